@@ -0,0 +1,165 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "domkrat3d/assets/archive.hpp"
+
+#ifdef __linux__
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr size_t FILE_COUNT = 2000;
+    constexpr size_t MAX_FILE_SIZE = 128 * 1024;
+    constexpr int REPEAT_COUNT = 5;
+
+    using Seconds = std::chrono::duration<double>;
+
+    // What a loader does with the bytes: read every one of them once.
+    auto checksum(const std::byte* data, size_t size) -> uint64_t {
+        uint64_t sum = 0;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word = 0;
+            std::memcpy(&word, data + i, sizeof(word));
+            sum += word;
+        }
+        for (; i < size; ++i) {
+            sum += static_cast<uint64_t>(data[i]);
+        }
+        return sum;
+    }
+
+#ifdef __linux__
+    constexpr bool CAN_EVICT = true;
+
+    // Drops the pages of a file from the page cache, so the next read goes to the disk. Works
+    // without privileges for files that are not dirty; the caller syncs first.
+    void evict(const fs::path& path) {
+        int const descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor >= 0) {
+            ::posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(descriptor);
+        }
+    }
+#else
+    // Other systems have no unprivileged way to drop a file from the cache; cold runs are skipped.
+    constexpr bool CAN_EVICT = false;
+
+    void evict(const fs::path&) {}
+#endif
+
+    template<typename Function>
+    auto seconds_per_run(Function&& function, bool cold, const std::vector<fs::path>& files) -> double {
+        double seconds = 0.0;
+        for (int repeat = 0; repeat < REPEAT_COUNT + 1; ++repeat) {
+            if (cold) {
+                for (const fs::path& file : files) {
+                    evict(file);
+                }
+            }
+            auto const start = std::chrono::steady_clock::now();
+            function();
+            // The first warm run fills the page cache.
+            if (cold || repeat > 0) {
+                seconds += Seconds(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+        return seconds / (cold ? REPEAT_COUNT + 1 : REPEAT_COUNT);
+    }
+}    // namespace
+
+auto main() -> int {
+    fs::path const directory = fs::temp_directory_path() / "domkrat3d_benchmark_assets";
+    fs::create_directories(directory);
+
+    std::vector<std::string> names;
+    std::vector<fs::path> files;
+    assets::ArchiveWriter writer;
+    std::mt19937 random(42);
+    size_t total = 0;
+    for (size_t i = 0; i < FILE_COUNT; ++i) {
+        std::vector<std::byte> data(1 + random() % MAX_FILE_SIZE);
+        for (std::byte& value : data) {
+            value = static_cast<std::byte>(random());
+        }
+        total += data.size();
+
+        names.push_back("level/asset_" + std::to_string(i) + ".bin");
+        files.push_back(directory / ("asset_" + std::to_string(i) + ".bin"));
+        std::FILE* file = std::fopen(files.back().string().c_str(), "wb");
+        std::fwrite(data.data(), 1, data.size(), file);
+        std::fclose(file);
+        writer.add(names.back(), assets::AssetType::Raw, std::move(data));
+    }
+
+    fs::path const archive_path = directory / "level.pak";
+    writer.write(archive_path.string());
+#ifdef __linux__
+    ::sync();
+#endif
+
+    std::cout << FILE_COUNT << " files, " << total / 1024 << " KB\n";
+
+    uint64_t expected = 0;
+    auto const read_files = [&files, &expected]()
+    {
+        uint64_t sum = 0;
+        std::vector<std::byte> buffer;
+        for (const fs::path& path : files) {
+            std::FILE* file = std::fopen(path.string().c_str(), "rb");
+            std::fseek(file, 0, SEEK_END);
+            auto const size = static_cast<size_t>(std::ftell(file));
+            std::fseek(file, 0, SEEK_SET);
+            buffer.resize(size);
+            if (std::fread(buffer.data(), 1, size, file) != size) {
+                std::cerr << "short read of " << path << "\n";
+            }
+            std::fclose(file);
+            sum += checksum(buffer.data(), size);
+        }
+        expected = sum;
+    };
+
+    uint64_t mapped = 0;
+    auto const read_archive = [&archive_path, &names, &mapped]()
+    {
+        assets::Archive const archive(archive_path.string());
+        uint64_t sum = 0;
+        for (const std::string& name : names) {
+            assets::Blob const blob = archive.find(name);
+            sum += checksum(blob.data, blob.size);
+        }
+        mapped = sum;
+    };
+
+    std::vector<fs::path> const archive_files {archive_path};
+    for (bool const cold : {false, true}) {
+        if (cold && !CAN_EVICT) {
+            std::cout << "  cold page cache: not measured on this system\n";
+            continue;
+        }
+        double const fread_seconds = seconds_per_run(read_files, cold, files);
+        double const archive_seconds = seconds_per_run(read_archive, cold, archive_files);
+        std::cout << (cold ? "  cold page cache" : "  warm page cache") << ": fread per file "
+                  << fread_seconds * 1e3 << " ms, mapped archive " << archive_seconds * 1e3 << " ms ("
+                  << fread_seconds / archive_seconds << "x)\n";
+    }
+    if (mapped != expected) {
+        std::cerr << "archive contents differ from the files\n";
+        return 1;
+    }
+
+    fs::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/broadphase.hpp"
+#include "domkrat3d/utils/random.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using physics::broadphase::Pair;
+
+    constexpr int FRAME_COUNT = 30;
+    constexpr float HALF_SIZE = 0.5F;
+    constexpr float SPEED = 2.0F;
+    constexpr float STEP = 1.0F / 60.0F;
+
+    // Objects keep the same density at every count: about one per 8 cubic units.
+    struct Scene {
+        std::vector<Vec3> centers;
+        std::vector<Vec3> velocities;
+        float world = 0.0F;
+
+        explicit Scene(size_t count)
+            : centers(count)
+            , velocities(count)
+            , world(std::cbrt(static_cast<float>(count) * 8.0F)) {
+            utils::random::Xoshiro256 engine(count);
+            for (size_t i = 0; i < count; ++i) {
+                centers[i] = {
+                    engine.uniform(0.0F, world), engine.uniform(0.0F, world), engine.uniform(0.0F, world)};
+                engine.on_unit_sphere(velocities[i].x, velocities[i].y, velocities[i].z);
+                velocities[i] *= SPEED;
+            }
+        }
+
+        auto box(size_t i) const -> Aabb {
+            Vec3 const half {HALF_SIZE, HALF_SIZE, HALF_SIZE};
+            return {centers[i] - half, centers[i] + half};
+        }
+
+        // Move every object, bouncing off the world bounds.
+        void advance() {
+            for (size_t i = 0; i < centers.size(); ++i) {
+                centers[i] += velocities[i] * STEP;
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (centers[i][axis] < 0.0F || centers[i][axis] > world) {
+                        velocities[i][axis] = -velocities[i][axis];
+                    }
+                }
+            }
+        }
+    };
+
+    // Seconds per frame for moving all proxies and collecting the pairs.
+    template<typename Broadphase>
+    auto measure(Broadphase& broadphase, size_t count, size_t& pair_count) -> double {
+        Scene scene(count);
+        std::vector<physics::broadphase::ProxyId> proxies(count);
+        std::vector<Pair> pairs;
+
+        for (size_t i = 0; i < count; ++i) {
+            proxies[i] = broadphase.create_proxy(scene.box(i));
+        }
+        broadphase.find_pairs(pairs);
+
+        double seconds = 0.0;
+        pair_count = 0;
+        for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+            scene.advance();
+
+            auto const start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; ++i) {
+                broadphase.move_proxy(proxies[i], scene.box(i));
+            }
+            broadphase.find_pairs(pairs);
+            std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+            seconds += elapsed.count();
+            pair_count += pairs.size();
+        }
+
+        pair_count /= FRAME_COUNT;
+        return seconds / FRAME_COUNT;
+    }
+
+    void report(const char* name, size_t count, size_t pair_count, double frame_seconds) {
+        std::cout << "  " << name << ": " << frame_seconds * 1e3 << " ms/frame, " << pair_count << " pairs, "
+                  << static_cast<double>(pair_count) / frame_seconds / 1e6 << " M pairs/s, "
+                  << static_cast<double>(count) / frame_seconds / 1e6 << " M objects/s\n";
+    }
+}    // namespace
+
+auto main() -> int {
+    for (size_t const count : {1000U, 10000U, 100000U}) {
+        std::cout << count << " moving boxes\n";
+
+        size_t pair_count = 0;
+
+        // Cells twice the object size: most boxes touch one or two cells per axis.
+        physics::broadphase::SpatialHash hash(4.0F * HALF_SIZE);
+        double const hash_seconds = measure(hash, count, pair_count);
+        report("spatial hash", count, pair_count, hash_seconds);
+
+        physics::broadphase::SweepAndPrune sweep;
+        double const sweep_seconds = measure(sweep, count, pair_count);
+        report("sweep and prune", count, pair_count, sweep_seconds);
+    }
+
+    return 0;
+}
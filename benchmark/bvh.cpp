@@ -0,0 +1,130 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/bvh.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+#include "domkrat3d/utils/random.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using mathematics::geometry::Ray;
+    using physics::bvh::Bvh;
+
+    constexpr float WORLD = 100.0F;
+    constexpr size_t RAY_COUNT = 100000;
+
+    // Seconds taken by body().
+    template<typename Body>
+    auto time(Body&& body) -> double {
+        auto const start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // Triangle soup spread through a cube; one triangle per primitive.
+    struct Soup {
+        std::vector<Vec3> a;
+        std::vector<Vec3> b;
+        std::vector<Vec3> c;
+        std::vector<Aabb> boxes;
+
+        explicit Soup(size_t count)
+            : a(count)
+            , b(count)
+            , c(count)
+            , boxes(count) {
+            utils::random::Xoshiro256 engine(count);
+            for (size_t i = 0; i < count; ++i) {
+                Vec3 const center {
+                    engine.uniform(0.0F, WORLD), engine.uniform(0.0F, WORLD), engine.uniform(0.0F, WORLD)};
+                a[i] = center + Vec3 {engine.uniform(-1.0F, 1.0F), engine.uniform(-1.0F, 1.0F), 0.0F};
+                b[i] = center + Vec3 {0.0F, engine.uniform(-1.0F, 1.0F), engine.uniform(-1.0F, 1.0F)};
+                c[i] = center + Vec3 {engine.uniform(-1.0F, 1.0F), 0.0F, engine.uniform(-1.0F, 1.0F)};
+            }
+            update_boxes();
+        }
+
+        void update_boxes() {
+            for (size_t i = 0; i < a.size(); ++i) {
+                boxes[i] = {mathematics::min(mathematics::min(a[i], b[i]), c[i]),
+                            mathematics::max(mathematics::max(a[i], b[i]), c[i])};
+            }
+        }
+    };
+
+    // Coherent primary rays from a camera outside the cube looking at its center.
+    auto camera_rays(size_t count) -> std::vector<Ray> {
+        std::vector<Ray> rays(count);
+        auto const side = static_cast<size_t>(std::sqrt(static_cast<double>(count)));
+        Vec3 const eye {WORLD * 0.5F, WORLD * 0.5F, -WORLD};
+
+        for (size_t i = 0; i < count; ++i) {
+            float const u = (static_cast<float>(i % side) / static_cast<float>(side)) - 0.5F;
+            float const v = (static_cast<float>(i / side) / static_cast<float>(side)) - 0.5F;
+            rays[i].origin = eye;
+            rays[i].direction = mathematics::normalize(Vec3 {u, v, 1.0F});
+        }
+        return rays;
+    }
+}    // namespace
+
+auto main() -> int {
+    for (size_t const count : {10000U, 100000U, 1000000U}) {
+        std::cout << count << " triangles\n";
+
+        Soup soup(count);
+        Bvh bvh;
+
+        auto const serial_execution = physics::kinematics::Execution::Serial;
+        double const serial = time([&] { bvh.build(soup.boxes.data(), count, serial_execution); });
+        double const parallel = time([&] { bvh.build(soup.boxes.data(), count); });
+        std::cout << "  build: " << serial * 1e3 << " ms serial, " << parallel * 1e3 << " ms parallel, "
+                  << bvh.node_count() << " nodes\n";
+
+        for (size_t i = 0; i < count; ++i) {
+            Vec3 const shift {0.01F, 0.0F, 0.0F};
+            soup.a[i] += shift;
+            soup.b[i] += shift;
+            soup.c[i] += shift;
+        }
+        soup.update_boxes();
+        double const refit = time([&] { bvh.refit(soup.boxes.data()); });
+        std::cout << "  refit: " << refit * 1e3 << " ms\n";
+
+        auto const triangle = [&soup](uint32_t primitive, const Ray& ray)
+        {
+            return mathematics::geometry::intersect_triangle(
+                ray, soup.a[primitive], soup.b[primitive], soup.c[primitive]);
+        };
+
+        std::vector<Ray> const rays = camera_rays(RAY_COUNT);
+        std::vector<physics::bvh::RayHit> hits(rays.size());
+        size_t hit_count = 0;
+
+        double const single = time(
+            [&]
+            {
+                for (size_t i = 0; i < rays.size(); ++i) {
+                    hits[i] = bvh.raycast(rays[i], triangle);
+                }
+            });
+        double const packets = time([&] { bvh.raycast(rays.data(), hits.data(), rays.size(), triangle); });
+
+        for (const auto& hit : hits) {
+            hit_count += hit.primitive != physics::bvh::NO_PRIMITIVE ? 1 : 0;
+        }
+        std::cout << "  rays: " << static_cast<double>(rays.size()) / single / 1e6 << " M rays/s single, "
+                  << static_cast<double>(rays.size()) / packets / 1e6 << " M rays/s packets, " << hit_count
+                  << " hits\n";
+    }
+
+    return 0;
+}
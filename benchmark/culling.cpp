@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/bvh.hpp"
+#include "domkrat3d/scene/culling.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using scene::culling::BoxArray;
+    using scene::culling::Frustum;
+    using scene::culling::SphereArray;
+    using utils::jobs::JobSystem;
+
+    constexpr size_t OBJECT_COUNT = 1000000;
+    constexpr float WORLD_SIZE = 2000.0F;
+    constexpr int REPEAT_COUNT = 20;
+
+    using Seconds = std::chrono::duration<double>;
+
+    template<typename Function>
+    auto seconds_per_run(Function&& function) -> double {
+        function();
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < REPEAT_COUNT; ++repeat) {
+            function();
+        }
+        return Seconds(std::chrono::steady_clock::now() - start).count() / REPEAT_COUNT;
+    }
+
+    void report(const char* name, double seconds, size_t visible) {
+        std::cout << "    " << name << ": " << seconds * 1e3 << " ms, "
+                  << static_cast<double>(OBJECT_COUNT) / (seconds * 1e3) << " objects/ms, " << visible
+                  << " visible\n";
+    }
+
+    // Scalar reference: the same sphere test one object at a time.
+    void cull_scalar(const Frustum& frustum, const SphereArray& spheres, std::vector<uint32_t>& visible) {
+        visible.clear();
+        for (uint32_t i = 0; i < spheres.size(); ++i) {
+            bool inside = true;
+            for (const auto& plane : frustum.planes) {
+                float const distance = mathematics::geometry::signed_distance(plane, spheres.center(i));
+                inside = inside && distance >= -spheres.radius(i);
+            }
+            if (inside) {
+                visible.push_back(i);
+            }
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    // Objects scattered over a flat city-sized area, the camera in the middle looking along it.
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> position(-WORLD_SIZE * 0.5F, WORLD_SIZE * 0.5F);
+    std::uniform_real_distribution<float> height(0.0F, 50.0F);
+    std::uniform_real_distribution<float> size(0.5F, 10.0F);
+
+    SphereArray spheres;
+    BoxArray boxes;
+    std::vector<Aabb> aabbs;
+    aabbs.reserve(OBJECT_COUNT);
+    for (size_t i = 0; i < OBJECT_COUNT; ++i) {
+        Vec3 const center {position(random), height(random), position(random)};
+        Vec3 const half {size(random), size(random), size(random)};
+        aabbs.push_back({center - half, center + half});
+        boxes.add(aabbs.back());
+        spheres.add(center, mathematics::length(half));
+    }
+    physics::bvh::Bvh bvh;
+    bvh.build(aabbs.data(), aabbs.size());
+
+    mathematics::Mat4 const view_projection = mathematics::perspective(1.0F, 16.0F / 9.0F, 0.1F, 800.0F)
+                                              * mathematics::look_at({0.0F, 20.0F, 0.0F},
+                                                                     {1.0F, 20.0F, 0.3F},
+                                                                     {0.0F, 1.0F, 0.0F});
+    Frustum const frustum = scene::culling::extract_frustum(view_projection);
+
+    size_t const cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::cout << OBJECT_COUNT << " objects, " << cores << " cores\n";
+
+    std::vector<uint32_t> visible;
+    double const scalar = seconds_per_run([&] { cull_scalar(frustum, spheres, visible); });
+    std::cout << "  1 thread\n";
+    report("scalar spheres", scalar, visible.size());
+
+    double const hierarchical = seconds_per_run([&] { scene::culling::cull(frustum, bvh, visible); });
+    report("BVH boxes", hierarchical, visible.size());
+
+    for (size_t threads = 1; threads <= cores; threads *= 2) {
+        JobSystem system(threads);
+        if (threads > 1) {
+            std::cout << "  " << threads << " threads\n";
+        }
+        double const sphere =
+            seconds_per_run([&] { scene::culling::cull(frustum, spheres, visible, system); });
+        report("SIMD spheres", sphere, visible.size());
+        double const box = seconds_per_run([&] { scene::culling::cull(frustum, boxes, visible, system); });
+        report("SIMD boxes", box, visible.size());
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/dynamics.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using physics::dynamics::BodyDesc;
+    using physics::dynamics::BodyType;
+    using physics::dynamics::Settings;
+    using physics::dynamics::World;
+    using physics::kinematics::Execution;
+    using physics::narrowphase::Shape;
+
+    constexpr int STEP_COUNT = 60;
+    constexpr float STEP = 1.0F / 60.0F;
+    constexpr float PYRAMID_SPACING = 40.0F;
+
+    // `count` pyramids of unit boxes side by side, each its own island.
+    void build(World& world, size_t count, int base) {
+        BodyDesc ground;
+        ground.type = BodyType::Static;
+        ground.shape = Shape::box({PYRAMID_SPACING * static_cast<float>(count), 0.5F, PYRAMID_SPACING});
+        ground.transform.position = {0.0F, -0.5F, 0.0F};
+        world.create_body(ground);
+
+        for (size_t pyramid = 0; pyramid < count; ++pyramid) {
+            float const offset = static_cast<float>(pyramid) - (static_cast<float>(count) / 2.0F);
+            float const center = PYRAMID_SPACING * offset;
+            for (int row = 0; row < base; ++row) {
+                for (int column = 0; column < base - row; ++column) {
+                    BodyDesc box;
+                    box.shape = Shape::box({0.5F, 0.5F, 0.5F});
+                    box.transform.position = {
+                        center + static_cast<float>(column) - (static_cast<float>(base - row - 1) / 2.0F),
+                        0.5F + static_cast<float>(row),
+                        0.0F};
+                    world.create_body(box);
+                }
+            }
+        }
+    }
+
+    void measure(const char* name, size_t count, int base, Execution execution, size_t batch_threshold) {
+        Settings settings;
+        settings.batch_threshold = batch_threshold;
+        // Settled pyramids would fall asleep and leave the solver nothing to do.
+        settings.time_to_sleep = std::numeric_limits<float>::max();
+        World world(settings);
+        world.set_execution(execution);
+        build(world, count, base);
+
+        double seconds = 0.0;
+        size_t contact_total = 0;
+        size_t batched_total = 0;
+        size_t colors = 0;
+
+        for (int step = 0; step < STEP_COUNT; ++step) {
+            auto const start = std::chrono::steady_clock::now();
+            world.step(STEP);
+            std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+            seconds += elapsed.count();
+            contact_total += world.stats().contact_points;
+            batched_total += world.stats().batched_points;
+            colors = std::max(colors, world.stats().colors);
+        }
+
+        std::cout << "  " << name << ": " << seconds / STEP_COUNT * 1e3 << " ms/step, "
+                  << world.stats().islands << " islands, " << contact_total / STEP_COUNT << " contacts, "
+                  << 100.0 * static_cast<double>(batched_total) / static_cast<double>(contact_total)
+                  << "% batched, " << colors << " colors\n";
+    }
+}    // namespace
+
+auto main() -> int {
+    struct Case {
+        size_t count;
+        int base;
+    };
+
+    size_t const batched = Settings {}.batch_threshold;
+
+    for (Case const scene : {Case {1, 30}, Case {16, 12}, Case {64, 12}}) {
+        std::cout << scene.count << " pyramid(s) of base " << scene.base << "\n";
+        measure("scalar, serial", scene.count, scene.base, Execution::Serial, SIZE_MAX);
+        measure("batched, serial", scene.count, scene.base, Execution::Serial, batched);
+        measure("scalar, parallel", scene.count, scene.base, Execution::Parallel, SIZE_MAX);
+        measure("batched, parallel", scene.count, scene.base, Execution::Parallel, batched);
+    }
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/scene/ecs.hpp"
+
+namespace {
+    using mathematics::Transform;
+    using mathematics::Vec3;
+    using scene::ecs::Entity;
+    using scene::ecs::Query;
+    using scene::ecs::World;
+
+    constexpr size_t ENTITY_COUNT = 1000000;
+    constexpr int REPEAT_COUNT = 20;
+    constexpr float STEP = 1.0F / 60.0F;
+
+    using Seconds = std::chrono::duration<double>;
+
+    struct Velocity {
+        Vec3 linear;
+    };
+
+    // What a scene without an entity model does: one heap object per entity, visited through a
+    // pointer list whose order has nothing to do with the allocation order.
+    struct Object {
+        Transform transform;
+        Velocity velocity;
+        char payload[96] = {};
+    };
+
+    template<typename Function>
+    auto seconds_per_run(Function&& function) -> double {
+        function();
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < REPEAT_COUNT; ++repeat) {
+            function();
+        }
+        return Seconds(std::chrono::steady_clock::now() - start).count() / REPEAT_COUNT;
+    }
+
+    void report(const char* name, double seconds) {
+        std::cout << "  " << name << ": " << seconds * 1e3 << " ms, "
+                  << seconds * 1e9 / static_cast<double>(ENTITY_COUNT) << " ns/entity\n";
+    }
+}    // namespace
+
+auto main() -> int {
+    World world;
+    for (size_t i = 0; i < ENTITY_COUNT; ++i) {
+        Transform transform;
+        transform.position = {static_cast<float>(i % 1000), 0.0F, static_cast<float>(i / 1000)};
+        world.create(transform, Velocity {{0.0F, 1.0F, 0.0F}});
+    }
+
+    std::vector<std::unique_ptr<Object>> objects;
+    objects.reserve(ENTITY_COUNT);
+    for (size_t i = 0; i < ENTITY_COUNT; ++i) {
+        objects.push_back(std::make_unique<Object>());
+        objects.back()->velocity.linear = {0.0F, 1.0F, 0.0F};
+    }
+    std::shuffle(objects.begin(), objects.end(), std::mt19937(42));
+
+    std::cout << ENTITY_COUNT << " entities in " << world.chunk_count() << " chunks of "
+              << world.archetype(1).capacity << "\n";
+
+    Query<Transform, const Velocity> moving(world);
+    auto const integrate = [](Entity, Transform& transform, const Velocity& velocity)
+    { transform.position = transform.position + velocity.linear * STEP; };
+
+    report("pointer list", seconds_per_run(
+                               [&objects]()
+                               {
+                                   for (auto& object : objects) {
+                                       object->transform.position =
+                                           object->transform.position + object->velocity.linear * STEP;
+                                   }
+                               }));
+    report("query", seconds_per_run([&]() { moving.each(integrate); }));
+    report("parallel query", seconds_per_run([&]() { moving.parallel_each(integrate); }));
+
+    // Structural changes deferred through a command buffer: tag and untag a tenth of the entities.
+    struct Tag {};
+    scene::ecs::CommandBuffer commands;
+    Query<const Transform> all(world);
+    Query<const Tag> tagged(world);
+    double const tagging = seconds_per_run(
+        [&]()
+        {
+            all.each(
+                [&commands](Entity entity, const Transform&)
+                {
+                    if (entity.index() % 10 == 0) {
+                        commands.add(entity, Tag {});
+                    }
+                });
+            commands.apply(world);
+            tagged.each([&commands](Entity entity, const Tag&) { commands.remove<Tag>(entity); });
+            commands.apply(world);
+        });
+    std::cout << "  tag and untag " << ENTITY_COUNT / 10 << " entities: " << tagging * 1e3 << " ms\n";
+
+    return 0;
+}
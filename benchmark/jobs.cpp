@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    using utils::jobs::Counter;
+    using utils::jobs::Job;
+    using utils::jobs::JobSystem;
+
+    constexpr size_t ELEMENT_COUNT = 1U << 22U;
+    constexpr size_t TINY_JOB_COUNT = 1U << 16U;
+    constexpr int REPEAT_COUNT = 10;
+
+    using Seconds = std::chrono::duration<double>;
+
+    // A few transcendental calls per element, so the loop is bound by compute, not memory.
+    void work(std::vector<float>& values, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float const x = static_cast<float>(i) * 1e-4F;
+            values[i] = std::sin(x) * std::cos(x * 0.5F) + std::sqrt(x);
+        }
+    }
+
+    auto loop_seconds(JobSystem& system, std::vector<float>& values) -> double {
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < REPEAT_COUNT; ++repeat) {
+            utils::parallel::parallel_for(system,
+                                          values.size(),
+                                          4096,
+                                          [&values](size_t begin, size_t end) { work(values, begin, end); });
+        }
+        return Seconds(std::chrono::steady_clock::now() - start).count() / REPEAT_COUNT;
+    }
+
+    // Submit-to-finish cost of jobs that do nothing.
+    auto tiny_job_seconds(JobSystem& system) -> double {
+        std::vector<Job> jobs(TINY_JOB_COUNT);
+        for (Job& job : jobs) {
+            job.function = [](const Job&) {};
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < REPEAT_COUNT; ++repeat) {
+            Counter counter;
+            system.submit(jobs.data(), jobs.size(), counter);
+            system.wait(counter);
+        }
+        return Seconds(std::chrono::steady_clock::now() - start).count() / REPEAT_COUNT;
+    }
+}    // namespace
+
+auto main() -> int {
+    size_t const cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::vector<float> values(ELEMENT_COUNT);
+    double baseline = 0.0;
+
+    std::cout << ELEMENT_COUNT << " elements, " << cores << " cores\n";
+
+    for (size_t threads = 1; threads <= cores; ++threads) {
+        JobSystem system(threads);
+        double const seconds = loop_seconds(system, values);
+        if (threads == 1) {
+            baseline = seconds;
+        }
+
+        double const tiny = tiny_job_seconds(system);
+        double const speedup = baseline / seconds;
+        std::cout << "  " << threads << " threads: parallel_for " << seconds * 1e3 << " ms, speedup "
+                  << speedup << ", efficiency " << 100.0 * speedup / static_cast<double>(threads)
+                  << "%, empty jobs " << tiny / TINY_JOB_COUNT * 1e9 << " ns/job\n";
+    }
+
+    return 0;
+}
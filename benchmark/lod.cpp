@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/scene/culling.hpp"
+#include "domkrat3d/scene/lod.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using mathematics::Mat4;
+    using mathematics::Vec3;
+    using scene::lod::LodLevel;
+
+    constexpr size_t INSTANCE_COUNT = 500000;
+    constexpr float WORLD_SIZE = 2000.0F;
+    constexpr float FOV_Y = 1.1F;
+    constexpr float VIEWPORT_HEIGHT = 1080.0F;
+    constexpr int FRAME_COUNT = 60;
+
+    // The camera walks this far per frame, so levels change every frame somewhere.
+    constexpr float STEP = 0.5F;
+
+    using Seconds = std::chrono::duration<double>;
+
+    // Trees, rocks and houses: each level has about half the triangles and twice the error of the last.
+    LodLevel const TREE_LEVELS[] = {{0.0F, 4000}, {0.02F, 1800}, {0.05F, 700}, {0.15F, 200}, {0.5F, 12}};
+    LodLevel const ROCK_LEVELS[] = {{0.0F, 1200}, {0.03F, 400}, {0.1F, 90}};
+    LodLevel const HOUSE_LEVELS[] = {{0.0F, 9000}, {0.01F, 3500}, {0.04F, 1200}, {0.2F, 300}};
+}    // namespace
+
+auto main() -> int {
+    std::mt19937 random(9);
+    std::uniform_real_distribution<float> position(-WORLD_SIZE * 0.5F, WORLD_SIZE * 0.5F);
+    std::uniform_real_distribution<float> size(1.0F, 6.0F);
+
+    scene::lod::LodSelector selector;
+    uint32_t const models[] = {selector.add_model(TREE_LEVELS, 5),
+                               selector.add_model(ROCK_LEVELS, 3),
+                               selector.add_model(HOUSE_LEVELS, 4)};
+    scene::culling::SphereArray bounds;
+    for (size_t i = 0; i < INSTANCE_COUNT; ++i) {
+        bounds.add({position(random), 0.0F, position(random)}, size(random));
+        selector.add_instance(models[i % 3]);
+    }
+
+    utils::jobs::JobSystem& jobs = utils::jobs::global();
+    std::vector<uint32_t> visible;
+    double culling = 0.0;
+    double selecting = 0.0;
+    uint64_t triangles = 0;
+    uint64_t finest_triangles = 0;
+    size_t switches = 0;
+    size_t evaluated = 0;
+    for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+        Vec3 const eye {STEP * static_cast<float>(frame), 2.0F, 0.0F};
+        Mat4 const view = mathematics::look_at(eye, eye + Vec3 {1.0F, 0.0F, 0.3F}, {0.0F, 1.0F, 0.0F});
+        Mat4 const view_projection = mathematics::perspective(FOV_Y, 16.0F / 9.0F, 0.1F, 3000.0F) * view;
+
+        auto const start = std::chrono::steady_clock::now();
+        scene::culling::cull(scene::culling::extract_frustum(view_projection), bounds, visible, jobs);
+        auto const culled = std::chrono::steady_clock::now();
+        selector.select(scene::lod::make_camera(eye, FOV_Y, VIEWPORT_HEIGHT), bounds, visible, jobs);
+        auto const selected = std::chrono::steady_clock::now();
+
+        // The first frame starts every instance at the finest level, so it is left out.
+        if (frame == 0) {
+            continue;
+        }
+        culling += Seconds(culled - start).count();
+        selecting += Seconds(selected - culled).count();
+        triangles += selector.triangle_count();
+        switches += selector.switch_count();
+        evaluated += visible.size();
+        for (uint32_t const instance : visible) {
+            finest_triangles += instance % 3 == 0 ? TREE_LEVELS[0].triangles
+                                : instance % 3 == 1 ? ROCK_LEVELS[0].triangles
+                                                    : HOUSE_LEVELS[0].triangles;
+        }
+    }
+
+    auto const frames = static_cast<double>(FRAME_COUNT - 1);
+    std::cout << INSTANCE_COUNT << " instances, " << jobs.thread_count() << " threads, " << FRAME_COUNT - 1
+              << " frames\n";
+    std::cout << "  culling: " << static_cast<double>(evaluated) / frames << " visible, "
+              << culling / frames * 1e3 << " ms\n";
+    std::cout << "  selection: " << selecting / frames * 1e3 << " ms, "
+              << static_cast<double>(evaluated) / (selecting * 1e3) << " instances/ms\n";
+    std::cout << "  triangles: " << static_cast<double>(triangles) / frames << " per frame, "
+              << static_cast<double>(finest_triangles) / frames << " at the finest level\n";
+    std::cout << "  switches: " << static_cast<double>(switches) / frames << " per frame\n";
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/broadphase.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+#include "domkrat3d/physics/narrowphase.hpp"
+#include "domkrat3d/utils/random.hpp"
+
+namespace {
+    using mathematics::Quat;
+    using mathematics::Vec3;
+    using physics::broadphase::Pair;
+    using physics::kinematics::Execution;
+    using physics::narrowphase::Collider;
+    using physics::narrowphase::ConvexHull;
+    using physics::narrowphase::Narrowphase;
+    using physics::narrowphase::Shape;
+
+    constexpr int FRAME_COUNT = 20;
+    constexpr float SPACING = 0.9F;
+    constexpr float JITTER = 0.05F;
+    constexpr float STEP = 1.0F / 60.0F;
+
+    // Octahedron-like hull with a few extra vertices, so the support search runs more than one SIMD block.
+    auto make_hull() -> ConvexHull {
+        Vec3 const points[] = {{0.5F, 0.0F, 0.0F},
+                               {-0.5F, 0.0F, 0.0F},
+                               {0.0F, 0.5F, 0.0F},
+                               {0.0F, -0.5F, 0.0F},
+                               {0.0F, 0.0F, 0.5F},
+                               {0.0F, 0.0F, -0.5F},
+                               {0.3F, 0.3F, 0.3F},
+                               {-0.3F, -0.3F, 0.3F},
+                               {0.3F, -0.3F, -0.3F},
+                               {-0.3F, 0.3F, -0.3F}};
+        return {points, sizeof(points) / sizeof(points[0])};
+    }
+
+    // Mixed shapes on a jittered grid tight enough that most neighbours touch.
+    struct Scene {
+        std::vector<Collider> colliders;
+        std::vector<Vec3> velocities;
+        std::vector<Vec3> spins;
+
+        Scene(size_t count, const ConvexHull& hull) {
+            utils::random::Xoshiro256 engine(count);
+            auto const side = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+
+            for (size_t i = 0; i < count; ++i) {
+                Shape shape;
+                switch (i % 4) {
+                    case 0:
+                        shape = Shape::box({0.5F, 0.5F, 0.5F});
+                        break;
+                    case 1:
+                        shape = Shape::sphere(0.5F);
+                        break;
+                    case 2:
+                        shape = Shape::capsule(0.3F, 0.3F);
+                        break;
+                    default:
+                        shape = Shape::convex_hull(hull);
+                        break;
+                }
+
+                Vec3 const cell {static_cast<float>(i % side),
+                                 static_cast<float>((i / side) % side),
+                                 static_cast<float>(i / (side * side))};
+                Vec3 const jitter {engine.uniform(-JITTER, JITTER),
+                                   engine.uniform(-JITTER, JITTER),
+                                   engine.uniform(-JITTER, JITTER)};
+                Quat const rotation = mathematics::normalize(Quat {engine.uniform(-1.0F, 1.0F),
+                                                                   engine.uniform(-1.0F, 1.0F),
+                                                                   engine.uniform(-1.0F, 1.0F),
+                                                                   engine.uniform(-1.0F, 1.0F)});
+
+                colliders.push_back({shape, {(cell * SPACING) + jitter, rotation}});
+
+                Vec3 velocity;
+                engine.on_unit_sphere(velocity.x, velocity.y, velocity.z);
+                velocities.push_back(velocity * 0.2F);
+                spins.push_back(velocity);
+            }
+        }
+
+        // Moves every `stride`-th collider; the rest rest and hit the manifold cache.
+        void advance(size_t stride) {
+            for (size_t i = 0; i < colliders.size(); i += stride) {
+                auto& transform = colliders[i].transform;
+                transform.position += velocities[i] * STEP;
+                transform.rotation = mathematics::integrate(transform.rotation, spins[i], STEP);
+            }
+        }
+    };
+
+    void measure(const char* name, size_t count, size_t stride, Execution execution, const ConvexHull& hull) {
+        Scene scene(count, hull);
+        physics::broadphase::SpatialHash broadphase(2.0F);
+        std::vector<physics::broadphase::ProxyId> proxies(count);
+        std::vector<Pair> pairs;
+
+        for (size_t i = 0; i < count; ++i) {
+            proxies[i] = broadphase.create_proxy(physics::narrowphase::bounds(scene.colliders[i]));
+        }
+
+        Narrowphase narrowphase;
+        double seconds = 0.0;
+        size_t pair_total = 0;
+        size_t contact_total = 0;
+        size_t reused_total = 0;
+
+        for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+            scene.advance(stride);
+            for (size_t i = 0; i < count; ++i) {
+                broadphase.move_proxy(proxies[i], physics::narrowphase::bounds(scene.colliders[i]));
+            }
+            broadphase.find_pairs(pairs);
+
+            auto const start = std::chrono::steady_clock::now();
+            narrowphase.update(pairs.data(), pairs.size(), scene.colliders.data(), execution);
+            std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+            seconds += elapsed.count();
+            pair_total += pairs.size();
+            contact_total += narrowphase.contact_count();
+            reused_total += narrowphase.reused_count();
+        }
+
+        std::cout << "  " << name << ": " << seconds / FRAME_COUNT * 1e3 << " ms/frame, "
+                  << pair_total / FRAME_COUNT << " pairs, " << contact_total / FRAME_COUNT << " contacts, "
+                  << static_cast<double>(pair_total) / seconds / 1e6 << " M pairs/s, "
+                  << static_cast<double>(contact_total) / seconds / 1e6 << " M contacts/s, "
+                  << 100.0 * static_cast<double>(reused_total) / static_cast<double>(pair_total)
+                  << "% cached\n";
+    }
+}    // namespace
+
+auto main() -> int {
+    ConvexHull const hull = make_hull();
+
+    for (size_t const count : {1000U, 10000U, 50000U}) {
+        std::cout << count << " colliders\n";
+        measure("all moving, serial", count, 1, Execution::Serial, hull);
+        measure("all moving, parallel", count, 1, Execution::Parallel, hull);
+        measure("10% moving, serial", count, 10, Execution::Serial, hull);
+        measure("10% moving, parallel", count, 10, Execution::Parallel, hull);
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/scene/culling.hpp"
+#include "domkrat3d/scene/occlusion.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using mathematics::Mat4;
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+
+    // A city of blocks on a grid with props (cars, lamps, benches) along the streets.
+    constexpr int BLOCKS_PER_SIDE = 60;
+    constexpr float BLOCK_SPACING = 40.0F;
+    constexpr size_t PROPS_PER_BLOCK = 24;
+
+    // Buildings this close to the camera are drawn into the occlusion buffer.
+    constexpr float OCCLUDER_DISTANCE = 250.0F;
+
+    constexpr uint32_t BUFFER_WIDTH = 320;
+    constexpr uint32_t BUFFER_HEIGHT = 192;
+    constexpr int REPEAT_COUNT = 20;
+
+    using Seconds = std::chrono::duration<double>;
+
+    template<typename Function>
+    auto seconds_per_run(Function&& function) -> double {
+        function();
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < REPEAT_COUNT; ++repeat) {
+            function();
+        }
+        return Seconds(std::chrono::steady_clock::now() - start).count() / REPEAT_COUNT;
+    }
+
+    // Unit cube around the origin; a building scales and moves it.
+    Vec3 const CUBE_POSITIONS[8] = {{-1.0F, -1.0F, -1.0F},
+                                    {1.0F, -1.0F, -1.0F},
+                                    {1.0F, 1.0F, -1.0F},
+                                    {-1.0F, 1.0F, -1.0F},
+                                    {-1.0F, -1.0F, 1.0F},
+                                    {1.0F, -1.0F, 1.0F},
+                                    {1.0F, 1.0F, 1.0F},
+                                    {-1.0F, 1.0F, 1.0F}};
+
+    uint32_t const CUBE_INDICES[36] = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+                                       3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5};
+}    // namespace
+
+auto main() -> int {
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+
+    std::vector<Aabb> buildings;
+    scene::culling::BoxArray boxes;
+    for (int z = 0; z < BLOCKS_PER_SIDE; ++z) {
+        for (int x = 0; x < BLOCKS_PER_SIDE; ++x) {
+            Vec3 const corner {
+                static_cast<float>(x) * BLOCK_SPACING, 0.0F, static_cast<float>(z) * BLOCK_SPACING};
+            float const height = 15.0F + (60.0F * unit(random));
+            buildings.push_back({corner + Vec3 {5.0F, 0.0F, 5.0F}, corner + Vec3 {35.0F, height, 35.0F}});
+            boxes.add(buildings.back());
+            for (size_t prop = 0; prop < PROPS_PER_BLOCK; ++prop) {
+                Vec3 const position = corner + Vec3 {2.0F * unit(random), 0.0F, BLOCK_SPACING * unit(random)};
+                boxes.add({position, position + Vec3 {1.5F, 1.5F + (3.0F * unit(random)), 4.0F}});
+            }
+        }
+    }
+
+    // Street level in the middle of the city, looking down an avenue at an angle.
+    float const middle = BLOCKS_PER_SIDE * BLOCK_SPACING * 0.5F;
+    Vec3 const eye {middle + 2.5F, 1.8F, middle};
+    Mat4 const view = mathematics::look_at(eye, eye + Vec3 {0.4F, 0.05F, 1.0F}, {0.0F, 1.0F, 0.0F});
+    Mat4 const view_projection = mathematics::perspective(1.1F, 16.0F / 9.0F, 0.1F, 3000.0F) * view;
+    scene::culling::Frustum const frustum = scene::culling::extract_frustum(view_projection);
+
+    utils::jobs::JobSystem& jobs = utils::jobs::global();
+    std::vector<uint32_t> in_frustum;
+    std::vector<uint32_t> visible;
+    scene::occlusion::OcclusionBuffer buffer(BUFFER_WIDTH, BUFFER_HEIGHT);
+
+    double const culling = seconds_per_run([&] { scene::culling::cull(frustum, boxes, in_frustum, jobs); });
+
+    size_t occluders = 0;
+    double const rasterizing = seconds_per_run(
+        [&]
+        {
+            buffer.begin(view_projection);
+            occluders = 0;
+            for (const Aabb& building : buildings) {
+                Vec3 const center = mathematics::geometry::center(building);
+                if (mathematics::length(center - eye) > OCCLUDER_DISTANCE) {
+                    continue;
+                }
+                Mat4 const world = mathematics::affine(
+                    mathematics::diagonal(mathematics::geometry::extent(building) * 0.5F), center);
+                buffer.add_occluder(CUBE_POSITIONS, 8, CUBE_INDICES, 36, world);
+                ++occluders;
+            }
+            buffer.rasterize(jobs);
+        });
+
+    double const testing = seconds_per_run([&] { buffer.cull(boxes, in_frustum, visible, jobs); });
+
+    std::cout << boxes.size() << " objects, " << jobs.thread_count() << " threads, " << buffer.width() << "x"
+              << buffer.height() << " buffer\n";
+    std::cout << "  frustum: " << in_frustum.size() << " visible, " << culling * 1e3 << " ms\n";
+    std::cout << "  occluders: " << occluders << " buildings, " << buffer.triangle_count() << " triangles, "
+              << rasterizing * 1e3 << " ms\n";
+    std::cout << "  occlusion: " << visible.size() << " visible (" << in_frustum.size() - visible.size()
+              << " hidden draws skipped), " << testing * 1e3 << " ms, "
+              << static_cast<double>(in_frustum.size()) / (testing * 1e3) << " boxes/ms\n";
+
+    return 0;
+}
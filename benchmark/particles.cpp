@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+#include "domkrat3d/physics/kinematics.hpp"
+#include "domkrat3d/physics/particles.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    using physics::kinematics::Execution;
+    using physics::particles::Integrator;
+
+    constexpr size_t PARTICLE_COUNT = 1U << 20U;
+    constexpr int STEP_COUNT = 100;
+    constexpr float STEP = 1.0F / 60.0F;
+
+    auto integrator_name(Integrator integrator) -> const char* {
+        switch (integrator) {
+            case Integrator::SemiImplicitEuler:
+                return "semi-implicit Euler";
+            case Integrator::VelocityVerlet:
+                return "velocity Verlet";
+            case Integrator::Rk4:
+                return "RK4";
+        }
+
+        return "";
+    }
+
+    // Particles updated per second with the given integrator and execution mode.
+    auto measure(Integrator integrator, Execution execution) -> double {
+        using namespace physics::particles;
+
+        ParticleSystem system(PARTICLE_COUNT);
+        system.set_integrator(integrator);
+        system.set_execution(execution);
+        system.add_force({ForceType::Uniform, 0.0F, -9.81F, 0.0F});
+        system.add_force({ForceType::Drag, 0.0F, 0.0F, 0.0F, 0.1F});
+        system.add_force({ForceType::Attractor, 0.0F, 5.0F, 0.0F, 20.0F, 0.5F});
+
+        Emitter emitter;
+        emitter.radius = 1.0F;
+        emitter.min_speed = 2.0F;
+        emitter.max_speed = 8.0F;
+        emitter.min_lifetime = 1000.0F;
+        emitter.max_lifetime = 1000.0F;
+        system.emit(emitter, PARTICLE_COUNT);
+
+        // Warm-up step: first touch of the pages, thread start-up.
+        system.step(STEP);
+
+        auto const start = std::chrono::steady_clock::now();
+        for (int i = 0; i < STEP_COUNT; ++i) {
+            system.step(STEP);
+        }
+        std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+        return static_cast<double>(system.size()) * STEP_COUNT / elapsed.count();
+    }
+}    // namespace
+
+auto main() -> int {
+    auto const workers = static_cast<double>(utils::parallel::worker_count());
+
+    std::cout << PARTICLE_COUNT << " particles, " << STEP_COUNT << " steps, " << workers << " workers\n";
+
+    for (Integrator const integrator :
+         {Integrator::SemiImplicitEuler, Integrator::VelocityVerlet, Integrator::Rk4})
+    {
+        double const serial = measure(integrator, Execution::Serial);
+        double const parallel = measure(integrator, Execution::Parallel);
+
+        std::cout << integrator_name(integrator) << ": " << serial / 1e6 << " M particles/s per core serial, "
+                  << parallel / workers / 1e6 << " M particles/s per core parallel (" << parallel / 1e6
+                  << " M/s total)\n";
+    }
+
+    return 0;
+}
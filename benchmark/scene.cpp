@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/scene/graph.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using scene::graph::LocalTransform;
+    using scene::graph::Node;
+    using scene::graph::SceneGraph;
+
+    constexpr size_t NODE_COUNT = 500000;
+    constexpr size_t ROOT_COUNT = 8;
+    constexpr int REPEAT_COUNT = 20;
+
+    using Seconds = std::chrono::duration<double>;
+
+    template<typename Function>
+    auto seconds_per_run(Function&& function) -> double {
+        function();
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < REPEAT_COUNT; ++repeat) {
+            function();
+        }
+        return Seconds(std::chrono::steady_clock::now() - start).count() / REPEAT_COUNT;
+    }
+}    // namespace
+
+auto main() -> int {
+    utils::jobs::JobSystem& jobs = utils::jobs::global();
+
+    // A random recursive tree: every node hangs under an earlier one, so most subtrees are small.
+    SceneGraph graph;
+    std::vector<Node> nodes;
+    nodes.reserve(NODE_COUNT);
+    std::mt19937 random(7);
+    for (size_t i = 0; i < NODE_COUNT; ++i) {
+        LocalTransform local;
+        local.position = {1.0F, 0.0F, 0.0F};
+        local.rotation = mathematics::from_axis_angle({0.0F, 1.0F, 0.0F}, 0.01F);
+        Node const parent = i < ROOT_COUNT ? Node {} : nodes[random() % i];
+        nodes.push_back(graph.create(local, parent));
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    graph.update(jobs);
+    double const first = Seconds(std::chrono::steady_clock::now() - start).count();
+    std::cout << NODE_COUNT << " nodes, " << graph.depth() << " levels, " << jobs.thread_count()
+              << " threads\n";
+    std::cout << "  first update (layout and all nodes): " << first * 1e3 << " ms\n";
+
+    for (size_t const moved : {NODE_COUNT, NODE_COUNT / 100, NODE_COUNT / 10000, size_t {0}}) {
+        size_t updated = 0;
+        double const seconds = seconds_per_run(
+            [&]
+            {
+                for (size_t i = 0; i < moved; ++i) {
+                    graph.set_position(nodes[random() % NODE_COUNT], {1.0F, 0.0F, 0.0F});
+                }
+                graph.update(jobs);
+                updated = graph.updated();
+            });
+        std::cout << "  " << moved << " moved: " << updated << " updated, " << seconds * 1e3 << " ms, "
+                  << (updated == 0 ? 0.0 : seconds * 1e9 / static_cast<double>(updated))
+                  << " ns/updated node\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "domkrat3d/physics/dynamics.hpp"
+#include "domkrat3d/physics/particles.hpp"
+#include "domkrat3d/physics/snapshot.hpp"
+
+namespace {
+    using physics::dynamics::BodyDesc;
+    using physics::dynamics::World;
+    using physics::narrowphase::Shape;
+    using physics::particles::Emitter;
+    using physics::particles::ParticleSystem;
+    using physics::snapshot::Pool;
+    using physics::snapshot::SnapshotRing;
+
+    constexpr int FRAME_COUNT = 64;
+    constexpr size_t RING_CAPACITY = 64;
+    constexpr float STEP = 1.0F / 60.0F;
+
+    using Seconds = std::chrono::duration<double>;
+
+    // Bodies on a loose grid, falling freely: every body changes every step.
+    void build(World& world, size_t count) {
+        auto const side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+        for (size_t i = 0; i < count; ++i) {
+            BodyDesc box;
+            box.shape = Shape::box({0.4F, 0.4F, 0.4F});
+            box.transform.position = {
+                2.0F * static_cast<float>(i % side), 10.0F, 2.0F * static_cast<float>(i / side)};
+            world.create_body(box);
+        }
+    }
+
+    // Captures after every call of `advance`, then restores the newest and the oldest frame. Only
+    // the second round of the ring is timed, when the frame buffers are allocated.
+    template<typename Advance>
+    void measure(const char* name, const std::vector<Pool>& pools, Advance advance) {
+        SnapshotRing ring(RING_CAPACITY);
+        double capture_seconds = 0.0;
+        size_t packed = 0;
+
+        for (size_t frame = 0; frame < RING_CAPACITY; ++frame) {
+            advance();
+            ring.capture(pools);
+        }
+
+        for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+            advance();
+
+            auto const start = std::chrono::steady_clock::now();
+            uint64_t const captured = ring.capture(pools);
+            capture_seconds += Seconds(std::chrono::steady_clock::now() - start).count();
+            packed += ring.packed_bytes(captured);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        ring.restore(ring.last_frame(), pools);
+        double const newest = Seconds(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        ring.restore(ring.first_frame(), pools);
+        double const oldest = Seconds(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "  " << name << ": capture " << capture_seconds / FRAME_COUNT * 1e3 << " ms, "
+                  << static_cast<double>(ring.raw_bytes()) / 1024.0 << " KiB raw, "
+                  << static_cast<double>(packed) / FRAME_COUNT / 1024.0 << " KiB packed per frame, "
+                  << "restore newest " << newest * 1e3 << " ms, oldest " << oldest * 1e3 << " ms\n";
+    }
+}    // namespace
+
+auto main() -> int {
+    for (size_t const count : {10000U, 50000U}) {
+        std::cout << count << " bodies / particles\n";
+
+        World world;
+        build(world, count);
+        std::vector<Pool> pools;
+        world.pools(pools);
+
+        measure("bodies, all moving", pools, [&world]() { world.step(STEP); });
+        measure("bodies, unchanged", pools, []() {});
+
+        ParticleSystem particles(count);
+        Emitter emitter;
+        emitter.radius = 1.0F;
+        emitter.min_lifetime = 10.0F;
+        emitter.max_lifetime = 10.0F;
+        particles.emit(emitter, count);
+        pools.clear();
+        particles.pools(pools);
+
+        measure("particles, all moving", pools, [&particles]() { particles.step(STEP); });
+    }
+
+    return 0;
+}
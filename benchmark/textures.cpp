@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/assets/texture.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using assets::texture::Image;
+    using assets::texture::TextureFormat;
+    using utils::jobs::JobSystem;
+
+    constexpr uint32_t SIZE = 2048;
+    constexpr int REPEAT_COUNT = 3;
+
+    using Seconds = std::chrono::duration<double>;
+
+    // Smooth gradients with some high-frequency detail, closer to a photo than noise is.
+    auto make_image() -> Image {
+        Image image;
+        image.width = SIZE;
+        image.height = SIZE;
+        image.pixels.resize(size_t {SIZE} * SIZE * 4);
+        for (uint32_t y = 0; y < SIZE; ++y) {
+            for (uint32_t x = 0; x < SIZE; ++x) {
+                uint8_t* const texel = &image.pixels[(size_t {y} * SIZE + x) * 4];
+                float const fx = static_cast<float>(x);
+                float const fy = static_cast<float>(y);
+                texel[0] = static_cast<uint8_t>(127.0F + 127.0F * std::sin(fx * 0.01F + fy * 0.003F));
+                texel[1] = static_cast<uint8_t>(127.0F + 127.0F * std::cos(fy * 0.013F));
+                texel[2] = static_cast<uint8_t>((x * 3 + y * 5) & 0xFFU);
+                texel[3] = static_cast<uint8_t>(255 - ((x ^ y) & 0x3FU));
+            }
+        }
+        return image;
+    }
+
+    template<typename Function>
+    auto seconds_per_run(Function&& function) -> double {
+        auto const start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < REPEAT_COUNT; ++repeat) {
+            function();
+        }
+        return Seconds(std::chrono::steady_clock::now() - start).count() / REPEAT_COUNT;
+    }
+}    // namespace
+
+auto main() -> int {
+    size_t const cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    Image const image = make_image();
+    double const megatexels = static_cast<double>(SIZE) * SIZE / 1e6;
+
+    std::cout << SIZE << "x" << SIZE << " RGBA8 (" << image.pixels.size() << " bytes), " << cores
+              << " cores\n";
+
+    for (size_t threads = 1; threads <= cores; threads *= 2) {
+        JobSystem system(threads);
+        std::cout << "  " << threads << " threads:";
+
+        double const mips = seconds_per_run(
+            [&image, &system]
+            { assets::texture::generate_mips(image, true, assets::texture::MipFilter::Kaiser, system); });
+        std::cout << " Kaiser mips " << mips * 1e3 << " ms";
+
+        for (TextureFormat const format : {TextureFormat::BC1, TextureFormat::BC7}) {
+            double const seconds = seconds_per_run(
+                [&image, &system, format] { assets::texture::compress(image, format, 128, system); });
+            std::cout << ", " << (format == TextureFormat::BC1 ? "BC1 " : "BC7 ") << megatexels / seconds
+                      << " Mtexel/s";
+        }
+        std::cout << "\n";
+    }
+
+    // Memory and upload bandwidth of the largest level.
+    std::cout << "  level bytes: RGBA8 " << image.pixels.size() << ", BC7 "
+              << assets::texture::level_size(TextureFormat::BC7, SIZE, SIZE) << ", BC1 "
+              << assets::texture::level_size(TextureFormat::BC1, SIZE, SIZE) << "\n";
+
+    return 0;
+}
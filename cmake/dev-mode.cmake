@@ -7,6 +7,16 @@ endif()
 
 add_subdirectory(examples)
 
+option(BUILD_BENCHMARKS "Build the benchmark executables" ON)
+if(BUILD_BENCHMARKS)
+  add_subdirectory(benchmark)
+endif()
+
+option(BUILD_TOOLS "Build the asset tools" ON)
+if(BUILD_TOOLS)
+  add_subdirectory(tools)
+endif()
+
 option(BUILD_MCSS_DOCS "Build documentation using Doxygen and m.css" OFF)
 if(BUILD_MCSS_DOCS)
   include(cmake/docs.cmake)
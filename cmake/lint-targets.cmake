@@ -4,6 +4,7 @@ set(
     include/*.hpp
     test/*.cpp test/*.hpp
     examples/*.cpp examples/*.hpp
+    benchmark/*.cpp benchmark/*.hpp
     CACHE STRING
     "; separated patterns relative to the project source dir to format"
 )
@@ -13,6 +13,7 @@ default(
     include/*.hpp
     test/*.cpp test/*.hpp
     examples/*.cpp examples/*.hpp
+    benchmark/*.cpp benchmark/*.hpp
 )
 default(FIX NO)
 
@@ -1,5 +1,6 @@
 #include <array>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
@@ -12,7 +13,10 @@
 auto main() -> int {
     LOG_TRACE
 
-    SimpleBasicApplication application;
+    // DOMKRAT3D_HEADLESS renders offscreen instead of opening a window, e.g. on machines without a display.
+    HeadlessOptions headless;
+    headless.enabled = std::getenv("DOMKRAT3D_HEADLESS") != nullptr;
+    SimpleBasicApplication application(headless);
 
     open_application(&application);
 
@@ -0,0 +1,240 @@
+/**
+ * @file
+ * @brief Packed asset archive opened with a memory mapping
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief	   Namespace of asset storage
+ *
+ * An archive is one file: a header, a hash table of contents, the names of
+ * the assets and then the blobs, each starting on a 4 KB boundary. Opening
+ * maps the file and checks the header and the table; nothing is read or
+ * parsed beyond that. A blob is used where it lies in the mapping, so the
+ * operating system pages it in on first touch, shares it between processes
+ * and drops it under memory pressure without writing it anywhere. Cooked
+ * data (meshes, textures, shaders) is stored in the layout it is used in,
+ * so it is read in place or copied once straight into a GPU staging buffer.
+ *
+ * All fields are little-endian.
+ */
+namespace assets {
+
+    /**
+     * @brief	   Alignment of blobs in the file and thus in memory, one page
+     */
+    constexpr size_t BLOB_ALIGNMENT = 4096;
+
+    /**
+     * @brief	   "DK3DPAK" and a zero byte, read as a little-endian integer
+     */
+    constexpr uint64_t ARCHIVE_MAGIC = 0x004B415044334B44ULL;
+
+    constexpr uint32_t ARCHIVE_VERSION = 1;
+
+    /**
+     * @brief	   Kind of data of a blob
+     */
+    enum class AssetType : uint32_t
+    {
+        Raw,
+        Mesh,
+        Texture,
+        Shader
+    };
+
+    /**
+     * @brief	   Start of an archive file
+     */
+    struct ArchiveHeader {
+        uint64_t magic = ARCHIVE_MAGIC;
+        uint32_t version = ARCHIVE_VERSION;
+        uint32_t entry_count = 0;
+
+        /**
+         * @brief	   Slots of the table of contents, a power of two at least twice entry_count
+         */
+        uint32_t slot_count = 0;
+        uint32_t reserved = 0;
+        uint64_t table_offset = 0;
+        uint64_t names_offset = 0;
+        uint64_t names_size = 0;
+        uint64_t file_size = 0;
+    };
+
+    /**
+     * @brief	   Slot of the table of contents; a slot with hash 0 is empty
+     *
+     * The table is open addressing with linear probing on hash_name().
+     */
+    struct ArchiveEntry {
+        uint64_t hash = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t name_offset = 0;
+        uint32_t name_size = 0;
+        AssetType type = AssetType::Raw;
+        uint32_t reserved = 0;
+    };
+
+    static_assert(sizeof(ArchiveHeader) == 56 && sizeof(ArchiveEntry) == 40, "archive layout changed");
+
+    /**
+     * @brief	   64-bit FNV-1a hash of an asset name, never 0
+     */
+    auto hash_name(std::string_view name) -> uint64_t;
+
+    /**
+     * @brief	   Asset in a mapped archive; empty when not found
+     */
+    struct Blob {
+        std::string_view name;
+        AssetType type = AssetType::Raw;
+        const std::byte* data = nullptr;
+        size_t size = 0;
+
+        explicit operator bool() const { return data != nullptr; }
+
+        /**
+         * @brief	   The blob as an array of `T`, without copying; blobs are aligned to BLOB_ALIGNMENT
+         */
+        template<typename T>
+        auto as() const -> const T* {
+            static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= BLOB_ALIGNMENT,
+                          "blobs hold plain data");
+            return reinterpret_cast<const T*>(data);
+        }
+
+        template<typename T>
+        auto count() const -> size_t {
+            return size / sizeof(T);
+        }
+    };
+
+    /**
+     * @brief	   Read-only memory mapping of an archive file
+     *
+     * Blobs point into the mapping and stay valid as long as the archive.
+     * Lookups may run on any number of threads at once.
+     */
+    class Archive {
+      public:
+        /**
+         * @brief	   Map an archive file
+         *
+         * @throw	   std::runtime_error when the file cannot be mapped or is not a valid archive
+         */
+        explicit Archive(const std::string& path);
+
+        ~Archive();
+
+        Archive(Archive&& other) noexcept;
+        auto operator=(Archive&& other) noexcept -> Archive&;
+
+        Archive(const Archive&) = delete;
+        auto operator=(const Archive&) -> Archive& = delete;
+
+        /**
+         * @brief	   Asset of a name; an empty blob when there is none
+         */
+        auto find(std::string_view name) const -> Blob;
+
+        /**
+         * @brief	   Ask the system to start reading a blob in the background, ahead of its use
+         */
+        void prefetch(const Blob& blob) const;
+
+        /**
+         * @brief	   Call a function with every blob, in file order
+         */
+        template<typename Function>
+        void each(Function&& function) const {
+            for (uint32_t slot : m_order) {
+                function(blob(entries()[slot]));
+            }
+        }
+
+        auto size() const -> size_t { return header().entry_count; }
+
+        /**
+         * @brief	   Bytes of the mapped file
+         */
+        auto file_size() const -> size_t { return m_size; }
+
+      private:
+        auto header() const -> const ArchiveHeader& {
+            return *reinterpret_cast<const ArchiveHeader*>(m_data);
+        }
+
+        auto entries() const -> const ArchiveEntry* {
+            return reinterpret_cast<const ArchiveEntry*>(m_data + header().table_offset);
+        }
+
+        auto blob(const ArchiveEntry& entry) const -> Blob;
+        void validate();
+        void unmap();
+
+        const std::byte* m_data = nullptr;
+        size_t m_size = 0;
+        std::vector<uint32_t> m_order;
+    };
+
+    /**
+     * @brief	   Builds an archive file
+     *
+     * Assets added from files are only read by write(), which streams them
+     * into the archive, so packing does not hold all assets in memory.
+     */
+    class ArchiveWriter {
+      public:
+        /**
+         * @brief	   Add an asset
+         *
+         * @throw	   std::invalid_argument when the name is empty or already added
+         */
+        void add(std::string name, AssetType type, std::vector<std::byte> data);
+
+        /**
+         * @brief	   Add the contents of a file as an asset
+         *
+         * @throw	   std::invalid_argument when the name is empty or already added
+         * @throw	   std::runtime_error when the file does not exist
+         */
+        void add_file(std::string name, AssetType type, const std::string& path);
+
+        auto size() const -> size_t { return m_assets.size(); }
+
+        /**
+         * @brief	   Write the archive
+         *
+         * @return	   the bytes written
+         *
+         * @throw	   std::runtime_error when an added file cannot be read or the archive cannot be written
+         */
+        auto write(const std::string& path) const -> size_t;
+
+      private:
+        struct Asset {
+            std::string name;
+            AssetType type;
+            std::vector<std::byte> data;
+            std::string path;
+            uint64_t size;
+        };
+
+        void add_name(const std::string& name);
+
+        std::vector<Asset> m_assets;
+        std::unordered_set<std::string> m_names;
+    };
+}    // namespace assets
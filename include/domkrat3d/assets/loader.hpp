@@ -0,0 +1,195 @@
+/**
+ * @file
+ * @brief Asynchronous asset loader with priorities and a resident cache
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace assets {
+
+    /**
+     * @brief	   Contents of a loaded file, shared by everyone who asked for it
+     */
+    using AssetData = std::shared_ptr<const std::vector<std::byte>>;
+
+    /**
+     * @brief	   Identifier of a load request; 0 is never used
+     */
+    using LoadId = uint64_t;
+
+    /**
+     * @brief	   Order in which queued loads are started, most urgent first
+     */
+    enum class LoadPriority : uint8_t
+    {
+        Critical,
+        High,
+        Normal,
+        Low
+    };
+
+    /**
+     * @brief	   Outcome of a load request
+     */
+    enum class LoadStatus : uint8_t
+    {
+        Loaded,
+        Failed
+    };
+
+    /**
+     * @brief	   Completion callback of a load; runs on the job system
+     */
+    using LoadCallback = std::function<void(LoadStatus status, const AssetData& data)>;
+
+    /**
+     * @brief	   Loader settings
+     *
+     *	+ memory_budget - bytes of loaded files kept resident; the least recently used go first
+     *	+ queue_depth - reads in flight at once
+     *	+ use_io_uring - read through io_uring where the kernel allows it; Linux only
+     *	+ fallback_threads - threads with blocking reads when io_uring is not used
+     */
+    struct LoaderSettings {
+        size_t memory_budget = size_t {256} << 20U;
+        uint32_t queue_depth = 256;
+        bool use_io_uring = true;
+        size_t fallback_threads = 4;
+    };
+
+    /**
+     * @brief	   Loads files in the background and keeps them resident within a budget
+     *
+     * Requests go to a priority queue. On Linux one I/O thread keeps up to
+     * queue_depth reads in flight through io_uring; without it, and on other
+     * systems, a few threads read with blocking positional reads. Requests for a file that is already queued or being
+     * read join that load instead of reading it again, and take it to the
+     * higher of the two priorities. A finished file enters the resident
+     * cache, and every request gets its callback as a job; a file already
+     * resident is handed out without any I/O.
+     *
+     * Eviction only drops the loader's reference: data handed out stays
+     * valid for as long as the caller keeps it.
+     */
+    class AssetLoader {
+      public:
+        /**
+         * @brief	   Start the I/O threads
+         *
+         * @param[in]  jobs		 The job system that runs the callbacks
+         * @param[in]  settings	 The settings
+         */
+        explicit AssetLoader(utils::jobs::JobSystem& jobs, const LoaderSettings& settings = {});
+
+        /**
+         * @brief	   Drop queued requests, finish the reads in flight and wait for all callbacks
+         */
+        ~AssetLoader();
+
+        AssetLoader(const AssetLoader&) = delete;
+        auto operator=(const AssetLoader&) -> AssetLoader& = delete;
+
+        /**
+         * @brief	   Request a file
+         *
+         * @param[in]  path		 The file
+         * @param[in]  priority	 The priority
+         * @param[in]  callback	 The callback, run once unless the request is cancelled
+         *
+         * @return	   identifier of the request
+         */
+        auto load(const std::string& path, LoadPriority priority, LoadCallback callback) -> LoadId;
+
+        /**
+         * @brief	   Cancel a request whose callback has not been scheduled yet
+         *
+         * The read of a file nobody waits for any more is dropped if it did
+         * not start; a read in flight finishes into the resident cache.
+         *
+         * @return	   whether the request was cancelled
+         */
+        auto cancel(LoadId id) -> bool;
+
+        /**
+         * @brief	   Resident contents of a file, nullptr when not resident; counts as a use
+         */
+        auto find(const std::string& path) -> AssetData;
+
+        /**
+         * @brief	   Bytes of resident files
+         */
+        auto resident_bytes() const -> size_t;
+
+        /**
+         * @brief	   Requests whose callback was not scheduled yet
+         */
+        auto pending() const -> size_t;
+
+        /**
+         * @brief	   Whether reads go through io_uring rather than the fallback threads
+         */
+        auto uses_io_uring() const -> bool { return m_ring != nullptr; }
+
+      private:
+        struct Request;
+        struct Load;
+        struct Ring;
+
+        // Entry of the priority queue; stale once the load of the path has another sequence.
+        struct QueueEntry {
+            LoadPriority priority;
+            uint64_t sequence;
+            std::string path;
+        };
+
+        struct Resident {
+            std::string path;
+            AssetData data;
+        };
+
+        void run_ring();
+        void run_fallback();
+        auto next_load() -> Load*;
+        void finish(Load* load, bool loaded);
+        void evict();
+        void schedule(std::vector<std::unique_ptr<Request>>& requests);
+        void reclaim();
+
+        static void run_callback(const utils::jobs::Job& job);
+
+        utils::jobs::JobSystem& m_jobs;
+        LoaderSettings m_settings;
+        std::unique_ptr<Ring> m_ring;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stop = false;
+        LoadId m_next_id = 1;
+        uint64_t m_next_sequence = 0;
+        std::vector<QueueEntry> m_queue;
+        std::unordered_map<std::string, std::unique_ptr<Load>> m_loads;
+        std::unordered_map<LoadId, Request*> m_requests;
+        std::vector<std::unique_ptr<Request>> m_scheduled;
+
+        std::list<Resident> m_resident;
+        std::unordered_map<std::string, std::list<Resident>::iterator> m_resident_index;
+        size_t m_resident_bytes = 0;
+
+        std::vector<std::thread> m_threads;
+    };
+}    // namespace assets
@@ -0,0 +1,157 @@
+/**
+ * @file
+ * @brief Mesh import, optimization and the cooked GPU layout
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "domkrat3d/mathematics/vector.hpp"
+
+/**
+ * @brief	   Namespace of meshes (assets)
+ *
+ * Meshes are cooked offline: imported as plain triangle lists, welded,
+ * reordered for the post-transform vertex cache and then for vertex fetch,
+ * and finally quantized into 16-byte vertices. A cooked mesh is one blob
+ * (a header, the vertices, the indices) that is drawn straight from an
+ * archive mapping or copied as is into GPU buffers.
+ */
+namespace assets::mesh {
+    using mathematics::Vec3;
+
+    /**
+     * @brief	   "DKMS" read as a little-endian integer
+     */
+    constexpr uint32_t MESH_MAGIC = 0x534D4B44U;
+
+    constexpr uint32_t MESH_VERSION = 1;
+
+    /**
+     * @brief	   Full precision vertex of the import and optimization steps
+     */
+    struct Vertex {
+        Vec3 position;
+        Vec3 normal;
+        float u = 0.0F;
+        float v = 0.0F;
+    };
+
+    /**
+     * @brief	   Indexed triangle list
+     */
+    struct Mesh {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    /**
+     * @brief	   Cooked vertex, 16 bytes
+     *
+     *	+ position - unorm16 within the bounds of the mesh, see MeshHeader
+     *	+ normal - octahedral encoding as snorm16
+     *	+ uv - half floats
+     */
+    struct PackedVertex {
+        uint16_t position[3];
+        uint16_t padding;
+        int16_t normal[2];
+        uint16_t uv[2];
+    };
+
+    /**
+     * @brief	   Start of a cooked mesh blob, followed by the vertices and then the indices
+     *
+     * A position decodes as `position_offset + position * position_scale`.
+     * Indices are 16-bit when the mesh has at most 65535 vertices, 32-bit
+     * otherwise.
+     */
+    struct MeshHeader {
+        uint32_t magic = MESH_MAGIC;
+        uint32_t version = MESH_VERSION;
+        uint32_t vertex_count = 0;
+        uint32_t index_count = 0;
+        uint32_t index_size = 0;
+        uint32_t vertex_stride = sizeof(PackedVertex);
+        float position_offset[3] = {};
+        float position_scale[3] = {};
+    };
+
+    static_assert(sizeof(PackedVertex) == 16 && sizeof(MeshHeader) == 48, "cooked mesh layout changed");
+
+    /**
+     * @brief	   Read a model file: Wavefront OBJ, glTF 2.0 (.gltf) or binary glTF (.glb)
+     *
+     * All triangles of the file become one mesh: glTF meshes are placed by
+     * the nodes of the default scene. Faces without normals get smooth (OBJ)
+     * or flat (glTF) normals.
+     *
+     * @throw	   std::runtime_error when the file cannot be read or parsed
+     */
+    auto import_mesh(const std::string& path) -> Mesh;
+
+    /**
+     * @brief	   Merge identical vertices
+     */
+    void weld(Mesh& mesh);
+
+    /**
+     * @brief	   Reorder triangles for the post-transform vertex cache (Forsyth's linear-speed method)
+     */
+    void optimize_vertex_cache(Mesh& mesh);
+
+    /**
+     * @brief	   Reorder vertices by first use in the index buffer; drops unused vertices
+     */
+    void optimize_vertex_fetch(Mesh& mesh);
+
+    /**
+     * @brief	   Vertex shader runs per triangle with a FIFO cache (ACMR); 3 is no reuse, 0.5 is ideal
+     */
+    auto cache_miss_ratio(const Mesh& mesh, size_t cache_size = 16) -> float;
+
+    /**
+     * @brief	   Quantize a mesh into a cooked blob
+     */
+    auto cook(const Mesh& mesh) -> std::vector<std::byte>;
+
+    /**
+     * @brief	   View of a cooked blob in place; empty when the blob is not a valid cooked mesh
+     */
+    struct CookedMesh {
+        const MeshHeader* header = nullptr;
+        const PackedVertex* vertices = nullptr;
+        const std::byte* indices = nullptr;
+
+        explicit operator bool() const { return header != nullptr; }
+
+        auto index(size_t i) const -> uint32_t;
+        auto position(size_t i) const -> Vec3;
+        auto normal(size_t i) const -> Vec3;
+        void uv(size_t i, float& u, float& v) const;
+    };
+
+    /**
+     * @brief	   View a cooked blob; it must be 4-byte aligned, as archive blobs are
+     */
+    auto read_cooked(const std::byte* data, size_t size) -> CookedMesh;
+
+    /**
+     * @brief	   IEEE half float of a float, rounded to nearest even
+     */
+    auto float_to_half(float value) -> uint16_t;
+
+    auto half_to_float(uint16_t value) -> float;
+
+    /**
+     * @brief	   Octahedral encoding of a unit vector as two snorm16 values
+     */
+    void encode_octahedral(Vec3 normal, int16_t encoded[2]);
+
+    auto decode_octahedral(const int16_t encoded[2]) -> Vec3;
+}    // namespace assets::mesh
@@ -0,0 +1,200 @@
+/**
+ * @file
+ * @brief Texture decoding, mip chains and block compression
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+
+/**
+ * @brief	   Namespace of textures (assets)
+ *
+ * Textures are cooked offline, or at load time when a cooked version is
+ * missing: the image is decoded to RGBA8, a mip chain is filtered in
+ * linear light, and every level is block compressed. Filtering runs over
+ * rows and compression over tiles of blocks on the job system. A cooked
+ * texture is one blob (a header with the offset of every level, then the
+ * levels) that is uploaded as is.
+ */
+namespace assets::texture {
+
+    /**
+     * @brief	   "DKTX" read as a little-endian integer
+     */
+    constexpr uint32_t TEXTURE_MAGIC = 0x58544B44U;
+
+    constexpr uint32_t TEXTURE_VERSION = 1;
+
+    /**
+     * @brief	   Most levels of a chain, enough for 32768 x 32768
+     */
+    constexpr uint32_t MAX_MIP_LEVELS = 16;
+
+    /**
+     * @brief	   Storage of the texels of a level
+     *
+     *	+ RGBA8 - 4 bytes per texel, no compression
+     *	+ BC1 - RGB with 1-bit alpha, 8 bytes per 4x4 block
+     *	+ BC3 - RGBA, BC1 colour and a BC4 alpha, 16 bytes per block
+     *	+ BC5 - two channels (RG, e.g. normal maps), 16 bytes per block
+     *	+ BC7 - RGBA, 16 bytes per block
+     */
+    enum class TextureFormat : uint32_t
+    {
+        RGBA8,
+        BC1,
+        BC3,
+        BC5,
+        BC7
+    };
+
+    /**
+     * @brief	   Downsampling filter of a mip chain
+     *
+     *	+ Box - average of 2x2 texels; fast, slightly blurry
+     *	+ Kaiser - Kaiser-windowed sinc reaching 3 texels of the smaller level each way; sharper
+     */
+    enum class MipFilter : uint8_t
+    {
+        Box,
+        Kaiser
+    };
+
+    /**
+     * @brief	   Decoded image, RGBA8 rows from the top
+     */
+    struct Image {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    /**
+     * @brief	   Cooking settings
+     *
+     *	+ format - storage of every level
+     *	+ srgb - colour channels hold sRGB values, filtered in linear light; alpha is always linear
+     *	+ mipmaps - build the full chain down to 1x1
+     *	+ filter - downsampling filter
+     *	+ tile_size - texels per side of a compression job, a multiple of 4
+     */
+    struct TextureSettings {
+        TextureFormat format = TextureFormat::BC7;
+        bool srgb = true;
+        bool mipmaps = true;
+        MipFilter filter = MipFilter::Kaiser;
+        uint32_t tile_size = 128;
+    };
+
+    /**
+     * @brief	   Start of a cooked texture blob; levels follow, largest first, each 16-byte aligned
+     */
+    struct TextureHeader {
+        uint32_t magic = TEXTURE_MAGIC;
+        uint32_t version = TEXTURE_VERSION;
+        TextureFormat format = TextureFormat::RGBA8;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mip_count = 0;
+        uint32_t srgb = 0;
+        uint32_t padding = 0;
+        uint32_t offsets[MAX_MIP_LEVELS] = {};
+    };
+
+    static_assert(sizeof(TextureHeader) == 96, "cooked texture layout changed");
+
+    /**
+     * @brief	   Decode a Truevision TGA (true colour or greyscale, plain or RLE) or a binary PNM/PAM image
+     *
+     * @throw	   std::runtime_error when the data is not an image of these formats
+     */
+    auto decode_image(const std::byte* data, size_t size) -> Image;
+
+    /**
+     * @brief	   decode_image() of a file
+     *
+     * @throw	   std::runtime_error when the file cannot be read or decoded
+     */
+    auto load_image(const std::string& path) -> Image;
+
+    /**
+     * @brief	   The mip chain of an image, the image itself first
+     *
+     * @param[in]  image	The image
+     * @param[in]  srgb		Filter colour channels in linear light
+     * @param[in]  filter	The downsampling filter
+     * @param[in]  jobs		The job system that filters rows
+     */
+    auto generate_mips(const Image& image, bool srgb, MipFilter filter, utils::jobs::JobSystem& jobs)
+        -> std::vector<Image>;
+
+    /**
+     * @brief	   Bytes of a level of the given size
+     */
+    auto level_size(TextureFormat format, uint32_t width, uint32_t height) -> size_t;
+
+    /**
+     * @brief	   Encode an image, tile by tile on the job system
+     *
+     * @param[in]  image	 The image
+     * @param[in]  format	 The format
+     * @param[in]  tile_size Texels per side of a job
+     * @param[in]  jobs		 The job system
+     *
+     * @return	   level_size() bytes; edge blocks repeat the last row and column
+     */
+    auto compress(const Image& image, TextureFormat format, uint32_t tile_size, utils::jobs::JobSystem& jobs)
+        -> std::vector<std::byte>;
+
+    /**
+     * @brief	   Encode one 4x4 block of RGBA8 texels (64 bytes, rows from the top)
+     */
+    void encode_block(TextureFormat format, const uint8_t texels[64], std::byte* block);
+
+    /**
+     * @brief	   Decode one block into 4x4 RGBA8 texels; BC5 gives R, G, 0, 255
+     *
+     * BC7 blocks are decoded in mode 6 only, the one encode_block() writes.
+     */
+    void decode_block(TextureFormat format, const std::byte* block, uint8_t texels[64]);
+
+    /**
+     * @brief	   Mips, compression and the header of an image: a cooked blob
+     */
+    auto cook(const Image& image, const TextureSettings& settings, utils::jobs::JobSystem& jobs)
+        -> std::vector<std::byte>;
+
+    /**
+     * @brief	   Level of a cooked texture
+     */
+    struct Level {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        const std::byte* data = nullptr;
+        size_t size = 0;
+    };
+
+    /**
+     * @brief	   View of a cooked blob in place; empty when the blob is not a valid cooked texture
+     */
+    struct CookedTexture {
+        const TextureHeader* header = nullptr;
+        const std::byte* data = nullptr;
+
+        explicit operator bool() const { return header != nullptr; }
+
+        auto level(uint32_t mip) const -> Level;
+    };
+
+    /**
+     * @brief	   View a cooked blob; it must be 4-byte aligned, as archive blobs are
+     */
+    auto read_texture(const std::byte* data, size_t size) -> CookedTexture;
+}    // namespace assets::texture
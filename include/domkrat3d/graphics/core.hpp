@@ -34,7 +34,7 @@ void init_glfw(bool resizable = false);
 void terminate_window(GLFWwindow* window);
 
 /**
- * @brief Poll events if GLFW Window is not closed.
+ * @brief Wait for events on this thread and run frames on a game thread until the window is closed.
  */
 void poll_events_if_window_open(GLFWwindow* window, int width, int height);
 
@@ -0,0 +1,175 @@
+/**
+ * @file
+ * @brief Input events queued from GLFW callbacks
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "domkrat3d/utils/ring.hpp"
+
+struct GLFWwindow;
+
+/**
+ * @brief	   Namespace of window input
+ *
+ * The thread that owns the window only waits for events: GLFW calls the
+ * callbacks installed by InputQueue::attach() from there, and they put
+ * timestamped events into a lock-free ring. The game thread takes them out
+ * in batches once per frame, so reading input never waits for the window
+ * thread and the window thread never waits for a frame.
+ */
+namespace graphics::input {
+
+    /**
+     * @brief	   Kind of an input event
+     */
+    enum class EventType : uint8_t
+    {
+        Key,
+        MouseButton,
+        CursorMove,
+        Scroll,
+        Resize
+    };
+
+    /**
+     * @brief	   Input event
+     *
+     * `code`, `action` and `mods` are the GLFW key or button, GLFW_PRESS,
+     * GLFW_RELEASE or GLFW_REPEAT and the modifier bits. `x` and `y` are the
+     * cursor position, the scroll offset or the new framebuffer size.
+     */
+    struct Event {
+        EventType type = EventType::Key;
+        int32_t code = 0;
+        int32_t action = 0;
+        int32_t mods = 0;
+        double x = 0.0;
+        double y = 0.0;
+
+        /**
+         * @brief	   Steady clock time the callback ran, in nanoseconds
+         */
+        int64_t timestamp = 0;
+    };
+
+    /**
+     * @brief	   Time from the callbacks to the consumer, in milliseconds, over the events of the last drain()
+     */
+    struct InputLatency {
+        size_t events = 0;
+        double mean = 0.0;
+        double max = 0.0;
+    };
+
+    /**
+     * @brief	   Input events of one window, from its thread to one consumer thread
+     */
+    class InputQueue {
+      public:
+        /**
+         * @brief	   Events the ring holds; a window thread further ahead than that drops events
+         */
+        static constexpr size_t CAPACITY = 1024;
+
+        InputQueue() = default;
+
+        ~InputQueue();
+
+        InputQueue(const InputQueue&) = delete;
+        auto operator=(const InputQueue&) -> InputQueue& = delete;
+
+        /**
+         * @brief	   Install the callbacks of a window; call from the thread that owns it
+         *
+         * The queue takes the user pointer of the window. Detach the queue,
+         * or destroy it, before the window is destroyed.
+         */
+        void attach(GLFWwindow* window);
+
+        /**
+         * @brief	   Remove the callbacks installed by attach()
+         */
+        void detach();
+
+        /**
+         * @brief	   Queue an event stamped with the current time; window thread only
+         */
+        void push(Event event) {
+            event.timestamp = timestamp();
+            if (!m_events.push(event)) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief	   Call a function with every queued event, oldest first; consumer thread only
+         *
+         * @return	   the number of events
+         */
+        template<typename Function>
+        auto drain(Function&& function) -> size_t {
+            // Only what was queued before the drain started, so a busy window thread cannot keep it going.
+            size_t limit = m_events.size();
+            int64_t const now = timestamp();
+            Event batch[BATCH_SIZE];
+            size_t total = 0;
+            double sum = 0.0;
+            double max = 0.0;
+
+            while (limit > 0) {
+                size_t const count = m_events.pop(batch, std::min(limit, BATCH_SIZE));
+                if (count == 0) {
+                    break;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    double const latency = static_cast<double>(now - batch[i].timestamp) * 1e-6;
+                    sum += latency;
+                    max = std::max(max, latency);
+                    function(static_cast<const Event&>(batch[i]));
+                }
+                total += count;
+                limit -= count;
+            }
+
+            if (total > 0) {
+                m_latency = {total, sum / static_cast<double>(total), max};
+            }
+            return total;
+        }
+
+        /**
+         * @brief	   Latency of the events of the last drain() that had any
+         */
+        auto latency() const -> const InputLatency& { return m_latency; }
+
+        /**
+         * @brief	   Events lost because the ring was full
+         */
+        auto dropped() const -> size_t { return m_dropped.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief	   Current steady clock time in nanoseconds, the clock of Event::timestamp
+         */
+        static auto timestamp() -> int64_t {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+      private:
+        static constexpr size_t BATCH_SIZE = 64;
+
+        utils::ring::SpscRing<Event, CAPACITY> m_events;
+        std::atomic<size_t> m_dropped {0};
+        InputLatency m_latency;
+        GLFWwindow* m_window = nullptr;
+    };
+}    // namespace graphics::input
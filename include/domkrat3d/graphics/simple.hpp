@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #include <vulkan/vulkan_core.h>
@@ -13,15 +14,54 @@
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan.h>
 
+/**
+ * @brief Headless mode options
+ *
+ *	+ enabled - run without a window or surface, rendering into an offscreen image
+ *	+ frame_count - frames to render before run() returns
+ *	+ read_back - copy the last frame to host memory, see SimpleBasicApplication::frame()
+ **/
+struct HeadlessOptions {
+    bool enabled = false;
+    uint32_t frame_count = 1;
+    bool read_back = false;
+};
+
 class SimpleBasicApplication {
   public:
     const int WIDTH = 800;
     const int HEIGHT = 600;
     const char* TITLE = "SimpleBasicApplication";
+
+    /**
+     * @brief Color every frame is cleared to, RGBA
+     **/
+    static constexpr VkClearColorValue CLEAR_COLOR = {{0.1F, 0.1F, 0.12F, 1.0F}};
     static std::string DebugIndent;
 
+    SimpleBasicApplication() = default;
+
+    /**
+     * @brief Create an application, headless when the options say so
+     *
+     * Headless mode needs no display: the instance has no surface extensions, and frames are rendered
+     * into an offscreen image on any device with a graphics queue, software ICDs such as lavapipe
+     * included.
+     *
+     * @param options headless mode options
+     **/
+    explicit SimpleBasicApplication(const HeadlessOptions& options);
+
     void run();
 
+    /**
+     * @brief Last frame read back in headless mode
+     *
+     * @return const std::vector<uint8_t>& WIDTH x HEIGHT RGBA8 pixels, rows from the top; empty unless
+     * read_back is set and run() has rendered
+     **/
+    auto frame() const -> const std::vector<uint8_t>& { return frame_pixels; }
+
     /**
      * @brief VKAPI debug callback
      *
@@ -38,10 +78,28 @@ class SimpleBasicApplication {
                    void* p_user_data) -> VkBool32;
 
   private:
-    GLFWwindow* window;
+    HeadlessOptions headless;
+    GLFWwindow* window = nullptr;
     VkInstance instance;
     VkDebugUtilsMessengerEXT debug_messenger;
 
+    // Offscreen target of headless mode.
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue graphics_queue = VK_NULL_HANDLE;
+    uint32_t graphics_queue_family = 0;
+    VkImage color_image = VK_NULL_HANDLE;
+    VkDeviceMemory color_memory = VK_NULL_HANDLE;
+    VkImageView color_view = VK_NULL_HANDLE;
+    VkRenderPass render_pass = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VkBuffer readback_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory readback_memory = VK_NULL_HANDLE;
+    VkCommandPool command_pool = VK_NULL_HANDLE;
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    VkFence frame_fence = VK_NULL_HANDLE;
+    std::vector<uint8_t> frame_pixels;
+
     /**
      * @brief Check validation layers support
      *
@@ -99,6 +157,41 @@ class SimpleBasicApplication {
      *
      **/
     void create_instance();
+
+    /**
+     * @brief Pick a physical device with a graphics queue and create the logical device
+     *
+     **/
+    void create_device();
+
+    /**
+     * @brief Create the offscreen color image, its render pass and framebuffer, and the readback buffer
+     *
+     **/
+    void create_offscreen_target();
+
+    /**
+     * @brief Create the command pool, command buffer and frame fence
+     *
+     **/
+    void create_commands();
+
+    /**
+     * @brief Find a memory type
+     *
+     * @param type_bits memory types allowed by the resource
+     * @param properties required memory properties
+     * @return uint32_t memory type index
+     **/
+    auto find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties) -> uint32_t;
+
+    /**
+     * @brief Record, submit and wait for one offscreen frame
+     *
+     * @param frame_index frame number, starting at 0
+     * @param read_back copy the frame to the readback buffer
+     **/
+    void render_offscreen_frame(uint32_t frame_index, bool read_back);
 };
 
 /**
@@ -0,0 +1,140 @@
+/**
+ * @file
+ * @brief Geometric primitives for spatial queries
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <limits>
+
+#include "domkrat3d/mathematics/vector.hpp"
+
+/**
+ * @brief Namespace of geometric primitives (mathematics)
+ */
+namespace mathematics::geometry {
+
+    /**
+     * @brief Axis-aligned bounding box, min <= max on every axis
+     */
+    struct Aabb {
+        Vec3 min;
+        Vec3 max;
+    };
+
+    /**
+     * @brief Half-line origin + t * direction for t in [0, max_distance]
+     *
+     * The direction does not need to be normalized; distances returned by the
+     * intersection functions are in units of its length.
+     */
+    struct Ray {
+        Vec3 origin;
+        Vec3 direction;
+        float max_distance = std::numeric_limits<float>::infinity();
+    };
+
+    /**
+     * @brief Plane dot(normal, p) + distance == 0; points on the side the normal points to are in front
+     */
+    struct Plane {
+        Vec3 normal;
+        float distance = 0.0F;
+    };
+
+    /**
+     * @brief	   Distance of a point in front of a plane with a unit normal (negative behind)
+     */
+    inline auto signed_distance(const Plane& plane, Vec3 point) -> float {
+        return dot(plane.normal, point) + plane.distance;
+    }
+
+    /**
+     * @brief	   Whether two boxes intersect (touching counts as overlap)
+     */
+    inline auto overlaps(const Aabb& a, const Aabb& b) -> bool {
+        return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y
+            && a.min.z <= b.max.z && b.min.z <= a.max.z;
+    }
+
+    /**
+     * @brief	   Whether a contains b entirely
+     */
+    inline auto contains(const Aabb& a, const Aabb& b) -> bool {
+        return a.min.x <= b.min.x && a.min.y <= b.min.y && a.min.z <= b.min.z && b.max.x <= a.max.x
+            && b.max.y <= a.max.y && b.max.z <= a.max.z;
+    }
+
+    /**
+     * @brief	   Smallest box enclosing both boxes
+     */
+    inline auto merge(const Aabb& a, const Aabb& b) -> Aabb {
+        return {mathematics::min(a.min, b.min), mathematics::max(a.max, b.max)};
+    }
+
+    /**
+     * @brief	   Box grown by margin on every side
+     */
+    inline auto expand(const Aabb& box, float margin) -> Aabb {
+        Vec3 const offset {margin, margin, margin};
+        return {box.min - offset, box.max + offset};
+    }
+
+    inline auto center(const Aabb& box) -> Vec3 {
+        return (box.min + box.max) * 0.5F;
+    }
+
+    inline auto extent(const Aabb& box) -> Vec3 {
+        return box.max - box.min;
+    }
+
+    /**
+     * @brief	   Surface area, the cost measure of the SAH
+     */
+    inline auto surface_area(const Aabb& box) -> float {
+        Vec3 const size = extent(box);
+        return 2.0F * ((size.x * size.y) + (size.y * size.z) + (size.z * size.x));
+    }
+
+    /**
+     * @brief	   Point of a box closest to a point (the point itself when inside)
+     */
+    inline auto closest_point(const Aabb& box, Vec3 point) -> Vec3 {
+        return mathematics::min(mathematics::max(point, box.min), box.max);
+    }
+
+    /**
+     * @brief	   Ray / box intersection (slab test)
+     *
+     * @param[in]  ray	The ray
+     * @param[in]  box	The box
+     *
+     * @return	   distance to the entry point (0 when the origin is inside), infinity on a miss
+     */
+    auto intersect(const Ray& ray, const Aabb& box) -> float;
+
+    /**
+     * @brief	   Ray / triangle intersection (Moller-Trumbore), both faces
+     *
+     * @param[in]  ray	The ray
+     * @param[in]  a	The first vertex
+     * @param[in]  b	The second vertex
+     * @param[in]  c	The third vertex
+     *
+     * @return	   distance to the hit, infinity on a miss
+     */
+    auto intersect_triangle(const Ray& ray, Vec3 a, Vec3 b, Vec3 c) -> float;
+
+    /**
+     * @brief	   Point of a triangle closest to a point
+     *
+     * @param[in]  point  The point
+     * @param[in]  a	  The first vertex
+     * @param[in]  b	  The second vertex
+     * @param[in]  c	  The third vertex
+     *
+     * @return	   closest point on the triangle
+     */
+    auto closest_point_on_triangle(Vec3 point, Vec3 a, Vec3 b, Vec3 c) -> Vec3;
+}    // namespace mathematics::geometry
@@ -0,0 +1,185 @@
+/**
+ * @file
+ * @brief Small fixed-size matrix types
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cmath>
+
+#include "domkrat3d/mathematics/vector.hpp"
+
+/**
+ * @brief Namespace of mathematics
+ */
+namespace mathematics {
+
+    /**
+     * @brief	   3x3 single precision matrix stored as columns
+     *
+     * For a rotation the columns are the rotated coordinate axes.
+     */
+    struct Mat3 {
+        Vec3 columns[3] = {{1.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, {0.0F, 0.0F, 1.0F}};
+
+        auto operator[](int column) const -> Vec3 { return columns[column]; }
+
+        auto operator[](int column) -> Vec3& { return columns[column]; }
+    };
+
+    /**
+     * @brief	   Diagonal matrix
+     */
+    inline auto diagonal(Vec3 values) -> Mat3 {
+        return {{{values.x, 0.0F, 0.0F}, {0.0F, values.y, 0.0F}, {0.0F, 0.0F, values.z}}};
+    }
+
+    inline auto operator*(const Mat3& m, Vec3 v) -> Vec3 {
+        return (m.columns[0] * v.x) + (m.columns[1] * v.y) + (m.columns[2] * v.z);
+    }
+
+    inline auto operator*(const Mat3& a, const Mat3& b) -> Mat3 {
+        return {{a * b.columns[0], a * b.columns[1], a * b.columns[2]}};
+    }
+
+    inline auto transpose(const Mat3& m) -> Mat3 {
+        return {{{m.columns[0].x, m.columns[1].x, m.columns[2].x},
+                 {m.columns[0].y, m.columns[1].y, m.columns[2].y},
+                 {m.columns[0].z, m.columns[1].z, m.columns[2].z}}};
+    }
+
+    inline auto operator+(const Mat3& a, const Mat3& b) -> Mat3 {
+        return {{a.columns[0] + b.columns[0], a.columns[1] + b.columns[1], a.columns[2] + b.columns[2]}};
+    }
+
+    inline auto operator-(const Mat3& a, const Mat3& b) -> Mat3 {
+        return {{a.columns[0] - b.columns[0], a.columns[1] - b.columns[1], a.columns[2] - b.columns[2]}};
+    }
+
+    /**
+     * @brief	   Cross product matrix: skew(a) * v == cross(a, v)
+     */
+    inline auto skew(Vec3 a) -> Mat3 {
+        return {{{0.0F, a.z, -a.y}, {-a.z, 0.0F, a.x}, {a.y, -a.x, 0.0F}}};
+    }
+
+    /**
+     * @brief	   Inverse of a matrix; a singular matrix yields all zeros
+     */
+    inline auto inverse(const Mat3& m) -> Mat3 {
+        Vec3 const r0 = cross(m.columns[1], m.columns[2]);
+        Vec3 const r1 = cross(m.columns[2], m.columns[0]);
+        Vec3 const r2 = cross(m.columns[0], m.columns[1]);
+        float const determinant = dot(m.columns[0], r0);
+        if (!(std::fabs(determinant) > 0.0F)) {
+            return {{{}, {}, {}}};
+        }
+
+        // The rows of the inverse are the cross products above divided by the determinant.
+        float const scale = 1.0F / determinant;
+        return transpose({{r0 * scale, r1 * scale, r2 * scale}});
+    }
+
+    /**
+     * @brief	   Transposed matrix times vector without forming the transpose
+     *
+     * For a rotation this is the inverse rotation.
+     */
+    inline auto transpose_multiply(const Mat3& m, Vec3 v) -> Vec3 {
+        return {dot(m.columns[0], v), dot(m.columns[1], v), dot(m.columns[2], v)};
+    }
+
+    /**
+     * @brief	   4x4 single precision matrix stored as columns, for affine transforms
+     *
+     * A column is 16 aligned bytes, one SIMD load.
+     */
+    struct alignas(16) Mat4 {
+        float columns[4][4] = {{1.0F, 0.0F, 0.0F, 0.0F},
+                               {0.0F, 1.0F, 0.0F, 0.0F},
+                               {0.0F, 0.0F, 1.0F, 0.0F},
+                               {0.0F, 0.0F, 0.0F, 1.0F}};
+    };
+
+    /**
+     * @brief	   Affine matrix of a linear part followed by a translation
+     */
+    inline auto affine(const Mat3& linear, Vec3 translation) -> Mat4 {
+        Mat4 result;
+        for (int column = 0; column < 3; ++column) {
+            result.columns[column][0] = linear.columns[column].x;
+            result.columns[column][1] = linear.columns[column].y;
+            result.columns[column][2] = linear.columns[column].z;
+        }
+        result.columns[3][0] = translation.x;
+        result.columns[3][1] = translation.y;
+        result.columns[3][2] = translation.z;
+        return result;
+    }
+
+    inline auto operator*(const Mat4& a, const Mat4& b) -> Mat4 {
+        Mat4 result;
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                float sum = 0.0F;
+                for (int k = 0; k < 4; ++k) {
+                    sum += a.columns[k][row] * b.columns[column][k];
+                }
+                result.columns[column][row] = sum;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief	   Transform a point (w = 1)
+     */
+    inline auto transform_point(const Mat4& m, Vec3 point) -> Vec3 {
+        return {(m.columns[0][0] * point.x) + (m.columns[1][0] * point.y) + (m.columns[2][0] * point.z)
+                    + m.columns[3][0],
+                (m.columns[0][1] * point.x) + (m.columns[1][1] * point.y) + (m.columns[2][1] * point.z)
+                    + m.columns[3][1],
+                (m.columns[0][2] * point.x) + (m.columns[1][2] * point.y) + (m.columns[2][2] * point.z)
+                    + m.columns[3][2]};
+    }
+
+    /**
+     * @brief	   Right-handed perspective projection to Vulkan clip space (depth 0 at near, 1 at far)
+     *
+     * @param[in]  fov_y   The vertical field of view, radians
+     * @param[in]  aspect  Width over height
+     * @param[in]  z_near  The near plane distance
+     * @param[in]  z_far   The far plane distance
+     */
+    inline auto perspective(float fov_y, float aspect, float z_near, float z_far) -> Mat4 {
+        float const focal = 1.0F / std::tan(fov_y * 0.5F);
+        Mat4 result;
+        result.columns[0][0] = focal / aspect;
+        result.columns[1][1] = focal;
+        result.columns[2][2] = z_far / (z_near - z_far);
+        result.columns[2][3] = -1.0F;
+        result.columns[3][2] = z_near * z_far / (z_near - z_far);
+        result.columns[3][3] = 0.0F;
+        return result;
+    }
+
+    /**
+     * @brief	   View matrix of a camera at eye looking at target; the camera looks down its -Z
+     */
+    inline auto look_at(Vec3 eye, Vec3 target, Vec3 up) -> Mat4 {
+        Vec3 const forward = normalize(target - eye);
+        Vec3 const side = normalize(cross(forward, up));
+        Vec3 const camera_up = cross(side, forward);
+        Mat4 result;
+        for (int column = 0; column < 3; ++column) {
+            result.columns[column][0] = side[column];
+            result.columns[column][1] = camera_up[column];
+            result.columns[column][2] = -forward[column];
+        }
+        result.columns[3][0] = -dot(side, eye);
+        result.columns[3][1] = -dot(camera_up, eye);
+        result.columns[3][2] = dot(forward, eye);
+        return result;
+    }
+}    // namespace mathematics
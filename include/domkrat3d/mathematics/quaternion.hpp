@@ -0,0 +1,167 @@
+/**
+ * @file
+ * @brief Rotation quaternion and rigid transform
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cmath>
+
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+
+/**
+ * @brief Namespace of mathematics
+ */
+namespace mathematics {
+
+    /**
+     * @brief	   Unit quaternion x*i + y*j + z*k + w; the default is no rotation
+     */
+    struct Quat {
+        float x = 0.0F;
+        float y = 0.0F;
+        float z = 0.0F;
+        float w = 1.0F;
+    };
+
+    /**
+     * @brief	   Rotation by angle (radians) around a unit axis
+     */
+    inline auto from_axis_angle(Vec3 axis, float angle) -> Quat {
+        float const half = angle * 0.5F;
+        float const s = std::sin(half);
+        return {axis.x * s, axis.y * s, axis.z * s, std::cos(half)};
+    }
+
+    /**
+     * @brief	   Composition: rotate by b, then by a
+     */
+    inline auto operator*(Quat a, Quat b) -> Quat {
+        return {(a.w * b.x) + (a.x * b.w) + (a.y * b.z) - (a.z * b.y),
+                (a.w * b.y) - (a.x * b.z) + (a.y * b.w) + (a.z * b.x),
+                (a.w * b.z) + (a.x * b.y) - (a.y * b.x) + (a.z * b.w),
+                (a.w * b.w) - (a.x * b.x) - (a.y * b.y) - (a.z * b.z)};
+    }
+
+    inline auto dot(Quat a, Quat b) -> float {
+        return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+    }
+
+    /**
+     * @brief	   Inverse of a unit quaternion
+     */
+    inline auto conjugate(Quat q) -> Quat {
+        return {-q.x, -q.y, -q.z, q.w};
+    }
+
+    inline auto normalize(Quat q) -> Quat {
+        float const len = std::sqrt(dot(q, q));
+        if (len <= 0.0F) {
+            return {};
+        }
+
+        float const inverse = 1.0F / len;
+        return {q.x * inverse, q.y * inverse, q.z * inverse, q.w * inverse};
+    }
+
+    /**
+     * @brief	   Normalized linear interpolation along the shorter arc
+     *
+     * Cheaper than slerp and close to it for the small angles between two
+     * consecutive simulation states.
+     */
+    inline auto nlerp(Quat a, Quat b, float t) -> Quat {
+        // q and -q are the same rotation; flip b onto the hemisphere of a.
+        float const s = dot(a, b) < 0.0F ? -t : t;
+        float const r = 1.0F - t;
+        return normalize(
+            {(a.x * r) + (b.x * s), (a.y * r) + (b.y * s), (a.z * r) + (b.z * s), (a.w * r) + (b.w * s)});
+    }
+
+    inline auto rotate(Quat q, Vec3 v) -> Vec3 {
+        // v + 2w (u x v) + 2 u x (u x v) with u the vector part.
+        Vec3 const u {q.x, q.y, q.z};
+        Vec3 const t = cross(u, v) * 2.0F;
+        return v + (t * q.w) + cross(u, t);
+    }
+
+    inline auto inverse_rotate(Quat q, Vec3 v) -> Vec3 {
+        return rotate(conjugate(q), v);
+    }
+
+    /**
+     * @brief	   Rotation matrix of a unit quaternion
+     */
+    inline auto to_matrix(Quat q) -> Mat3 {
+        float const xx = q.x * q.x;
+        float const yy = q.y * q.y;
+        float const zz = q.z * q.z;
+        float const xy = q.x * q.y;
+        float const xz = q.x * q.z;
+        float const yz = q.y * q.z;
+        float const wx = q.w * q.x;
+        float const wy = q.w * q.y;
+        float const wz = q.w * q.z;
+
+        return {{{1.0F - (2.0F * (yy + zz)), 2.0F * (xy + wz), 2.0F * (xz - wy)},
+                 {2.0F * (xy - wz), 1.0F - (2.0F * (xx + zz)), 2.0F * (yz + wx)},
+                 {2.0F * (xz + wy), 2.0F * (yz - wx), 1.0F - (2.0F * (xx + yy))}}};
+    }
+
+    /**
+     * @brief	   Advance an orientation by an angular velocity over a time step
+     *
+     * First order integration followed by renormalization; accurate for the
+     * small angles of a simulation step.
+     */
+    inline auto integrate(Quat q, Vec3 angular_velocity, float time) -> Quat {
+        Quat const spin {angular_velocity.x, angular_velocity.y, angular_velocity.z, 0.0F};
+        Quat const delta = spin * q;
+        float const half = 0.5F * time;
+        return normalize(
+            {q.x + (delta.x * half), q.y + (delta.y * half), q.z + (delta.z * half), q.w + (delta.w * half)});
+    }
+
+    /**
+     * @brief	   Rigid transform: rotation followed by translation
+     */
+    struct Transform {
+        Vec3 position;
+        Quat rotation;
+    };
+
+    /**
+     * @brief	   Local point to world
+     */
+    inline auto apply(const Transform& transform, Vec3 point) -> Vec3 {
+        return rotate(transform.rotation, point) + transform.position;
+    }
+
+    /**
+     * @brief	   World point to local
+     */
+    inline auto apply_inverse(const Transform& transform, Vec3 point) -> Vec3 {
+        return inverse_rotate(transform.rotation, point - transform.position);
+    }
+
+    /**
+     * @brief	   Composition: apply b, then a
+     */
+    inline auto operator*(const Transform& a, const Transform& b) -> Transform {
+        return {apply(a, b.position), a.rotation * b.rotation};
+    }
+
+    /**
+     * @brief	   Blend of two transforms: positions by lerp(), rotations by nlerp()
+     */
+    inline auto interpolate(const Transform& a, const Transform& b, float t) -> Transform {
+        return {lerp(a.position, b.position, t), nlerp(a.rotation, b.rotation, t)};
+    }
+
+    inline auto inverse(const Transform& transform) -> Transform {
+        Quat const rotation = conjugate(transform.rotation);
+        return {rotate(rotation, -transform.position), rotation};
+    }
+}    // namespace mathematics
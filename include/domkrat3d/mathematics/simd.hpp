@@ -0,0 +1,755 @@
+/**
+ * @file
+ * @brief Portable 4-lane SIMD vector types
+ * @authors alexeev-prog
+ *
+ * Thin wrappers over SSE2 (SSE4.1 when available) with a scalar fallback, so
+ * batch kernels can be written once and still build on any target.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define DOMKRAT3D_SIMD_SSE2
+#    include <emmintrin.h>
+#    if defined(__SSE4_1__)
+#        define DOMKRAT3D_SIMD_SSE41
+#        include <smmintrin.h>
+#    endif
+#endif
+
+/**
+ * @brief Namespace of SIMD primitives (mathematics)
+ */
+namespace mathematics::simd {
+
+    /**
+     * @brief Number of lanes in float4 / int4
+     */
+    constexpr int LANES = 4;
+
+    /**
+     * @brief Four packed single precision floats
+     */
+    struct float4 {
+#ifdef DOMKRAT3D_SIMD_SSE2
+        __m128 v;
+#else
+        float v[LANES];
+#endif
+    };
+
+    /**
+     * @brief Four packed 32-bit integers
+     */
+    struct int4 {
+#ifdef DOMKRAT3D_SIMD_SSE2
+        __m128i v;
+#else
+        int32_t v[LANES];
+#endif
+    };
+
+    /**
+     * @brief Two packed double precision floats
+     */
+    struct double2 {
+#ifdef DOMKRAT3D_SIMD_SSE2
+        __m128d v;
+#else
+        double v[2];
+#endif
+    };
+
+#ifdef DOMKRAT3D_SIMD_SSE2
+
+    // ---- float4 ----
+
+    inline auto set1(float value) -> float4 {
+        return {_mm_set1_ps(value)};
+    }
+
+    inline auto set(float x, float y, float z, float w) -> float4 {
+        return {_mm_setr_ps(x, y, z, w)};
+    }
+
+    inline auto zero4() -> float4 {
+        return {_mm_setzero_ps()};
+    }
+
+    inline auto load(const float* src) -> float4 {
+        return {_mm_loadu_ps(src)};
+    }
+
+    inline void store(float* dst, float4 a) {
+        _mm_storeu_ps(dst, a.v);
+    }
+
+    inline auto operator+(float4 a, float4 b) -> float4 {
+        return {_mm_add_ps(a.v, b.v)};
+    }
+
+    inline auto operator-(float4 a, float4 b) -> float4 {
+        return {_mm_sub_ps(a.v, b.v)};
+    }
+
+    inline auto operator*(float4 a, float4 b) -> float4 {
+        return {_mm_mul_ps(a.v, b.v)};
+    }
+
+    inline auto operator/(float4 a, float4 b) -> float4 {
+        return {_mm_div_ps(a.v, b.v)};
+    }
+
+    inline auto operator-(float4 a) -> float4 {
+        return {_mm_xor_ps(a.v, _mm_set1_ps(-0.0F))};
+    }
+
+    inline auto min(float4 a, float4 b) -> float4 {
+        return {_mm_min_ps(a.v, b.v)};
+    }
+
+    inline auto max(float4 a, float4 b) -> float4 {
+        return {_mm_max_ps(a.v, b.v)};
+    }
+
+    inline auto sqrt(float4 a) -> float4 {
+        return {_mm_sqrt_ps(a.v)};
+    }
+
+    inline auto abs(float4 a) -> float4 {
+        return {_mm_andnot_ps(_mm_set1_ps(-0.0F), a.v)};
+    }
+
+    /**
+     * @brief Lane-wise floor, valid for |x| < 2^31
+     */
+    inline auto floor(float4 a) -> float4 {
+#    ifdef DOMKRAT3D_SIMD_SSE41
+        return {_mm_floor_ps(a.v)};
+#    else
+        const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+        const __m128 correction = _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.0F));
+        return {_mm_sub_ps(truncated, correction)};
+#    endif
+    }
+
+    // Comparisons return all-ones / all-zeros lane masks stored in a float4.
+    inline auto operator<(float4 a, float4 b) -> float4 {
+        return {_mm_cmplt_ps(a.v, b.v)};
+    }
+
+    inline auto operator<=(float4 a, float4 b) -> float4 {
+        return {_mm_cmple_ps(a.v, b.v)};
+    }
+
+    inline auto operator>(float4 a, float4 b) -> float4 {
+        return {_mm_cmpgt_ps(a.v, b.v)};
+    }
+
+    inline auto operator>=(float4 a, float4 b) -> float4 {
+        return {_mm_cmpge_ps(a.v, b.v)};
+    }
+
+    inline auto operator==(float4 a, float4 b) -> float4 {
+        return {_mm_cmpeq_ps(a.v, b.v)};
+    }
+
+    inline auto operator&(float4 a, float4 b) -> float4 {
+        return {_mm_and_ps(a.v, b.v)};
+    }
+
+    /**
+     * @brief ~mask & b
+     */
+    inline auto andnot(float4 mask, float4 b) -> float4 {
+        return {_mm_andnot_ps(mask.v, b.v)};
+    }
+
+    inline auto operator|(float4 a, float4 b) -> float4 {
+        return {_mm_or_ps(a.v, b.v)};
+    }
+
+    inline auto operator^(float4 a, float4 b) -> float4 {
+        return {_mm_xor_ps(a.v, b.v)};
+    }
+
+    /**
+     * @brief Pick if_true where mask is set, if_false otherwise
+     */
+    inline auto select(float4 mask, float4 if_true, float4 if_false) -> float4 {
+#    ifdef DOMKRAT3D_SIMD_SSE41
+        return {_mm_blendv_ps(if_false.v, if_true.v, mask.v)};
+#    else
+        return {_mm_or_ps(_mm_and_ps(mask.v, if_true.v), _mm_andnot_ps(mask.v, if_false.v))};
+#    endif
+    }
+
+    /**
+     * @brief Bit i is set when lane i of the mask is set
+     */
+    inline auto movemask(float4 mask) -> int {
+        return _mm_movemask_ps(mask.v);
+    }
+
+    /**
+     * @brief Value of lane 0
+     */
+    inline auto first(float4 a) -> float {
+        return _mm_cvtss_f32(a.v);
+    }
+
+    // ---- int4 ----
+
+    inline auto set1i(int32_t value) -> int4 {
+        return {_mm_set1_epi32(value)};
+    }
+
+    inline auto loadi(const int32_t* src) -> int4 {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))};
+    }
+
+    inline void storei(int32_t* dst, int4 a) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), a.v);
+    }
+
+    inline auto operator+(int4 a, int4 b) -> int4 {
+        return {_mm_add_epi32(a.v, b.v)};
+    }
+
+    inline auto operator-(int4 a, int4 b) -> int4 {
+        return {_mm_sub_epi32(a.v, b.v)};
+    }
+
+    /**
+     * @brief Lane-wise 32-bit multiply keeping the low half (wraps)
+     */
+    inline auto operator*(int4 a, int4 b) -> int4 {
+#    ifdef DOMKRAT3D_SIMD_SSE41
+        return {_mm_mullo_epi32(a.v, b.v)};
+#    else
+        const __m128i even = _mm_mul_epu32(a.v, b.v);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a.v, 4), _mm_srli_si128(b.v, 4));
+        return {_mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                   _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)))};
+#    endif
+    }
+
+    inline auto operator&(int4 a, int4 b) -> int4 {
+        return {_mm_and_si128(a.v, b.v)};
+    }
+
+    inline auto operator|(int4 a, int4 b) -> int4 {
+        return {_mm_or_si128(a.v, b.v)};
+    }
+
+    inline auto operator^(int4 a, int4 b) -> int4 {
+        return {_mm_xor_si128(a.v, b.v)};
+    }
+
+    /**
+     * @brief Logical shift right
+     */
+    template<int Bits>
+    inline auto srl(int4 a) -> int4 {
+        return {_mm_srli_epi32(a.v, Bits)};
+    }
+
+    /**
+     * @brief Arithmetic shift right
+     */
+    template<int Bits>
+    inline auto sra(int4 a) -> int4 {
+        return {_mm_srai_epi32(a.v, Bits)};
+    }
+
+    /**
+     * @brief Shift left
+     */
+    template<int Bits>
+    inline auto sll(int4 a) -> int4 {
+        return {_mm_slli_epi32(a.v, Bits)};
+    }
+
+    /**
+     * @brief Convert with truncation toward zero
+     */
+    inline auto to_int(float4 a) -> int4 {
+        return {_mm_cvttps_epi32(a.v)};
+    }
+
+    inline auto to_float(int4 a) -> float4 {
+        return {_mm_cvtepi32_ps(a.v)};
+    }
+
+    /**
+     * @brief Reinterpret the bits of an int4 as float4
+     */
+    inline auto as_float(int4 a) -> float4 {
+        return {_mm_castsi128_ps(a.v)};
+    }
+
+    /**
+     * @brief Reinterpret the bits of a float4 as int4
+     */
+    inline auto as_int(float4 a) -> int4 {
+        return {_mm_castps_si128(a.v)};
+    }
+
+    // ---- double2 ----
+
+    inline auto set1(double value) -> double2 {
+        return {_mm_set1_pd(value)};
+    }
+
+    inline auto load(const double* src) -> double2 {
+        return {_mm_loadu_pd(src)};
+    }
+
+    inline void store(double* dst, double2 a) {
+        _mm_storeu_pd(dst, a.v);
+    }
+
+    inline auto operator+(double2 a, double2 b) -> double2 {
+        return {_mm_add_pd(a.v, b.v)};
+    }
+
+    inline auto operator-(double2 a, double2 b) -> double2 {
+        return {_mm_sub_pd(a.v, b.v)};
+    }
+
+    inline auto operator*(double2 a, double2 b) -> double2 {
+        return {_mm_mul_pd(a.v, b.v)};
+    }
+
+    inline auto operator/(double2 a, double2 b) -> double2 {
+        return {_mm_div_pd(a.v, b.v)};
+    }
+
+    inline auto min(double2 a, double2 b) -> double2 {
+        return {_mm_min_pd(a.v, b.v)};
+    }
+
+    inline auto max(double2 a, double2 b) -> double2 {
+        return {_mm_max_pd(a.v, b.v)};
+    }
+
+#else
+
+    // ---- scalar fallback ----
+
+#    define DOMKRAT3D_SIMD_LANEWISE(expr)    \
+        for (int lane = 0; lane < LANES; ++lane) { \
+            expr;                           \
+        }
+
+    inline auto set1(float value) -> float4 {
+        return {{value, value, value, value}};
+    }
+
+    inline auto set(float x, float y, float z, float w) -> float4 {
+        return {{x, y, z, w}};
+    }
+
+    inline auto zero4() -> float4 {
+        return set1(0.0F);
+    }
+
+    inline auto load(const float* src) -> float4 {
+        float4 r;
+        std::memcpy(r.v, src, sizeof(r.v));
+        return r;
+    }
+
+    inline void store(float* dst, float4 a) {
+        std::memcpy(dst, a.v, sizeof(a.v));
+    }
+
+    inline auto mask_bits(bool condition) -> float {
+        uint32_t const bits = condition ? 0xFFFFFFFFU : 0U;
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    inline auto lane_bits(float value) -> uint32_t {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline auto bits_lane(uint32_t bits) -> float {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    inline auto operator+(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] += b.v[lane])
+        return a;
+    }
+
+    inline auto operator-(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] -= b.v[lane])
+        return a;
+    }
+
+    inline auto operator*(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] *= b.v[lane])
+        return a;
+    }
+
+    inline auto operator/(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] /= b.v[lane])
+        return a;
+    }
+
+    inline auto operator-(float4 a) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = -a.v[lane])
+        return a;
+    }
+
+    inline auto min(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = a.v[lane] < b.v[lane] ? a.v[lane] : b.v[lane])
+        return a;
+    }
+
+    inline auto max(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = a.v[lane] > b.v[lane] ? a.v[lane] : b.v[lane])
+        return a;
+    }
+
+    inline auto sqrt(float4 a) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = std::sqrt(a.v[lane]))
+        return a;
+    }
+
+    inline auto abs(float4 a) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = std::fabs(a.v[lane]))
+        return a;
+    }
+
+    inline auto floor(float4 a) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = std::floor(a.v[lane]))
+        return a;
+    }
+
+    inline auto operator<(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = mask_bits(a.v[lane] < b.v[lane]))
+        return a;
+    }
+
+    inline auto operator<=(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = mask_bits(a.v[lane] <= b.v[lane]))
+        return a;
+    }
+
+    inline auto operator>(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = mask_bits(a.v[lane] > b.v[lane]))
+        return a;
+    }
+
+    inline auto operator>=(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = mask_bits(a.v[lane] >= b.v[lane]))
+        return a;
+    }
+
+    inline auto operator==(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = mask_bits(a.v[lane] <= b.v[lane] && a.v[lane] >= b.v[lane]))
+        return a;
+    }
+
+    inline auto operator&(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = bits_lane(lane_bits(a.v[lane]) & lane_bits(b.v[lane])))
+        return a;
+    }
+
+    inline auto andnot(float4 mask, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(b.v[lane] = bits_lane(~lane_bits(mask.v[lane]) & lane_bits(b.v[lane])))
+        return b;
+    }
+
+    inline auto operator|(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = bits_lane(lane_bits(a.v[lane]) | lane_bits(b.v[lane])))
+        return a;
+    }
+
+    inline auto operator^(float4 a, float4 b) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = bits_lane(lane_bits(a.v[lane]) ^ lane_bits(b.v[lane])))
+        return a;
+    }
+
+    inline auto select(float4 mask, float4 if_true, float4 if_false) -> float4 {
+        DOMKRAT3D_SIMD_LANEWISE(
+            if_false.v[lane] = (lane_bits(mask.v[lane]) >> 31U) != 0 ? if_true.v[lane] : if_false.v[lane])
+        return if_false;
+    }
+
+    inline auto movemask(float4 mask) -> int {
+        int bits = 0;
+        DOMKRAT3D_SIMD_LANEWISE(bits |= static_cast<int>(lane_bits(mask.v[lane]) >> 31U) << lane)
+        return bits;
+    }
+
+    inline auto first(float4 a) -> float {
+        return a.v[0];
+    }
+
+    inline auto set1i(int32_t value) -> int4 {
+        return {{value, value, value, value}};
+    }
+
+    inline auto loadi(const int32_t* src) -> int4 {
+        int4 r;
+        std::memcpy(r.v, src, sizeof(r.v));
+        return r;
+    }
+
+    inline void storei(int32_t* dst, int4 a) {
+        std::memcpy(dst, a.v, sizeof(a.v));
+    }
+
+    inline auto operator+(int4 a, int4 b) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = static_cast<int32_t>(static_cast<uint32_t>(a.v[lane])
+                                                                 + static_cast<uint32_t>(b.v[lane])))
+        return a;
+    }
+
+    inline auto operator-(int4 a, int4 b) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = static_cast<int32_t>(static_cast<uint32_t>(a.v[lane])
+                                                                 - static_cast<uint32_t>(b.v[lane])))
+        return a;
+    }
+
+    inline auto operator*(int4 a, int4 b) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = static_cast<int32_t>(static_cast<uint32_t>(a.v[lane])
+                                                                 * static_cast<uint32_t>(b.v[lane])))
+        return a;
+    }
+
+    inline auto operator&(int4 a, int4 b) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] &= b.v[lane])
+        return a;
+    }
+
+    inline auto operator|(int4 a, int4 b) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] |= b.v[lane])
+        return a;
+    }
+
+    inline auto operator^(int4 a, int4 b) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] ^= b.v[lane])
+        return a;
+    }
+
+    template<int Bits>
+    inline auto srl(int4 a) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = static_cast<int32_t>(static_cast<uint32_t>(a.v[lane]) >> Bits))
+        return a;
+    }
+
+    template<int Bits>
+    inline auto sra(int4 a) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] >>= Bits)
+        return a;
+    }
+
+    template<int Bits>
+    inline auto sll(int4 a) -> int4 {
+        DOMKRAT3D_SIMD_LANEWISE(a.v[lane] = static_cast<int32_t>(static_cast<uint32_t>(a.v[lane]) << Bits))
+        return a;
+    }
+
+    inline auto to_int(float4 a) -> int4 {
+        int4 r;
+        DOMKRAT3D_SIMD_LANEWISE(r.v[lane] = static_cast<int32_t>(a.v[lane]))
+        return r;
+    }
+
+    inline auto to_float(int4 a) -> float4 {
+        float4 r;
+        DOMKRAT3D_SIMD_LANEWISE(r.v[lane] = static_cast<float>(a.v[lane]))
+        return r;
+    }
+
+    inline auto as_float(int4 a) -> float4 {
+        float4 r;
+        std::memcpy(r.v, a.v, sizeof(r.v));
+        return r;
+    }
+
+    inline auto as_int(float4 a) -> int4 {
+        int4 r;
+        std::memcpy(r.v, a.v, sizeof(r.v));
+        return r;
+    }
+
+    inline auto set1(double value) -> double2 {
+        return {{value, value}};
+    }
+
+    inline auto load(const double* src) -> double2 {
+        double2 r;
+        std::memcpy(r.v, src, sizeof(r.v));
+        return r;
+    }
+
+    inline void store(double* dst, double2 a) {
+        std::memcpy(dst, a.v, sizeof(a.v));
+    }
+
+    inline auto operator+(double2 a, double2 b) -> double2 {
+        return {{a.v[0] + b.v[0], a.v[1] + b.v[1]}};
+    }
+
+    inline auto operator-(double2 a, double2 b) -> double2 {
+        return {{a.v[0] - b.v[0], a.v[1] - b.v[1]}};
+    }
+
+    inline auto operator*(double2 a, double2 b) -> double2 {
+        return {{a.v[0] * b.v[0], a.v[1] * b.v[1]}};
+    }
+
+    inline auto operator/(double2 a, double2 b) -> double2 {
+        return {{a.v[0] / b.v[0], a.v[1] / b.v[1]}};
+    }
+
+    inline auto min(double2 a, double2 b) -> double2 {
+        return {{a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1]}};
+    }
+
+    inline auto max(double2 a, double2 b) -> double2 {
+        return {{a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1]}};
+    }
+
+#    undef DOMKRAT3D_SIMD_LANEWISE
+
+#endif
+
+    // ---- composite helpers (shared by both back ends) ----
+
+    /**
+     * @brief a * b + c
+     */
+    inline auto madd(float4 a, float4 b, float4 c) -> float4 {
+        return (a * b) + c;
+    }
+
+    inline auto madd(double2 a, double2 b, double2 c) -> double2 {
+        return (a * b) + c;
+    }
+
+    /**
+     * @brief Linear interpolation a + (b - a) * t
+     */
+    inline auto lerp(float4 a, float4 b, float4 t) -> float4 {
+        return madd(b - a, t, a);
+    }
+
+    inline auto clamp(float4 a, float4 low, float4 high) -> float4 {
+        return min(max(a, low), high);
+    }
+
+    /**
+     * @brief 1.0 where the mask is set, 0.0 otherwise
+     */
+    inline auto mask_to_one(float4 mask) -> float4 {
+        return mask & set1(1.0F);
+    }
+
+    /**
+     * @brief Is any lane of the mask set
+     */
+    inline auto any(float4 mask) -> bool {
+        return movemask(mask) != 0;
+    }
+
+    /**
+     * @brief Are all lanes of the mask set
+     */
+    inline auto all(float4 mask) -> bool {
+        return movemask(mask) == 0xF;
+    }
+
+    /**
+     * @brief	   Natural logarithm approximation
+     *
+     * Cephes-style range reduction to [sqrt(1/2), sqrt(2)) followed by a
+     * degree-9 polynomial. Relative error is about 1e-7 for normal positive
+     * inputs; zero and negative inputs are clamped to the smallest normal.
+     *
+     * @param[in]  x  The argument
+     *
+     * @return	   log(x) per lane
+     */
+    inline auto log(float4 x) -> float4 {
+        x = max(x, as_float(set1i(0x00800000)));
+
+        int4 const bits = as_int(x);
+        float4 exponent = to_float(srl<23>(bits) - set1i(126));
+        float4 mantissa = as_float((bits & set1i(static_cast<int32_t>(0x807FFFFFU))) | set1i(0x3F000000));
+
+        float4 const below = mantissa < set1(0.707106781186547524F);
+        exponent = exponent - (below & set1(1.0F));
+        mantissa = mantissa - set1(1.0F) + (below & mantissa);
+
+        float4 const z = mantissa * mantissa;
+        float4 y = set1(7.0376836292E-2F);
+        y = madd(y, mantissa, set1(-1.1514610310E-1F));
+        y = madd(y, mantissa, set1(1.1676998740E-1F));
+        y = madd(y, mantissa, set1(-1.2420140846E-1F));
+        y = madd(y, mantissa, set1(1.4249322787E-1F));
+        y = madd(y, mantissa, set1(-1.6668057665E-1F));
+        y = madd(y, mantissa, set1(2.0000714765E-1F));
+        y = madd(y, mantissa, set1(-2.4999993993E-1F));
+        y = madd(y, mantissa, set1(3.3333331174E-1F));
+        y = y * mantissa * z;
+
+        y = madd(exponent, set1(-2.12194440E-4F), y);
+        y = y - (z * set1(0.5F));
+
+        return madd(exponent, set1(0.693359375F), mantissa + y);
+    }
+
+    /**
+     * @brief	   Sine and cosine approximation
+     *
+     * Reduces the argument to [-pi/2, pi/2] and evaluates an odd degree-11
+     * polynomial; absolute error stays below 1e-6 for |x| up to a few
+     * thousand radians.
+     *
+     * @param[in]  x	   The angle in radians
+     * @param[out] sine	   sin(x) per lane
+     * @param[out] cosine  cos(x) per lane
+     */
+    inline void sincos(float4 x, float4& sine, float4& cosine) {
+        float4 const pi = set1(3.14159265358979F);
+        float4 const half_pi = set1(1.57079632679490F);
+
+        auto reduced_sin = [&](float4 angle) -> float4
+        {
+            float4 const turns = floor(madd(angle, set1(0.159154943091895F), set1(0.5F)));
+            angle = angle - (turns * set1(6.28318548202514648F));
+            angle = angle + (turns * set1(1.7484555e-7F));
+
+            angle = select(angle > half_pi, pi - angle, angle);
+            angle = select(angle < -half_pi, -pi - angle, angle);
+
+            float4 const a2 = angle * angle;
+            float4 p = set1(-2.50521083854417E-8F);
+            p = madd(p, a2, set1(2.75573192239859E-6F));
+            p = madd(p, a2, set1(-1.98412698412698E-4F));
+            p = madd(p, a2, set1(8.33333333333333E-3F));
+            p = madd(p, a2, set1(-1.66666666666667E-1F));
+            p = madd(p, a2, set1(1.0F));
+            return p * angle;
+        };
+
+        sine = reduced_sin(x);
+        cosine = reduced_sin(x + half_pi);
+    }
+}    // namespace mathematics::simd
@@ -44,7 +44,7 @@ namespace mathematics::statistics {
      * @param data
      * @return double
      **/
-    auto median(std::vector<double> data) -> double;
+    auto median(const std::vector<double>& data) -> double;
 
     /**
      * @brief	   variance
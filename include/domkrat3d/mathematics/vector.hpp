@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @brief Small fixed-size vector types
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cmath>
+
+/**
+ * @brief Namespace of mathematics
+ */
+namespace mathematics {
+
+    /**
+     * @brief Three-component single precision vector
+     */
+    struct Vec3 {
+        float x = 0.0F;
+        float y = 0.0F;
+        float z = 0.0F;
+
+        auto operator[](int axis) const -> float { return axis == 0 ? x : (axis == 1 ? y : z); }
+
+        auto operator[](int axis) -> float& { return axis == 0 ? x : (axis == 1 ? y : z); }
+    };
+
+    inline auto operator+(Vec3 a, Vec3 b) -> Vec3 {
+        return {a.x + b.x, a.y + b.y, a.z + b.z};
+    }
+
+    inline auto operator-(Vec3 a, Vec3 b) -> Vec3 {
+        return {a.x - b.x, a.y - b.y, a.z - b.z};
+    }
+
+    inline auto operator-(Vec3 a) -> Vec3 {
+        return {-a.x, -a.y, -a.z};
+    }
+
+    inline auto operator*(Vec3 a, float s) -> Vec3 {
+        return {a.x * s, a.y * s, a.z * s};
+    }
+
+    inline auto operator*(float s, Vec3 a) -> Vec3 {
+        return a * s;
+    }
+
+    inline auto operator+=(Vec3& a, Vec3 b) -> Vec3& {
+        a = a + b;
+        return a;
+    }
+
+    inline auto operator-=(Vec3& a, Vec3 b) -> Vec3& {
+        a = a - b;
+        return a;
+    }
+
+    inline auto operator*=(Vec3& a, float s) -> Vec3& {
+        a = a * s;
+        return a;
+    }
+
+    inline auto dot(Vec3 a, Vec3 b) -> float {
+        return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+    }
+
+    inline auto cross(Vec3 a, Vec3 b) -> Vec3 {
+        return {(a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x)};
+    }
+
+    inline auto length_squared(Vec3 a) -> float {
+        return dot(a, a);
+    }
+
+    inline auto length(Vec3 a) -> float {
+        return std::sqrt(dot(a, a));
+    }
+
+    /**
+     * @brief	   Unit vector in the direction of a (zero vector stays zero)
+     */
+    inline auto normalize(Vec3 a) -> Vec3 {
+        float const len = length(a);
+        return len > 0.0F ? a * (1.0F / len) : a;
+    }
+
+    /**
+     * @brief	   Component-wise minimum
+     */
+    inline auto min(Vec3 a, Vec3 b) -> Vec3 {
+        return {a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z};
+    }
+
+    /**
+     * @brief	   Component-wise maximum
+     */
+    inline auto max(Vec3 a, Vec3 b) -> Vec3 {
+        return {a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z};
+    }
+
+    /**
+     * @brief	   Linear interpolation: a at t = 0, b at t = 1
+     */
+    inline auto lerp(Vec3 a, Vec3 b, float t) -> Vec3 {
+        return a + ((b - a) * t);
+    }
+}    // namespace mathematics
@@ -0,0 +1,202 @@
+/**
+ * @file
+ * @brief Broadphase collision detection
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+
+/**
+ * @brief	   Namespace of broadphase collision detection (physics)
+ *
+ * A broadphase tracks the bounding boxes of moving objects (proxies) and
+ * reports every pair of overlapping boxes, each pair exactly once. Both
+ * implementations keep their state between frames and only do work
+ * proportional to what moved; find_pairs() writes into a caller-owned
+ * vector, so once it has grown to the typical pair count no frame
+ * allocates.
+ */
+namespace physics::broadphase {
+
+    using mathematics::geometry::Aabb;
+
+    /**
+     * @brief Proxy handle; ids of destroyed proxies are reused
+     */
+    using ProxyId = uint32_t;
+
+    /**
+     * @brief	   Overlapping proxy pair, first < second
+     */
+    struct Pair {
+        ProxyId first;
+        ProxyId second;
+    };
+
+    /**
+     * @brief Coordinate axis
+     */
+    enum class Axis
+    {
+        X,
+        Y,
+        Z
+    };
+
+    /**
+     * @brief	   Spatial hash over an unbounded uniform grid
+     *
+     * Every proxy is registered in each grid cell its box touches. Cells are
+     * identified by a 64-bit key packed from their coordinates, and the
+     * (cell, proxy) entries are kept in one array sorted by key, so the
+     * proxies of a cell are adjacent and the pair search streams through
+     * memory. Moving a proxy that stays in the same cells only updates its
+     * box; a proxy that changes cells invalidates its old entries by bumping
+     * a stamp and queues new ones, which the next find_pairs() sorts and
+     * merges in.
+     *
+     * A pair is reported only from the first cell the two boxes share, which
+     * removes duplicates without a pair set.
+     *
+     * Works best when the cell size is about the size of a typical object.
+     * Cell coordinates must fit in 21 bits (about a million cells per axis).
+     */
+    class SpatialHash {
+      public:
+        /**
+         * @brief	   Construct a spatial hash
+         *
+         * @param[in]  cell_size  The grid cell edge length
+         */
+        explicit SpatialHash(float cell_size);
+
+        /**
+         * @brief	   Add a proxy
+         *
+         * @param[in]  box	The bounding box
+         *
+         * @return	   proxy id
+         */
+        auto create_proxy(const Aabb& box) -> ProxyId;
+
+        /**
+         * @brief	   Update the box of a proxy
+         */
+        void move_proxy(ProxyId proxy, const Aabb& box);
+
+        void destroy_proxy(ProxyId proxy);
+
+        /**
+         * @brief	   Collect all overlapping pairs
+         *
+         * Merges the queued cell changes first, which is why this is not const.
+         *
+         * @param[out] pairs  cleared and filled with the pairs
+         */
+        void find_pairs(std::vector<Pair>& pairs);
+
+        auto proxy_count() const -> size_t { return m_boxes.size() - m_free.size(); }
+
+      private:
+        struct CellRange {
+            int32_t min_x;
+            int32_t min_y;
+            int32_t min_z;
+            int32_t max_x;
+            int32_t max_y;
+            int32_t max_z;
+        };
+
+        // One cell of a proxy. `tag` holds the proxy stamp at insertion above three bits that
+        // are set where the cell is the first of the range on that axis.
+        struct Entry {
+            uint64_t cell;
+            ProxyId proxy;
+            uint32_t tag;
+        };
+
+        auto cells_of(const Aabb& box) const -> CellRange;
+        void queue_cells(ProxyId proxy);
+        void merge();
+
+        float m_inverse_cell_size;
+        std::vector<Aabb> m_boxes;
+        std::vector<CellRange> m_ranges;
+        std::vector<uint32_t> m_stamps;
+        std::vector<ProxyId> m_free;
+
+        std::vector<Entry> m_entries;
+        std::vector<Entry> m_queued;
+        std::vector<Entry> m_merged;
+        bool m_stale = false;
+    };
+
+    /**
+     * @brief	   Sweep and prune along one axis
+     *
+     * Proxies are kept sorted by the lower end of their box on the sweep
+     * axis. Between frames boxes move little, so the order is repaired with
+     * an insertion sort that costs O(n + swaps); large batches of new
+     * proxies fall back to a full sort. The sweep then compares each box
+     * only with boxes starting before it ends, four at a time.
+     *
+     * The sweep cost grows with the number of boxes overlapping on the sweep
+     * axis alone, so this suits scenes spread along one axis (tracks,
+     * corridors, side-scrolling levels); choose that axis. For objects
+     * spread evenly in 3D the spatial hash scales better.
+     */
+    class SweepAndPrune {
+      public:
+        explicit SweepAndPrune(Axis axis = Axis::X);
+
+        /**
+         * @brief	   Add a proxy
+         *
+         * @param[in]  box	The bounding box
+         *
+         * @return	   proxy id
+         */
+        auto create_proxy(const Aabb& box) -> ProxyId;
+
+        /**
+         * @brief	   Update the box of a proxy
+         */
+        void move_proxy(ProxyId proxy, const Aabb& box);
+
+        void destroy_proxy(ProxyId proxy);
+
+        /**
+         * @brief	   Collect all overlapping pairs
+         *
+         * Restores the sort order first, which is why this is not const.
+         *
+         * @param[out] pairs  cleared and filled with the pairs
+         */
+        void find_pairs(std::vector<Pair>& pairs);
+
+        auto proxy_count() const -> size_t { return m_boxes.size() - m_free.size() - m_pending_free.size(); }
+
+      private:
+        void sort();
+
+        int m_axis;
+        std::vector<Aabb> m_boxes;
+        std::vector<bool> m_alive;
+        std::vector<ProxyId> m_free;
+
+        // Destroyed ids stay in m_order until the next sort, so they are not reused before that.
+        std::vector<ProxyId> m_pending_free;
+        std::vector<ProxyId> m_order;
+        size_t m_inserted = 0;
+
+        // Boxes in sweep order, one array per bound; sweep axis first.
+        std::vector<float> m_lower[3];
+        std::vector<float> m_upper[3];
+    };
+}    // namespace physics::broadphase
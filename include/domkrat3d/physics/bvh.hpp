@@ -0,0 +1,207 @@
+/**
+ * @file
+ * @brief Bounding volume hierarchy for ray, overlap and proximity queries
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+
+/**
+ * @brief	   Namespace of the bounding volume hierarchy (physics)
+ *
+ * The tree is built over primitive bounding boxes; what a primitive is
+ * (triangle, collider, whole object) is up to the caller, who supplies the
+ * exact test as a callback. Without a callback queries work on the boxes
+ * themselves, which is enough for picking objects.
+ */
+namespace physics::bvh {
+
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using mathematics::geometry::Plane;
+    using mathematics::geometry::Ray;
+
+    /**
+     * @brief Marker for "no primitive"
+     */
+    constexpr uint32_t NO_PRIMITIVE = UINT32_MAX;
+
+    /**
+     * @brief Most planes of a convex volume query
+     */
+    constexpr size_t MAX_PLANES = 32;
+
+    /**
+     * @brief	   Exact ray test of one primitive
+     *
+     * Receives the primitive index and the ray (max_distance already
+     * shortened to the best hit so far); returns the hit distance or
+     * infinity on a miss.
+     */
+    using RayTest = std::function<float(uint32_t primitive, const Ray& ray)>;
+
+    /**
+     * @brief	   Closest point of one primitive to a point
+     */
+    using ClosestPointTest = std::function<Vec3(uint32_t primitive, Vec3 point)>;
+
+    /**
+     * @brief	   Nearest ray hit
+     */
+    struct RayHit {
+        uint32_t primitive = NO_PRIMITIVE;
+        float distance = std::numeric_limits<float>::infinity();
+    };
+
+    /**
+     * @brief	   Closest point query result
+     */
+    struct ClosestHit {
+        uint32_t primitive = NO_PRIMITIVE;
+        Vec3 point;
+        float distance = std::numeric_limits<float>::infinity();
+    };
+
+    /**
+     * @brief	   Four-wide tree node, two cache lines
+     *
+     * Child boxes are stored per coordinate so one SIMD instruction tests a
+     * query against all four. A child with count == 0 is an inner node
+     * (index into the node array), otherwise a leaf with `count` primitives
+     * starting at `index` in the primitive order; unused slots hold a
+     * degenerate box at +infinity that no query reaches.
+     */
+    struct alignas(64) Node {
+        float min_x[4];
+        float min_y[4];
+        float min_z[4];
+        float max_x[4];
+        float max_y[4];
+        float max_z[4];
+        uint32_t index[4];
+        uint32_t count[4];
+    };
+
+    /**
+     * @brief	   BVH4 built with the binned surface area heuristic
+     *
+     * Nodes are stored in one array with children after their parent,
+     * which keeps subtrees close in memory and lets refit() run as a single
+     * backwards pass. Leaves hold up to four primitives.
+     */
+    class Bvh {
+      public:
+        /**
+         * @brief	   Build the tree
+         *
+         * Large subtrees are binned and built on worker threads with
+         * Execution::Parallel.
+         *
+         * @param[in]  boxes	  The primitive boxes, primitive i has boxes[i]
+         * @param[in]  count	  The number of primitives
+         * @param[in]  execution  The execution
+         */
+        void build(const Aabb* boxes,
+                   size_t count,
+                   kinematics::Execution execution = kinematics::Execution::Parallel);
+
+        /**
+         * @brief	   Update boxes after primitives moved, keeping the topology
+         *
+         * Much cheaper than a rebuild; query cost degrades as primitives
+         * drift far from where the tree was built, so rebuild occasionally.
+         *
+         * @param[in]  boxes  The new boxes, same count and order as in build()
+         */
+        void refit(const Aabb* boxes);
+
+        /**
+         * @brief	   Nearest hit along a ray
+         *
+         * @param[in]  ray	 The ray
+         * @param[in]  test	 The exact primitive test (empty: hit the primitive box)
+         *
+         * @return	   nearest hit, primitive == NO_PRIMITIVE on a miss
+         */
+        auto raycast(const Ray& ray, const RayTest& test = {}) const -> RayHit;
+
+        /**
+         * @brief	   Nearest hits for many rays, traversed in packets
+         *
+         * Rays of a packet walk the tree together, so each node is fetched
+         * once per packet instead of once per ray. Works best for coherent
+         * rays (same origin, similar direction).
+         *
+         * @param[in]  rays	  The rays
+         * @param[out] hits	  One hit per ray
+         * @param[in]  count  The number of rays
+         * @param[in]  test	  The exact primitive test (empty: hit the primitive box)
+         */
+        void raycast(const Ray* rays, RayHit* hits, size_t count, const RayTest& test = {}) const;
+
+        /**
+         * @brief	   Whether anything blocks the ray (line of sight)
+         *
+         * Stops at the first hit instead of searching for the nearest one.
+         */
+        auto occluded(const Ray& ray, const RayTest& test = {}) const -> bool;
+
+        /**
+         * @brief	   Primitives whose boxes overlap a box
+         *
+         * @param[in]  box		   The box
+         * @param[out] primitives  primitive indices are appended
+         */
+        void overlap(const Aabb& box, std::vector<uint32_t>& primitives) const;
+
+        /**
+         * @brief	   Primitives whose boxes are not entirely behind any plane of a convex volume
+         *
+         * A view frustum is the usual volume. A subtree whose box is in front
+         * of a plane skips that plane below it, so subtrees entirely inside
+         * are collected without further tests. Like any box test this is
+         * conservative near the edges of the volume.
+         *
+         * @param[in]  planes		The planes, normals pointing into the volume
+         * @param[in]  plane_count	The number of planes, at most MAX_PLANES
+         * @param[out] primitives	primitive indices are appended
+         *
+         * @throw	   std::invalid_argument when there are more than MAX_PLANES planes
+         */
+        void overlap(const Plane* planes, size_t plane_count, std::vector<uint32_t>& primitives) const;
+
+        /**
+         * @brief	   Closest primitive point to a point
+         *
+         * @param[in]  point		 The point
+         * @param[in]  test			 The primitive closest point (empty: closest point of the box)
+         * @param[in]  max_distance	 The search radius
+         *
+         * @return	   closest point, primitive == NO_PRIMITIVE if nothing is within the radius
+         */
+        auto closest_point(Vec3 point,
+                           const ClosestPointTest& test = {},
+                           float max_distance = std::numeric_limits<float>::infinity()) const -> ClosestHit;
+
+        auto bounds() const -> const Aabb& { return m_bounds; }
+
+        auto node_count() const -> size_t { return m_nodes.size(); }
+
+        auto primitive_count() const -> size_t { return m_primitives.size(); }
+
+      private:
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_primitives;
+        std::vector<Aabb> m_boxes;
+        Aabb m_bounds;
+    };
+}    // namespace physics::bvh
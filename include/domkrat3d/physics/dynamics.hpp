@@ -0,0 +1,278 @@
+/**
+ * @file
+ * @brief Rigid-body dynamics with an island-parallel constraint solver
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/physics/broadphase.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+#include "domkrat3d/physics/narrowphase.hpp"
+#include "domkrat3d/physics/snapshot.hpp"
+
+/**
+ * @brief	   Namespace of rigid-body dynamics (physics)
+ *
+ * A world owns its bodies together with their broadphase proxies and the
+ * narrowphase manifold cache. Every step detects contacts, splits the awake
+ * bodies into islands (bodies connected through touching contacts or
+ * joints, found with union-find) and solves the islands independently on
+ * worker threads with sequential impulses, warm started from the impulses
+ * stored in the persistent contact points. Large islands are additionally
+ * split by graph coloring into batches of contacts without a shared body,
+ * which are solved four contacts per SIMD instruction.
+ *
+ * An island whose bodies stay slow for a while falls asleep as a whole: its
+ * contacts are kept but not queried, solved or integrated until an awake
+ * body touches one of its bodies.
+ */
+namespace physics::dynamics {
+
+    using mathematics::Quat;
+    using mathematics::Transform;
+    using mathematics::Vec3;
+    using narrowphase::Shape;
+
+    /**
+     * @brief Body handle, the index of the body in its world
+     */
+    using BodyId = uint32_t;
+
+    /**
+     * @brief Joint handle, the index of the joint in its world
+     */
+    using JointId = uint32_t;
+
+    /**
+     * @brief Body type
+     *
+     * Static bodies never move and have infinite mass; dynamic bodies are
+     * moved by gravity and constraints.
+     */
+    enum class BodyType
+    {
+        Static,
+        Dynamic
+    };
+
+    /**
+     * @brief	   Body description for World::create_body()
+     *
+     * The inertia follows from the shape and the mass (hulls use the inertia
+     * of their bounding box). Friction and restitution of a contact are the
+     * geometric mean and the maximum of the two bodies' values.
+     */
+    struct BodyDesc {
+        Shape shape;
+        Transform transform;
+        Vec3 linear_velocity;
+        Vec3 angular_velocity;
+        BodyType type = BodyType::Dynamic;
+        float mass = 1.0F;
+        float friction = 0.5F;
+        float restitution = 0.0F;
+    };
+
+    /**
+     * @brief	   Ball joint description: pins an anchor of one body to an anchor of another
+     *
+     * Anchors are given in the local frames of the bodies.
+     */
+    struct BallJointDesc {
+        BodyId first = 0;
+        BodyId second = 0;
+        Vec3 local_anchor_a;
+        Vec3 local_anchor_b;
+    };
+
+    /**
+     * @brief	   World settings
+     *
+     *	+ velocity_iterations - solver passes over the constraints of an island
+     *	+ baumgarte - fraction of the penetration (or joint drift) removed per step
+     *	+ allowed_penetration - penetration left uncorrected, so resting contacts stay touching
+     *	+ sleep_linear_velocity, sleep_angular_velocity - speeds below which a body may sleep
+     *	+ time_to_sleep - time every body of an island must stay slow before the island sleeps
+     *	+ batch_threshold - contact points from which an island is solved in colored SIMD batches
+     *	+ cell_size - grid cell of the broadphase spatial hash, about the size of a typical body
+     */
+    struct Settings {
+        Vec3 gravity {0.0F, -9.81F, 0.0F};
+        int velocity_iterations = 8;
+        float baumgarte = 0.2F;
+        float allowed_penetration = 0.01F;
+        float sleep_linear_velocity = 0.05F;
+        float sleep_angular_velocity = 0.05F;
+        float time_to_sleep = 0.5F;
+        size_t batch_threshold = 64;
+        float cell_size = 2.0F;
+    };
+
+    /**
+     * @brief	   Statistics of the last step
+     */
+    struct StepStats {
+        size_t islands = 0;
+        size_t awake_bodies = 0;
+        size_t contact_points = 0;
+        size_t batched_points = 0;
+        size_t colors = 0;
+    };
+
+    /**
+     * @brief	   Rigid-body world
+     *
+     * Bodies live as long as the world; their ids are dense, so per-body
+     * data can be kept in plain arrays next to the world.
+     */
+    class World {
+      public:
+        explicit World(const Settings& settings = {});
+
+        /**
+         * @brief	   Add a body; dynamic bodies start awake
+         *
+         * @param[in]  desc	 The body description
+         *
+         * @return	   id of the body
+         */
+        auto create_body(const BodyDesc& desc) -> BodyId;
+
+        /**
+         * @brief	   Connect two bodies with a ball joint; wakes both
+         *
+         * @param[in]  desc	 The joint description
+         *
+         * @return	   id of the joint
+         */
+        auto create_joint(const BallJointDesc& desc) -> JointId;
+
+        /**
+         * @brief	   Choose where collision detection and islands run
+         */
+        void set_execution(kinematics::Execution execution);
+
+        /**
+         * @brief	   Advance the world by one step
+         *
+         * Gravity is applied, the constraints are solved for the new
+         * velocities and the bodies move with them (semi-implicit Euler).
+         *
+         * @param[in]  time	 The step (s)
+         */
+        void step(float time);
+
+        auto transform(BodyId body) const -> const Transform& { return m_colliders[body].transform; }
+
+        auto linear_velocity(BodyId body) const -> Vec3 { return m_bodies[body].linear_velocity; }
+
+        auto angular_velocity(BodyId body) const -> Vec3 { return m_bodies[body].angular_velocity; }
+
+        /**
+         * @brief	   Set the velocities of a dynamic body and wake its island
+         */
+        void set_velocity(BodyId body, Vec3 linear, Vec3 angular);
+
+        /**
+         * @brief	   Wake the island of a sleeping body
+         */
+        void wake(BodyId body);
+
+        auto is_sleeping(BodyId body) const -> bool { return m_bodies[body].sleep_group != NO_GROUP; }
+
+        auto body_count() const -> size_t { return m_bodies.size(); }
+
+        auto stats() const -> const StepStats& { return m_stats; }
+
+        /**
+         * @brief	   Append the arrays holding the state of the bodies and joints, for snapshot::SnapshotRing
+         *
+         * The layout stays the same until a body or joint is created.
+         * After copying a state back into the pools, call restored().
+         *
+         * @param[out] pools  The list to append to
+         */
+        void pools(std::vector<snapshot::Pool>& pools);
+
+        /**
+         * @brief	   Rebuild what is derived from the pools after a restore
+         *
+         * Sleeping groups are regrouped, the broadphase follows the restored
+         * transforms and the contact cache is dropped, so the next step
+         * starts its contacts cold: replays from one restored frame match
+         * each other, but not bit for bit the run that was captured.
+         */
+        void restored();
+
+        /**
+         * @brief	   Manifolds of the last step, with the impulses the solver applied
+         */
+        auto manifolds() const -> const std::vector<narrowphase::Manifold>& {
+            return m_narrowphase.manifolds();
+        }
+
+      private:
+        static constexpr uint32_t NO_GROUP = UINT32_MAX;
+
+        struct Body {
+            Vec3 linear_velocity;
+            Vec3 angular_velocity;
+            Vec3 inverse_inertia;
+            float inverse_mass = 0.0F;
+            float friction = 0.5F;
+            float restitution = 0.0F;
+            float sleep_time = 0.0F;
+            uint32_t sleep_group = NO_GROUP;
+            BodyType type = BodyType::Dynamic;
+        };
+
+        struct Joint {
+            BallJointDesc desc;
+            Vec3 impulse;
+        };
+
+        // Awake bodies grouped by island; manifolds and joints likewise.
+        struct Islands {
+            std::vector<uint32_t> parent;
+            std::vector<uint32_t> index;
+            std::vector<BodyId> bodies;
+            std::vector<uint32_t> manifolds;
+            std::vector<JointId> joints;
+            std::vector<uint32_t> body_start;
+            std::vector<uint32_t> manifold_start;
+            std::vector<uint32_t> joint_start;
+            std::vector<uint32_t> order;
+            std::vector<float> sleep_time;
+            std::vector<StepStats> stats;
+        };
+
+        auto is_awake(BodyId body) const -> bool { return m_awake[body] != 0; }
+
+        void move_proxy(BodyId body);
+        void wake_touched();
+        void build_islands();
+        void solve_island(size_t island, float time);
+        void sleep_islands();
+        void sleep(size_t island);
+
+        Settings m_settings;
+        kinematics::Execution m_execution = kinematics::Execution::Parallel;
+        std::vector<Body> m_bodies;
+        std::vector<narrowphase::Collider> m_colliders;
+        std::vector<uint8_t> m_awake;
+        std::vector<Joint> m_joints;
+        std::vector<std::vector<BodyId>> m_sleep_groups;
+        std::vector<uint32_t> m_free_groups;
+        broadphase::SpatialHash m_broadphase;
+        std::vector<broadphase::Pair> m_pairs;
+        narrowphase::Narrowphase m_narrowphase;
+        Islands m_islands;
+        StepStats m_stats;
+    };
+}    // namespace physics::dynamics
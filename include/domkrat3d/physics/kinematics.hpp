@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 /**
  * @brief	   Namespace of kinematics (physics)
  *
@@ -132,4 +134,146 @@ namespace physics::kinematics {
      * @return	   The speed of rectilinear motion.
      */
     auto calculate_speed_of_rectilinear_motion(double end_speed, double acceleration, double time) -> double;
+
+    /**
+     * @brief How batch functions schedule their work: on the calling thread
+     * or split into chunks across worker threads
+     */
+    enum class Execution
+    {
+        Serial,
+        Parallel
+    };
+
+    /**
+     * @brief	   Mutable view of 3D vectors stored as structure-of-arrays
+     */
+    template<typename Real>
+    struct Vec3Span {
+        Real* x;
+        Real* y;
+        Real* z;
+    };
+
+    /**
+     * @brief	   Read-only view of 3D vectors stored as structure-of-arrays
+     */
+    template<typename Real>
+    struct ConstVec3Span {
+        const Real* x;
+        const Real* y;
+        const Real* z;
+    };
+
+    /**
+     * @brief	   Calculates final velocities of many bodies in place.
+     *
+     * Batch variant of calculate_final_velocity(): v[i] = v[i] + a[i] * t.
+     * Bodies are processed several per SIMD instruction; unlike the scalar
+     * functions, batch variants emit no trace output.
+     *
+     * @param	   velocity		 The velocities (updated in place)
+     * @param[in]  acceleration	 The accelerations
+     * @param[in]  count		 The number of bodies
+     * @param[in]  time			 The time
+     * @param[in]  execution	 Serial or parallel execution
+     */
+    void calculate_final_velocity_batch(float* velocity,
+                                        const float* acceleration,
+                                        size_t count,
+                                        float time,
+                                        Execution execution = Execution::Serial);
+    void calculate_final_velocity_batch(double* velocity,
+                                        const double* acceleration,
+                                        size_t count,
+                                        double time,
+                                        Execution execution = Execution::Serial);
+    void calculate_final_velocity_batch(Vec3Span<float> velocity,
+                                        ConstVec3Span<float> acceleration,
+                                        size_t count,
+                                        float time,
+                                        Execution execution = Execution::Serial);
+    void calculate_final_velocity_batch(Vec3Span<double> velocity,
+                                        ConstVec3Span<double> acceleration,
+                                        size_t count,
+                                        double time,
+                                        Execution execution = Execution::Serial);
+
+    /**
+     * @brief	   Calculates final positions of many bodies in place.
+     *
+     * Batch variant of calculate_final_position(): s[i] = s[i] + u[i] * t +
+     * 0.5 * a[i] * t^2. Velocities are read, not updated.
+     *
+     * @param	   position		 The positions (updated in place)
+     * @param[in]  velocity		 The initial velocities
+     * @param[in]  acceleration	 The accelerations
+     * @param[in]  count		 The number of bodies
+     * @param[in]  time			 The time
+     * @param[in]  execution	 Serial or parallel execution
+     */
+    void calculate_final_position_batch(float* position,
+                                        const float* velocity,
+                                        const float* acceleration,
+                                        size_t count,
+                                        float time,
+                                        Execution execution = Execution::Serial);
+    void calculate_final_position_batch(double* position,
+                                        const double* velocity,
+                                        const double* acceleration,
+                                        size_t count,
+                                        double time,
+                                        Execution execution = Execution::Serial);
+    void calculate_final_position_batch(Vec3Span<float> position,
+                                        ConstVec3Span<float> velocity,
+                                        ConstVec3Span<float> acceleration,
+                                        size_t count,
+                                        float time,
+                                        Execution execution = Execution::Serial);
+    void calculate_final_position_batch(Vec3Span<double> position,
+                                        ConstVec3Span<double> velocity,
+                                        ConstVec3Span<double> acceleration,
+                                        size_t count,
+                                        double time,
+                                        Execution execution = Execution::Serial);
+
+    /**
+     * @brief	   Advances positions and velocities of many bodies by one step.
+     *
+     * Fuses calculate_final_position_batch() and
+     * calculate_final_velocity_batch() into one pass over memory: positions
+     * use the velocity at the start of the step, then velocities are
+     * updated.
+     *
+     * @param	   position		 The positions (updated in place)
+     * @param	   velocity		 The velocities (updated in place)
+     * @param[in]  acceleration	 The accelerations
+     * @param[in]  count		 The number of bodies
+     * @param[in]  time			 The time step
+     * @param[in]  execution	 Serial or parallel execution
+     */
+    void advance_batch(float* position,
+                       float* velocity,
+                       const float* acceleration,
+                       size_t count,
+                       float time,
+                       Execution execution = Execution::Serial);
+    void advance_batch(double* position,
+                       double* velocity,
+                       const double* acceleration,
+                       size_t count,
+                       double time,
+                       Execution execution = Execution::Serial);
+    void advance_batch(Vec3Span<float> position,
+                       Vec3Span<float> velocity,
+                       ConstVec3Span<float> acceleration,
+                       size_t count,
+                       float time,
+                       Execution execution = Execution::Serial);
+    void advance_batch(Vec3Span<double> position,
+                       Vec3Span<double> velocity,
+                       ConstVec3Span<double> acceleration,
+                       size_t count,
+                       double time,
+                       Execution execution = Execution::Serial);
 }    // namespace physics::kinematics
@@ -0,0 +1,272 @@
+/**
+ * @file
+ * @brief Narrowphase collision detection: exact contacts between convex shapes
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/physics/broadphase.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+
+/**
+ * @brief	   Namespace of narrowphase collision detection (physics)
+ *
+ * Takes the pairs reported by the broadphase and computes contact manifolds:
+ * a shared normal and up to four contact points per touching pair. Boxes
+ * against boxes use the separating axis test with face clipping, which
+ * yields a full manifold in one frame. Every other combination uses GJK on
+ * the shape cores (sphere center, capsule segment) and falls back to EPA
+ * when the cores overlap; those produce one point per frame and the
+ * persistent manifold collects the rest over the following frames.
+ */
+namespace physics::narrowphase {
+
+    using broadphase::Pair;
+    using mathematics::Quat;
+    using mathematics::Transform;
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+
+    /**
+     * @brief Contacts are reported up to this separation, so the solver sees them before impact
+     */
+    constexpr float CONTACT_MARGIN = 0.02F;
+
+    /**
+     * @brief Contact points per manifold
+     */
+    constexpr int MAX_CONTACT_POINTS = 4;
+
+    /**
+     * @brief	   Convex hull given by its vertices
+     *
+     * Vertices are stored per coordinate and padded to the SIMD width, so the
+     * support search tests four vertices per instruction.
+     */
+    class ConvexHull {
+      public:
+        /**
+         * @brief	   Construct a hull
+         *
+         * @param[in]  points  The vertices in local space (interior points are harmless)
+         * @param[in]  count   The number of vertices, at least 1
+         */
+        ConvexHull(const Vec3* points, size_t count);
+
+        /**
+         * @brief	   Vertex furthest in a direction
+         *
+         * @param[in]  direction  The direction in local space
+         *
+         * @return	   the vertex
+         */
+        auto support(Vec3 direction) const -> Vec3;
+
+        auto bounds() const -> const Aabb& { return m_bounds; }
+
+        auto vertex_count() const -> size_t { return m_count; }
+
+      private:
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_z;
+        size_t m_count;
+        Aabb m_bounds;
+    };
+
+    /**
+     * @brief Shape type
+     */
+    enum class ShapeType
+    {
+        Sphere,
+        Capsule,
+        Box,
+        ConvexHull
+    };
+
+    /**
+     * @brief	   Convex shape in its local frame, centered at the origin
+     *
+     * Spheres and capsules use `radius`; the capsule segment runs along the
+     * local y axis from -half_height to +half_height. Boxes use
+     * `half_extents`. Hulls point to vertices owned by the caller, which must
+     * outlive the shape.
+     */
+    struct Shape {
+        ShapeType type = ShapeType::Sphere;
+        float radius = 0.5F;
+        float half_height = 0.0F;
+        Vec3 half_extents;
+        const ConvexHull* hull = nullptr;
+
+        static auto sphere(float radius) -> Shape;
+        static auto capsule(float radius, float half_height) -> Shape;
+        static auto box(Vec3 half_extents) -> Shape;
+        static auto convex_hull(const ConvexHull& hull) -> Shape;
+    };
+
+    /**
+     * @brief	   Shape placed in the world
+     */
+    struct Collider {
+        Shape shape;
+        Transform transform;
+    };
+
+    /**
+     * @brief	   World bounding box of a collider, for the broadphase
+     */
+    auto bounds(const Collider& collider) -> Aabb;
+
+    /**
+     * @brief	   World point of a collider furthest in a direction
+     */
+    auto support(const Collider& collider, Vec3 direction) -> Vec3;
+
+    /**
+     * @brief	   GJK distance query result
+     */
+    struct DistanceResult {
+        float distance = 0.0F;
+        Vec3 point_a;
+        Vec3 point_b;
+        bool overlapping = false;
+    };
+
+    /**
+     * @brief	   Distance and closest points between two colliders (GJK)
+     *
+     * @return	   distance result; when the shapes overlap, distance is 0 and the points are undefined
+     */
+    auto distance(const Collider& a, const Collider& b) -> DistanceResult;
+
+    /**
+     * @brief	   One contact point
+     *
+     * The anchors in each body's local frame let the point be tracked while
+     * the bodies move. The impulses are written by the constraint solver and
+     * kept with the point across frames for warm starting.
+     */
+    struct ContactPoint {
+        Vec3 position;
+        float depth = 0.0F;
+        Vec3 local_a;
+        Vec3 local_b;
+        float normal_impulse = 0.0F;
+        float tangent_impulse[2] = {0.0F, 0.0F};
+    };
+
+    /**
+     * @brief	   Contact manifold of a pair
+     *
+     * The normal points from the first collider to the second; depth is
+     * positive for penetration and negative (down to -CONTACT_MARGIN) for
+     * a small gap.
+     */
+    struct Manifold {
+        uint32_t first = 0;
+        uint32_t second = 0;
+        Vec3 normal;
+        ContactPoint points[MAX_CONTACT_POINTS];
+        int count = 0;
+    };
+
+    /**
+     * @brief	   Contact manifold of two colliders, without any caching
+     *
+     * @param[in]  a		 The first collider
+     * @param[in]  b		 The second collider
+     * @param[out] manifold	 normal and points; pair ids are left untouched
+     *
+     * @return	   whether the shapes touch (within CONTACT_MARGIN)
+     */
+    auto collide(const Collider& a, const Collider& b, Manifold& manifold) -> bool;
+
+    /**
+     * @brief	   Narrowphase with a manifold cache
+     *
+     * Manifolds persist from frame to frame for the pairs that stay in the
+     * broadphase output. A pair whose relative placement barely changed
+     * only has its points re-projected, without running GJK, EPA or SAT;
+     * otherwise the cached separating direction seeds the new query.
+     * Persistent points keep their solver impulses for warm starting.
+     */
+    class Narrowphase {
+      public:
+        Narrowphase();
+
+        /**
+         * @brief	   Update the manifolds of a frame
+         *
+         * Pairs are processed in batches on worker threads with
+         * Execution::Parallel. With an `awake` mask, a pair of two colliders
+         * that are both marked 0 (static or sleeping bodies) keeps its cached
+         * manifold as it is, impulses included, without any work.
+         *
+         * @param[in]  pairs	  The broadphase pairs
+         * @param[in]  count	  The number of pairs
+         * @param[in]  colliders  The colliders, indexed by the pair ids
+         * @param[in]  execution  The execution
+         * @param[in]  awake	  Optional per-collider flags, indexed by the pair ids
+         */
+        void update(const Pair* pairs,
+                    size_t count,
+                    const Collider* colliders,
+                    kinematics::Execution execution = kinematics::Execution::Parallel,
+                    const uint8_t* awake = nullptr);
+
+        /**
+         * @brief	   Drop all manifolds and cached queries
+         */
+        void clear();
+
+        /**
+         * @brief	   One manifold per pair of the last update, sorted by pair
+         *
+         * Pairs whose shapes do not touch have count == 0. Mutable so the
+         * solver can store impulses in the points.
+         */
+        auto manifolds() -> std::vector<Manifold>& { return m_manifolds; }
+
+        auto manifolds() const -> const std::vector<Manifold>& { return m_manifolds; }
+
+        /**
+         * @brief	   Contact points over all manifolds of the last update
+         */
+        auto contact_count() const -> size_t { return m_contact_count; }
+
+        /**
+         * @brief	   Pairs of the last update served from the cache without a shape query
+         */
+        auto reused_count() const -> size_t { return m_reused_count; }
+
+      private:
+        // Cache entry next to each manifold.
+        struct PairState {
+            Transform relative;
+            Vec3 local_normal;
+            Vec3 search_direction;
+            int separating_axis = -1;
+            bool cached = false;
+            bool reused = false;
+        };
+
+        void process(size_t index, const Collider* colliders, const uint8_t* awake);
+
+        std::vector<Manifold> m_manifolds;
+        std::vector<PairState> m_states;
+        std::vector<Manifold> m_next_manifolds;
+        std::vector<PairState> m_next_states;
+        std::vector<uint64_t> m_keys;
+        size_t m_contact_count = 0;
+        size_t m_reused_count = 0;
+    };
+}    // namespace physics::narrowphase
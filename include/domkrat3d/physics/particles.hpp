@@ -0,0 +1,262 @@
+/**
+ * @file
+ * @brief Particle systems with structure-of-arrays storage
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/physics/kinematics.hpp"
+#include "domkrat3d/physics/snapshot.hpp"
+#include "domkrat3d/utils/random.hpp"
+
+/**
+ * @brief	   Namespace of particle simulation (physics)
+ *
+ * Particles live in one pool per system, one contiguous array per component,
+ * so every update pass streams through memory four particles per SIMD
+ * instruction. Dead particles are removed by moving the last particle into
+ * their slot: the pool stays dense, but particle order is not preserved.
+ */
+namespace physics::particles {
+
+    /**
+     * @brief Numerical integration scheme for particle motion
+     *
+     * SemiImplicitEuler evaluates forces once per step, VelocityVerlet once
+     * per step plus the stored acceleration of the previous step, Rk4 four
+     * times per step.
+     */
+    enum class Integrator
+    {
+        SemiImplicitEuler,
+        VelocityVerlet,
+        Rk4
+    };
+
+    /**
+     * @brief Kind of force field
+     */
+    enum class ForceType
+    {
+        Uniform,
+        Drag,
+        Attractor
+    };
+
+    /**
+     * @brief	   Force field acting on every particle of a system
+     *
+     * Forces are expressed as accelerations (particles have unit mass):
+     *	+ Uniform - constant acceleration (x, y, z), e.g. gravity or wind
+     *	+ Drag - linear drag, a = -strength * v
+     *	+ Attractor - point (x, y, z) pulling with strength / r^2, softened by
+     *	  radius so particles passing through the center stay finite
+     */
+    struct Force {
+        ForceType type = ForceType::Uniform;
+        float x = 0.0F;
+        float y = 0.0F;
+        float z = 0.0F;
+        float strength = 1.0F;
+        float radius = 0.1F;
+    };
+
+    /**
+     * @brief Initial direction distribution of an emitter
+     */
+    enum class EmitterShape
+    {
+        Sphere,
+        Hemisphere
+    };
+
+    /**
+     * @brief	   Particle source
+     *
+     * Spawns `rate` particles per second (fractional counts carry over to the
+     * next step) at points spread uniformly through the ball of `radius`
+     * around the position. Initial velocities point in a uniformly random
+     * direction (around `direction` for a hemisphere) with a speed in
+     * [min_speed, max_speed).
+     */
+    struct Emitter {
+        float x = 0.0F;
+        float y = 0.0F;
+        float z = 0.0F;
+        float radius = 0.0F;
+        EmitterShape shape = EmitterShape::Sphere;
+        float direction_x = 0.0F;
+        float direction_y = 1.0F;
+        float direction_z = 0.0F;
+        float min_speed = 1.0F;
+        float max_speed = 1.0F;
+        float min_lifetime = 1.0F;
+        float max_lifetime = 1.0F;
+        float rate = 0.0F;
+        bool enabled = true;
+        float accumulator = 0.0F;
+    };
+
+    /**
+     * @brief	   Structure-of-arrays particle storage
+     *
+     * All arrays have `capacity` elements; indices [0, size) are alive.
+     * (ax, ay, az) hold the acceleration of the last step, which the
+     * Velocity Verlet integrator reuses.
+     */
+    struct ParticlePool {
+        std::vector<float> px;
+        std::vector<float> py;
+        std::vector<float> pz;
+        std::vector<float> vx;
+        std::vector<float> vy;
+        std::vector<float> vz;
+        std::vector<float> ax;
+        std::vector<float> ay;
+        std::vector<float> az;
+        std::vector<float> age;
+        std::vector<float> lifetime;
+        size_t size = 0;
+
+        /**
+         * @brief	   Allocate storage for a number of particles
+         *
+         * @param[in]  capacity  The capacity
+         */
+        void reserve(size_t capacity);
+
+        /**
+         * @brief	   Number of particles that fit into the pool
+         */
+        auto capacity() const -> size_t { return age.size(); }
+
+        /**
+         * @brief	   Remove particle `index` by moving the last particle into its slot
+         */
+        void swap_remove(size_t index);
+    };
+
+    /**
+     * @brief	   Particle system: pool, emitters, forces and an integrator
+     *
+     * update() advances the simulation in fixed steps, so results do not
+     * depend on the frame rate. Every step spawns from the emitters,
+     * integrates all particles in chunks (optionally on worker threads),
+     * ages them and compacts the pool.
+     */
+    class ParticleSystem {
+      public:
+        /**
+         * @brief	   Construct a particle system
+         *
+         * @param[in]  capacity	The maximal number of live particles
+         * @param[in]  seed		The seed of the emitter random engine
+         */
+        explicit ParticleSystem(size_t capacity, uint64_t seed = utils::random::DEFAULT_SEED);
+
+        /**
+         * @brief	   Add an emitter
+         *
+         * @param[in]  emitter	The emitter
+         *
+         * @return	   index of the emitter (see emitter())
+         */
+        auto add_emitter(const Emitter& emitter) -> size_t;
+
+        /**
+         * @brief	   Access an emitter, e.g. to move or disable it
+         */
+        auto emitter(size_t index) -> Emitter&;
+
+        /**
+         * @brief	   Add a force field
+         */
+        void add_force(const Force& force);
+
+        /**
+         * @brief	   Remove all force fields
+         */
+        void clear_forces();
+
+        void set_integrator(Integrator integrator);
+
+        /**
+         * @brief	   Set the simulation step and the substep cap of update()
+         *
+         * @param[in]  step			 The fixed step (s)
+         * @param[in]  max_substeps	 The maximal number of steps per update
+         */
+        void set_fixed_step(float step, int max_substeps = 8);
+
+        /**
+         * @brief	   Choose where update passes run
+         */
+        void set_execution(kinematics::Execution execution);
+
+        /**
+         * @brief	   Spawn a burst of particles from an emitter description
+         *
+         * @param[in]  emitter	The emitter
+         * @param[in]  count	The number of particles
+         *
+         * @return	   number of spawned particles (limited by free capacity)
+         */
+        auto emit(const Emitter& emitter, size_t count) -> size_t;
+
+        /**
+         * @brief	   Advance the simulation by a frame
+         *
+         * The frame time is accumulated and consumed in fixed steps; at most
+         * `max_substeps` steps run per call, the rest of a long frame is
+         * dropped instead of stalling the following frames.
+         *
+         * @param[in]  frame_time  The frame time (s)
+         *
+         * @return	   number of steps taken
+         */
+        auto update(float frame_time) -> int;
+
+        /**
+         * @brief	   Run exactly one simulation step
+         *
+         * @param[in]  time	 The step (s)
+         */
+        void step(float time);
+
+        /**
+         * @brief	   Append the arrays holding the simulation state, for snapshot::SnapshotRing
+         *
+         * The whole capacity is listed, so the layout only changes with
+         * add_emitter(); the random engine is included, so a restored
+         * system emits the same particles again.
+         *
+         * @param[out] pools  The list to append to
+         */
+        void pools(std::vector<snapshot::Pool>& pools);
+
+        auto size() const -> size_t { return m_pool.size; }
+
+        auto pool() const -> const ParticlePool& { return m_pool; }
+
+      private:
+        void spawn(const Emitter& emitter, size_t count);
+        void integrate(float time);
+        void compact();
+
+        ParticlePool m_pool;
+        std::vector<Emitter> m_emitters;
+        std::vector<Force> m_forces;
+        std::vector<float> m_scratch;
+        utils::random::BatchEngine m_engine;
+        Integrator m_integrator = Integrator::SemiImplicitEuler;
+        kinematics::Execution m_execution = kinematics::Execution::Serial;
+        float m_fixed_step = 1.0F / 60.0F;
+        float m_accumulator = 0.0F;
+        int m_max_substeps = 8;
+    };
+}    // namespace physics::particles
@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @brief Fixed-timestep simulation thread with interpolated snapshots for rendering
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/physics/dynamics.hpp"
+
+/**
+ * @brief	   Namespace of the simulation scheduler (physics)
+ *
+ * The simulation advances a world in fixed steps on its own thread, paced
+ * by the wall clock, so the render loop and the physics never wait for each
+ * other. After every step the thread publishes the body transforms before
+ * and after the step through a lock-free triple buffer; the render thread
+ * picks up the latest pair and blends it for the moment it draws. Since the
+ * world only ever sees the fixed step, the same number of steps yields the
+ * same state whatever the frame rate.
+ */
+namespace physics::simulation {
+
+    using mathematics::Transform;
+
+    /**
+     * @brief	   Latest-value channel between one writer and one reader thread
+     *
+     * Three slots: the writer fills its back slot and swaps it with the
+     * middle one, the reader swaps the middle one with its front slot when
+     * a newer value is there. Neither side blocks or allocates, and the
+     * reader always sees a complete value; values the reader is too slow to
+     * see are skipped.
+     */
+    template<typename T>
+    class TripleBuffer {
+      public:
+        /**
+         * @brief	   Writer side: the slot to fill before publish()
+         */
+        auto back() -> T& { return m_slots[m_back]; }
+
+        /**
+         * @brief	   Writer side: hand the back slot to the reader
+         */
+        void publish() { m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX; }
+
+        /**
+         * @brief	   Reader side: take the newest published value, if there is one
+         *
+         * @return	   whether front() changed
+         */
+        auto update() -> bool {
+            if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+                return false;
+            }
+
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+
+        /**
+         * @brief	   Reader side: the value taken by the last update()
+         */
+        auto front() const -> const T& { return m_slots[m_front]; }
+
+      private:
+        static constexpr uint8_t INDEX = 3U;
+        static constexpr uint8_t FRESH = 4U;
+
+        std::array<T, 3> m_slots {};
+        uint8_t m_back = 0;
+        std::atomic<uint8_t> m_middle {1};
+        uint8_t m_front = 2;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief	   Body transforms around one step
+     *
+     * `current` is the state at `time`, `previous` the state one step
+     * earlier; both are indexed by body id.
+     */
+    struct Snapshot {
+        std::vector<Transform> previous;
+        std::vector<Transform> current;
+        uint64_t step = 0;
+        Clock::time_point time;
+    };
+
+    /**
+     * @brief	   Simulation settings
+     *
+     *	+ rate - steps per second
+     *	+ max_steps_per_update - steps run back to back when the thread is late; time
+     *	  beyond that is dropped, so a slow machine runs in slow motion instead of falling further behind
+     */
+    struct Settings {
+        double rate = 120.0;
+        int max_steps_per_update = 8;
+    };
+
+    /**
+     * @brief	   Fixed-step simulation of a world
+     *
+     * While the thread runs, the world belongs to it: other threads must not
+     * touch the world and read the bodies through interpolate() instead.
+     */
+    class Simulation {
+      public:
+        explicit Simulation(dynamics::World& world, const Settings& settings = {});
+
+        ~Simulation();
+
+        Simulation(const Simulation&) = delete;
+        auto operator=(const Simulation&) -> Simulation& = delete;
+
+        /**
+         * @brief	   Start stepping the world on the simulation thread
+         */
+        void start();
+
+        /**
+         * @brief	   Stop the simulation thread after its current step
+         */
+        void stop();
+
+        auto is_running() const -> bool { return m_thread.joinable(); }
+
+        /**
+         * @brief	   Run steps on the calling thread, e.g. for replays or without a render loop
+         *
+         * Must not be called while the thread runs. Every step is published
+         * like a step of the thread.
+         *
+         * @param[in]  count  The number of steps
+         */
+        void advance(int count);
+
+        /**
+         * @brief	   Run the steps that are due at a moment
+         *
+         * Steps are due every step_time(), counted from the first call. Late
+         * steps run back to back, up to max_steps_per_update; the backlog
+         * beyond that is dropped. The thread drives this with the wall
+         * clock; without it any clock will do. Must not be called while the
+         * thread runs.
+         *
+         * @param[in]  now	The current moment
+         *
+         * @return	   number of steps run
+         */
+        auto update(Clock::time_point now) -> int;
+
+        /**
+         * @brief	   Render side: transforms of the bodies at the moment of drawing
+         *
+         * The picture runs one step behind the simulation: the latest
+         * published pair of states is blended for `now` minus one step.
+         * Call from one render thread only.
+         *
+         * @param[in]  now		   The moment of drawing
+         * @param[out] transforms  The blended transforms, indexed by body id
+         *
+         * @return	   whether a state was published yet (otherwise transforms is left untouched)
+         */
+        auto interpolate(Clock::time_point now, std::vector<Transform>& transforms) -> bool;
+
+        auto step_time() const -> float { return m_step_time; }
+
+        /**
+         * @brief	   Steps run so far; read from the simulation thread or while stopped
+         */
+        auto step_count() const -> uint64_t { return m_step_count; }
+
+      private:
+        void run();
+        void step(Clock::time_point time);
+
+        dynamics::World& m_world;
+        Settings m_settings;
+        float m_step_time;
+        Clock::duration m_step_duration;
+        Clock::time_point m_next;
+        bool m_scheduled = false;
+        uint64_t m_step_count = 0;
+        std::vector<Transform> m_last;
+        TripleBuffer<Snapshot> m_snapshots;
+        std::atomic<bool> m_stop {false};
+        std::thread m_thread;
+    };
+}    // namespace physics::simulation
@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief Simulation state capture and rollback with XOR delta compression
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief	   Namespace of simulation snapshots (physics)
+ *
+ * Simulation state lives in flat arrays (pools) that can be captured byte
+ * for byte. A snapshot ring keeps the last frames of a set of pools: each
+ * frame is XORed with the previous one, which turns everything that did not
+ * change (sleeping bodies, dead particles, configuration) into zero words,
+ * and the result is packed as one 32-bit mask per 32 words followed by the
+ * non-zero words only. Every few frames a keyframe is packed against zero
+ * instead, so restoring never replays more than a keyframe interval.
+ */
+namespace physics::snapshot {
+
+    /**
+     * @brief	   Live array captured and restored byte for byte
+     */
+    struct Pool {
+        void* data = nullptr;
+        size_t size = 0;
+    };
+
+    /**
+     * @brief	   Ring of delta-compressed frames of a set of pools
+     *
+     * The ring keeps the raw image of the newest frame, so capturing reads
+     * each pool once and restoring the newest frame is a plain copy. Frame
+     * buffers are reused round the ring, so capturing does not allocate in
+     * the steady state.
+     */
+    class SnapshotRing {
+      public:
+        /**
+         * @brief	   Construct a ring
+         *
+         * @param[in]  capacity			  The number of frames kept (at least 1)
+         * @param[in]  keyframe_interval  The number of frames from one keyframe to the next (1 to capacity)
+         */
+        explicit SnapshotRing(size_t capacity, size_t keyframe_interval = 32);
+
+        /**
+         * @brief	   Capture the current contents of the pools
+         *
+         * Pools are given in the same order every time. A capture with a
+         * different number or size of pools starts over with a keyframe and
+         * drops the frames of the old layout.
+         *
+         * @param[in]  pools  The pools
+         *
+         * @return	   number of the frame
+         */
+        auto capture(const std::vector<Pool>& pools) -> uint64_t;
+
+        /**
+         * @brief	   Copy a captured frame back into the pools and roll the ring back to it
+         *
+         * Frames captured after `frame` are dropped; the next capture gets
+         * the number `frame + 1`.
+         *
+         * @param[in]  frame  The frame, see contains()
+         * @param[in]  pools  The pools, in the layout of the capture
+         *
+         * @return	   whether the frame was restored (false for a dropped frame or another layout)
+         */
+        auto restore(uint64_t frame, const std::vector<Pool>& pools) -> bool;
+
+        /**
+         * @brief	   Whether a frame can still be restored
+         */
+        auto contains(uint64_t frame) const -> bool;
+
+        /**
+         * @brief	   Oldest frame that can be restored; only meaningful when !empty()
+         */
+        auto first_frame() const -> uint64_t;
+
+        /**
+         * @brief	   Newest frame; only meaningful when !empty()
+         */
+        auto last_frame() const -> uint64_t { return m_next - 1; }
+
+        auto empty() const -> bool { return m_next == m_start; }
+
+        /**
+         * @brief	   Bytes of one raw state (all pools)
+         */
+        auto raw_bytes() const -> size_t { return m_raw.size() * sizeof(uint32_t); }
+
+        /**
+         * @brief	   Bytes a stored frame takes packed
+         */
+        auto packed_bytes(uint64_t frame) const -> size_t;
+
+      private:
+        struct Frame {
+            std::vector<uint32_t> words;
+            size_t count = 0;
+            bool keyframe = false;
+        };
+
+        auto same_layout(const std::vector<Pool>& pools) const -> bool;
+        auto slot(uint64_t frame) -> Frame& { return m_frames[frame % m_frames.size()]; }
+        auto slot(uint64_t frame) const -> const Frame& { return m_frames[frame % m_frames.size()]; }
+        void decode(uint64_t frame, std::vector<uint32_t>& image) const;
+
+        std::vector<Frame> m_frames;
+        size_t m_keyframe_interval;
+        std::vector<size_t> m_layout;
+        std::vector<uint32_t> m_raw;
+        std::vector<uint32_t> m_image;
+
+        // No frame before m_start is intact; a rewind may lower m_next but never m_start.
+        uint64_t m_start = 0;
+        uint64_t m_next = 0;
+        uint64_t m_last_keyframe = 0;
+    };
+}    // namespace physics::snapshot
@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief Frustum culling of bounding volume arrays
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/bvh.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+/**
+ * @brief	   Namespace of visibility determination (scene)
+ *
+ * Bounding volumes are kept per coordinate (x of all objects, then y, and
+ * so on), so one SIMD instruction tests a plane against four objects.
+ * Arrays are cut into chunks that are culled on the job system; each chunk
+ * writes the indices of its visible objects, and the chunks are compacted
+ * into one sorted list. Large static sets can go through a BVH instead,
+ * where a node outside the frustum rejects its whole subtree.
+ */
+namespace scene::culling {
+
+    using mathematics::Mat4;
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using mathematics::geometry::Plane;
+
+    /**
+     * @brief	   Objects per culling job
+     */
+    constexpr size_t CULL_CHUNK = 4096;
+
+    /**
+     * @brief	   View volume as six planes with unit normals pointing inside
+     *
+     * The planes are left, right, bottom, top, near and far.
+     */
+    struct Frustum {
+        Plane planes[6];
+    };
+
+    /**
+     * @brief	   Frustum of a view-projection matrix with Vulkan clip space (depth from 0 to 1)
+     */
+    auto extract_frustum(const Mat4& view_projection) -> Frustum;
+
+    /**
+     * @brief	   Bounding spheres, one array per coordinate, padded to a multiple of four
+     */
+    class SphereArray {
+      public:
+        /**
+         * @brief	   Append a sphere
+         *
+         * @return	   its index
+         */
+        auto add(Vec3 center, float radius) -> uint32_t;
+
+        void set(uint32_t index, Vec3 center, float radius);
+
+        void clear();
+
+        auto size() const -> size_t { return m_size; }
+
+        auto center(uint32_t index) const -> Vec3 { return {m_x[index], m_y[index], m_z[index]}; }
+        auto radius(uint32_t index) const -> float { return m_radius[index]; }
+
+        auto x() const -> const float* { return m_x.data(); }
+        auto y() const -> const float* { return m_y.data(); }
+        auto z() const -> const float* { return m_z.data(); }
+        auto radii() const -> const float* { return m_radius.data(); }
+
+      private:
+        size_t m_size = 0;
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_z;
+        std::vector<float> m_radius;
+    };
+
+    /**
+     * @brief	   Axis-aligned boxes, one array per bound and coordinate, padded to a multiple of four
+     */
+    class BoxArray {
+      public:
+        /**
+         * @brief	   Append a box
+         *
+         * @return	   its index
+         */
+        auto add(const Aabb& box) -> uint32_t;
+
+        void set(uint32_t index, const Aabb& box);
+
+        void clear();
+
+        auto size() const -> size_t { return m_size; }
+
+        auto box(uint32_t index) const -> Aabb {
+            return {{m_min_x[index], m_min_y[index], m_min_z[index]},
+                    {m_max_x[index], m_max_y[index], m_max_z[index]}};
+        }
+
+        auto min_x() const -> const float* { return m_min_x.data(); }
+        auto min_y() const -> const float* { return m_min_y.data(); }
+        auto min_z() const -> const float* { return m_min_z.data(); }
+        auto max_x() const -> const float* { return m_max_x.data(); }
+        auto max_y() const -> const float* { return m_max_y.data(); }
+        auto max_z() const -> const float* { return m_max_z.data(); }
+
+      private:
+        size_t m_size = 0;
+        std::vector<float> m_min_x;
+        std::vector<float> m_min_y;
+        std::vector<float> m_min_z;
+        std::vector<float> m_max_x;
+        std::vector<float> m_max_y;
+        std::vector<float> m_max_z;
+    };
+
+    /**
+     * @brief	   Spheres not entirely outside the frustum
+     *
+     * @param[in]  frustum	The frustum
+     * @param[in]  spheres	The spheres
+     * @param[out] visible	The indices of the visible spheres, increasing
+     * @param[in]  jobs		The job system that culls the chunks
+     */
+    void cull(const Frustum& frustum,
+              const SphereArray& spheres,
+              std::vector<uint32_t>& visible,
+              utils::jobs::JobSystem& jobs);
+
+    /**
+     * @brief	   Boxes not entirely behind a frustum plane
+     *
+     * @param[in]  frustum	The frustum
+     * @param[in]  boxes	The boxes
+     * @param[out] visible	The indices of the visible boxes, increasing
+     * @param[in]  jobs		The job system that culls the chunks
+     */
+    void cull(const Frustum& frustum,
+              const BoxArray& boxes,
+              std::vector<uint32_t>& visible,
+              utils::jobs::JobSystem& jobs);
+
+    /**
+     * @brief	   Primitives of a BVH whose boxes are not entirely behind a frustum plane
+     *
+     * Rejects whole subtrees outside the frustum and stops testing planes
+     * for subtrees inside them; see physics::bvh::Bvh::overlap().
+     *
+     * @param[in]  frustum	The frustum
+     * @param[in]  bvh		The tree
+     * @param[out] visible	The primitive indices of the visible boxes, increasing
+     */
+    void cull(const Frustum& frustum, const physics::bvh::Bvh& bvh, std::vector<uint32_t>& visible);
+}    // namespace scene::culling
@@ -0,0 +1,495 @@
+/**
+ * @file
+ * @brief Archetype entity component system with chunked SoA storage
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+#include "domkrat3d/utils/pool.hpp"
+
+/**
+ * @brief	   Namespace of the entity component system (scene)
+ *
+ * Entities with the same set of components form an archetype. An archetype
+ * stores its entities in fixed-size chunks, one array per component in each
+ * chunk, so a query walks a few contiguous arrays per chunk instead of
+ * chasing pointers per entity. Chunks stay dense: removing an entity moves
+ * the last entity of the archetype into its row.
+ *
+ * Components are plain data (trivially copyable types), so moving an entity
+ * from one archetype to another is a copy of its bytes. Adding or removing
+ * components and creating or destroying entities while a query runs
+ * invalidates the arrays it walks; such changes go through a command buffer
+ * that is applied afterwards.
+ */
+namespace scene::ecs {
+
+    /**
+     * @brief	   Bytes of one chunk
+     */
+    constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    /**
+     * @brief	   Number of component types a program can register
+     */
+    constexpr size_t MAX_COMPONENTS = 64;
+
+    /**
+     * @brief	   Identifier of a component type, see component_id()
+     */
+    using ComponentId = uint32_t;
+
+    /**
+     * @brief	   Set of component types, one bit per component id
+     */
+    using ComponentMask = uint64_t;
+
+    struct EntityTag;
+
+    /**
+     * @brief	   Handle of an entity; stale once the entity is destroyed
+     */
+    using Entity = utils::pool::Handle<EntityTag>;
+
+    /**
+     * @brief	   Size and alignment of a registered component type
+     */
+    struct ComponentInfo {
+        size_t size = 0;
+        size_t alignment = 0;
+    };
+
+    /**
+     * @brief	   Register a component type; use component_id() instead
+     *
+     * @throw	   std::length_error when MAX_COMPONENTS types are registered already
+     */
+    auto register_component(size_t size, size_t alignment) -> ComponentId;
+
+    /**
+     * @brief	   Size and alignment of a registered component type
+     */
+    auto component_info(ComponentId component) -> ComponentInfo;
+
+    /**
+     * @brief	   Id of a component type, registered on first use
+     */
+    template<typename T>
+    auto component_id() -> ComponentId {
+        if constexpr (!std::is_same_v<T, std::remove_cv_t<T>>) {
+            return component_id<std::remove_cv_t<T>>();
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>, "components are moved by copying their bytes");
+
+            static ComponentId const id = register_component(sizeof(T), alignof(T));
+            return id;
+        }
+    }
+
+    /**
+     * @brief	   Set of the given component types
+     */
+    template<typename... Ts>
+    auto component_mask() -> ComponentMask {
+        return (ComponentMask {0} | ... | (ComponentMask {1} << component_id<Ts>()));
+    }
+
+    /**
+     * @brief	   Fixed-size block of entities of one archetype
+     */
+    struct Chunk {
+        std::byte* data = nullptr;
+        uint32_t count = 0;
+    };
+
+    /**
+     * @brief	   Entities with one set of components
+     *
+     * A chunk starts with the array of entity handles, followed by one
+     * array per component in order of component id, each aligned to a
+     * cache line. All chunks but the last are full.
+     */
+    struct Archetype {
+        static constexpr uint32_t ABSENT = UINT32_MAX;
+
+        ComponentMask mask = 0;
+        std::vector<ComponentId> components;
+        std::array<uint32_t, MAX_COMPONENTS> offsets {};
+        uint32_t capacity = 0;
+        std::vector<Chunk> chunks;
+
+        // Archetype reached by adding or removing a component; filled in on first use.
+        std::array<uint32_t, MAX_COMPONENTS> add_edges {};
+        std::array<uint32_t, MAX_COMPONENTS> remove_edges {};
+    };
+
+    /**
+     * @brief	   The arrays of one chunk as seen by a query
+     */
+    class ChunkView {
+      public:
+        ChunkView(const Archetype& archetype, const Chunk& chunk)
+            : m_archetype(&archetype)
+            , m_chunk(&chunk) {}
+
+        auto size() const -> size_t { return m_chunk->count; }
+
+        auto entities() const -> const Entity* { return reinterpret_cast<const Entity*>(m_chunk->data); }
+
+        /**
+         * @brief	   Array of a component in the chunk, nullptr if the archetype lacks it
+         */
+        template<typename T>
+        auto array() const -> T* {
+            uint32_t const offset = m_archetype->offsets[component_id<T>()];
+            return offset == Archetype::ABSENT ? nullptr : reinterpret_cast<T*>(m_chunk->data + offset);
+        }
+
+      private:
+        const Archetype* m_archetype;
+        const Chunk* m_chunk;
+    };
+
+    /**
+     * @brief	   Storage of all entities and their components
+     */
+    class World {
+      public:
+        World();
+        ~World();
+
+        World(const World&) = delete;
+        auto operator=(const World&) -> World& = delete;
+
+        /**
+         * @brief	   Create an entity without components
+         */
+        auto create() -> Entity;
+
+        /**
+         * @brief	   Create an entity with components
+         */
+        template<typename T, typename... Ts>
+        auto create(const T& value, const Ts&... values) -> Entity {
+            ComponentId const ids[] = {component_id<T>(), component_id<Ts>()...};
+            const void* const data[] = {&value, &values...};
+            return create_entity(ids, data, 1 + sizeof...(Ts));
+        }
+
+        /**
+         * @brief	   Create an entity from type-erased components
+         *
+         * @param[in]  components  The component ids, each at most once
+         * @param[in]  values	   The component values
+         * @param[in]  count	   The number of components
+         *
+         * @throw	   std::length_error when one entity of these components is larger than a chunk
+         */
+        auto create_entity(const ComponentId* components, const void* const* values, size_t count) -> Entity;
+
+        /**
+         * @brief	   Destroy an entity
+         *
+         * @return	   whether the entity was alive
+         */
+        auto destroy(Entity entity) -> bool;
+
+        auto alive(Entity entity) const -> bool;
+
+        /**
+         * @brief	   Add a component to an entity, or overwrite it if present
+         *
+         * @return	   whether the entity was alive
+         *
+         * @throw	   std::length_error when the entity would be larger than a chunk
+         */
+        template<typename T>
+        auto add(Entity entity, const T& value) -> bool {
+            return add_component(entity, component_id<T>(), &value);
+        }
+
+        auto add_component(Entity entity, ComponentId component, const void* value) -> bool;
+
+        /**
+         * @brief	   Remove a component from an entity
+         *
+         * @return	   whether the entity was alive and had the component
+         */
+        template<typename T>
+        auto remove(Entity entity) -> bool {
+            return remove_component(entity, component_id<T>());
+        }
+
+        auto remove_component(Entity entity, ComponentId component) -> bool;
+
+        /**
+         * @brief	   Component of an entity, nullptr if the entity is dead or lacks it
+         *
+         * The pointer is valid until the next structural change.
+         */
+        template<typename T>
+        auto get(Entity entity) -> T* {
+            return static_cast<T*>(get_component(entity, component_id<T>()));
+        }
+
+        template<typename T>
+        auto has(Entity entity) const -> bool {
+            return has_component(entity, component_id<T>());
+        }
+
+        auto get_component(Entity entity, ComponentId component) -> void*;
+        auto has_component(Entity entity, ComponentId component) const -> bool;
+
+        auto entity_count() const -> size_t { return m_records.size(); }
+        auto archetype_count() const -> size_t { return m_archetypes.size(); }
+        auto archetype(size_t index) -> Archetype& { return *m_archetypes[index]; }
+
+        /**
+         * @brief	   Chunks in use by all archetypes
+         */
+        auto chunk_count() const -> size_t;
+
+      private:
+        struct Record {
+            uint32_t archetype = 0;
+            uint32_t chunk = 0;
+            uint32_t row = 0;
+        };
+
+        auto find_archetype(ComponentMask mask) -> uint32_t;
+        auto add_edge(uint32_t archetype, ComponentId component) -> uint32_t;
+        auto remove_edge(uint32_t archetype, ComponentId component) -> uint32_t;
+        auto record(Entity entity) -> Record& { return m_records[entity]; }
+        auto record(Entity entity) const -> const Record& { return m_records[entity]; }
+        auto allocate_row(uint32_t archetype, Entity entity) -> Record;
+        void free_row(const Record& record);
+        void move_entity(Entity entity, uint32_t target);
+        auto component_pointer(const Record& record, ComponentId component) const -> std::byte*;
+
+        std::vector<std::unique_ptr<Archetype>> m_archetypes;
+        std::unordered_map<ComponentMask, uint32_t> m_archetype_index;
+        utils::pool::Pool<Record, EntityTag> m_records;
+        std::vector<std::byte*> m_free_chunks;
+    };
+
+    /**
+     * @brief	   Archetype matching shared by all queries
+     *
+     * The matching archetypes are cached and only archetypes created since
+     * the last run are checked again.
+     */
+    class QueryBase {
+      public:
+        /**
+         * @brief	   Number of entities the query visits
+         */
+        auto count() -> size_t;
+
+      protected:
+        QueryBase(World& world, ComponentMask include, ComponentMask exclude);
+
+        void refresh();
+
+        /**
+         * @brief	   Views of all non-empty matching chunks; the vector is reused between runs
+         */
+        auto collect_chunks() -> const std::vector<ChunkView>&;
+
+        World& m_world;
+        ComponentMask m_include;
+        ComponentMask m_exclude;
+        std::vector<uint32_t> m_matches;
+        size_t m_checked = 0;
+        std::vector<ChunkView> m_chunks;
+    };
+
+    /**
+     * @brief	   Cached query over the entities that have all of `Ts`
+     *
+     * A const component type marks read-only access. Bodies take the
+     * entity followed by references to the components, in order.
+     */
+    template<typename... Ts>
+    class Query : public QueryBase {
+      public:
+        /**
+         * @brief	   Construct a query
+         *
+         * @param[in]  world	The world
+         * @param[in]  exclude	The components an entity must not have
+         */
+        explicit Query(World& world, ComponentMask exclude = 0)
+            : QueryBase(world, component_mask<Ts...>(), exclude) {}
+
+        /**
+         * @brief	   Call a body for every entity, chunk by chunk
+         */
+        template<typename Body>
+        void each(Body&& body) {
+            refresh();
+            for (uint32_t const index : m_matches) {
+                const Archetype& archetype = m_world.archetype(index);
+                for (const Chunk& chunk : archetype.chunks) {
+                    run_chunk(ChunkView(archetype, chunk), body);
+                }
+            }
+        }
+
+        /**
+         * @brief	   Call a body for every non-empty chunk
+         */
+        template<typename Body>
+        void each_chunk(Body&& body) {
+            for (const ChunkView& chunk : collect_chunks()) {
+                body(chunk);
+            }
+        }
+
+        /**
+         * @brief	   each() with chunks spread over a job system
+         *
+         * The body runs concurrently for entities of different chunks.
+         */
+        template<typename Body>
+        void parallel_each(utils::jobs::JobSystem& system, Body&& body) {
+            const std::vector<ChunkView>& chunks = collect_chunks();
+            utils::parallel::parallel_for(system,
+                                          chunks.size(),
+                                          1,
+                                          [&chunks, &body](size_t begin, size_t end)
+                                          {
+                                              for (size_t i = begin; i < end; ++i) {
+                                                  run_chunk(chunks[i], body);
+                                              }
+                                          });
+        }
+
+        /**
+         * @brief	   parallel_each() on the engine-wide job system
+         */
+        template<typename Body>
+        void parallel_each(Body&& body) {
+            parallel_each(utils::jobs::global(), std::forward<Body>(body));
+        }
+
+        /**
+         * @brief	   each_chunk() with chunks spread over a job system
+         */
+        template<typename Body>
+        void parallel_each_chunk(utils::jobs::JobSystem& system, Body&& body) {
+            const std::vector<ChunkView>& chunks = collect_chunks();
+            utils::parallel::parallel_for(system,
+                                          chunks.size(),
+                                          1,
+                                          [&chunks, &body](size_t begin, size_t end)
+                                          {
+                                              for (size_t i = begin; i < end; ++i) {
+                                                  body(chunks[i]);
+                                              }
+                                          });
+        }
+
+        /**
+         * @brief	   parallel_each_chunk() on the engine-wide job system
+         */
+        template<typename Body>
+        void parallel_each_chunk(Body&& body) {
+            parallel_each_chunk(utils::jobs::global(), std::forward<Body>(body));
+        }
+
+      private:
+        template<typename Body>
+        static void run_chunk(const ChunkView& chunk, Body& body) {
+            run_chunk(chunk, body, std::make_tuple(chunk.array<Ts>()...), std::index_sequence_for<Ts...> {});
+        }
+
+        template<typename Body, typename Arrays, size_t... Is>
+        static void run_chunk(const ChunkView& chunk, Body& body, Arrays arrays, std::index_sequence<Is...>) {
+            const Entity* const entities = chunk.entities();
+            size_t const size = chunk.size();
+            for (size_t row = 0; row < size; ++row) {
+                body(entities[row], std::get<Is>(arrays)[row]...);
+            }
+        }
+    };
+
+    /**
+     * @brief	   Structural changes recorded for later
+     *
+     * Recording is thread safe, so the jobs of a parallel query may share
+     * one buffer. apply() replays the commands in order; commands for
+     * entities destroyed in between are skipped.
+     */
+    class CommandBuffer {
+      public:
+        void create();
+
+        template<typename T, typename... Ts>
+        void create(const T& value, const Ts&... values) {
+            std::lock_guard<std::mutex> const guard(m_mutex);
+            write_command(Op::Create, Entity {}, 0, static_cast<uint32_t>(1 + sizeof...(Ts)));
+            write_component(component_id<T>(), &value, sizeof(T));
+            (write_component(component_id<Ts>(), &values, sizeof(Ts)), ...);
+        }
+
+        void destroy(Entity entity);
+
+        template<typename T>
+        void add(Entity entity, const T& value) {
+            std::lock_guard<std::mutex> const guard(m_mutex);
+            write_command(Op::Add, entity, component_id<T>(), 1);
+            write_bytes(&value, sizeof(T));
+        }
+
+        template<typename T>
+        void remove(Entity entity) {
+            std::lock_guard<std::mutex> const guard(m_mutex);
+            write_command(Op::Remove, entity, component_id<T>(), 0);
+        }
+
+        auto empty() const -> bool { return m_bytes.empty(); }
+
+        /**
+         * @brief	   Replay the commands on a world and clear the buffer (keeping its memory)
+         */
+        void apply(World& world);
+
+      private:
+        enum class Op : uint32_t
+        {
+            Create,
+            Destroy,
+            Add,
+            Remove
+        };
+
+        struct Command {
+            Op op;
+            Entity entity;
+            ComponentId component;
+            uint32_t count;
+        };
+
+        void write_command(Op op, Entity entity, ComponentId component, uint32_t count);
+        void write_component(ComponentId component, const void* value, size_t size);
+        void write_bytes(const void* data, size_t size);
+
+        std::mutex m_mutex;
+        std::vector<std::byte> m_bytes;
+    };
+}    // namespace scene::ecs
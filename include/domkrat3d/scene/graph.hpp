@@ -0,0 +1,171 @@
+/**
+ * @file
+ * @brief Transform hierarchy with dirty-flag propagation
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+#include "domkrat3d/utils/pool.hpp"
+
+/**
+ * @brief	   Namespace of the transform hierarchy (scene)
+ *
+ * Local transforms live in arrays sorted by depth (breadth first), so
+ * every parent comes before its children and the children of a node are
+ * one contiguous range. Setting a local transform only marks the node
+ * dirty; update() then walks the levels in order and recomputes the world
+ * matrices of the dirty nodes and of everything below them, one level at a
+ * time across the job system. Unchanged subtrees are never visited, so an
+ * update costs what changed, not what exists.
+ *
+ * Creating, destroying and reparenting nodes only relinks them; the arrays
+ * are sorted again once, on the next update().
+ */
+namespace scene::graph {
+
+    struct NodeTag;
+
+    /**
+     * @brief	   Handle of a node; stale once the node is destroyed
+     */
+    using Node = utils::pool::Handle<NodeTag>;
+
+    /**
+     * @brief	   Transform of a node relative to its parent: scale, then rotation, then translation
+     */
+    struct LocalTransform {
+        mathematics::Vec3 position;
+        mathematics::Quat rotation;
+        mathematics::Vec3 scale {1.0F, 1.0F, 1.0F};
+    };
+
+    /**
+     * @brief	   Hierarchy of nodes with local transforms and cached world matrices
+     */
+    class SceneGraph {
+      public:
+        SceneGraph();
+
+        SceneGraph(const SceneGraph&) = delete;
+        auto operator=(const SceneGraph&) -> SceneGraph& = delete;
+
+        /**
+         * @brief	   Create a node
+         *
+         * @param[in]  local   The local transform
+         * @param[in]  parent  The parent, or a null handle for a root
+         *
+         * @throw	   std::invalid_argument when the parent is not alive
+         */
+        auto create(const LocalTransform& local = {}, Node parent = {}) -> Node;
+
+        /**
+         * @brief	   Destroy a node and all its descendants
+         *
+         * @return	   whether the node was alive
+         */
+        auto destroy(Node node) -> bool;
+
+        auto alive(Node node) const -> bool;
+
+        /**
+         * @brief	   Move a node with its subtree under another parent, keeping its local transform
+         *
+         * @throw	   std::invalid_argument when a node is not alive or the parent is in the subtree
+         */
+        void set_parent(Node node, Node parent);
+
+        /**
+         * @brief	   Parent of a live node; a null handle for a root
+         */
+        auto parent(Node node) const -> Node;
+
+        /**
+         * @brief	   Local transform of a live node
+         */
+        auto local(Node node) const -> LocalTransform;
+
+        void set_local(Node node, const LocalTransform& local);
+        void set_position(Node node, mathematics::Vec3 position);
+        void set_rotation(Node node, mathematics::Quat rotation);
+        void set_scale(Node node, mathematics::Vec3 scale);
+
+        /**
+         * @brief	   World matrix of a live node as of the last update()
+         */
+        auto world(Node node) const -> const mathematics::Mat4&;
+
+        /**
+         * @brief	   Recompute the world matrices of the dirty nodes and their descendants
+         *
+         * @param[in]  jobs	   The job system that computes each level
+         */
+        void update(utils::jobs::JobSystem& jobs);
+
+        /**
+         * @brief	   update() on the global job system
+         */
+        void update();
+
+        auto size() const -> size_t { return m_records.size(); }
+
+        /**
+         * @brief	   Number of levels as of the last update(); roots are level 0
+         */
+        auto depth() const -> size_t { return m_levels.empty() ? 0 : m_levels.size() - 1; }
+
+        /**
+         * @brief	   Number of world matrices the last update() recomputed
+         */
+        auto updated() const -> size_t { return m_updated; }
+
+      private:
+        struct Record {
+            uint32_t slot = 0;
+            Node parent;
+            Node first_child;
+            Node previous_sibling;
+            Node next_sibling;
+        };
+
+        static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+        auto record(Node node) const -> const Record&;
+        void mark_dirty(uint32_t slot);
+        void link(Node node, Node parent);
+        void unlink(Node node);
+        void relayout();
+
+        utils::pool::Pool<Record, NodeTag> m_records;
+
+        // Per slot, in breadth-first order after relayout(); new nodes are appended until then.
+        std::vector<Node> m_nodes;
+        std::vector<mathematics::Vec3> m_positions;
+        std::vector<mathematics::Quat> m_rotations;
+        std::vector<mathematics::Vec3> m_scales;
+        std::vector<uint32_t> m_parents;
+        std::vector<uint32_t> m_first_children;
+        std::vector<uint32_t> m_child_counts;
+        std::vector<uint32_t> m_depths;
+        std::vector<mathematics::Mat4> m_worlds;
+        std::vector<uint32_t> m_stamps;
+
+        // First slot of every level, then the end of the last one.
+        std::vector<uint32_t> m_levels;
+
+        std::vector<uint32_t> m_dirty;
+        std::vector<std::vector<uint32_t>> m_work;
+        uint32_t m_stamp = 0;
+        size_t m_updated = 0;
+        bool m_layout_dirty = false;
+    };
+}    // namespace scene::graph
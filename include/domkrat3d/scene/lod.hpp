@@ -0,0 +1,173 @@
+/**
+ * @file
+ * @brief Level of detail selection with hysteresis
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/scene/culling.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+/**
+ * @brief	   Namespace of level of detail selection (scene)
+ *
+ * A model registers its levels, finest first, each with the geometric
+ * error it makes (how far its surface strays from the finest one, in
+ * model units). Every frame the visible instances project that error to
+ * pixels from their bounding sphere and the camera, and each takes the
+ * coarsest level whose error stays under a pixel threshold. Switching to
+ * a coarser level needs a margin below the threshold, so an instance
+ * sitting at a boundary does not flip back and forth every frame.
+ *
+ * Instances are indices into the culling arrays; selection runs over the
+ * list culling leaves, on the job system, and sorts the result into one
+ * instance list per model and level for batched submission.
+ */
+namespace scene::lod {
+
+    using mathematics::Vec3;
+
+    /**
+     * @brief	   Most levels of a model
+     */
+    constexpr uint32_t MAX_LODS = 8;
+
+    /**
+     * @brief	   Level of a model
+     *
+     *	+ error - geometric error in model units, 0 for the finest level
+     *	+ triangles - triangle count, for statistics
+     */
+    struct LodLevel {
+        float error = 0.0F;
+        uint32_t triangles = 0;
+    };
+
+    /**
+     * @brief	   Camera as far as selection cares
+     *
+     *	+ position - eye position in world space
+     *	+ pixels_per_unit - pixels covered by one world unit at distance 1, see make_camera()
+     */
+    struct LodCamera {
+        Vec3 position;
+        float pixels_per_unit = 1.0F;
+    };
+
+    /**
+     * @brief	   Camera of a perspective projection
+     *
+     * @param[in]  position		  The eye position
+     * @param[in]  fov_y		  The vertical field of view, radians
+     * @param[in]  viewport_height  The viewport height in pixels
+     */
+    auto make_camera(Vec3 position, float fov_y, float viewport_height) -> LodCamera;
+
+    /**
+     * @brief	   Selection settings
+     *
+     *	+ pixel_error - largest projected error, in pixels, a level may show
+     *	+ hysteresis - fraction under pixel_error a coarser level must reach before it replaces the current one
+     */
+    struct LodSettings {
+        float pixel_error = 1.0F;
+        float hysteresis = 0.25F;
+    };
+
+    /**
+     * @brief	   Instances of one model and level selected by the last select()
+     */
+    struct InstanceList {
+        const uint32_t* data = nullptr;
+        size_t size = 0;
+
+        auto begin() const -> const uint32_t* { return data; }
+        auto end() const -> const uint32_t* { return data + size; }
+        auto empty() const -> bool { return size == 0; }
+    };
+
+    /**
+     * @brief	   Models with levels, instances with their current level, and per-level lists
+     */
+    class LodSelector {
+      public:
+        explicit LodSelector(const LodSettings& settings = {});
+
+        /**
+         * @brief	   Register a model
+         *
+         * @param[in]  levels  The levels, finest first, errors not decreasing
+         * @param[in]  count   The number of levels, 1 to MAX_LODS
+         *
+         * @throw	   std::invalid_argument when the count or the order of errors is wrong
+         * @return	   the model id
+         */
+        auto add_model(const LodLevel* levels, size_t count) -> uint32_t;
+
+        /**
+         * @brief	   Register the next instance; instance i has the bounds of index i of the culling arrays
+         *
+         * @throw	   std::invalid_argument when the model is not registered
+         * @return	   the instance index, starting at the finest level
+         */
+        auto add_instance(uint32_t model) -> uint32_t;
+
+        /**
+         * @brief	   Choose the level of every visible instance and build the per-level lists
+         *
+         * Instances that are not visible keep their level for when they come back.
+         *
+         * @param[in]  camera	 The camera
+         * @param[in]  bounds	 The bounding spheres of the instances
+         * @param[in]  visible	 The visible instances, e.g. the output of culling::cull()
+         * @param[in]  jobs		 The job system
+         */
+        void select(const LodCamera& camera,
+                    const culling::SphereArray& bounds,
+                    const std::vector<uint32_t>& visible,
+                    utils::jobs::JobSystem& jobs);
+
+        /**
+         * @brief	   Instances of a model drawn at a level, in the order of the visible list
+         */
+        auto instances(uint32_t model, uint32_t level) const -> InstanceList;
+
+        /**
+         * @brief	   Current level of an instance
+         */
+        auto level(uint32_t instance) const -> uint32_t { return m_levels[instance]; }
+
+        auto model_count() const -> size_t { return m_level_counts.size(); }
+        auto instance_count() const -> size_t { return m_models.size(); }
+
+        /**
+         * @brief	   Triangles of the levels the last select() chose
+         */
+        auto triangle_count() const -> uint64_t { return m_triangles; }
+
+        /**
+         * @brief	   Number of instances whose level changed in the last select()
+         */
+        auto switch_count() const -> size_t { return m_switches; }
+
+      private:
+        LodSettings m_settings;
+        std::vector<LodLevel> m_model_levels;
+        std::vector<uint32_t> m_level_counts;
+        std::vector<uint32_t> m_models;
+        std::vector<uint8_t> m_levels;
+
+        // Instances of the last select() grouped by model and level; bucket b spans
+        // [m_bucket_starts[b], m_bucket_starts[b + 1]).
+        std::vector<uint32_t> m_selected;
+        std::vector<size_t> m_bucket_starts;
+        uint64_t m_triangles = 0;
+        size_t m_switches = 0;
+    };
+}    // namespace scene::lod
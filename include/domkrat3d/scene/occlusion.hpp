@@ -0,0 +1,157 @@
+/**
+ * @file
+ * @brief Software rasterized occlusion culling
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/scene/culling.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+/**
+ * @brief	   Namespace of occlusion culling (scene)
+ *
+ * A few large occluders (buildings, terrain, walls) are rasterized on the
+ * CPU into a small depth buffer; the bounding boxes of the objects that
+ * passed frustum culling are then tested against it, and the ones entirely
+ * behind the occluders are not drawn.
+ *
+ * Occluder triangles are transformed and binned into screen tiles, then
+ * the tiles are rasterized in parallel, four pixels per SIMD instruction.
+ * Each tile also keeps the farthest depth of every 8x8 block, so most box
+ * tests are settled by a few block reads before any pixel is touched.
+ * Depth is z/w of Vulkan clip space: 0 at the near plane, 1 at the far one.
+ *
+ * Pixels are covered when their centre is inside a triangle, so an
+ * occluder covers slightly less than its exact area, and box tests cover
+ * every pixel the box touches: both err towards visible.
+ */
+namespace scene::occlusion {
+
+    using mathematics::Mat4;
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+
+    /**
+     * @brief	   Pixels per side of a rasterization job
+     */
+    constexpr uint32_t TILE_SIZE = 32;
+
+    /**
+     * @brief	   Pixels per side of a block of the coarse depth level
+     */
+    constexpr uint32_t BLOCK_SIZE = 8;
+
+    /**
+     * @brief	   Depth buffer of occluders and the tests against it
+     */
+    class OcclusionBuffer {
+      public:
+        /**
+         * @brief	   Create a buffer; both sizes are rounded up to a multiple of TILE_SIZE
+         *
+         * @throw	   std::invalid_argument when a size is zero
+         */
+        OcclusionBuffer(uint32_t width, uint32_t height);
+
+        /**
+         * @brief	   Start a frame: clear the buffer and set the camera
+         */
+        void begin(const Mat4& view_projection);
+
+        /**
+         * @brief	   Transform, clip and bin the triangles of an occluder
+         *
+         * Both faces of a triangle are drawn, so winding does not matter.
+         *
+         * @param[in]  positions	 The vertex positions in model space
+         * @param[in]  vertex_count	 The number of vertices
+         * @param[in]  indices		 Three vertex indices per triangle
+         * @param[in]  index_count	 The number of indices
+         * @param[in]  world		 Model to world
+         *
+         * @throw	   std::out_of_range when an index is not below vertex_count
+         */
+        void add_occluder(const Vec3* positions,
+                          size_t vertex_count,
+                          const uint32_t* indices,
+                          size_t index_count,
+                          const Mat4& world);
+
+        /**
+         * @brief	   Rasterize the binned triangles, tile by tile on the job system
+         */
+        void rasterize(utils::jobs::JobSystem& jobs);
+
+        /**
+         * @brief	   Whether a world box is entirely behind the occluders
+         *
+         * Boxes crossing the near plane and boxes off screen are not occluded.
+         */
+        auto occluded(const Aabb& box) const -> bool;
+
+        /**
+         * @brief	   The candidates whose boxes may be in front of the occluders
+         *
+         * @param[in]  boxes	   The boxes
+         * @param[in]  candidates  The indices to test, e.g. the output of culling::cull()
+         * @param[out] visible	   The candidates that pass, in their order
+         * @param[in]  jobs		   The job system that tests them
+         */
+        void cull(const culling::BoxArray& boxes,
+                  const std::vector<uint32_t>& candidates,
+                  std::vector<uint32_t>& visible,
+                  utils::jobs::JobSystem& jobs) const;
+
+        auto width() const -> uint32_t { return m_width; }
+        auto height() const -> uint32_t { return m_height; }
+
+        /**
+         * @brief	   Depth of the pixels, rows from the top
+         */
+        auto depth() const -> const std::vector<float>& { return m_depth; }
+
+        /**
+         * @brief	   Number of triangles binned since begin()
+         */
+        auto triangle_count() const -> size_t { return m_triangles.size(); }
+
+      private:
+        // Screen-space triangle with its edge functions and depth plane, positive inside.
+        struct Triangle {
+            float edge_a[3];
+            float edge_b[3];
+            float edge_c[3];
+            float depth_a;
+            float depth_b;
+            float depth_c;
+            float min_depth;
+            float max_depth;
+            int32_t min_x;
+            int32_t min_y;
+            int32_t max_x;
+            int32_t max_y;
+        };
+
+        void setup(Vec3 a, Vec3 b, Vec3 c);
+        void rasterize_tile(uint32_t tile);
+
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_tiles_x;
+        uint32_t m_tiles_y;
+        Mat4 m_view_projection;
+        std::vector<float> m_depth;
+        std::vector<float> m_blocks;
+        std::vector<Triangle> m_triangles;
+        std::vector<std::vector<uint32_t>> m_bins;
+    };
+}    // namespace scene::occlusion
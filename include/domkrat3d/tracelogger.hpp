@@ -20,7 +20,7 @@ class TraceLogger {
      **/
 
   public:
-    static std::string Indent;
+    static thread_local std::string Indent;
 
     /**
      * @brief Construct a new Trace Logger object
@@ -0,0 +1,196 @@
+/**
+ * @file
+ * @brief Work-stealing job system
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief	   Namespace of the job system
+ *
+ * One worker thread per core besides the calling thread. Every worker owns
+ * a Chase-Lev deque: it pushes and pops its own jobs at the bottom (most
+ * recent first, still warm in the cache) while idle workers steal from the
+ * top of other deques. Threads that are not workers submit through a
+ * shared queue. A thread waiting for its jobs runs other jobs meanwhile,
+ * so jobs may submit and wait for jobs of their own (nested loops,
+ * recursive builds) without blocking a worker.
+ *
+ * Two pinned threads take the jobs that must stay on one thread: GPU
+ * submission and blocking I/O. They run their jobs in submission order and
+ * never take part in stealing.
+ */
+namespace utils::jobs {
+
+    struct Job;
+
+    /**
+     * @brief	   Function of a job; receives the job itself with its context and range
+     */
+    using JobFunction = void (*)(const Job& job);
+
+    /**
+     * @brief	   Number of unfinished jobs of a submission; the handle to wait on
+     *
+     * A counter may be reused for the next submission once done() holds,
+     * and must outlive the jobs counted on it.
+     */
+    class Counter {
+      public:
+        auto done() const -> bool { return m_pending.load(std::memory_order_acquire) == 0; }
+
+      private:
+        friend class JobSystem;
+
+        std::atomic<size_t> m_pending {0};
+    };
+
+    /**
+     * @brief	   Unit of work: a function with a context pointer and an index range
+     *
+     * Jobs are plain data owned by the submitter and must stay alive until
+     * their counter is done; the system only stores pointers to them.
+     */
+    struct Job {
+        JobFunction function = nullptr;
+        const void* context = nullptr;
+        size_t begin = 0;
+        size_t end = 0;
+        Counter* counter = nullptr;
+    };
+
+    /**
+     * @brief	   Pinned thread a job can be sent to
+     */
+    enum class Pinned
+    {
+        Gpu,
+        Io
+    };
+
+    /**
+     * @brief	   Job system with work-stealing workers and pinned threads
+     */
+    class JobSystem {
+      public:
+        /**
+         * @brief	   Start the threads
+         *
+         * @param[in]  threads	The number of threads running jobs, the calling one included (at least 1)
+         */
+        explicit JobSystem(size_t threads);
+
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        auto operator=(const JobSystem&) -> JobSystem& = delete;
+
+        /**
+         * @brief	   Threads that run jobs: the workers and the waiting caller
+         */
+        auto thread_count() const -> size_t { return m_workers.size() + 1; }
+
+        /**
+         * @brief	   Queue jobs for the workers
+         *
+         * From a worker the jobs go to its own deque (a full deque runs the
+         * rest inline); from any other thread to the shared queue.
+         *
+         * @param[in]  jobs		The jobs
+         * @param[in]  count	The number of jobs
+         * @param[in]  counter	The counter the jobs are added to; overrides Job::counter
+         */
+        void submit(Job* jobs, size_t count, Counter& counter);
+
+        /**
+         * @brief	   Queue jobs for a pinned thread, run in order of submission
+         */
+        void submit(Pinned thread, Job* jobs, size_t count, Counter& counter);
+
+        /**
+         * @brief	   Run jobs until a counter is done
+         */
+        void wait(const Counter& counter);
+
+        /**
+         * @brief	   Run one queued job, for loops that wait on something else than a counter
+         *
+         * @return	   whether a job was run
+         */
+        auto run_one() -> bool;
+
+      private:
+        // Chase-Lev deque of job pointers with a fixed capacity.
+        class WorkDeque {
+          public:
+            WorkDeque();
+
+            auto push(Job* job) -> bool;
+            auto pop() -> Job*;
+            auto steal() -> Job*;
+
+          private:
+            static constexpr int64_t CAPACITY = 4096;
+
+            std::atomic<int64_t> m_top {0};
+            std::atomic<int64_t> m_bottom {0};
+            std::unique_ptr<std::atomic<Job*>[]> m_slots;
+        };
+
+        // FIFO of job pointers on a ring that only grows, so a steady load does not allocate.
+        class JobQueue {
+          public:
+            void push(Job* job);
+            auto pop() -> Job*;
+
+            auto empty() const -> bool { return m_size == 0; }
+            auto size() const -> size_t { return m_size; }
+
+          private:
+            std::vector<Job*> m_ring;
+            size_t m_head = 0;
+            size_t m_size = 0;
+        };
+
+        struct PinnedThread {
+            std::thread thread;
+            std::mutex mutex;
+            std::condition_variable wake;
+            JobQueue queue;
+        };
+
+        void work(size_t index);
+        void serve(PinnedThread& pinned);
+        auto find_job(size_t index) -> Job*;
+        void notify();
+
+        static void execute(Job& job);
+
+        std::vector<std::unique_ptr<WorkDeque>> m_deques;
+        std::vector<std::thread> m_workers;
+        std::mutex m_shared_mutex;
+        JobQueue m_shared;
+        std::atomic<size_t> m_shared_size {0};
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake;
+        std::atomic<uint64_t> m_epoch {0};
+        std::atomic<size_t> m_sleepers {0};
+        std::atomic<bool> m_stop {false};
+        PinnedThread m_pinned[2];
+    };
+
+    /**
+     * @brief	   The engine-wide job system, started on first use with one thread per core
+     */
+    auto global() -> JobSystem&;
+}    // namespace utils::jobs
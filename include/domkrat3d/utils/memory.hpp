@@ -0,0 +1,184 @@
+/**
+ * @file
+ * @brief Frame arena and thread-local scratch allocators
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief	   Namespace of engine allocators
+ *
+ * Both allocators are std::pmr::memory_resource, so standard containers
+ * take them directly (std::pmr::vector, std::pmr::string). Memory handed
+ * out is released all at once, never piece by piece: the frame arena at
+ * the end of the frame, a scratch stack when its scope closes. Objects
+ * placed in them are not destroyed by the allocator.
+ */
+namespace utils::memory {
+
+    /**
+     * @brief	   Linear allocator for data that lives for one frame
+     *
+     * Allocation bumps an atomic offset into one block, so several threads
+     * may allocate at the same time. A frame that needs more than the block
+     * takes the rest from the upstream resource; the next reset() frees that
+     * and grows the block past the peak, so the following frames fit again.
+     * Otherwise reset() is constant time.
+     */
+    class LinearArena : public std::pmr::memory_resource {
+      public:
+        /**
+         * @brief	   Construct an arena
+         *
+         * @param[in]  capacity	 The bytes of the block
+         * @param[in]  upstream	 The resource of the block and of overflow
+         */
+        explicit LinearArena(size_t capacity,
+                             std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+        ~LinearArena() override;
+
+        LinearArena(const LinearArena&) = delete;
+        auto operator=(const LinearArena&) -> LinearArena& = delete;
+
+        /**
+         * @brief	   Uninitialized array of trivially destructible elements
+         */
+        template<typename T>
+        auto allocate_array(size_t count) -> T* {
+            return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        }
+
+        /**
+         * @brief	   Release everything allocated since the last reset; no allocation may be in flight
+         */
+        void reset();
+
+        /**
+         * @brief	   Bytes allocated since the last reset, overflow included
+         */
+        auto used() const -> size_t;
+
+        auto capacity() const -> size_t { return m_capacity; }
+
+        /**
+         * @brief	   Largest used() seen at a reset
+         */
+        auto peak() const -> size_t { return m_peak; }
+
+      private:
+        struct Overflow {
+            void* data;
+            size_t size;
+            size_t alignment;
+        };
+
+        auto do_allocate(size_t bytes, size_t alignment) -> void* override;
+        void do_deallocate(void* data, size_t bytes, size_t alignment) override;
+        auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override;
+
+        std::pmr::memory_resource* m_upstream;
+        std::byte* m_block = nullptr;
+        size_t m_capacity;
+        std::atomic<size_t> m_offset {0};
+        mutable std::mutex m_overflow_mutex;
+        std::vector<Overflow> m_overflow;
+        size_t m_overflow_bytes = 0;
+        size_t m_peak = 0;
+    };
+
+    /**
+     * @brief	   Stack allocator for temporary data of one thread
+     *
+     * Memory comes from blocks that are kept once allocated, so after the
+     * first few uses a scope of scratch work does not touch the heap. Only
+     * the most recent allocation is actually freed by deallocate() (the old
+     * buffer of a growing container usually is not); everything else goes
+     * when the stack is rewound to a marker, see ScratchScope.
+     */
+    class ScratchStack : public std::pmr::memory_resource {
+      public:
+        /**
+         * @brief	   Position of the stack to rewind to
+         */
+        struct Marker {
+            size_t block = 0;
+            size_t offset = 0;
+        };
+
+        /**
+         * @brief	   Construct a stack
+         *
+         * @param[in]  block_size  The bytes of a block; larger allocations get a block of their own
+         */
+        explicit ScratchStack(size_t block_size = 256 * 1024);
+
+        ~ScratchStack() override;
+
+        ScratchStack(const ScratchStack&) = delete;
+        auto operator=(const ScratchStack&) -> ScratchStack& = delete;
+
+        auto marker() const -> Marker { return {m_current, m_offset}; }
+
+        /**
+         * @brief	   Free everything allocated after a marker was taken
+         */
+        void rewind(Marker marker);
+
+        /**
+         * @brief	   Bytes held in blocks
+         */
+        auto reserved() const -> size_t;
+
+      private:
+        struct Block {
+            std::byte* data;
+            size_t size;
+        };
+
+        auto do_allocate(size_t bytes, size_t alignment) -> void* override;
+        void do_deallocate(void* data, size_t bytes, size_t alignment) override;
+        auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override;
+
+        size_t m_block_size;
+        std::vector<Block> m_blocks;
+        size_t m_current = 0;
+        size_t m_offset = 0;
+    };
+
+    /**
+     * @brief	   Scratch stack of the calling thread
+     */
+    auto scratch() -> ScratchStack&;
+
+    /**
+     * @brief	   Rewinds a scratch stack to where it was when the scope was opened
+     *
+     * Containers using resource() must be destroyed (or no longer used)
+     * before the scope closes.
+     */
+    class ScratchScope {
+      public:
+        explicit ScratchScope(ScratchStack& stack = scratch())
+            : m_stack(stack)
+            , m_marker(stack.marker()) {}
+
+        ~ScratchScope() { m_stack.rewind(m_marker); }
+
+        ScratchScope(const ScratchScope&) = delete;
+        auto operator=(const ScratchScope&) -> ScratchScope& = delete;
+
+        auto resource() const -> ScratchStack& { return m_stack; }
+
+      private:
+        ScratchStack& m_stack;
+        ScratchStack::Marker m_marker;
+    };
+}    // namespace utils::memory
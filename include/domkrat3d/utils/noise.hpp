@@ -0,0 +1,183 @@
+/**
+ * @file
+ * @brief Procedural gradient and value noise
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief	   Namespace of procedural noise generators
+ *
+ * Lattice values and gradients come from an integer hash of the cell
+ * coordinates and the seed instead of a permutation table, so four samples
+ * are evaluated per SIMD instruction without gathers. Scalar and batch
+ * functions share the same kernels and return identical values.
+ */
+namespace utils::noise {
+
+    /**
+     * @brief Base noise function
+     */
+    enum class NoiseType
+    {
+        Value,
+        Perlin,
+        Simplex
+    };
+
+    /**
+     * @brief Octave combinator applied on top of the base noise
+     */
+    enum class Fractal
+    {
+        None,
+        Fbm,
+        Ridged
+    };
+
+    /**
+     * @brief	   Noise evaluation parameters
+     */
+    struct NoiseSettings {
+        NoiseType type = NoiseType::Simplex;
+        Fractal fractal = Fractal::Fbm;
+        uint32_t seed = 1337;
+        int octaves = 5;
+        float frequency = 1.0F;
+        float lacunarity = 2.0F;
+        float gain = 0.5F;
+    };
+
+    /**
+     * @brief	   Value noise, range [-1, 1]
+     *
+     * @param[in]  x	 x coordinate
+     * @param[in]  y	 y coordinate
+     * @param[in]  seed  The seed
+     *
+     * @return	   noise value
+     */
+    auto value(float x, float y, uint32_t seed) -> float;
+    auto value(float x, float y, float z, uint32_t seed) -> float;
+    auto value(float x, float y, float z, float w, uint32_t seed) -> float;
+
+    /**
+     * @brief	   Classic (improved) Perlin gradient noise, range about [-1, 1]
+     *
+     * @param[in]  x	 x coordinate
+     * @param[in]  y	 y coordinate
+     * @param[in]  seed  The seed
+     *
+     * @return	   noise value
+     */
+    auto perlin(float x, float y, uint32_t seed) -> float;
+    auto perlin(float x, float y, float z, uint32_t seed) -> float;
+    auto perlin(float x, float y, float z, float w, uint32_t seed) -> float;
+
+    /**
+     * @brief	   Simplex noise, range about [-1, 1]
+     *
+     * @param[in]  x	 x coordinate
+     * @param[in]  y	 y coordinate
+     * @param[in]  seed  The seed
+     *
+     * @return	   noise value
+     */
+    auto simplex(float x, float y, uint32_t seed) -> float;
+    auto simplex(float x, float y, float z, uint32_t seed) -> float;
+    auto simplex(float x, float y, float z, float w, uint32_t seed) -> float;
+
+    /**
+     * @brief	   Evaluate noise with fractal settings at a single point
+     *
+     * @param[in]  settings  The settings
+     * @param[in]  x		 x coordinate
+     * @param[in]  y		 y coordinate
+     *
+     * @return	   noise value
+     */
+    auto sample(const NoiseSettings& settings, float x, float y) -> float;
+    auto sample(const NoiseSettings& settings, float x, float y, float z) -> float;
+    auto sample(const NoiseSettings& settings, float x, float y, float z, float w) -> float;
+
+    /**
+     * @brief	   Evaluate 2D noise for arrays of coordinates
+     *
+     * @param[in]  settings  The settings
+     * @param[in]  x		 x coordinates
+     * @param[in]  y		 y coordinates
+     * @param[out] out		 results
+     * @param[in]  count	 The number of points
+     */
+    void evaluate(const NoiseSettings& settings, const float* x, const float* y, float* out, size_t count);
+
+    /**
+     * @brief	   Evaluate 3D noise for arrays of coordinates
+     */
+    void evaluate(const NoiseSettings& settings,
+                  const float* x,
+                  const float* y,
+                  const float* z,
+                  float* out,
+                  size_t count);
+
+    /**
+     * @brief	   Evaluate 4D noise for arrays of coordinates
+     */
+    void evaluate(const NoiseSettings& settings,
+                  const float* x,
+                  const float* y,
+                  const float* z,
+                  const float* w,
+                  float* out,
+                  size_t count);
+
+    /**
+     * @brief	   Fill a row-major 2D grid (e.g. a heightmap)
+     *
+     * Sample (column, row) is taken at (origin_x + column * step, origin_y +
+     * row * step). Rows are distributed across worker threads.
+     *
+     * @param[in]  settings  The settings
+     * @param[out] out		 width * height results
+     * @param[in]  width	 The width
+     * @param[in]  height	 The height
+     * @param[in]  origin_x  The origin x
+     * @param[in]  origin_y  The origin y
+     * @param[in]  step		 The distance between samples
+     */
+    void evaluate_grid(const NoiseSettings& settings,
+                       float* out,
+                       size_t width,
+                       size_t height,
+                       float origin_x = 0.0F,
+                       float origin_y = 0.0F,
+                       float step = 1.0F);
+
+    /**
+     * @brief	   Fill a 3D grid (e.g. a density volume), x fastest then y then z
+     *
+     * @param[in]  settings  The settings
+     * @param[out] out		 width * height * depth results
+     * @param[in]  width	 The width
+     * @param[in]  height	 The height
+     * @param[in]  depth	 The depth
+     * @param[in]  origin_x  The origin x
+     * @param[in]  origin_y  The origin y
+     * @param[in]  origin_z  The origin z
+     * @param[in]  step		 The distance between samples
+     */
+    void evaluate_volume(const NoiseSettings& settings,
+                         float* out,
+                         size_t width,
+                         size_t height,
+                         size_t depth,
+                         float origin_x = 0.0F,
+                         float origin_y = 0.0F,
+                         float origin_z = 0.0F,
+                         float step = 1.0F);
+}    // namespace utils::noise
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief Data-parallel loop helpers
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+#include "domkrat3d/utils/memory.hpp"
+
+/**
+ * @brief	   Namespace of parallel loop helpers
+ *
+ * The loops run on a job system (by default the engine-wide one, see
+ * jobs::global()); the calling thread takes part in the work and may itself
+ * be a job, so loops nest.
+ */
+namespace utils::parallel {
+
+    /**
+     * @brief	   Range body: processes the half-open index range [begin, end)
+     */
+    using RangeBody = std::function<void(size_t begin, size_t end)>;
+
+    /**
+     * @brief	   Number of threads a parallel loop may use (at least 1)
+     *
+     * @return	   worker count
+     */
+    auto worker_count() -> size_t;
+
+    /**
+     * @brief	   Run a loop over [0, count) split into ranges on several threads
+     *
+     * The range is cut into chunks of at least `grain` indices; chunks are
+     * handed out dynamically and the calling thread takes part in the work.
+     * Small loops (count <= grain) run inline without touching other threads.
+     * The body must be safe to run concurrently on disjoint ranges.
+     *
+     * @param[in]  system  The job system
+     * @param[in]  count   The number of indices
+     * @param[in]  grain   The minimal chunk size
+     * @param[in]  body	   The range body
+     */
+    void parallel_for(jobs::JobSystem& system, size_t count, size_t grain, const RangeBody& body);
+
+    /**
+     * @brief	   parallel_for() on the engine-wide job system
+     */
+    void parallel_for(size_t count, size_t grain, const RangeBody& body);
+
+    /**
+     * @brief	   Reduce a loop over [0, count) on several threads
+     *
+     * The range is cut into chunks of exactly `grain` indices whatever the
+     * number of threads, and the chunk results are combined in index order,
+     * so floating-point results do not change with the thread count.
+     *
+     * @param[in]  count	The number of indices
+     * @param[in]  grain	The chunk size
+     * @param[in]  identity The neutral value of combine
+     * @param[in]  map		Range function: (begin, end) -> value of the chunk
+     * @param[in]  combine	Binary function: (value, value) -> value
+     *
+     * @return	   combined value, identity for an empty range
+     */
+    template<typename T, typename Map, typename Combine>
+    auto parallel_reduce(size_t count, size_t grain, T identity, const Map& map, const Combine& combine)
+        -> T {
+        grain = std::max<size_t>(grain, 1);
+        size_t const chunks = (count + grain - 1) / grain;
+        memory::ScratchScope const scope;
+        std::pmr::vector<T> partial(chunks, identity, &scope.resource());
+
+        // Two references: small enough for the body to be stored without a heap allocation.
+        auto const reduce_chunk = [&map, grain, count](size_t chunk) -> T
+        {
+            size_t const first = chunk * grain;
+            return map(first, std::min(first + grain, count));
+        };
+        parallel_for(chunks,
+                     1,
+                     [&partial, &reduce_chunk](size_t begin, size_t end)
+                     {
+                         for (size_t chunk = begin; chunk < end; ++chunk) {
+                             partial[chunk] = reduce_chunk(chunk);
+                         }
+                     });
+
+        T result = identity;
+        for (const T& value : partial) {
+            result = combine(result, value);
+        }
+        return result;
+    }
+}    // namespace utils::parallel
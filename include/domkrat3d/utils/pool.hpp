@@ -0,0 +1,263 @@
+/**
+ * @file
+ * @brief Object pools addressed by generational handles
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief	   Namespace of generational object pools
+ *
+ * A pool keeps its objects in an array of slots whose indices never
+ * change. A handle is 32 bits: the slot index and the generation the slot
+ * had when the object was created. Destroying an object bumps the
+ * generation, so old handles stop matching and a lookup of a stale handle
+ * returns nullptr instead of another object. The lowest generation bit
+ * tells whether a slot is live, which lets iteration sweep the slot array
+ * in order without a separate list.
+ */
+namespace utils::pool {
+
+    /**
+     * @brief	   Generational handle of an object in a pool of `Tag`
+     *
+     * The default handle is null and never refers to an object.
+     */
+    template<typename Tag>
+    class Handle {
+      public:
+        static constexpr uint32_t INDEX_BITS = 20;
+        static constexpr uint32_t GENERATION_BITS = 32 - INDEX_BITS;
+        static constexpr uint32_t INDEX_MASK = (1U << INDEX_BITS) - 1;
+        static constexpr uint32_t GENERATION_MASK = (1U << GENERATION_BITS) - 1;
+
+        constexpr Handle() = default;
+
+        constexpr Handle(uint32_t index, uint32_t generation)
+            : m_value((generation << INDEX_BITS) | (index & INDEX_MASK)) {}
+
+        constexpr auto index() const -> uint32_t { return m_value & INDEX_MASK; }
+        constexpr auto generation() const -> uint32_t { return m_value >> INDEX_BITS; }
+        constexpr auto value() const -> uint32_t { return m_value; }
+        constexpr auto is_null() const -> bool { return m_value == 0; }
+
+        constexpr auto operator==(const Handle& other) const -> bool { return m_value == other.m_value; }
+        constexpr auto operator!=(const Handle& other) const -> bool { return m_value != other.m_value; }
+
+      private:
+        uint32_t m_value = 0;
+    };
+
+    /**
+     * @brief	   Pool of objects of type `T` with handles of `Tag`
+     *
+     * Creating and destroying are O(1) through a free list. Freed slots are
+     * reused oldest first, which spreads reuse over all free slots and keeps
+     * a slot's generation from wrapping around soon. Objects move only when
+     * the slot array grows, so pointers from get() are valid until the next
+     * create().
+     */
+    template<typename T, typename Tag = T>
+    class Pool {
+      public:
+        using HandleType = Handle<Tag>;
+
+        /**
+         * @brief	   Number of slots a pool can have
+         */
+        static constexpr uint32_t MAX_SLOTS = HandleType::INDEX_MASK + 1;
+
+        Pool() = default;
+
+        ~Pool() {
+            clear();
+            release(m_slots);
+        }
+
+        Pool(const Pool&) = delete;
+        auto operator=(const Pool&) -> Pool& = delete;
+
+        /**
+         * @brief	   Construct an object in a free slot
+         *
+         * @throw	   std::length_error when all MAX_SLOTS slots are live
+         */
+        template<typename... Args>
+        auto create(Args&&... args) -> HandleType {
+            uint32_t index = m_free_head;
+            if (index == NONE) {
+                if (m_slot_count == MAX_SLOTS) {
+                    throw std::length_error("pool is full");
+                }
+                if (m_slot_count == m_capacity) {
+                    reserve(m_capacity == 0 ? 16 : m_capacity * 2);
+                }
+                index = m_slot_count;
+                m_slots[index].generation = 0;
+            }
+
+            // Construct first, so a throwing constructor leaves the pool as it was.
+            Slot& slot = m_slots[index];
+            new (slot.storage) T(std::forward<Args>(args)...);
+            if (index == m_free_head) {
+                m_free_head = slot.next_free;
+                if (m_free_head == NONE) {
+                    m_free_tail = NONE;
+                }
+            } else {
+                ++m_slot_count;
+            }
+
+            slot.generation = (slot.generation + 1) & HandleType::GENERATION_MASK;
+            ++m_size;
+            return HandleType(index, slot.generation);
+        }
+
+        /**
+         * @brief	   Destroy the object of a handle
+         *
+         * @return	   whether the handle was live
+         */
+        auto destroy(HandleType handle) -> bool {
+            T* const object = get(handle);
+            if (object == nullptr) {
+                return false;
+            }
+
+            object->~T();
+            uint32_t const index = handle.index();
+            Slot& slot = m_slots[index];
+            slot.generation = (slot.generation + 1) & HandleType::GENERATION_MASK;
+            slot.next_free = NONE;
+            if (m_free_tail == NONE) {
+                m_free_head = index;
+            } else {
+                m_slots[m_free_tail].next_free = index;
+            }
+            m_free_tail = index;
+            --m_size;
+            return true;
+        }
+
+        /**
+         * @brief	   Object of a handle, nullptr for a null or stale handle
+         */
+        auto get(HandleType handle) -> T* {
+            uint32_t const index = handle.index();
+            if (index >= m_slot_count) {
+                return nullptr;
+            }
+            Slot& slot = m_slots[index];
+            return slot.generation == handle.generation() ? object(slot) : nullptr;
+        }
+
+        auto get(HandleType handle) const -> const T* { return const_cast<Pool*>(this)->get(handle); }
+
+        auto contains(HandleType handle) const -> bool { return get(handle) != nullptr; }
+
+        /**
+         * @brief	   Object of a handle known to be live, without any check
+         */
+        auto operator[](HandleType handle) -> T& { return *object(m_slots[handle.index()]); }
+
+        auto operator[](HandleType handle) const -> const T& {
+            return *object(m_slots[handle.index()]);
+        }
+
+        /**
+         * @brief	   Number of live objects
+         */
+        auto size() const -> size_t { return m_size; }
+
+        auto empty() const -> bool { return m_size == 0; }
+
+        auto capacity() const -> size_t { return m_capacity; }
+
+        /**
+         * @brief	   Allocate slots ahead, up to MAX_SLOTS
+         */
+        void reserve(size_t capacity) {
+            capacity = std::min<size_t>(capacity, MAX_SLOTS);
+            if (capacity <= m_capacity) {
+                return;
+            }
+
+            auto* const slots =
+                static_cast<Slot*>(::operator new(capacity * sizeof(Slot), std::align_val_t {alignof(Slot)}));
+            for (uint32_t index = 0; index < m_slot_count; ++index) {
+                Slot& from = m_slots[index];
+                Slot& to = slots[index];
+                to.generation = from.generation;
+                to.next_free = from.next_free;
+                if (live(from)) {
+                    new (to.storage) T(std::move(*object(from)));
+                    object(from)->~T();
+                }
+            }
+
+            release(m_slots);
+            m_slots = slots;
+            m_capacity = static_cast<uint32_t>(capacity);
+        }
+
+        /**
+         * @brief	   Call a function with the handle and object of every live slot, in slot order
+         */
+        template<typename Function>
+        void each(Function&& function) {
+            for (uint32_t index = 0; index < m_slot_count; ++index) {
+                Slot& slot = m_slots[index];
+                if (live(slot)) {
+                    function(HandleType(index, slot.generation), *object(slot));
+                }
+            }
+        }
+
+        /**
+         * @brief	   Destroy all objects; their handles become stale, the slots stay allocated
+         */
+        void clear() {
+            for (uint32_t index = 0; index < m_slot_count; ++index) {
+                if (live(m_slots[index])) {
+                    destroy(HandleType(index, m_slots[index].generation));
+                }
+            }
+        }
+
+      private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        struct Slot {
+            uint32_t generation;
+            uint32_t next_free;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        static auto live(const Slot& slot) -> bool { return (slot.generation & 1U) != 0; }
+
+        static auto object(Slot& slot) -> T* { return std::launder(reinterpret_cast<T*>(slot.storage)); }
+
+        static auto object(const Slot& slot) -> const T* {
+            return std::launder(reinterpret_cast<const T*>(slot.storage));
+        }
+
+        static void release(Slot* slots) { ::operator delete(slots, std::align_val_t {alignof(Slot)}); }
+
+        Slot* m_slots = nullptr;
+        uint32_t m_capacity = 0;
+        uint32_t m_slot_count = 0;
+        uint32_t m_free_head = NONE;
+        uint32_t m_free_tail = NONE;
+        size_t m_size = 0;
+    };
+}    // namespace utils::pool
@@ -1,8 +1,293 @@
+/**
+ * @file
+ * @brief Pseudo-random number generation utils
+ * @authors alexeev-prog
+ */
+
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 /**
  * @brief Generate random float (for color)
  *
- * @return float
+ * Draws from the calling thread's engine (see utils::random::thread_engine()),
+ * so consecutive calls return independent values.
+ *
+ * @return float in [0, 1)
  **/
 auto generate_random_float() -> float;
+
+/**
+ * @brief	   Namespace of random number generators and distributions
+ */
+namespace utils::random {
+
+    /**
+     * @brief Seed used by engines constructed without an explicit seed
+     */
+    constexpr uint64_t DEFAULT_SEED = 0x9E3779B97F4A7C15ULL;
+
+    /**
+     * @brief	   xoshiro256** pseudo-random number generator
+     *
+     * 256 bits of state, period 2^256 - 1, passes BigCrush. jump() and
+     * long_jump() advance the state by 2^128 and 2^192 steps, which is how
+     * independent streams for parallel work are derived (see split()).
+     *
+     * Satisfies UniformRandomBitGenerator, so it can also drive the
+     * <random> distributions.
+     */
+    class Xoshiro256 {
+      public:
+        using result_type = uint64_t;
+
+        /**
+         * @brief	   Construct an engine from a 64-bit seed
+         *
+         * The seed is expanded with splitmix64, so any value (including 0)
+         * gives a well-mixed state.
+         *
+         * @param[in]  seed  The seed
+         */
+        explicit Xoshiro256(uint64_t seed = DEFAULT_SEED);
+
+        /**
+         * @brief	   Construct an engine from a raw state (must not be all zero)
+         */
+        Xoshiro256(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3);
+
+        static constexpr auto min() -> result_type { return 0; }
+
+        static constexpr auto max() -> result_type { return UINT64_MAX; }
+
+        auto operator()() -> result_type { return next(); }
+
+        /**
+         * @brief	   Next 64 random bits
+         */
+        auto next() -> uint64_t {
+            uint64_t const result = rotl(m_state[1] * 5, 7) * 9;
+            uint64_t const shifted = m_state[1] << 17U;
+
+            m_state[2] ^= m_state[0];
+            m_state[3] ^= m_state[1];
+            m_state[1] ^= m_state[2];
+            m_state[0] ^= m_state[3];
+            m_state[2] ^= shifted;
+            m_state[3] = rotl(m_state[3], 45);
+
+            return result;
+        }
+
+        /**
+         * @brief	   Uniform float in [0, 1) with 24 bits of precision
+         */
+        auto next_float() -> float { return static_cast<float>(next() >> 40U) * 0x1.0p-24F; }
+
+        /**
+         * @brief	   Uniform double in [0, 1) with 53 bits of precision
+         */
+        auto next_double() -> double { return static_cast<double>(next() >> 11U) * 0x1.0p-53; }
+
+        /**
+         * @brief	   Uniform float in [min, max)
+         */
+        auto uniform(float min, float max) -> float { return min + ((max - min) * next_float()); }
+
+        /**
+         * @brief	   Uniform double in [min, max)
+         */
+        auto uniform(double min, double max) -> double { return min + ((max - min) * next_double()); }
+
+        /**
+         * @brief	   Unbiased uniform integer in [min, max] (Lemire's method)
+         *
+         * @param[in]  min	The lower bound (inclusive)
+         * @param[in]  max	The upper bound (inclusive)
+         *
+         * @return	   random integer
+         */
+        auto uniform_int(int32_t min, int32_t max) -> int32_t;
+
+        /**
+         * @brief	   Normally distributed float (Box-Muller)
+         *
+         * @param[in]  mean	   The mean
+         * @param[in]  stddev  The standard deviation
+         *
+         * @return	   random float
+         */
+        auto normal(float mean = 0.0F, float stddev = 1.0F) -> float;
+
+        /**
+         * @brief	   Uniform direction on the unit sphere
+         *
+         * @param[out] x  x component
+         * @param[out] y  y component
+         * @param[out] z  z component
+         */
+        void on_unit_sphere(float& x, float& y, float& z);
+
+        /**
+         * @brief	   Advance the state by 2^128 steps
+         */
+        void jump();
+
+        /**
+         * @brief	   Advance the state by 2^192 steps
+         */
+        void long_jump();
+
+        /**
+         * @brief	   Split off an independent stream
+         *
+         * Returns a copy of the current stream and jumps this engine 2^128
+         * steps ahead, so the two never overlap. Repeated splits hand out
+         * consecutive non-overlapping streams, e.g. one per worker thread.
+         *
+         * @return	   engine for the split-off stream
+         */
+        auto split() -> Xoshiro256;
+
+      private:
+        friend class BatchEngine;
+
+        uint64_t m_state[4];
+
+        static constexpr auto rotl(uint64_t x, unsigned int k) -> uint64_t {
+            return (x << k) | (x >> (64U - k));
+        }
+
+        void apply_jump(const uint64_t (&polynomial)[4]);
+    };
+
+    /**
+     * @brief	   Engine owned by the calling thread
+     *
+     * Every thread receives its own stream split from a shared source on
+     * first use, so no locking happens after that and threads never share
+     * state.
+     *
+     * @return	   reference to the thread-local engine
+     */
+    auto thread_engine() -> Xoshiro256&;
+
+    /**
+     * @brief	   Reseed the source of thread engines
+     *
+     * The calling thread's engine is reseeded immediately; other threads keep
+     * their current stream, threads started afterwards get streams derived
+     * from the new seed.
+     *
+     * @param[in]  seed  The seed
+     */
+    void seed_thread_engines(uint64_t seed);
+
+    /**
+     * @brief	   Multi-lane xoshiro256** for batch generation
+     *
+     * Holds LANES independent streams in structure-of-arrays form. The state
+     * update of all lanes is one straight-line loop that the compiler maps
+     * onto vector instructions, so filling a buffer costs a few instructions
+     * per 64 random bits.
+     */
+    class BatchEngine {
+      public:
+        static constexpr size_t LANES = 8;
+
+        /**
+         * @brief	   Build lanes from a seed
+         */
+        explicit BatchEngine(uint64_t seed = DEFAULT_SEED);
+
+        /**
+         * @brief	   Build lanes by splitting streams off an existing engine
+         *
+         * @param	   source  The source engine (advanced by LANES jumps)
+         */
+        explicit BatchEngine(Xoshiro256& source);
+
+        /**
+         * @brief	   Produce one 64-bit value per lane
+         *
+         * @param[out] out	LANES values
+         */
+        void next_block(uint64_t* out);
+
+      private:
+        void seed_lanes(Xoshiro256& source);
+
+        alignas(64) uint64_t m_s0[LANES];
+        alignas(64) uint64_t m_s1[LANES];
+        alignas(64) uint64_t m_s2[LANES];
+        alignas(64) uint64_t m_s3[LANES];
+    };
+
+    /**
+     * @brief	   Fill a buffer with raw 64-bit random values
+     */
+    void fill_bits(BatchEngine& engine, uint64_t* out, size_t count);
+
+    /**
+     * @brief	   Fill a buffer with uniform floats in [min, max)
+     *
+     * @param	   engine  The batch engine
+     * @param[out] out	   The buffer
+     * @param[in]  count   The number of values
+     * @param[in]  min	   The lower bound
+     * @param[in]  max	   The upper bound
+     */
+    void fill_uniform(BatchEngine& engine, float* out, size_t count, float min = 0.0F, float max = 1.0F);
+
+    /**
+     * @brief	   Fill a buffer with uniform doubles in [min, max)
+     */
+    void fill_uniform(BatchEngine& engine, double* out, size_t count, double min = 0.0, double max = 1.0);
+
+    /**
+     * @brief	   Fill a buffer with uniform integers in [min, max]
+     *
+     * Uses the multiply-shift range reduction without rejection; the bias is
+     * below (max - min + 1) / 2^32 and irrelevant for simulation use.
+     */
+    void fill_uniform_int(BatchEngine& engine, int32_t* out, size_t count, int32_t min, int32_t max);
+
+    /**
+     * @brief	   Fill a buffer with normally distributed floats (vectorized Box-Muller)
+     */
+    void fill_normal(BatchEngine& engine, float* out, size_t count, float mean = 0.0F, float stddev = 1.0F);
+
+    /**
+     * @brief	   Fill SoA buffers with uniform directions on the unit sphere
+     *
+     * @param	   engine  The batch engine
+     * @param[out] x	   x components
+     * @param[out] y	   y components
+     * @param[out] z	   z components
+     * @param[in]  count   The number of directions
+     */
+    void fill_unit_sphere(BatchEngine& engine, float* x, float* y, float* z, size_t count);
+
+    /**
+     * @brief	   Fill SoA buffers with uniform directions on a hemisphere
+     *
+     * @param	   engine  The batch engine
+     * @param[out] x	   x components
+     * @param[out] y	   y components
+     * @param[out] z	   z components
+     * @param[in]  count   The number of directions
+     * @param[in]  nx	   hemisphere normal x (unit length)
+     * @param[in]  ny	   hemisphere normal y
+     * @param[in]  nz	   hemisphere normal z
+     */
+    void fill_hemisphere(BatchEngine& engine,
+                         float* x,
+                         float* y,
+                         float* z,
+                         size_t count,
+                         float nx = 0.0F,
+                         float ny = 0.0F,
+                         float nz = 1.0F);
+}    // namespace utils::random
@@ -0,0 +1,107 @@
+/**
+ * @file
+ * @brief Lock-free single-producer single-consumer ring buffer
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief	   Namespace of lock-free rings
+ */
+namespace utils::ring {
+
+    /**
+     * @brief	   Bounded queue between exactly one producer thread and one consumer thread
+     *
+     * Neither side locks or waits: push() fails when the ring is full and
+     * pop() when it is empty. Each index is written by one side only and
+     * sits on a cache line of its own; each side also keeps a copy of the
+     * other side's index and reloads it only when the copy says the ring is
+     * full (or empty), so a busy producer and consumer rarely touch each
+     * other's line.
+     *
+     * @tparam	   T		 The element, trivially copyable
+     * @tparam	   Capacity	 The number of elements, a power of two
+     */
+    template<typename T, size_t Capacity>
+    class SpscRing {
+        static_assert(std::is_trivially_copyable_v<T>, "ring elements are copied as plain data");
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+      public:
+        static constexpr size_t CAPACITY = Capacity;
+
+        /**
+         * @brief	   Append an element; producer only
+         *
+         * @return	   false when the ring is full and the element was not added
+         */
+        auto push(const T& value) -> bool {
+            size_t const tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cached_head == Capacity) {
+                m_cached_head = m_head.load(std::memory_order_acquire);
+                if (tail - m_cached_head == Capacity) {
+                    return false;
+                }
+            }
+
+            m_values[tail & MASK] = value;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief	   Take the oldest element; consumer only
+         *
+         * @return	   false when the ring is empty
+         */
+        auto pop(T& value) -> bool { return pop(&value, 1) == 1; }
+
+        /**
+         * @brief	   Take up to `count` of the oldest elements at once; consumer only
+         *
+         * @return	   the number of elements taken
+         */
+        auto pop(T* values, size_t count) -> size_t {
+            size_t const head = m_head.load(std::memory_order_relaxed);
+            if (m_cached_tail - head < count) {
+                m_cached_tail = m_tail.load(std::memory_order_acquire);
+            }
+
+            size_t const taken = std::min(count, m_cached_tail - head);
+            for (size_t i = 0; i < taken; ++i) {
+                values[i] = m_values[(head + i) & MASK];
+            }
+            if (taken > 0) {
+                m_head.store(head + taken, std::memory_order_release);
+            }
+            return taken;
+        }
+
+        /**
+         * @brief	   Number of elements; exact only on the consumer or producer thread when the other is idle
+         */
+        auto size() const -> size_t {
+            return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+        }
+
+        auto empty() const -> bool { return size() == 0; }
+
+      private:
+        static constexpr size_t MASK = Capacity - 1;
+        static constexpr size_t CACHE_LINE = 64;
+
+        alignas(CACHE_LINE) std::atomic<size_t> m_head {0};
+        size_t m_cached_tail = 0;
+        alignas(CACHE_LINE) std::atomic<size_t> m_tail {0};
+        size_t m_cached_head = 0;
+        alignas(CACHE_LINE) std::array<T, Capacity> m_values {};
+    };
+}    // namespace utils::ring
@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief Frame task graph scheduled on the job system
+ * @authors alexeev-prog
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+
+/**
+ * @brief	   Namespace of the frame task graph
+ *
+ * Systems declare the work of a frame as tasks, each with the resources it
+ * reads and writes. Dependencies follow from declaration order: a task runs
+ * after the last earlier task that writes one of its resources, and a task
+ * that writes a resource also runs after the earlier tasks that read it.
+ * Tasks without such a conflict run in parallel on the job system. The
+ * graph is compiled once and run every frame without allocating.
+ */
+namespace utils::tasks {
+
+    /**
+     * @brief	   Identifier of a resource, see TaskGraph::add_resource()
+     */
+    using ResourceId = uint32_t;
+
+    /**
+     * @brief	   Identifier of a task, the index in declaration order
+     */
+    using TaskId = uint32_t;
+
+    /**
+     * @brief	   Declaration of a task
+     */
+    struct TaskDesc {
+        std::string name;
+        std::function<void()> function;
+        std::vector<ResourceId> reads;
+        std::vector<ResourceId> writes;
+
+        /**
+         * @brief	   Run on the thread calling TaskGraph::run() (window events, graphics API calls)
+         */
+        bool main_thread = false;
+    };
+
+    /**
+     * @brief	   Timing of a task in the last frame, in milliseconds; the start counts from the start of run()
+     */
+    struct TaskTiming {
+        double start = 0.0;
+        double duration = 0.0;
+    };
+
+    /**
+     * @brief	   Dependency graph of the tasks of a frame
+     */
+    class TaskGraph {
+      public:
+        TaskGraph();
+
+        TaskGraph(const TaskGraph&) = delete;
+        auto operator=(const TaskGraph&) -> TaskGraph& = delete;
+
+        /**
+         * @brief	   Declare a resource tasks can read and write
+         *
+         * @param[in]  name	 The name, for reports
+         *
+         * @return	   id of the resource
+         */
+        auto add_resource(std::string name) -> ResourceId;
+
+        /**
+         * @brief	   Declare a task; the graph is compiled again on the next run
+         *
+         * @param[in]  task	 The task, with resources returned by add_resource()
+         *
+         * @return	   id of the task
+         */
+        auto add_task(TaskDesc task) -> TaskId;
+
+        /**
+         * @brief	   Build the dependency graph; run() does it on demand
+         */
+        void compile();
+
+        /**
+         * @brief	   Run every task once and wait for them
+         *
+         * The calling thread runs the main thread tasks and helps with the
+         * others while waiting.
+         *
+         * @param[in]  system  The job system
+         */
+        void run(jobs::JobSystem& system);
+
+        /**
+         * @brief	   run() on the engine-wide job system
+         */
+        void run();
+
+        auto task_count() const -> size_t { return m_tasks.size(); }
+
+        auto name(TaskId task) const -> const std::string& { return m_tasks[task].desc.name; }
+
+        auto resource_name(ResourceId resource) const -> const std::string& { return m_resources[resource]; }
+
+        /**
+         * @brief	   Tasks that run right after a task finishes, in increasing order; needs compile()
+         */
+        auto successors(TaskId task) const -> std::vector<TaskId>;
+
+        /**
+         * @brief	   Timings of the last run, indexed by task
+         */
+        auto timings() const -> const std::vector<TaskTiming>& { return m_timings; }
+
+        /**
+         * @brief	   Wall time of the last run in milliseconds
+         */
+        auto frame_time() const -> double { return m_frame_time; }
+
+      private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Task {
+            TaskDesc desc;
+            uint32_t predecessors = 0;
+            uint32_t first_successor = 0;
+            uint32_t successor_count = 0;
+        };
+
+        static void run_job(const jobs::Job& job);
+
+        void execute(TaskId task);
+        void schedule(TaskId task);
+        auto next_main_task(TaskId& task) -> bool;
+
+        std::vector<std::string> m_resources;
+        std::vector<Task> m_tasks;
+        std::vector<TaskId> m_successors;
+        std::vector<TaskId> m_roots;
+        bool m_compiled = false;
+
+        // Per frame state; sized by compile() and reused afterwards.
+        std::vector<jobs::Job> m_jobs;
+        std::unique_ptr<std::atomic<uint32_t>[]> m_remaining;
+        std::vector<TaskTiming> m_timings;
+        std::vector<TaskId> m_main_ready;
+        size_t m_main_next = 0;
+        std::mutex m_main_mutex;
+        std::atomic<size_t> m_finished {0};
+        jobs::Counter m_counter;
+        jobs::JobSystem* m_system = nullptr;
+        Clock::time_point m_frame_start;
+        double m_frame_time = 0.0;
+    };
+}    // namespace utils::tasks
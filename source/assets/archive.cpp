@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/assets/archive.hpp"
+
+#ifdef _WIN32
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    using assets::ArchiveEntry;
+    using assets::ArchiveHeader;
+
+    constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    // Bytes read from an added file per write while packing.
+    constexpr size_t COPY_BUFFER_SIZE = 1 << 20;
+
+    auto align_up(uint64_t value, uint64_t alignment) -> uint64_t {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Smallest power of two with room for twice the entries, so probe sequences stay short and
+    // always reach an empty slot.
+    auto slot_count_for(size_t entry_count) -> uint32_t {
+        uint32_t slots = 1;
+        while (slots < 2 * entry_count) {
+            slots *= 2;
+        }
+        return std::max<uint32_t>(slots, 2);
+    }
+
+    // Maps a whole file read-only. The mapping keeps the file alive, so no handle is kept open.
+    auto map_file(const std::string& path, size_t& size) -> const std::byte* {
+#ifdef _WIN32
+        HANDLE const file = ::CreateFileA(path.c_str(),
+                                          GENERIC_READ,
+                                          FILE_SHARE_READ,
+                                          nullptr,
+                                          OPEN_EXISTING,
+                                          FILE_ATTRIBUTE_NORMAL,
+                                          nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("failed to open archive " + path);
+        }
+
+        LARGE_INTEGER length {};
+        if (::GetFileSizeEx(file, &length) == 0
+            || length.QuadPart < static_cast<LONGLONG>(sizeof(ArchiveHeader)))
+        {
+            ::CloseHandle(file);
+            throw std::runtime_error("not an archive: " + path);
+        }
+        size = static_cast<size_t>(length.QuadPart);
+
+        HANDLE const mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        ::CloseHandle(file);
+        void* const data = mapping != nullptr ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping != nullptr) {
+            ::CloseHandle(mapping);
+        }
+        if (data == nullptr) {
+            throw std::runtime_error("failed to map archive " + path);
+        }
+#else
+        int const descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0) {
+            throw std::runtime_error("failed to open archive " + path);
+        }
+
+        struct stat status {};
+        if (::fstat(descriptor, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(ArchiveHeader))) {
+            ::close(descriptor);
+            throw std::runtime_error("not an archive: " + path);
+        }
+        size = static_cast<size_t>(status.st_size);
+
+        void* const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        ::close(descriptor);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("failed to map archive " + path);
+        }
+#endif
+        return static_cast<const std::byte*>(data);
+    }
+
+    void unmap_file(const std::byte* data, size_t size) {
+#ifdef _WIN32
+        static_cast<void>(size);
+        ::UnmapViewOfFile(data);
+#else
+        ::munmap(const_cast<std::byte*>(data), size);
+#endif
+    }
+
+    // Asks the system to read a range of a mapping in the background.
+    void prefetch_range(const std::byte* data, size_t size) {
+#ifdef _WIN32
+        WIN32_MEMORY_RANGE_ENTRY range {const_cast<std::byte*>(data), size};
+        ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+#else
+        auto const page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+        auto const start = reinterpret_cast<uintptr_t>(data) / page * page;
+        auto const end = reinterpret_cast<uintptr_t>(data) + size;
+        ::madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+#endif
+    }
+
+    struct FileCloser {
+        void operator()(std::FILE* file) const { std::fclose(file); }
+    };
+
+    using File = std::unique_ptr<std::FILE, FileCloser>;
+
+    void write_bytes(std::FILE* file, const void* data, size_t size, const std::string& path) {
+        if (size > 0 && std::fwrite(data, 1, size, file) != size) {
+            throw std::runtime_error("failed to write archive " + path);
+        }
+    }
+
+    void write_padding(std::FILE* file, uint64_t& position, uint64_t target, const std::string& path) {
+        static std::array<std::byte, assets::BLOB_ALIGNMENT> const ZEROS {};
+        while (position < target) {
+            size_t const size = std::min<uint64_t>(target - position, ZEROS.size());
+            write_bytes(file, ZEROS.data(), size, path);
+            position += size;
+        }
+    }
+}    // namespace
+
+namespace assets {
+    auto hash_name(std::string_view name) -> uint64_t {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        for (char const character : name) {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= FNV_PRIME;
+        }
+        return hash == 0 ? 1 : hash;
+    }
+
+    Archive::Archive(const std::string& path) {
+        LOG_TRACE
+
+        m_data = map_file(path, m_size);
+
+        try {
+            validate();
+        } catch (const std::runtime_error& error) {
+            unmap();
+            throw std::runtime_error(std::string(error.what()) + ": " + path);
+        }
+    }
+
+    Archive::~Archive() {
+        unmap();
+    }
+
+    Archive::Archive(Archive&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+        , m_order(std::move(other.m_order)) {}
+
+    auto Archive::operator=(Archive&& other) noexcept -> Archive& {
+        if (this != &other) {
+            unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_order = std::move(other.m_order);
+        }
+        return *this;
+    }
+
+    void Archive::unmap() {
+        if (m_data != nullptr) {
+            unmap_file(m_data, m_size);
+            m_data = nullptr;
+        }
+    }
+
+    void Archive::validate() {
+        const ArchiveHeader& head = header();
+        if (head.magic != ARCHIVE_MAGIC || head.version != ARCHIVE_VERSION || head.file_size != m_size) {
+            throw std::runtime_error("not an archive of this version");
+        }
+
+        // Offsets are checked against the size before they are added to, so nothing here can overflow.
+        uint64_t const slots = head.slot_count;
+        if (slots == 0 || (slots & (slots - 1)) != 0 || slots <= head.entry_count
+            || head.table_offset % alignof(ArchiveEntry) != 0 || head.table_offset > m_size
+            || slots > (m_size - head.table_offset) / sizeof(ArchiveEntry) || head.names_offset > m_size
+            || head.names_size > m_size - head.names_offset)
+        {
+            throw std::runtime_error("corrupt archive header");
+        }
+
+        const auto* const names = reinterpret_cast<const char*>(m_data + head.names_offset);
+        m_order.clear();
+        m_order.reserve(head.entry_count);
+        for (uint32_t slot = 0; slot < slots; ++slot) {
+            const ArchiveEntry& entry = entries()[slot];
+            if (entry.hash == 0) {
+                continue;
+            }
+            if (entry.name_offset > head.names_size || entry.name_size > head.names_size - entry.name_offset
+                || entry.offset % BLOB_ALIGNMENT != 0 || entry.offset > m_size
+                || entry.size > m_size - entry.offset
+                || entry.hash != hash_name({names + entry.name_offset, entry.name_size}))
+            {
+                throw std::runtime_error("corrupt archive entry");
+            }
+            m_order.push_back(slot);
+        }
+        if (m_order.size() != head.entry_count) {
+            throw std::runtime_error("corrupt archive table");
+        }
+
+        // Empty blobs share their offset with the next blob; the names are in the order blobs were added.
+        std::sort(m_order.begin(),
+                  m_order.end(),
+                  [this](uint32_t a, uint32_t b)
+                  {
+                      const ArchiveEntry& first = entries()[a];
+                      const ArchiveEntry& second = entries()[b];
+                      return first.offset != second.offset ? first.offset < second.offset
+                                                           : first.name_offset < second.name_offset;
+                  });
+    }
+
+    auto Archive::blob(const ArchiveEntry& entry) const -> Blob {
+        const auto* const names = reinterpret_cast<const char*>(m_data + header().names_offset);
+        return {{names + entry.name_offset, entry.name_size}, entry.type, m_data + entry.offset, entry.size};
+    }
+
+    auto Archive::find(std::string_view name) const -> Blob {
+        uint64_t const hash = hash_name(name);
+        uint32_t const mask = header().slot_count - 1;
+        const auto* const names = reinterpret_cast<const char*>(m_data + header().names_offset);
+
+        for (auto slot = static_cast<uint32_t>(hash) & mask;; slot = (slot + 1) & mask) {
+            const ArchiveEntry& entry = entries()[slot];
+            if (entry.hash == 0) {
+                return {};
+            }
+            if (entry.hash == hash && std::string_view(names + entry.name_offset, entry.name_size) == name) {
+                return blob(entry);
+            }
+        }
+    }
+
+    void Archive::prefetch(const Blob& blob) const {
+        if (!blob || blob.size == 0) {
+            return;
+        }
+        prefetch_range(blob.data, blob.size);
+    }
+
+    void ArchiveWriter::add_name(const std::string& name) {
+        if (name.empty() || !m_names.insert(name).second) {
+            throw std::invalid_argument("empty or repeated asset name: " + name);
+        }
+    }
+
+    void ArchiveWriter::add(std::string name, AssetType type, std::vector<std::byte> data) {
+        add_name(name);
+        uint64_t const size = data.size();
+        m_assets.push_back({std::move(name), type, std::move(data), {}, size});
+    }
+
+    void ArchiveWriter::add_file(std::string name, AssetType type, const std::string& path) {
+        std::error_code error;
+        uint64_t const size = std::filesystem::file_size(path, error);
+        if (error) {
+            throw std::runtime_error("failed to read asset " + path);
+        }
+
+        add_name(name);
+        m_assets.push_back({std::move(name), type, {}, path, size});
+    }
+
+    auto ArchiveWriter::write(const std::string& path) const -> size_t {
+        ArchiveHeader head;
+        head.entry_count = static_cast<uint32_t>(m_assets.size());
+        head.slot_count = slot_count_for(m_assets.size());
+        head.table_offset = sizeof(ArchiveHeader);
+        head.names_offset = head.table_offset + uint64_t {head.slot_count} * sizeof(ArchiveEntry);
+
+        std::vector<char> names;
+        for (const Asset& asset : m_assets) {
+            names.insert(names.end(), asset.name.begin(), asset.name.end());
+        }
+        head.names_size = names.size();
+
+        // Blobs follow the names in the order they were added, each on the next boundary.
+        std::vector<ArchiveEntry> table(head.slot_count);
+        std::vector<uint64_t> offsets;
+        offsets.reserve(m_assets.size());
+        uint64_t offset = align_up(head.names_offset + head.names_size, BLOB_ALIGNMENT);
+        uint32_t name_offset = 0;
+        for (const Asset& asset : m_assets) {
+            ArchiveEntry entry;
+            entry.hash = hash_name(asset.name);
+            entry.offset = offset;
+            entry.size = asset.size;
+            entry.name_offset = name_offset;
+            entry.name_size = static_cast<uint32_t>(asset.name.size());
+            entry.type = asset.type;
+
+            uint32_t slot = static_cast<uint32_t>(entry.hash) & (head.slot_count - 1);
+            while (table[slot].hash != 0) {
+                slot = (slot + 1) & (head.slot_count - 1);
+            }
+            table[slot] = entry;
+
+            offsets.push_back(offset);
+            name_offset += entry.name_size;
+            offset = align_up(offset + asset.size, BLOB_ALIGNMENT);
+        }
+        head.file_size = m_assets.empty() ? head.names_offset + head.names_size
+                                          : offsets.back() + m_assets.back().size;
+
+        File const file(std::fopen(path.c_str(), "wb"));
+        if (!file) {
+            throw std::runtime_error("failed to create archive " + path);
+        }
+
+        write_bytes(file.get(), &head, sizeof(head), path);
+        write_bytes(file.get(), table.data(), table.size() * sizeof(ArchiveEntry), path);
+        write_bytes(file.get(), names.data(), names.size(), path);
+        uint64_t position = head.names_offset + head.names_size;
+
+        std::vector<std::byte> buffer;
+        for (size_t i = 0; i < m_assets.size(); ++i) {
+            const Asset& asset = m_assets[i];
+            write_padding(file.get(), position, offsets[i], path);
+
+            if (asset.path.empty()) {
+                write_bytes(file.get(), asset.data.data(), asset.data.size(), path);
+            } else {
+                File const source(std::fopen(asset.path.c_str(), "rb"));
+                if (!source) {
+                    throw std::runtime_error("failed to read asset " + asset.path);
+                }
+                buffer.resize(COPY_BUFFER_SIZE);
+                uint64_t remaining = asset.size;
+                while (remaining > 0) {
+                    size_t const size = std::min<uint64_t>(remaining, buffer.size());
+                    if (std::fread(buffer.data(), 1, size, source.get()) != size) {
+                        throw std::runtime_error("failed to read asset " + asset.path);
+                    }
+                    write_bytes(file.get(), buffer.data(), size, path);
+                    remaining -= size;
+                }
+            }
+            position += asset.size;
+        }
+
+        if (std::fflush(file.get()) != 0) {
+            throw std::runtime_error("failed to write archive " + path);
+        }
+        return static_cast<size_t>(position);
+    }
+}    // namespace assets
@@ -0,0 +1,644 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/assets/loader.hpp"
+
+#ifdef _WIN32
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#ifdef __linux__
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#endif
+
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    // Largest single read; a bigger file is read in several steps.
+    constexpr size_t MAX_READ_SIZE = size_t {1} << 30U;
+
+    // Queue order: higher priority first, then the order of the requests.
+    struct QueueOrder {
+        template<typename Entry>
+        auto operator()(const Entry& a, const Entry& b) const -> bool {
+            return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+        }
+    };
+
+#ifdef _WIN32
+    using FileHandle = HANDLE;
+
+    auto no_file() -> FileHandle {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    // Open a regular file for reading and tell its size.
+    auto open_file(const std::string& path, FileHandle& file, size_t& size) -> bool {
+        file = ::CreateFileA(path.c_str(),
+                             GENERIC_READ,
+                             FILE_SHARE_READ,
+                             nullptr,
+                             OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN,
+                             nullptr);
+        LARGE_INTEGER length {};
+        if (file == INVALID_HANDLE_VALUE || ::GetFileType(file) != FILE_TYPE_DISK
+            || ::GetFileSizeEx(file, &length) == 0)
+        {
+            return false;
+        }
+        size = static_cast<size_t>(length.QuadPart);
+        return true;
+    }
+
+    // Read at an offset without moving a shared file position; 0 at the end of the file.
+    auto read_at(FileHandle file, std::byte* data, size_t size, uint64_t offset) -> int64_t {
+        OVERLAPPED position {};
+        position.Offset = static_cast<DWORD>(offset);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32U);
+        DWORD count = 0;
+        if (::ReadFile(file, data, static_cast<DWORD>(size), &count, &position) == 0) {
+            return -1;
+        }
+        return static_cast<int64_t>(count);
+    }
+
+    void close_file(FileHandle file) {
+        ::CloseHandle(file);
+    }
+#else
+    using FileHandle = int;
+
+    auto no_file() -> FileHandle {
+        return -1;
+    }
+
+    auto open_file(const std::string& path, FileHandle& file, size_t& size) -> bool {
+        file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat status {};
+        if (file < 0 || ::fstat(file, &status) != 0 || !S_ISREG(status.st_mode)) {
+            return false;
+        }
+        size = static_cast<size_t>(status.st_size);
+        return true;
+    }
+
+    auto read_at(FileHandle file, std::byte* data, size_t size, uint64_t offset) -> int64_t {
+        while (true) {
+            ssize_t const count = ::pread(file, data, size, static_cast<off_t>(offset));
+            if (count >= 0 || errno != EINTR) {
+                return count;
+            }
+        }
+    }
+
+    void close_file(FileHandle file) {
+        ::close(file);
+    }
+#endif
+
+#ifdef __linux__
+    auto load_acquire(const uint32_t* value) -> uint32_t {
+        return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+    }
+
+    void store_release(uint32_t* value, uint32_t stored) {
+        __atomic_store_n(value, stored, __ATOMIC_RELEASE);
+    }
+#endif
+}    // namespace
+
+namespace assets {
+    struct AssetLoader::Request {
+        LoadId id = 0;
+        LoadCallback callback;
+        Load* load = nullptr;
+        LoadStatus status = LoadStatus::Failed;
+        AssetData data;
+        utils::jobs::Job job;
+        utils::jobs::Counter counter;
+    };
+
+    struct AssetLoader::Load {
+        std::string path;
+        LoadPriority priority = LoadPriority::Normal;
+        uint64_t sequence = 0;
+        bool started = false;
+        std::vector<std::unique_ptr<Request>> waiters;
+        FileHandle file = no_file();
+        std::shared_ptr<std::vector<std::byte>> buffer;
+        size_t done = 0;
+
+        // Open the file and allocate its buffer; I/O threads only.
+        auto open() -> bool {
+            size_t size = 0;
+            if (!open_file(path, file, size)) {
+                return false;
+            }
+            buffer = std::make_shared<std::vector<std::byte>>(size);
+            return true;
+        }
+
+        // Read what is left with blocking calls.
+        auto read_rest() -> bool {
+            while (done < buffer->size()) {
+                int64_t const count = read_at(
+                    file, buffer->data() + done, std::min(buffer->size() - done, MAX_READ_SIZE), done);
+                if (count <= 0) {
+                    return false;
+                }
+                done += static_cast<size_t>(count);
+            }
+            return true;
+        }
+    };
+
+#ifdef __linux__
+
+    // Submission and completion rings shared with the kernel, set up without liburing.
+    struct AssetLoader::Ring {
+        int descriptor = -1;
+        void* sq_mapping = MAP_FAILED;
+        size_t sq_mapping_size = 0;
+        void* cq_mapping = MAP_FAILED;
+        size_t cq_mapping_size = 0;
+        io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        size_t sqes_size = 0;
+
+        uint32_t* sq_head = nullptr;
+        uint32_t* sq_tail = nullptr;
+        uint32_t sq_mask = 0;
+        uint32_t* sq_array = nullptr;
+        uint32_t* cq_head = nullptr;
+        uint32_t* cq_tail = nullptr;
+        uint32_t cq_mask = 0;
+        io_uring_cqe* cqes = nullptr;
+        uint32_t unsubmitted = 0;
+
+        Ring() = default;
+        Ring(const Ring&) = delete;
+        auto operator=(const Ring&) -> Ring& = delete;
+
+        ~Ring() {
+            if (sqes != MAP_FAILED) {
+                ::munmap(sqes, sqes_size);
+            }
+            if (cq_mapping != MAP_FAILED && cq_mapping != sq_mapping) {
+                ::munmap(cq_mapping, cq_mapping_size);
+            }
+            if (sq_mapping != MAP_FAILED) {
+                ::munmap(sq_mapping, sq_mapping_size);
+            }
+            if (descriptor >= 0) {
+                ::close(descriptor);
+            }
+        }
+
+        // A ring with room for `entries` submissions, nullptr where io_uring is not available.
+        static auto create(uint32_t entries) -> std::unique_ptr<Ring> {
+            auto ring = std::make_unique<Ring>();
+            io_uring_params params {};
+            ring->descriptor = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+            if (ring->descriptor < 0) {
+                return nullptr;
+            }
+
+            ring->sq_mapping_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            ring->cq_mapping_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool const single_mapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mapping) {
+                size_t const size = std::max(ring->sq_mapping_size, ring->cq_mapping_size);
+                ring->sq_mapping_size = size;
+                ring->cq_mapping_size = size;
+            }
+
+            ring->sq_mapping = ::mmap(nullptr,
+                                      ring->sq_mapping_size,
+                                      PROT_READ | PROT_WRITE,
+                                      MAP_SHARED | MAP_POPULATE,
+                                      ring->descriptor,
+                                      IORING_OFF_SQ_RING);
+            if (ring->sq_mapping == MAP_FAILED) {
+                return nullptr;
+            }
+            ring->cq_mapping = single_mapping ? ring->sq_mapping
+                                              : ::mmap(nullptr,
+                                                       ring->cq_mapping_size,
+                                                       PROT_READ | PROT_WRITE,
+                                                       MAP_SHARED | MAP_POPULATE,
+                                                       ring->descriptor,
+                                                       IORING_OFF_CQ_RING);
+            if (ring->cq_mapping == MAP_FAILED) {
+                return nullptr;
+            }
+            ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            ring->sqes = static_cast<io_uring_sqe*>(::mmap(nullptr,
+                                                           ring->sqes_size,
+                                                           PROT_READ | PROT_WRITE,
+                                                           MAP_SHARED | MAP_POPULATE,
+                                                           ring->descriptor,
+                                                           IORING_OFF_SQES));
+            if (ring->sqes == MAP_FAILED) {
+                return nullptr;
+            }
+
+            auto* const sq = static_cast<std::byte*>(ring->sq_mapping);
+            auto* const cq = static_cast<std::byte*>(ring->cq_mapping);
+            ring->sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+            ring->sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+            ring->sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+            ring->sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+            ring->cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+            ring->cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+            ring->cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+            ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return ring;
+        }
+
+        // Queue a read of the rest of a load; the caller keeps at most as many reads in flight
+        // as the ring has entries.
+        void read(Load* load) {
+            uint32_t const tail = *sq_tail + unsubmitted;
+            uint32_t const index = tail & sq_mask;
+            io_uring_sqe& sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = load->file;
+            sqe.addr = reinterpret_cast<uint64_t>(load->buffer->data() + load->done);
+            sqe.len = static_cast<uint32_t>(std::min(load->buffer->size() - load->done, MAX_READ_SIZE));
+            sqe.off = load->done;
+            sqe.user_data = reinterpret_cast<uint64_t>(load);
+            sq_array[index] = index;
+            ++unsubmitted;
+        }
+
+        // Hand the queued reads to the kernel and wait until at least one has completed.
+        void submit_and_wait() {
+            store_release(sq_tail, *sq_tail + unsubmitted);
+            uint32_t pending = unsubmitted;
+            unsubmitted = 0;
+
+            // The kernel may take fewer entries than offered; the rest stay queued for the next call.
+            while (true) {
+                long const result = ::syscall(
+                    __NR_io_uring_enter, descriptor, pending, 1, IORING_ENTER_GETEVENTS, nullptr, size_t {0});
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (result <= 0 || static_cast<uint32_t>(result) >= pending) {
+                    return;
+                }
+                pending -= static_cast<uint32_t>(result);
+            }
+        }
+
+        template<typename Function>
+        void complete(Function&& function) {
+            uint32_t head = *cq_head;
+            uint32_t const tail = load_acquire(cq_tail);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes[head & cq_mask];
+                function(reinterpret_cast<Load*>(cqe.user_data), cqe.res);
+            }
+            store_release(cq_head, head);
+        }
+    };
+#else
+    // io_uring is Linux only; elsewhere the loader always reads on the fallback threads.
+    struct AssetLoader::Ring {};
+#endif
+
+    AssetLoader::AssetLoader(utils::jobs::JobSystem& jobs, const LoaderSettings& settings)
+        : m_jobs(jobs)
+        , m_settings(settings) {
+        LOG_TRACE
+
+        m_settings.queue_depth = std::max<uint32_t>(m_settings.queue_depth, 1);
+#ifdef __linux__
+        if (m_settings.use_io_uring) {
+            m_ring = Ring::create(m_settings.queue_depth);
+        }
+        if (m_ring) {
+            m_threads.emplace_back([this]() { run_ring(); });
+        }
+#endif
+
+        if (!m_ring) {
+            for (size_t i = 0; i < std::max<size_t>(m_settings.fallback_threads, 1); ++i) {
+                m_threads.emplace_back([this]() { run_fallback(); });
+            }
+        }
+    }
+
+    AssetLoader::~AssetLoader() {
+        {
+            std::lock_guard<std::mutex> const guard(m_mutex);
+            m_stop = true;
+            for (auto it = m_loads.begin(); it != m_loads.end();) {
+                if (it->second->started) {
+                    ++it;
+                    continue;
+                }
+                for (const auto& request : it->second->waiters) {
+                    m_requests.erase(request->id);
+                }
+                it = m_loads.erase(it);
+            }
+            m_queue.clear();
+        }
+        m_wake.notify_all();
+
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+        for (const auto& request : m_scheduled) {
+            m_jobs.wait(request->counter);
+        }
+    }
+
+    auto AssetLoader::load(const std::string& path, LoadPriority priority, LoadCallback callback) -> LoadId {
+        auto request = std::make_unique<Request>();
+        request->callback = std::move(callback);
+
+        std::vector<std::unique_ptr<Request>> ready;
+        {
+            std::lock_guard<std::mutex> const guard(m_mutex);
+            reclaim();
+            request->id = m_next_id++;
+            LoadId const id = request->id;
+
+            auto const resident = m_resident_index.find(path);
+            if (resident != m_resident_index.end()) {
+                m_resident.splice(m_resident.begin(), m_resident, resident->second);
+                request->status = LoadStatus::Loaded;
+                request->data = resident->second->data;
+                ready.push_back(std::move(request));
+            } else {
+                std::unique_ptr<Load>& load = m_loads[path];
+                if (!load) {
+                    load = std::make_unique<Load>();
+                    load->path = path;
+                    load->priority = priority;
+                    load->sequence = m_next_sequence++;
+                    m_queue.push_back({priority, load->sequence, path});
+                    std::push_heap(m_queue.begin(), m_queue.end(), QueueOrder {});
+                } else if (!load->started && priority < load->priority) {
+                    // Queue the load again at the new priority; the old entry goes stale.
+                    load->priority = priority;
+                    load->sequence = m_next_sequence++;
+                    m_queue.push_back({priority, load->sequence, path});
+                    std::push_heap(m_queue.begin(), m_queue.end(), QueueOrder {});
+                }
+                request->load = load.get();
+                m_requests[id] = request.get();
+                load->waiters.push_back(std::move(request));
+            }
+
+            if (ready.empty()) {
+                m_wake.notify_one();
+                return id;
+            }
+        }
+
+        LoadId const id = ready.front()->id;
+        schedule(ready);
+        return id;
+    }
+
+    auto AssetLoader::cancel(LoadId id) -> bool {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        auto const found = m_requests.find(id);
+        if (found == m_requests.end()) {
+            return false;
+        }
+
+        Load* const load = found->second->load;
+        m_requests.erase(found);
+        auto const is_request = [id](const std::unique_ptr<Request>& request) { return request->id == id; };
+        load->waiters.erase(std::find_if(load->waiters.begin(), load->waiters.end(), is_request));
+
+        // Nobody waits for a load that has not started: drop it, its queue entry goes stale.
+        if (!load->started && load->waiters.empty()) {
+            m_loads.erase(load->path);
+        }
+        return true;
+    }
+
+    auto AssetLoader::find(const std::string& path) -> AssetData {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        auto const resident = m_resident_index.find(path);
+        if (resident == m_resident_index.end()) {
+            return nullptr;
+        }
+        m_resident.splice(m_resident.begin(), m_resident, resident->second);
+        return resident->second->data;
+    }
+
+    auto AssetLoader::resident_bytes() const -> size_t {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        return m_resident_bytes;
+    }
+
+    auto AssetLoader::pending() const -> size_t {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        return m_requests.size();
+    }
+
+    auto AssetLoader::next_load() -> Load* {
+        while (!m_queue.empty()) {
+            std::pop_heap(m_queue.begin(), m_queue.end(), QueueOrder {});
+            QueueEntry const entry = std::move(m_queue.back());
+            m_queue.pop_back();
+
+            auto const found = m_loads.find(entry.path);
+            if (found == m_loads.end()) {
+                continue;
+            }
+            Load* const load = found->second.get();
+            if (load->sequence == entry.sequence && !load->started) {
+                load->started = true;
+                return load;
+            }
+        }
+        return nullptr;
+    }
+
+#ifdef __linux__
+    void AssetLoader::run_ring() {
+        std::vector<Load*> started;
+        uint32_t in_flight = 0;
+
+        while (true) {
+            started.clear();
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                reclaim();
+                if (in_flight == 0) {
+                    m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+                    if (m_stop) {
+                        return;
+                    }
+                }
+                while (!m_stop && in_flight + started.size() < m_settings.queue_depth) {
+                    Load* const load = next_load();
+                    if (load == nullptr) {
+                        break;
+                    }
+                    started.push_back(load);
+                }
+            }
+
+            for (Load* const load : started) {
+                if (!load->open()) {
+                    finish(load, false);
+                } else if (load->buffer->empty()) {
+                    finish(load, true);
+                } else {
+                    m_ring->read(load);
+                    ++in_flight;
+                }
+            }
+            if (in_flight == 0) {
+                continue;
+            }
+
+            m_ring->submit_and_wait();
+            m_ring->complete(
+                [this, &in_flight](Load* load, int32_t result)
+                {
+                    if (result == -EINTR || result == -EAGAIN) {
+                        m_ring->read(load);
+                        return;
+                    }
+
+                    // A kernel without ring reads answers -EINVAL; read that file directly instead.
+                    bool done = false;
+                    bool loaded = false;
+                    if (result == -EINVAL) {
+                        done = true;
+                        loaded = load->read_rest();
+                    } else if (result <= 0) {
+                        done = true;
+                    } else {
+                        load->done += static_cast<size_t>(result);
+                        done = load->done == load->buffer->size();
+                        loaded = done;
+                    }
+
+                    if (done) {
+                        --in_flight;
+                        finish(load, loaded);
+                    } else {
+                        m_ring->read(load);
+                    }
+                });
+        }
+    }
+#endif
+
+    void AssetLoader::run_fallback() {
+        while (true) {
+            Load* load = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                reclaim();
+                m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+                if (m_stop) {
+                    return;
+                }
+                load = next_load();
+            }
+
+            if (load != nullptr) {
+                bool const loaded = load->open() && load->read_rest();
+                finish(load, loaded);
+            }
+        }
+    }
+
+    void AssetLoader::finish(Load* load, bool loaded) {
+        if (load->file != no_file()) {
+            close_file(load->file);
+        }
+
+        std::vector<std::unique_ptr<Request>> ready;
+        {
+            std::lock_guard<std::mutex> const guard(m_mutex);
+            AssetData data;
+            if (loaded) {
+                data = std::move(load->buffer);
+                if (data->size() <= m_settings.memory_budget) {
+                    m_resident.push_front({load->path, data});
+                    m_resident_index[load->path] = m_resident.begin();
+                    m_resident_bytes += data->size();
+                    evict();
+                }
+            }
+
+            for (auto& request : load->waiters) {
+                request->status = loaded ? LoadStatus::Loaded : LoadStatus::Failed;
+                request->data = data;
+                request->load = nullptr;
+                m_requests.erase(request->id);
+                ready.push_back(std::move(request));
+            }
+            m_loads.erase(load->path);
+        }
+
+        schedule(ready);
+    }
+
+    void AssetLoader::evict() {
+        while (m_resident_bytes > m_settings.memory_budget) {
+            const Resident& oldest = m_resident.back();
+            m_resident_bytes -= oldest.data->size();
+            m_resident_index.erase(oldest.path);
+            m_resident.pop_back();
+        }
+    }
+
+    void AssetLoader::schedule(std::vector<std::unique_ptr<Request>>& requests) {
+        // Submitted without the lock held: a worker with a full deque runs the callback inline,
+        // and the callback may well call load().
+        for (const auto& request : requests) {
+            request->job.function = run_callback;
+            request->job.context = request.get();
+            m_jobs.submit(&request->job, 1, request->counter);
+        }
+
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        for (auto& request : requests) {
+            m_scheduled.push_back(std::move(request));
+        }
+    }
+
+    void AssetLoader::run_callback(const utils::jobs::Job& job) {
+        const auto* const request = static_cast<const Request*>(job.context);
+        if (request->callback) {
+            request->callback(request->status, request->data);
+        }
+    }
+
+    void AssetLoader::reclaim() {
+        auto const done = [](const std::unique_ptr<Request>& request) { return request->counter.done(); };
+        m_scheduled.erase(std::remove_if(m_scheduled.begin(), m_scheduled.end(), done), m_scheduled.end());
+    }
+}    // namespace assets
@@ -0,0 +1,457 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "domkrat3d/assets/mesh.hpp"
+
+namespace {
+    using assets::mesh::Mesh;
+    using assets::mesh::Vec3;
+    using assets::mesh::Vertex;
+
+    // Forsyth's constants: the cache modelled while choosing triangles, the score of the three
+    // vertices of the last triangle, the falloff over the rest of the cache and the bonus of
+    // vertices with few triangles left, which keeps the order from leaving lone triangles behind.
+    constexpr size_t CACHE_SIZE = 32;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75F;
+    constexpr float CACHE_DECAY_POWER = 1.5F;
+    constexpr float VALENCE_BOOST_SCALE = 2.0F;
+    constexpr float VALENCE_BOOST_POWER = 0.5F;
+    constexpr uint32_t NOT_CACHED = std::numeric_limits<uint32_t>::max();
+
+    constexpr uint32_t MAX_SHORT_INDEX_VERTICES = 65535;
+
+    auto bits(float value) -> uint32_t {
+        uint32_t result = 0;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    // The bits of a vertex with -0 turned into +0, so both weld together.
+    auto vertex_key(const Vertex& vertex) -> std::array<uint32_t, 8> {
+        float const values[8] = {vertex.position.x,
+                                 vertex.position.y,
+                                 vertex.position.z,
+                                 vertex.normal.x,
+                                 vertex.normal.y,
+                                 vertex.normal.z,
+                                 vertex.u,
+                                 vertex.v};
+        std::array<uint32_t, 8> key {};
+        for (size_t i = 0; i < key.size(); ++i) {
+            key[i] = bits(values[i] + 0.0F);
+        }
+        return key;
+    }
+
+    struct KeyHash {
+        auto operator()(const std::array<uint32_t, 8>& key) const -> size_t {
+            uint64_t hash = 0xCBF29CE484222325ULL;
+            for (uint32_t const word : key) {
+                hash = (hash ^ word) * 0x100000001B3ULL;
+            }
+            return static_cast<size_t>(hash ^ (hash >> 32U));
+        }
+    };
+
+    auto vertex_score(uint32_t cache_position, uint32_t remaining) -> float {
+        if (remaining == 0) {
+            return -1.0F;
+        }
+
+        float score = 0.0F;
+        if (cache_position != NOT_CACHED) {
+            if (cache_position < 3) {
+                score = LAST_TRIANGLE_SCORE;
+            } else {
+                float const scaled = 1.0F
+                                     - static_cast<float>(cache_position - 3)
+                                           / static_cast<float>(CACHE_SIZE - 3);
+                score = std::pow(scaled, CACHE_DECAY_POWER);
+            }
+        }
+        return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining), -VALENCE_BOOST_POWER);
+    }
+
+    auto unorm16(float value) -> uint16_t {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0F, 1.0F) * 65535.0F));
+    }
+
+    auto snorm16(float value) -> int16_t {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0F, 1.0F) * 32767.0F));
+    }
+}    // namespace
+
+namespace assets::mesh {
+    void weld(Mesh& mesh) {
+        std::unordered_map<std::array<uint32_t, 8>, uint32_t, KeyHash> index;
+        index.reserve(mesh.vertices.size());
+        std::vector<uint32_t> remap(mesh.vertices.size());
+        std::vector<Vertex> welded;
+        welded.reserve(mesh.vertices.size());
+
+        for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+            auto const [found, inserted] =
+                index.try_emplace(vertex_key(mesh.vertices[i]), static_cast<uint32_t>(welded.size()));
+            if (inserted) {
+                welded.push_back(mesh.vertices[i]);
+            }
+            remap[i] = found->second;
+        }
+
+        for (uint32_t& vertex : mesh.indices) {
+            vertex = remap[vertex];
+        }
+        mesh.vertices = std::move(welded);
+    }
+
+    void optimize_vertex_cache(Mesh& mesh) {
+        size_t const vertex_count = mesh.vertices.size();
+        size_t const triangle_count = mesh.indices.size() / 3;
+        if (triangle_count == 0) {
+            return;
+        }
+
+        // Triangles of every vertex, in one array with an offset per vertex.
+        std::vector<uint32_t> remaining(vertex_count, 0);
+        for (uint32_t const vertex : mesh.indices) {
+            ++remaining[vertex];
+        }
+        std::vector<uint32_t> offsets(vertex_count + 1, 0);
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+            offsets[vertex + 1] = offsets[vertex] + remaining[vertex];
+        }
+        std::vector<uint32_t> triangles(mesh.indices.size());
+        std::vector<uint32_t> filled(offsets.begin(), offsets.end() - 1);
+        for (size_t triangle = 0; triangle < triangle_count; ++triangle) {
+            for (size_t corner = 0; corner < 3; ++corner) {
+                triangles[filled[mesh.indices[triangle * 3 + corner]]++] = static_cast<uint32_t>(triangle);
+            }
+        }
+
+        std::vector<uint32_t> cache_position(vertex_count, NOT_CACHED);
+        std::vector<float> score(vertex_count);
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+            score[vertex] = vertex_score(NOT_CACHED, remaining[vertex]);
+        }
+        std::vector<float> triangle_score(triangle_count);
+        for (size_t triangle = 0; triangle < triangle_count; ++triangle) {
+            const uint32_t* const corners = &mesh.indices[triangle * 3];
+            triangle_score[triangle] = score[corners[0]] + score[corners[1]] + score[corners[2]];
+        }
+
+        std::vector<bool> emitted(triangle_count, false);
+        std::vector<uint32_t> order;
+        order.reserve(mesh.indices.size());
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> next_cache;
+        cache.reserve(CACHE_SIZE + 3);
+        next_cache.reserve(CACHE_SIZE + 3);
+
+        size_t scan = 0;
+        auto best = static_cast<uint32_t>(std::max_element(triangle_score.begin(), triangle_score.end())
+                                          - triangle_score.begin());
+
+        while (true) {
+            emitted[best] = true;
+            const uint32_t* const corners = &mesh.indices[static_cast<size_t>(best) * 3];
+            order.insert(order.end(), corners, corners + 3);
+
+            // The triangle's vertices move to the front of the cache, the rest shift back.
+            next_cache.assign(corners, corners + 3);
+            for (uint32_t const vertex : cache) {
+                if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+                    next_cache.push_back(vertex);
+                }
+            }
+            for (size_t corner = 0; corner < 3; ++corner) {
+                uint32_t const vertex = corners[corner];
+                uint32_t* const first = &triangles[offsets[vertex]];
+                uint32_t* const last = first + remaining[vertex];
+                std::iter_swap(std::find(first, last, best), last - 1);
+                --remaining[vertex];
+            }
+
+            // Rescore the vertices that were in the cache and their triangles, picking the best.
+            for (size_t position = 0; position < next_cache.size(); ++position) {
+                uint32_t const vertex = next_cache[position];
+                cache_position[vertex] = position < CACHE_SIZE ? static_cast<uint32_t>(position) : NOT_CACHED;
+                float const updated = vertex_score(cache_position[vertex], remaining[vertex]);
+                float const change = updated - score[vertex];
+                score[vertex] = updated;
+                for (uint32_t k = 0; k < remaining[vertex]; ++k) {
+                    triangle_score[triangles[offsets[vertex] + k]] += change;
+                }
+            }
+            if (next_cache.size() > CACHE_SIZE) {
+                next_cache.resize(CACHE_SIZE);
+            }
+            std::swap(cache, next_cache);
+
+            float best_score = -1.0F;
+            for (uint32_t const vertex : cache) {
+                for (uint32_t k = 0; k < remaining[vertex]; ++k) {
+                    uint32_t const triangle = triangles[offsets[vertex] + k];
+                    if (triangle_score[triangle] > best_score) {
+                        best_score = triangle_score[triangle];
+                        best = triangle;
+                    }
+                }
+            }
+
+            // Nothing left around the cache: continue with the next triangle not emitted yet.
+            if (best_score < 0.0F) {
+                while (scan < triangle_count && emitted[scan]) {
+                    ++scan;
+                }
+                if (scan == triangle_count) {
+                    break;
+                }
+                best = static_cast<uint32_t>(scan);
+            }
+        }
+
+        auto const tail = mesh.indices.begin() + static_cast<ptrdiff_t>(triangle_count * 3);
+        order.insert(order.end(), tail, mesh.indices.end());
+        mesh.indices = std::move(order);
+    }
+
+    void optimize_vertex_fetch(Mesh& mesh) {
+        std::vector<uint32_t> remap(mesh.vertices.size(), NOT_CACHED);
+        std::vector<Vertex> ordered;
+        ordered.reserve(mesh.vertices.size());
+
+        for (uint32_t& vertex : mesh.indices) {
+            if (remap[vertex] == NOT_CACHED) {
+                remap[vertex] = static_cast<uint32_t>(ordered.size());
+                ordered.push_back(mesh.vertices[vertex]);
+            }
+            vertex = remap[vertex];
+        }
+        mesh.vertices = std::move(ordered);
+    }
+
+    auto cache_miss_ratio(const Mesh& mesh, size_t cache_size) -> float {
+        size_t const triangle_count = mesh.indices.size() / 3;
+        if (triangle_count == 0) {
+            return 0.0F;
+        }
+
+        // FIFO of the last vertices shaded; a hit does not move a vertex.
+        std::vector<uint32_t> entry_time(mesh.vertices.size(), 0);
+        uint32_t time = 0;
+        size_t misses = 0;
+        for (size_t i = 0; i < triangle_count * 3; ++i) {
+            uint32_t const vertex = mesh.indices[i];
+            if (entry_time[vertex] == 0 || time - entry_time[vertex] >= cache_size) {
+                entry_time[vertex] = ++time;
+                ++misses;
+            }
+        }
+        return static_cast<float>(misses) / static_cast<float>(triangle_count);
+    }
+
+    auto cook(const Mesh& mesh) -> std::vector<std::byte> {
+        MeshHeader header;
+        header.vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+        header.index_count = static_cast<uint32_t>(mesh.indices.size());
+        header.index_size = header.vertex_count <= MAX_SHORT_INDEX_VERTICES ? 2 : 4;
+
+        float const largest = std::numeric_limits<float>::max();
+        Vec3 low {largest, largest, largest};
+        Vec3 high = -low;
+        for (const Vertex& vertex : mesh.vertices) {
+            low = mathematics::min(low, vertex.position);
+            high = mathematics::max(high, vertex.position);
+        }
+        if (mesh.vertices.empty()) {
+            low = {};
+            high = {};
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            float const extent = high[axis] - low[axis];
+            header.position_offset[axis] = low[axis];
+            header.position_scale[axis] = extent > 0.0F ? extent / 65535.0F : 0.0F;
+        }
+
+        size_t const vertex_bytes = mesh.vertices.size() * sizeof(PackedVertex);
+        size_t const index_bytes = mesh.indices.size() * header.index_size;
+        std::vector<std::byte> blob(sizeof(MeshHeader) + vertex_bytes + index_bytes);
+        std::memcpy(blob.data(), &header, sizeof(header));
+
+        std::byte* vertices = blob.data() + sizeof(MeshHeader);
+        for (const Vertex& vertex : mesh.vertices) {
+            PackedVertex packed {};
+            for (int axis = 0; axis < 3; ++axis) {
+                float const extent = high[axis] - low[axis];
+                if (extent > 0.0F) {
+                    packed.position[axis] = unorm16((vertex.position[axis] - low[axis]) / extent);
+                }
+            }
+            encode_octahedral(vertex.normal, packed.normal);
+            packed.uv[0] = float_to_half(vertex.u);
+            packed.uv[1] = float_to_half(vertex.v);
+            std::memcpy(vertices, &packed, sizeof(packed));
+            vertices += sizeof(packed);
+        }
+
+        std::byte* indices = blob.data() + sizeof(MeshHeader) + vertex_bytes;
+        for (uint32_t const index : mesh.indices) {
+            if (header.index_size == 2) {
+                auto const short_index = static_cast<uint16_t>(index);
+                std::memcpy(indices, &short_index, sizeof(short_index));
+            } else {
+                std::memcpy(indices, &index, sizeof(index));
+            }
+            indices += header.index_size;
+        }
+        return blob;
+    }
+
+    auto read_cooked(const std::byte* data, size_t size) -> CookedMesh {
+        if (data == nullptr || size < sizeof(MeshHeader)) {
+            return {};
+        }
+
+        const auto* const header = reinterpret_cast<const MeshHeader*>(data);
+        if (header->magic != MESH_MAGIC || header->version != MESH_VERSION
+            || header->vertex_stride != sizeof(PackedVertex)
+            || (header->index_size != 2 && header->index_size != 4))
+        {
+            return {};
+        }
+        uint64_t const needed = sizeof(MeshHeader) + uint64_t {header->vertex_count} * sizeof(PackedVertex)
+                                + uint64_t {header->index_count} * header->index_size;
+        if (needed > size) {
+            return {};
+        }
+
+        CookedMesh mesh;
+        mesh.header = header;
+        mesh.vertices = reinterpret_cast<const PackedVertex*>(data + sizeof(MeshHeader));
+        mesh.indices = data + sizeof(MeshHeader) + header->vertex_count * sizeof(PackedVertex);
+        return mesh;
+    }
+
+    auto CookedMesh::index(size_t i) const -> uint32_t {
+        if (header->index_size == 2) {
+            uint16_t value = 0;
+            std::memcpy(&value, indices + i * 2, sizeof(value));
+            return value;
+        }
+        uint32_t value = 0;
+        std::memcpy(&value, indices + i * 4, sizeof(value));
+        return value;
+    }
+
+    auto CookedMesh::position(size_t i) const -> Vec3 {
+        const PackedVertex& vertex = vertices[i];
+        Vec3 result;
+        for (int axis = 0; axis < 3; ++axis) {
+            result[axis] = header->position_offset[axis]
+                           + static_cast<float>(vertex.position[axis]) * header->position_scale[axis];
+        }
+        return result;
+    }
+
+    auto CookedMesh::normal(size_t i) const -> Vec3 {
+        return decode_octahedral(vertices[i].normal);
+    }
+
+    void CookedMesh::uv(size_t i, float& u, float& v) const {
+        u = half_to_float(vertices[i].uv[0]);
+        v = half_to_float(vertices[i].uv[1]);
+    }
+
+    auto float_to_half(float value) -> uint16_t {
+        uint32_t const word = bits(value);
+        auto const sign = static_cast<uint16_t>((word >> 16U) & 0x8000U);
+        uint32_t const exponent = (word >> 23U) & 0xFFU;
+        uint32_t mantissa = word & 0x7FFFFFU;
+
+        if (exponent == 0xFFU) {
+            return static_cast<uint16_t>(sign | 0x7C00U | (mantissa != 0 ? 0x200U : 0U));
+        }
+
+        int const half_exponent = static_cast<int>(exponent) - 127 + 15;
+        if (half_exponent >= 31) {
+            return static_cast<uint16_t>(sign | 0x7C00U);
+        }
+        if (half_exponent <= 0) {
+            // Subnormal half: shift the mantissa with its implicit bit into place, rounding to even.
+            if (half_exponent < -10) {
+                return sign;
+            }
+            mantissa |= 0x800000U;
+            auto const shift = static_cast<uint32_t>(14 - half_exponent);
+            uint32_t half_mantissa = mantissa >> shift;
+            uint32_t const rest = mantissa & ((1U << shift) - 1U);
+            uint32_t const halfway = 1U << (shift - 1U);
+            if (rest > halfway || (rest == halfway && (half_mantissa & 1U) != 0)) {
+                ++half_mantissa;
+            }
+            return static_cast<uint16_t>(sign | half_mantissa);
+        }
+
+        uint32_t half = (static_cast<uint32_t>(half_exponent) << 10U) | (mantissa >> 13U);
+        uint32_t const rest = mantissa & 0x1FFFU;
+        if (rest > 0x1000U || (rest == 0x1000U && (half & 1U) != 0)) {
+            ++half;    // may carry into the exponent, up to infinity, which is right
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    auto half_to_float(uint16_t value) -> float {
+        uint32_t const sign = static_cast<uint32_t>(value & 0x8000U) << 16U;
+        uint32_t const exponent = (value >> 10U) & 0x1FU;
+        uint32_t const mantissa = value & 0x3FFU;
+
+        float result = 0.0F;
+        if (exponent == 0) {
+            result = std::ldexp(static_cast<float>(mantissa), -24);
+        } else if (exponent == 31) {
+            result = mantissa == 0 ? std::numeric_limits<float>::infinity()
+                                   : std::numeric_limits<float>::quiet_NaN();
+        } else {
+            result = std::ldexp(static_cast<float>(mantissa | 0x400U), static_cast<int>(exponent) - 25);
+        }
+        return sign != 0 ? -result : result;
+    }
+
+    void encode_octahedral(Vec3 normal, int16_t encoded[2]) {
+        float const norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (!(norm > 0.0F)) {
+            encoded[0] = 0;
+            encoded[1] = 0;
+            return;
+        }
+
+        float x = normal.x / norm;
+        float y = normal.y / norm;
+        if (normal.z < 0.0F) {
+            float const folded_x = (1.0F - std::abs(y)) * (x >= 0.0F ? 1.0F : -1.0F);
+            float const folded_y = (1.0F - std::abs(x)) * (y >= 0.0F ? 1.0F : -1.0F);
+            x = folded_x;
+            y = folded_y;
+        }
+        encoded[0] = snorm16(x);
+        encoded[1] = snorm16(y);
+    }
+
+    auto decode_octahedral(const int16_t encoded[2]) -> Vec3 {
+        float const x = std::max(static_cast<float>(encoded[0]) / 32767.0F, -1.0F);
+        float const y = std::max(static_cast<float>(encoded[1]) / 32767.0F, -1.0F);
+        Vec3 normal {x, y, 1.0F - std::abs(x) - std::abs(y)};
+        if (normal.z < 0.0F) {
+            normal.x = (1.0F - std::abs(y)) * (x >= 0.0F ? 1.0F : -1.0F);
+            normal.y = (1.0F - std::abs(x)) * (y >= 0.0F ? 1.0F : -1.0F);
+        }
+        return mathematics::normalize(normal);
+    }
+}    // namespace assets::mesh
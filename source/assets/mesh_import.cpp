@@ -0,0 +1,791 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/assets/mesh.hpp"
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/quaternion.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    using assets::mesh::Mesh;
+    using assets::mesh::Vec3;
+    using assets::mesh::Vertex;
+    using mathematics::Mat3;
+
+    constexpr uint32_t GLB_MAGIC = 0x46546C67U;    // "glTF"
+    constexpr uint32_t GLB_JSON_CHUNK = 0x4E4F534AU;
+    constexpr uint32_t GLB_BINARY_CHUNK = 0x004E4942U;
+    constexpr int GLTF_TRIANGLES = 4;
+    constexpr int MAX_NODE_DEPTH = 64;
+
+    auto read_file(const fs::path& path) -> std::string {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("cannot open " + path.string());
+        }
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    auto face_normal(Vec3 a, Vec3 b, Vec3 c) -> Vec3 {
+        return mathematics::cross(b - a, c - a);
+    }
+
+    // Wavefront OBJ
+
+    struct Corner {
+        long position;
+        long uv;
+        long normal;
+    };
+
+    // OBJ indices count from 1, negative ones from the end of the list so far.
+    auto resolve(long index, size_t count) -> long {
+        long const resolved = index < 0 ? static_cast<long>(count) + index : index - 1;
+        if (resolved < 0 || resolved >= static_cast<long>(count)) {
+            throw std::runtime_error("OBJ index out of range");
+        }
+        return resolved;
+    }
+
+    auto parse_corner(const std::string& token,
+                      size_t positions,
+                      size_t uvs,
+                      size_t normals) -> Corner {
+        Corner corner {-1, -1, -1};
+        size_t const first = token.find('/');
+        corner.position = resolve(std::strtol(token.c_str(), nullptr, 10), positions);
+        if (first == std::string::npos) {
+            return corner;
+        }
+
+        size_t const second = token.find('/', first + 1);
+        size_t const uv_length = second == std::string::npos ? std::string::npos : second - first - 1;
+        std::string const uv = token.substr(first + 1, uv_length);
+        if (!uv.empty()) {
+            corner.uv = resolve(std::strtol(uv.c_str(), nullptr, 10), uvs);
+        }
+        if (second != std::string::npos && second + 1 < token.size()) {
+            corner.normal = resolve(std::strtol(token.c_str() + second + 1, nullptr, 10), normals);
+        }
+        return corner;
+    }
+
+    auto import_obj(const fs::path& path) -> Mesh {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::runtime_error("cannot open " + path.string());
+        }
+
+        std::vector<Vec3> positions;
+        std::vector<std::pair<float, float>> uvs;
+        std::vector<Vec3> normals;
+        std::vector<Corner> corners;
+
+        std::string line;
+        std::vector<Corner> face;
+        while (std::getline(file, line)) {
+            std::istringstream stream(line);
+            std::string keyword;
+            stream >> keyword;
+
+            if (keyword == "v") {
+                Vec3 position;
+                stream >> position.x >> position.y >> position.z;
+                positions.push_back(position);
+            } else if (keyword == "vt") {
+                float u = 0.0F;
+                float v = 0.0F;
+                stream >> u >> v;
+                uvs.emplace_back(u, v);
+            } else if (keyword == "vn") {
+                Vec3 normal;
+                stream >> normal.x >> normal.y >> normal.z;
+                normals.push_back(normal);
+            } else if (keyword == "f") {
+                face.clear();
+                std::string token;
+                while (stream >> token) {
+                    face.push_back(parse_corner(token, positions.size(), uvs.size(), normals.size()));
+                }
+                if (face.size() < 3) {
+                    throw std::runtime_error("OBJ face with fewer than 3 vertices in " + path.string());
+                }
+                // Polygons as fans around their first vertex.
+                for (size_t i = 1; i + 1 < face.size(); ++i) {
+                    corners.push_back(face[0]);
+                    corners.push_back(face[i]);
+                    corners.push_back(face[i + 1]);
+                }
+            }
+        }
+
+        // Smooth normals for corners without one: area weighted face normals summed per position.
+        std::vector<Vec3> smooth(positions.size());
+        for (size_t i = 0; i < corners.size(); i += 3) {
+            Vec3 const normal = face_normal(positions[static_cast<size_t>(corners[i].position)],
+                                            positions[static_cast<size_t>(corners[i + 1].position)],
+                                            positions[static_cast<size_t>(corners[i + 2].position)]);
+            for (size_t k = 0; k < 3; ++k) {
+                smooth[static_cast<size_t>(corners[i + k].position)] += normal;
+            }
+        }
+
+        Mesh mesh;
+        mesh.vertices.reserve(corners.size());
+        mesh.indices.reserve(corners.size());
+        for (const Corner& corner : corners) {
+            Vertex vertex;
+            vertex.position = positions[static_cast<size_t>(corner.position)];
+            Vec3 const normal = corner.normal >= 0 ? normals[static_cast<size_t>(corner.normal)]
+                                                   : smooth[static_cast<size_t>(corner.position)];
+            vertex.normal = mathematics::normalize(normal);
+            if (corner.uv >= 0) {
+                vertex.u = uvs[static_cast<size_t>(corner.uv)].first;
+                vertex.v = uvs[static_cast<size_t>(corner.uv)].second;
+            }
+            mesh.indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+            mesh.vertices.push_back(vertex);
+        }
+        return mesh;
+    }
+
+    // JSON, as much as glTF needs
+
+    struct Json {
+        enum class Kind : uint8_t
+        {
+            Null,
+            Boolean,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        Kind kind = Kind::Null;
+        double number = 0.0;
+        std::string string;
+        std::vector<Json> items;
+        std::vector<std::pair<std::string, Json>> members;
+
+        auto find(const std::string& key) const -> const Json* {
+            for (const auto& [name, value] : members) {
+                if (name == key) {
+                    return &value;
+                }
+            }
+            return nullptr;
+        }
+
+        auto integer(const std::string& key, long fallback) const -> long {
+            const Json* const value = find(key);
+            if (value == nullptr || value->kind != Kind::Number) {
+                return fallback;
+            }
+            return static_cast<long>(value->number);
+        }
+
+        auto text(const std::string& key) const -> std::string {
+            const Json* const value = find(key);
+            return value != nullptr && value->kind == Kind::String ? value->string : std::string {};
+        }
+
+        auto array(const std::string& key) const -> const std::vector<Json>& {
+            static const std::vector<Json> EMPTY;
+            const Json* const value = find(key);
+            return value != nullptr && value->kind == Kind::Array ? value->items : EMPTY;
+        }
+    };
+
+    class JsonParser {
+      public:
+        explicit JsonParser(const std::string& text)
+            : m_text(text) {}
+
+        auto parse() -> Json {
+            Json value = parse_value(0);
+            skip_space();
+            if (m_position != m_text.size()) {
+                fail();
+            }
+            return value;
+        }
+
+      private:
+        static constexpr int MAX_DEPTH = 256;
+
+        [[noreturn]] void fail() const {
+            throw std::runtime_error("invalid glTF JSON at byte " + std::to_string(m_position));
+        }
+
+        void skip_space() {
+            while (m_position < m_text.size()
+                   && std::isspace(static_cast<unsigned char>(m_text[m_position])) != 0)
+            {
+                ++m_position;
+            }
+        }
+
+        auto next() -> char {
+            skip_space();
+            if (m_position == m_text.size()) {
+                fail();
+            }
+            return m_text[m_position];
+        }
+
+        void expect(char character) {
+            if (next() != character) {
+                fail();
+            }
+            ++m_position;
+        }
+
+        auto parse_value(int depth) -> Json {
+            if (depth > MAX_DEPTH) {
+                fail();
+            }
+
+            Json value;
+            char const character = next();
+            if (character == '{') {
+                value.kind = Json::Kind::Object;
+                ++m_position;
+                if (next() == '}') {
+                    ++m_position;
+                    return value;
+                }
+                do {
+                    std::string key = parse_string();
+                    expect(':');
+                    value.members.emplace_back(std::move(key), parse_value(depth + 1));
+                } while (consume(','));
+                expect('}');
+            } else if (character == '[') {
+                value.kind = Json::Kind::Array;
+                ++m_position;
+                if (next() == ']') {
+                    ++m_position;
+                    return value;
+                }
+                do {
+                    value.items.push_back(parse_value(depth + 1));
+                } while (consume(','));
+                expect(']');
+            } else if (character == '"') {
+                value.kind = Json::Kind::String;
+                value.string = parse_string();
+            } else if (literal("true")) {
+                value.kind = Json::Kind::Boolean;
+                value.number = 1.0;
+            } else if (literal("false")) {
+                value.kind = Json::Kind::Boolean;
+            } else if (literal("null")) {
+                value.kind = Json::Kind::Null;
+            } else {
+                const char* const start = m_text.c_str() + m_position;
+                char* end = nullptr;
+                value.kind = Json::Kind::Number;
+                value.number = std::strtod(start, &end);
+                if (end == start) {
+                    fail();
+                }
+                m_position += static_cast<size_t>(end - start);
+            }
+            return value;
+        }
+
+        auto consume(char character) -> bool {
+            if (next() == character) {
+                ++m_position;
+                return true;
+            }
+            return false;
+        }
+
+        auto literal(const char* word) -> bool {
+            size_t const length = std::strlen(word);
+            if (m_text.compare(m_position, length, word) == 0) {
+                m_position += length;
+                return true;
+            }
+            return false;
+        }
+
+        // Escapes other than \uXXXX are kept; names and URIs in glTF files do not need them.
+        auto parse_string() -> std::string {
+            expect('"');
+            std::string result;
+            while (m_position < m_text.size() && m_text[m_position] != '"') {
+                char character = m_text[m_position++];
+                if (character == '\\' && m_position < m_text.size()) {
+                    character = m_text[m_position++];
+                    if (character == 'u') {
+                        m_position += 4;
+                        character = '?';
+                    } else if (character == 'n') {
+                        character = '\n';
+                    } else if (character == 't') {
+                        character = '\t';
+                    }
+                }
+                result += character;
+            }
+            if (m_position == m_text.size()) {
+                fail();
+            }
+            ++m_position;
+            return result;
+        }
+
+        const std::string& m_text;
+        size_t m_position = 0;
+    };
+
+    // glTF 2.0
+
+    auto decode_base64(const std::string& text, size_t start) -> std::string {
+        std::string result;
+        uint32_t accumulator = 0;
+        int bits = 0;
+        for (size_t i = start; i < text.size() && text[i] != '='; ++i) {
+            char const character = text[i];
+            int value = -1;
+            if (character >= 'A' && character <= 'Z') {
+                value = character - 'A';
+            } else if (character >= 'a' && character <= 'z') {
+                value = character - 'a' + 26;
+            } else if (character >= '0' && character <= '9') {
+                value = character - '0' + 52;
+            } else if (character == '+') {
+                value = 62;
+            } else if (character == '/') {
+                value = 63;
+            } else {
+                throw std::runtime_error("invalid base64 in a glTF data URI");
+            }
+            accumulator = (accumulator << 6U) | static_cast<uint32_t>(value);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                result += static_cast<char>((accumulator >> static_cast<uint32_t>(bits)) & 0xFFU);
+            }
+        }
+        return result;
+    }
+
+    // Affine transform of a node: a linear part and a translation.
+    struct Placement {
+        Mat3 linear;
+        Vec3 translation;
+    };
+
+    auto combine(const Placement& parent, const Placement& child) -> Placement {
+        return {parent.linear * child.linear, parent.linear * child.translation + parent.translation};
+    }
+
+    class GltfImporter {
+      public:
+        explicit GltfImporter(const fs::path& path)
+            : m_directory(path.parent_path()) {
+            std::string const file = read_file(path);
+
+            uint32_t magic = 0;
+            if (file.size() >= sizeof(magic)) {
+                std::memcpy(&magic, file.data(), sizeof(magic));
+            }
+            if (magic == GLB_MAGIC) {
+                read_glb(file);
+            } else {
+                m_document = JsonParser(file).parse();
+            }
+            load_buffers();
+        }
+
+        auto import() -> Mesh {
+            Mesh mesh;
+            const std::vector<Json>& scenes = m_document.array("scenes");
+            if (scenes.empty()) {
+                // A file without scenes: its meshes as they are.
+                for (size_t i = 0; i < m_document.array("meshes").size(); ++i) {
+                    add_mesh(static_cast<long>(i), Placement {}, mesh);
+                }
+                return mesh;
+            }
+
+            auto const scene = static_cast<size_t>(m_document.integer("scene", 0));
+            if (scene >= scenes.size()) {
+                throw std::runtime_error("glTF default scene out of range");
+            }
+            for (const Json& node : scenes[scene].array("nodes")) {
+                add_node(static_cast<long>(node.number), Placement {}, mesh, 0);
+            }
+            return mesh;
+        }
+
+      private:
+        struct Accessor {
+            const unsigned char* data = nullptr;
+            size_t count = 0;
+            size_t components = 0;
+            size_t stride = 0;
+            long component_type = 0;
+            bool normalized = false;
+        };
+
+        void read_glb(const std::string& file) {
+            size_t position = 12;
+            std::string json;
+            while (position + 8 <= file.size()) {
+                uint32_t length = 0;
+                uint32_t type = 0;
+                std::memcpy(&length, file.data() + position, sizeof(length));
+                std::memcpy(&type, file.data() + position + 4, sizeof(type));
+                position += 8;
+                if (length > file.size() - position) {
+                    throw std::runtime_error("truncated GLB chunk");
+                }
+                if (type == GLB_JSON_CHUNK) {
+                    json = file.substr(position, length);
+                } else if (type == GLB_BINARY_CHUNK && m_binary.empty()) {
+                    m_binary = file.substr(position, length);
+                }
+                position += length;
+            }
+            if (json.empty()) {
+                throw std::runtime_error("GLB without a JSON chunk");
+            }
+            m_document = JsonParser(json).parse();
+        }
+
+        void load_buffers() {
+            const std::vector<Json>& buffers = m_document.array("buffers");
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                std::string const uri = buffers[i].text("uri");
+                if (uri.empty()) {
+                    if (i != 0) {
+                        throw std::runtime_error("glTF buffer without a URI");
+                    }
+                    m_buffers.push_back(std::move(m_binary));
+                } else if (uri.compare(0, 5, "data:") == 0) {
+                    size_t const comma = uri.find(";base64,");
+                    if (comma == std::string::npos) {
+                        throw std::runtime_error("glTF data URI is not base64");
+                    }
+                    m_buffers.push_back(decode_base64(uri, comma + 8));
+                } else {
+                    m_buffers.push_back(read_file(m_directory / uri));
+                }
+
+                if (static_cast<size_t>(buffers[i].integer("byteLength", 0)) > m_buffers.back().size()) {
+                    throw std::runtime_error("glTF buffer shorter than its byteLength");
+                }
+            }
+        }
+
+        static auto component_size(long type) -> size_t {
+            switch (type) {
+                case 5120:
+                case 5121:
+                    return 1;
+                case 5122:
+                case 5123:
+                    return 2;
+                case 5125:
+                case 5126:
+                    return 4;
+                default:
+                    throw std::runtime_error("unsupported glTF component type " + std::to_string(type));
+            }
+        }
+
+        static auto component_count(const std::string& type) -> size_t {
+            if (type == "SCALAR") {
+                return 1;
+            }
+            if (type == "VEC2") {
+                return 2;
+            }
+            if (type == "VEC3") {
+                return 3;
+            }
+            if (type == "VEC4") {
+                return 4;
+            }
+            throw std::runtime_error("unsupported glTF accessor type " + type);
+        }
+
+        auto accessor(long index) const -> Accessor {
+            const std::vector<Json>& accessors = m_document.array("accessors");
+            if (index < 0 || static_cast<size_t>(index) >= accessors.size()) {
+                throw std::runtime_error("glTF accessor out of range");
+            }
+            const Json& json = accessors[static_cast<size_t>(index)];
+            if (json.find("sparse") != nullptr) {
+                throw std::runtime_error("sparse glTF accessors are not supported");
+            }
+
+            Accessor result;
+            result.count = static_cast<size_t>(json.integer("count", 0));
+            result.components = component_count(json.text("type"));
+            result.component_type = json.integer("componentType", 0);
+            const Json* const normalized = json.find("normalized");
+            result.normalized = normalized != nullptr && std::fabs(normalized->number) > 0.0;
+            size_t const element = result.components * component_size(result.component_type);
+
+            const std::vector<Json>& views = m_document.array("bufferViews");
+            long const view_index = json.integer("bufferView", -1);
+            if (view_index < 0 || static_cast<size_t>(view_index) >= views.size()) {
+                throw std::runtime_error("glTF accessor without a valid buffer view");
+            }
+            const Json& view = views[static_cast<size_t>(view_index)];
+            auto const buffer = static_cast<size_t>(view.integer("buffer", -1));
+            if (buffer >= m_buffers.size()) {
+                throw std::runtime_error("glTF buffer view out of range");
+            }
+            long const view_offset = view.integer("byteOffset", 0);
+            auto const offset = static_cast<size_t>(view_offset + json.integer("byteOffset", 0));
+            result.stride = static_cast<size_t>(view.integer("byteStride", 0));
+            if (result.stride == 0) {
+                result.stride = element;
+            }
+            size_t const end = offset + (result.count - 1) * result.stride + element;
+            if (result.count > 0 && end > m_buffers[buffer].size()) {
+                throw std::runtime_error("glTF accessor outside of its buffer");
+            }
+            result.data = reinterpret_cast<const unsigned char*>(m_buffers[buffer].data()) + offset;
+            return result;
+        }
+
+        static auto component(const Accessor& accessor, size_t element, size_t index) -> float {
+            const unsigned char* const data = accessor.data + element * accessor.stride;
+            switch (accessor.component_type) {
+                case 5126: {
+                    float value = 0.0F;
+                    std::memcpy(&value, data + index * 4, sizeof(value));
+                    return value;
+                }
+                case 5121: {
+                    float const value = data[index];
+                    return accessor.normalized ? value / 255.0F : value;
+                }
+                case 5123: {
+                    uint16_t value = 0;
+                    std::memcpy(&value, data + index * 2, sizeof(value));
+                    auto const result = static_cast<float>(value);
+                    return accessor.normalized ? result / 65535.0F : result;
+                }
+                case 5120: {
+                    auto const value = static_cast<float>(static_cast<int8_t>(data[index]));
+                    return accessor.normalized ? std::max(value / 127.0F, -1.0F) : value;
+                }
+                case 5122: {
+                    int16_t value = 0;
+                    std::memcpy(&value, data + index * 2, sizeof(value));
+                    auto const result = static_cast<float>(value);
+                    return accessor.normalized ? std::max(result / 32767.0F, -1.0F) : result;
+                }
+                default:
+                    throw std::runtime_error("unsupported glTF vertex component type");
+            }
+        }
+
+        static auto index_value(const Accessor& accessor, size_t element) -> uint32_t {
+            const unsigned char* const data = accessor.data + element * accessor.stride;
+            switch (accessor.component_type) {
+                case 5121:
+                    return data[0];
+                case 5123: {
+                    uint16_t value = 0;
+                    std::memcpy(&value, data, sizeof(value));
+                    return value;
+                }
+                case 5125: {
+                    uint32_t value = 0;
+                    std::memcpy(&value, data, sizeof(value));
+                    return value;
+                }
+                default:
+                    throw std::runtime_error("unsupported glTF index component type");
+            }
+        }
+
+        static auto vector(const Json& json, const std::string& key, Vec3 fallback) -> Vec3 {
+            const std::vector<Json>& items = json.array(key);
+            if (items.size() < 3) {
+                return fallback;
+            }
+            return {static_cast<float>(items[0].number),
+                    static_cast<float>(items[1].number),
+                    static_cast<float>(items[2].number)};
+        }
+
+        static auto placement(const Json& node) -> Placement {
+            Placement result;
+            const std::vector<Json>& matrix = node.array("matrix");
+            if (matrix.size() == 16) {
+                // Column major, as Mat3 is.
+                for (int column = 0; column < 3; ++column) {
+                    for (int row = 0; row < 3; ++row) {
+                        auto const element = static_cast<size_t>(column * 4 + row);
+                        result.linear[column][row] = static_cast<float>(matrix[element].number);
+                    }
+                    auto const element = static_cast<size_t>(12 + column);
+                    result.translation[column] = static_cast<float>(matrix[element].number);
+                }
+                return result;
+            }
+
+            mathematics::Quat rotation;
+            const std::vector<Json>& quaternion = node.array("rotation");
+            if (quaternion.size() == 4) {
+                rotation = {static_cast<float>(quaternion[0].number),
+                            static_cast<float>(quaternion[1].number),
+                            static_cast<float>(quaternion[2].number),
+                            static_cast<float>(quaternion[3].number)};
+            }
+            Vec3 const scale = vector(node, "scale", {1.0F, 1.0F, 1.0F});
+            result.linear =
+                mathematics::to_matrix(mathematics::normalize(rotation)) * mathematics::diagonal(scale);
+            result.translation = vector(node, "translation", {});
+            return result;
+        }
+
+        void add_node(long index, const Placement& parent, Mesh& mesh, int depth) const {
+            const std::vector<Json>& nodes = m_document.array("nodes");
+            if (index < 0 || static_cast<size_t>(index) >= nodes.size() || depth > MAX_NODE_DEPTH) {
+                throw std::runtime_error("glTF node out of range or nested too deep");
+            }
+            const Json& node = nodes[static_cast<size_t>(index)];
+            Placement const world = combine(parent, placement(node));
+
+            long const node_mesh = node.integer("mesh", -1);
+            if (node_mesh >= 0) {
+                add_mesh(node_mesh, world, mesh);
+            }
+            for (const Json& child : node.array("children")) {
+                add_node(static_cast<long>(child.number), world, mesh, depth + 1);
+            }
+        }
+
+        void add_mesh(long index, const Placement& world, Mesh& mesh) const {
+            const std::vector<Json>& meshes = m_document.array("meshes");
+            if (index < 0 || static_cast<size_t>(index) >= meshes.size()) {
+                throw std::runtime_error("glTF mesh out of range");
+            }
+            Mat3 const normal_matrix = mathematics::transpose(mathematics::inverse(world.linear));
+
+            for (const Json& primitive : meshes[static_cast<size_t>(index)].array("primitives")) {
+                if (primitive.integer("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES) {
+                    continue;    // points and lines have no place in a triangle mesh
+                }
+                const Json* const attributes = primitive.find("attributes");
+                long const position_index = attributes != nullptr ? attributes->integer("POSITION", -1) : -1;
+                if (position_index < 0) {
+                    continue;
+                }
+
+                Accessor const positions = accessor(position_index);
+                long const normal_index = attributes->integer("NORMAL", -1);
+                long const uv_index = attributes->integer("TEXCOORD_0", -1);
+                Accessor const normals = normal_index >= 0 ? accessor(normal_index) : Accessor {};
+                Accessor const uvs = uv_index >= 0 ? accessor(uv_index) : Accessor {};
+                if (positions.components != 3 || (normals.data != nullptr && normals.count < positions.count)
+                    || (uvs.data != nullptr && uvs.count < positions.count))
+                {
+                    throw std::runtime_error("glTF primitive with mismatched attributes");
+                }
+
+                auto const base = static_cast<uint32_t>(mesh.vertices.size());
+                for (size_t i = 0; i < positions.count; ++i) {
+                    Vertex vertex;
+                    Vec3 const local {
+                        component(positions, i, 0), component(positions, i, 1), component(positions, i, 2)};
+                    vertex.position = world.linear * local + world.translation;
+                    if (normals.data != nullptr) {
+                        Vec3 const normal {
+                            component(normals, i, 0), component(normals, i, 1), component(normals, i, 2)};
+                        vertex.normal = mathematics::normalize(normal_matrix * normal);
+                    }
+                    if (uvs.data != nullptr) {
+                        vertex.u = component(uvs, i, 0);
+                        vertex.v = component(uvs, i, 1);
+                    }
+                    mesh.vertices.push_back(vertex);
+                }
+
+                size_t const first_index = mesh.indices.size();
+                long const indices_index = primitive.integer("indices", -1);
+                if (indices_index >= 0) {
+                    Accessor const indices = accessor(indices_index);
+                    // A trailing partial triangle is dropped.
+                    for (size_t i = 0; i < indices.count - indices.count % 3; ++i) {
+                        uint32_t const vertex = index_value(indices, i);
+                        if (vertex >= positions.count) {
+                            throw std::runtime_error("glTF index out of range");
+                        }
+                        mesh.indices.push_back(base + vertex);
+                    }
+                } else {
+                    for (size_t i = 0; i + 3 <= positions.count; i += 3) {
+                        mesh.indices.insert(mesh.indices.end(), {base + static_cast<uint32_t>(i),
+                                                                 base + static_cast<uint32_t>(i + 1),
+                                                                 base + static_cast<uint32_t>(i + 2)});
+                    }
+                }
+
+                if (normals.data == nullptr) {
+                    flat_normals(mesh, first_index);
+                }
+            }
+        }
+
+        // Faces without normals: each corner gets its own copy of the vertex with the face normal.
+        static void flat_normals(Mesh& mesh, size_t first_index) {
+            for (size_t i = first_index; i + 3 <= mesh.indices.size(); i += 3) {
+                Vec3 const normal = mathematics::normalize(
+                    face_normal(mesh.vertices[mesh.indices[i]].position,
+                                mesh.vertices[mesh.indices[i + 1]].position,
+                                mesh.vertices[mesh.indices[i + 2]].position));
+                for (size_t k = 0; k < 3; ++k) {
+                    Vertex vertex = mesh.vertices[mesh.indices[i + k]];
+                    vertex.normal = normal;
+                    mesh.indices[i + k] = static_cast<uint32_t>(mesh.vertices.size());
+                    mesh.vertices.push_back(vertex);
+                }
+            }
+        }
+
+        fs::path m_directory;
+        Json m_document;
+        std::string m_binary;
+        std::vector<std::string> m_buffers;
+    };
+}    // namespace
+
+namespace assets::mesh {
+    auto import_mesh(const std::string& path) -> Mesh {
+        std::string const extension = fs::path(path).extension().string();
+        if (extension == ".obj") {
+            return import_obj(path);
+        }
+        if (extension == ".gltf" || extension == ".glb") {
+            return GltfImporter(path).import();
+        }
+        throw std::runtime_error("unknown model format: " + path);
+    }
+}    // namespace assets::mesh
@@ -0,0 +1,589 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "domkrat3d/assets/texture.hpp"
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+    using assets::texture::Image;
+    using assets::texture::MipFilter;
+    using assets::texture::TextureFormat;
+    using simd::float4;
+
+    constexpr uint32_t MAX_DIMENSION = 1U << 15U;
+    constexpr size_t LEVEL_ALIGNMENT = 16;
+    constexpr size_t ROW_GRAIN = 8;
+
+    // Kaiser filter: the radius in texels of the smaller level and the shape of the window.
+    constexpr float KAISER_RADIUS = 3.0F;
+    constexpr float KAISER_ALPHA = 4.0F;
+    constexpr float PI = 3.14159265358979F;
+
+    // ---- decoding ----
+
+    class Reader {
+      public:
+        Reader(const std::byte* data, size_t size)
+            : m_data(data)
+            , m_size(size) {}
+
+        auto remaining() const -> size_t { return m_size - m_position; }
+
+        auto byte() -> uint8_t {
+            if (m_position >= m_size) {
+                throw std::runtime_error("truncated image");
+            }
+            return static_cast<uint8_t>(m_data[m_position++]);
+        }
+
+        auto u16() -> uint32_t {
+            uint32_t const low = byte();
+            return low | (static_cast<uint32_t>(byte()) << 8U);
+        }
+
+        void skip(size_t count) {
+            if (count > remaining()) {
+                throw std::runtime_error("truncated image");
+            }
+            m_position += count;
+        }
+
+        // Whitespace separated word of a PNM header, skipping comments.
+        auto word() -> std::string {
+            std::string result;
+            while (m_position < m_size) {
+                auto const character = static_cast<char>(m_data[m_position]);
+                if (character == '#') {
+                    while (m_position < m_size && static_cast<char>(m_data[m_position]) != '\n') {
+                        ++m_position;
+                    }
+                } else if (character == ' ' || character == '\t' || character == '\r' || character == '\n') {
+                    if (!result.empty()) {
+                        break;
+                    }
+                    ++m_position;
+                } else {
+                    result += character;
+                    ++m_position;
+                }
+            }
+            return result;
+        }
+
+        auto number() -> uint32_t {
+            std::string const text = word();
+            bool const digits = !text.empty() && text.find_first_not_of("0123456789") == std::string::npos;
+            if (!digits || text.size() > 9) {
+                throw std::runtime_error("invalid PNM header");
+            }
+            return static_cast<uint32_t>(std::stoul(text));
+        }
+
+      private:
+        const std::byte* m_data;
+        size_t m_size;
+        size_t m_position = 0;
+    };
+
+    auto allocate(uint32_t width, uint32_t height) -> Image {
+        if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+            throw std::runtime_error("image size out of range");
+        }
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(size_t {width} * height * 4);
+        return image;
+    }
+
+    // P5 (grey), P6 (RGB) and P7 (PAM, 1 to 4 channels), 8 bits per channel.
+    auto decode_pnm(Reader& reader) -> Image {
+        std::string const magic = reader.word();
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t channels = 0;
+        uint32_t maximum = 0;
+
+        if (magic == "P7") {
+            for (std::string key = reader.word(); key != "ENDHDR"; key = reader.word()) {
+                if (key.empty()) {
+                    throw std::runtime_error("invalid PAM header");
+                }
+                if (key == "WIDTH") {
+                    width = reader.number();
+                } else if (key == "HEIGHT") {
+                    height = reader.number();
+                } else if (key == "DEPTH") {
+                    channels = reader.number();
+                } else if (key == "MAXVAL") {
+                    maximum = reader.number();
+                } else if (key == "TUPLTYPE") {
+                    reader.word();
+                }
+            }
+        } else {
+            channels = magic == "P5" ? 1 : 3;
+            width = reader.number();
+            height = reader.number();
+            maximum = reader.number();
+        }
+        reader.byte();    // the single whitespace after the header
+        if (maximum != 255 || channels < 1 || channels > 4) {
+            throw std::runtime_error("unsupported PNM image: 8-bit images of 1 to 4 channels only");
+        }
+
+        Image image = allocate(width, height);
+        for (size_t texel = 0; texel < size_t {width} * height; ++texel) {
+            uint8_t values[4] = {0, 0, 0, 255};
+            for (uint32_t c = 0; c < channels; ++c) {
+                values[c] = reader.byte();
+            }
+            // Grey, with alpha when there are two channels.
+            if (channels <= 2) {
+                values[3] = channels == 2 ? values[1] : uint8_t {255};
+                values[1] = values[0];
+                values[2] = values[0];
+            }
+            std::memcpy(&image.pixels[texel * 4], values, 4);
+        }
+        return image;
+    }
+
+    // Image types 2 and 3 (true colour, grey) and their RLE versions 10 and 11.
+    auto decode_tga(Reader& reader) -> Image {
+        uint32_t const id_length = reader.byte();
+        uint32_t const color_map = reader.byte();
+        uint32_t const type = reader.byte();
+        reader.skip(9);
+        uint32_t const width = reader.u16();
+        uint32_t const height = reader.u16();
+        uint32_t const bits = reader.byte();
+        uint32_t const descriptor = reader.byte();
+        reader.skip(id_length);
+
+        bool const grey = type == 3 || type == 11;
+        bool const rle = type == 10 || type == 11;
+        bool const valid_bits = grey ? bits == 8 : (bits == 24 || bits == 32);
+        if (color_map != 0 || (type != 2 && type != 3 && !rle) || !valid_bits) {
+            throw std::runtime_error("unsupported TGA image: 8-bit grey or 24/32-bit true colour only");
+        }
+
+        Image image = allocate(width, height);
+        uint32_t const bytes = bits / 8;
+        bool const top_down = (descriptor & 0x20U) != 0;
+        size_t const count = size_t {width} * height;
+
+        uint8_t texel[4] = {0, 0, 0, 255};
+        auto const read_texel = [&reader, &texel, bytes, grey]()
+        {
+            if (grey) {
+                texel[0] = reader.byte();
+                texel[1] = texel[0];
+                texel[2] = texel[0];
+                return;
+            }
+            texel[2] = reader.byte();
+            texel[1] = reader.byte();
+            texel[0] = reader.byte();
+            texel[3] = bytes == 4 ? reader.byte() : uint8_t {255};
+        };
+        auto const store = [&image, &texel, width, height, top_down](size_t index)
+        {
+            size_t const row = index / width;
+            size_t const target = (top_down ? row : height - 1 - row) * width + index % width;
+            std::memcpy(&image.pixels[target * 4], texel, 4);
+        };
+
+        for (size_t index = 0; index < count;) {
+            uint32_t run = 1;
+            bool repeat = false;
+            if (rle) {
+                uint32_t const packet = reader.byte();
+                run = (packet & 0x7FU) + 1;
+                repeat = (packet & 0x80U) != 0;
+            }
+            for (uint32_t k = 0; k < run && index < count; ++k, ++index) {
+                if (!repeat || k == 0) {
+                    read_texel();
+                }
+                store(index);
+            }
+        }
+        return image;
+    }
+
+    // ---- colour spaces ----
+
+    auto srgb_to_linear(float value) -> float {
+        return value <= 0.04045F ? value / 12.92F : std::pow((value + 0.055F) / 1.055F, 2.4F);
+    }
+
+    auto linear_to_srgb(float value) -> float {
+        return value <= 0.0031308F ? value * 12.92F : 1.055F * std::pow(value, 1.0F / 2.4F) - 0.055F;
+    }
+
+    auto srgb_table() -> const std::array<float, 256>& {
+        static const std::array<float, 256> TABLE = []
+        {
+            std::array<float, 256> table {};
+            for (size_t i = 0; i < table.size(); ++i) {
+                table[i] = srgb_to_linear(static_cast<float>(i) / 255.0F);
+            }
+            return table;
+        }();
+        return TABLE;
+    }
+
+    // Level in linear light, four floats per texel.
+    struct FloatImage {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<float> texels;
+
+        auto at(uint32_t x, uint32_t y) const -> float4 {
+            return simd::load(&texels[(size_t {y} * width + x) * 4]);
+        }
+
+        void set(uint32_t x, uint32_t y, float4 value) {
+            simd::store(&texels[(size_t {y} * width + x) * 4], value);
+        }
+    };
+
+    // ---- filters ----
+
+    auto bessel_i0(float x) -> float {
+        float sum = 1.0F;
+        float term = 1.0F;
+        for (int k = 1; k < 32 && term > sum * 1e-8F; ++k) {
+            float const half = x / (2.0F * static_cast<float>(k));
+            term *= half * half;
+            sum += term;
+        }
+        return sum;
+    }
+
+    auto kaiser(float t) -> float {
+        float const ratio = t / KAISER_RADIUS;
+        if (std::abs(ratio) >= 1.0F) {
+            return 0.0F;
+        }
+        float const sinc = !(std::abs(t) > 0.0F) ? 1.0F : std::sin(PI * t) / (PI * t);
+        return sinc * bessel_i0(KAISER_ALPHA * std::sqrt(1.0F - ratio * ratio)) / bessel_i0(KAISER_ALPHA);
+    }
+
+    // Source texels and weights of every destination texel along one axis, normalized to sum to 1.
+    struct Taps {
+        std::vector<uint32_t> first;
+        std::vector<std::vector<float>> weights;
+    };
+
+    auto kaiser_taps(uint32_t source, uint32_t destination) -> Taps {
+        float const scale = static_cast<float>(source) / static_cast<float>(destination);
+        float const support = KAISER_RADIUS * scale;
+        int const last = static_cast<int>(source) - 1;
+
+        Taps taps;
+        for (uint32_t x = 0; x < destination; ++x) {
+            float const center = (static_cast<float>(x) + 0.5F) * scale;
+            auto const begin = static_cast<int>(std::floor(center - support));
+            auto const end = static_cast<int>(std::ceil(center + support));
+            int const low = std::clamp(begin, 0, last);
+
+            // Taps past the edges repeat the edge texel; they are folded into its weight.
+            std::vector<float> weights(static_cast<size_t>(std::clamp(end, 0, last) - low + 1), 0.0F);
+            float total = 0.0F;
+            for (int i = begin; i <= end; ++i) {
+                float const weight = kaiser((static_cast<float>(i) + 0.5F - center) / scale);
+                weights[static_cast<size_t>(std::clamp(i, 0, last) - low)] += weight;
+                total += weight;
+            }
+            for (float& weight : weights) {
+                weight /= total;
+            }
+            taps.first.push_back(static_cast<uint32_t>(low));
+            taps.weights.push_back(std::move(weights));
+        }
+        return taps;
+    }
+
+    auto half_size(const FloatImage& source) -> FloatImage {
+        FloatImage level;
+        level.width = std::max(source.width / 2, 1U);
+        level.height = std::max(source.height / 2, 1U);
+        level.texels.resize(size_t {level.width} * level.height * 4);
+        return level;
+    }
+
+    auto box_level(const FloatImage& source, utils::jobs::JobSystem& jobs) -> FloatImage {
+        FloatImage level = half_size(source);
+
+        auto const body = [&source, &level](size_t begin, size_t end)
+        {
+            float4 const quarter = simd::set1(0.25F);
+            for (auto y = static_cast<uint32_t>(begin); y < end; ++y) {
+                uint32_t const y0 = std::min(y * 2, source.height - 1);
+                uint32_t const y1 = std::min(y * 2 + 1, source.height - 1);
+                for (uint32_t x = 0; x < level.width; ++x) {
+                    uint32_t const x0 = std::min(x * 2, source.width - 1);
+                    uint32_t const x1 = std::min(x * 2 + 1, source.width - 1);
+                    float4 const sum =
+                        source.at(x0, y0) + source.at(x1, y0) + source.at(x0, y1) + source.at(x1, y1);
+                    level.set(x, y, sum * quarter);
+                }
+            }
+        };
+        utils::parallel::parallel_for(jobs, level.height, ROW_GRAIN, body);
+        return level;
+    }
+
+    // Separable: rows of the source are filtered to the new width, then columns to the new height.
+    auto kaiser_level(const FloatImage& source, utils::jobs::JobSystem& jobs) -> FloatImage {
+        FloatImage level = half_size(source);
+        Taps const horizontal = kaiser_taps(source.width, level.width);
+        Taps const vertical = kaiser_taps(source.height, level.height);
+
+        FloatImage rows;
+        rows.width = level.width;
+        rows.height = source.height;
+        rows.texels.resize(size_t {rows.width} * rows.height * 4);
+
+        auto const filter_rows = [&source, &rows, &horizontal](size_t begin, size_t end)
+        {
+            for (auto y = static_cast<uint32_t>(begin); y < end; ++y) {
+                for (uint32_t x = 0; x < rows.width; ++x) {
+                    const std::vector<float>& weights = horizontal.weights[x];
+                    float4 sum = simd::zero4();
+                    for (uint32_t k = 0; k < weights.size(); ++k) {
+                        sum = sum + source.at(horizontal.first[x] + k, y) * simd::set1(weights[k]);
+                    }
+                    rows.set(x, y, sum);
+                }
+            }
+        };
+        auto const filter_columns = [&rows, &level, &vertical](size_t begin, size_t end)
+        {
+            for (auto y = static_cast<uint32_t>(begin); y < end; ++y) {
+                const std::vector<float>& weights = vertical.weights[y];
+                for (uint32_t x = 0; x < level.width; ++x) {
+                    float4 sum = simd::zero4();
+                    for (uint32_t k = 0; k < weights.size(); ++k) {
+                        sum = sum + rows.at(x, vertical.first[y] + k) * simd::set1(weights[k]);
+                    }
+                    level.set(x, y, sum);
+                }
+            }
+        };
+        utils::parallel::parallel_for(jobs, rows.height, ROW_GRAIN, filter_rows);
+        utils::parallel::parallel_for(jobs, level.height, ROW_GRAIN, filter_columns);
+        return level;
+    }
+
+    auto to_float(const Image& image, bool srgb, utils::jobs::JobSystem& jobs) -> FloatImage {
+        FloatImage result;
+        result.width = image.width;
+        result.height = image.height;
+        result.texels.resize(image.pixels.size());
+        const std::array<float, 256>& table = srgb_table();
+
+        size_t const row = size_t {image.width} * 4;
+        auto const body = [&image, &result, &table, srgb, row](size_t begin, size_t end)
+        {
+            for (size_t i = begin * row; i < end * row; ++i) {
+                uint8_t const value = image.pixels[i];
+                bool const color = srgb && i % 4 != 3;
+                result.texels[i] = color ? table[value] : static_cast<float>(value) / 255.0F;
+            }
+        };
+        utils::parallel::parallel_for(jobs, image.height, ROW_GRAIN, body);
+        return result;
+    }
+
+    auto to_image(const FloatImage& level, bool srgb, utils::jobs::JobSystem& jobs) -> Image {
+        Image image = allocate(level.width, level.height);
+
+        size_t const row = size_t {level.width} * 4;
+        auto const body = [&image, &level, srgb, row](size_t begin, size_t end)
+        {
+            for (size_t i = begin * row; i < end * row; ++i) {
+                // The Kaiser filter rings a little past 0 and 1.
+                float value = std::clamp(level.texels[i], 0.0F, 1.0F);
+                if (srgb && i % 4 != 3) {
+                    value = linear_to_srgb(value);
+                }
+                image.pixels[i] = static_cast<uint8_t>(std::lround(value * 255.0F));
+            }
+        };
+        utils::parallel::parallel_for(jobs, level.height, ROW_GRAIN, body);
+        return image;
+    }
+
+    // Texels of a block; past the right and bottom edges the last column and row repeat.
+    void gather_block(const Image& image, uint32_t block_x, uint32_t block_y, uint8_t texels[64]) {
+        for (uint32_t texel = 0; texel < 16; ++texel) {
+            uint32_t const x = std::min(block_x * 4 + texel % 4, image.width - 1);
+            uint32_t const y = std::min(block_y * 4 + texel / 4, image.height - 1);
+            std::memcpy(&texels[texel * 4], &image.pixels[(size_t {y} * image.width + x) * 4], 4);
+        }
+    }
+
+    auto align(size_t value) -> size_t {
+        return (value + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+    }
+}    // namespace
+
+namespace assets::texture {
+    auto decode_image(const std::byte* data, size_t size) -> Image {
+        if (data == nullptr || size < 2) {
+            throw std::runtime_error("not an image");
+        }
+
+        Reader reader(data, size);
+        auto const first = static_cast<char>(data[0]);
+        auto const second = static_cast<char>(data[1]);
+        if (first == 'P' && (second == '5' || second == '6' || second == '7')) {
+            return decode_pnm(reader);
+        }
+        return decode_tga(reader);
+    }
+
+    auto load_image(const std::string& path) -> Image {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        std::vector<char> const contents {std::istreambuf_iterator<char>(file),
+                                          std::istreambuf_iterator<char>()};
+        try {
+            return decode_image(reinterpret_cast<const std::byte*>(contents.data()), contents.size());
+        } catch (const std::runtime_error& error) {
+            throw std::runtime_error(path + ": " + error.what());
+        }
+    }
+
+    auto generate_mips(const Image& image, bool srgb, MipFilter filter, utils::jobs::JobSystem& jobs)
+        -> std::vector<Image> {
+        std::vector<Image> levels {image};
+        FloatImage current = to_float(image, srgb, jobs);
+        while ((current.width > 1 || current.height > 1) && levels.size() < MAX_MIP_LEVELS) {
+            current = filter == MipFilter::Box ? box_level(current, jobs) : kaiser_level(current, jobs);
+            levels.push_back(to_image(current, srgb, jobs));
+        }
+        return levels;
+    }
+
+    auto level_size(TextureFormat format, uint32_t width, uint32_t height) -> size_t {
+        if (format == TextureFormat::RGBA8) {
+            return size_t {width} * height * 4;
+        }
+        size_t const blocks = size_t {(width + 3) / 4} * ((height + 3) / 4);
+        return blocks * (format == TextureFormat::BC1 ? 8 : 16);
+    }
+
+    auto compress(const Image& image, TextureFormat format, uint32_t tile_size, utils::jobs::JobSystem& jobs)
+        -> std::vector<std::byte> {
+        std::vector<std::byte> result(level_size(format, image.width, image.height));
+        if (format == TextureFormat::RGBA8) {
+            std::memcpy(result.data(), image.pixels.data(), result.size());
+            return result;
+        }
+
+        uint32_t const blocks_x = (image.width + 3) / 4;
+        uint32_t const blocks_y = (image.height + 3) / 4;
+        uint32_t const tile_blocks = std::max(tile_size / 4, 1U);
+        uint32_t const tiles_x = (blocks_x + tile_blocks - 1) / tile_blocks;
+        uint32_t const tiles_y = (blocks_y + tile_blocks - 1) / tile_blocks;
+        size_t const block_bytes = format == TextureFormat::BC1 ? 8 : 16;
+
+        auto const body = [&](size_t begin, size_t end)
+        {
+            uint8_t texels[64];
+            for (size_t tile = begin; tile < end; ++tile) {
+                uint32_t const first_x = static_cast<uint32_t>(tile % tiles_x) * tile_blocks;
+                uint32_t const first_y = static_cast<uint32_t>(tile / tiles_x) * tile_blocks;
+                uint32_t const last_x = std::min(first_x + tile_blocks, blocks_x);
+                uint32_t const last_y = std::min(first_y + tile_blocks, blocks_y);
+
+                for (uint32_t block_y = first_y; block_y < last_y; ++block_y) {
+                    for (uint32_t block_x = first_x; block_x < last_x; ++block_x) {
+                        gather_block(image, block_x, block_y, texels);
+                        size_t const block = size_t {block_y} * blocks_x + block_x;
+                        encode_block(format, texels, result.data() + block * block_bytes);
+                    }
+                }
+            }
+        };
+        utils::parallel::parallel_for(jobs, size_t {tiles_x} * tiles_y, 1, body);
+        return result;
+    }
+
+    auto cook(const Image& image, const TextureSettings& settings, utils::jobs::JobSystem& jobs)
+        -> std::vector<std::byte> {
+        std::vector<Image> const levels = settings.mipmaps
+                                              ? generate_mips(image, settings.srgb, settings.filter, jobs)
+                                              : std::vector<Image> {image};
+
+        TextureHeader header;
+        header.format = settings.format;
+        header.width = image.width;
+        header.height = image.height;
+        header.mip_count = static_cast<uint32_t>(levels.size());
+        header.srgb = settings.srgb ? 1 : 0;
+
+        std::vector<std::byte> blob(sizeof(TextureHeader));
+        for (size_t mip = 0; mip < levels.size(); ++mip) {
+            std::vector<std::byte> const data =
+                compress(levels[mip], settings.format, settings.tile_size, jobs);
+            blob.resize(align(blob.size()));
+            header.offsets[mip] = static_cast<uint32_t>(blob.size());
+            blob.insert(blob.end(), data.begin(), data.end());
+        }
+        std::memcpy(blob.data(), &header, sizeof(header));
+        return blob;
+    }
+
+    auto CookedTexture::level(uint32_t mip) const -> Level {
+        Level result;
+        result.width = std::max(header->width >> mip, 1U);
+        result.height = std::max(header->height >> mip, 1U);
+        result.data = data + header->offsets[mip];
+        result.size = level_size(header->format, result.width, result.height);
+        return result;
+    }
+
+    auto read_texture(const std::byte* data, size_t size) -> CookedTexture {
+        if (data == nullptr || size < sizeof(TextureHeader)) {
+            return {};
+        }
+
+        const auto* const header = reinterpret_cast<const TextureHeader*>(data);
+        if (header->magic != TEXTURE_MAGIC || header->version != TEXTURE_VERSION
+            || header->format > TextureFormat::BC7 || header->width == 0 || header->height == 0
+            || header->width > MAX_DIMENSION || header->height > MAX_DIMENSION || header->mip_count == 0
+            || header->mip_count > MAX_MIP_LEVELS)
+        {
+            return {};
+        }
+
+        CookedTexture texture {header, data};
+        for (uint32_t mip = 0; mip < header->mip_count; ++mip) {
+            Level const level = texture.level(mip);
+            if (header->offsets[mip] < sizeof(TextureHeader) || header->offsets[mip] > size
+                || level.size > size - header->offsets[mip])
+            {
+                return {};
+            }
+        }
+        return texture;
+    }
+}    // namespace assets::texture
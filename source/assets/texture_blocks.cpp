@@ -0,0 +1,583 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "domkrat3d/assets/texture.hpp"
+
+namespace {
+    using assets::texture::TextureFormat;
+
+    constexpr int TEXELS = 16;
+    constexpr int POWER_ITERATIONS = 8;
+
+    // Interpolation weights of BC7 4-bit indices, out of 64.
+    constexpr int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // Little-endian bit stream of one 128-bit block.
+    class BitWriter {
+      public:
+        explicit BitWriter(std::byte* block)
+            : m_block(block) {
+            std::memset(m_block, 0, 16);
+        }
+
+        void write(uint32_t value, uint32_t count) {
+            for (uint32_t bit = 0; bit < count; ++bit, ++m_position) {
+                if (((value >> bit) & 1U) != 0) {
+                    m_block[m_position / 8] |= std::byte {static_cast<uint8_t>(1U << (m_position % 8))};
+                }
+            }
+        }
+
+      private:
+        std::byte* m_block;
+        uint32_t m_position = 0;
+    };
+
+    class BitReader {
+      public:
+        explicit BitReader(const std::byte* block)
+            : m_block(block) {}
+
+        auto read(uint32_t count) -> uint32_t {
+            uint32_t value = 0;
+            for (uint32_t bit = 0; bit < count; ++bit, ++m_position) {
+                auto const byte = static_cast<uint32_t>(m_block[m_position / 8]);
+                value |= ((byte >> (m_position % 8)) & 1U) << bit;
+            }
+            return value;
+        }
+
+      private:
+        const std::byte* m_block;
+        uint32_t m_position = 0;
+    };
+
+    void write16(std::byte* out, uint16_t value) {
+        std::memcpy(out, &value, sizeof(value));
+    }
+
+    auto read16(const std::byte* in) -> uint16_t {
+        uint16_t value = 0;
+        std::memcpy(&value, in, sizeof(value));
+        return value;
+    }
+
+    // Direction of largest spread of a set of points of `Channels` components, by power iteration on
+    // their covariance; the mean is returned too. A flat set gives a zero axis.
+    template<int Channels>
+    void principal_axis(const float points[][4], int count, float mean[4], float axis[4]) {
+        for (int c = 0; c < 4; ++c) {
+            mean[c] = 0.0F;
+            axis[c] = 0.0F;
+        }
+        if (count == 0) {
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            for (int c = 0; c < Channels; ++c) {
+                mean[c] += points[i][c];
+            }
+        }
+        for (int c = 0; c < Channels; ++c) {
+            mean[c] /= static_cast<float>(count);
+        }
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < count; ++i) {
+            for (int a = 0; a < Channels; ++a) {
+                for (int b = 0; b < Channels; ++b) {
+                    covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                }
+            }
+        }
+
+        // Starting from the channel that varies most: a fixed start such as (1, 1, 1, 1) can be
+        // orthogonal to the axis, e.g. for red rising while green falls, and never turn towards it.
+        int widest = 0;
+        for (int c = 1; c < Channels; ++c) {
+            if (covariance[c][c] > covariance[widest][widest]) {
+                widest = c;
+            }
+        }
+        float vector[4] = {};
+        vector[widest] = 1.0F;
+        for (int iteration = 0; iteration < POWER_ITERATIONS; ++iteration) {
+            float next[4] = {};
+            float largest = 0.0F;
+            for (int a = 0; a < Channels; ++a) {
+                for (int b = 0; b < Channels; ++b) {
+                    next[a] += covariance[a][b] * vector[b];
+                }
+                largest = std::max(largest, std::abs(next[a]));
+            }
+            if (!(largest > 0.0F)) {
+                return;
+            }
+            for (int c = 0; c < Channels; ++c) {
+                vector[c] = next[c] / largest;
+            }
+        }
+        for (int c = 0; c < Channels; ++c) {
+            axis[c] = vector[c];
+        }
+    }
+
+    // Ends of the principal axis over the points: the mean moved by the smallest and largest projection.
+    template<int Channels>
+    void axis_ends(const float points[][4], int count, float low[4], float high[4]) {
+        float mean[4];
+        float axis[4];
+        principal_axis<Channels>(points, count, mean, axis);
+
+        float minimum = std::numeric_limits<float>::max();
+        float maximum = std::numeric_limits<float>::lowest();
+        float length = 0.0F;
+        for (int c = 0; c < Channels; ++c) {
+            length += axis[c] * axis[c];
+        }
+        for (int i = 0; i < count; ++i) {
+            float projection = 0.0F;
+            for (int c = 0; c < Channels; ++c) {
+                projection += (points[i][c] - mean[c]) * axis[c];
+            }
+            minimum = std::min(minimum, projection);
+            maximum = std::max(maximum, projection);
+        }
+        if (!(length > 0.0F) || count == 0) {
+            minimum = 0.0F;
+            maximum = 0.0F;
+            length = 1.0F;
+        }
+        for (int c = 0; c < 4; ++c) {
+            low[c] = std::clamp(mean[c] + axis[c] * minimum / length, 0.0F, 255.0F);
+            high[c] = std::clamp(mean[c] + axis[c] * maximum / length, 0.0F, 255.0F);
+        }
+    }
+
+    // ---- BC1 colour ----
+
+    auto quantize(float value, float levels) -> uint32_t {
+        return static_cast<uint32_t>(std::lround(std::clamp(value, 0.0F, 255.0F) * levels / 255.0F));
+    }
+
+    auto pack565(const float color[4]) -> uint16_t {
+        return static_cast<uint16_t>((quantize(color[0], 31.0F) << 11U) | (quantize(color[1], 63.0F) << 5U)
+                                     | quantize(color[2], 31.0F));
+    }
+
+    void unpack565(uint16_t packed, int color[3]) {
+        uint32_t const r = (packed >> 11U) & 31U;
+        uint32_t const g = (packed >> 5U) & 63U;
+        uint32_t const b = packed & 31U;
+        color[0] = static_cast<int>((r << 3U) | (r >> 2U));
+        color[1] = static_cast<int>((g << 2U) | (g >> 4U));
+        color[2] = static_cast<int>((b << 3U) | (b >> 2U));
+    }
+
+    // The four colours of a BC1 block; the last is transparent black in three-colour mode, which BC1
+    // takes when c0 <= c1 and BC3 never does.
+    void color_palette(uint16_t c0, uint16_t c1, bool four_colors, int palette[4][4]) {
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        palette[0][3] = 255;
+        palette[1][3] = 255;
+        for (int c = 0; c < 3; ++c) {
+            if (four_colors) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            } else {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = four_colors ? 255 : 0;
+    }
+
+    // Nearest palette colour of every texel, transparent texels to index 3; the squared error.
+    auto color_indices(const uint8_t texels[64],
+                       const bool transparent[TEXELS],
+                       uint16_t c0,
+                       uint16_t c1,
+                       bool four_colors,
+                       uint32_t& indices) -> int {
+        int palette[4][4];
+        color_palette(c0, c1, four_colors, palette);
+        int const choices = four_colors ? 4 : 3;
+
+        indices = 0;
+        int total = 0;
+        for (int i = 0; i < TEXELS; ++i) {
+            uint32_t best = 3;
+            if (!transparent[i]) {
+                int best_error = std::numeric_limits<int>::max();
+                for (int k = 0; k < choices; ++k) {
+                    int error = 0;
+                    for (int c = 0; c < 3; ++c) {
+                        int const difference = texels[i * 4 + c] - palette[k][c];
+                        error += difference * difference;
+                    }
+                    if (error < best_error) {
+                        best_error = error;
+                        best = static_cast<uint32_t>(k);
+                    }
+                }
+                total += best_error;
+            }
+            indices |= best << (static_cast<uint32_t>(i) * 2U);
+        }
+        return total;
+    }
+
+    // Endpoints minimizing the squared error for fixed four-colour indices, per channel.
+    auto least_squares(const float points[][4],
+                       const int order[TEXELS],
+                       int count,
+                       uint32_t indices,
+                       float c0[4],
+                       float c1[4]) -> bool {
+        constexpr float WEIGHT[4] = {1.0F, 0.0F, 2.0F / 3.0F, 1.0F / 3.0F};
+        float aa = 0.0F;
+        float ab = 0.0F;
+        float bb = 0.0F;
+        float ax[3] = {};
+        float bx[3] = {};
+        for (int i = 0; i < count; ++i) {
+            float const a = WEIGHT[(indices >> (static_cast<uint32_t>(order[i]) * 2U)) & 3U];
+            float const b = 1.0F - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; ++c) {
+                ax[c] += a * points[i][c];
+                bx[c] += b * points[i][c];
+            }
+        }
+        float const determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6F) {
+            return false;
+        }
+        for (int c = 0; c < 3; ++c) {
+            c0[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+            c1[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+        }
+        return true;
+    }
+
+    // Colour part of BC1 and BC3; three-colour mode with transparent texels only when allowed.
+    void encode_color(const uint8_t texels[64], bool allow_transparent, std::byte* block) {
+        float points[TEXELS][4];
+        int order[TEXELS];
+        bool transparent[TEXELS];
+        int count = 0;
+        for (int i = 0; i < TEXELS; ++i) {
+            transparent[i] = allow_transparent && texels[i * 4 + 3] < 128;
+            if (!transparent[i]) {
+                for (int c = 0; c < 4; ++c) {
+                    points[count][c] = texels[i * 4 + c];
+                }
+                order[count++] = i;
+            }
+        }
+        bool const three_colors = count < TEXELS;
+
+        float low[4];
+        float high[4];
+        axis_ends<3>(points, count, low, high);
+        // Pulled in by 1/16 of the range: the ends of a fit are rarely the best palette colours.
+        for (int c = 0; c < 3; ++c) {
+            float const inset = (high[c] - low[c]) / 16.0F;
+            low[c] += inset;
+            high[c] -= inset;
+        }
+
+        uint16_t c0 = pack565(high);
+        uint16_t c1 = pack565(low);
+        if (three_colors ? c0 > c1 : c0 < c1) {
+            std::swap(c0, c1);
+        }
+        bool const four_colors = !allow_transparent || c0 > c1;
+        uint32_t indices = 0;
+        int const error = color_indices(texels, transparent, c0, c1, four_colors, indices);
+
+        // One least squares step from the first indices, kept when it lowers the error.
+        float fitted0[4] = {};
+        float fitted1[4] = {};
+        if (four_colors && c0 != c1 && error > 0
+            && least_squares(points, order, count, indices, fitted0, fitted1))
+        {
+            uint16_t r0 = pack565(fitted0);
+            uint16_t r1 = pack565(fitted1);
+            if (r0 < r1) {
+                std::swap(r0, r1);
+            }
+            uint32_t refined = 0;
+            if (r0 != r1 && color_indices(texels, transparent, r0, r1, true, refined) < error) {
+                c0 = r0;
+                c1 = r1;
+                indices = refined;
+            }
+        }
+
+        write16(block, c0);
+        write16(block + 2, c1);
+        std::memcpy(block + 4, &indices, sizeof(indices));
+    }
+
+    void decode_color(const std::byte* block, bool four_colors, uint8_t texels[64]) {
+        uint16_t const c0 = read16(block);
+        uint16_t const c1 = read16(block + 2);
+        uint32_t indices = 0;
+        std::memcpy(&indices, block + 4, sizeof(indices));
+
+        int palette[4][4];
+        color_palette(c0, c1, four_colors || c0 > c1, palette);
+        for (uint32_t i = 0; i < TEXELS; ++i) {
+            uint32_t const index = (indices >> (i * 2U)) & 3U;
+            for (uint32_t c = 0; c < 4; ++c) {
+                texels[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+            }
+        }
+    }
+
+    // ---- BC4 single channel (BC3 alpha, BC5) ----
+
+    void encode_channel(const uint8_t texels[64], int channel, std::byte* block) {
+        int low = 255;
+        int high = 0;
+        for (int i = 0; i < TEXELS; ++i) {
+            low = std::min<int>(low, texels[i * 4 + channel]);
+            high = std::max<int>(high, texels[i * 4 + channel]);
+        }
+
+        block[0] = std::byte {static_cast<uint8_t>(high)};
+        block[1] = std::byte {static_cast<uint8_t>(low)};
+        uint64_t indices = 0;
+        if (high > low) {
+            // Eight values from high (index 0) to low (index 1), the six between as indices 2 to 7.
+            for (int i = 0; i < TEXELS; ++i) {
+                int const step = (7 * (high - texels[i * 4 + channel]) + (high - low) / 2) / (high - low);
+                uint64_t const index = step == 0 ? 0 : (step == 7 ? 1 : static_cast<uint64_t>(step) + 1);
+                indices |= index << (static_cast<uint64_t>(i) * 3U);
+            }
+        }
+        for (int byte = 0; byte < 6; ++byte) {
+            block[2 + byte] = std::byte {static_cast<uint8_t>(indices >> (static_cast<uint64_t>(byte) * 8U))};
+        }
+    }
+
+    void decode_channel(const std::byte* block, int channel, uint8_t texels[64]) {
+        auto const a0 = static_cast<int>(block[0]);
+        auto const a1 = static_cast<int>(block[1]);
+        int palette[8] = {a0, a1};
+        if (a0 > a1) {
+            for (int k = 1; k < 7; ++k) {
+                palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+            }
+        } else {
+            for (int k = 1; k < 5; ++k) {
+                palette[k + 1] = ((5 - k) * a0 + k * a1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t indices = 0;
+        for (int byte = 0; byte < 6; ++byte) {
+            indices |= static_cast<uint64_t>(block[2 + byte]) << (static_cast<uint64_t>(byte) * 8U);
+        }
+        for (int i = 0; i < TEXELS; ++i) {
+            auto const index = static_cast<size_t>((indices >> (static_cast<uint64_t>(i) * 3U)) & 7U);
+            texels[i * 4 + channel] = static_cast<uint8_t>(palette[index]);
+        }
+    }
+
+    // ---- BC7 mode 6: one subset, RGBA endpoints of 7 bits and a p-bit, 4-bit indices ----
+
+    auto interpolate(int e0, int e1, int index) -> int {
+        return ((64 - BC7_WEIGHTS[index]) * e0 + BC7_WEIGHTS[index] * e1 + 32) >> 6;
+    }
+
+    // 7-bit endpoint that with the p-bit below it comes closest to an 8-bit value.
+    auto quantize7(float value, int pbit) -> int {
+        return std::clamp(static_cast<int>(std::lround((value - static_cast<float>(pbit)) / 2.0F)), 0, 127);
+    }
+
+    // Nearest of the 16 palette entries for every texel; the squared error.
+    auto bc7_indices(const uint8_t texels[64], const int e0[4], const int e1[4], int indices[TEXELS]) -> int {
+        int palette[16][4];
+        for (int k = 0; k < 16; ++k) {
+            for (int c = 0; c < 4; ++c) {
+                palette[k][c] = interpolate(e0[c], e1[c], k);
+            }
+        }
+
+        int total = 0;
+        for (int i = 0; i < TEXELS; ++i) {
+            int best_error = std::numeric_limits<int>::max();
+            for (int k = 0; k < 16; ++k) {
+                int error = 0;
+                for (int c = 0; c < 4; ++c) {
+                    int const difference = texels[i * 4 + c] - palette[k][c];
+                    error += difference * difference;
+                }
+                if (error < best_error) {
+                    best_error = error;
+                    indices[i] = k;
+                }
+            }
+            total += best_error;
+        }
+        return total;
+    }
+
+    void encode_bc7(const uint8_t texels[64], std::byte* block) {
+        float points[TEXELS][4];
+        for (int i = 0; i < TEXELS; ++i) {
+            for (int c = 0; c < 4; ++c) {
+                points[i][c] = texels[i * 4 + c];
+            }
+        }
+        float low[4];
+        float high[4];
+        axis_ends<4>(points, TEXELS, low, high);
+
+        // Every combination of p-bits quantizes the endpoints differently; keep the best.
+        int best_error = std::numeric_limits<int>::max();
+        int best_quantized[2][4] = {};
+        int best_pbits[2] = {};
+        int best_indices[TEXELS] = {};
+        for (int p0 = 0; p0 < 2; ++p0) {
+            for (int p1 = 0; p1 < 2; ++p1) {
+                int quantized[2][4];
+                int e0[4];
+                int e1[4];
+                for (int c = 0; c < 4; ++c) {
+                    quantized[0][c] = quantize7(low[c], p0);
+                    quantized[1][c] = quantize7(high[c], p1);
+                    e0[c] = quantized[0][c] * 2 + p0;
+                    e1[c] = quantized[1][c] * 2 + p1;
+                }
+                int indices[TEXELS];
+                int const error = bc7_indices(texels, e0, e1, indices);
+                if (error < best_error) {
+                    best_error = error;
+                    std::memcpy(best_quantized, quantized, sizeof(quantized));
+                    best_pbits[0] = p0;
+                    best_pbits[1] = p1;
+                    std::memcpy(best_indices, indices, sizeof(indices));
+                }
+            }
+        }
+
+        // The first index is stored in 3 bits, so its top bit must be 0: swap the ends if it is not.
+        if (best_indices[0] >= 8) {
+            for (int c = 0; c < 4; ++c) {
+                std::swap(best_quantized[0][c], best_quantized[1][c]);
+            }
+            std::swap(best_pbits[0], best_pbits[1]);
+            for (int& index : best_indices) {
+                index = 15 - index;
+            }
+        }
+
+        BitWriter writer(block);
+        writer.write(1U << 6U, 7);
+        for (int c = 0; c < 4; ++c) {
+            writer.write(static_cast<uint32_t>(best_quantized[0][c]), 7);
+            writer.write(static_cast<uint32_t>(best_quantized[1][c]), 7);
+        }
+        writer.write(static_cast<uint32_t>(best_pbits[0]), 1);
+        writer.write(static_cast<uint32_t>(best_pbits[1]), 1);
+        for (int i = 0; i < TEXELS; ++i) {
+            writer.write(static_cast<uint32_t>(best_indices[i]), i == 0 ? 3 : 4);
+        }
+    }
+
+    // Mode 6 only, as written by encode_bc7; blocks of other modes decode as opaque magenta.
+    void decode_bc7(const std::byte* block, uint8_t texels[64]) {
+        BitReader reader(block);
+        if (reader.read(7) != (1U << 6U)) {
+            for (int i = 0; i < TEXELS; ++i) {
+                texels[i * 4] = 255;
+                texels[i * 4 + 1] = 0;
+                texels[i * 4 + 2] = 255;
+                texels[i * 4 + 3] = 255;
+            }
+            return;
+        }
+
+        int e0[4];
+        int e1[4];
+        for (int c = 0; c < 4; ++c) {
+            e0[c] = static_cast<int>(reader.read(7)) << 1;
+            e1[c] = static_cast<int>(reader.read(7)) << 1;
+        }
+        auto const p0 = static_cast<int>(reader.read(1));
+        auto const p1 = static_cast<int>(reader.read(1));
+        for (int c = 0; c < 4; ++c) {
+            e0[c] |= p0;
+            e1[c] |= p1;
+        }
+        for (int i = 0; i < TEXELS; ++i) {
+            auto const index = static_cast<int>(reader.read(i == 0 ? 3 : 4));
+            for (int c = 0; c < 4; ++c) {
+                texels[i * 4 + c] = static_cast<uint8_t>(interpolate(e0[c], e1[c], index));
+            }
+        }
+    }
+}    // namespace
+
+namespace assets::texture {
+    void encode_block(TextureFormat format, const uint8_t texels[64], std::byte* block) {
+        switch (format) {
+            case TextureFormat::RGBA8:
+                std::memcpy(block, texels, 64);
+                break;
+            case TextureFormat::BC1:
+                encode_color(texels, true, block);
+                break;
+            case TextureFormat::BC3:
+                encode_channel(texels, 3, block);
+                encode_color(texels, false, block + 8);
+                break;
+            case TextureFormat::BC5:
+                encode_channel(texels, 0, block);
+                encode_channel(texels, 1, block + 8);
+                break;
+            case TextureFormat::BC7:
+                encode_bc7(texels, block);
+                break;
+        }
+    }
+
+    void decode_block(TextureFormat format, const std::byte* block, uint8_t texels[64]) {
+        switch (format) {
+            case TextureFormat::RGBA8:
+                std::memcpy(texels, block, 64);
+                break;
+            case TextureFormat::BC1:
+                decode_color(block, false, texels);
+                break;
+            case TextureFormat::BC3:
+                decode_color(block + 8, true, texels);
+                decode_channel(block, 3, texels);
+                break;
+            case TextureFormat::BC5:
+                for (int i = 0; i < TEXELS; ++i) {
+                    texels[i * 4 + 2] = 0;
+                    texels[i * 4 + 3] = 255;
+                }
+                decode_channel(block, 0, texels);
+                decode_channel(block + 8, 1, texels);
+                break;
+            case TextureFormat::BC7:
+                decode_bc7(block, texels);
+                break;
+        }
+    }
+}    // namespace assets::texture
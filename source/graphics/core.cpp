@@ -1,13 +1,19 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <iostream>
+#include <thread>
 
 #include "domkrat3d/graphics/core.hpp"
 
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan_core.h>
 
+#include "domkrat3d/graphics/input.hpp"
 #include "domkrat3d/tracelogger.hpp"
 #include "domkrat3d/utils/random.hpp"
+#include "domkrat3d/utils/tasks.hpp"
 
 #define GLFW_INCLUDE_VULKAN
 #define GLFW_DLL
@@ -16,6 +22,12 @@
 
 // Non-public Functions
 namespace {
+    // Seconds the window thread waits for events before checking whether the window closed.
+    constexpr double EVENT_TIMEOUT = 0.1;
+
+    // Time between the starts of two frames of the game thread, 60 frames per second.
+    constexpr std::chrono::microseconds FRAME_PERIOD {16667};
+
     void print_vulkan_extensions_count() {
         LOG_TRACE
 
@@ -63,16 +75,62 @@ void poll_events_if_window_open(GLFWwindow* window, int width, int height) {
     float blue = generate_random_float();
     float green = generate_random_float();
 
+    // This thread owns the window and the context: it waits for events and presents the frames.
+    // The frame runs as a task graph on a game thread that takes the input queued by the
+    // callbacks at its start.
+    graphics::input::InputQueue input;
+    input.attach(window);
+
+    double max_latency = 0.0;
+    utils::tasks::TaskGraph frame;
+    utils::tasks::ResourceId const events = frame.add_resource("events");
+
+    frame.add_task({"input",
+                    [&input, &max_latency]()
+                    {
+                        input.drain([](const graphics::input::Event&) {});
+                        max_latency = std::max(max_latency, input.latency().max);
+                    },
+                    {},
+                    {events},
+                    true});
+    frame.compile();
+
+    std::atomic<bool> running {true};
+    std::atomic<uint64_t> finished {0};
+    std::thread game(
+        [&frame, &running, &finished]()
+        {
+            // A frame that runs late starts the next one at once instead of catching up.
+            auto next = std::chrono::steady_clock::now();
+            while (running.load(std::memory_order_acquire)) {
+                frame.run();
+                finished.fetch_add(1, std::memory_order_release);
+                glfwPostEmptyEvent();
+
+                next = std::max(next + FRAME_PERIOD, std::chrono::steady_clock::now());
+                std::this_thread::sleep_until(next);
+            }
+        });
+
+    uint64_t presented = 0;
     while (glfwWindowShouldClose(window) == 0) {
-        glfwPollEvents();
-
-        // Render Color
-        glClearColor(red, green, blue, 1.0F);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // Swap the screen buffers
-        glfwSwapBuffers(window);
+        glfwWaitEventsTimeout(EVENT_TIMEOUT);
+
+        // Present once per finished frame; the game thread wakes this one when it finishes.
+        uint64_t const latest = finished.load(std::memory_order_acquire);
+        if (latest != presented) {
+            presented = latest;
+            glClearColor(red, green, blue, 1.0F);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glfwSwapBuffers(window);
+        }
     }
+    running.store(false, std::memory_order_release);
+    game.join();
+    input.detach();
+
+    std::cout << "input latency up to " << max_latency << " ms, " << input.dropped() << " events dropped\n";
 }
 
 void initialize_window(int width, int height, const char* title) {
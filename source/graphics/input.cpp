@@ -0,0 +1,72 @@
+#include "domkrat3d/graphics/input.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    using graphics::input::Event;
+    using graphics::input::EventType;
+    using graphics::input::InputQueue;
+
+    auto queue_of(GLFWwindow* window) -> InputQueue* {
+        return static_cast<InputQueue*>(glfwGetWindowUserPointer(window));
+    }
+
+    void key_callback(GLFWwindow* window, int key, int /*scancode*/, int action, int mods) {
+        queue_of(window)->push({EventType::Key, key, action, mods, 0.0, 0.0, 0});
+    }
+
+    void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+        queue_of(window)->push({EventType::MouseButton, button, action, mods, 0.0, 0.0, 0});
+    }
+
+    void cursor_position_callback(GLFWwindow* window, double x, double y) {
+        queue_of(window)->push({EventType::CursorMove, 0, 0, 0, x, y, 0});
+    }
+
+    void scroll_callback(GLFWwindow* window, double x, double y) {
+        queue_of(window)->push({EventType::Scroll, 0, 0, 0, x, y, 0});
+    }
+
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+        Event event;
+        event.type = EventType::Resize;
+        event.x = static_cast<double>(width);
+        event.y = static_cast<double>(height);
+        queue_of(window)->push(event);
+    }
+}    // namespace
+
+namespace graphics::input {
+    InputQueue::~InputQueue() {
+        detach();
+    }
+
+    void InputQueue::attach(GLFWwindow* window) {
+        LOG_TRACE
+
+        detach();
+        m_window = window;
+        glfwSetWindowUserPointer(window, this);
+        glfwSetKeyCallback(window, key_callback);
+        glfwSetMouseButtonCallback(window, mouse_button_callback);
+        glfwSetCursorPosCallback(window, cursor_position_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    }
+
+    void InputQueue::detach() {
+        if (m_window == nullptr) {
+            return;
+        }
+
+        glfwSetKeyCallback(m_window, nullptr);
+        glfwSetMouseButtonCallback(m_window, nullptr);
+        glfwSetCursorPosCallback(m_window, nullptr);
+        glfwSetScrollCallback(m_window, nullptr);
+        glfwSetFramebufferSizeCallback(m_window, nullptr);
+        glfwSetWindowUserPointer(m_window, nullptr);
+        m_window = nullptr;
+    }
+}    // namespace graphics::input
@@ -1,8 +1,10 @@
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <exception>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "domkrat3d/graphics/simple.hpp"
@@ -15,6 +17,9 @@
 
 const std::vector<const char*> VALIDATION_LAYERS = {"VK_LAYER_KHRONOS_validation"};
 
+// Headless frames are RGBA8 so that read back pixels need no conversion.
+const VkFormat OFFSCREEN_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
 std::string SimpleBasicApplication::DebugIndent = START_INDENT_SYMBOL;
 
 #ifdef DEBUG
@@ -55,7 +60,7 @@ SimpleBasicApplication::debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT me
                                        void* p_user_data) -> VkBool32 {
     LOG_TRACE
 
-    auto severity_str = [message_severity]() -> std::string
+    auto severity_str = [message_severity]() -> const char*
     {
         switch (message_severity) {
             case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
@@ -71,7 +76,7 @@ SimpleBasicApplication::debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT me
         }
     }();
 
-    auto type_str = [message_type]() -> std::string
+    auto type_str = [message_type]() -> const char*
     {
         switch (message_type) {
             case VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT:
@@ -85,7 +90,7 @@ SimpleBasicApplication::debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT me
         }
     }();
 
-    auto color = [message_severity]() -> std::string
+    auto color = [message_severity]() -> const char*
     {
         switch (message_severity) {
             case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
@@ -107,6 +112,11 @@ SimpleBasicApplication::debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT me
     return VK_FALSE;
 }
 
+SimpleBasicApplication::SimpleBasicApplication(const HeadlessOptions& options)
+    : headless(options) {
+    LOG_TRACE
+}
+
 auto SimpleBasicApplication::check_validation_layer_support() -> bool {
     LOG_TRACE
 
@@ -137,11 +147,16 @@ auto SimpleBasicApplication::check_validation_layer_support() -> bool {
 auto SimpleBasicApplication::get_required_extensions() -> std::vector<const char*> {
     LOG_TRACE
 
+    // Surface extensions come from GLFW, which needs a display; headless instances render offscreen only.
     uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    const char** glfwExtensions = nullptr;
+    if (!headless.enabled) {
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    }
 
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    std::vector<const char*> extensions;
+    extensions.reserve(glfwExtensionCount + 1);
+    extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
 
     if (ENABLE_VALIDATION_LAYERS) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -166,7 +181,9 @@ void SimpleBasicApplication::populate_debug_messenger_create_info(
 void SimpleBasicApplication::run() {
     LOG_TRACE
 
-    init_window();
+    if (!headless.enabled) {
+        init_window();
+    }
     init_vulkan();
     main_loop();
     cleanup();
@@ -184,6 +201,12 @@ void SimpleBasicApplication::init_vulkan() {
 
     create_instance();
     setup_debug_callback();
+
+    if (headless.enabled) {
+        create_device();
+        create_offscreen_target();
+        create_commands();
+    }
 }
 
 void SimpleBasicApplication::setup_debug_callback() {
@@ -251,22 +274,360 @@ void SimpleBasicApplication::create_instance() {
     }
 }
 
+void SimpleBasicApplication::create_device() {
+    LOG_TRACE
+
+    uint32_t device_count = 0;
+    vkEnumeratePhysicalDevices(instance, &device_count, nullptr);
+    std::vector<VkPhysicalDevice> devices(device_count);
+    vkEnumeratePhysicalDevices(instance, &device_count, devices.data());
+
+    // Any device with a graphics queue will do, CPU implementations included; discrete GPUs come first.
+    bool found = false;
+    for (const auto& candidate : devices) {
+        uint32_t family_count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &family_count, nullptr);
+        std::vector<VkQueueFamilyProperties> families(family_count);
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &family_count, families.data());
+
+        for (uint32_t family = 0; family < family_count; ++family) {
+            if ((families[family].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
+                continue;
+            }
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(candidate, &properties);
+            if (!found || properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
+                physical_device = candidate;
+                graphics_queue_family = family;
+                found = true;
+            }
+            break;
+        }
+    }
+
+    if (!found) {
+        throw std::runtime_error("failed to find a device with a graphics queue!");
+    }
+
+    float const queue_priority = 1.0F;
+    VkDeviceQueueCreateInfo queue_create_info {};
+    queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queue_create_info.queueFamilyIndex = graphics_queue_family;
+    queue_create_info.queueCount = 1;
+    queue_create_info.pQueuePriorities = &queue_priority;
+
+    // Offscreen rendering needs no device extensions, in particular no swapchain.
+    VkDeviceCreateInfo create_info {};
+    create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    create_info.queueCreateInfoCount = 1;
+    create_info.pQueueCreateInfos = &queue_create_info;
+
+    if (vkCreateDevice(physical_device, &create_info, nullptr, &device) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create logical device!");
+    }
+
+    vkGetDeviceQueue(device, graphics_queue_family, 0, &graphics_queue);
+}
+
+auto SimpleBasicApplication::find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties)
+    -> uint32_t {
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+        if ((type_bits & (1U << i)) != 0
+            && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find a suitable memory type!");
+}
+
+void SimpleBasicApplication::create_offscreen_target() {
+    LOG_TRACE
+
+    auto const width = static_cast<uint32_t>(WIDTH);
+    auto const height = static_cast<uint32_t>(HEIGHT);
+
+    VkImageCreateInfo image_info {};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = OFFSCREEN_FORMAT;
+    image_info.extent = {width, height, 1};
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(device, &image_info, nullptr, &color_image) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create offscreen image!");
+    }
+
+    VkMemoryRequirements image_requirements;
+    vkGetImageMemoryRequirements(device, color_image, &image_requirements);
+
+    VkMemoryAllocateInfo image_allocate_info {};
+    image_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    image_allocate_info.allocationSize = image_requirements.size;
+    image_allocate_info.memoryTypeIndex =
+        find_memory_type(image_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (vkAllocateMemory(device, &image_allocate_info, nullptr, &color_memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate offscreen image memory!");
+    }
+    vkBindImageMemory(device, color_image, color_memory, 0);
+
+    VkImageViewCreateInfo view_info {};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = color_image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = OFFSCREEN_FORMAT;
+    view_info.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    if (vkCreateImageView(device, &view_info, nullptr, &color_view) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create offscreen image view!");
+    }
+
+    // The pass leaves the image ready to be copied, whether or not this frame is read back.
+    VkAttachmentDescription color_attachment {};
+    color_attachment.format = OFFSCREEN_FORMAT;
+    color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    color_attachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    VkAttachmentReference color_reference {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+
+    VkSubpassDescription subpass {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &color_reference;
+
+    // Attachment writes finish before the copy to the readback buffer reads them.
+    VkSubpassDependency dependency {};
+    dependency.srcSubpass = 0;
+    dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    VkRenderPassCreateInfo render_pass_info {};
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    render_pass_info.attachmentCount = 1;
+    render_pass_info.pAttachments = &color_attachment;
+    render_pass_info.subpassCount = 1;
+    render_pass_info.pSubpasses = &subpass;
+    render_pass_info.dependencyCount = 1;
+    render_pass_info.pDependencies = &dependency;
+
+    if (vkCreateRenderPass(device, &render_pass_info, nullptr, &render_pass) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create offscreen render pass!");
+    }
+
+    VkFramebufferCreateInfo framebuffer_info {};
+    framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebuffer_info.renderPass = render_pass;
+    framebuffer_info.attachmentCount = 1;
+    framebuffer_info.pAttachments = &color_view;
+    framebuffer_info.width = width;
+    framebuffer_info.height = height;
+    framebuffer_info.layers = 1;
+
+    if (vkCreateFramebuffer(device, &framebuffer_info, nullptr, &framebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create offscreen framebuffer!");
+    }
+
+    if (!headless.read_back) {
+        return;
+    }
+
+    VkBufferCreateInfo buffer_info {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = VkDeviceSize {width} * height * 4;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &buffer_info, nullptr, &readback_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create readback buffer!");
+    }
+
+    VkMemoryRequirements buffer_requirements;
+    vkGetBufferMemoryRequirements(device, readback_buffer, &buffer_requirements);
+
+    VkMemoryAllocateInfo buffer_allocate_info {};
+    buffer_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    buffer_allocate_info.allocationSize = buffer_requirements.size;
+    buffer_allocate_info.memoryTypeIndex =
+        find_memory_type(buffer_requirements.memoryTypeBits,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    if (vkAllocateMemory(device, &buffer_allocate_info, nullptr, &readback_memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate readback memory!");
+    }
+    vkBindBufferMemory(device, readback_buffer, readback_memory, 0);
+}
+
+void SimpleBasicApplication::create_commands() {
+    LOG_TRACE
+
+    VkCommandPoolCreateInfo pool_info {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = graphics_queue_family;
+
+    if (vkCreateCommandPool(device, &pool_info, nullptr, &command_pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create command pool!");
+    }
+
+    VkCommandBufferAllocateInfo allocate_info {};
+    allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocate_info.commandPool = command_pool;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(device, &allocate_info, &command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate command buffer!");
+    }
+
+    VkFenceCreateInfo fence_info {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(device, &fence_info, nullptr, &frame_fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create frame fence!");
+    }
+}
+
+void SimpleBasicApplication::render_offscreen_frame(uint32_t frame_index, bool read_back) {
+    auto const width = static_cast<uint32_t>(WIDTH);
+    auto const height = static_cast<uint32_t>(HEIGHT);
+
+    vkResetCommandBuffer(command_buffer, 0);
+
+    VkCommandBufferBeginInfo begin_info {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    VkClearValue clear_value {};
+    clear_value.color = CLEAR_COLOR;
+
+    VkRenderPassBeginInfo render_pass_begin {};
+    render_pass_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    render_pass_begin.renderPass = render_pass;
+    render_pass_begin.framebuffer = framebuffer;
+    render_pass_begin.renderArea = {{0, 0}, {width, height}};
+    render_pass_begin.clearValueCount = 1;
+    render_pass_begin.pClearValues = &clear_value;
+
+    vkCmdBeginRenderPass(command_buffer, &render_pass_begin, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdEndRenderPass(command_buffer);
+
+    if (read_back) {
+        VkBufferImageCopy region {};
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageExtent = {width, height, 1};
+        vkCmdCopyImageToBuffer(
+            command_buffer, color_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback_buffer, 1, &region);
+
+        // Make the copy visible to the host once the fence signals.
+        VkBufferMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = readback_buffer;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier,
+                             0,
+                             nullptr);
+    }
+
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    VkSubmitInfo submit_info {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+
+    if (vkQueueSubmit(graphics_queue, 1, &submit_info, frame_fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit offscreen frame " + std::to_string(frame_index) + "!");
+    }
+    vkWaitForFences(device, 1, &frame_fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(device, 1, &frame_fence);
+
+    if (read_back) {
+        void* data = nullptr;
+        vkMapMemory(device, readback_memory, 0, VK_WHOLE_SIZE, 0, &data);
+        auto const* pixels = static_cast<const uint8_t*>(data);
+        frame_pixels.assign(pixels, pixels + (size_t {width} * height * 4));
+        vkUnmapMemory(device, readback_memory);
+    }
+}
+
 void SimpleBasicApplication::main_loop() {
     LOG_TRACE
 
-    poll_events_if_window_open(window, WIDTH, HEIGHT);
+    if (!headless.enabled) {
+        poll_events_if_window_open(window, WIDTH, HEIGHT);
+        return;
+    }
+
+    for (uint32_t frame_index = 0; frame_index < headless.frame_count; ++frame_index) {
+        bool const last = frame_index + 1 == headless.frame_count;
+        render_offscreen_frame(frame_index, headless.read_back && last);
+    }
 }
 
 void SimpleBasicApplication::cleanup() {
     LOG_TRACE
 
+    if (device != VK_NULL_HANDLE) {
+        vkDeviceWaitIdle(device);
+
+        vkDestroyFence(device, frame_fence, nullptr);
+        vkDestroyCommandPool(device, command_pool, nullptr);
+        vkDestroyBuffer(device, readback_buffer, nullptr);
+        vkFreeMemory(device, readback_memory, nullptr);
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+        vkDestroyRenderPass(device, render_pass, nullptr);
+        vkDestroyImageView(device, color_view, nullptr);
+        vkDestroyImage(device, color_image, nullptr);
+        vkFreeMemory(device, color_memory, nullptr);
+        vkDestroyDevice(device, nullptr);
+    }
+
     if (ENABLE_VALIDATION_LAYERS) {
         destroy_debug_utils_messenger_ext(instance, debug_messenger, nullptr);
     }
 
     vkDestroyInstance(instance, nullptr);
 
-    terminate_window(window);
+    if (!headless.enabled) {
+        terminate_window(window);
+    }
 }
 
 auto open_application(SimpleBasicApplication* application) -> int {
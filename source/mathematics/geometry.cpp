@@ -0,0 +1,104 @@
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+
+namespace mathematics::geometry {
+
+    auto intersect(const Ray& ray, const Aabb& box) -> float {
+        float near = 0.0F;
+        float far = ray.max_distance;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            float const inverse = 1.0F / ray.direction[axis];
+            float t0 = (box.min[axis] - ray.origin[axis]) * inverse;
+            float t1 = (box.max[axis] - ray.origin[axis]) * inverse;
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+
+            near = t0 > near ? t0 : near;
+            far = t1 < far ? t1 : far;
+            if (near > far) {
+                return std::numeric_limits<float>::infinity();
+            }
+        }
+
+        return near;
+    }
+
+    auto intersect_triangle(const Ray& ray, Vec3 a, Vec3 b, Vec3 c) -> float {
+        constexpr float EPSILON = 1e-8F;
+        float const miss = std::numeric_limits<float>::infinity();
+
+        Vec3 const edge1 = b - a;
+        Vec3 const edge2 = c - a;
+        Vec3 const p = cross(ray.direction, edge2);
+        float const determinant = dot(edge1, p);
+        if (std::fabs(determinant) < EPSILON) {
+            return miss;
+        }
+
+        float const inverse = 1.0F / determinant;
+        Vec3 const offset = ray.origin - a;
+        float const u = dot(offset, p) * inverse;
+        if (u < 0.0F || u > 1.0F) {
+            return miss;
+        }
+
+        Vec3 const q = cross(offset, edge1);
+        float const v = dot(ray.direction, q) * inverse;
+        if (v < 0.0F || u + v > 1.0F) {
+            return miss;
+        }
+
+        float const t = dot(edge2, q) * inverse;
+        return t >= 0.0F && t <= ray.max_distance ? t : miss;
+    }
+
+    // Voronoi region walk from Ericson, "Real-Time Collision Detection", 5.1.5.
+    auto closest_point_on_triangle(Vec3 point, Vec3 a, Vec3 b, Vec3 c) -> Vec3 {
+        Vec3 const ab = b - a;
+        Vec3 const ac = c - a;
+        Vec3 const ap = point - a;
+
+        float const d1 = dot(ab, ap);
+        float const d2 = dot(ac, ap);
+        if (d1 <= 0.0F && d2 <= 0.0F) {
+            return a;
+        }
+
+        Vec3 const bp = point - b;
+        float const d3 = dot(ab, bp);
+        float const d4 = dot(ac, bp);
+        if (d3 >= 0.0F && d4 <= d3) {
+            return b;
+        }
+
+        float const vc = (d1 * d4) - (d3 * d2);
+        if (vc <= 0.0F && d1 >= 0.0F && d3 <= 0.0F) {
+            return a + (ab * (d1 / (d1 - d3)));
+        }
+
+        Vec3 const cp = point - c;
+        float const d5 = dot(ab, cp);
+        float const d6 = dot(ac, cp);
+        if (d6 >= 0.0F && d5 <= d6) {
+            return c;
+        }
+
+        float const vb = (d5 * d2) - (d1 * d6);
+        if (vb <= 0.0F && d2 >= 0.0F && d6 <= 0.0F) {
+            return a + (ac * (d2 / (d2 - d6)));
+        }
+
+        float const va = (d3 * d6) - (d5 * d4);
+        if (va <= 0.0F && (d4 - d3) >= 0.0F && (d5 - d6) >= 0.0F) {
+            return b + ((c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+        }
+
+        float const denominator = 1.0F / (va + vb + vc);
+        return a + (ab * (vb * denominator)) + (ac * (vc * denominator));
+    }
+}    // namespace mathematics::geometry
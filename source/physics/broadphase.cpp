@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "domkrat3d/physics/broadphase.hpp"
+
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+    using physics::broadphase::Aabb;
+    using physics::broadphase::Pair;
+    using physics::broadphase::ProxyId;
+
+    constexpr size_t WIDTH = static_cast<size_t>(simd::LANES);
+    constexpr int ALL_LANES = (1 << simd::LANES) - 1;
+    constexpr uint32_t ALL_AXES = 7;
+    constexpr uint32_t STAMP_SHIFT = 3;
+    constexpr uint32_t STAMP_MASK = UINT32_MAX >> STAMP_SHIFT;
+
+    // Cell coordinates are packed into 21 bits each.
+    constexpr uint64_t CELL_MASK = (1ULL << 21U) - 1;
+    constexpr int64_t CELL_BIAS = 1LL << 20U;
+
+    // New proxies beyond this share of all proxies are cheaper to place with a full sort.
+    constexpr size_t FULL_SORT_DIVISOR = 8;
+
+    auto make_pair(ProxyId a, ProxyId b) -> Pair {
+        return a < b ? Pair {a, b} : Pair {b, a};
+    }
+
+    auto cell_coordinate(float value, float inverse_cell_size) -> int32_t {
+        return static_cast<int32_t>(std::floor(value * inverse_cell_size));
+    }
+
+    auto cell_key(int32_t x, int32_t y, int32_t z) -> uint64_t {
+        auto pack = [](int32_t coordinate)
+        { return static_cast<uint64_t>(coordinate + CELL_BIAS) & CELL_MASK; };
+        return (pack(x) << 42U) | (pack(y) << 21U) | pack(z);
+    }
+
+    auto next_stamp(uint32_t stamp) -> uint32_t {
+        return (stamp + 1) & STAMP_MASK;
+    }
+
+    // Recycled id if there is one, otherwise the next unused one.
+    auto allocate_id(std::vector<ProxyId>& free, size_t used) -> ProxyId {
+        if (free.empty()) {
+            return static_cast<ProxyId>(used);
+        }
+
+        ProxyId const id = free.back();
+        free.pop_back();
+        return id;
+    }
+}    // namespace
+
+namespace physics::broadphase {
+    SpatialHash::SpatialHash(float cell_size)
+        : m_inverse_cell_size(1.0F / cell_size) {
+        LOG_TRACE
+    }
+
+    auto SpatialHash::cells_of(const Aabb& box) const -> CellRange {
+        return {cell_coordinate(box.min.x, m_inverse_cell_size),
+                cell_coordinate(box.min.y, m_inverse_cell_size),
+                cell_coordinate(box.min.z, m_inverse_cell_size),
+                cell_coordinate(box.max.x, m_inverse_cell_size),
+                cell_coordinate(box.max.y, m_inverse_cell_size),
+                cell_coordinate(box.max.z, m_inverse_cell_size)};
+    }
+
+    void SpatialHash::queue_cells(ProxyId proxy) {
+        CellRange const& range = m_ranges[proxy];
+        uint32_t const stamp = m_stamps[proxy] << STAMP_SHIFT;
+
+        for (int32_t x = range.min_x; x <= range.max_x; ++x) {
+            for (int32_t y = range.min_y; y <= range.max_y; ++y) {
+                for (int32_t z = range.min_z; z <= range.max_z; ++z) {
+                    uint32_t const lowest = (x == range.min_x ? 1U : 0U) | (y == range.min_y ? 2U : 0U)
+                        | (z == range.min_z ? 4U : 0U);
+                    m_queued.push_back({cell_key(x, y, z), proxy, stamp | lowest});
+                }
+            }
+        }
+    }
+
+    void SpatialHash::merge() {
+        if (m_queued.empty() && !m_stale) {
+            return;
+        }
+
+        // Entries of moved or destroyed proxies carry an outdated stamp and are dropped here.
+        auto current = [this](const Entry& entry)
+        { return (entry.tag >> STAMP_SHIFT) == m_stamps[entry.proxy]; };
+        auto before = [](const Entry& a, const Entry& b)
+        { return a.cell < b.cell || (a.cell == b.cell && a.proxy < b.proxy); };
+
+        std::sort(m_queued.begin(), m_queued.end(), before);
+
+        m_merged.clear();
+        m_merged.reserve(m_entries.size() + m_queued.size());
+
+        size_t i = 0;
+        size_t j = 0;
+        while (i < m_entries.size() || j < m_queued.size()) {
+            bool const take_queued =
+                i == m_entries.size() || (j < m_queued.size() && before(m_queued[j], m_entries[i]));
+            const Entry& entry = take_queued ? m_queued[j++] : m_entries[i++];
+
+            if (current(entry)) {
+                m_merged.push_back(entry);
+            }
+        }
+
+        m_entries.swap(m_merged);
+        m_queued.clear();
+        m_stale = false;
+    }
+
+    auto SpatialHash::create_proxy(const Aabb& box) -> ProxyId {
+        ProxyId const proxy = allocate_id(m_free, m_boxes.size());
+
+        if (proxy == m_boxes.size()) {
+            m_boxes.push_back(box);
+            m_ranges.push_back(cells_of(box));
+            m_stamps.push_back(0);
+        } else {
+            m_boxes[proxy] = box;
+            m_ranges[proxy] = cells_of(box);
+            m_stamps[proxy] = next_stamp(m_stamps[proxy]);
+        }
+
+        queue_cells(proxy);
+        return proxy;
+    }
+
+    void SpatialHash::move_proxy(ProxyId proxy, const Aabb& box) {
+        m_boxes[proxy] = box;
+
+        CellRange const range = cells_of(box);
+        CellRange& current = m_ranges[proxy];
+        if (range.min_x == current.min_x && range.min_y == current.min_y && range.min_z == current.min_z
+            && range.max_x == current.max_x && range.max_y == current.max_y && range.max_z == current.max_z)
+        {
+            return;
+        }
+
+        m_stamps[proxy] = next_stamp(m_stamps[proxy]);
+        current = range;
+        queue_cells(proxy);
+    }
+
+    void SpatialHash::destroy_proxy(ProxyId proxy) {
+        m_stale = true;
+        m_stamps[proxy] = next_stamp(m_stamps[proxy]);
+        m_free.push_back(proxy);
+    }
+
+    void SpatialHash::find_pairs(std::vector<Pair>& pairs) {
+        pairs.clear();
+        merge();
+
+        size_t const count = m_entries.size();
+        size_t begin = 0;
+        while (begin < count) {
+            size_t end = begin + 1;
+            while (end < count && m_entries[end].cell == m_entries[begin].cell) {
+                ++end;
+            }
+
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t j = i + 1; j < end; ++j) {
+                    Entry const& a = m_entries[i];
+                    Entry const& b = m_entries[j];
+
+                    // Report the pair only from the first cell both boxes touch: on every axis the shared
+                    // cell must start the range of one of them. Checked before the boxes are loaded, since
+                    // it rejects most duplicates.
+                    if (((a.tag | b.tag) & ALL_AXES) == ALL_AXES
+                        && mathematics::geometry::overlaps(m_boxes[a.proxy], m_boxes[b.proxy]))
+                    {
+                        pairs.push_back(make_pair(a.proxy, b.proxy));
+                    }
+                }
+            }
+
+            begin = end;
+        }
+    }
+
+    SweepAndPrune::SweepAndPrune(Axis axis)
+        : m_axis(static_cast<int>(axis)) {
+        LOG_TRACE
+    }
+
+    auto SweepAndPrune::create_proxy(const Aabb& box) -> ProxyId {
+        ProxyId const proxy = allocate_id(m_free, m_boxes.size());
+
+        if (proxy == m_boxes.size()) {
+            m_boxes.push_back(box);
+            m_alive.push_back(true);
+        } else {
+            m_boxes[proxy] = box;
+            m_alive[proxy] = true;
+        }
+
+        m_order.push_back(proxy);
+        ++m_inserted;
+        return proxy;
+    }
+
+    void SweepAndPrune::move_proxy(ProxyId proxy, const Aabb& box) {
+        m_boxes[proxy] = box;
+    }
+
+    void SweepAndPrune::destroy_proxy(ProxyId proxy) {
+        m_alive[proxy] = false;
+        m_pending_free.push_back(proxy);
+    }
+
+    void SweepAndPrune::sort() {
+        if (!m_pending_free.empty()) {
+            m_order.erase(std::remove_if(m_order.begin(),
+                                         m_order.end(),
+                                         [this](ProxyId proxy) { return !m_alive[proxy]; }),
+                          m_order.end());
+            m_free.insert(m_free.end(), m_pending_free.begin(), m_pending_free.end());
+            m_pending_free.clear();
+        }
+
+        int const axis = m_axis;
+        auto lower = [this, axis](ProxyId proxy) { return m_boxes[proxy].min[axis]; };
+
+        if (m_inserted * FULL_SORT_DIVISOR > m_order.size()) {
+            std::sort(m_order.begin(),
+                      m_order.end(),
+                      [&lower](ProxyId a, ProxyId b) { return lower(a) < lower(b); });
+        } else {
+            // Nearly sorted from the previous frame: insertion sort moves each proxy a few slots.
+            for (size_t i = 1; i < m_order.size(); ++i) {
+                ProxyId const proxy = m_order[i];
+                float const key = lower(proxy);
+
+                size_t j = i;
+                while (j > 0 && lower(m_order[j - 1]) > key) {
+                    m_order[j] = m_order[j - 1];
+                    --j;
+                }
+                m_order[j] = proxy;
+            }
+        }
+
+        m_inserted = 0;
+    }
+
+    void SweepAndPrune::find_pairs(std::vector<Pair>& pairs) {
+        pairs.clear();
+        sort();
+
+        size_t const count = m_order.size();
+        int const axes[3] = {m_axis, (m_axis + 1) % 3, (m_axis + 2) % 3};
+
+        // Sentinels past the end stop every sweep without a bounds check.
+        for (int k = 0; k < 3; ++k) {
+            m_lower[k].resize(count + WIDTH);
+            m_upper[k].resize(count + WIDTH);
+
+            for (size_t i = 0; i < count; ++i) {
+                Aabb const& box = m_boxes[m_order[i]];
+                m_lower[k][i] = box.min[axes[k]];
+                m_upper[k][i] = box.max[axes[k]];
+            }
+            std::fill(m_lower[k].begin() + static_cast<std::ptrdiff_t>(count),
+                      m_lower[k].end(),
+                      std::numeric_limits<float>::infinity());
+            std::fill(m_upper[k].begin() + static_cast<std::ptrdiff_t>(count),
+                      m_upper[k].end(),
+                      -std::numeric_limits<float>::infinity());
+        }
+
+        const float* lower0 = m_lower[0].data();
+        const float* lower1 = m_lower[1].data();
+        const float* lower2 = m_lower[2].data();
+        const float* upper1 = m_upper[1].data();
+        const float* upper2 = m_upper[2].data();
+
+        for (size_t i = 0; i < count; ++i) {
+            auto const end0 = simd::set1(m_upper[0][i]);
+            auto const start1 = simd::set1(lower1[i]);
+            auto const end1 = simd::set1(upper1[i]);
+            auto const start2 = simd::set1(lower2[i]);
+            auto const end2 = simd::set1(upper2[i]);
+
+            for (size_t j = i + 1;; j += WIDTH) {
+                auto const along = simd::load(lower0 + j) <= end0;
+                int const active = simd::movemask(along);
+                if (active == 0) {
+                    break;
+                }
+
+                auto const hit = along & (simd::load(lower1 + j) <= end1) & (simd::load(upper1 + j) >= start1)
+                    & (simd::load(lower2 + j) <= end2) & (simd::load(upper2 + j) >= start2);
+
+                int const bits = simd::movemask(hit);
+                for (size_t lane = 0; lane < WIDTH; ++lane) {
+                    if ((bits & (1 << lane)) != 0) {
+                        pairs.push_back(make_pair(m_order[i], m_order[j + lane]));
+                    }
+                }
+
+                if (active != ALL_LANES) {
+                    break;
+                }
+            }
+        }
+    }
+}    // namespace physics::broadphase
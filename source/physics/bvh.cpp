@@ -0,0 +1,949 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/physics/bvh.hpp"
+
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using mathematics::geometry::Plane;
+    using physics::bvh::Node;
+
+    constexpr size_t WIDTH = 4;
+    constexpr uint32_t LEAF_SIZE = 4;
+    constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+    constexpr int BIN_COUNT = 16;
+
+    // Slightly under BIN_COUNT so the largest centroid still lands in the last bin.
+    constexpr float BIN_SCALE = static_cast<float>(BIN_COUNT) * 0.9999F;
+
+    // Past this depth splits are forced to the median so the traversal stack never overflows.
+    constexpr int MEDIAN_DEPTH = 48;
+    constexpr size_t STACK_SIZE = 256;
+
+    // Ranges at least this large are binned / built on worker threads.
+    constexpr uint32_t PARALLEL_BINNING = 1U << 16U;
+    constexpr uint32_t PARALLEL_SUBTREE = 1U << 12U;
+
+    constexpr size_t PACKET_SIZE = 8;
+
+    constexpr float INFINITE = std::numeric_limits<float>::infinity();
+    constexpr float FAR = std::numeric_limits<float>::max();
+
+    auto empty_box() -> Aabb {
+        return {{INFINITE, INFINITE, INFINITE}, {-INFINITE, -INFINITE, -INFINITE}};
+    }
+
+    void grow(Aabb& box, const Aabb& other) {
+        box = mathematics::geometry::merge(box, other);
+    }
+
+    void grow(Aabb& box, Vec3 point) {
+        box.min = mathematics::min(box.min, point);
+        box.max = mathematics::max(box.max, point);
+    }
+
+    // Half the surface area of a box of the given size; the factor cancels out in the heuristic.
+    auto half_area(simd::float4 size) -> float {
+        float extent[4];
+        simd::store(extent, size);
+        return (extent[0] * extent[1]) + (extent[1] * extent[2]) + (extent[2] * extent[0]);
+    }
+
+    void set_slot(Node& node, size_t slot, const Aabb& box, uint32_t index, uint32_t count) {
+        node.min_x[slot] = box.min.x;
+        node.min_y[slot] = box.min.y;
+        node.min_z[slot] = box.min.z;
+        node.max_x[slot] = box.max.x;
+        node.max_y[slot] = box.max.y;
+        node.max_z[slot] = box.max.z;
+        node.index[slot] = index;
+        node.count[slot] = count;
+    }
+
+    // Unused slots get a degenerate box at +infinity that no query reaches.
+    void clear_slot(Node& node, size_t slot) {
+        Aabb const far_away {{INFINITE, INFINITE, INFINITE}, {INFINITE, INFINITE, INFINITE}};
+        set_slot(node, slot, far_away, EMPTY_SLOT, 0);
+    }
+
+    auto slot_box(const Node& node, size_t slot) -> Aabb {
+        return {{node.min_x[slot], node.min_y[slot], node.min_z[slot]},
+                {node.max_x[slot], node.max_y[slot], node.max_z[slot]}};
+    }
+
+    auto is_leaf(const Node& node, size_t slot) -> bool {
+        return node.count[slot] != 0;
+    }
+
+    auto is_inner(const Node& node, size_t slot) -> bool {
+        return node.count[slot] == 0 && node.index[slot] != EMPTY_SLOT;
+    }
+
+    // Whether a box is not entirely behind any of the selected planes.
+    auto in_front(const Aabb& box, const Plane* planes, size_t plane_count, uint32_t selected) -> bool {
+        for (size_t p = 0; p < plane_count; ++p) {
+            if ((selected & (1U << p)) == 0) {
+                continue;
+            }
+            const Plane& plane = planes[p];
+            Vec3 const corner {plane.normal.x >= 0.0F ? box.max.x : box.min.x,
+                               plane.normal.y >= 0.0F ? box.max.y : box.min.y,
+                               plane.normal.z >= 0.0F ? box.max.z : box.min.z};
+            if (mathematics::geometry::signed_distance(plane, corner) < 0.0F) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    struct Range {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        Aabb bounds = empty_box();
+        Aabb centroid_bounds = empty_box();
+
+        auto size() const -> uint32_t { return end - begin; }
+    };
+
+    // Primitives are moved around during the build together with their box, so binning and
+    // partitioning stream through memory instead of gathering boxes by index. The fourth
+    // component pads the bounds to SIMD width.
+    struct Reference {
+        float lower[4];
+        float upper[4];
+        uint32_t primitive;
+    };
+
+    auto centroid_of(const Reference& reference) -> Vec3 {
+        return {(reference.lower[0] + reference.upper[0]) * 0.5F,
+                (reference.lower[1] + reference.upper[1]) * 0.5F,
+                (reference.lower[2] + reference.upper[2]) * 0.5F};
+    }
+
+    auto box_of(const Reference& reference) -> Aabb {
+        return {{reference.lower[0], reference.lower[1], reference.lower[2]},
+                {reference.upper[0], reference.upper[1], reference.upper[2]}};
+    }
+
+    auto to_box(simd::float4 lower, simd::float4 upper) -> Aabb {
+        float low[4];
+        float high[4];
+        simd::store(low, lower);
+        simd::store(high, upper);
+        return {{low[0], low[1], low[2]}, {high[0], high[1], high[2]}};
+    }
+
+    struct Bin {
+        uint32_t count = 0;
+        simd::float4 lower = simd::set1(INFINITE);
+        simd::float4 upper = simd::set1(-INFINITE);
+        simd::float4 centroid_lower = simd::set1(INFINITE);
+        simd::float4 centroid_upper = simd::set1(-INFINITE);
+    };
+
+    struct Bins {
+        Bin axis[3][BIN_COUNT];
+    };
+
+    // Maps centroids to bins on all three axes at once.
+    struct Binning {
+        simd::float4 origin;
+        simd::float4 scale;
+
+        void index(simd::float4 centroid, int32_t indices[4]) const {
+            auto const position = (centroid - origin) * scale;
+            auto const last = simd::set1(static_cast<float>(BIN_COUNT - 1));
+            simd::storei(indices, simd::to_int(simd::clamp(position, simd::zero4(), last)));
+        }
+    };
+
+    auto centroid_lanes(const Reference& reference) -> simd::float4 {
+        return (simd::load(reference.lower) + simd::load(reference.upper)) * simd::set1(0.5F);
+    }
+
+    class Builder {
+      public:
+        Builder(const Aabb* boxes, size_t count, bool parallel)
+            : m_boxes(boxes)
+            , m_parallel(parallel)
+            , m_references(count) {}
+
+        // Primitive indices in leaf order.
+        void order(std::vector<uint32_t>& primitives) const {
+            primitives.resize(m_references.size());
+            for (size_t i = 0; i < m_references.size(); ++i) {
+                primitives[i] = m_references[i].primitive;
+            }
+        }
+
+        // Build the whole tree into `nodes`; order() then holds the primitives in leaf order.
+        void build(std::vector<Node>& nodes) {
+            Range root;
+            root.end = static_cast<uint32_t>(m_references.size());
+
+            for (uint32_t i = 0; i < root.end; ++i) {
+                const Aabb& box = m_boxes[i];
+                m_references[i] = {{box.min.x, box.min.y, box.min.z, 0.0F},
+                                   {box.max.x, box.max.y, box.max.z, 0.0F},
+                                   i};
+                grow(root.bounds, box);
+                grow(root.centroid_bounds, centroid_of(m_references[i]));
+            }
+
+            // Every node but the root has at least two children, so there are fewer nodes than primitives.
+            nodes.resize(std::max<size_t>(m_references.size(), 1));
+            m_nodes = nodes.data();
+            m_next_node = 1;
+
+            build_node(0, root, 0);
+
+            nodes.resize(m_next_node.load());
+        }
+
+      private:
+        void build_node(uint32_t node_index, const Range& range, int depth) {
+            Range children[WIDTH];
+            size_t child_count = 1;
+            children[0] = range;
+
+            // Split the largest child until there are four or all of them are leaves.
+            while (child_count < WIDTH) {
+                size_t largest = WIDTH;
+                for (size_t i = 0; i < child_count; ++i) {
+                    if (children[i].size() > LEAF_SIZE
+                        && (largest == WIDTH || children[i].size() > children[largest].size()))
+                    {
+                        largest = i;
+                    }
+                }
+
+                if (largest == WIDTH) {
+                    break;
+                }
+
+                Range left;
+                Range right;
+                split(children[largest], depth, left, right);
+                children[largest] = left;
+                children[child_count++] = right;
+            }
+
+            Node& node = m_nodes[node_index];
+            uint32_t inner[WIDTH];
+            size_t inner_count = 0;
+
+            for (size_t slot = 0; slot < WIDTH; ++slot) {
+                if (slot >= child_count) {
+                    clear_slot(node, slot);
+                } else if (children[slot].size() <= LEAF_SIZE) {
+                    set_slot(node, slot, children[slot].bounds, children[slot].begin, children[slot].size());
+                } else {
+                    uint32_t const child = m_next_node.fetch_add(1);
+                    set_slot(node, slot, children[slot].bounds, child, 0);
+                    inner[inner_count++] = static_cast<uint32_t>(slot);
+                }
+            }
+
+            auto recurse = [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i) {
+                    size_t const slot = inner[i];
+                    build_node(node.index[slot], children[slot], depth + 1);
+                }
+            };
+
+            bool const large = inner_count > 1 && range.size() >= PARALLEL_SUBTREE;
+            if (m_parallel && large) {
+                utils::parallel::parallel_for(inner_count, 1, recurse);
+            } else {
+                recurse(0, inner_count);
+            }
+        }
+
+        void bin(const Binning& binning, Bins& bins, uint32_t begin, uint32_t end) const {
+            for (uint32_t i = begin; i < end; ++i) {
+                auto const lower = simd::load(m_references[i].lower);
+                auto const upper = simd::load(m_references[i].upper);
+                auto const centroid = (lower + upper) * simd::set1(0.5F);
+
+                int32_t index[4];
+                binning.index(centroid, index);
+
+                for (int axis = 0; axis < 3; ++axis) {
+                    Bin& target = bins.axis[axis][index[axis]];
+                    target.count++;
+                    target.lower = simd::min(target.lower, lower);
+                    target.upper = simd::max(target.upper, upper);
+                    target.centroid_lower = simd::min(target.centroid_lower, centroid);
+                    target.centroid_upper = simd::max(target.centroid_upper, centroid);
+                }
+            }
+        }
+
+        static void merge_bin(Bin& target, const Bin& source) {
+            target.count += source.count;
+            target.lower = simd::min(target.lower, source.lower);
+            target.upper = simd::max(target.upper, source.upper);
+            target.centroid_lower = simd::min(target.centroid_lower, source.centroid_lower);
+            target.centroid_upper = simd::max(target.centroid_upper, source.centroid_upper);
+        }
+
+        // Binned SAH split; falls back to the median when the heuristic cannot separate the range.
+        void split(const Range& range, int depth, Range& left, Range& right) {
+            Vec3 const extent = mathematics::geometry::extent(range.centroid_bounds);
+            Vec3 scale;
+            for (int axis = 0; axis < 3; ++axis) {
+                scale[axis] = extent[axis] > 0.0F ? BIN_SCALE / extent[axis] : 0.0F;
+            }
+
+            bool const degenerate = extent.x <= 0.0F && extent.y <= 0.0F && extent.z <= 0.0F;
+            if (degenerate || depth >= MEDIAN_DEPTH) {
+                median_split(range, left, right);
+                return;
+            }
+
+            Vec3 const& origin = range.centroid_bounds.min;
+            Binning const binning {simd::set(origin.x, origin.y, origin.z, 0.0F),
+                                   simd::set(scale.x, scale.y, scale.z, 0.0F)};
+
+            Bins bins;
+            if (m_parallel && range.size() >= PARALLEL_BINNING) {
+                std::mutex merge_lock;
+                utils::parallel::parallel_for(range.size(),
+                                              PARALLEL_BINNING / 4,
+                                              [&](size_t begin, size_t end)
+                                              {
+                                                  Bins local;
+                                                  bin(binning,
+                                                      local,
+                                                      range.begin + static_cast<uint32_t>(begin),
+                                                      range.begin + static_cast<uint32_t>(end));
+
+                                                  std::lock_guard<std::mutex> const guard(merge_lock);
+                                                  for (int axis = 0; axis < 3; ++axis) {
+                                                      for (int i = 0; i < BIN_COUNT; ++i) {
+                                                          merge_bin(bins.axis[axis][i], local.axis[axis][i]);
+                                                      }
+                                                  }
+                                              });
+            } else {
+                bin(binning, bins, range.begin, range.end);
+            }
+
+            float best_cost = INFINITE;
+            int best_axis = -1;
+            int best_split = 0;
+
+            for (int axis = 0; axis < 3; ++axis) {
+                if (extent[axis] <= 0.0F) {
+                    continue;
+                }
+
+                // Right-to-left sweep stores the cost of every right side, left-to-right adds the left.
+                float right_cost[BIN_COUNT];
+                auto lower = simd::set1(INFINITE);
+                auto upper = simd::set1(-INFINITE);
+                uint32_t count = 0;
+                for (int i = BIN_COUNT - 1; i > 0; --i) {
+                    const Bin& source = bins.axis[axis][i];
+                    lower = simd::min(lower, source.lower);
+                    upper = simd::max(upper, source.upper);
+                    count += source.count;
+                    right_cost[i] = count == 0 ? 0.0F : half_area(upper - lower) * static_cast<float>(count);
+                }
+
+                lower = simd::set1(INFINITE);
+                upper = simd::set1(-INFINITE);
+                count = 0;
+                for (int i = 0; i < BIN_COUNT - 1; ++i) {
+                    const Bin& source = bins.axis[axis][i];
+                    lower = simd::min(lower, source.lower);
+                    upper = simd::max(upper, source.upper);
+                    count += source.count;
+                    if (count == 0 || count == range.size()) {
+                        continue;
+                    }
+
+                    float const left_cost = half_area(upper - lower) * static_cast<float>(count);
+                    float const cost = left_cost + right_cost[i + 1];
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_split = i + 1;
+                    }
+                }
+            }
+
+            if (best_axis < 0) {
+                median_split(range, left, right);
+                return;
+            }
+
+            auto const middle = std::partition(m_references.begin() + range.begin,
+                                               m_references.begin() + range.end,
+                                               [&](const Reference& reference)
+                                               {
+                                                   int32_t index[4];
+                                                   binning.index(centroid_lanes(reference), index);
+                                                   return index[best_axis] < best_split;
+                                               });
+
+            Bin sides[2];
+            for (int i = 0; i < BIN_COUNT; ++i) {
+                merge_bin(sides[i < best_split ? 0 : 1], bins.axis[best_axis][i]);
+            }
+
+            auto const split_index = static_cast<uint32_t>(middle - m_references.begin());
+            left = {range.begin,
+                    split_index,
+                    to_box(sides[0].lower, sides[0].upper),
+                    to_box(sides[0].centroid_lower, sides[0].centroid_upper)};
+            right = {split_index,
+                     range.end,
+                     to_box(sides[1].lower, sides[1].upper),
+                     to_box(sides[1].centroid_lower, sides[1].centroid_upper)};
+        }
+
+        // Object median along the widest centroid axis.
+        void median_split(const Range& range, Range& left, Range& right) {
+            Vec3 const extent = mathematics::geometry::extent(range.centroid_bounds);
+            int axis = 0;
+            if (extent.y > extent[axis]) {
+                axis = 1;
+            }
+            if (extent.z > extent[axis]) {
+                axis = 2;
+            }
+
+            uint32_t const middle = range.begin + (range.size() / 2);
+            std::nth_element(m_references.begin() + range.begin,
+                             m_references.begin() + middle,
+                             m_references.begin() + range.end,
+                             [axis](const Reference& a, const Reference& b)
+                             { return centroid_of(a)[axis] < centroid_of(b)[axis]; });
+
+            left = {range.begin, middle, empty_box(), empty_box()};
+            right = {middle, range.end, empty_box(), empty_box()};
+            for (Range* side : {&left, &right}) {
+                for (uint32_t i = side->begin; i < side->end; ++i) {
+                    grow(side->bounds, box_of(m_references[i]));
+                    grow(side->centroid_bounds, centroid_of(m_references[i]));
+                }
+            }
+        }
+
+        const Aabb* m_boxes;
+        bool m_parallel;
+        std::vector<Reference> m_references;
+        Node* m_nodes = nullptr;
+        std::atomic<uint32_t> m_next_node {0};
+    };
+
+    // Ray data splatted across lanes for the four-child slab test.
+    struct RayLanes {
+        simd::float4 origin_x;
+        simd::float4 origin_y;
+        simd::float4 origin_z;
+        simd::float4 inverse_x;
+        simd::float4 inverse_y;
+        simd::float4 inverse_z;
+
+        RayLanes() = default;
+
+        explicit RayLanes(const mathematics::geometry::Ray& ray)
+            : origin_x(simd::set1(ray.origin.x))
+            , origin_y(simd::set1(ray.origin.y))
+            , origin_z(simd::set1(ray.origin.z))
+            , inverse_x(simd::set1(1.0F / ray.direction.x))
+            , inverse_y(simd::set1(1.0F / ray.direction.y))
+            , inverse_z(simd::set1(1.0F / ray.direction.z)) {}
+    };
+
+    // Entry distances of the four children; lanes that miss or start beyond `limit` are masked out.
+    auto slab_test(const Node& node, const RayLanes& ray, float limit, simd::float4& entry) -> int {
+        auto const x0 = (simd::load(node.min_x) - ray.origin_x) * ray.inverse_x;
+        auto const x1 = (simd::load(node.max_x) - ray.origin_x) * ray.inverse_x;
+        auto const y0 = (simd::load(node.min_y) - ray.origin_y) * ray.inverse_y;
+        auto const y1 = (simd::load(node.max_y) - ray.origin_y) * ray.inverse_y;
+        auto const z0 = (simd::load(node.min_z) - ray.origin_z) * ray.inverse_z;
+        auto const z1 = (simd::load(node.max_z) - ray.origin_z) * ray.inverse_z;
+
+        auto const near = simd::max(simd::max(simd::min(x0, x1), simd::min(y0, y1)),
+                                    simd::max(simd::min(z0, z1), simd::zero4()));
+        auto const far = simd::min(simd::min(simd::max(x0, x1), simd::max(y0, y1)),
+                                   simd::min(simd::max(z0, z1), simd::set1(limit)));
+
+        entry = near;
+        return simd::movemask(near <= far);
+    }
+
+    auto limit_of(const mathematics::geometry::Ray& ray) -> float {
+        return std::min(ray.max_distance, FAR);
+    }
+
+    // Exact primitive test when given, otherwise the primitive box.
+    auto hit_distance(const physics::bvh::RayTest& test,
+                      uint32_t primitive,
+                      const Aabb& box,
+                      const mathematics::geometry::Ray& ray) -> float {
+        return test ? test(primitive, ray) : mathematics::geometry::intersect(ray, box);
+    }
+
+    // Per-lane distance from a coordinate to the [lower, upper] interval, 0 inside.
+    auto outside(const float* lower, const float* upper, simd::float4 coordinate) -> simd::float4 {
+        auto const below = simd::load(lower) - coordinate;
+        auto const above = coordinate - simd::load(upper);
+        return simd::max(simd::max(below, above), simd::zero4());
+    }
+
+    // Keeps `slots` sorted by descending distance, so pushing them in order puts the nearest child
+    // on top of the stack.
+    void insert_far_to_near(uint32_t* slots, size_t& count, const float* distance, size_t slot) {
+        size_t position = count++;
+        while (position > 0 && distance[slots[position - 1]] < distance[slot]) {
+            slots[position] = slots[position - 1];
+            --position;
+        }
+        slots[position] = static_cast<uint32_t>(slot);
+    }
+}    // namespace
+
+namespace physics::bvh {
+    void Bvh::build(const Aabb* boxes, size_t count, kinematics::Execution execution) {
+        LOG_TRACE
+
+        m_nodes.clear();
+        m_primitives.clear();
+        m_boxes.clear();
+        m_bounds = empty_box();
+
+        if (count == 0) {
+            return;
+        }
+
+        Builder builder(boxes, count, execution == kinematics::Execution::Parallel);
+        builder.build(m_nodes);
+
+        builder.order(m_primitives);
+        m_boxes.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_boxes[i] = boxes[m_primitives[i]];
+            grow(m_bounds, m_boxes[i]);
+        }
+    }
+
+    void Bvh::refit(const Aabb* boxes) {
+        for (size_t i = 0; i < m_primitives.size(); ++i) {
+            m_boxes[i] = boxes[m_primitives[i]];
+        }
+
+        // Children always come after their parent, so one backwards pass sees every child first.
+        for (size_t n = m_nodes.size(); n-- > 0;) {
+            Node& node = m_nodes[n];
+
+            for (size_t slot = 0; slot < WIDTH; ++slot) {
+                Aabb box = empty_box();
+
+                if (is_leaf(node, slot)) {
+                    for (uint32_t i = node.index[slot]; i < node.index[slot] + node.count[slot]; ++i) {
+                        grow(box, m_boxes[i]);
+                    }
+                } else if (is_inner(node, slot)) {
+                    const Node& child = m_nodes[node.index[slot]];
+                    for (size_t child_slot = 0; child_slot < WIDTH; ++child_slot) {
+                        if (child.index[child_slot] != EMPTY_SLOT) {
+                            grow(box, slot_box(child, child_slot));
+                        }
+                    }
+                } else {
+                    continue;
+                }
+
+                set_slot(node, slot, box, node.index[slot], node.count[slot]);
+            }
+        }
+
+        m_bounds = empty_box();
+        for (const Aabb& box : m_boxes) {
+            grow(m_bounds, box);
+        }
+    }
+
+    auto Bvh::raycast(const Ray& ray, const RayTest& test) const -> RayHit {
+        RayHit hit;
+        if (m_nodes.empty()) {
+            return hit;
+        }
+
+        RayLanes const lanes(ray);
+        Ray shortened = ray;
+        shortened.max_distance = limit_of(ray);
+
+        uint32_t stack[STACK_SIZE];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+
+            simd::float4 entry_lanes;
+            int const mask = slab_test(node, lanes, shortened.max_distance, entry_lanes);
+            if (mask == 0) {
+                continue;
+            }
+
+            float entry[WIDTH];
+            simd::store(entry, entry_lanes);
+
+            // Inner children go on the stack far to near, so the nearest is visited next.
+            uint32_t slots[WIDTH];
+            size_t inner_count = 0;
+
+            for (size_t slot = 0; slot < WIDTH; ++slot) {
+                if ((mask & (1 << slot)) == 0) {
+                    continue;
+                }
+
+                if (is_leaf(node, slot)) {
+                    for (uint32_t i = node.index[slot]; i < node.index[slot] + node.count[slot]; ++i) {
+                        float const distance = hit_distance(test, m_primitives[i], m_boxes[i], shortened);
+                        if (distance < shortened.max_distance) {
+                            shortened.max_distance = distance;
+                            hit = {m_primitives[i], distance};
+                        }
+                    }
+                } else {
+                    insert_far_to_near(slots, inner_count, entry, slot);
+                }
+            }
+
+            for (size_t i = 0; i < inner_count; ++i) {
+                if (entry[slots[i]] <= shortened.max_distance) {
+                    stack[top++] = node.index[slots[i]];
+                }
+            }
+        }
+
+        return hit;
+    }
+
+    void Bvh::raycast(const Ray* rays, RayHit* hits, size_t count, const RayTest& test) const {
+        for (size_t packet = 0; packet < count; packet += PACKET_SIZE) {
+            size_t const size = std::min(PACKET_SIZE, count - packet);
+
+            RayLanes lanes[PACKET_SIZE];
+            Ray shortened[PACKET_SIZE];
+
+            for (size_t r = 0; r < size; ++r) {
+                lanes[r] = RayLanes(rays[packet + r]);
+                shortened[r] = rays[packet + r];
+                shortened[r].max_distance = limit_of(rays[packet + r]);
+                hits[packet + r] = {};
+            }
+
+            if (m_nodes.empty()) {
+                continue;
+            }
+
+            uint32_t stack[STACK_SIZE];
+            size_t top = 0;
+            stack[top++] = 0;
+
+            while (top > 0) {
+                const Node& node = m_nodes[stack[--top]];
+
+                // Which rays hit which child; a child is visited if any ray of the packet hits it, and
+                // children are ordered by the nearest entry of any ray.
+                int masks[PACKET_SIZE];
+                int any = 0;
+                float nearest[WIDTH] = {INFINITE, INFINITE, INFINITE, INFINITE};
+                for (size_t r = 0; r < size; ++r) {
+                    simd::float4 entry_lanes;
+                    masks[r] = slab_test(node, lanes[r], shortened[r].max_distance, entry_lanes);
+                    if (masks[r] == 0) {
+                        continue;
+                    }
+
+                    float entry[WIDTH];
+                    simd::store(entry, entry_lanes);
+                    for (size_t slot = 0; slot < WIDTH; ++slot) {
+                        if ((masks[r] & (1 << slot)) != 0) {
+                            nearest[slot] = std::min(nearest[slot], entry[slot]);
+                        }
+                    }
+                    any |= masks[r];
+                }
+
+                uint32_t slots[WIDTH];
+                size_t inner_count = 0;
+
+                for (size_t slot = 0; slot < WIDTH; ++slot) {
+                    if ((any & (1 << slot)) == 0) {
+                        continue;
+                    }
+
+                    if (!is_leaf(node, slot)) {
+                        insert_far_to_near(slots, inner_count, nearest, slot);
+                        continue;
+                    }
+
+                    for (size_t r = 0; r < size; ++r) {
+                        if ((masks[r] & (1 << slot)) == 0) {
+                            continue;
+                        }
+
+                        Ray& current = shortened[r];
+                        for (uint32_t i = node.index[slot]; i < node.index[slot] + node.count[slot]; ++i) {
+                            float const distance = hit_distance(test, m_primitives[i], m_boxes[i], current);
+                            if (distance < current.max_distance) {
+                                current.max_distance = distance;
+                                hits[packet + r] = {m_primitives[i], distance};
+                            }
+                        }
+                    }
+                }
+
+                for (size_t i = 0; i < inner_count; ++i) {
+                    stack[top++] = node.index[slots[i]];
+                }
+            }
+        }
+    }
+
+    auto Bvh::occluded(const Ray& ray, const RayTest& test) const -> bool {
+        if (m_nodes.empty()) {
+            return false;
+        }
+
+        RayLanes const lanes(ray);
+        Ray limited = ray;
+        limited.max_distance = limit_of(ray);
+
+        uint32_t stack[STACK_SIZE];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+
+            simd::float4 entry;
+            int const mask = slab_test(node, lanes, limited.max_distance, entry);
+
+            for (size_t slot = 0; slot < WIDTH; ++slot) {
+                if ((mask & (1 << slot)) == 0) {
+                    continue;
+                }
+
+                if (!is_leaf(node, slot)) {
+                    stack[top++] = node.index[slot];
+                    continue;
+                }
+
+                for (uint32_t i = node.index[slot]; i < node.index[slot] + node.count[slot]; ++i) {
+                    float const distance = hit_distance(test, m_primitives[i], m_boxes[i], limited);
+                    if (distance <= limited.max_distance) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void Bvh::overlap(const Aabb& box, std::vector<uint32_t>& primitives) const {
+        if (m_nodes.empty()) {
+            return;
+        }
+
+        auto const min_x = simd::set1(box.min.x);
+        auto const min_y = simd::set1(box.min.y);
+        auto const min_z = simd::set1(box.min.z);
+        auto const max_x = simd::set1(box.max.x);
+        auto const max_y = simd::set1(box.max.y);
+        auto const max_z = simd::set1(box.max.z);
+
+        uint32_t stack[STACK_SIZE];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+
+            auto const along_x = (simd::load(node.min_x) <= max_x) & (simd::load(node.max_x) >= min_x);
+            auto const along_y = (simd::load(node.min_y) <= max_y) & (simd::load(node.max_y) >= min_y);
+            auto const along_z = (simd::load(node.min_z) <= max_z) & (simd::load(node.max_z) >= min_z);
+            int const mask = simd::movemask(along_x & along_y & along_z);
+
+            for (size_t slot = 0; slot < WIDTH; ++slot) {
+                if ((mask & (1 << slot)) == 0) {
+                    continue;
+                }
+
+                if (!is_leaf(node, slot)) {
+                    stack[top++] = node.index[slot];
+                    continue;
+                }
+
+                for (uint32_t i = node.index[slot]; i < node.index[slot] + node.count[slot]; ++i) {
+                    if (mathematics::geometry::overlaps(box, m_boxes[i])) {
+                        primitives.push_back(m_primitives[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    void Bvh::overlap(const Plane* planes, size_t plane_count, std::vector<uint32_t>& primitives) const {
+        if (plane_count > MAX_PLANES) {
+            throw std::invalid_argument("too many planes for a volume query");
+        }
+        if (m_nodes.empty()) {
+            return;
+        }
+
+        // An entry carries the planes its box straddles; the children of a box need no others.
+        struct Entry {
+            uint32_t node;
+            uint32_t planes;
+        };
+
+        Entry stack[STACK_SIZE];
+        size_t top = 0;
+        stack[top++] = {0, plane_count == MAX_PLANES ? UINT32_MAX : (1U << plane_count) - 1};
+
+        while (top > 0) {
+            Entry const entry = stack[--top];
+            const Node& node = m_nodes[entry.node];
+
+            simd::float4 outside = simd::zero4();
+            uint32_t straddled[WIDTH] = {};
+            for (size_t p = 0; p < plane_count; ++p) {
+                if ((entry.planes & (1U << p)) == 0) {
+                    continue;
+                }
+
+                // The corners of the boxes farthest along the normal and farthest against it.
+                const Plane& plane = planes[p];
+                bool const positive_x = plane.normal.x >= 0.0F;
+                bool const positive_y = plane.normal.y >= 0.0F;
+                bool const positive_z = plane.normal.z >= 0.0F;
+                auto const nx = simd::set1(plane.normal.x);
+                auto const ny = simd::set1(plane.normal.y);
+                auto const nz = simd::set1(plane.normal.z);
+                auto const d = simd::set1(plane.distance);
+                auto const front = (nx * simd::load(positive_x ? node.max_x : node.min_x))
+                                   + (ny * simd::load(positive_y ? node.max_y : node.min_y))
+                                   + (nz * simd::load(positive_z ? node.max_z : node.min_z)) + d;
+                auto const back = (nx * simd::load(positive_x ? node.min_x : node.max_x))
+                                  + (ny * simd::load(positive_y ? node.min_y : node.max_y))
+                                  + (nz * simd::load(positive_z ? node.min_z : node.max_z)) + d;
+                outside = outside | (front < simd::zero4());
+
+                int const crossing = simd::movemask(back < simd::zero4());
+                for (size_t slot = 0; slot < WIDTH; ++slot) {
+                    if ((crossing & (1 << slot)) != 0) {
+                        straddled[slot] |= 1U << p;
+                    }
+                }
+            }
+
+            int const rejected = simd::movemask(outside);
+            for (size_t slot = 0; slot < WIDTH; ++slot) {
+                if ((rejected & (1 << slot)) != 0) {
+                    continue;
+                }
+
+                if (is_inner(node, slot)) {
+                    stack[top++] = {node.index[slot], straddled[slot]};
+                } else if (is_leaf(node, slot)) {
+                    for (uint32_t i = node.index[slot]; i < node.index[slot] + node.count[slot]; ++i) {
+                        if (in_front(m_boxes[i], planes, plane_count, straddled[slot])) {
+                            primitives.push_back(m_primitives[i]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    auto Bvh::closest_point(Vec3 point,
+                            const ClosestPointTest& test,
+                            float max_distance) const -> ClosestHit {
+        ClosestHit hit;
+        if (m_nodes.empty()) {
+            return hit;
+        }
+
+        auto const px = simd::set1(point.x);
+        auto const py = simd::set1(point.y);
+        auto const pz = simd::set1(point.z);
+        float best = max_distance < FAR ? max_distance * max_distance : INFINITE;
+
+        uint32_t stack[STACK_SIZE];
+        size_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+
+            // Squared distance from the point to each child box (0 inside).
+            auto const dx = outside(node.min_x, node.max_x, px);
+            auto const dy = outside(node.min_y, node.max_y, py);
+            auto const dz = outside(node.min_z, node.max_z, pz);
+            auto const distance_lanes = simd::madd(dx, dx, simd::madd(dy, dy, dz * dz));
+
+            float distance[WIDTH];
+            simd::store(distance, distance_lanes);
+
+            uint32_t slots[WIDTH];
+            size_t inner_count = 0;
+
+            for (size_t slot = 0; slot < WIDTH; ++slot) {
+                if (node.index[slot] == EMPTY_SLOT || !(distance[slot] < best)) {
+                    continue;
+                }
+
+                if (is_leaf(node, slot)) {
+                    for (uint32_t i = node.index[slot]; i < node.index[slot] + node.count[slot]; ++i) {
+                        Vec3 const candidate = test ? test(m_primitives[i], point)
+                                                    : mathematics::geometry::closest_point(m_boxes[i], point);
+                        float const squared = mathematics::length_squared(candidate - point);
+                        if (squared < best) {
+                            best = squared;
+                            hit = {m_primitives[i], candidate, 0.0F};
+                        }
+                    }
+                } else {
+                    insert_far_to_near(slots, inner_count, distance, slot);
+                }
+            }
+
+            for (size_t i = 0; i < inner_count; ++i) {
+                if (distance[slots[i]] < best) {
+                    stack[top++] = node.index[slots[i]];
+                }
+            }
+        }
+
+        if (hit.primitive != NO_PRIMITIVE) {
+            hit.distance = std::sqrt(best);
+        }
+
+        return hit;
+    }
+}    // namespace physics::bvh
@@ -0,0 +1,1011 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "domkrat3d/physics/dynamics.hpp"
+
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+    using mathematics::Mat3;
+    using mathematics::Vec3;
+    using physics::kinematics::ConstVec3Span;
+    using physics::kinematics::Vec3Span;
+    using physics::narrowphase::ContactPoint;
+    using physics::narrowphase::Shape;
+    using physics::narrowphase::ShapeType;
+
+    constexpr size_t WIDTH = static_cast<size_t>(simd::LANES);
+    static_assert(WIDTH == 4, "contact blocks gather four lanes");
+
+    // Islands per parallel chunk; islands are sorted largest first, so the big ones start early.
+    constexpr size_t ISLAND_GRAIN = 1;
+
+    // Approach speed above which restitution applies; slower contacts come to rest.
+    constexpr float RESTITUTION_THRESHOLD = 1.0F;
+
+    // Fastest separation the position bias may ask for, so deep overlaps resolve without launching bodies.
+    constexpr float MAX_BIAS_VELOCITY = 4.0F;
+
+    // Colors of the graph coloring; contact points that fit none are solved one by one after the batches.
+    constexpr uint32_t MAX_COLORS = 64;
+
+    constexpr uint32_t PADDING_LANE = UINT32_MAX;
+
+    auto box_inertia(Vec3 half_extents, float mass) -> Vec3 {
+        Vec3 const size = half_extents * 2.0F;
+        float const k = mass / 12.0F;
+        return {k * ((size.y * size.y) + (size.z * size.z)),
+                k * ((size.x * size.x) + (size.z * size.z)),
+                k * ((size.x * size.x) + (size.y * size.y))};
+    }
+
+    // Capsule as a cylinder plus two hemispheres, the mass split by volume.
+    auto capsule_inertia(float radius, float half_height, float mass) -> Vec3 {
+        float const height = 2.0F * half_height;
+        float const r2 = radius * radius;
+        float const cylinder_volume = r2 * height;
+        float const sphere_volume = (4.0F / 3.0F) * r2 * radius;
+        float const cylinder = mass * cylinder_volume / (cylinder_volume + sphere_volume);
+        float const caps = mass - cylinder;
+
+        float const axial = (cylinder * r2 * 0.5F) + (caps * r2 * 0.4F);
+        float const lateral = (cylinder * ((r2 * 0.25F) + (height * height / 12.0F)))
+            + (caps * ((r2 * 0.4F) + (height * height * 0.25F) + (height * radius * 0.375F)));
+        return {lateral, axial, lateral};
+    }
+
+    auto inverse_inertia(const Shape& shape, float mass) -> Vec3 {
+        Vec3 inertia;
+        switch (shape.type) {
+            case ShapeType::Sphere: {
+                float const sphere = 0.4F * mass * shape.radius * shape.radius;
+                inertia = {sphere, sphere, sphere};
+                break;
+            }
+            case ShapeType::Capsule:
+                inertia = capsule_inertia(shape.radius, shape.half_height, mass);
+                break;
+            case ShapeType::Box:
+                inertia = box_inertia(shape.half_extents, mass);
+                break;
+            case ShapeType::ConvexHull: {
+                auto const& bounds = shape.hull->bounds();
+                inertia = box_inertia((bounds.max - bounds.min) * 0.5F, mass);
+                break;
+            }
+        }
+
+        auto invert = [](float value) { return value > 0.0F ? 1.0F / value : 0.0F; };
+        return {invert(inertia.x), invert(inertia.y), invert(inertia.z)};
+    }
+
+    // Two unit vectors completing a unit normal to an orthonormal basis; stable for a stable normal,
+    // so the friction impulses of consecutive frames refer to the same directions.
+    void tangents(Vec3 normal, Vec3& first, Vec3& second) {
+        first = std::fabs(normal.x) >= 0.57735F ? Vec3 {normal.y, -normal.x, 0.0F}
+                                                : Vec3 {0.0F, normal.z, -normal.y};
+        first = mathematics::normalize(first);
+        second = cross(normal, first);
+    }
+
+    // Velocities of the bodies of one island per component; slot 0 stands for every static body
+    // and stays at rest, since it has neither mass nor inertia to take impulses.
+    struct Velocities {
+        std::vector<float> vx;
+        std::vector<float> vy;
+        std::vector<float> vz;
+        std::vector<float> wx;
+        std::vector<float> wy;
+        std::vector<float> wz;
+
+        void reset(size_t count) {
+            for (auto* values : {&vx, &vy, &vz, &wx, &wy, &wz}) {
+                values->assign(count, 0.0F);
+            }
+        }
+
+        auto linear(uint32_t slot) const -> Vec3 { return {vx[slot], vy[slot], vz[slot]}; }
+
+        auto angular(uint32_t slot) const -> Vec3 { return {wx[slot], wy[slot], wz[slot]}; }
+
+        void set(uint32_t slot, Vec3 linear, Vec3 angular) {
+            vx[slot] = linear.x;
+            vy[slot] = linear.y;
+            vz[slot] = linear.z;
+            wx[slot] = angular.x;
+            wy[slot] = angular.y;
+            wz[slot] = angular.z;
+        }
+
+        void add(uint32_t slot, Vec3 linear, Vec3 angular) {
+            vx[slot] += linear.x;
+            vy[slot] += linear.y;
+            vz[slot] += linear.z;
+            wx[slot] += angular.x;
+            wy[slot] += angular.y;
+            wz[slot] += angular.z;
+        }
+    };
+
+    // One contact point with its three rows: 0 along the normal, 1 and 2 along the tangents.
+    // For a row direction d the arms are r x d and the spins the inverse world inertia times the arm,
+    // so neither the lever arms nor the inertia are needed while iterating.
+    struct Row {
+        uint32_t a = 0;
+        uint32_t b = 0;
+        Vec3 direction[3];
+        Vec3 arm_a[3];
+        Vec3 arm_b[3];
+        Vec3 spin_a[3];
+        Vec3 spin_b[3];
+        float mass[3] = {};
+        float impulse[3] = {};
+        float inverse_mass_a = 0.0F;
+        float inverse_mass_b = 0.0F;
+        float bias = 0.0F;
+        float friction = 0.0F;
+        ContactPoint* point = nullptr;
+    };
+
+    // Four rows of one color, one per SIMD lane, stored [row][axis][lane]; no two lanes share a
+    // dynamic body, so the lanes can update their bodies at the same time.
+    struct Block {
+        uint32_t a[WIDTH];
+        uint32_t b[WIDTH];
+        uint32_t row[WIDTH];
+        float direction[3][3][WIDTH];
+        float arm_a[3][3][WIDTH];
+        float arm_b[3][3][WIDTH];
+        float spin_a[3][3][WIDTH];
+        float spin_b[3][3][WIDTH];
+        float mass[3][WIDTH];
+        float impulse[3][WIDTH];
+        float inverse_mass_a[WIDTH];
+        float inverse_mass_b[WIDTH];
+        float bias[WIDTH];
+        float friction[WIDTH];
+    };
+
+    // Ball joint as one 3x3 block row.
+    struct JointRow {
+        uint32_t a = 0;
+        uint32_t b = 0;
+        Vec3 arm_a;
+        Vec3 arm_b;
+        Mat3 inverse_inertia_a;
+        Mat3 inverse_inertia_b;
+        float inverse_mass_a = 0.0F;
+        float inverse_mass_b = 0.0F;
+        Mat3 mass;
+        Vec3 bias;
+        Vec3 impulse;
+        Vec3* stored = nullptr;
+    };
+
+    // Solver storage of a worker thread, reused from island to island and from step to step.
+    struct Scratch {
+        Velocities velocities;
+        std::vector<float> px;
+        std::vector<float> py;
+        std::vector<float> pz;
+        std::vector<float> ax;
+        std::vector<float> ay;
+        std::vector<float> az;
+        std::vector<float> inverse_mass;
+        std::vector<Mat3> inverse_inertia;
+        std::vector<Row> rows;
+        std::vector<JointRow> joints;
+        std::vector<Block> blocks;
+        std::vector<uint32_t> color_of;
+        std::vector<uint64_t> used_colors;
+        std::vector<uint32_t> color_start;
+        std::vector<uint32_t> sorted;
+        std::vector<uint32_t> fill;
+        std::vector<uint32_t> leftover;
+    };
+
+    auto scratch() -> Scratch& {
+        thread_local Scratch storage;
+        return storage;
+    }
+
+    auto row_velocity(const Row& row, int k, const Velocities& velocities) -> float {
+        return dot(row.direction[k], velocities.linear(row.b) - velocities.linear(row.a))
+            + dot(row.arm_b[k], velocities.angular(row.b)) - dot(row.arm_a[k], velocities.angular(row.a));
+    }
+
+    void apply_row(const Row& row, int k, float impulse, Velocities& velocities) {
+        velocities.add(row.a, row.direction[k] * (-impulse * row.inverse_mass_a), row.spin_a[k] * -impulse);
+        velocities.add(row.b, row.direction[k] * (impulse * row.inverse_mass_b), row.spin_b[k] * impulse);
+    }
+
+    // Friction first, bounded by the normal impulse of the previous pass, then the normal row.
+    void solve_row(Row& row, Velocities& velocities) {
+        float const limit = row.friction * row.impulse[0];
+        for (int k = 1; k < 3; ++k) {
+            float const change = -row_velocity(row, k, velocities) * row.mass[k];
+            float const total = std::clamp(row.impulse[k] + change, -limit, limit);
+            apply_row(row, k, total - row.impulse[k], velocities);
+            row.impulse[k] = total;
+        }
+
+        float const change = (row.bias - row_velocity(row, 0, velocities)) * row.mass[0];
+        float const total = std::max(row.impulse[0] + change, 0.0F);
+        apply_row(row, 0, total - row.impulse[0], velocities);
+        row.impulse[0] = total;
+    }
+
+    struct Lanes3 {
+        simd::float4 x;
+        simd::float4 y;
+        simd::float4 z;
+    };
+
+    auto load3(const float (&values)[3][WIDTH]) -> Lanes3 {
+        return {simd::load(values[0]), simd::load(values[1]), simd::load(values[2])};
+    }
+
+    auto dot3(const Lanes3& a, const Lanes3& b) -> simd::float4 {
+        return simd::madd(a.x, b.x, simd::madd(a.y, b.y, a.z * b.z));
+    }
+
+    void add_scaled(Lanes3& a, const Lanes3& b, simd::float4 scale) {
+        a.x = simd::madd(b.x, scale, a.x);
+        a.y = simd::madd(b.y, scale, a.y);
+        a.z = simd::madd(b.z, scale, a.z);
+    }
+
+    auto gather(const std::vector<float>& values, const uint32_t* slots) -> simd::float4 {
+        return simd::set(values[slots[0]], values[slots[1]], values[slots[2]], values[slots[3]]);
+    }
+
+    void scatter(std::vector<float>& values, const uint32_t* slots, simd::float4 lanes) {
+        float stored[WIDTH];
+        simd::store(stored, lanes);
+        for (size_t lane = 0; lane < WIDTH; ++lane) {
+            values[slots[lane]] = stored[lane];
+        }
+    }
+
+    // solve_row() on four rows at once.
+    void solve_block(Block& block, Velocities& velocities) {
+        Lanes3 va {
+            gather(velocities.vx, block.a), gather(velocities.vy, block.a), gather(velocities.vz, block.a)};
+        Lanes3 wa {
+            gather(velocities.wx, block.a), gather(velocities.wy, block.a), gather(velocities.wz, block.a)};
+        Lanes3 vb {
+            gather(velocities.vx, block.b), gather(velocities.vy, block.b), gather(velocities.vz, block.b)};
+        Lanes3 wb {
+            gather(velocities.wx, block.b), gather(velocities.wy, block.b), gather(velocities.wz, block.b)};
+        simd::float4 const inverse_mass_a = simd::load(block.inverse_mass_a);
+        simd::float4 const inverse_mass_b = simd::load(block.inverse_mass_b);
+
+        auto velocity = [&](int k)
+        {
+            Lanes3 const relative {vb.x - va.x, vb.y - va.y, vb.z - va.z};
+            return dot3(load3(block.direction[k]), relative) + dot3(load3(block.arm_b[k]), wb)
+                - dot3(load3(block.arm_a[k]), wa);
+        };
+
+        auto apply = [&](int k, simd::float4 impulse)
+        {
+            Lanes3 const direction = load3(block.direction[k]);
+            add_scaled(va, direction, -(impulse * inverse_mass_a));
+            add_scaled(wa, load3(block.spin_a[k]), -impulse);
+            add_scaled(vb, direction, impulse * inverse_mass_b);
+            add_scaled(wb, load3(block.spin_b[k]), impulse);
+        };
+
+        simd::float4 const limit = simd::load(block.friction) * simd::load(block.impulse[0]);
+        for (int k = 1; k < 3; ++k) {
+            simd::float4 const old = simd::load(block.impulse[k]);
+            simd::float4 const change = -(velocity(k) * simd::load(block.mass[k]));
+            simd::float4 const total = simd::min(simd::max(old + change, -limit), limit);
+            simd::store(block.impulse[k], total);
+            apply(k, total - old);
+        }
+
+        simd::float4 const old = simd::load(block.impulse[0]);
+        simd::float4 const change = (simd::load(block.bias) - velocity(0)) * simd::load(block.mass[0]);
+        simd::float4 const total = simd::max(old + change, simd::zero4());
+        simd::store(block.impulse[0], total);
+        apply(0, total - old);
+
+        scatter(velocities.vx, block.a, va.x);
+        scatter(velocities.vy, block.a, va.y);
+        scatter(velocities.vz, block.a, va.z);
+        scatter(velocities.wx, block.a, wa.x);
+        scatter(velocities.wy, block.a, wa.y);
+        scatter(velocities.wz, block.a, wa.z);
+        scatter(velocities.vx, block.b, vb.x);
+        scatter(velocities.vy, block.b, vb.y);
+        scatter(velocities.vz, block.b, vb.z);
+        scatter(velocities.wx, block.b, wb.x);
+        scatter(velocities.wy, block.b, wb.y);
+        scatter(velocities.wz, block.b, wb.z);
+    }
+
+    // Transposes up to four rows into a block; missing lanes connect slot 0 to itself and do nothing.
+    void fill_block(const std::vector<Row>& rows, const uint32_t* indices, size_t count, Block& block) {
+        block = Block {};
+        for (size_t lane = 0; lane < WIDTH; ++lane) {
+            block.a[lane] = 0;
+            block.b[lane] = 0;
+            block.row[lane] = PADDING_LANE;
+        }
+
+        for (size_t lane = 0; lane < count; ++lane) {
+            const Row& row = rows[indices[lane]];
+            block.a[lane] = row.a;
+            block.b[lane] = row.b;
+            block.row[lane] = indices[lane];
+            for (int k = 0; k < 3; ++k) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    block.direction[k][axis][lane] = row.direction[k][axis];
+                    block.arm_a[k][axis][lane] = row.arm_a[k][axis];
+                    block.arm_b[k][axis][lane] = row.arm_b[k][axis];
+                    block.spin_a[k][axis][lane] = row.spin_a[k][axis];
+                    block.spin_b[k][axis][lane] = row.spin_b[k][axis];
+                }
+                block.mass[k][lane] = row.mass[k];
+                block.impulse[k][lane] = row.impulse[k];
+            }
+            block.inverse_mass_a[lane] = row.inverse_mass_a;
+            block.inverse_mass_b[lane] = row.inverse_mass_b;
+            block.bias[lane] = row.bias;
+            block.friction[lane] = row.friction;
+        }
+    }
+
+    // Greedy coloring: every row takes the first color neither of its dynamic bodies has used yet.
+    // Rows of one color are packed into blocks; the rows beyond the last color are left over.
+    // Returns the number of colors used.
+    auto color_rows(Scratch& storage, size_t slots) -> size_t {
+        auto const& rows = storage.rows;
+        storage.used_colors.assign(slots, 0);
+        storage.color_of.resize(rows.size());
+        storage.color_start.assign(MAX_COLORS + 1, 0);
+        storage.leftover.clear();
+
+        size_t colors = 0;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            uint64_t const taken = storage.used_colors[rows[i].a] | storage.used_colors[rows[i].b];
+            uint32_t color = 0;
+            while (color < MAX_COLORS && ((taken >> color) & 1U) != 0) {
+                ++color;
+            }
+
+            storage.color_of[i] = color;
+            if (color == MAX_COLORS) {
+                storage.leftover.push_back(static_cast<uint32_t>(i));
+                continue;
+            }
+
+            // Slot 0 never changes, so any number of rows of one color may touch it.
+            uint64_t const bit = uint64_t {1} << color;
+            if (rows[i].a != 0) {
+                storage.used_colors[rows[i].a] |= bit;
+            }
+            if (rows[i].b != 0) {
+                storage.used_colors[rows[i].b] |= bit;
+            }
+            ++storage.color_start[color + 1];
+            colors = std::max<size_t>(colors, color + 1);
+        }
+
+        for (uint32_t color = 0; color < MAX_COLORS; ++color) {
+            storage.color_start[color + 1] += storage.color_start[color];
+        }
+
+        storage.sorted.resize(rows.size() - storage.leftover.size());
+        storage.fill.assign(storage.color_start.begin(), storage.color_start.end() - 1);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (storage.color_of[i] < MAX_COLORS) {
+                storage.sorted[storage.fill[storage.color_of[i]]++] = static_cast<uint32_t>(i);
+            }
+        }
+
+        storage.blocks.clear();
+        for (size_t color = 0; color < colors; ++color) {
+            for (uint32_t begin = storage.color_start[color]; begin < storage.color_start[color + 1];
+                 begin += static_cast<uint32_t>(WIDTH))
+            {
+                size_t const count = std::min<size_t>(WIDTH, storage.color_start[color + 1] - begin);
+                storage.blocks.emplace_back();
+                fill_block(rows, &storage.sorted[begin], count, storage.blocks.back());
+            }
+        }
+
+        return colors;
+    }
+
+    void apply_joint(const JointRow& joint, Vec3 impulse, Velocities& velocities) {
+        velocities.add(joint.a,
+                       impulse * -joint.inverse_mass_a,
+                       -(joint.inverse_inertia_a * cross(joint.arm_a, impulse)));
+        velocities.add(
+            joint.b, impulse * joint.inverse_mass_b, joint.inverse_inertia_b * cross(joint.arm_b, impulse));
+    }
+
+    void solve_joint(JointRow& joint, Velocities& velocities) {
+        Vec3 const velocity = velocities.linear(joint.b) + cross(velocities.angular(joint.b), joint.arm_b)
+            - velocities.linear(joint.a) - cross(velocities.angular(joint.a), joint.arm_a);
+        Vec3 const impulse = joint.mass * -(velocity + joint.bias);
+        joint.impulse += impulse;
+        apply_joint(joint, impulse, velocities);
+    }
+
+    auto find_root(std::vector<uint32_t>& parent, uint32_t node) -> uint32_t {
+        while (parent[node] != node) {
+            parent[node] = parent[parent[node]];
+            node = parent[node];
+        }
+        return node;
+    }
+
+    void unite(std::vector<uint32_t>& parent, uint32_t a, uint32_t b) {
+        uint32_t const root_a = find_root(parent, a);
+        uint32_t const root_b = find_root(parent, b);
+        if (root_a != root_b) {
+            parent[std::max(root_a, root_b)] = std::min(root_a, root_b);
+        }
+    }
+}    // namespace
+
+namespace physics::dynamics {
+
+    World::World(const Settings& settings)
+        : m_settings(settings)
+        , m_broadphase(settings.cell_size) {
+        LOG_TRACE
+    }
+
+    auto World::create_body(const BodyDesc& desc) -> BodyId {
+        auto const id = static_cast<BodyId>(m_bodies.size());
+
+        Body body;
+        body.linear_velocity = desc.linear_velocity;
+        body.angular_velocity = desc.angular_velocity;
+        body.friction = desc.friction;
+        body.restitution = desc.restitution;
+        body.type = desc.type;
+        if (desc.type == BodyType::Dynamic && desc.mass > 0.0F) {
+            body.inverse_mass = 1.0F / desc.mass;
+            body.inverse_inertia = inverse_inertia(desc.shape, desc.mass);
+        } else {
+            body.linear_velocity = {};
+            body.angular_velocity = {};
+        }
+
+        m_bodies.push_back(body);
+        m_colliders.push_back({desc.shape, desc.transform});
+        m_awake.push_back(desc.type == BodyType::Dynamic ? 1 : 0);
+
+        // No proxy is ever destroyed, so proxy ids and body ids stay equal and the broadphase pairs
+        // index the collider array directly.
+        m_broadphase.create_proxy(narrowphase::bounds(m_colliders.back()));
+        return id;
+    }
+
+    auto World::create_joint(const BallJointDesc& desc) -> JointId {
+        wake(desc.first);
+        wake(desc.second);
+        m_joints.push_back({desc, {}});
+        return static_cast<JointId>(m_joints.size() - 1);
+    }
+
+    void World::set_execution(kinematics::Execution execution) {
+        m_execution = execution;
+    }
+
+    void World::set_velocity(BodyId body, Vec3 linear, Vec3 angular) {
+        if (m_bodies[body].type != BodyType::Dynamic) {
+            return;
+        }
+
+        wake(body);
+        m_bodies[body].linear_velocity = linear;
+        m_bodies[body].angular_velocity = angular;
+        m_bodies[body].sleep_time = 0.0F;
+    }
+
+    void World::wake(BodyId body) {
+        uint32_t const group = m_bodies[body].sleep_group;
+        if (group == NO_GROUP) {
+            return;
+        }
+
+        for (BodyId const member : m_sleep_groups[group]) {
+            m_bodies[member].sleep_group = NO_GROUP;
+            m_bodies[member].sleep_time = 0.0F;
+            m_awake[member] = 1;
+        }
+        m_sleep_groups[group].clear();
+        m_free_groups.push_back(group);
+    }
+
+    void World::pools(std::vector<snapshot::Pool>& pools) {
+        pools.push_back({m_bodies.data(), m_bodies.size() * sizeof(Body)});
+        pools.push_back({m_colliders.data(), m_colliders.size() * sizeof(narrowphase::Collider)});
+        pools.push_back({m_awake.data(), m_awake.size()});
+        pools.push_back({m_joints.data(), m_joints.size() * sizeof(Joint)});
+    }
+
+    void World::restored() {
+        LOG_TRACE
+
+        // Group ids are kept in the bodies; the member lists follow from them.
+        for (auto& group : m_sleep_groups) {
+            group.clear();
+        }
+        for (BodyId body = 0; body < m_bodies.size(); ++body) {
+            uint32_t const group = m_bodies[body].sleep_group;
+            if (group != NO_GROUP) {
+                if (group >= m_sleep_groups.size()) {
+                    m_sleep_groups.resize(group + 1);
+                }
+                m_sleep_groups[group].push_back(body);
+            }
+        }
+
+        m_free_groups.clear();
+        for (uint32_t group = 0; group < m_sleep_groups.size(); ++group) {
+            if (m_sleep_groups[group].empty()) {
+                m_free_groups.push_back(group);
+            }
+        }
+
+        for (BodyId body = 0; body < m_bodies.size(); ++body) {
+            move_proxy(body);
+        }
+        m_narrowphase.clear();
+    }
+
+    // The box is widened by the margin the narrowphase reports contacts in.
+    void World::move_proxy(BodyId body) {
+        float const widen = narrowphase::CONTACT_MARGIN;
+        Vec3 const margin {widen, widen, widen};
+        auto const box = narrowphase::bounds(m_colliders[body]);
+        m_broadphase.move_proxy(body, {box.min - margin, box.max + margin});
+    }
+
+    void World::step(float time) {
+        if (time <= 0.0F) {
+            return;
+        }
+
+        // Only awake bodies move.
+        for (BodyId body = 0; body < m_bodies.size(); ++body) {
+            if (is_awake(body)) {
+                move_proxy(body);
+            }
+        }
+
+        m_broadphase.find_pairs(m_pairs);
+        m_narrowphase.update(m_pairs.data(), m_pairs.size(), m_colliders.data(), m_execution, m_awake.data());
+
+        wake_touched();
+        build_islands();
+
+        auto body = [this, time](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) {
+                solve_island(m_islands.order[i], time);
+            }
+        };
+
+        size_t const island_count = m_islands.order.size();
+        if (m_execution == kinematics::Execution::Parallel) {
+            utils::parallel::parallel_for(island_count, ISLAND_GRAIN, body);
+        } else {
+            body(0, island_count);
+        }
+
+        m_stats = {};
+        m_stats.islands = island_count;
+        for (const StepStats& island : m_islands.stats) {
+            m_stats.awake_bodies += island.awake_bodies;
+            m_stats.contact_points += island.contact_points;
+            m_stats.batched_points += island.batched_points;
+            m_stats.colors = std::max(m_stats.colors, island.colors);
+        }
+
+        sleep_islands();
+    }
+
+    // A sleeping island touched by an awake body wakes as a whole; its cached contacts are still exact,
+    // since none of its bodies moved, so it is solved in this very step.
+    void World::wake_touched() {
+        auto sleeping = [this](BodyId body) { return m_bodies[body].sleep_group != NO_GROUP; };
+
+        bool woke = true;
+        while (woke) {
+            woke = false;
+            for (const auto& manifold : m_narrowphase.manifolds()) {
+                if (manifold.count == 0 || is_awake(manifold.first) == is_awake(manifold.second)) {
+                    continue;
+                }
+
+                BodyId const other = is_awake(manifold.first) ? manifold.second : manifold.first;
+                if (sleeping(other)) {
+                    wake(other);
+                    woke = true;
+                }
+            }
+
+            for (const Joint& joint : m_joints) {
+                BodyId const first = joint.desc.first;
+                BodyId const second = joint.desc.second;
+                if (is_awake(first) != is_awake(second) && (sleeping(first) || sleeping(second))) {
+                    wake(sleeping(first) ? first : second);
+                    woke = true;
+                }
+            }
+        }
+    }
+
+    void World::build_islands() {
+        Islands& islands = m_islands;
+        size_t const body_count = m_bodies.size();
+        const auto& manifolds = m_narrowphase.manifolds();
+
+        islands.parent.resize(body_count);
+        islands.index.resize(body_count);
+        for (BodyId body = 0; body < body_count; ++body) {
+            islands.parent[body] = body;
+        }
+
+        for (const auto& manifold : manifolds) {
+            if (manifold.count > 0 && is_awake(manifold.first) && is_awake(manifold.second)) {
+                unite(islands.parent, manifold.first, manifold.second);
+            }
+        }
+        for (const Joint& joint : m_joints) {
+            if (is_awake(joint.desc.first) && is_awake(joint.desc.second)) {
+                unite(islands.parent, joint.desc.first, joint.desc.second);
+            }
+        }
+
+        // Number the islands by their roots and count their bodies. A root is the smallest body of its
+        // island, so every member comes after its root and finds the root's island already numbered.
+        islands.body_start.assign(1, 0);
+        for (BodyId body = 0; body < body_count; ++body) {
+            if (!is_awake(body)) {
+                continue;
+            }
+
+            uint32_t const root = find_root(islands.parent, body);
+            if (root == body) {
+                islands.index[body] = static_cast<uint32_t>(islands.body_start.size() - 1);
+                islands.body_start.push_back(0);
+            }
+            ++islands.body_start[islands.index[root] + 1];
+        }
+
+        size_t const island_count = islands.body_start.size() - 1;
+        for (size_t island = 0; island < island_count; ++island) {
+            islands.body_start[island + 1] += islands.body_start[island];
+        }
+
+        islands.bodies.resize(islands.body_start.back());
+        std::vector<uint32_t>& fill = islands.order;
+        fill.assign(islands.body_start.begin(), islands.body_start.end() - 1);
+        for (BodyId body = 0; body < body_count; ++body) {
+            if (is_awake(body)) {
+                uint32_t const island = islands.index[find_root(islands.parent, body)];
+                islands.index[body] = island;
+                islands.bodies[fill[island]++] = body;
+            }
+        }
+
+        // Manifolds and joints belong to the island of their awake body.
+        auto island_of = [this](BodyId first, BodyId second)
+        { return m_islands.index[is_awake(first) ? first : second]; };
+
+        islands.manifold_start.assign(island_count + 1, 0);
+        for (const auto& manifold : manifolds) {
+            if (manifold.count > 0 && (is_awake(manifold.first) || is_awake(manifold.second))) {
+                ++islands.manifold_start[island_of(manifold.first, manifold.second) + 1];
+            }
+        }
+        islands.joint_start.assign(island_count + 1, 0);
+        for (const Joint& joint : m_joints) {
+            if (is_awake(joint.desc.first) || is_awake(joint.desc.second)) {
+                ++islands.joint_start[island_of(joint.desc.first, joint.desc.second) + 1];
+            }
+        }
+        for (size_t island = 0; island < island_count; ++island) {
+            islands.manifold_start[island + 1] += islands.manifold_start[island];
+            islands.joint_start[island + 1] += islands.joint_start[island];
+        }
+
+        islands.manifolds.resize(islands.manifold_start.back());
+        fill.assign(islands.manifold_start.begin(), islands.manifold_start.end() - 1);
+        for (size_t i = 0; i < manifolds.size(); ++i) {
+            const auto& manifold = manifolds[i];
+            if (manifold.count > 0 && (is_awake(manifold.first) || is_awake(manifold.second))) {
+                uint32_t const island = island_of(manifold.first, manifold.second);
+                islands.manifolds[fill[island]++] = static_cast<uint32_t>(i);
+            }
+        }
+
+        islands.joints.resize(islands.joint_start.back());
+        fill.assign(islands.joint_start.begin(), islands.joint_start.end() - 1);
+        for (JointId i = 0; i < m_joints.size(); ++i) {
+            const BallJointDesc& joint = m_joints[i].desc;
+            if (is_awake(joint.first) || is_awake(joint.second)) {
+                islands.joints[fill[island_of(joint.first, joint.second)]++] = i;
+            }
+        }
+
+        // Largest islands first, so the long ones do not start last on a worker thread.
+        islands.order.resize(island_count);
+        for (uint32_t island = 0; island < island_count; ++island) {
+            islands.order[island] = island;
+        }
+        auto const size = [&islands](uint32_t island)
+        {
+            return (islands.body_start[island + 1] - islands.body_start[island])
+                + (islands.manifold_start[island + 1] - islands.manifold_start[island]);
+        };
+        std::sort(islands.order.begin(),
+                  islands.order.end(),
+                  [&size](uint32_t a, uint32_t b) { return size(a) > size(b); });
+
+        islands.sleep_time.assign(island_count, 0.0F);
+        islands.stats.assign(island_count, {});
+    }
+
+    void World::solve_island(size_t island, float time) {
+        Scratch& storage = scratch();
+        Velocities& velocities = storage.velocities;
+        auto& manifolds = m_narrowphase.manifolds();
+
+        uint32_t const body_begin = m_islands.body_start[island];
+        uint32_t const body_end = m_islands.body_start[island + 1];
+        size_t const slots = body_end - body_begin + 1;
+
+        velocities.reset(slots);
+        for (auto* values : {&storage.px, &storage.py, &storage.pz, &storage.ax, &storage.ay, &storage.az}) {
+            values->assign(slots, 0.0F);
+        }
+        storage.inverse_mass.assign(slots, 0.0F);
+        storage.inverse_inertia.assign(slots, Mat3 {{{}, {}, {}}});
+
+        for (uint32_t slot = 1; slot < slots; ++slot) {
+            BodyId const id = m_islands.bodies[body_begin + slot - 1];
+            const Body& body = m_bodies[id];
+            const Transform& transform = m_colliders[id].transform;
+            m_islands.index[id] = slot;
+
+            Mat3 const rotation = mathematics::to_matrix(transform.rotation);
+            velocities.set(slot, body.linear_velocity, body.angular_velocity);
+            storage.px[slot] = transform.position.x;
+            storage.py[slot] = transform.position.y;
+            storage.pz[slot] = transform.position.z;
+            if (body.inverse_mass > 0.0F) {
+                storage.ax[slot] = m_settings.gravity.x;
+                storage.ay[slot] = m_settings.gravity.y;
+                storage.az[slot] = m_settings.gravity.z;
+            }
+            storage.inverse_mass[slot] = body.inverse_mass;
+            storage.inverse_inertia[slot] =
+                rotation * mathematics::diagonal(body.inverse_inertia) * mathematics::transpose(rotation);
+        }
+
+        Vec3Span<float> const linear {velocities.vx.data(), velocities.vy.data(), velocities.vz.data()};
+        ConstVec3Span<float> const gravity {storage.ax.data(), storage.ay.data(), storage.az.data()};
+        kinematics::calculate_final_velocity_batch(linear, gravity, slots, time);
+
+        auto slot_of = [this](BodyId body) { return is_awake(body) ? m_islands.index[body] : 0U; };
+
+        storage.rows.clear();
+        for (uint32_t i = m_islands.manifold_start[island]; i < m_islands.manifold_start[island + 1]; ++i) {
+            auto& manifold = manifolds[m_islands.manifolds[i]];
+            const Body& first = m_bodies[manifold.first];
+            const Body& second = m_bodies[manifold.second];
+            Vec3 const center_a = m_colliders[manifold.first].transform.position;
+            Vec3 const center_b = m_colliders[manifold.second].transform.position;
+            float const friction = std::sqrt(first.friction * second.friction);
+            float const restitution = std::max(first.restitution, second.restitution);
+
+            Row row;
+            row.a = slot_of(manifold.first);
+            row.b = slot_of(manifold.second);
+            row.inverse_mass_a = storage.inverse_mass[row.a];
+            row.inverse_mass_b = storage.inverse_mass[row.b];
+            row.friction = friction;
+            row.direction[0] = manifold.normal;
+            tangents(manifold.normal, row.direction[1], row.direction[2]);
+
+            for (int p = 0; p < manifold.count; ++p) {
+                ContactPoint& point = manifold.points[p];
+                Vec3 const offset_a = point.position - center_a;
+                Vec3 const offset_b = point.position - center_b;
+
+                for (int k = 0; k < 3; ++k) {
+                    row.arm_a[k] = cross(offset_a, row.direction[k]);
+                    row.arm_b[k] = cross(offset_b, row.direction[k]);
+                    row.spin_a[k] = storage.inverse_inertia[row.a] * row.arm_a[k];
+                    row.spin_b[k] = storage.inverse_inertia[row.b] * row.arm_b[k];
+                    float const effective = row.inverse_mass_a + row.inverse_mass_b
+                        + dot(row.arm_a[k], row.spin_a[k]) + dot(row.arm_b[k], row.spin_b[k]);
+                    row.mass[k] = effective > 0.0F ? 1.0F / effective : 0.0F;
+                }
+
+                // Penetration beyond the allowance is pushed out over several steps; a gap lets the
+                // bodies approach just far enough to close it within this step.
+                if (point.depth > 0.0F) {
+                    float const excess = std::max(point.depth - m_settings.allowed_penetration, 0.0F);
+                    row.bias = std::min(m_settings.baumgarte * excess / time, MAX_BIAS_VELOCITY);
+                } else {
+                    row.bias = point.depth / time;
+                }
+
+                float const approach = row_velocity(row, 0, velocities);
+                if (approach < -RESTITUTION_THRESHOLD) {
+                    row.bias = std::max(row.bias, -restitution * approach);
+                }
+
+                row.impulse[0] = point.normal_impulse;
+                row.impulse[1] = point.tangent_impulse[0];
+                row.impulse[2] = point.tangent_impulse[1];
+                row.point = &point;
+                storage.rows.push_back(row);
+            }
+        }
+
+        storage.joints.clear();
+        for (uint32_t i = m_islands.joint_start[island]; i < m_islands.joint_start[island + 1]; ++i) {
+            Joint& source = m_joints[m_islands.joints[i]];
+            const Transform& transform_a = m_colliders[source.desc.first].transform;
+            const Transform& transform_b = m_colliders[source.desc.second].transform;
+
+            JointRow joint;
+            joint.a = slot_of(source.desc.first);
+            joint.b = slot_of(source.desc.second);
+            joint.arm_a = mathematics::rotate(transform_a.rotation, source.desc.local_anchor_a);
+            joint.arm_b = mathematics::rotate(transform_b.rotation, source.desc.local_anchor_b);
+            joint.inverse_mass_a = storage.inverse_mass[joint.a];
+            joint.inverse_mass_b = storage.inverse_mass[joint.b];
+            joint.inverse_inertia_a = storage.inverse_inertia[joint.a];
+            joint.inverse_inertia_b = storage.inverse_inertia[joint.b];
+
+            Mat3 const skew_a = mathematics::skew(joint.arm_a);
+            Mat3 const skew_b = mathematics::skew(joint.arm_b);
+            Mat3 const linear_part = mathematics::diagonal(
+                Vec3 {1.0F, 1.0F, 1.0F} * (joint.inverse_mass_a + joint.inverse_mass_b));
+            joint.mass = mathematics::inverse(linear_part - (skew_a * joint.inverse_inertia_a * skew_a)
+                                              - (skew_b * joint.inverse_inertia_b * skew_b));
+
+            Vec3 const drift = (transform_b.position + joint.arm_b) - (transform_a.position + joint.arm_a);
+            joint.bias = drift * (m_settings.baumgarte / time);
+            joint.impulse = source.impulse;
+            joint.stored = &source.impulse;
+            storage.joints.push_back(joint);
+        }
+
+        // Warm start with the impulses the contact points and joints kept from the last step.
+        for (const Row& row : storage.rows) {
+            for (int k = 0; k < 3; ++k) {
+                apply_row(row, k, row.impulse[k], velocities);
+            }
+        }
+        for (const JointRow& joint : storage.joints) {
+            apply_joint(joint, joint.impulse, velocities);
+        }
+
+        bool const batched = storage.rows.size() >= m_settings.batch_threshold;
+        StepStats& stats = m_islands.stats[island];
+        stats.awake_bodies = slots - 1;
+        stats.contact_points = storage.rows.size();
+        if (batched) {
+            stats.colors = color_rows(storage, slots);
+            stats.batched_points = storage.rows.size() - storage.leftover.size();
+        }
+
+        for (int iteration = 0; iteration < m_settings.velocity_iterations; ++iteration) {
+            for (JointRow& joint : storage.joints) {
+                solve_joint(joint, velocities);
+            }
+
+            if (batched) {
+                for (Block& block : storage.blocks) {
+                    solve_block(block, velocities);
+                }
+                for (uint32_t const row : storage.leftover) {
+                    solve_row(storage.rows[row], velocities);
+                }
+            } else {
+                for (Row& row : storage.rows) {
+                    solve_row(row, velocities);
+                }
+            }
+        }
+
+        // Impulses go back into the persistent contact points for the next warm start.
+        if (batched) {
+            for (const Block& block : storage.blocks) {
+                for (size_t lane = 0; lane < WIDTH && block.row[lane] != PADDING_LANE; ++lane) {
+                    for (int k = 0; k < 3; ++k) {
+                        storage.rows[block.row[lane]].impulse[k] = block.impulse[k][lane];
+                    }
+                }
+            }
+        }
+        for (const Row& row : storage.rows) {
+            row.point->normal_impulse = row.impulse[0];
+            row.point->tangent_impulse[0] = row.impulse[1];
+            row.point->tangent_impulse[1] = row.impulse[2];
+        }
+        for (const JointRow& joint : storage.joints) {
+            *joint.stored = joint.impulse;
+        }
+
+        // x' = x + v * t has the form of the velocity update, with the solved velocities as the rate.
+        kinematics::calculate_final_velocity_batch(
+            Vec3Span<float> {storage.px.data(), storage.py.data(), storage.pz.data()},
+            ConstVec3Span<float> {velocities.vx.data(), velocities.vy.data(), velocities.vz.data()},
+            slots,
+            time);
+
+        float const linear_limit = m_settings.sleep_linear_velocity * m_settings.sleep_linear_velocity;
+        float const angular_limit = m_settings.sleep_angular_velocity * m_settings.sleep_angular_velocity;
+        float sleep_time = std::numeric_limits<float>::infinity();
+
+        for (uint32_t slot = 1; slot < slots; ++slot) {
+            BodyId const id = m_islands.bodies[body_begin + slot - 1];
+            Body& body = m_bodies[id];
+            Transform& transform = m_colliders[id].transform;
+
+            body.linear_velocity = velocities.linear(slot);
+            body.angular_velocity = velocities.angular(slot);
+            transform.position = {storage.px[slot], storage.py[slot], storage.pz[slot]};
+            transform.rotation = mathematics::integrate(transform.rotation, body.angular_velocity, time);
+
+            bool const slow = length_squared(body.linear_velocity) <= linear_limit
+                && length_squared(body.angular_velocity) <= angular_limit;
+            body.sleep_time = slow ? body.sleep_time + time : 0.0F;
+            sleep_time = std::min(sleep_time, body.sleep_time);
+        }
+
+        m_islands.sleep_time[island] = sleep_time;
+    }
+
+    void World::sleep_islands() {
+        for (size_t island = 0; island < m_islands.sleep_time.size(); ++island) {
+            if (m_islands.sleep_time[island] >= m_settings.time_to_sleep) {
+                sleep(island);
+            }
+        }
+    }
+
+    void World::sleep(size_t island) {
+        uint32_t group = 0;
+        if (m_free_groups.empty()) {
+            group = static_cast<uint32_t>(m_sleep_groups.size());
+            m_sleep_groups.emplace_back();
+        } else {
+            group = m_free_groups.back();
+            m_free_groups.pop_back();
+        }
+
+        for (uint32_t i = m_islands.body_start[island]; i < m_islands.body_start[island + 1]; ++i) {
+            BodyId const id = m_islands.bodies[i];
+            m_bodies[id].linear_velocity = {};
+            m_bodies[id].angular_velocity = {};
+            m_bodies[id].sleep_group = group;
+            m_awake[id] = 0;
+            m_sleep_groups[group].push_back(id);
+        }
+    }
+}    // namespace physics::dynamics
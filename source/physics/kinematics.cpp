@@ -1,6 +1,10 @@
+#include <cstddef>
+
 #include "domkrat3d/physics/kinematics.hpp"
 
+#include "domkrat3d/mathematics/simd.hpp"
 #include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
 
 double const HALF_PART = 0.5;
 
@@ -50,3 +54,289 @@ namespace physics::kinematics {
     }
 
 }    // namespace physics::kinematics
+
+namespace {
+    namespace simd = mathematics::simd;
+    using physics::kinematics::ConstVec3Span;
+    using physics::kinematics::Execution;
+    using physics::kinematics::Vec3Span;
+
+    // Bodies per parallel chunk; below this threads cost more than they save.
+    constexpr size_t PARALLEL_GRAIN = 16384;
+
+    template<typename Real>
+    constexpr size_t LANE_COUNT = sizeof(decltype(simd::set1(Real {}))) / sizeof(Real);
+
+    template<typename Body>
+    void run(size_t count, Execution execution, const Body& body) {
+        if (execution == Execution::Parallel) {
+            utils::parallel::parallel_for(count, PARALLEL_GRAIN, body);
+        } else {
+            body(0, count);
+        }
+    }
+
+    // v += a * t
+    template<typename Real>
+    void velocity_kernel(Real* velocity, const Real* acceleration, size_t begin, size_t end, Real time) {
+        auto const step = simd::set1(time);
+        size_t i = begin;
+
+        for (; i + LANE_COUNT<Real> <= end; i += LANE_COUNT<Real>) {
+            auto const increment = simd::load(acceleration + i);
+            simd::store(velocity + i, simd::madd(increment, step, simd::load(velocity + i)));
+        }
+
+        for (; i < end; ++i) {
+            velocity[i] = (acceleration[i] * time) + velocity[i];
+        }
+    }
+
+    // s += t * (u + (t / 2) * a)
+    template<typename Real>
+    void position_kernel(Real* position,
+                         const Real* velocity,
+                         const Real* acceleration,
+                         size_t begin,
+                         size_t end,
+                         Real time) {
+        auto const step = simd::set1(time);
+        auto const half_step = simd::set1(static_cast<Real>(HALF_PART) * time);
+        size_t i = begin;
+
+        for (; i + LANE_COUNT<Real> <= end; i += LANE_COUNT<Real>) {
+            auto const a = simd::load(acceleration + i);
+            auto const v = simd::load(velocity + i);
+
+            auto const displacement = simd::madd(simd::madd(a, half_step, v), step, simd::load(position + i));
+            simd::store(position + i, displacement);
+        }
+
+        Real const half_time = static_cast<Real>(HALF_PART) * time;
+        for (; i < end; ++i) {
+            position[i] = (((acceleration[i] * half_time) + velocity[i]) * time) + position[i];
+        }
+    }
+
+    // Position from the start-of-step velocity, then the velocity itself.
+    template<typename Real>
+    void advance_kernel(Real* position,
+                        Real* velocity,
+                        const Real* acceleration,
+                        size_t begin,
+                        size_t end,
+                        Real time) {
+        auto const step = simd::set1(time);
+        auto const half_step = simd::set1(static_cast<Real>(HALF_PART) * time);
+        size_t i = begin;
+
+        for (; i + LANE_COUNT<Real> <= end; i += LANE_COUNT<Real>) {
+            auto const a = simd::load(acceleration + i);
+            auto const v = simd::load(velocity + i);
+
+            auto const displacement = simd::madd(simd::madd(a, half_step, v), step, simd::load(position + i));
+            simd::store(position + i, displacement);
+            simd::store(velocity + i, simd::madd(a, step, v));
+        }
+
+        Real const half_time = static_cast<Real>(HALF_PART) * time;
+        for (; i < end; ++i) {
+            position[i] = (((acceleration[i] * half_time) + velocity[i]) * time) + position[i];
+            velocity[i] = (acceleration[i] * time) + velocity[i];
+        }
+    }
+
+    template<typename Real>
+    void velocity_batch(Real* velocity,
+                        const Real* acceleration,
+                        size_t count,
+                        Real time,
+                        Execution execution) {
+        run(count,
+            execution,
+            [=](size_t begin, size_t end) { velocity_kernel(velocity, acceleration, begin, end, time); });
+    }
+
+    template<typename Real>
+    void velocity_batch(Vec3Span<Real> velocity,
+                        ConstVec3Span<Real> acceleration,
+                        size_t count,
+                        Real time,
+                        Execution execution) {
+        run(count,
+            execution,
+            [=](size_t begin, size_t end)
+            {
+                velocity_kernel(velocity.x, acceleration.x, begin, end, time);
+                velocity_kernel(velocity.y, acceleration.y, begin, end, time);
+                velocity_kernel(velocity.z, acceleration.z, begin, end, time);
+            });
+    }
+
+    template<typename Real>
+    void position_batch(Real* position,
+                        const Real* velocity,
+                        const Real* acceleration,
+                        size_t count,
+                        Real time,
+                        Execution execution) {
+        run(count,
+            execution,
+            [=](size_t begin, size_t end)
+            { position_kernel(position, velocity, acceleration, begin, end, time); });
+    }
+
+    template<typename Real>
+    void position_batch(Vec3Span<Real> position,
+                        ConstVec3Span<Real> velocity,
+                        ConstVec3Span<Real> acceleration,
+                        size_t count,
+                        Real time,
+                        Execution execution) {
+        run(count,
+            execution,
+            [=](size_t begin, size_t end)
+            {
+                position_kernel(position.x, velocity.x, acceleration.x, begin, end, time);
+                position_kernel(position.y, velocity.y, acceleration.y, begin, end, time);
+                position_kernel(position.z, velocity.z, acceleration.z, begin, end, time);
+            });
+    }
+
+    template<typename Real>
+    void advance(Real* position,
+                 Real* velocity,
+                 const Real* acceleration,
+                 size_t count,
+                 Real time,
+                 Execution execution) {
+        run(count,
+            execution,
+            [=](size_t begin, size_t end)
+            { advance_kernel(position, velocity, acceleration, begin, end, time); });
+    }
+
+    template<typename Real>
+    void advance(Vec3Span<Real> position,
+                 Vec3Span<Real> velocity,
+                 ConstVec3Span<Real> acceleration,
+                 size_t count,
+                 Real time,
+                 Execution execution) {
+        run(count,
+            execution,
+            [=](size_t begin, size_t end)
+            {
+                advance_kernel(position.x, velocity.x, acceleration.x, begin, end, time);
+                advance_kernel(position.y, velocity.y, acceleration.y, begin, end, time);
+                advance_kernel(position.z, velocity.z, acceleration.z, begin, end, time);
+            });
+    }
+}    // namespace
+
+namespace physics::kinematics {
+
+    void calculate_final_velocity_batch(float* velocity,
+                                        const float* acceleration,
+                                        size_t count,
+                                        float time,
+                                        Execution execution) {
+        velocity_batch(velocity, acceleration, count, time, execution);
+    }
+
+    void calculate_final_velocity_batch(double* velocity,
+                                        const double* acceleration,
+                                        size_t count,
+                                        double time,
+                                        Execution execution) {
+        velocity_batch(velocity, acceleration, count, time, execution);
+    }
+
+    void calculate_final_velocity_batch(Vec3Span<float> velocity,
+                                        ConstVec3Span<float> acceleration,
+                                        size_t count,
+                                        float time,
+                                        Execution execution) {
+        velocity_batch(velocity, acceleration, count, time, execution);
+    }
+
+    void calculate_final_velocity_batch(Vec3Span<double> velocity,
+                                        ConstVec3Span<double> acceleration,
+                                        size_t count,
+                                        double time,
+                                        Execution execution) {
+        velocity_batch(velocity, acceleration, count, time, execution);
+    }
+
+    void calculate_final_position_batch(float* position,
+                                        const float* velocity,
+                                        const float* acceleration,
+                                        size_t count,
+                                        float time,
+                                        Execution execution) {
+        position_batch(position, velocity, acceleration, count, time, execution);
+    }
+
+    void calculate_final_position_batch(double* position,
+                                        const double* velocity,
+                                        const double* acceleration,
+                                        size_t count,
+                                        double time,
+                                        Execution execution) {
+        position_batch(position, velocity, acceleration, count, time, execution);
+    }
+
+    void calculate_final_position_batch(Vec3Span<float> position,
+                                        ConstVec3Span<float> velocity,
+                                        ConstVec3Span<float> acceleration,
+                                        size_t count,
+                                        float time,
+                                        Execution execution) {
+        position_batch(position, velocity, acceleration, count, time, execution);
+    }
+
+    void calculate_final_position_batch(Vec3Span<double> position,
+                                        ConstVec3Span<double> velocity,
+                                        ConstVec3Span<double> acceleration,
+                                        size_t count,
+                                        double time,
+                                        Execution execution) {
+        position_batch(position, velocity, acceleration, count, time, execution);
+    }
+
+    void advance_batch(float* position,
+                       float* velocity,
+                       const float* acceleration,
+                       size_t count,
+                       float time,
+                       Execution execution) {
+        advance(position, velocity, acceleration, count, time, execution);
+    }
+
+    void advance_batch(double* position,
+                       double* velocity,
+                       const double* acceleration,
+                       size_t count,
+                       double time,
+                       Execution execution) {
+        advance(position, velocity, acceleration, count, time, execution);
+    }
+
+    void advance_batch(Vec3Span<float> position,
+                       Vec3Span<float> velocity,
+                       ConstVec3Span<float> acceleration,
+                       size_t count,
+                       float time,
+                       Execution execution) {
+        advance(position, velocity, acceleration, count, time, execution);
+    }
+
+    void advance_batch(Vec3Span<double> position,
+                       Vec3Span<double> velocity,
+                       ConstVec3Span<double> acceleration,
+                       size_t count,
+                       double time,
+                       Execution execution) {
+        advance(position, velocity, acceleration, count, time, execution);
+    }
+}    // namespace physics::kinematics
@@ -0,0 +1,1325 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/physics/narrowphase.hpp"
+
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+    using mathematics::Mat3;
+    using mathematics::Transform;
+    using mathematics::Vec3;
+    using physics::narrowphase::Collider;
+    using physics::narrowphase::CONTACT_MARGIN;
+    using physics::narrowphase::ContactPoint;
+    using physics::narrowphase::Manifold;
+    using physics::narrowphase::MAX_CONTACT_POINTS;
+    using physics::narrowphase::Shape;
+    using physics::narrowphase::ShapeType;
+
+    constexpr size_t WIDTH = static_cast<size_t>(simd::LANES);
+    constexpr float INFINITE = std::numeric_limits<float>::infinity();
+
+    constexpr int GJK_ITERATIONS = 32;
+    constexpr float GJK_TOLERANCE = 1e-5F;
+
+    // Cores closer than this are treated as overlapping; the normal from their closest points is unreliable.
+    constexpr float CORE_TOUCH_DISTANCE = 1e-4F;
+
+    constexpr int EPA_ITERATIONS = 32;
+    constexpr int EPA_MAX_VERTICES = EPA_ITERATIONS + 4;
+    constexpr int EPA_MAX_FACES = 2 * EPA_MAX_VERTICES;
+    constexpr float EPA_TOLERANCE = 1e-4F;
+
+    // Box2D's bias towards the first candidate when two axes separate about equally.
+    constexpr float RELATIVE_TOLERANCE = 0.98F;
+    constexpr float ABSOLUTE_TOLERANCE = 0.001F;
+
+    constexpr int MAX_CLIPPED_POINTS = 8;
+
+    // A new point this close to a cached one replaces it and inherits its impulses.
+    constexpr float MATCH_DISTANCE = 0.02F;
+    // Cached points whose anchors drift apart tangentially by more than this are dropped.
+    constexpr float BREAK_DISTANCE = 0.04F;
+
+    // Relative motion small enough to re-project the cached manifold instead of querying.
+    constexpr float REUSE_DISTANCE = 1e-3F;
+    constexpr float REUSE_ROTATION = 0.99999F;
+
+    constexpr size_t PARALLEL_GRAIN = 64;
+
+    auto sign(float value) -> float {
+        return value < 0.0F ? -1.0F : 1.0F;
+    }
+
+    // Support of the shape without its rounding radius: a point for spheres, a segment for capsules.
+    auto core_support(const Shape& shape, Vec3 direction) -> Vec3 {
+        switch (shape.type) {
+            case ShapeType::Sphere:
+                return {};
+            case ShapeType::Capsule:
+                return {0.0F, sign(direction.y) * shape.half_height, 0.0F};
+            case ShapeType::Box:
+                return {sign(direction.x) * shape.half_extents.x,
+                        sign(direction.y) * shape.half_extents.y,
+                        sign(direction.z) * shape.half_extents.z};
+            case ShapeType::ConvexHull:
+                return shape.hull->support(direction);
+        }
+        return {};
+    }
+
+    auto core_radius(const Shape& shape) -> float {
+        return shape.type == ShapeType::Sphere || shape.type == ShapeType::Capsule ? shape.radius : 0.0F;
+    }
+
+    // World support mapping of a collider, optionally grown by the rounding radius.
+    struct Support {
+        const Collider* collider;
+        float radius;
+
+        auto operator()(Vec3 direction) const -> Vec3 {
+            Vec3 const local = mathematics::inverse_rotate(collider->transform.rotation, direction);
+            Vec3 point = mathematics::apply(collider->transform, core_support(collider->shape, local));
+            if (radius > 0.0F) {
+                point += mathematics::normalize(direction) * radius;
+            }
+            return point;
+        }
+    };
+
+    // Vertex of the Minkowski difference A - B with the support points it came from.
+    struct Vertex {
+        Vec3 a;
+        Vec3 b;
+        Vec3 w;
+    };
+
+    auto make_vertex(const Support& a, const Support& b, Vec3 direction) -> Vertex {
+        Vertex vertex {a(direction), b(-direction), {}};
+        vertex.w = vertex.a - vertex.b;
+        return vertex;
+    }
+
+    struct Simplex {
+        Vertex vertices[4];
+        float weights[4] = {1.0F, 0.0F, 0.0F, 0.0F};
+        int count = 0;
+
+        void keep(int i, float wi) {
+            vertices[0] = vertices[i];
+            weights[0] = wi;
+            count = 1;
+        }
+
+        void keep(int i, float wi, int j, float wj) {
+            Vertex const first = vertices[i];
+            Vertex const second = vertices[j];
+            vertices[0] = first;
+            vertices[1] = second;
+            weights[0] = wi;
+            weights[1] = wj;
+            count = 2;
+        }
+
+        auto closest() const -> Vec3 {
+            Vec3 point;
+            for (int i = 0; i < count; ++i) {
+                point += vertices[i].w * weights[i];
+            }
+            return point;
+        }
+
+        void witnesses(Vec3& point_a, Vec3& point_b) const {
+            point_a = {};
+            point_b = {};
+            for (int i = 0; i < count; ++i) {
+                point_a += vertices[i].a * weights[i];
+                point_b += vertices[i].b * weights[i];
+            }
+        }
+    };
+
+    // Each solver reduces the simplex to the feature closest to the origin and sets its weights.
+    void solve_segment(Simplex& simplex) {
+        Vec3 const a = simplex.vertices[0].w;
+        Vec3 const ab = simplex.vertices[1].w - a;
+        float const length = dot(ab, ab);
+        float const t = length > 0.0F ? -dot(a, ab) / length : 0.0F;
+
+        if (t <= 0.0F) {
+            simplex.keep(0, 1.0F);
+        } else if (t >= 1.0F) {
+            simplex.keep(1, 1.0F);
+        } else {
+            simplex.keep(0, 1.0F - t, 1, t);
+        }
+    }
+
+    // Voronoi regions of a triangle as in Ericson, "Real-Time Collision Detection", 5.1.5.
+    void solve_triangle(Simplex& simplex) {
+        Vec3 const a = simplex.vertices[0].w;
+        Vec3 const b = simplex.vertices[1].w;
+        Vec3 const c = simplex.vertices[2].w;
+        Vec3 const ab = b - a;
+        Vec3 const ac = c - a;
+
+        float const d1 = -dot(ab, a);
+        float const d2 = -dot(ac, a);
+        if (d1 <= 0.0F && d2 <= 0.0F) {
+            simplex.keep(0, 1.0F);
+            return;
+        }
+
+        float const d3 = -dot(ab, b);
+        float const d4 = -dot(ac, b);
+        if (d3 >= 0.0F && d4 <= d3) {
+            simplex.keep(1, 1.0F);
+            return;
+        }
+
+        float const vc = (d1 * d4) - (d3 * d2);
+        if (vc <= 0.0F && d1 >= 0.0F && d3 <= 0.0F) {
+            float const v = d1 / (d1 - d3);
+            simplex.keep(0, 1.0F - v, 1, v);
+            return;
+        }
+
+        float const d5 = -dot(ab, c);
+        float const d6 = -dot(ac, c);
+        if (d6 >= 0.0F && d5 <= d6) {
+            simplex.keep(2, 1.0F);
+            return;
+        }
+
+        float const vb = (d5 * d2) - (d1 * d6);
+        if (vb <= 0.0F && d2 >= 0.0F && d6 <= 0.0F) {
+            float const w = d2 / (d2 - d6);
+            simplex.keep(0, 1.0F - w, 2, w);
+            return;
+        }
+
+        float const va = (d3 * d6) - (d5 * d4);
+        if (va <= 0.0F && (d4 - d3) >= 0.0F && (d5 - d6) >= 0.0F) {
+            float const w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            simplex.keep(1, 1.0F - w, 2, w);
+            return;
+        }
+
+        float const denominator = 1.0F / (va + vb + vc);
+        float const v = vb * denominator;
+        float const w = vc * denominator;
+        simplex.weights[0] = 1.0F - v - w;
+        simplex.weights[1] = v;
+        simplex.weights[2] = w;
+        simplex.count = 3;
+    }
+
+    // Returns false when the origin is inside the tetrahedron.
+    auto solve_tetrahedron(Simplex& simplex) -> bool {
+        constexpr int FACES[4][4] = {{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}};
+
+        Simplex best;
+        float best_distance = INFINITE;
+        bool outside_any = false;
+
+        for (const auto& face : FACES) {
+            Vec3 const a = simplex.vertices[face[0]].w;
+            Vec3 const normal = cross(simplex.vertices[face[1]].w - a, simplex.vertices[face[2]].w - a);
+            float const origin_side = -dot(normal, a);
+            float const opposite_side = dot(normal, simplex.vertices[face[3]].w - a);
+
+            // A flat tetrahedron cannot tell the sides apart, so every face is a candidate then.
+            bool const outside = !(std::fabs(opposite_side) > 0.0F) || origin_side * opposite_side < 0.0F;
+            if (!outside) {
+                continue;
+            }
+            outside_any = true;
+
+            Simplex candidate;
+            candidate.vertices[0] = simplex.vertices[face[0]];
+            candidate.vertices[1] = simplex.vertices[face[1]];
+            candidate.vertices[2] = simplex.vertices[face[2]];
+            candidate.count = 3;
+            solve_triangle(candidate);
+
+            float const distance = length_squared(candidate.closest());
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = candidate;
+            }
+        }
+
+        if (!outside_any) {
+            return false;
+        }
+
+        simplex = best;
+        return true;
+    }
+
+    struct GjkResult {
+        bool overlapping = false;
+        float distance = 0.0F;
+        Vec3 point_a;
+        Vec3 point_b;
+        Vec3 direction;
+    };
+
+    // GJK distance between the shapes; `direction` is an initial guess of A - B.
+    auto gjk(const Support& a, const Support& b, Vec3 direction, Simplex& simplex) -> GjkResult {
+        GjkResult result;
+        Vec3 closest = length_squared(direction) > 0.0F ? direction : Vec3 {1.0F, 0.0F, 0.0F};
+        simplex.count = 0;
+
+        for (int iteration = 0; iteration < GJK_ITERATIONS; ++iteration) {
+            Vertex const vertex = make_vertex(a, b, -closest);
+            float const closest_squared = length_squared(closest);
+
+            // No progress towards the origin: closest is the answer.
+            bool converged = simplex.count > 0
+                && closest_squared - dot(closest, vertex.w) <= GJK_TOLERANCE * closest_squared;
+            for (int i = 0; i < simplex.count && !converged; ++i) {
+                converged = !(length_squared(simplex.vertices[i].w - vertex.w) > 0.0F);
+            }
+            if (converged) {
+                break;
+            }
+
+            simplex.vertices[simplex.count++] = vertex;
+
+            bool inside = false;
+            switch (simplex.count) {
+                case 1:
+                    simplex.weights[0] = 1.0F;
+                    break;
+                case 2:
+                    solve_segment(simplex);
+                    break;
+                case 3:
+                    solve_triangle(simplex);
+                    break;
+                default:
+                    inside = !solve_tetrahedron(simplex);
+                    break;
+            }
+
+            closest = simplex.closest();
+            if (inside || length_squared(closest) <= CORE_TOUCH_DISTANCE * CORE_TOUCH_DISTANCE) {
+                result.overlapping = true;
+                result.direction = direction;
+                // Where the cores meet, unless the origin ended up inside a tetrahedron.
+                if (!inside) {
+                    simplex.witnesses(result.point_a, result.point_b);
+                }
+                return result;
+            }
+        }
+
+        result.distance = length(closest);
+        result.direction = closest;
+        simplex.witnesses(result.point_a, result.point_b);
+        return result;
+    }
+
+    struct Penetration {
+        Vec3 normal;
+        float depth = 0.0F;
+        Vec3 point_a;
+        Vec3 point_b;
+    };
+
+    struct Face {
+        int index[3];
+        Vec3 normal;
+        float distance;
+    };
+
+    auto make_face(const Vertex* vertices, int a, int b, int c) -> Face {
+        Face face {{a, b, c}, {}, INFINITE};
+        Vec3 const normal = cross(vertices[b].w - vertices[a].w, vertices[c].w - vertices[a].w);
+        float const length = mathematics::length(normal);
+        if (length > 0.0F) {
+            face.normal = normal * (1.0F / length);
+            face.distance = dot(face.normal, vertices[a].w);
+        }
+        return face;
+    }
+
+    // Grows a GJK simplex that touches the origin into a tetrahedron for EPA.
+    auto make_tetrahedron(const Support& a, const Support& b, Simplex& simplex) -> bool {
+        constexpr float EPSILON = 1e-10F;
+        Vec3 const axes[6] = {{1.0F, 0.0F, 0.0F},
+                              {-1.0F, 0.0F, 0.0F},
+                              {0.0F, 1.0F, 0.0F},
+                              {0.0F, -1.0F, 0.0F},
+                              {0.0F, 0.0F, 1.0F},
+                              {0.0F, 0.0F, -1.0F}};
+        Vertex* vertices = simplex.vertices;
+
+        if (simplex.count == 0) {
+            vertices[simplex.count++] = make_vertex(a, b, axes[0]);
+        }
+
+        for (int i = 0; i < 6 && simplex.count == 1; ++i) {
+            Vertex const vertex = make_vertex(a, b, axes[i]);
+            if (length_squared(vertex.w - vertices[0].w) > EPSILON) {
+                vertices[simplex.count++] = vertex;
+            }
+        }
+
+        if (simplex.count == 2) {
+            Vec3 const segment = vertices[1].w - vertices[0].w;
+            Vec3 const perpendicular = cross(segment, std::fabs(segment.x) < 0.57F ? axes[0] : axes[2]);
+            Vec3 const other = cross(segment, perpendicular);
+            Vec3 const directions[4] = {perpendicular, -perpendicular, other, -other};
+
+            for (int i = 0; i < 4 && simplex.count == 2; ++i) {
+                Vertex const vertex = make_vertex(a, b, directions[i]);
+                if (length_squared(cross(segment, vertex.w - vertices[0].w)) > EPSILON) {
+                    vertices[simplex.count++] = vertex;
+                }
+            }
+        }
+
+        if (simplex.count == 3) {
+            Vec3 const normal = cross(vertices[1].w - vertices[0].w, vertices[2].w - vertices[0].w);
+            for (Vec3 const direction : {normal, -normal}) {
+                Vertex const vertex = make_vertex(a, b, direction);
+                if (std::fabs(dot(normal, vertex.w - vertices[0].w)) > EPSILON) {
+                    vertices[simplex.count++] = vertex;
+                    break;
+                }
+            }
+        }
+
+        if (simplex.count < 4) {
+            return false;
+        }
+
+        // Wind face (0, 1, 2) away from vertex 3.
+        Vec3 const normal = cross(vertices[1].w - vertices[0].w, vertices[2].w - vertices[0].w);
+        if (dot(normal, vertices[3].w - vertices[0].w) > 0.0F) {
+            std::swap(vertices[0], vertices[1]);
+        }
+        return true;
+    }
+
+    // Expanding polytope algorithm: penetration normal and depth of overlapping shapes.
+    auto epa(const Support& a, const Support& b, Simplex simplex, Penetration& penetration) -> bool {
+        if (!make_tetrahedron(a, b, simplex)) {
+            return false;
+        }
+
+        Vertex vertices[EPA_MAX_VERTICES];
+        int vertex_count = 4;
+        std::copy(simplex.vertices, simplex.vertices + 4, vertices);
+
+        Face faces[EPA_MAX_FACES];
+        int face_count = 0;
+        faces[face_count++] = make_face(vertices, 0, 1, 2);
+        faces[face_count++] = make_face(vertices, 0, 3, 1);
+        faces[face_count++] = make_face(vertices, 0, 2, 3);
+        faces[face_count++] = make_face(vertices, 1, 3, 2);
+
+        int edges[EPA_MAX_FACES * 3][2];
+        int closest = 0;
+
+        for (int iteration = 0;; ++iteration) {
+            closest = 0;
+            for (int i = 1; i < face_count; ++i) {
+                if (faces[i].distance < faces[closest].distance) {
+                    closest = i;
+                }
+            }
+
+            Face const face = faces[closest];
+            if (!(face.distance < INFINITE)) {
+                return false;
+            }
+
+            Vertex const vertex = make_vertex(a, b, face.normal);
+            float const reach = dot(vertex.w, face.normal);
+            if (reach - face.distance <= EPA_TOLERANCE || iteration == EPA_ITERATIONS
+                || vertex_count == EPA_MAX_VERTICES)
+            {
+                break;
+            }
+
+            int const added = vertex_count;
+            vertices[vertex_count++] = vertex;
+
+            // Faces the new vertex sees are removed; their outline (horizon) is closed with new faces.
+            int edge_count = 0;
+            int kept = 0;
+            for (int i = 0; i < face_count; ++i) {
+                const Face& current = faces[i];
+                if (dot(current.normal, vertex.w - vertices[current.index[0]].w) <= 0.0F) {
+                    faces[kept++] = current;
+                    continue;
+                }
+
+                for (int e = 0; e < 3; ++e) {
+                    int const from = current.index[e];
+                    int const to = current.index[(e + 1) % 3];
+
+                    int shared = -1;
+                    for (int k = 0; k < edge_count; ++k) {
+                        if (edges[k][0] == to && edges[k][1] == from) {
+                            shared = k;
+                            break;
+                        }
+                    }
+
+                    if (shared >= 0) {
+                        edges[shared][0] = edges[edge_count - 1][0];
+                        edges[shared][1] = edges[edge_count - 1][1];
+                        --edge_count;
+                    } else {
+                        edges[edge_count][0] = from;
+                        edges[edge_count][1] = to;
+                        ++edge_count;
+                    }
+                }
+            }
+
+            face_count = kept;
+            if (face_count + edge_count > EPA_MAX_FACES) {
+                return false;
+            }
+            for (int k = 0; k < edge_count; ++k) {
+                faces[face_count++] = make_face(vertices, edges[k][0], edges[k][1], added);
+            }
+        }
+
+        // Barycentric coordinates of the origin's projection give the witness points.
+        const Face& face = faces[closest];
+        const Vertex& v0 = vertices[face.index[0]];
+        const Vertex& v1 = vertices[face.index[1]];
+        const Vertex& v2 = vertices[face.index[2]];
+
+        Vec3 const projection = face.normal * face.distance;
+        Vec3 const e0 = v1.w - v0.w;
+        Vec3 const e1 = v2.w - v0.w;
+        Vec3 const e2 = projection - v0.w;
+        float const d00 = dot(e0, e0);
+        float const d01 = dot(e0, e1);
+        float const d11 = dot(e1, e1);
+        float const d20 = dot(e2, e0);
+        float const d21 = dot(e2, e1);
+        float const denominator = (d00 * d11) - (d01 * d01);
+
+        float v = 0.0F;
+        float w = 0.0F;
+        if (denominator > 0.0F) {
+            v = ((d11 * d20) - (d01 * d21)) / denominator;
+            w = ((d00 * d21) - (d01 * d20)) / denominator;
+        }
+        float const u = 1.0F - v - w;
+
+        penetration.normal = face.normal;
+        penetration.depth = face.distance;
+        penetration.point_a = (v0.a * u) + (v1.a * v) + (v2.a * w);
+        penetration.point_b = (v0.b * u) + (v1.b * v) + (v2.b * w);
+        return true;
+    }
+
+    auto make_point(const Collider& a, const Collider& b, Vec3 point_a, Vec3 point_b, Vec3 normal)
+        -> ContactPoint {
+        ContactPoint point;
+        point.position = (point_a + point_b) * 0.5F;
+        point.depth = dot(point_a - point_b, normal);
+        point.local_a = mathematics::apply_inverse(a.transform, point_a);
+        point.local_b = mathematics::apply_inverse(b.transform, point_b);
+        return point;
+    }
+
+    // Query state carried between frames: GJK search direction and the last SAT axis.
+    struct Hint {
+        Vec3 direction;
+        int axis = -1;
+    };
+
+    // Axis of a capsule core in world space; zero for a sphere.
+    auto core_axis(const Collider& collider) -> Vec3 {
+        if (collider.shape.type != ShapeType::Capsule) {
+            return {};
+        }
+        return mathematics::rotate(collider.transform.rotation, {0.0F, 1.0F, 0.0F});
+    }
+
+    // Normal of two rounded shapes whose cores meet: across both segments when they cross, else
+    // across the one segment, else along the centers, oriented from A to B.
+    auto rounded_normal(const Collider& a, const Collider& b) -> Vec3 {
+        constexpr float EPSILON = 1e-12F;
+        Vec3 const axis_a = core_axis(a);
+        Vec3 const axis_b = core_axis(b);
+        Vec3 const offset = b.transform.position - a.transform.position;
+
+        Vec3 normal = cross(axis_a, axis_b);
+        if (!(length_squared(normal) > EPSILON)) {
+            Vec3 const axis = length_squared(axis_a) > 0.0F ? axis_a : axis_b;
+            normal = offset - (axis * dot(offset, axis));
+            if (!(length_squared(normal) > EPSILON)) {
+                // Coincident cores: any direction across the segment separates them.
+                Vec3 const other =
+                    std::fabs(axis.x) < 0.57F ? Vec3 {1.0F, 0.0F, 0.0F} : Vec3 {0.0F, 1.0F, 0.0F};
+                normal = cross(axis, other);
+            }
+            if (!(length_squared(normal) > EPSILON)) {
+                normal = {0.0F, 1.0F, 0.0F};
+            }
+        }
+
+        normal = mathematics::normalize(normal);
+        return dot(normal, offset) < 0.0F ? -normal : normal;
+    }
+
+    // Any pair of convex shapes: GJK on the cores, EPA when the cores overlap.
+    auto collide_convex(const Collider& a, const Collider& b, Hint& hint, Manifold& manifold) -> bool {
+        float const radius_a = core_radius(a.shape);
+        float const radius_b = core_radius(b.shape);
+
+        Vec3 direction = hint.direction;
+        if (!(length_squared(direction) > 0.0F)) {
+            direction = a.transform.position - b.transform.position;
+        }
+
+        Simplex simplex;
+        GjkResult const result = gjk({&a, 0.0F}, {&b, 0.0F}, direction, simplex);
+        if (!result.overlapping) {
+            hint.direction = result.direction;
+        }
+
+        float const reach = radius_a + radius_b;
+        if (!result.overlapping && result.distance > reach + CONTACT_MARGIN) {
+            return false;
+        }
+
+        if (!result.overlapping && result.distance > CORE_TOUCH_DISTANCE) {
+            Vec3 const normal = (result.point_b - result.point_a) * (1.0F / result.distance);
+            Vec3 const point_a = result.point_a + (normal * radius_a);
+            Vec3 const point_b = result.point_b - (normal * radius_b);
+
+            manifold.normal = normal;
+            manifold.points[0] = make_point(a, b, point_a, point_b, normal);
+            manifold.count = 1;
+            return true;
+        }
+
+        // The penetration of the cores grown by the rounding radii. Points and segments give EPA no
+        // volume to expand, so two rounded shapes separate across their cores from where GJK stopped;
+        // flat hulls fall back to EPA on the full shapes.
+        Penetration penetration;
+        if (epa({&a, 0.0F}, {&b, 0.0F}, Simplex {}, penetration)) {
+            penetration.point_a += penetration.normal * radius_a;
+            penetration.point_b -= penetration.normal * radius_b;
+        } else if (radius_a > 0.0F && radius_b > 0.0F) {
+            penetration.normal = rounded_normal(a, b);
+            penetration.point_a = result.point_a + (penetration.normal * radius_a);
+            penetration.point_b = result.point_b - (penetration.normal * radius_b);
+        } else if (!epa({&a, radius_a}, {&b, radius_b}, Simplex {}, penetration)) {
+            return false;
+        }
+
+        manifold.normal = penetration.normal;
+        manifold.points[0] = make_point(a, b, penetration.point_a, penetration.point_b, penetration.normal);
+        manifold.count = 1;
+        return true;
+    }
+
+    struct Box {
+        Vec3 center;
+        Mat3 axes;
+        Vec3 half_extents;
+
+        explicit Box(const Collider& collider)
+            : center(collider.transform.position)
+            , axes(mathematics::to_matrix(collider.transform.rotation))
+            , half_extents(collider.shape.half_extents) {}
+
+        // Half length of the box projected on a unit axis.
+        auto projected_radius(Vec3 axis) const -> float {
+            return (half_extents.x * std::fabs(dot(axes[0], axis)))
+                + (half_extents.y * std::fabs(dot(axes[1], axis)))
+                + (half_extents.z * std::fabs(dot(axes[2], axis)));
+        }
+    };
+
+    // Separation of two boxes along SAT axis 0-14 (3 faces of A, 3 of B, 9 edge pairs); the normal
+    // is oriented from A to B. Parallel edge pairs give no axis and report -infinity.
+    auto separation(const Box& a, const Box& b, int axis, Vec3& normal) -> float {
+        if (axis < 3) {
+            normal = a.axes[axis];
+        } else if (axis < 6) {
+            normal = b.axes[axis - 3];
+        } else {
+            normal = cross(a.axes[(axis - 6) / 3], b.axes[(axis - 6) % 3]);
+            float const length = mathematics::length(normal);
+            if (length < 1e-5F) {
+                return -INFINITE;
+            }
+            normal *= 1.0F / length;
+        }
+
+        float const distance = dot(b.center - a.center, normal);
+        if (distance < 0.0F) {
+            normal = -normal;
+        }
+        return std::fabs(distance) - a.projected_radius(normal) - b.projected_radius(normal);
+    }
+
+    // Sutherland-Hodgman: keeps the part of the polygon where dot(p - origin, normal) <= offset.
+    auto clip(const Vec3* input, int count, Vec3 origin, Vec3 normal, float offset, Vec3* output) -> int {
+        int result = 0;
+        for (int i = 0; i < count; ++i) {
+            Vec3 const start = input[i];
+            Vec3 const end = input[(i + 1) % count];
+            float const start_distance = dot(start - origin, normal) - offset;
+            float const end_distance = dot(end - origin, normal) - offset;
+
+            if (start_distance <= 0.0F) {
+                output[result++] = start;
+            }
+            if (start_distance * end_distance < 0.0F) {
+                float const t = start_distance / (start_distance - end_distance);
+                output[result++] = start + ((end - start) * t);
+            }
+        }
+        return result;
+    }
+
+    // Picks up to four points spanning the largest area, always keeping the deepest.
+    auto reduce(const Vec3* points, const float* depths, int count, Vec3 normal, int* chosen) -> int {
+        if (count <= MAX_CONTACT_POINTS) {
+            for (int i = 0; i < count; ++i) {
+                chosen[i] = i;
+            }
+            return count;
+        }
+
+        int deepest = 0;
+        for (int i = 1; i < count; ++i) {
+            if (depths[i] > depths[deepest]) {
+                deepest = i;
+            }
+        }
+
+        int farthest = deepest == 0 ? 1 : 0;
+        for (int i = 0; i < count; ++i) {
+            if (length_squared(points[i] - points[deepest])
+                > length_squared(points[farthest] - points[deepest]))
+            {
+                farthest = i;
+            }
+        }
+
+        auto signed_area = [&](int i)
+        { return dot(cross(points[farthest] - points[deepest], points[i] - points[deepest]), normal); };
+
+        int third = -1;
+        int fourth = -1;
+        for (int i = 0; i < count; ++i) {
+            if (i == deepest || i == farthest) {
+                continue;
+            }
+            if (third < 0 || signed_area(i) > signed_area(third)) {
+                third = i;
+            }
+            if (fourth < 0 || signed_area(i) < signed_area(fourth)) {
+                fourth = i;
+            }
+        }
+
+        chosen[0] = deepest;
+        chosen[1] = farthest;
+        chosen[2] = third;
+        chosen[3] = fourth;
+        return third == fourth ? 3 : 4;
+    }
+
+    // Closest points of segments p1-q1 and p2-q2 (Ericson 5.1.9).
+    void closest_segments(Vec3 p1, Vec3 q1, Vec3 p2, Vec3 q2, Vec3& c1, Vec3& c2) {
+        Vec3 const d1 = q1 - p1;
+        Vec3 const d2 = q2 - p2;
+        Vec3 const r = p1 - p2;
+        float const a = dot(d1, d1);
+        float const e = dot(d2, d2);
+        float const f = dot(d2, r);
+        float const c = dot(d1, r);
+        float const b = dot(d1, d2);
+        float const denominator = (a * e) - (b * b);
+
+        float s = denominator > 1e-12F ? std::clamp(((b * f) - (c * e)) / denominator, 0.0F, 1.0F) : 0.0F;
+        float t = ((b * s) + f) / e;
+        if (t < 0.0F) {
+            t = 0.0F;
+            s = std::clamp(-c / a, 0.0F, 1.0F);
+        } else if (t > 1.0F) {
+            t = 1.0F;
+            s = std::clamp((b - c) / a, 0.0F, 1.0F);
+        }
+
+        c1 = p1 + (d1 * s);
+        c2 = p2 + (d2 * t);
+    }
+
+    // Edge-edge contact: one point between the two edges supporting the axis.
+    void edge_contact(const Box& a, const Box& b, int axis, Vec3 normal, Vec3& point_a, Vec3& point_b) {
+        int const i = (axis - 6) / 3;
+        int const j = (axis - 6) % 3;
+
+        Vec3 edge_a = a.center;
+        Vec3 edge_b = b.center;
+        for (int k = 0; k < 3; ++k) {
+            if (k != i) {
+                edge_a += a.axes[k] * (sign(dot(a.axes[k], normal)) * a.half_extents[k]);
+            }
+            if (k != j) {
+                edge_b -= b.axes[k] * (sign(dot(b.axes[k], normal)) * b.half_extents[k]);
+            }
+        }
+
+        Vec3 const half_a = a.axes[i] * a.half_extents[i];
+        Vec3 const half_b = b.axes[j] * b.half_extents[j];
+        closest_segments(
+            edge_a - half_a, edge_a + half_a, edge_b - half_b, edge_b + half_b, point_a, point_b);
+    }
+
+    // Box against box: separating axis test, then clipping of the incident face against the reference face.
+    auto collide_boxes(const Collider& first, const Collider& second, Hint& hint, Manifold& manifold)
+        -> bool {
+        Box const a(first);
+        Box const b(second);
+        Vec3 normal;
+
+        // The axis that separated the boxes last time most likely still does.
+        if (hint.axis >= 0 && separation(a, b, hint.axis, normal) > CONTACT_MARGIN) {
+            return false;
+        }
+
+        int best_face = 0;
+        float best_face_separation = -INFINITE;
+        int best_edge = -1;
+        float best_edge_separation = -INFINITE;
+
+        for (int axis = 0; axis < 15; ++axis) {
+            float const distance = separation(a, b, axis, normal);
+            if (distance > CONTACT_MARGIN) {
+                hint.axis = axis;
+                return false;
+            }
+
+            // Faces of B need to be clearly better than faces of A, edges clearly better than faces.
+            bool const face = axis < 6;
+            float const bias = axis < 3 ? 0.0F : ABSOLUTE_TOLERANCE;
+            if (face && (axis < 3 ? distance > best_face_separation
+                                  : distance > (RELATIVE_TOLERANCE * best_face_separation) + bias))
+            {
+                best_face = axis;
+                best_face_separation = distance;
+            } else if (!face && distance > best_edge_separation) {
+                best_edge = axis;
+                best_edge_separation = distance;
+            }
+        }
+
+        bool const use_edge = best_edge >= 0
+            && best_edge_separation > (RELATIVE_TOLERANCE * best_face_separation) + ABSOLUTE_TOLERANCE;
+        int const axis = use_edge ? best_edge : best_face;
+        hint.axis = axis;
+        separation(a, b, axis, normal);
+        manifold.normal = normal;
+
+        if (use_edge) {
+            Vec3 point_a;
+            Vec3 point_b;
+            edge_contact(a, b, axis, normal, point_a, point_b);
+            manifold.points[0] = make_point(first, second, point_a, point_b, normal);
+            manifold.count = 1;
+            return true;
+        }
+
+        bool const reference_is_a = axis < 3;
+        const Box& reference = reference_is_a ? a : b;
+        const Box& incident = reference_is_a ? b : a;
+        int const face = reference_is_a ? axis : axis - 3;
+        Vec3 const face_normal = reference_is_a ? normal : -normal;
+
+        // Incident face: the face of the other box most opposed to the reference normal.
+        int incident_axis = 0;
+        float incident_dot = 0.0F;
+        for (int k = 0; k < 3; ++k) {
+            float const d = dot(incident.axes[k], face_normal);
+            if (std::fabs(d) > std::fabs(incident_dot)) {
+                incident_axis = k;
+                incident_dot = d;
+            }
+        }
+
+        Vec3 const incident_center = incident.center
+            - (incident.axes[incident_axis] * (sign(incident_dot) * incident.half_extents[incident_axis]));
+        int const u_axis = (incident_axis + 1) % 3;
+        int const v_axis = (incident_axis + 2) % 3;
+        Vec3 const u = incident.axes[u_axis] * incident.half_extents[u_axis];
+        Vec3 const v = incident.axes[v_axis] * incident.half_extents[v_axis];
+
+        Vec3 polygon[MAX_CLIPPED_POINTS] = {incident_center + u + v,
+                                            incident_center - u + v,
+                                            incident_center - u - v,
+                                            incident_center + u - v};
+        Vec3 clipped[MAX_CLIPPED_POINTS];
+        int count = 4;
+
+        for (int side = 1; side < 3; ++side) {
+            int const k = (face + side) % 3;
+            Vec3 const side_normal = reference.axes[k];
+            float const extent = reference.half_extents[k];
+
+            count = clip(polygon, count, reference.center, side_normal, extent, clipped);
+            count = clip(clipped, count, reference.center, -side_normal, extent, polygon);
+        }
+
+        Vec3 points[MAX_CLIPPED_POINTS];
+        float depths[MAX_CLIPPED_POINTS];
+        int kept = 0;
+        for (int i = 0; i < count; ++i) {
+            float const distance =
+                dot(polygon[i] - reference.center, face_normal) - reference.half_extents[face];
+            if (distance <= CONTACT_MARGIN) {
+                points[kept] = polygon[i];
+                depths[kept] = -distance;
+                ++kept;
+            }
+        }
+
+        int chosen[MAX_CONTACT_POINTS];
+        manifold.count = reduce(points, depths, kept, face_normal, chosen);
+        for (int i = 0; i < manifold.count; ++i) {
+            Vec3 const on_incident = points[chosen[i]];
+            Vec3 const on_reference = on_incident + (face_normal * depths[chosen[i]]);
+            manifold.points[i] = reference_is_a
+                ? make_point(first, second, on_reference, on_incident, normal)
+                : make_point(first, second, on_incident, on_reference, normal);
+        }
+        return manifold.count > 0;
+    }
+
+    auto query(const Collider& a, const Collider& b, Hint& hint, Manifold& manifold) -> bool {
+        manifold.count = 0;
+        if (a.shape.type == ShapeType::Box && b.shape.type == ShapeType::Box) {
+            return collide_boxes(a, b, hint, manifold);
+        }
+        return collide_convex(a, b, hint, manifold);
+    }
+
+    // Moves cached points with the bodies; drops those that separated or slid apart.
+    void refresh(Manifold& manifold, const Collider& a, const Collider& b) {
+        for (int i = 0; i < manifold.count;) {
+            ContactPoint& point = manifold.points[i];
+            Vec3 const point_a = mathematics::apply(a.transform, point.local_a);
+            Vec3 const point_b = mathematics::apply(b.transform, point.local_b);
+            Vec3 const offset = point_a - point_b;
+            float const depth = dot(offset, manifold.normal);
+            Vec3 const tangential = offset - (manifold.normal * depth);
+
+            if (depth < -CONTACT_MARGIN || length_squared(tangential) > BREAK_DISTANCE * BREAK_DISTANCE) {
+                manifold.points[i] = manifold.points[--manifold.count];
+                continue;
+            }
+
+            point.position = (point_a + point_b) * 0.5F;
+            point.depth = depth;
+            ++i;
+        }
+    }
+
+    auto matching_point(const Manifold& manifold, const ContactPoint& point) -> int {
+        for (int i = 0; i < manifold.count; ++i) {
+            if (length_squared(manifold.points[i].local_a - point.local_a)
+                < MATCH_DISTANCE * MATCH_DISTANCE)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    auto carry_impulses(ContactPoint point, const ContactPoint& previous) -> ContactPoint {
+        point.normal_impulse = previous.normal_impulse;
+        point.tangent_impulse[0] = previous.tangent_impulse[0];
+        point.tangent_impulse[1] = previous.tangent_impulse[1];
+        return point;
+    }
+
+    // Twice the area spanned by four points, approximated by the largest diagonal cross product.
+    auto quad_area(Vec3 p0, Vec3 p1, Vec3 p2, Vec3 p3) -> float {
+        float const a = length_squared(cross(p0 - p1, p2 - p3));
+        float const b = length_squared(cross(p0 - p2, p1 - p3));
+        float const c = length_squared(cross(p0 - p3, p1 - p2));
+        return std::max(a, std::max(b, c));
+    }
+
+    // Adds a point to a persistent manifold; when full, the point whose removal keeps the largest
+    // area goes, never the deepest.
+    void add_point(Manifold& manifold, const ContactPoint& point) {
+        int const match = matching_point(manifold, point);
+        if (match >= 0) {
+            manifold.points[match] = carry_impulses(point, manifold.points[match]);
+            return;
+        }
+
+        if (manifold.count < MAX_CONTACT_POINTS) {
+            manifold.points[manifold.count++] = point;
+            return;
+        }
+
+        int deepest = -1;
+        float deepest_depth = point.depth;
+        for (int i = 0; i < MAX_CONTACT_POINTS; ++i) {
+            if (manifold.points[i].depth > deepest_depth) {
+                deepest = i;
+                deepest_depth = manifold.points[i].depth;
+            }
+        }
+
+        int replaced = -1;
+        float best_area = -1.0F;
+        for (int i = 0; i < MAX_CONTACT_POINTS; ++i) {
+            if (i == deepest) {
+                continue;
+            }
+
+            Vec3 corners[MAX_CONTACT_POINTS];
+            for (int k = 0; k < MAX_CONTACT_POINTS; ++k) {
+                corners[k] = k == i ? point.local_a : manifold.points[k].local_a;
+            }
+
+            float const area = quad_area(corners[0], corners[1], corners[2], corners[3]);
+            if (area > best_area) {
+                best_area = area;
+                replaced = i;
+            }
+        }
+
+        manifold.points[replaced] = point;
+    }
+
+    // Merges a fresh query into the cached manifold. A full face manifold replaces the cached points
+    // (keeping the impulses of those it matches); single points are accumulated over frames.
+    void merge(Manifold& manifold, const Manifold& fresh) {
+        if (fresh.count > 1) {
+            ContactPoint points[MAX_CONTACT_POINTS];
+            for (int i = 0; i < fresh.count; ++i) {
+                int const match = matching_point(manifold, fresh.points[i]);
+                points[i] =
+                    match >= 0 ? carry_impulses(fresh.points[i], manifold.points[match]) : fresh.points[i];
+            }
+
+            std::copy(points, points + fresh.count, manifold.points);
+            manifold.count = fresh.count;
+            return;
+        }
+
+        for (int i = 0; i < fresh.count; ++i) {
+            add_point(manifold, fresh.points[i]);
+        }
+    }
+
+    auto pair_key(uint32_t first, uint32_t second) -> uint64_t {
+        return (static_cast<uint64_t>(first) << 32U) | second;
+    }
+
+    auto world_extents(const Mat3& rotation, Vec3 half_extents) -> Vec3 {
+        Vec3 extents;
+        for (int axis = 0; axis < 3; ++axis) {
+            extents[axis] = (std::fabs(rotation[0][axis]) * half_extents.x)
+                + (std::fabs(rotation[1][axis]) * half_extents.y)
+                + (std::fabs(rotation[2][axis]) * half_extents.z);
+        }
+        return extents;
+    }
+}    // namespace
+
+namespace physics::narrowphase {
+    ConvexHull::ConvexHull(const Vec3* points, size_t count)
+        : m_count(count) {
+        LOG_TRACE
+
+        // Padding repeats the first vertex, which never changes the support result.
+        size_t const padded = (count + WIDTH - 1) / WIDTH * WIDTH;
+        m_x.assign(padded, points[0].x);
+        m_y.assign(padded, points[0].y);
+        m_z.assign(padded, points[0].z);
+
+        m_bounds = {points[0], points[0]};
+        for (size_t i = 0; i < count; ++i) {
+            m_x[i] = points[i].x;
+            m_y[i] = points[i].y;
+            m_z[i] = points[i].z;
+            m_bounds.min = mathematics::min(m_bounds.min, points[i]);
+            m_bounds.max = mathematics::max(m_bounds.max, points[i]);
+        }
+    }
+
+    auto ConvexHull::support(Vec3 direction) const -> Vec3 {
+        auto const dx = simd::set1(direction.x);
+        auto const dy = simd::set1(direction.y);
+        auto const dz = simd::set1(direction.z);
+        auto const step = simd::set1(static_cast<float>(WIDTH));
+
+        // Per lane best projection and the index it came from (exact in float up to 2^24 vertices).
+        auto best = simd::set1(-INFINITE);
+        auto best_index = simd::zero4();
+        auto index = simd::set(0.0F, 1.0F, 2.0F, 3.0F);
+
+        for (size_t i = 0; i < m_x.size(); i += WIDTH) {
+            auto const projection = simd::madd(
+                simd::load(&m_x[i]), dx, simd::madd(simd::load(&m_y[i]), dy, simd::load(&m_z[i]) * dz));
+            auto const better = projection > best;
+            best = simd::select(better, projection, best);
+            best_index = simd::select(better, index, best_index);
+            index = index + step;
+        }
+
+        float projections[WIDTH];
+        float indices[WIDTH];
+        simd::store(projections, best);
+        simd::store(indices, best_index);
+
+        size_t lane = 0;
+        for (size_t i = 1; i < WIDTH; ++i) {
+            if (projections[i] > projections[lane]) {
+                lane = i;
+            }
+        }
+
+        auto const vertex = static_cast<size_t>(indices[lane]);
+        return {m_x[vertex], m_y[vertex], m_z[vertex]};
+    }
+
+    auto Shape::sphere(float radius) -> Shape {
+        Shape shape;
+        shape.type = ShapeType::Sphere;
+        shape.radius = radius;
+        return shape;
+    }
+
+    auto Shape::capsule(float radius, float half_height) -> Shape {
+        Shape shape;
+        shape.type = ShapeType::Capsule;
+        shape.radius = radius;
+        shape.half_height = half_height;
+        return shape;
+    }
+
+    auto Shape::box(Vec3 half_extents) -> Shape {
+        Shape shape;
+        shape.type = ShapeType::Box;
+        shape.radius = 0.0F;
+        shape.half_extents = half_extents;
+        return shape;
+    }
+
+    auto Shape::convex_hull(const ConvexHull& hull) -> Shape {
+        Shape shape;
+        shape.type = ShapeType::ConvexHull;
+        shape.radius = 0.0F;
+        shape.hull = &hull;
+        return shape;
+    }
+
+    auto bounds(const Collider& collider) -> Aabb {
+        const Shape& shape = collider.shape;
+        const Transform& transform = collider.transform;
+
+        Vec3 center = transform.position;
+        Vec3 extents;
+        switch (shape.type) {
+            case ShapeType::Sphere:
+                extents = {shape.radius, shape.radius, shape.radius};
+                break;
+            case ShapeType::Capsule: {
+                Vec3 const axis = mathematics::rotate(transform.rotation, {0.0F, shape.half_height, 0.0F});
+                Vec3 const radius {shape.radius, shape.radius, shape.radius};
+                extents = Vec3 {std::fabs(axis.x), std::fabs(axis.y), std::fabs(axis.z)} + radius;
+                break;
+            }
+            case ShapeType::Box:
+                extents = world_extents(mathematics::to_matrix(transform.rotation), shape.half_extents);
+                break;
+            case ShapeType::ConvexHull: {
+                const Aabb& local = shape.hull->bounds();
+                center = mathematics::apply(transform, mathematics::geometry::center(local));
+                extents = world_extents(mathematics::to_matrix(transform.rotation),
+                                        mathematics::geometry::extent(local) * 0.5F);
+                break;
+            }
+        }
+
+        return {center - extents, center + extents};
+    }
+
+    auto support(const Collider& collider, Vec3 direction) -> Vec3 {
+        return Support {&collider, core_radius(collider.shape)}(direction);
+    }
+
+    auto distance(const Collider& a, const Collider& b) -> DistanceResult {
+        float const radius_a = core_radius(a.shape);
+        float const radius_b = core_radius(b.shape);
+
+        Simplex simplex;
+        GjkResult const core =
+            gjk({&a, 0.0F}, {&b, 0.0F}, a.transform.position - b.transform.position, simplex);
+
+        DistanceResult result;
+        if (core.overlapping || core.distance <= radius_a + radius_b) {
+            result.overlapping = true;
+            return result;
+        }
+
+        Vec3 const normal = (core.point_b - core.point_a) * (1.0F / core.distance);
+        result.distance = core.distance - radius_a - radius_b;
+        result.point_a = core.point_a + (normal * radius_a);
+        result.point_b = core.point_b - (normal * radius_b);
+        return result;
+    }
+
+    auto collide(const Collider& a, const Collider& b, Manifold& manifold) -> bool {
+        Hint hint;
+        return query(a, b, hint, manifold);
+    }
+
+    Narrowphase::Narrowphase() {
+        LOG_TRACE
+    }
+
+    void Narrowphase::clear() {
+        m_manifolds.clear();
+        m_states.clear();
+        m_contact_count = 0;
+        m_reused_count = 0;
+    }
+
+    void Narrowphase::process(size_t index, const Collider* colliders, const uint8_t* awake) {
+        Manifold& manifold = m_manifolds[index];
+        PairState& state = m_states[index];
+
+        if (awake != nullptr && awake[manifold.first] == 0 && awake[manifold.second] == 0) {
+            state.reused = true;
+            return;
+        }
+        const Collider& a = colliders[manifold.first];
+        const Collider& b = colliders[manifold.second];
+
+        Transform const relative = mathematics::inverse(a.transform) * b.transform;
+
+        // Same relative placement as at the last query: the cached contacts are still exact.
+        if (state.cached
+            && length_squared(relative.position - state.relative.position)
+                < REUSE_DISTANCE * REUSE_DISTANCE
+            && std::fabs(dot(relative.rotation, state.relative.rotation)) > REUSE_ROTATION)
+        {
+            manifold.normal = mathematics::rotate(a.transform.rotation, state.local_normal);
+            refresh(manifold, a, b);
+            state.reused = true;
+            return;
+        }
+
+        Hint hint {mathematics::rotate(a.transform.rotation, state.search_direction), state.separating_axis};
+        Manifold fresh;
+        bool const touching = query(a, b, hint, fresh);
+
+        state.cached = true;
+        state.reused = false;
+        state.relative = relative;
+        state.search_direction = mathematics::inverse_rotate(a.transform.rotation, hint.direction);
+        state.separating_axis = hint.axis;
+
+        if (!touching) {
+            manifold.count = 0;
+            return;
+        }
+
+        manifold.normal = fresh.normal;
+        state.local_normal = mathematics::inverse_rotate(a.transform.rotation, fresh.normal);
+        refresh(manifold, a, b);
+        merge(manifold, fresh);
+    }
+
+    void Narrowphase::update(const Pair* pairs,
+                             size_t count,
+                             const Collider* colliders,
+                             kinematics::Execution execution,
+                             const uint8_t* awake) {
+        m_keys.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t const first = std::min(pairs[i].first, pairs[i].second);
+            uint32_t const second = std::max(pairs[i].first, pairs[i].second);
+            m_keys[i] = pair_key(first, second);
+        }
+        std::sort(m_keys.begin(), m_keys.end());
+        m_keys.erase(std::unique(m_keys.begin(), m_keys.end()), m_keys.end());
+
+        // Both lists are sorted by pair: pairs that stayed keep their manifold and cache entry.
+        m_next_manifolds.clear();
+        m_next_states.clear();
+        m_next_manifolds.reserve(m_keys.size());
+        m_next_states.reserve(m_keys.size());
+
+        size_t cached = 0;
+        for (uint64_t const key : m_keys) {
+            while (cached < m_manifolds.size()
+                   && pair_key(m_manifolds[cached].first, m_manifolds[cached].second) < key)
+            {
+                ++cached;
+            }
+
+            if (cached < m_manifolds.size()
+                && pair_key(m_manifolds[cached].first, m_manifolds[cached].second) == key) {
+                m_next_manifolds.push_back(m_manifolds[cached]);
+                m_next_states.push_back(m_states[cached]);
+            } else {
+                Manifold manifold;
+                manifold.first = static_cast<uint32_t>(key >> 32U);
+                manifold.second = static_cast<uint32_t>(key);
+                m_next_manifolds.push_back(manifold);
+                m_next_states.emplace_back();
+            }
+        }
+
+        m_manifolds.swap(m_next_manifolds);
+        m_states.swap(m_next_states);
+
+        auto body = [this, colliders, awake](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) {
+                process(i, colliders, awake);
+            }
+        };
+
+        if (execution == kinematics::Execution::Parallel) {
+            utils::parallel::parallel_for(m_manifolds.size(), PARALLEL_GRAIN, body);
+        } else {
+            body(0, m_manifolds.size());
+        }
+
+        m_contact_count = 0;
+        m_reused_count = 0;
+        for (size_t i = 0; i < m_manifolds.size(); ++i) {
+            m_contact_count += static_cast<size_t>(m_manifolds[i].count);
+            if (m_states[i].reused) {
+                ++m_reused_count;
+            }
+        }
+    }
+}    // namespace physics::narrowphase
@@ -0,0 +1,512 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "domkrat3d/physics/particles.hpp"
+
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+#include "domkrat3d/utils/random.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+    using physics::kinematics::ConstVec3Span;
+    using physics::kinematics::Vec3Span;
+    using physics::particles::Force;
+    using physics::particles::ForceType;
+    using physics::particles::ParticlePool;
+
+    // Particles per parallel chunk.
+    constexpr size_t PARALLEL_GRAIN = 4096;
+
+    // Particles per integration block; every pass over a block stays in L1.
+    constexpr size_t BLOCK = 256;
+
+    constexpr size_t WIDTH = static_cast<size_t>(simd::LANES);
+
+    struct Lanes3 {
+        simd::float4 x;
+        simd::float4 y;
+        simd::float4 z;
+    };
+
+    // Force fields of one step with all uniform fields folded into one vector.
+    struct Field {
+        float gravity_x = 0.0F;
+        float gravity_y = 0.0F;
+        float gravity_z = 0.0F;
+        const Force* forces = nullptr;
+        size_t count = 0;
+    };
+
+    auto make_field(const std::vector<Force>& forces) -> Field {
+        Field field;
+        field.forces = forces.data();
+        field.count = forces.size();
+
+        for (const Force& force : forces) {
+            if (force.type == ForceType::Uniform) {
+                field.gravity_x += force.x;
+                field.gravity_y += force.y;
+                field.gravity_z += force.z;
+            }
+        }
+
+        return field;
+    }
+
+    auto load_lanes(const float* src, size_t count) -> simd::float4 {
+        if (count >= WIDTH) {
+            return simd::load(src);
+        }
+
+        float padded[WIDTH] = {};
+        std::copy(src, src + count, padded);
+        return simd::load(padded);
+    }
+
+    void store_lanes(float* dst, simd::float4 value, size_t count) {
+        if (count >= WIDTH) {
+            simd::store(dst, value);
+            return;
+        }
+
+        float padded[WIDTH];
+        simd::store(padded, value);
+        std::copy(padded, padded + count, dst);
+    }
+
+    auto load_position(const ParticlePool& pool, size_t index, size_t count) -> Lanes3 {
+        return {load_lanes(&pool.px[index], count),
+                load_lanes(&pool.py[index], count),
+                load_lanes(&pool.pz[index], count)};
+    }
+
+    auto load_velocity(const ParticlePool& pool, size_t index, size_t count) -> Lanes3 {
+        return {load_lanes(&pool.vx[index], count),
+                load_lanes(&pool.vy[index], count),
+                load_lanes(&pool.vz[index], count)};
+    }
+
+    auto acceleration(const Field& field, const Lanes3& position, const Lanes3& velocity) -> Lanes3 {
+        Lanes3 result {simd::set1(field.gravity_x), simd::set1(field.gravity_y), simd::set1(field.gravity_z)};
+
+        for (size_t i = 0; i < field.count; ++i) {
+            const Force& force = field.forces[i];
+
+            switch (force.type) {
+                case ForceType::Uniform:
+                    break;
+                case ForceType::Drag: {
+                    auto const drag = simd::set1(-force.strength);
+                    result.x = simd::madd(velocity.x, drag, result.x);
+                    result.y = simd::madd(velocity.y, drag, result.y);
+                    result.z = simd::madd(velocity.z, drag, result.z);
+                    break;
+                }
+                case ForceType::Attractor: {
+                    auto const dx = simd::set1(force.x) - position.x;
+                    auto const dy = simd::set1(force.y) - position.y;
+                    auto const dz = simd::set1(force.z) - position.z;
+                    auto const softening = simd::set1(force.radius * force.radius);
+                    auto const distance2 = simd::madd(dx, dx, simd::madd(dy, dy, (dz * dz) + softening));
+                    auto const scale = simd::set1(force.strength) / (distance2 * simd::sqrt(distance2));
+                    result.x = simd::madd(dx, scale, result.x);
+                    result.y = simd::madd(dy, scale, result.y);
+                    result.z = simd::madd(dz, scale, result.z);
+                    break;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // a = F(p, v) for particles [begin, end), written to the pool.
+    void accelerate(const Field& field, ParticlePool& pool, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i += WIDTH) {
+            size_t const n = std::min(WIDTH, end - i);
+            Lanes3 const a = acceleration(field, load_position(pool, i, n), load_velocity(pool, i, n));
+
+            store_lanes(&pool.ax[i], a.x, n);
+            store_lanes(&pool.ay[i], a.y, n);
+            store_lanes(&pool.az[i], a.z, n);
+        }
+    }
+
+    auto position_span(ParticlePool& pool, size_t begin) -> Vec3Span<float> {
+        return {&pool.px[begin], &pool.py[begin], &pool.pz[begin]};
+    }
+
+    auto velocity_span(ParticlePool& pool, size_t begin) -> Vec3Span<float> {
+        return {&pool.vx[begin], &pool.vy[begin], &pool.vz[begin]};
+    }
+
+    auto const_velocity_span(const ParticlePool& pool, size_t begin) -> ConstVec3Span<float> {
+        return {&pool.vx[begin], &pool.vy[begin], &pool.vz[begin]};
+    }
+
+    auto acceleration_span(const ParticlePool& pool, size_t begin) -> ConstVec3Span<float> {
+        return {&pool.ax[begin], &pool.ay[begin], &pool.az[begin]};
+    }
+
+    // s = s + vt for particles [begin, end).
+    void drift(ParticlePool& pool, size_t begin, size_t end, float time) {
+        auto const step = simd::set1(time);
+
+        for (size_t i = begin; i < end; i += WIDTH) {
+            size_t const n = std::min(WIDTH, end - i);
+            Lanes3 const p = load_position(pool, i, n);
+            Lanes3 const v = load_velocity(pool, i, n);
+
+            store_lanes(&pool.px[i], simd::madd(v.x, step, p.x), n);
+            store_lanes(&pool.py[i], simd::madd(v.y, step, p.y), n);
+            store_lanes(&pool.pz[i], simd::madd(v.z, step, p.z), n);
+        }
+    }
+
+    // v = u + at, then s = s + vt with the updated velocity.
+    void semi_implicit_euler(const Field& field, ParticlePool& pool, size_t begin, size_t end, float time) {
+        accelerate(field, pool, begin, end);
+        physics::kinematics::calculate_final_velocity_batch(
+            velocity_span(pool, begin), acceleration_span(pool, begin), end - begin, time);
+        drift(pool, begin, end, time);
+    }
+
+    // s = s + ut + at^2/2 with the stored acceleration, then v = u + (a + a')t/2.
+    void velocity_verlet(const Field& field, ParticlePool& pool, size_t begin, size_t end, float time) {
+        namespace kinematics = physics::kinematics;
+        size_t const count = end - begin;
+        float const half_time = 0.5F * time;
+
+        kinematics::calculate_final_position_batch(position_span(pool, begin),
+                                                   const_velocity_span(pool, begin),
+                                                   acceleration_span(pool, begin),
+                                                   count,
+                                                   time);
+        kinematics::calculate_final_velocity_batch(
+            velocity_span(pool, begin), acceleration_span(pool, begin), count, half_time);
+        accelerate(field, pool, begin, end);
+        kinematics::calculate_final_velocity_batch(
+            velocity_span(pool, begin), acceleration_span(pool, begin), count, half_time);
+    }
+
+    void runge_kutta(const Field& field, ParticlePool& pool, size_t begin, size_t end, float time) {
+        auto const half_step = simd::set1(0.5F * time);
+        auto const full_step = simd::set1(time);
+        auto const sixth_step = simd::set1(time / 6.0F);
+        auto const two = simd::set1(2.0F);
+
+        for (size_t i = begin; i < end; i += WIDTH) {
+            size_t const n = std::min(WIDTH, end - i);
+            Lanes3 const p = load_position(pool, i, n);
+            Lanes3 const v = load_velocity(pool, i, n);
+
+            // Derivative of (p, v) is (v, a); each stage restarts from the step origin.
+            auto stage = [&](const Lanes3& velocity, const Lanes3& slope, simd::float4 step, Lanes3& p_out)
+            {
+                p_out = {simd::madd(velocity.x, step, p.x),
+                         simd::madd(velocity.y, step, p.y),
+                         simd::madd(velocity.z, step, p.z)};
+                return Lanes3 {simd::madd(slope.x, step, v.x),
+                               simd::madd(slope.y, step, v.y),
+                               simd::madd(slope.z, step, v.z)};
+            };
+
+            Lanes3 p2;
+            Lanes3 p3;
+            Lanes3 p4;
+            Lanes3 const a1 = acceleration(field, p, v);
+            Lanes3 const v2 = stage(v, a1, half_step, p2);
+            Lanes3 const a2 = acceleration(field, p2, v2);
+            Lanes3 const v3 = stage(v2, a2, half_step, p3);
+            Lanes3 const a3 = acceleration(field, p3, v3);
+            Lanes3 const v4 = stage(v3, a3, full_step, p4);
+            Lanes3 const a4 = acceleration(field, p4, v4);
+
+            auto weigh = [&](simd::float4 k1, simd::float4 k2, simd::float4 k3, simd::float4 k4)
+            { return simd::madd(k2 + k3, two, k1 + k4) * sixth_step; };
+
+            store_lanes(&pool.px[i], p.x + weigh(v.x, v2.x, v3.x, v4.x), n);
+            store_lanes(&pool.py[i], p.y + weigh(v.y, v2.y, v3.y, v4.y), n);
+            store_lanes(&pool.pz[i], p.z + weigh(v.z, v2.z, v3.z, v4.z), n);
+            store_lanes(&pool.vx[i], v.x + weigh(a1.x, a2.x, a3.x, a4.x), n);
+            store_lanes(&pool.vy[i], v.y + weigh(a1.y, a2.y, a3.y, a4.y), n);
+            store_lanes(&pool.vz[i], v.z + weigh(a1.z, a2.z, a3.z, a4.z), n);
+            store_lanes(&pool.ax[i], a1.x, n);
+            store_lanes(&pool.ay[i], a1.y, n);
+            store_lanes(&pool.az[i], a1.z, n);
+        }
+    }
+
+    void add_age(ParticlePool& pool, size_t begin, size_t end, float time) {
+        auto const step = simd::set1(time);
+        size_t i = begin;
+
+        for (; i + WIDTH <= end; i += WIDTH) {
+            simd::store(&pool.age[i], simd::load(&pool.age[i]) + step);
+        }
+
+        for (; i < end; ++i) {
+            pool.age[i] += time;
+        }
+    }
+}    // namespace
+
+namespace physics::particles {
+    void ParticlePool::reserve(size_t capacity) {
+        LOG_TRACE
+
+        for (auto* component : {&px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &age, &lifetime}) {
+            component->resize(capacity, 0.0F);
+        }
+
+        size = std::min(size, capacity);
+    }
+
+    void ParticlePool::swap_remove(size_t index) {
+        size_t const last = --size;
+
+        px[index] = px[last];
+        py[index] = py[last];
+        pz[index] = pz[last];
+        vx[index] = vx[last];
+        vy[index] = vy[last];
+        vz[index] = vz[last];
+        ax[index] = ax[last];
+        ay[index] = ay[last];
+        az[index] = az[last];
+        age[index] = age[last];
+        lifetime[index] = lifetime[last];
+    }
+
+    ParticleSystem::ParticleSystem(size_t capacity, uint64_t seed)
+        : m_scratch(capacity)
+        , m_engine(seed) {
+        LOG_TRACE
+
+        m_pool.reserve(capacity);
+    }
+
+    auto ParticleSystem::add_emitter(const Emitter& emitter) -> size_t {
+        LOG_TRACE
+
+        m_emitters.push_back(emitter);
+        return m_emitters.size() - 1;
+    }
+
+    auto ParticleSystem::emitter(size_t index) -> Emitter& {
+        return m_emitters.at(index);
+    }
+
+    void ParticleSystem::add_force(const Force& force) {
+        LOG_TRACE
+
+        m_forces.push_back(force);
+    }
+
+    void ParticleSystem::clear_forces() {
+        LOG_TRACE
+
+        m_forces.clear();
+    }
+
+    void ParticleSystem::set_integrator(Integrator integrator) {
+        m_integrator = integrator;
+    }
+
+    void ParticleSystem::set_fixed_step(float step, int max_substeps) {
+        m_fixed_step = step;
+        m_max_substeps = std::max(max_substeps, 1);
+    }
+
+    void ParticleSystem::set_execution(kinematics::Execution execution) {
+        m_execution = execution;
+    }
+
+    auto ParticleSystem::emit(const Emitter& emitter, size_t count) -> size_t {
+        count = std::min(count, m_pool.capacity() - m_pool.size);
+        spawn(emitter, count);
+        return count;
+    }
+
+    auto ParticleSystem::update(float frame_time) -> int {
+        m_accumulator += frame_time;
+
+        int steps = 0;
+        while (m_accumulator >= m_fixed_step && steps < m_max_substeps) {
+            step(m_fixed_step);
+            m_accumulator -= m_fixed_step;
+            ++steps;
+        }
+
+        if (steps == m_max_substeps) {
+            m_accumulator = std::min(m_accumulator, m_fixed_step);
+        }
+
+        return steps;
+    }
+
+    void ParticleSystem::pools(std::vector<snapshot::Pool>& pools) {
+        size_t const bytes = m_pool.capacity() * sizeof(float);
+        for (auto* values : {&m_pool.px,
+                             &m_pool.py,
+                             &m_pool.pz,
+                             &m_pool.vx,
+                             &m_pool.vy,
+                             &m_pool.vz,
+                             &m_pool.ax,
+                             &m_pool.ay,
+                             &m_pool.az,
+                             &m_pool.age,
+                             &m_pool.lifetime})
+        {
+            pools.push_back({values->data(), bytes});
+        }
+        pools.push_back({&m_pool.size, sizeof(m_pool.size)});
+        pools.push_back({m_emitters.data(), m_emitters.size() * sizeof(Emitter)});
+        pools.push_back({&m_engine, sizeof(m_engine)});
+        pools.push_back({&m_accumulator, sizeof(m_accumulator)});
+    }
+
+    void ParticleSystem::step(float time) {
+        for (Emitter& emitter : m_emitters) {
+            if (!emitter.enabled) {
+                continue;
+            }
+
+            emitter.accumulator += emitter.rate * time;
+            float const whole = std::floor(emitter.accumulator);
+            emitter.accumulator -= whole;
+
+            size_t const count = std::min(static_cast<size_t>(whole), m_pool.capacity() - m_pool.size);
+            spawn(emitter, count);
+        }
+
+        integrate(time);
+        compact();
+    }
+
+    void ParticleSystem::spawn(const Emitter& emitter, size_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        size_t const begin = m_pool.size;
+        float* px = &m_pool.px[begin];
+        float* py = &m_pool.py[begin];
+        float* pz = &m_pool.pz[begin];
+        float* vx = &m_pool.vx[begin];
+        float* vy = &m_pool.vy[begin];
+        float* vz = &m_pool.vz[begin];
+
+        if (emitter.radius > 0.0F) {
+            // The cube root spreads points evenly through the volume instead of crowding the center.
+            utils::random::fill_unit_sphere(m_engine, px, py, pz, count);
+            utils::random::fill_uniform(m_engine, m_scratch.data(), count, 0.0F, 1.0F);
+            for (size_t i = 0; i < count; ++i) {
+                m_scratch[i] = emitter.radius * std::cbrt(m_scratch[i]);
+            }
+        } else {
+            std::fill_n(px, count, 0.0F);
+            std::fill_n(py, count, 0.0F);
+            std::fill_n(pz, count, 0.0F);
+            std::fill_n(m_scratch.data(), count, 0.0F);
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            px[i] = emitter.x + (px[i] * m_scratch[i]);
+            py[i] = emitter.y + (py[i] * m_scratch[i]);
+            pz[i] = emitter.z + (pz[i] * m_scratch[i]);
+        }
+
+        if (emitter.shape == EmitterShape::Hemisphere) {
+            utils::random::fill_hemisphere(
+                m_engine, vx, vy, vz, count, emitter.direction_x, emitter.direction_y, emitter.direction_z);
+        } else {
+            utils::random::fill_unit_sphere(m_engine, vx, vy, vz, count);
+        }
+
+        utils::random::fill_uniform(m_engine, m_scratch.data(), count, emitter.min_speed, emitter.max_speed);
+        for (size_t i = 0; i < count; ++i) {
+            vx[i] *= m_scratch[i];
+            vy[i] *= m_scratch[i];
+            vz[i] *= m_scratch[i];
+        }
+
+        utils::random::fill_uniform(
+            m_engine, &m_pool.lifetime[begin], count, emitter.min_lifetime, emitter.max_lifetime);
+        std::fill_n(&m_pool.age[begin], count, 0.0F);
+
+        m_pool.size += count;
+
+        // Verlet needs an acceleration from before the first step.
+        accelerate(make_field(m_forces), m_pool, begin, m_pool.size);
+    }
+
+    void ParticleSystem::integrate(float time) {
+        Field const field = make_field(m_forces);
+        Integrator const integrator = m_integrator;
+        ParticlePool& pool = m_pool;
+
+        auto body = [&](size_t begin, size_t end)
+        {
+            for (size_t block = begin; block < end; block += BLOCK) {
+                size_t const block_end = std::min(block + BLOCK, end);
+
+                switch (integrator) {
+                    case Integrator::SemiImplicitEuler:
+                        semi_implicit_euler(field, pool, block, block_end, time);
+                        break;
+                    case Integrator::VelocityVerlet:
+                        velocity_verlet(field, pool, block, block_end, time);
+                        break;
+                    case Integrator::Rk4:
+                        runge_kutta(field, pool, block, block_end, time);
+                        break;
+                }
+
+                add_age(pool, block, block_end, time);
+            }
+        };
+
+        if (m_execution == kinematics::Execution::Parallel) {
+            utils::parallel::parallel_for(pool.size, PARALLEL_GRAIN, body);
+        } else {
+            body(0, pool.size);
+        }
+    }
+
+    void ParticleSystem::compact() {
+        size_t i = 0;
+
+        while (i + WIDTH <= m_pool.size) {
+            auto const expired = simd::load(&m_pool.age[i]) >= simd::load(&m_pool.lifetime[i]);
+            if (!simd::any(expired)) {
+                i += WIDTH;
+                continue;
+            }
+
+            // Slow path for the group: a removed slot is refilled from the end and rechecked.
+            size_t const group_end = i + WIDTH;
+            while (i < group_end && i < m_pool.size) {
+                if (m_pool.age[i] >= m_pool.lifetime[i]) {
+                    m_pool.swap_remove(i);
+                } else {
+                    ++i;
+                }
+            }
+        }
+
+        while (i < m_pool.size) {
+            if (m_pool.age[i] >= m_pool.lifetime[i]) {
+                m_pool.swap_remove(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+}    // namespace physics::particles
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/physics/simulation.hpp"
+
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    using physics::simulation::Clock;
+
+    auto step_duration(double rate) -> Clock::duration {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    }
+}    // namespace
+
+namespace physics::simulation {
+    Simulation::Simulation(dynamics::World& world, const Settings& settings)
+        : m_world(world)
+        , m_settings(settings)
+        , m_step_time(static_cast<float>(1.0 / settings.rate))
+        , m_step_duration(step_duration(settings.rate)) {
+        LOG_TRACE
+    }
+
+    Simulation::~Simulation() {
+        stop();
+    }
+
+    void Simulation::start() {
+        LOG_TRACE
+
+        if (m_thread.joinable()) {
+            return;
+        }
+
+        m_stop.store(false, std::memory_order_relaxed);
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    void Simulation::stop() {
+        if (!m_thread.joinable()) {
+            return;
+        }
+
+        m_stop.store(true, std::memory_order_relaxed);
+        m_thread.join();
+    }
+
+    void Simulation::advance(int count) {
+        for (int i = 0; i < count; ++i) {
+            step(Clock::now());
+        }
+    }
+
+    auto Simulation::update(Clock::time_point now) -> int {
+        if (!m_scheduled) {
+            m_next = now + m_step_duration;
+            m_scheduled = true;
+            return 0;
+        }
+
+        // Catch up on missed steps, but only so far; the rest of the backlog is dropped.
+        int steps = 0;
+        for (; m_next <= now && steps < m_settings.max_steps_per_update; ++steps) {
+            step(m_next);
+            m_next += m_step_duration;
+        }
+        if (m_next <= now) {
+            m_next = now + (m_step_duration / 2);
+        }
+        return steps;
+    }
+
+    void Simulation::run() {
+        m_scheduled = false;
+        update(Clock::now());
+
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_until(m_next);
+            update(Clock::now());
+        }
+    }
+
+    void Simulation::step(Clock::time_point time) {
+        size_t const count = m_world.body_count();
+        if (m_last.size() != count) {
+            m_last.resize(count);
+            for (dynamics::BodyId body = 0; body < count; ++body) {
+                m_last[body] = m_world.transform(body);
+            }
+        }
+
+        m_world.step(m_step_time);
+        ++m_step_count;
+
+        // The slots are reused, so after the first few steps publishing only copies.
+        Snapshot& snapshot = m_snapshots.back();
+        snapshot.previous.assign(m_last.begin(), m_last.end());
+        for (dynamics::BodyId body = 0; body < count; ++body) {
+            m_last[body] = m_world.transform(body);
+        }
+        snapshot.current.assign(m_last.begin(), m_last.end());
+        snapshot.step = m_step_count;
+        snapshot.time = time;
+        m_snapshots.publish();
+    }
+
+    auto Simulation::interpolate(Clock::time_point now, std::vector<Transform>& transforms) -> bool {
+        m_snapshots.update();
+        const Snapshot& snapshot = m_snapshots.front();
+        if (snapshot.step == 0) {
+            return false;
+        }
+
+        // Drawn one step behind, at now - step: `previous` stands for time - step, `current` for time.
+        std::chrono::duration<float> const behind = now - snapshot.time;
+        float const t = std::clamp(behind.count() / m_step_time, 0.0F, 1.0F);
+
+        transforms.resize(snapshot.current.size());
+        for (size_t body = 0; body < transforms.size(); ++body) {
+            transforms[body] = mathematics::interpolate(snapshot.previous[body], snapshot.current[body], t);
+        }
+        return true;
+    }
+}    // namespace physics::simulation
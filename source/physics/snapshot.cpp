@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "domkrat3d/physics/snapshot.hpp"
+
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    using physics::snapshot::Pool;
+
+    // Words covered by one mask word.
+    constexpr size_t BLOCK = 32;
+
+    auto word_count(size_t bytes) -> size_t {
+        return (bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    }
+
+    auto block_count(size_t words) -> size_t {
+        return (words + BLOCK - 1) / BLOCK;
+    }
+
+    // Packs the XOR of a pool with its previous image (or, for a keyframe, the pool itself) and
+    // stores the pool as the new image. Every word is written to the output and the cursor only
+    // advances past non-zero ones, which keeps the loop free of branches.
+    template<bool KEYFRAME>
+    auto encode(const Pool& pool, uint32_t* image, uint32_t* cursor) -> uint32_t* {
+        auto const* bytes = static_cast<const uint8_t*>(pool.data);
+        size_t const words = word_count(pool.size);
+        uint32_t block[BLOCK];
+
+        for (size_t base = 0; base < words; base += BLOCK) {
+            size_t const count = std::min(BLOCK, words - base);
+            size_t const offset = base * sizeof(uint32_t);
+            size_t const length = std::min(BLOCK * sizeof(uint32_t), pool.size - offset);
+            if (length < sizeof(block)) {
+                std::fill(block, block + BLOCK, 0U);
+            }
+            std::memcpy(block, bytes + offset, length);
+
+            uint32_t* const mask_slot = cursor++;
+            uint32_t mask = 0;
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t const delta = KEYFRAME ? block[i] : block[i] ^ image[base + i];
+                image[base + i] = block[i];
+                *cursor = delta;
+                cursor += delta != 0 ? 1 : 0;
+                mask |= (delta != 0 ? 1U : 0U) << i;
+            }
+            *mask_slot = mask;
+        }
+        return cursor;
+    }
+
+    // XORs one packed frame into an image.
+    void apply(const uint32_t* packed, const std::vector<size_t>& layout, uint32_t* image) {
+        for (size_t const size : layout) {
+            size_t const words = word_count(size);
+            for (size_t base = 0; base < words; base += BLOCK) {
+                uint32_t mask = *packed++;
+                for (size_t i = base; mask != 0; ++i, mask >>= 1U) {
+                    if ((mask & 1U) != 0) {
+                        image[i] ^= *packed++;
+                    }
+                }
+            }
+            image += words;
+        }
+    }
+}    // namespace
+
+namespace physics::snapshot {
+    SnapshotRing::SnapshotRing(size_t capacity, size_t keyframe_interval)
+        : m_frames(std::max<size_t>(capacity, 1))
+        , m_keyframe_interval(std::clamp<size_t>(keyframe_interval, 1, m_frames.size())) {
+        LOG_TRACE
+    }
+
+    auto SnapshotRing::same_layout(const std::vector<Pool>& pools) const -> bool {
+        if (pools.size() != m_layout.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < pools.size(); ++i) {
+            if (pools[i].size != m_layout[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto SnapshotRing::capture(const std::vector<Pool>& pools) -> uint64_t {
+        uint64_t const frame = m_next;
+
+        if (!same_layout(pools)) {
+            m_layout.clear();
+            size_t words = 0;
+            for (const Pool& pool : pools) {
+                m_layout.push_back(pool.size);
+                words += word_count(pool.size);
+            }
+            m_raw.assign(words, 0U);
+            m_start = frame;
+        }
+
+        bool const keyframe = frame == m_start || frame - m_last_keyframe >= m_keyframe_interval;
+        size_t worst = 0;
+        for (size_t const size : m_layout) {
+            worst += word_count(size) + block_count(word_count(size));
+        }
+
+        // Slots only grow, so once the ring went round capturing neither allocates nor clears memory.
+        Frame& target = slot(frame);
+        if (target.words.size() < worst) {
+            target.words.resize(worst);
+        }
+        target.keyframe = keyframe;
+
+        uint32_t* cursor = target.words.data();
+        uint32_t* image = m_raw.data();
+        for (const Pool& pool : pools) {
+            cursor = keyframe ? encode<true>(pool, image, cursor) : encode<false>(pool, image, cursor);
+            image += word_count(pool.size);
+        }
+        target.count = static_cast<size_t>(cursor - target.words.data());
+
+        if (keyframe) {
+            m_last_keyframe = frame;
+        }
+        m_next = frame + 1;
+        return frame;
+    }
+
+    auto SnapshotRing::first_frame() const -> uint64_t {
+        uint64_t const capacity = m_frames.size();
+        uint64_t frame = m_next - m_start > capacity ? m_next - capacity : m_start;
+
+        // A delta is useless once its keyframe was overwritten.
+        while (frame < m_next && !slot(frame).keyframe) {
+            ++frame;
+        }
+        return frame;
+    }
+
+    auto SnapshotRing::contains(uint64_t frame) const -> bool {
+        return !empty() && frame < m_next && frame >= first_frame();
+    }
+
+    auto SnapshotRing::packed_bytes(uint64_t frame) const -> size_t {
+        return contains(frame) ? slot(frame).count * sizeof(uint32_t) : 0;
+    }
+
+    void SnapshotRing::decode(uint64_t frame, std::vector<uint32_t>& image) const {
+        uint64_t keyframe = frame;
+        while (!slot(keyframe).keyframe) {
+            --keyframe;
+        }
+
+        image.assign(m_raw.size(), 0U);
+        for (uint64_t step = keyframe; step <= frame; ++step) {
+            apply(slot(step).words.data(), m_layout, image.data());
+        }
+    }
+
+    auto SnapshotRing::restore(uint64_t frame, const std::vector<Pool>& pools) -> bool {
+        if (!contains(frame) || !same_layout(pools)) {
+            return false;
+        }
+
+        // The raw image already holds the newest frame; older ones are rebuilt from their keyframe.
+        if (frame != last_frame()) {
+            decode(frame, m_image);
+            m_raw.swap(m_image);
+        }
+
+        const uint32_t* image = m_raw.data();
+        for (const Pool& pool : pools) {
+            if (pool.size > 0) {
+                std::memcpy(pool.data, image, pool.size);
+            }
+            image += word_count(pool.size);
+        }
+
+        // Slots of the dropped frames still hold them until they are captured over, so the frames
+        // older than the ring held before the rewind stay lost.
+        uint64_t const capacity = m_frames.size();
+        if (m_next - m_start > capacity) {
+            m_start = m_next - capacity;
+        }
+        m_next = frame + 1;
+        m_last_keyframe = frame;
+        while (!slot(m_last_keyframe).keyframe) {
+            --m_last_keyframe;
+        }
+        return true;
+    }
+}    // namespace physics::snapshot
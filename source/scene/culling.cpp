@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "domkrat3d/scene/culling.hpp"
+
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+
+    using mathematics::Mat4;
+    using mathematics::Vec3;
+    using mathematics::geometry::Plane;
+    using scene::culling::CULL_CHUNK;
+    using scene::culling::Frustum;
+
+    constexpr size_t WIDTH = 4;
+    constexpr size_t PLANE_COUNT = 6;
+
+    auto padded(size_t count) -> size_t {
+        return (count + WIDTH - 1) / WIDTH * WIDTH;
+    }
+
+    // Plane a * x + b * y + c * z + d >= 0 scaled to a unit normal.
+    auto unit_plane(const float coefficients[4]) -> Plane {
+        Vec3 const normal {coefficients[0], coefficients[1], coefficients[2]};
+        float const scale = 1.0F / mathematics::length(normal);
+        return {normal * scale, coefficients[3] * scale};
+    }
+
+    // Planes broadcast once per cull instead of once per group of four objects.
+    struct WidePlanes {
+        simd::float4 x[PLANE_COUNT];
+        simd::float4 y[PLANE_COUNT];
+        simd::float4 z[PLANE_COUNT];
+        simd::float4 d[PLANE_COUNT];
+    };
+
+    auto widen(const Frustum& frustum) -> WidePlanes {
+        WidePlanes wide {};
+        for (size_t p = 0; p < PLANE_COUNT; ++p) {
+            wide.x[p] = simd::set1(frustum.planes[p].normal.x);
+            wide.y[p] = simd::set1(frustum.planes[p].normal.y);
+            wide.z[p] = simd::set1(frustum.planes[p].normal.z);
+            wide.d[p] = simd::set1(frustum.planes[p].distance);
+        }
+        return wide;
+    }
+
+    // Lanes of a group of four that exist; the last group of an array may be partial.
+    auto valid_lanes(size_t index, size_t count) -> int {
+        size_t const remaining = count - index;
+        return remaining >= WIDTH ? 0xF : (1 << remaining) - 1;
+    }
+
+    // Append the indices of the set lanes without branching on them; out needs room for four.
+    auto append(int mask, uint32_t index, uint32_t* out) -> size_t {
+        size_t written = 0;
+        for (uint32_t lane = 0; lane < WIDTH; ++lane) {
+            out[written] = index + lane;
+            written += static_cast<size_t>((mask >> lane) & 1);
+        }
+        return written;
+    }
+
+    /*
+     * Run a chunk test over [0, count) and compact the result. test(begin, end, out) writes
+     * the visible indices of a chunk to out, which has room for the padded chunk, and
+     * returns how many it wrote; chunks write where they start, then move down in order.
+     */
+    template<typename Test>
+    void cull_chunks(size_t count,
+                     std::vector<uint32_t>& visible,
+                     utils::jobs::JobSystem& jobs,
+                     Test&& test) {
+        size_t const chunk_count = (count + CULL_CHUNK - 1) / CULL_CHUNK;
+        std::vector<size_t> written(chunk_count, 0);
+        visible.resize(padded(count));
+
+        auto const body = [count, &visible, &written, &test](size_t begin, size_t end)
+        {
+            for (size_t chunk = begin; chunk < end; ++chunk) {
+                size_t const first = chunk * CULL_CHUNK;
+                written[chunk] = test(first, std::min(first + CULL_CHUNK, count), visible.data() + first);
+            }
+        };
+        utils::parallel::parallel_for(jobs, chunk_count, 1, body);
+
+        size_t total = 0;
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            if (total != chunk * CULL_CHUNK) {
+                auto const source = visible.begin() + static_cast<std::ptrdiff_t>(chunk * CULL_CHUNK);
+                std::copy(source,
+                          source + static_cast<std::ptrdiff_t>(written[chunk]),
+                          visible.begin() + static_cast<std::ptrdiff_t>(total));
+            }
+            total += written[chunk];
+        }
+        visible.resize(total);
+    }
+}    // namespace
+
+namespace scene::culling {
+    auto extract_frustum(const Mat4& view_projection) -> Frustum {
+        float rows[4][4];
+        for (int row = 0; row < 4; ++row) {
+            for (int column = 0; column < 4; ++column) {
+                rows[row][column] = view_projection.columns[column][row];
+            }
+        }
+
+        // Clip space keeps -w <= x, y <= w and 0 <= z <= w; each inequality is a plane.
+        float planes[PLANE_COUNT][4];
+        for (int column = 0; column < 4; ++column) {
+            planes[0][column] = rows[3][column] + rows[0][column];
+            planes[1][column] = rows[3][column] - rows[0][column];
+            planes[2][column] = rows[3][column] + rows[1][column];
+            planes[3][column] = rows[3][column] - rows[1][column];
+            planes[4][column] = rows[2][column];
+            planes[5][column] = rows[3][column] - rows[2][column];
+        }
+
+        Frustum frustum;
+        for (size_t p = 0; p < PLANE_COUNT; ++p) {
+            frustum.planes[p] = unit_plane(planes[p]);
+        }
+        return frustum;
+    }
+
+    auto SphereArray::add(Vec3 center, float radius) -> uint32_t {
+        auto const index = static_cast<uint32_t>(m_size++);
+        size_t const size = padded(m_size);
+        m_x.resize(size);
+        m_y.resize(size);
+        m_z.resize(size);
+        m_radius.resize(size);
+        set(index, center, radius);
+        return index;
+    }
+
+    void SphereArray::set(uint32_t index, Vec3 center, float radius) {
+        m_x[index] = center.x;
+        m_y[index] = center.y;
+        m_z[index] = center.z;
+        m_radius[index] = radius;
+    }
+
+    void SphereArray::clear() {
+        m_size = 0;
+        m_x.clear();
+        m_y.clear();
+        m_z.clear();
+        m_radius.clear();
+    }
+
+    auto BoxArray::add(const Aabb& box) -> uint32_t {
+        auto const index = static_cast<uint32_t>(m_size++);
+        size_t const size = padded(m_size);
+        m_min_x.resize(size);
+        m_min_y.resize(size);
+        m_min_z.resize(size);
+        m_max_x.resize(size);
+        m_max_y.resize(size);
+        m_max_z.resize(size);
+        set(index, box);
+        return index;
+    }
+
+    void BoxArray::set(uint32_t index, const Aabb& box) {
+        m_min_x[index] = box.min.x;
+        m_min_y[index] = box.min.y;
+        m_min_z[index] = box.min.z;
+        m_max_x[index] = box.max.x;
+        m_max_y[index] = box.max.y;
+        m_max_z[index] = box.max.z;
+    }
+
+    void BoxArray::clear() {
+        m_size = 0;
+        m_min_x.clear();
+        m_min_y.clear();
+        m_min_z.clear();
+        m_max_x.clear();
+        m_max_y.clear();
+        m_max_z.clear();
+    }
+
+    void cull(const Frustum& frustum,
+              const SphereArray& spheres,
+              std::vector<uint32_t>& visible,
+              utils::jobs::JobSystem& jobs) {
+        WidePlanes const planes = widen(frustum);
+        size_t const count = spheres.size();
+
+        auto const test = [&planes, &spheres, count](size_t begin, size_t end, uint32_t* out) -> size_t
+        {
+            size_t written = 0;
+            for (size_t i = begin; i < end; i += WIDTH) {
+                auto const x = simd::load(spheres.x() + i);
+                auto const y = simd::load(spheres.y() + i);
+                auto const z = simd::load(spheres.z() + i);
+                auto const negative_radius = -simd::load(spheres.radii() + i);
+
+                // A sphere is outside once its center is farther than its radius behind a plane.
+                auto inside = simd::zero4() == simd::zero4();
+                for (size_t p = 0; p < PLANE_COUNT; ++p) {
+                    auto const distance =
+                        (planes.x[p] * x) + (planes.y[p] * y) + (planes.z[p] * z) + planes.d[p];
+                    inside = inside & (distance >= negative_radius);
+                }
+                int const mask = simd::movemask(inside) & valid_lanes(i, count);
+                written += append(mask, static_cast<uint32_t>(i), out + written);
+            }
+            return written;
+        };
+        cull_chunks(count, visible, jobs, test);
+    }
+
+    void cull(const Frustum& frustum,
+              const BoxArray& boxes,
+              std::vector<uint32_t>& visible,
+              utils::jobs::JobSystem& jobs) {
+        WidePlanes const planes = widen(frustum);
+        size_t const count = boxes.size();
+
+        // The corner of every box farthest along a normal is picked per plane, not per box.
+        const float* corner_x[PLANE_COUNT];
+        const float* corner_y[PLANE_COUNT];
+        const float* corner_z[PLANE_COUNT];
+        for (size_t p = 0; p < PLANE_COUNT; ++p) {
+            Vec3 const normal = frustum.planes[p].normal;
+            corner_x[p] = normal.x >= 0.0F ? boxes.max_x() : boxes.min_x();
+            corner_y[p] = normal.y >= 0.0F ? boxes.max_y() : boxes.min_y();
+            corner_z[p] = normal.z >= 0.0F ? boxes.max_z() : boxes.min_z();
+        }
+
+        auto const test = [&](size_t begin, size_t end, uint32_t* out) -> size_t
+        {
+            size_t written = 0;
+            for (size_t i = begin; i < end; i += WIDTH) {
+                auto inside = simd::zero4() == simd::zero4();
+                for (size_t p = 0; p < PLANE_COUNT; ++p) {
+                    auto const distance = (planes.x[p] * simd::load(corner_x[p] + i))
+                                          + (planes.y[p] * simd::load(corner_y[p] + i))
+                                          + (planes.z[p] * simd::load(corner_z[p] + i)) + planes.d[p];
+                    inside = inside & (distance >= simd::zero4());
+                }
+                int const mask = simd::movemask(inside) & valid_lanes(i, count);
+                written += append(mask, static_cast<uint32_t>(i), out + written);
+            }
+            return written;
+        };
+        cull_chunks(count, visible, jobs, test);
+    }
+
+    void cull(const Frustum& frustum, const physics::bvh::Bvh& bvh, std::vector<uint32_t>& visible) {
+        visible.clear();
+        bvh.overlap(frustum.planes, PLANE_COUNT, visible);
+        std::sort(visible.begin(), visible.end());
+    }
+}    // namespace scene::culling
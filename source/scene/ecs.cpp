@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "domkrat3d/scene/ecs.hpp"
+
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    using scene::ecs::Archetype;
+    using scene::ecs::ComponentId;
+    using scene::ecs::ComponentInfo;
+    using scene::ecs::ComponentMask;
+    using scene::ecs::Entity;
+    using scene::ecs::MAX_COMPONENTS;
+
+    constexpr size_t CACHE_LINE = 64;
+
+    // Entries are written once before the count is published, so lookups need no lock.
+    struct Registry {
+        std::mutex mutex;
+        std::array<ComponentInfo, MAX_COMPONENTS> infos {};
+        std::atomic<size_t> count {0};
+    };
+
+    auto registry() -> Registry& {
+        static Registry instance;
+        return instance;
+    }
+
+    auto align_up(size_t value, size_t alignment) -> size_t {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Offsets of the component arrays for a number of rows; returns the bytes used.
+    auto lay_out(Archetype& archetype, uint32_t rows) -> size_t {
+        size_t offset = align_up(rows * sizeof(Entity), CACHE_LINE);
+        for (ComponentId const component : archetype.components) {
+            ComponentInfo const info = scene::ecs::component_info(component);
+            offset = align_up(offset, std::max(info.alignment, CACHE_LINE));
+            archetype.offsets[component] = static_cast<uint32_t>(offset);
+            offset += rows * info.size;
+        }
+        return offset;
+    }
+
+    auto allocate_chunk() -> std::byte* {
+        return static_cast<std::byte*>(::operator new(scene::ecs::CHUNK_SIZE, std::align_val_t {CACHE_LINE}));
+    }
+
+    void free_chunk(std::byte* data) {
+        ::operator delete(data, std::align_val_t {CACHE_LINE});
+    }
+}    // namespace
+
+namespace scene::ecs {
+    auto register_component(size_t size, size_t alignment) -> ComponentId {
+        Registry& components = registry();
+        std::lock_guard<std::mutex> const guard(components.mutex);
+
+        size_t const id = components.count.load(std::memory_order_relaxed);
+        if (id == MAX_COMPONENTS) {
+            throw std::length_error("too many component types");
+        }
+
+        components.infos[id] = {size, alignment};
+        components.count.store(id + 1, std::memory_order_release);
+        return static_cast<ComponentId>(id);
+    }
+
+    auto component_info(ComponentId component) -> ComponentInfo {
+        return registry().infos[component];
+    }
+
+    World::World() {
+        LOG_TRACE
+
+        find_archetype(0);
+    }
+
+    World::~World() {
+        for (auto& archetype : m_archetypes) {
+            for (Chunk& chunk : archetype->chunks) {
+                free_chunk(chunk.data);
+            }
+        }
+        for (std::byte* const data : m_free_chunks) {
+            free_chunk(data);
+        }
+    }
+
+    auto World::find_archetype(ComponentMask mask) -> uint32_t {
+        auto const found = m_archetype_index.find(mask);
+        if (found != m_archetype_index.end()) {
+            return found->second;
+        }
+
+        auto archetype = std::make_unique<Archetype>();
+        archetype->mask = mask;
+        for (ComponentId component = 0; component < MAX_COMPONENTS; ++component) {
+            if (((mask >> component) & 1U) != 0) {
+                archetype->components.push_back(component);
+            }
+        }
+        archetype->offsets.fill(Archetype::ABSENT);
+        archetype->add_edges.fill(Archetype::ABSENT);
+        archetype->remove_edges.fill(Archetype::ABSENT);
+
+        // Start from the row count ignoring padding and give up rows until the layout fits.
+        size_t row_bytes = sizeof(Entity);
+        for (ComponentId const component : archetype->components) {
+            row_bytes += component_info(component).size;
+        }
+        auto rows = static_cast<uint32_t>(CHUNK_SIZE / row_bytes);
+        while (rows > 1 && lay_out(*archetype, rows) > CHUNK_SIZE) {
+            --rows;
+        }
+        if (rows == 0 || lay_out(*archetype, rows) > CHUNK_SIZE) {
+            throw std::length_error("components of an entity do not fit in a chunk");
+        }
+        archetype->capacity = rows;
+
+        auto const index = static_cast<uint32_t>(m_archetypes.size());
+        m_archetypes.push_back(std::move(archetype));
+        m_archetype_index.emplace(mask, index);
+        return index;
+    }
+
+    auto World::add_edge(uint32_t archetype, ComponentId component) -> uint32_t {
+        if (m_archetypes[archetype]->add_edges[component] == Archetype::ABSENT) {
+            ComponentMask const mask = m_archetypes[archetype]->mask | ComponentMask {1} << component;
+            uint32_t const target = find_archetype(mask);
+            m_archetypes[archetype]->add_edges[component] = target;
+        }
+        return m_archetypes[archetype]->add_edges[component];
+    }
+
+    auto World::remove_edge(uint32_t archetype, ComponentId component) -> uint32_t {
+        if (m_archetypes[archetype]->remove_edges[component] == Archetype::ABSENT) {
+            ComponentMask const mask = m_archetypes[archetype]->mask & ~(ComponentMask {1} << component);
+            uint32_t const target = find_archetype(mask);
+            m_archetypes[archetype]->remove_edges[component] = target;
+        }
+        return m_archetypes[archetype]->remove_edges[component];
+    }
+
+    auto World::chunk_count() const -> size_t {
+        size_t count = 0;
+        for (const auto& archetype : m_archetypes) {
+            count += archetype->chunks.size();
+        }
+        return count;
+    }
+
+    auto World::allocate_row(uint32_t archetype, Entity entity) -> Record {
+        Archetype& target = *m_archetypes[archetype];
+        if (target.chunks.empty() || target.chunks.back().count == target.capacity) {
+            Chunk chunk;
+            if (m_free_chunks.empty()) {
+                chunk.data = allocate_chunk();
+            } else {
+                chunk.data = m_free_chunks.back();
+                m_free_chunks.pop_back();
+            }
+            target.chunks.push_back(chunk);
+        }
+
+        Chunk& chunk = target.chunks.back();
+        Record record;
+        record.archetype = archetype;
+        record.chunk = static_cast<uint32_t>(target.chunks.size() - 1);
+        record.row = chunk.count++;
+        reinterpret_cast<Entity*>(chunk.data)[record.row] = entity;
+        return record;
+    }
+
+    void World::free_row(const Record& record) {
+        Archetype& archetype = *m_archetypes[record.archetype];
+        Chunk& last = archetype.chunks.back();
+        uint32_t const last_row = last.count - 1;
+        auto const last_chunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+
+        // Keep the chunks dense: the last entity of the archetype takes over the freed row.
+        if (record.chunk != last_chunk || record.row != last_row) {
+            Chunk& hole = archetype.chunks[record.chunk];
+            Entity const moved = reinterpret_cast<Entity*>(last.data)[last_row];
+            reinterpret_cast<Entity*>(hole.data)[record.row] = moved;
+            for (ComponentId const component : archetype.components) {
+                size_t const size = component_info(component).size;
+                uint32_t const offset = archetype.offsets[component];
+                std::memcpy(
+                    hole.data + offset + record.row * size, last.data + offset + last_row * size, size);
+            }
+            Record& moved_record = this->record(moved);
+            moved_record.chunk = record.chunk;
+            moved_record.row = record.row;
+        }
+
+        if (--last.count == 0) {
+            m_free_chunks.push_back(last.data);
+            archetype.chunks.pop_back();
+        }
+    }
+
+    auto World::component_pointer(const Record& record, ComponentId component) const -> std::byte* {
+        const Archetype& archetype = *m_archetypes[record.archetype];
+        uint32_t const offset = archetype.offsets[component];
+        if (offset == Archetype::ABSENT) {
+            return nullptr;
+        }
+        return archetype.chunks[record.chunk].data + offset + record.row * component_info(component).size;
+    }
+
+    void World::move_entity(Entity entity, uint32_t target) {
+        Record const source = record(entity);
+        Record const moved = allocate_row(target, entity);
+
+        // Components present on both sides are copied; a new one is written by the caller.
+        for (ComponentId const component : m_archetypes[target]->components) {
+            if (const std::byte* from = component_pointer(source, component)) {
+                std::memcpy(component_pointer(moved, component), from, component_info(component).size);
+            }
+        }
+
+        free_row(source);
+        record(entity) = moved;
+    }
+
+    auto World::create() -> Entity {
+        return create_entity(nullptr, nullptr, 0);
+    }
+
+    auto World::create_entity(const ComponentId* components, const void* const* values, size_t count)
+        -> Entity {
+        ComponentMask mask = 0;
+        for (size_t i = 0; i < count; ++i) {
+            mask |= ComponentMask {1} << components[i];
+        }
+
+        // The archetype comes first, so an entity that cannot be stored is never created.
+        uint32_t const archetype = find_archetype(mask);
+        Entity const entity = m_records.create();
+        Record& created = record(entity);
+        created = allocate_row(archetype, entity);
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(
+                component_pointer(created, components[i]), values[i], component_info(components[i]).size);
+        }
+
+        return entity;
+    }
+
+    auto World::alive(Entity entity) const -> bool {
+        return m_records.contains(entity);
+    }
+
+    auto World::destroy(Entity entity) -> bool {
+        if (!alive(entity)) {
+            return false;
+        }
+
+        free_row(record(entity));
+        m_records.destroy(entity);
+        return true;
+    }
+
+    auto World::add_component(Entity entity, ComponentId component, const void* value) -> bool {
+        if (!alive(entity)) {
+            return false;
+        }
+
+        if (!has_component(entity, component)) {
+            move_entity(entity, add_edge(record(entity).archetype, component));
+        }
+        std::byte* const target = component_pointer(record(entity), component);
+        std::memcpy(target, value, component_info(component).size);
+        return true;
+    }
+
+    auto World::remove_component(Entity entity, ComponentId component) -> bool {
+        if (!has_component(entity, component)) {
+            return false;
+        }
+
+        move_entity(entity, remove_edge(record(entity).archetype, component));
+        return true;
+    }
+
+    auto World::get_component(Entity entity, ComponentId component) -> void* {
+        return alive(entity) ? component_pointer(record(entity), component) : nullptr;
+    }
+
+    auto World::has_component(Entity entity, ComponentId component) const -> bool {
+        if (!alive(entity)) {
+            return false;
+        }
+        return ((m_archetypes[record(entity).archetype]->mask >> component) & 1U) != 0;
+    }
+
+    QueryBase::QueryBase(World& world, ComponentMask include, ComponentMask exclude)
+        : m_world(world)
+        , m_include(include)
+        , m_exclude(exclude) {}
+
+    void QueryBase::refresh() {
+        size_t const count = m_world.archetype_count();
+        for (; m_checked < count; ++m_checked) {
+            ComponentMask const mask = m_world.archetype(m_checked).mask;
+            if ((mask & m_include) == m_include && (mask & m_exclude) == 0) {
+                m_matches.push_back(static_cast<uint32_t>(m_checked));
+            }
+        }
+    }
+
+    auto QueryBase::collect_chunks() -> const std::vector<ChunkView>& {
+        refresh();
+        m_chunks.clear();
+        for (uint32_t const index : m_matches) {
+            const Archetype& archetype = m_world.archetype(index);
+            for (const Chunk& chunk : archetype.chunks) {
+                m_chunks.emplace_back(archetype, chunk);
+            }
+        }
+        return m_chunks;
+    }
+
+    auto QueryBase::count() -> size_t {
+        refresh();
+        size_t total = 0;
+        for (uint32_t const index : m_matches) {
+            for (const Chunk& chunk : m_world.archetype(index).chunks) {
+                total += chunk.count;
+            }
+        }
+        return total;
+    }
+
+    void CommandBuffer::write_bytes(const void* data, size_t size) {
+        size_t const offset = m_bytes.size();
+        m_bytes.resize(offset + size);
+        std::memcpy(m_bytes.data() + offset, data, size);
+    }
+
+    void CommandBuffer::write_command(Op op, Entity entity, ComponentId component, uint32_t count) {
+        Command const command {op, entity, component, count};
+        write_bytes(&command, sizeof(command));
+    }
+
+    void CommandBuffer::write_component(ComponentId component, const void* value, size_t size) {
+        write_bytes(&component, sizeof(component));
+        write_bytes(value, size);
+    }
+
+    void CommandBuffer::create() {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        write_command(Op::Create, Entity {}, 0, 0);
+    }
+
+    void CommandBuffer::destroy(Entity entity) {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        write_command(Op::Destroy, entity, 0, 0);
+    }
+
+    void CommandBuffer::apply(World& world) {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+
+        std::array<ComponentId, MAX_COMPONENTS> components {};
+        std::array<const void*, MAX_COMPONENTS> values {};
+
+        const std::byte* cursor = m_bytes.data();
+        const std::byte* const end = cursor + m_bytes.size();
+        while (cursor < end) {
+            Command command {};
+            std::memcpy(&command, cursor, sizeof(command));
+            cursor += sizeof(command);
+
+            switch (command.op) {
+                case Op::Create:
+                    for (uint32_t i = 0; i < command.count; ++i) {
+                        std::memcpy(&components[i], cursor, sizeof(ComponentId));
+                        values[i] = cursor + sizeof(ComponentId);
+                        cursor += sizeof(ComponentId) + component_info(components[i]).size;
+                    }
+                    world.create_entity(components.data(), values.data(), command.count);
+                    break;
+                case Op::Destroy:
+                    world.destroy(command.entity);
+                    break;
+                case Op::Add:
+                    world.add_component(command.entity, command.component, cursor);
+                    cursor += component_info(command.component).size;
+                    break;
+                case Op::Remove:
+                    world.remove_component(command.entity, command.component);
+                    break;
+            }
+        }
+        m_bytes.clear();
+    }
+}    // namespace scene::ecs
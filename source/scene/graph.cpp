@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/scene/graph.hpp"
+
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+
+    using mathematics::Mat3;
+    using mathematics::Mat4;
+    using mathematics::Quat;
+    using mathematics::Vec3;
+
+    // A node costs a few dozen multiplies; smaller batches would cost more to schedule than to run.
+    constexpr size_t UPDATE_GRAIN = 512;
+
+    auto local_matrix(Vec3 position, Quat rotation, Vec3 scale) -> Mat4 {
+        Mat3 linear = mathematics::to_matrix(rotation);
+        linear.columns[0] = linear.columns[0] * scale.x;
+        linear.columns[1] = linear.columns[1] * scale.y;
+        linear.columns[2] = linear.columns[2] * scale.z;
+        return mathematics::affine(linear, position);
+    }
+
+    // result = a * b, a column of the result per four multiply-adds of the columns of a.
+    void multiply(const Mat4& a, const Mat4& b, Mat4& result) {
+        simd::float4 const a0 = simd::load(a.columns[0]);
+        simd::float4 const a1 = simd::load(a.columns[1]);
+        simd::float4 const a2 = simd::load(a.columns[2]);
+        simd::float4 const a3 = simd::load(a.columns[3]);
+        for (int column = 0; column < 4; ++column) {
+            const float* const b_column = b.columns[column];
+            simd::float4 const sum = (a0 * simd::set1(b_column[0])) + (a1 * simd::set1(b_column[1]))
+                                     + (a2 * simd::set1(b_column[2])) + (a3 * simd::set1(b_column[3]));
+            simd::store(result.columns[column], sum);
+        }
+    }
+
+    // Values in the new order, order[i] being the old index of new index i.
+    template<typename T>
+    void permute(std::vector<T>& values, const std::vector<uint32_t>& order) {
+        std::vector<T> permuted;
+        permuted.reserve(order.size());
+        for (uint32_t const old : order) {
+            permuted.push_back(values[old]);
+        }
+        values = std::move(permuted);
+    }
+}    // namespace
+
+namespace scene::graph {
+    SceneGraph::SceneGraph() {
+        LOG_TRACE
+    }
+
+    auto SceneGraph::create(const LocalTransform& local, Node parent) -> Node {
+        if (!parent.is_null() && !m_records.contains(parent)) {
+            throw std::invalid_argument("parent node is not alive");
+        }
+
+        auto const slot = static_cast<uint32_t>(m_nodes.size());
+        Record record;
+        record.slot = slot;
+        Node const node = m_records.create(record);
+        m_nodes.push_back(node);
+        m_positions.push_back(local.position);
+        m_rotations.push_back(local.rotation);
+        m_scales.push_back(local.scale);
+        m_parents.push_back(NO_PARENT);
+        m_first_children.push_back(0);
+        m_child_counts.push_back(0);
+        m_depths.push_back(0);
+        m_worlds.emplace_back();
+        m_stamps.push_back(m_stamp);
+
+        link(node, parent);
+        mark_dirty(slot);
+        m_layout_dirty = true;
+        return node;
+    }
+
+    auto SceneGraph::destroy(Node node) -> bool {
+        if (!m_records.contains(node)) {
+            return false;
+        }
+
+        unlink(node);
+        std::vector<Node> stack {node};
+        while (!stack.empty()) {
+            Node const current = stack.back();
+            stack.pop_back();
+            const Record& record = m_records[current];
+            for (Node child = record.first_child; !child.is_null(); child = m_records[child].next_sibling) {
+                stack.push_back(child);
+            }
+            // The slot stays until the next relayout(), which drops it.
+            m_nodes[record.slot] = Node {};
+            m_records.destroy(current);
+        }
+        m_layout_dirty = true;
+        return true;
+    }
+
+    auto SceneGraph::alive(Node node) const -> bool {
+        return m_records.contains(node);
+    }
+
+    void SceneGraph::set_parent(Node node, Node parent) {
+        if (!m_records.contains(node) || (!parent.is_null() && !m_records.contains(parent))) {
+            throw std::invalid_argument("node is not alive");
+        }
+        for (Node ancestor = parent; !ancestor.is_null(); ancestor = m_records[ancestor].parent) {
+            if (ancestor == node) {
+                throw std::invalid_argument("parent is in the subtree of the node");
+            }
+        }
+        if (m_records[node].parent == parent) {
+            return;
+        }
+
+        unlink(node);
+        link(node, parent);
+        mark_dirty(m_records[node].slot);
+        m_layout_dirty = true;
+    }
+
+    auto SceneGraph::parent(Node node) const -> Node {
+        return record(node).parent;
+    }
+
+    auto SceneGraph::local(Node node) const -> LocalTransform {
+        uint32_t const slot = record(node).slot;
+        return {m_positions[slot], m_rotations[slot], m_scales[slot]};
+    }
+
+    void SceneGraph::set_local(Node node, const LocalTransform& local) {
+        uint32_t const slot = record(node).slot;
+        m_positions[slot] = local.position;
+        m_rotations[slot] = local.rotation;
+        m_scales[slot] = local.scale;
+        mark_dirty(slot);
+    }
+
+    void SceneGraph::set_position(Node node, Vec3 position) {
+        uint32_t const slot = record(node).slot;
+        m_positions[slot] = position;
+        mark_dirty(slot);
+    }
+
+    void SceneGraph::set_rotation(Node node, Quat rotation) {
+        uint32_t const slot = record(node).slot;
+        m_rotations[slot] = rotation;
+        mark_dirty(slot);
+    }
+
+    void SceneGraph::set_scale(Node node, Vec3 scale) {
+        uint32_t const slot = record(node).slot;
+        m_scales[slot] = scale;
+        mark_dirty(slot);
+    }
+
+    auto SceneGraph::world(Node node) const -> const Mat4& {
+        return m_worlds[record(node).slot];
+    }
+
+    void SceneGraph::update() {
+        update(utils::jobs::global());
+    }
+
+    void SceneGraph::update(utils::jobs::JobSystem& jobs) {
+        m_updated = 0;
+        if (m_layout_dirty) {
+            relayout();
+        }
+        if (m_dirty.empty()) {
+            return;
+        }
+
+        // Queued slots carry the stamp of this update; a stamp per slot dedups children reached twice.
+        ++m_stamp;
+        for (uint32_t const slot : m_dirty) {
+            m_work[m_depths[slot]].push_back(slot);
+        }
+        m_dirty.clear();
+
+        for (size_t level = 0; level < m_work.size(); ++level) {
+            std::vector<uint32_t>& slots = m_work[level];
+            if (slots.empty()) {
+                continue;
+            }
+            // Sorted, the batch reads and writes the level arrays front to back.
+            std::sort(slots.begin(), slots.end());
+
+            auto const body = [this, &slots](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t const slot = slots[i];
+                    Mat4 const local = local_matrix(m_positions[slot], m_rotations[slot], m_scales[slot]);
+                    uint32_t const parent = m_parents[slot];
+                    if (parent == NO_PARENT) {
+                        m_worlds[slot] = local;
+                    } else {
+                        multiply(m_worlds[parent], local, m_worlds[slot]);
+                    }
+                }
+            };
+            utils::parallel::parallel_for(jobs, slots.size(), UPDATE_GRAIN, body);
+
+            // Children of updated nodes are updated on the next level, whether dirty or not.
+            if (level + 1 < m_work.size()) {
+                std::vector<uint32_t>& next = m_work[level + 1];
+                for (uint32_t const slot : slots) {
+                    uint32_t const end = m_first_children[slot] + m_child_counts[slot];
+                    for (uint32_t child = m_first_children[slot]; child < end; ++child) {
+                        if (m_stamps[child] != m_stamp) {
+                            m_stamps[child] = m_stamp;
+                            next.push_back(child);
+                        }
+                    }
+                }
+            }
+            m_updated += slots.size();
+            slots.clear();
+        }
+    }
+
+    auto SceneGraph::record(Node node) const -> const Record& {
+        const Record* const found = m_records.get(node);
+        if (found == nullptr) {
+            throw std::invalid_argument("node is not alive");
+        }
+        return *found;
+    }
+
+    void SceneGraph::mark_dirty(uint32_t slot) {
+        // The stamp of the next update() marks a queued slot.
+        if (m_stamps[slot] != m_stamp + 1) {
+            m_stamps[slot] = m_stamp + 1;
+            m_dirty.push_back(slot);
+        }
+    }
+
+    void SceneGraph::link(Node node, Node parent) {
+        Record& record = m_records[node];
+        record.parent = parent;
+        record.previous_sibling = Node {};
+        record.next_sibling = Node {};
+        if (parent.is_null()) {
+            return;
+        }
+
+        Record& parent_record = m_records[parent];
+        record.next_sibling = parent_record.first_child;
+        if (!parent_record.first_child.is_null()) {
+            m_records[parent_record.first_child].previous_sibling = node;
+        }
+        parent_record.first_child = node;
+    }
+
+    void SceneGraph::unlink(Node node) {
+        Record& record = m_records[node];
+        if (!record.previous_sibling.is_null()) {
+            m_records[record.previous_sibling].next_sibling = record.next_sibling;
+        } else if (!record.parent.is_null()) {
+            m_records[record.parent].first_child = record.next_sibling;
+        }
+        if (!record.next_sibling.is_null()) {
+            m_records[record.next_sibling].previous_sibling = record.previous_sibling;
+        }
+        record.parent = Node {};
+        record.previous_sibling = Node {};
+        record.next_sibling = Node {};
+    }
+
+    void SceneGraph::relayout() {
+        // Breadth first from the roots in slot order: order[i] is the old slot of new slot i.
+        std::vector<uint32_t> order;
+        order.reserve(m_records.size());
+        for (uint32_t slot = 0; slot < m_nodes.size(); ++slot) {
+            Node const node = m_nodes[slot];
+            if (!node.is_null() && m_records[node].parent.is_null()) {
+                order.push_back(slot);
+            }
+        }
+
+        std::vector<uint32_t> first_children(m_records.size(), 0);
+        std::vector<uint32_t> child_counts(m_records.size(), 0);
+        std::vector<uint32_t> depths(m_records.size(), 0);
+        m_levels.assign(1, 0);
+        for (size_t begin = 0; begin < order.size();) {
+            size_t const end = order.size();
+            for (size_t i = begin; i < end; ++i) {
+                first_children[i] = static_cast<uint32_t>(order.size());
+                depths[i] = static_cast<uint32_t>(m_levels.size() - 1);
+                const Record& record = m_records[m_nodes[order[i]]];
+                for (Node child = record.first_child; !child.is_null();) {
+                    const Record& child_record = m_records[child];
+                    order.push_back(child_record.slot);
+                    child = child_record.next_sibling;
+                }
+                child_counts[i] = static_cast<uint32_t>(order.size()) - first_children[i];
+            }
+            m_levels.push_back(static_cast<uint32_t>(end));
+            begin = end;
+        }
+
+        std::vector<uint32_t> new_slots(m_nodes.size(), NO_PARENT);
+        for (size_t i = 0; i < order.size(); ++i) {
+            new_slots[order[i]] = static_cast<uint32_t>(i);
+        }
+
+        permute(m_nodes, order);
+        permute(m_positions, order);
+        permute(m_rotations, order);
+        permute(m_scales, order);
+        permute(m_worlds, order);
+        permute(m_stamps, order);
+        m_first_children = std::move(first_children);
+        m_child_counts = std::move(child_counts);
+        m_depths = std::move(depths);
+
+        m_parents.assign(order.size(), NO_PARENT);
+        for (size_t i = 0; i < order.size(); ++i) {
+            Record& record = m_records[m_nodes[i]];
+            if (!record.parent.is_null()) {
+                m_parents[i] = new_slots[m_records[record.parent].slot];
+            }
+        }
+        for (size_t i = 0; i < order.size(); ++i) {
+            m_records[m_nodes[i]].slot = static_cast<uint32_t>(i);
+        }
+
+        // Queued slots move with their nodes; those of destroyed nodes are dropped.
+        size_t kept = 0;
+        for (uint32_t const slot : m_dirty) {
+            if (new_slots[slot] != NO_PARENT) {
+                m_dirty[kept++] = new_slots[slot];
+            }
+        }
+        m_dirty.resize(kept);
+
+        m_work.resize(m_levels.size() - 1);
+        m_layout_dirty = false;
+    }
+}    // namespace scene::graph
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "domkrat3d/scene/lod.hpp"
+
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+
+    using scene::lod::LodLevel;
+    using scene::lod::MAX_LODS;
+
+    constexpr size_t WIDTH = 4;
+
+    // Instances per selection job.
+    constexpr size_t SELECT_GRAIN = 1024;
+
+    // Distances are clamped here so that an eye inside a bounding sphere picks the finest level.
+    constexpr float MIN_DISTANCE = 1e-3F;
+
+    /*
+     * Level for a projected error scale (pixels per model unit of error). The coarsest level
+     * under the threshold wins; a level coarser than the current one must also clear the
+     * hysteresis margin, while refining happens as soon as the current level is too coarse.
+     */
+    auto choose(const LodLevel* levels,
+                uint32_t count,
+                uint32_t current,
+                float scale,
+                float limit,
+                float margin) -> uint32_t {
+        uint32_t chosen = 0;
+        for (uint32_t level = 1; level < count; ++level) {
+            float const pixels = levels[level].error * scale;
+            if (pixels > limit || (level > current && pixels > margin)) {
+                break;
+            }
+            chosen = level;
+        }
+        return chosen;
+    }
+}    // namespace
+
+namespace scene::lod {
+    auto make_camera(Vec3 position, float fov_y, float viewport_height) -> LodCamera {
+        return {position, viewport_height / (2.0F * std::tan(fov_y * 0.5F))};
+    }
+
+    LodSelector::LodSelector(const LodSettings& settings)
+        : m_settings(settings) {
+        LOG_TRACE
+    }
+
+    auto LodSelector::add_model(const LodLevel* levels, size_t count) -> uint32_t {
+        if (count == 0 || count > MAX_LODS) {
+            throw std::invalid_argument("a model needs 1 to MAX_LODS levels");
+        }
+        for (size_t level = 1; level < count; ++level) {
+            if (levels[level].error < levels[level - 1].error) {
+                throw std::invalid_argument("level errors must not decrease");
+            }
+        }
+
+        auto const model = static_cast<uint32_t>(m_level_counts.size());
+        m_model_levels.insert(m_model_levels.end(), levels, levels + count);
+        m_model_levels.resize(size_t {model + 1} * MAX_LODS);
+        m_level_counts.push_back(static_cast<uint32_t>(count));
+        return model;
+    }
+
+    auto LodSelector::add_instance(uint32_t model) -> uint32_t {
+        if (model >= m_level_counts.size()) {
+            throw std::invalid_argument("unknown model");
+        }
+        m_models.push_back(model);
+        m_levels.push_back(0);
+        return static_cast<uint32_t>(m_models.size() - 1);
+    }
+
+    void LodSelector::select(const LodCamera& camera,
+                             const culling::SphereArray& bounds,
+                             const std::vector<uint32_t>& visible,
+                             utils::jobs::JobSystem& jobs) {
+        size_t const count = visible.size();
+        float const limit = m_settings.pixel_error;
+        float const margin = m_settings.pixel_error * (1.0F - m_settings.hysteresis);
+        std::vector<uint8_t> switched(count, 0);
+
+        // Jobs take whole groups of four visible entries.
+        auto const body = [this, &camera, &bounds, &visible, &switched, count, limit, margin](size_t begin,
+                                                                                              size_t end)
+        {
+            simd::float4 const eye_x = simd::set1(camera.position.x);
+            simd::float4 const eye_y = simd::set1(camera.position.y);
+            simd::float4 const eye_z = simd::set1(camera.position.z);
+            simd::float4 const min_distance = simd::set1(MIN_DISTANCE);
+            simd::float4 const pixels_per_unit = simd::set1(camera.pixels_per_unit);
+
+            for (size_t group = begin; group < end; ++group) {
+                // A partial last group repeats its last instance in the spare lanes.
+                size_t const first = group * WIDTH;
+                uint32_t instances[WIDTH];
+                for (size_t lane = 0; lane < WIDTH; ++lane) {
+                    instances[lane] = visible[std::min(first + lane, count - 1)];
+                }
+                auto const gather = [&instances](const float* values)
+                {
+                    return simd::set(values[instances[0]],
+                                     values[instances[1]],
+                                     values[instances[2]],
+                                     values[instances[3]]);
+                };
+
+                simd::float4 const dx = gather(bounds.x()) - eye_x;
+                simd::float4 const dy = gather(bounds.y()) - eye_y;
+                simd::float4 const dz = gather(bounds.z()) - eye_z;
+                simd::float4 const centers = simd::sqrt((dx * dx) + (dy * dy) + (dz * dz));
+                simd::float4 const distance = simd::max(centers - gather(bounds.radii()), min_distance);
+                float scales[WIDTH];
+                simd::store(scales, pixels_per_unit / distance);
+
+                for (size_t lane = 0; lane < WIDTH && first + lane < count; ++lane) {
+                    uint32_t const instance = instances[lane];
+                    uint32_t const model = m_models[instance];
+                    uint32_t const current = m_levels[instance];
+                    uint32_t const chosen = choose(&m_model_levels[size_t {model} * MAX_LODS],
+                                                   m_level_counts[model],
+                                                   current,
+                                                   scales[lane],
+                                                   limit,
+                                                   margin);
+                    m_levels[instance] = static_cast<uint8_t>(chosen);
+                    switched[first + lane] = chosen != current ? 1 : 0;
+                }
+            }
+        };
+        utils::parallel::parallel_for(jobs, (count + WIDTH - 1) / WIDTH, SELECT_GRAIN / WIDTH, body);
+
+        // Counting sort into one bucket per model and level, keeping the visible order.
+        size_t const bucket_count = m_level_counts.size() * MAX_LODS;
+        m_bucket_starts.assign(bucket_count + 1, 0);
+        m_triangles = 0;
+        m_switches = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t const instance = visible[i];
+            size_t const bucket = size_t {m_models[instance]} * MAX_LODS + m_levels[instance];
+            ++m_bucket_starts[bucket + 1];
+            m_triangles += m_model_levels[bucket].triangles;
+            m_switches += switched[i];
+        }
+        for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+            m_bucket_starts[bucket + 1] += m_bucket_starts[bucket];
+        }
+        m_selected.resize(count);
+        std::vector<size_t> cursors(m_bucket_starts.begin(), m_bucket_starts.end() - 1);
+        for (uint32_t const instance : visible) {
+            size_t const bucket = size_t {m_models[instance]} * MAX_LODS + m_levels[instance];
+            m_selected[cursors[bucket]++] = instance;
+        }
+    }
+
+    auto LodSelector::instances(uint32_t model, uint32_t level) const -> InstanceList {
+        size_t const bucket = size_t {model} * MAX_LODS + level;
+        if (bucket + 1 >= m_bucket_starts.size()) {
+            return {};
+        }
+        size_t const begin = m_bucket_starts[bucket];
+        return {m_selected.data() + begin, m_bucket_starts[bucket + 1] - begin};
+    }
+}    // namespace scene::lod
@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/scene/occlusion.hpp"
+
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    namespace simd = mathematics::simd;
+
+    using mathematics::Mat4;
+    using mathematics::Vec3;
+    using scene::occlusion::BLOCK_SIZE;
+    using scene::occlusion::TILE_SIZE;
+
+    constexpr uint32_t WIDTH = 4;
+
+    // Boxes per test job; a test reads a few blocks and rarely a few rows of pixels.
+    constexpr size_t TEST_GRAIN = 256;
+
+    // Clip-space w below which a point is treated as on the eye plane.
+    constexpr float MIN_W = 1e-6F;
+
+    struct Clip {
+        float x;
+        float y;
+        float z;
+        float w;
+    };
+
+    auto transform(const Mat4& m, Vec3 point) -> Clip {
+        Clip clip {};
+        float* const out[4] = {&clip.x, &clip.y, &clip.z, &clip.w};
+        for (int row = 0; row < 4; ++row) {
+            *out[row] = (m.columns[0][row] * point.x) + (m.columns[1][row] * point.y)
+                        + (m.columns[2][row] * point.z) + m.columns[3][row];
+        }
+        return clip;
+    }
+
+    auto lerp(const Clip& a, const Clip& b, float t) -> Clip {
+        return {a.x + ((b.x - a.x) * t),
+                a.y + ((b.y - a.y) * t),
+                a.z + ((b.z - a.z) * t),
+                a.w + ((b.w - a.w) * t)};
+    }
+
+    // Polygon of a triangle on the visible side of the near plane (z >= 0): up to four points.
+    auto clip_near(const Clip (&triangle)[3], Clip (&polygon)[4]) -> size_t {
+        size_t count = 0;
+        for (size_t i = 0; i < 3; ++i) {
+            const Clip& current = triangle[i];
+            const Clip& next = triangle[(i + 1) % 3];
+            if (current.z >= 0.0F) {
+                polygon[count++] = current;
+            }
+            if ((current.z >= 0.0F) != (next.z >= 0.0F)) {
+                polygon[count++] = lerp(current, next, current.z / (current.z - next.z));
+            }
+        }
+        return count;
+    }
+
+    // Whether all three points are outside the same side plane of clip space.
+    auto outside_sides(const Clip (&triangle)[3]) -> bool {
+        bool right = true;
+        bool left = true;
+        bool bottom = true;
+        bool top = true;
+        for (const Clip& p : triangle) {
+            right = right && p.x > p.w;
+            left = left && p.x < -p.w;
+            bottom = bottom && p.y > p.w;
+            top = top && p.y < -p.w;
+        }
+        return right || left || bottom || top;
+    }
+
+    auto horizontal_min(simd::float4 value) -> float {
+        float lanes[4];
+        simd::store(lanes, value);
+        return std::min({lanes[0], lanes[1], lanes[2], lanes[3]});
+    }
+
+    auto lane_offsets() -> simd::float4 {
+        return simd::set(0.5F, 1.5F, 2.5F, 3.5F);
+    }
+}    // namespace
+
+namespace scene::occlusion {
+    OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+        : m_width((width + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE)
+        , m_height((height + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE)
+        , m_tiles_x(m_width / TILE_SIZE)
+        , m_tiles_y(m_height / TILE_SIZE) {
+        LOG_TRACE
+
+        if (width == 0 || height == 0) {
+            throw std::invalid_argument("occlusion buffer size is zero");
+        }
+        m_depth.assign(size_t {m_width} * m_height, 1.0F);
+        m_blocks.assign(size_t {m_width / BLOCK_SIZE} * (m_height / BLOCK_SIZE), 1.0F);
+        m_bins.resize(size_t {m_tiles_x} * m_tiles_y);
+    }
+
+    void OcclusionBuffer::begin(const Mat4& view_projection) {
+        m_view_projection = view_projection;
+        std::fill(m_depth.begin(), m_depth.end(), 1.0F);
+        std::fill(m_blocks.begin(), m_blocks.end(), 1.0F);
+        m_triangles.clear();
+        for (auto& bin : m_bins) {
+            bin.clear();
+        }
+    }
+
+    void OcclusionBuffer::add_occluder(const Vec3* positions,
+                                       size_t vertex_count,
+                                       const uint32_t* indices,
+                                       size_t index_count,
+                                       const Mat4& world) {
+        Mat4 const model_to_clip = m_view_projection * world;
+        float const half_width = 0.5F * static_cast<float>(m_width);
+        float const half_height = 0.5F * static_cast<float>(m_height);
+
+        for (size_t i = 0; i + 2 < index_count; i += 3) {
+            Clip triangle[3];
+            for (size_t corner = 0; corner < 3; ++corner) {
+                if (indices[i + corner] >= vertex_count) {
+                    throw std::out_of_range("occluder index out of range");
+                }
+                triangle[corner] = transform(model_to_clip, positions[indices[i + corner]]);
+            }
+            if (outside_sides(triangle)) {
+                continue;
+            }
+
+            Clip polygon[4];
+            size_t const count = clip_near(triangle, polygon);
+            Vec3 screen[4];
+            bool behind = false;
+            for (size_t corner = 0; corner < count; ++corner) {
+                const Clip& p = polygon[corner];
+                behind = behind || p.w < MIN_W;
+                float const inverse_w = 1.0F / p.w;
+                screen[corner] = {((p.x * inverse_w) + 1.0F) * half_width,
+                                  ((p.y * inverse_w) + 1.0F) * half_height,
+                                  p.z * inverse_w};
+            }
+            if (behind) {
+                continue;
+            }
+            for (size_t corner = 2; corner < count; ++corner) {
+                setup(screen[0], screen[corner - 1], screen[corner]);
+            }
+        }
+    }
+
+    void OcclusionBuffer::setup(Vec3 a, Vec3 b, Vec3 c) {
+        float area = ((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x));
+        if (!(std::fabs(area) > 0.0F) || !std::isfinite(area)) {
+            return;
+        }
+        // Both faces are drawn: a clockwise triangle is turned around.
+        if (area < 0.0F) {
+            std::swap(b, c);
+            area = -area;
+        }
+
+        Triangle triangle {};
+        triangle.min_x = std::max(0, static_cast<int32_t>(std::floor(std::min({a.x, b.x, c.x}))));
+        triangle.min_y = std::max(0, static_cast<int32_t>(std::floor(std::min({a.y, b.y, c.y}))));
+        triangle.max_x = std::min(static_cast<int32_t>(m_width),
+                                  static_cast<int32_t>(std::ceil(std::max({a.x, b.x, c.x}))));
+        triangle.max_y = std::min(static_cast<int32_t>(m_height),
+                                  static_cast<int32_t>(std::ceil(std::max({a.y, b.y, c.y}))));
+        if (triangle.min_x >= triangle.max_x || triangle.min_y >= triangle.max_y) {
+            return;
+        }
+
+        // Edge p -> q: (q.x - p.x) * (y - p.y) - (q.y - p.y) * (x - p.x), positive inside.
+        Vec3 const corners[3] = {a, b, c};
+        for (size_t edge = 0; edge < 3; ++edge) {
+            Vec3 const p = corners[edge];
+            Vec3 const q = corners[(edge + 1) % 3];
+            triangle.edge_a[edge] = p.y - q.y;
+            triangle.edge_b[edge] = q.x - p.x;
+            triangle.edge_c[edge] = ((q.y - p.y) * p.x) - ((q.x - p.x) * p.y);
+        }
+
+        // z/w is linear in screen space.
+        float const dz_dx = (((b.z - a.z) * (c.y - a.y)) - ((c.z - a.z) * (b.y - a.y))) / area;
+        float const dz_dy = (((c.z - a.z) * (b.x - a.x)) - ((b.z - a.z) * (c.x - a.x))) / area;
+        triangle.depth_a = dz_dx;
+        triangle.depth_b = dz_dy;
+        triangle.depth_c = a.z - (dz_dx * a.x) - (dz_dy * a.y);
+        triangle.min_depth = std::max(0.0F, std::min({a.z, b.z, c.z}));
+        triangle.max_depth = std::min(1.0F, std::max({a.z, b.z, c.z}));
+
+        auto const index = static_cast<uint32_t>(m_triangles.size());
+        m_triangles.push_back(triangle);
+        auto const tile_x0 = static_cast<uint32_t>(triangle.min_x) / TILE_SIZE;
+        auto const tile_x1 = static_cast<uint32_t>(triangle.max_x - 1) / TILE_SIZE;
+        auto const tile_y0 = static_cast<uint32_t>(triangle.min_y) / TILE_SIZE;
+        auto const tile_y1 = static_cast<uint32_t>(triangle.max_y - 1) / TILE_SIZE;
+        for (uint32_t tile_y = tile_y0; tile_y <= tile_y1; ++tile_y) {
+            for (uint32_t tile_x = tile_x0; tile_x <= tile_x1; ++tile_x) {
+                m_bins[size_t {tile_y} * m_tiles_x + tile_x].push_back(index);
+            }
+        }
+    }
+
+    void OcclusionBuffer::rasterize(utils::jobs::JobSystem& jobs) {
+        auto const body = [this](size_t begin, size_t end)
+        {
+            for (size_t tile = begin; tile < end; ++tile) {
+                rasterize_tile(static_cast<uint32_t>(tile));
+            }
+        };
+        utils::parallel::parallel_for(jobs, m_bins.size(), 1, body);
+    }
+
+    void OcclusionBuffer::rasterize_tile(uint32_t tile) {
+        auto const tile_x = static_cast<int32_t>(tile % m_tiles_x * TILE_SIZE);
+        auto const tile_y = static_cast<int32_t>(tile / m_tiles_x * TILE_SIZE);
+        auto const tile_end_x = tile_x + static_cast<int32_t>(TILE_SIZE);
+        auto const tile_end_y = tile_y + static_cast<int32_t>(TILE_SIZE);
+        simd::float4 const offsets = lane_offsets();
+
+        for (uint32_t const index : m_bins[tile]) {
+            const Triangle& triangle = m_triangles[index];
+            // Groups of four start on a multiple of four, which the tile edges are.
+            int32_t const x0 = std::max(triangle.min_x, tile_x) & ~static_cast<int32_t>(WIDTH - 1);
+            int32_t const x1 = std::min(triangle.max_x, tile_end_x);
+            int32_t const y0 = std::max(triangle.min_y, tile_y);
+            int32_t const y1 = std::min(triangle.max_y, tile_end_y);
+
+            simd::float4 const a[3] = {simd::set1(triangle.edge_a[0]),
+                                       simd::set1(triangle.edge_a[1]),
+                                       simd::set1(triangle.edge_a[2])};
+            simd::float4 const depth_a = simd::set1(triangle.depth_a);
+            simd::float4 const min_depth = simd::set1(triangle.min_depth);
+            simd::float4 const max_depth = simd::set1(triangle.max_depth);
+
+            for (int32_t y = y0; y < y1; ++y) {
+                float const center_y = static_cast<float>(y) + 0.5F;
+                simd::float4 row[3];
+                for (size_t edge = 0; edge < 3; ++edge) {
+                    row[edge] = simd::set1((triangle.edge_b[edge] * center_y) + triangle.edge_c[edge]);
+                }
+                simd::float4 const row_depth = simd::set1((triangle.depth_b * center_y) + triangle.depth_c);
+                float* const pixels = &m_depth[static_cast<size_t>(y) * m_width];
+
+                for (int32_t x = x0; x < x1; x += static_cast<int32_t>(WIDTH)) {
+                    simd::float4 const center_x = simd::set1(static_cast<float>(x)) + offsets;
+                    simd::float4 const inside = (((a[0] * center_x) + row[0]) >= simd::zero4())
+                                                & (((a[1] * center_x) + row[1]) >= simd::zero4())
+                                                & (((a[2] * center_x) + row[2]) >= simd::zero4());
+                    if (simd::movemask(inside) == 0) {
+                        continue;
+                    }
+                    simd::float4 const depth =
+                        simd::clamp((depth_a * center_x) + row_depth, min_depth, max_depth);
+                    simd::float4 const old = simd::load(pixels + x);
+                    simd::store(pixels + x, simd::select(inside, simd::min(old, depth), old));
+                }
+            }
+        }
+
+        // Farthest depth of every block of the tile.
+        uint32_t const blocks_x = m_width / BLOCK_SIZE;
+        auto const first_x = static_cast<uint32_t>(tile_x);
+        auto const first_y = static_cast<uint32_t>(tile_y);
+        for (uint32_t block_y = first_y; block_y < first_y + TILE_SIZE; block_y += BLOCK_SIZE) {
+            for (uint32_t block_x = first_x; block_x < first_x + TILE_SIZE; block_x += BLOCK_SIZE) {
+                simd::float4 farthest = simd::zero4();
+                for (uint32_t y = block_y; y < block_y + BLOCK_SIZE; ++y) {
+                    const float* const pixels = &m_depth[size_t {y} * m_width];
+                    for (uint32_t x = block_x; x < block_x + BLOCK_SIZE; x += WIDTH) {
+                        farthest = simd::max(farthest, simd::load(pixels + x));
+                    }
+                }
+                float lanes[4];
+                simd::store(lanes, farthest);
+                m_blocks[size_t {block_y / BLOCK_SIZE} * blocks_x + block_x / BLOCK_SIZE] =
+                    std::max({lanes[0], lanes[1], lanes[2], lanes[3]});
+            }
+        }
+    }
+
+    auto OcclusionBuffer::occluded(const Aabb& box) const -> bool {
+        // The eight corners as two groups of four, the near face and the far face.
+        const Mat4& m = m_view_projection;
+        simd::float4 const xs = simd::set(box.min.x, box.max.x, box.min.x, box.max.x);
+        simd::float4 const ys = simd::set(box.min.y, box.min.y, box.max.y, box.max.y);
+        simd::float4 low_x = simd::set1(INFINITY);
+        simd::float4 low_y = low_x;
+        simd::float4 low_z = low_x;
+        simd::float4 high_x = -low_x;
+        simd::float4 high_y = -low_x;
+        for (float const z : {box.min.z, box.max.z}) {
+            simd::float4 clip[4];
+            for (int row = 0; row < 4; ++row) {
+                clip[row] = (simd::set1(m.columns[0][row]) * xs) + (simd::set1(m.columns[1][row]) * ys)
+                            + simd::set1((m.columns[2][row] * z) + m.columns[3][row]);
+            }
+            if (simd::any((clip[2] < simd::zero4()) | (clip[3] < simd::set1(MIN_W)))) {
+                return false;
+            }
+            simd::float4 const inverse_w = simd::set1(1.0F) / clip[3];
+            simd::float4 const x = clip[0] * inverse_w;
+            simd::float4 const y = clip[1] * inverse_w;
+            low_x = simd::min(low_x, x);
+            high_x = simd::max(high_x, x);
+            low_y = simd::min(low_y, y);
+            high_y = simd::max(high_y, y);
+            low_z = simd::min(low_z, clip[2] * inverse_w);
+        }
+        float const min_x = horizontal_min(low_x);
+        float const max_x = -horizontal_min(-high_x);
+        float const min_y = horizontal_min(low_y);
+        float const max_y = -horizontal_min(-high_y);
+        float const nearest = horizontal_min(low_z);
+        if (max_x < -1.0F || min_x > 1.0F || max_y < -1.0F || min_y > 1.0F || nearest > 1.0F) {
+            return false;
+        }
+
+        // Every pixel the box touches, at least one.
+        auto const pixel = [](float ndc, uint32_t size)
+        {
+            float const extent = static_cast<float>(size);
+            return std::clamp((ndc + 1.0F) * 0.5F * extent, 0.0F, extent);
+        };
+        auto const x0 = std::min(static_cast<uint32_t>(pixel(min_x, m_width)), m_width - 1);
+        auto const y0 = std::min(static_cast<uint32_t>(pixel(min_y, m_height)), m_height - 1);
+        auto const x1 = std::max(static_cast<uint32_t>(std::ceil(pixel(max_x, m_width))), x0 + 1);
+        auto const y1 = std::max(static_cast<uint32_t>(std::ceil(pixel(max_y, m_height))), y0 + 1);
+
+        simd::float4 const box_depth = simd::set1(nearest);
+        uint32_t const blocks_x = m_width / BLOCK_SIZE;
+        for (uint32_t block_y = y0 / BLOCK_SIZE; block_y <= (y1 - 1) / BLOCK_SIZE; ++block_y) {
+            for (uint32_t block_x = x0 / BLOCK_SIZE; block_x <= (x1 - 1) / BLOCK_SIZE; ++block_x) {
+                if (nearest < m_blocks[size_t {block_y} * blocks_x + block_x]) {
+                    // Part of the block is farther than the box; look at the pixels the box covers.
+                    uint32_t const start_x = std::max(x0, block_x * BLOCK_SIZE) & ~(WIDTH - 1);
+                    uint32_t const end_x = std::min(x1, (block_x + 1) * BLOCK_SIZE);
+                    uint32_t const start_y = std::max(y0, block_y * BLOCK_SIZE);
+                    uint32_t const end_y = std::min(y1, (block_y + 1) * BLOCK_SIZE);
+                    for (uint32_t y = start_y; y < end_y; ++y) {
+                        const float* const pixels = &m_depth[size_t {y} * m_width];
+                        for (uint32_t x = start_x; x < end_x; x += WIDTH) {
+                            if (simd::any(box_depth < simd::load(pixels + x))) {
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    void OcclusionBuffer::cull(const culling::BoxArray& boxes,
+                               const std::vector<uint32_t>& candidates,
+                               std::vector<uint32_t>& visible,
+                               utils::jobs::JobSystem& jobs) const {
+        std::vector<uint8_t> passed(candidates.size(), 0);
+        auto const body = [this, &boxes, &candidates, &passed](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) {
+                passed[i] = occluded(boxes.box(candidates[i])) ? 0 : 1;
+            }
+        };
+        utils::parallel::parallel_for(jobs, candidates.size(), TEST_GRAIN, body);
+
+        visible.clear();
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (passed[i] != 0) {
+                visible.push_back(candidates[i]);
+            }
+        }
+    }
+}    // namespace scene::occlusion
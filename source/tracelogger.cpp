@@ -8,7 +8,7 @@
 #include "domkrat3d/_default.hpp"
 #include "domkrat3d/tracelogger.hpp"
 
-std::string TraceLogger::Indent = "";
+thread_local std::string TraceLogger::Indent = "";
 
 TraceLogger::TraceLogger(const char* filename, const char* funcname, int linenumber)
     : m_FILENAME(filename)
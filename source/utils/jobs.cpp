@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    // Rounds of stealing an idle worker tries before it goes to sleep.
+    constexpr int SPIN_ROUNDS = 64;
+
+    constexpr size_t NOT_A_WORKER = SIZE_MAX;
+
+    // Which system and deque the current thread works for.
+    struct WorkerIdentity {
+        const void* system = nullptr;
+        size_t index = NOT_A_WORKER;
+    };
+
+    auto identity() -> WorkerIdentity& {
+        thread_local WorkerIdentity worker;
+        return worker;
+    }
+}    // namespace
+
+namespace utils::jobs {
+    JobSystem::WorkDeque::WorkDeque()
+        : m_slots(new std::atomic<Job*>[CAPACITY]) {}
+
+    auto JobSystem::WorkDeque::push(Job* job) -> bool {
+        int64_t const bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t const top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= CAPACITY) {
+            return false;
+        }
+
+        m_slots[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto JobSystem::WorkDeque::pop() -> Job* {
+        int64_t const bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = m_slots[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last job: a thief may take it at the same time, the top decides.
+            if (!m_top.compare_exchange_strong(
+                    top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    auto JobSystem::WorkDeque::steal() -> Job* {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t const bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Job* const job = m_slots[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        bool const taken =
+            m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        return taken ? job : nullptr;
+    }
+
+    void JobSystem::JobQueue::push(Job* job) {
+        if (m_size == m_ring.size()) {
+            std::vector<Job*> ring(std::max<size_t>(64, m_ring.size() * 2));
+            for (size_t i = 0; i < m_size; ++i) {
+                ring[i] = m_ring[(m_head + i) % m_ring.size()];
+            }
+            m_ring.swap(ring);
+            m_head = 0;
+        }
+
+        m_ring[(m_head + m_size) % m_ring.size()] = job;
+        ++m_size;
+    }
+
+    auto JobSystem::JobQueue::pop() -> Job* {
+        Job* const job = m_ring[m_head];
+        m_head = (m_head + 1) % m_ring.size();
+        --m_size;
+        return job;
+    }
+
+    JobSystem::JobSystem(size_t threads) {
+        LOG_TRACE
+
+        size_t const workers = std::max<size_t>(threads, 1) - 1;
+        for (size_t i = 0; i < workers; ++i) {
+            m_deques.push_back(std::make_unique<WorkDeque>());
+        }
+
+        m_workers.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            m_workers.emplace_back([this, i]() { work(i); });
+        }
+        for (PinnedThread& pinned : m_pinned) {
+            pinned.thread = std::thread([this, &pinned]() { serve(pinned); });
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> const guard(m_sleep_mutex);
+            m_stop.store(true);
+        }
+        m_wake.notify_all();
+
+        for (PinnedThread& pinned : m_pinned) {
+            {
+                std::lock_guard<std::mutex> const guard(pinned.mutex);
+            }
+            pinned.wake.notify_all();
+        }
+
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+        for (PinnedThread& pinned : m_pinned) {
+            pinned.thread.join();
+        }
+    }
+
+    void JobSystem::execute(Job& job) {
+        // Read the counter first: once it drops, the submitter may release the job.
+        Counter* const counter = job.counter;
+        job.function(job);
+        counter->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void JobSystem::submit(Job* jobs, size_t count, Counter& counter) {
+        if (count == 0) {
+            return;
+        }
+
+        counter.m_pending.fetch_add(count, std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            jobs[i].counter = &counter;
+        }
+
+        WorkerIdentity const& worker = identity();
+        if (worker.system == this) {
+            WorkDeque& deque = *m_deques[worker.index];
+            for (size_t i = 0; i < count; ++i) {
+                if (!deque.push(&jobs[i])) {
+                    execute(jobs[i]);
+                }
+            }
+        } else {
+            std::lock_guard<std::mutex> const guard(m_shared_mutex);
+            for (size_t i = 0; i < count; ++i) {
+                m_shared.push(&jobs[i]);
+            }
+            m_shared_size.store(m_shared.size(), std::memory_order_release);
+        }
+        notify();
+    }
+
+    void JobSystem::submit(Pinned thread, Job* jobs, size_t count, Counter& counter) {
+        if (count == 0) {
+            return;
+        }
+
+        counter.m_pending.fetch_add(count, std::memory_order_relaxed);
+        PinnedThread& pinned = m_pinned[static_cast<size_t>(thread)];
+        {
+            std::lock_guard<std::mutex> const guard(pinned.mutex);
+            for (size_t i = 0; i < count; ++i) {
+                jobs[i].counter = &counter;
+                pinned.queue.push(&jobs[i]);
+            }
+        }
+        pinned.wake.notify_one();
+    }
+
+    void JobSystem::notify() {
+        // Sleepers re-check the epoch under the lock, so a wake-up between their last look for
+        // work and their wait is not lost.
+        m_epoch.fetch_add(1);
+        if (m_sleepers.load() > 0) {
+            std::lock_guard<std::mutex> const guard(m_sleep_mutex);
+            m_wake.notify_all();
+        }
+    }
+
+    auto JobSystem::find_job(size_t index) -> Job* {
+        if (index != NOT_A_WORKER) {
+            if (Job* job = m_deques[index]->pop()) {
+                return job;
+            }
+        }
+
+        if (m_shared_size.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> const guard(m_shared_mutex);
+            if (!m_shared.empty()) {
+                Job* const job = m_shared.pop();
+                m_shared_size.store(m_shared.size(), std::memory_order_release);
+                return job;
+            }
+        }
+
+        // Victims in turn, starting next to the thief so thieves spread over the deques.
+        size_t const count = m_deques.size();
+        size_t const start = index == NOT_A_WORKER ? 0 : index + 1;
+        for (size_t i = 0; i < count; ++i) {
+            size_t const victim = (start + i) % count;
+            if (victim == index) {
+                continue;
+            }
+            if (Job* job = m_deques[victim]->steal()) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void JobSystem::work(size_t index) {
+        identity() = {this, index};
+
+        int idle = 0;
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            uint64_t const epoch = m_epoch.load();
+            if (Job* job = find_job(index)) {
+                execute(*job);
+                idle = 0;
+                continue;
+            }
+
+            if (++idle < SPIN_ROUNDS) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleepers.fetch_add(1);
+            m_wake.wait(lock, [this, epoch]() { return m_stop.load() || m_epoch.load() != epoch; });
+            m_sleepers.fetch_sub(1);
+            idle = 0;
+        }
+    }
+
+    void JobSystem::serve(PinnedThread& pinned) {
+        while (true) {
+            Job* job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(pinned.mutex);
+                pinned.wake.wait(lock, [this, &pinned]() { return m_stop.load() || !pinned.queue.empty(); });
+                if (pinned.queue.empty()) {
+                    return;
+                }
+                job = pinned.queue.pop();
+            }
+            execute(*job);
+        }
+    }
+
+    void JobSystem::wait(const Counter& counter) {
+        WorkerIdentity const& worker = identity();
+        size_t const index = worker.system == this ? worker.index : NOT_A_WORKER;
+
+        while (!counter.done()) {
+            if (Job* job = find_job(index)) {
+                execute(*job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    auto JobSystem::run_one() -> bool {
+        WorkerIdentity const& worker = identity();
+        Job* const job = find_job(worker.system == this ? worker.index : NOT_A_WORKER);
+        if (job == nullptr) {
+            return false;
+        }
+
+        execute(*job);
+        return true;
+    }
+
+    auto global() -> JobSystem& {
+        static JobSystem system(std::max<size_t>(1, std::thread::hardware_concurrency()));
+        return system;
+    }
+}    // namespace utils::jobs
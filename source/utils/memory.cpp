@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "domkrat3d/utils/memory.hpp"
+
+#include "domkrat3d/tracelogger.hpp"
+
+namespace {
+    // Blocks start on a cache line, so allocations from different threads share lines only
+    // when they are small.
+    constexpr size_t BLOCK_ALIGNMENT = 64;
+
+    auto align_up(uintptr_t value, size_t alignment) -> uintptr_t {
+        return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    }
+
+    // Bytes from `offset` into a block to the next address with `alignment`.
+    auto aligned_offset(const std::byte* block, size_t offset, size_t alignment) -> size_t {
+        auto const base = reinterpret_cast<uintptr_t>(block);
+        return static_cast<size_t>(align_up(base + offset, alignment) - base);
+    }
+}    // namespace
+
+namespace utils::memory {
+    LinearArena::LinearArena(size_t capacity, std::pmr::memory_resource* upstream)
+        : m_upstream(upstream)
+        , m_capacity(capacity) {
+        LOG_TRACE
+
+        if (m_capacity > 0) {
+            m_block = static_cast<std::byte*>(m_upstream->allocate(m_capacity, BLOCK_ALIGNMENT));
+        }
+    }
+
+    LinearArena::~LinearArena() {
+        for (const Overflow& overflow : m_overflow) {
+            m_upstream->deallocate(overflow.data, overflow.size, overflow.alignment);
+        }
+        if (m_block != nullptr) {
+            m_upstream->deallocate(m_block, m_capacity, BLOCK_ALIGNMENT);
+        }
+    }
+
+    auto LinearArena::do_allocate(size_t bytes, size_t alignment) -> void* {
+        size_t offset = m_offset.load(std::memory_order_relaxed);
+        while (m_block != nullptr) {
+            size_t const start = aligned_offset(m_block, offset, alignment);
+            if (start + bytes > m_capacity) {
+                break;
+            }
+            if (m_offset.compare_exchange_weak(offset, start + bytes, std::memory_order_relaxed)) {
+                return m_block + start;
+            }
+        }
+
+        std::lock_guard<std::mutex> const guard(m_overflow_mutex);
+        void* const data = m_upstream->allocate(bytes, alignment);
+        m_overflow.push_back({data, bytes, alignment});
+        m_overflow_bytes += bytes;
+        return data;
+    }
+
+    void LinearArena::do_deallocate(void* /*data*/, size_t /*bytes*/, size_t /*alignment*/) {}
+
+    auto LinearArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool {
+        return this == &other;
+    }
+
+    auto LinearArena::used() const -> size_t {
+        std::lock_guard<std::mutex> const guard(m_overflow_mutex);
+        return std::min(m_offset.load(std::memory_order_relaxed), m_capacity) + m_overflow_bytes;
+    }
+
+    void LinearArena::reset() {
+        m_peak = std::max(m_peak, used());
+
+        if (!m_overflow.empty()) {
+            for (const Overflow& overflow : m_overflow) {
+                m_upstream->deallocate(overflow.data, overflow.size, overflow.alignment);
+            }
+            m_overflow.clear();
+            m_overflow_bytes = 0;
+
+            // A quarter over the peak leaves room for alignment padding and a slightly busier frame.
+            if (m_block != nullptr) {
+                m_upstream->deallocate(m_block, m_capacity, BLOCK_ALIGNMENT);
+            }
+            m_capacity = m_peak + m_peak / 4;
+            m_block = static_cast<std::byte*>(m_upstream->allocate(m_capacity, BLOCK_ALIGNMENT));
+        }
+
+        m_offset.store(0, std::memory_order_relaxed);
+    }
+
+    ScratchStack::ScratchStack(size_t block_size)
+        : m_block_size(std::max<size_t>(block_size, BLOCK_ALIGNMENT)) {}
+
+    ScratchStack::~ScratchStack() {
+        for (const Block& block : m_blocks) {
+            ::operator delete(block.data, std::align_val_t {BLOCK_ALIGNMENT});
+        }
+    }
+
+    auto ScratchStack::do_allocate(size_t bytes, size_t alignment) -> void* {
+        // Blocks past the current one are free; take the first that fits.
+        for (; m_current < m_blocks.size(); ++m_current, m_offset = 0) {
+            const Block& block = m_blocks[m_current];
+            size_t const start = aligned_offset(block.data, m_offset, alignment);
+            if (start + bytes <= block.size) {
+                m_offset = start + bytes;
+                return block.data + start;
+            }
+        }
+
+        size_t const size = std::max(m_block_size, bytes + alignment);
+        auto* const data = static_cast<std::byte*>(::operator new(size, std::align_val_t {BLOCK_ALIGNMENT}));
+        m_blocks.push_back({data, size});
+        m_current = m_blocks.size() - 1;
+
+        size_t const start = aligned_offset(data, 0, alignment);
+        m_offset = start + bytes;
+        return data + start;
+    }
+
+    void ScratchStack::do_deallocate(void* data, size_t bytes, size_t /*alignment*/) {
+        if (m_current < m_blocks.size()) {
+            std::byte* const block = m_blocks[m_current].data;
+            if (static_cast<std::byte*>(data) + bytes == block + m_offset) {
+                m_offset = static_cast<size_t>(static_cast<std::byte*>(data) - block);
+            }
+        }
+    }
+
+    auto ScratchStack::do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool {
+        return this == &other;
+    }
+
+    void ScratchStack::rewind(Marker marker) {
+        m_current = marker.block;
+        m_offset = marker.offset;
+    }
+
+    auto ScratchStack::reserved() const -> size_t {
+        size_t bytes = 0;
+        for (const Block& block : m_blocks) {
+            bytes += block.size;
+        }
+        return bytes;
+    }
+
+    auto scratch() -> ScratchStack& {
+        thread_local ScratchStack stack;
+        return stack;
+    }
+}    // namespace utils::memory
@@ -0,0 +1,727 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "domkrat3d/utils/noise.hpp"
+
+#include "domkrat3d/mathematics/simd.hpp"
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    using namespace mathematics::simd;
+    using utils::noise::Fractal;
+    using utils::noise::NoiseSettings;
+    using utils::noise::NoiseType;
+
+    constexpr auto WIDTH = static_cast<size_t>(LANES);
+
+    // Large primes spreading lattice coordinates over the 32-bit hash space.
+    constexpr int32_t PRIME_X = 501125321;
+    constexpr int32_t PRIME_Y = 1136930381;
+    constexpr int32_t PRIME_Z = 1720413743;
+    constexpr int32_t PRIME_W = 1066037191;
+    constexpr int32_t HASH_MULTIPLIER = 0x27D4EB2D;
+
+    // Samples per parallel chunk when filling grids.
+    constexpr size_t GRID_GRAIN = 8192;
+
+    constexpr float F2 = 0.366025403784438647F;    // (sqrt(3) - 1) / 2
+    constexpr float G2 = 0.211324865405187118F;    // (3 - sqrt(3)) / 6
+    constexpr float F3 = 1.0F / 3.0F;
+    constexpr float G3 = 1.0F / 6.0F;
+    constexpr float F4 = 0.309016994374947424F;    // (sqrt(5) - 1) / 4
+    constexpr float G4 = 0.138196601125010515F;    // (5 - sqrt(5)) / 20
+
+    inline auto finalize(int4 hash) -> int4 {
+        hash = hash * set1i(HASH_MULTIPLIER);
+        return hash ^ srl<15>(hash);
+    }
+
+    inline auto hash(int4 seed, int4 xp, int4 yp) -> int4 {
+        return finalize(seed ^ xp ^ yp);
+    }
+
+    inline auto hash(int4 seed, int4 xp, int4 yp, int4 zp) -> int4 {
+        return finalize(seed ^ xp ^ yp ^ zp);
+    }
+
+    inline auto hash(int4 seed, int4 xp, int4 yp, int4 zp, int4 wp) -> int4 {
+        return finalize(seed ^ xp ^ yp ^ zp ^ wp);
+    }
+
+    inline auto fade(float4 t) -> float4 {
+        return t * t * t * madd(t, madd(t, set1(6.0F), set1(-15.0F)), set1(10.0F));
+    }
+
+    // Hash mapped to [-1, 1].
+    inline auto hash_to_unit(int4 hash) -> float4 {
+        return to_float(hash) * set1(1.0F / 2147483648.0F);
+    }
+
+    // Sign-bit mask taken from bit `Bit` of the hash; XOR with it negates a lane.
+    template<int Bit>
+    inline auto flip_by_bit(int4 hash) -> float4 {
+        return as_float(sll<31 - Bit>(hash) & set1i(static_cast<int32_t>(0x80000000U)));
+    }
+
+    inline auto grad(int4 hash, float4 x, float4 y) -> float4 {
+        float4 const low = to_float(hash & set1i(7)) < set1(4.0F);
+        float4 const u = select(low, x, y);
+        float4 const v = select(low, y, x);
+
+        return (u ^ flip_by_bit<0>(hash)) + ((v + v) ^ flip_by_bit<1>(hash));
+    }
+
+    inline auto grad(int4 hash, float4 x, float4 y, float4 z) -> float4 {
+        float4 const h = to_float(hash & set1i(15));
+        float4 const x_or_z = (h == set1(12.0F)) | (h == set1(14.0F));
+        float4 const u = select(h < set1(8.0F), x, y);
+        float4 const v = select(h < set1(4.0F), y, select(x_or_z, x, z));
+
+        return (u ^ flip_by_bit<0>(hash)) + (v ^ flip_by_bit<1>(hash));
+    }
+
+    inline auto grad(int4 hash, float4 x, float4 y, float4 z, float4 w) -> float4 {
+        float4 const h = to_float(hash & set1i(31));
+        float4 const u = select(h < set1(24.0F), x, y);
+        float4 const v = select(h < set1(16.0F), y, z);
+        float4 const t = select(h < set1(8.0F), z, w);
+
+        return (u ^ flip_by_bit<0>(hash)) + (v ^ flip_by_bit<1>(hash)) + (t ^ flip_by_bit<2>(hash));
+    }
+
+    // Lattice cell of a coordinate: primed integer corner and fractional offset.
+    struct Cell {
+        int4 primed;
+        float4 offset;
+    };
+
+    inline auto cell(float4 coordinate, int32_t prime) -> Cell {
+        float4 const corner = floor(coordinate);
+        return {to_int(corner) * set1i(prime), coordinate - corner};
+    }
+
+    // Simplex corner contribution: max(radius - |d|^2, 0)^4 * gradient.
+    inline auto falloff(float4 radius, float4 distance_squared) -> float4 {
+        float4 t = max(radius - distance_squared, zero4());
+        t = t * t;
+        return t * t;
+    }
+
+    struct ValueKernel {
+        static auto eval(float4 x, float4 y, int4 seed) -> float4 {
+            Cell const cx = cell(x, PRIME_X);
+            Cell const cy = cell(y, PRIME_Y);
+            int4 const x1 = cx.primed + set1i(PRIME_X);
+            int4 const y1 = cy.primed + set1i(PRIME_Y);
+
+            float4 const u = fade(cx.offset);
+            float4 const v = fade(cy.offset);
+
+            float4 const bottom = lerp(hash_to_unit(hash(seed, cx.primed, cy.primed)),
+                                       hash_to_unit(hash(seed, x1, cy.primed)),
+                                       u);
+            float4 const top =
+                lerp(hash_to_unit(hash(seed, cx.primed, y1)), hash_to_unit(hash(seed, x1, y1)), u);
+
+            return lerp(bottom, top, v);
+        }
+
+        static auto eval(float4 x, float4 y, float4 z, int4 seed) -> float4 {
+            Cell const cx = cell(x, PRIME_X);
+            Cell const cy = cell(y, PRIME_Y);
+            Cell const cz = cell(z, PRIME_Z);
+            int4 const xs[2] = {cx.primed, cx.primed + set1i(PRIME_X)};
+            int4 const ys[2] = {cy.primed, cy.primed + set1i(PRIME_Y)};
+            int4 const zs[2] = {cz.primed, cz.primed + set1i(PRIME_Z)};
+
+            float4 const u = fade(cx.offset);
+            float4 const v = fade(cy.offset);
+            float4 const w = fade(cz.offset);
+
+            float4 layers[2];
+            for (size_t k = 0; k < 2; ++k) {
+                float4 const bottom = lerp(hash_to_unit(hash(seed, xs[0], ys[0], zs[k])),
+                                           hash_to_unit(hash(seed, xs[1], ys[0], zs[k])),
+                                           u);
+                float4 const top = lerp(hash_to_unit(hash(seed, xs[0], ys[1], zs[k])),
+                                        hash_to_unit(hash(seed, xs[1], ys[1], zs[k])),
+                                        u);
+                layers[k] = lerp(bottom, top, v);
+            }
+
+            return lerp(layers[0], layers[1], w);
+        }
+
+        static auto eval(float4 x, float4 y, float4 z, float4 w, int4 seed) -> float4 {
+            Cell const cx = cell(x, PRIME_X);
+            Cell const cy = cell(y, PRIME_Y);
+            Cell const cz = cell(z, PRIME_Z);
+            Cell const cw = cell(w, PRIME_W);
+            int4 const xs[2] = {cx.primed, cx.primed + set1i(PRIME_X)};
+            int4 const ys[2] = {cy.primed, cy.primed + set1i(PRIME_Y)};
+            int4 const zs[2] = {cz.primed, cz.primed + set1i(PRIME_Z)};
+            int4 const ws[2] = {cw.primed, cw.primed + set1i(PRIME_W)};
+
+            float4 const fx = fade(cx.offset);
+            float4 const fy = fade(cy.offset);
+            float4 const fz = fade(cz.offset);
+            float4 const fw = fade(cw.offset);
+
+            float4 volumes[2];
+            for (size_t l = 0; l < 2; ++l) {
+                float4 layers[2];
+                for (size_t k = 0; k < 2; ++k) {
+                    float4 const bottom = lerp(hash_to_unit(hash(seed, xs[0], ys[0], zs[k], ws[l])),
+                                               hash_to_unit(hash(seed, xs[1], ys[0], zs[k], ws[l])),
+                                               fx);
+                    float4 const top = lerp(hash_to_unit(hash(seed, xs[0], ys[1], zs[k], ws[l])),
+                                            hash_to_unit(hash(seed, xs[1], ys[1], zs[k], ws[l])),
+                                            fx);
+                    layers[k] = lerp(bottom, top, fy);
+                }
+                volumes[l] = lerp(layers[0], layers[1], fz);
+            }
+
+            return lerp(volumes[0], volumes[1], fw);
+        }
+    };
+
+    struct PerlinKernel {
+        static auto eval(float4 x, float4 y, int4 seed) -> float4 {
+            Cell const cx = cell(x, PRIME_X);
+            Cell const cy = cell(y, PRIME_Y);
+            int4 const x1 = cx.primed + set1i(PRIME_X);
+            int4 const y1 = cy.primed + set1i(PRIME_Y);
+            float4 const dx1 = cx.offset - set1(1.0F);
+            float4 const dy1 = cy.offset - set1(1.0F);
+
+            float4 const bottom = lerp(grad(hash(seed, cx.primed, cy.primed), cx.offset, cy.offset),
+                                       grad(hash(seed, x1, cy.primed), dx1, cy.offset),
+                                       fade(cx.offset));
+            float4 const top = lerp(grad(hash(seed, cx.primed, y1), cx.offset, dy1),
+                                    grad(hash(seed, x1, y1), dx1, dy1),
+                                    fade(cx.offset));
+
+            return lerp(bottom, top, fade(cy.offset)) * set1(0.507F);
+        }
+
+        static auto eval(float4 x, float4 y, float4 z, int4 seed) -> float4 {
+            Cell const cx = cell(x, PRIME_X);
+            Cell const cy = cell(y, PRIME_Y);
+            Cell const cz = cell(z, PRIME_Z);
+            int4 const xs[2] = {cx.primed, cx.primed + set1i(PRIME_X)};
+            int4 const ys[2] = {cy.primed, cy.primed + set1i(PRIME_Y)};
+            int4 const zs[2] = {cz.primed, cz.primed + set1i(PRIME_Z)};
+            float4 const dx[2] = {cx.offset, cx.offset - set1(1.0F)};
+            float4 const dy[2] = {cy.offset, cy.offset - set1(1.0F)};
+            float4 const dz[2] = {cz.offset, cz.offset - set1(1.0F)};
+
+            float4 const u = fade(cx.offset);
+            float4 const v = fade(cy.offset);
+
+            float4 layers[2];
+            for (size_t k = 0; k < 2; ++k) {
+                float4 const bottom = lerp(grad(hash(seed, xs[0], ys[0], zs[k]), dx[0], dy[0], dz[k]),
+                                           grad(hash(seed, xs[1], ys[0], zs[k]), dx[1], dy[0], dz[k]),
+                                           u);
+                float4 const top = lerp(grad(hash(seed, xs[0], ys[1], zs[k]), dx[0], dy[1], dz[k]),
+                                        grad(hash(seed, xs[1], ys[1], zs[k]), dx[1], dy[1], dz[k]),
+                                        u);
+                layers[k] = lerp(bottom, top, v);
+            }
+
+            return lerp(layers[0], layers[1], fade(cz.offset)) * set1(0.936F);
+        }
+
+        static auto eval(float4 x, float4 y, float4 z, float4 w, int4 seed) -> float4 {
+            Cell const cx = cell(x, PRIME_X);
+            Cell const cy = cell(y, PRIME_Y);
+            Cell const cz = cell(z, PRIME_Z);
+            Cell const cw = cell(w, PRIME_W);
+            int4 const xs[2] = {cx.primed, cx.primed + set1i(PRIME_X)};
+            int4 const ys[2] = {cy.primed, cy.primed + set1i(PRIME_Y)};
+            int4 const zs[2] = {cz.primed, cz.primed + set1i(PRIME_Z)};
+            int4 const ws[2] = {cw.primed, cw.primed + set1i(PRIME_W)};
+            float4 const dx[2] = {cx.offset, cx.offset - set1(1.0F)};
+            float4 const dy[2] = {cy.offset, cy.offset - set1(1.0F)};
+            float4 const dz[2] = {cz.offset, cz.offset - set1(1.0F)};
+            float4 const dw[2] = {cw.offset, cw.offset - set1(1.0F)};
+
+            float4 const fx = fade(cx.offset);
+            float4 const fy = fade(cy.offset);
+            float4 const fz = fade(cz.offset);
+
+            float4 volumes[2];
+            for (size_t l = 0; l < 2; ++l) {
+                float4 layers[2];
+                for (size_t k = 0; k < 2; ++k) {
+                    float4 const bottom =
+                        lerp(grad(hash(seed, xs[0], ys[0], zs[k], ws[l]), dx[0], dy[0], dz[k], dw[l]),
+                             grad(hash(seed, xs[1], ys[0], zs[k], ws[l]), dx[1], dy[0], dz[k], dw[l]),
+                             fx);
+                    float4 const top =
+                        lerp(grad(hash(seed, xs[0], ys[1], zs[k], ws[l]), dx[0], dy[1], dz[k], dw[l]),
+                             grad(hash(seed, xs[1], ys[1], zs[k], ws[l]), dx[1], dy[1], dz[k], dw[l]),
+                             fx);
+                    layers[k] = lerp(bottom, top, fy);
+                }
+                volumes[l] = lerp(layers[0], layers[1], fz);
+            }
+
+            return lerp(volumes[0], volumes[1], fade(cw.offset)) * set1(0.87F);
+        }
+    };
+
+    struct SimplexKernel {
+        static auto eval(float4 x, float4 y, int4 seed) -> float4 {
+            float4 const skew = (x + y) * set1(F2);
+            float4 const i = floor(x + skew);
+            float4 const j = floor(y + skew);
+            float4 const unskew = (i + j) * set1(G2);
+
+            float4 const x0 = x - (i - unskew);
+            float4 const y0 = y - (j - unskew);
+
+            float4 const i1 = mask_to_one(x0 > y0);
+            float4 const j1 = set1(1.0F) - i1;
+
+            float4 const x1 = x0 - i1 + set1(G2);
+            float4 const y1 = y0 - j1 + set1(G2);
+            float4 const x2 = x0 - set1(1.0F - (2.0F * G2));
+            float4 const y2 = y0 - set1(1.0F - (2.0F * G2));
+
+            int4 const ip = to_int(i) * set1i(PRIME_X);
+            int4 const jp = to_int(j) * set1i(PRIME_Y);
+
+            float4 const n0 = falloff(set1(0.5F), (x0 * x0) + (y0 * y0)) * grad(hash(seed, ip, jp), x0, y0);
+            float4 const n1 = falloff(set1(0.5F), (x1 * x1) + (y1 * y1))
+                * grad(hash(seed, ip + (to_int(i1) * set1i(PRIME_X)), jp + (to_int(j1) * set1i(PRIME_Y))),
+                       x1,
+                       y1);
+            float4 const n2 = falloff(set1(0.5F), (x2 * x2) + (y2 * y2))
+                * grad(hash(seed, ip + set1i(PRIME_X), jp + set1i(PRIME_Y)), x2, y2);
+
+            return (n0 + n1 + n2) * set1(40.0F);
+        }
+
+        static auto eval(float4 x, float4 y, float4 z, int4 seed) -> float4 {
+            float4 const one = set1(1.0F);
+            float4 const skew = (x + y + z) * set1(F3);
+            float4 const i = floor(x + skew);
+            float4 const j = floor(y + skew);
+            float4 const k = floor(z + skew);
+            float4 const unskew = (i + j + k) * set1(G3);
+
+            float4 const x0 = x - (i - unskew);
+            float4 const y0 = y - (j - unskew);
+            float4 const z0 = z - (k - unskew);
+
+            // Simplex traversal order from the relative magnitudes of the offsets.
+            float4 const x_ge_y = x0 >= y0;
+            float4 const y_ge_z = y0 >= z0;
+            float4 const x_ge_z = x0 >= z0;
+
+            float4 const i1 = (x_ge_y & x_ge_z) & one;
+            float4 const j1 = andnot(x_ge_y, y_ge_z) & one;
+            float4 const k1 = andnot(x_ge_z | y_ge_z, one);
+            float4 const i2 = (x_ge_y | x_ge_z) & one;
+            float4 const j2 = andnot(x_ge_y, one) | (y_ge_z & one);
+            float4 const k2 = andnot(x_ge_z & y_ge_z, one);
+
+            float4 const x1 = x0 - i1 + set1(G3);
+            float4 const y1 = y0 - j1 + set1(G3);
+            float4 const z1 = z0 - k1 + set1(G3);
+            float4 const x2 = x0 - i2 + set1(2.0F * G3);
+            float4 const y2 = y0 - j2 + set1(2.0F * G3);
+            float4 const z2 = z0 - k2 + set1(2.0F * G3);
+            float4 const x3 = x0 - set1(1.0F - (3.0F * G3));
+            float4 const y3 = y0 - set1(1.0F - (3.0F * G3));
+            float4 const z3 = z0 - set1(1.0F - (3.0F * G3));
+
+            int4 const ip = to_int(i) * set1i(PRIME_X);
+            int4 const jp = to_int(j) * set1i(PRIME_Y);
+            int4 const kp = to_int(k) * set1i(PRIME_Z);
+
+            auto corner = [&](float4 dx, float4 dy, float4 dz, int4 h) -> float4
+            { return falloff(set1(0.6F), (dx * dx) + (dy * dy) + (dz * dz)) * grad(h, dx, dy, dz); };
+
+            float4 const n0 = corner(x0, y0, z0, hash(seed, ip, jp, kp));
+            float4 const n1 = corner(x1,
+                                     y1,
+                                     z1,
+                                     hash(seed,
+                                          ip + (to_int(i1) * set1i(PRIME_X)),
+                                          jp + (to_int(j1) * set1i(PRIME_Y)),
+                                          kp + (to_int(k1) * set1i(PRIME_Z))));
+            float4 const n2 = corner(x2,
+                                     y2,
+                                     z2,
+                                     hash(seed,
+                                          ip + (to_int(i2) * set1i(PRIME_X)),
+                                          jp + (to_int(j2) * set1i(PRIME_Y)),
+                                          kp + (to_int(k2) * set1i(PRIME_Z))));
+            float4 const n3 = corner(
+                x3, y3, z3, hash(seed, ip + set1i(PRIME_X), jp + set1i(PRIME_Y), kp + set1i(PRIME_Z)));
+
+            return (n0 + n1 + n2 + n3) * set1(32.0F);
+        }
+
+        static auto eval(float4 x, float4 y, float4 z, float4 w, int4 seed) -> float4 {
+            float4 const one = set1(1.0F);
+            float4 const skew = (x + y + z + w) * set1(F4);
+            float4 const i = floor(x + skew);
+            float4 const j = floor(y + skew);
+            float4 const k = floor(z + skew);
+            float4 const l = floor(w + skew);
+            float4 const unskew = (i + j + k + l) * set1(G4);
+
+            float4 const x0 = x - (i - unskew);
+            float4 const y0 = y - (j - unskew);
+            float4 const z0 = z - (k - unskew);
+            float4 const w0 = w - (l - unskew);
+
+            // Rank each axis by how many other offsets it exceeds.
+            float4 const x_gt_y = x0 > y0;
+            float4 const x_gt_z = x0 > z0;
+            float4 const x_gt_w = x0 > w0;
+            float4 const y_gt_z = y0 > z0;
+            float4 const y_gt_w = y0 > w0;
+            float4 const z_gt_w = z0 > w0;
+
+            float4 const rank_x = (x_gt_y & one) + (x_gt_z & one) + (x_gt_w & one);
+            float4 const rank_y = andnot(x_gt_y, one) + (y_gt_z & one) + (y_gt_w & one);
+            float4 const rank_z = andnot(x_gt_z, one) + andnot(y_gt_z, one) + (z_gt_w & one);
+            float4 const rank_w = andnot(x_gt_w, one) + andnot(y_gt_w, one) + andnot(z_gt_w, one);
+
+            float4 const offsets_x[3] = {mask_to_one(rank_x > set1(2.5F)),
+                                         mask_to_one(rank_x > set1(1.5F)),
+                                         mask_to_one(rank_x > set1(0.5F))};
+            float4 const offsets_y[3] = {mask_to_one(rank_y > set1(2.5F)),
+                                         mask_to_one(rank_y > set1(1.5F)),
+                                         mask_to_one(rank_y > set1(0.5F))};
+            float4 const offsets_z[3] = {mask_to_one(rank_z > set1(2.5F)),
+                                         mask_to_one(rank_z > set1(1.5F)),
+                                         mask_to_one(rank_z > set1(0.5F))};
+            float4 const offsets_w[3] = {mask_to_one(rank_w > set1(2.5F)),
+                                         mask_to_one(rank_w > set1(1.5F)),
+                                         mask_to_one(rank_w > set1(0.5F))};
+
+            int4 const ip = to_int(i) * set1i(PRIME_X);
+            int4 const jp = to_int(j) * set1i(PRIME_Y);
+            int4 const kp = to_int(k) * set1i(PRIME_Z);
+            int4 const lp = to_int(l) * set1i(PRIME_W);
+
+            auto corner = [&](float4 dx, float4 dy, float4 dz, float4 dw, int4 h) -> float4
+            {
+                float4 const distance = (dx * dx) + (dy * dy) + (dz * dz) + (dw * dw);
+                return falloff(set1(0.6F), distance) * grad(h, dx, dy, dz, dw);
+            };
+
+            float4 sum = corner(x0, y0, z0, w0, hash(seed, ip, jp, kp, lp));
+
+            for (size_t c = 0; c < 3; ++c) {
+                float4 const bias = set1(static_cast<float>(c + 1) * G4);
+                sum = sum
+                    + corner(x0 - offsets_x[c] + bias,
+                             y0 - offsets_y[c] + bias,
+                             z0 - offsets_z[c] + bias,
+                             w0 - offsets_w[c] + bias,
+                             hash(seed,
+                                  ip + (to_int(offsets_x[c]) * set1i(PRIME_X)),
+                                  jp + (to_int(offsets_y[c]) * set1i(PRIME_Y)),
+                                  kp + (to_int(offsets_z[c]) * set1i(PRIME_Z)),
+                                  lp + (to_int(offsets_w[c]) * set1i(PRIME_W))));
+            }
+
+            float4 const last = set1(1.0F - (4.0F * G4));
+            sum = sum
+                + corner(x0 - last,
+                         y0 - last,
+                         z0 - last,
+                         w0 - last,
+                         hash(seed,
+                              ip + set1i(PRIME_X),
+                              jp + set1i(PRIME_Y),
+                              kp + set1i(PRIME_Z),
+                              lp + set1i(PRIME_W)));
+
+            return sum * set1(27.0F);
+        }
+    };
+
+    /**
+     * Base noise summed over octaves. Coordinates are scaled by the
+     * frequency first and by the lacunarity after every octave; each octave
+     * uses the next seed so octaves are decorrelated.
+     */
+    template<typename Kernel, typename... Coords>
+    inline auto fractal(const NoiseSettings& settings, Coords... coords) -> float4 {
+        float4 const frequency = set1(settings.frequency);
+        ((coords = coords * frequency), ...);
+
+        int4 seed = set1i(static_cast<int32_t>(settings.seed));
+
+        if (settings.fractal == Fractal::None) {
+            return Kernel::eval(coords..., seed);
+        }
+
+        // A single octave still goes through the fractal, which reshapes it when ridged.
+        int const octaves = std::max(settings.octaves, 1);
+        float4 const lacunarity = set1(settings.lacunarity);
+        float4 sum = zero4();
+        float amplitude = 1.0F;
+        float total = 0.0F;
+
+        for (int octave = 0; octave < octaves; ++octave) {
+            float4 layer = Kernel::eval(coords..., seed);
+
+            if (settings.fractal == Fractal::Ridged) {
+                layer = set1(1.0F) - (set1(2.0F) * abs(layer));
+            }
+
+            sum = madd(layer, set1(amplitude), sum);
+            total += amplitude;
+            amplitude *= settings.gain;
+
+            ((coords = coords * lacunarity), ...);
+            seed = seed + set1i(1);
+        }
+
+        return sum * set1(1.0F / total);
+    }
+
+    template<typename Visitor>
+    inline void with_kernel(NoiseType type, Visitor&& visitor) {
+        switch (type) {
+            case NoiseType::Value:
+                visitor(ValueKernel {});
+                break;
+            case NoiseType::Perlin:
+                visitor(PerlinKernel {});
+                break;
+            case NoiseType::Simplex:
+                visitor(SimplexKernel {});
+                break;
+        }
+    }
+
+    template<typename Kernel, size_t... Axis>
+    void evaluate_points(const NoiseSettings& settings,
+                         const float* const* axes,
+                         float* out,
+                         size_t count,
+                         std::index_sequence<Axis...> /*axes*/) {
+        size_t i = 0;
+
+        for (; i + WIDTH <= count; i += WIDTH) {
+            store(out + i, fractal<Kernel>(settings, load(axes[Axis] + i)...));
+        }
+
+        if (i == count) {
+            return;
+        }
+
+        // Pad the tail to a full vector.
+        float tail[sizeof...(Axis)][WIDTH] = {};
+        for (size_t axis = 0; axis < sizeof...(Axis); ++axis) {
+            std::copy(axes[axis] + i, axes[axis] + count, tail[axis]);
+        }
+
+        float result[WIDTH];
+        store(result, fractal<Kernel>(settings, load(tail[Axis])...));
+        std::copy(result, result + (count - i), out + i);
+    }
+
+    template<size_t Dimensions>
+    void evaluate_any(const NoiseSettings& settings, const float* const* axes, float* out, size_t count) {
+        with_kernel(settings.type,
+                    [&](auto kernel)
+                    {
+                        using Kernel = decltype(kernel);
+                        evaluate_points<Kernel>(
+                            settings, axes, out, count, std::make_index_sequence<Dimensions> {});
+                    });
+    }
+
+    // One grid row along x; the remaining coordinates are fixed for the row.
+    template<typename Kernel, typename... Fixed>
+    void evaluate_row(const NoiseSettings& settings,
+                      float* out,
+                      size_t width,
+                      float origin_x,
+                      float step,
+                      Fixed... fixed) {
+        float4 const origin = set1(origin_x);
+        float4 const spacing = set1(step);
+        float4 const lane_index = set(0.0F, 1.0F, 2.0F, 3.0F);
+        size_t column = 0;
+
+        for (; column + WIDTH <= width; column += WIDTH) {
+            float4 const x = madd(set1(static_cast<float>(column)) + lane_index, spacing, origin);
+            store(out + column, fractal<Kernel>(settings, x, set1(fixed)...));
+        }
+
+        if (column < width) {
+            float4 const x = madd(set1(static_cast<float>(column)) + lane_index, spacing, origin);
+            float result[WIDTH];
+            store(result, fractal<Kernel>(settings, x, set1(fixed)...));
+            std::copy(result, result + (width - column), out + column);
+        }
+    }
+
+    auto rows_per_chunk(size_t width) -> size_t {
+        return std::max<size_t>(1, GRID_GRAIN / std::max<size_t>(width, 1));
+    }
+}    // namespace
+
+namespace utils::noise {
+    auto value(float x, float y, uint32_t seed) -> float {
+        return first(ValueKernel::eval(set1(x), set1(y), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto value(float x, float y, float z, uint32_t seed) -> float {
+        return first(ValueKernel::eval(set1(x), set1(y), set1(z), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto value(float x, float y, float z, float w, uint32_t seed) -> float {
+        return first(
+            ValueKernel::eval(set1(x), set1(y), set1(z), set1(w), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto perlin(float x, float y, uint32_t seed) -> float {
+        return first(PerlinKernel::eval(set1(x), set1(y), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto perlin(float x, float y, float z, uint32_t seed) -> float {
+        return first(PerlinKernel::eval(set1(x), set1(y), set1(z), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto perlin(float x, float y, float z, float w, uint32_t seed) -> float {
+        return first(
+            PerlinKernel::eval(set1(x), set1(y), set1(z), set1(w), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto simplex(float x, float y, uint32_t seed) -> float {
+        return first(SimplexKernel::eval(set1(x), set1(y), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto simplex(float x, float y, float z, uint32_t seed) -> float {
+        return first(SimplexKernel::eval(set1(x), set1(y), set1(z), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto simplex(float x, float y, float z, float w, uint32_t seed) -> float {
+        return first(
+            SimplexKernel::eval(set1(x), set1(y), set1(z), set1(w), set1i(static_cast<int32_t>(seed))));
+    }
+
+    auto sample(const NoiseSettings& settings, float x, float y) -> float {
+        float result = 0.0F;
+        with_kernel(settings.type,
+                    [&](auto kernel)
+                    { result = first(fractal<decltype(kernel)>(settings, set1(x), set1(y))); });
+        return result;
+    }
+
+    auto sample(const NoiseSettings& settings, float x, float y, float z) -> float {
+        float result = 0.0F;
+        with_kernel(settings.type,
+                    [&](auto kernel)
+                    { result = first(fractal<decltype(kernel)>(settings, set1(x), set1(y), set1(z))); });
+        return result;
+    }
+
+    auto sample(const NoiseSettings& settings, float x, float y, float z, float w) -> float {
+        float result = 0.0F;
+        with_kernel(
+            settings.type,
+            [&](auto kernel)
+            { result = first(fractal<decltype(kernel)>(settings, set1(x), set1(y), set1(z), set1(w))); });
+        return result;
+    }
+
+    void evaluate(const NoiseSettings& settings, const float* x, const float* y, float* out, size_t count) {
+        const float* const axes[] = {x, y};
+        evaluate_any<2>(settings, axes, out, count);
+    }
+
+    void evaluate(const NoiseSettings& settings,
+                  const float* x,
+                  const float* y,
+                  const float* z,
+                  float* out,
+                  size_t count) {
+        const float* const axes[] = {x, y, z};
+        evaluate_any<3>(settings, axes, out, count);
+    }
+
+    void evaluate(const NoiseSettings& settings,
+                  const float* x,
+                  const float* y,
+                  const float* z,
+                  const float* w,
+                  float* out,
+                  size_t count) {
+        const float* const axes[] = {x, y, z, w};
+        evaluate_any<4>(settings, axes, out, count);
+    }
+
+    void evaluate_grid(const NoiseSettings& settings,
+                       float* out,
+                       size_t width,
+                       size_t height,
+                       float origin_x,
+                       float origin_y,
+                       float step) {
+        LOG_TRACE
+
+        with_kernel(settings.type,
+                    [&](auto kernel)
+                    {
+                        using Kernel = decltype(kernel);
+                        utils::parallel::parallel_for(
+                            height,
+                            rows_per_chunk(width),
+                            [&](size_t begin, size_t end)
+                            {
+                                for (size_t row = begin; row < end; ++row) {
+                                    float const y = origin_y + (static_cast<float>(row) * step);
+                                    evaluate_row<Kernel>(
+                                        settings, out + (row * width), width, origin_x, step, y);
+                                }
+                            });
+                    });
+    }
+
+    void evaluate_volume(const NoiseSettings& settings,
+                         float* out,
+                         size_t width,
+                         size_t height,
+                         size_t depth,
+                         float origin_x,
+                         float origin_y,
+                         float origin_z,
+                         float step) {
+        LOG_TRACE
+
+        with_kernel(settings.type,
+                    [&](auto kernel)
+                    {
+                        using Kernel = decltype(kernel);
+                        utils::parallel::parallel_for(
+                            height * depth,
+                            rows_per_chunk(width),
+                            [&](size_t begin, size_t end)
+                            {
+                                for (size_t row = begin; row < end; ++row) {
+                                    float const y = origin_y + (static_cast<float>(row % height) * step);
+                                    float const z = origin_z + (static_cast<float>(row / height) * step);
+                                    evaluate_row<Kernel>(
+                                        settings, out + (row * width), width, origin_x, step, y, z);
+                                }
+                            });
+                    });
+    }
+}    // namespace utils::noise
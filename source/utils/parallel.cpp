@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "domkrat3d/utils/parallel.hpp"
+
+#include "domkrat3d/utils/jobs.hpp"
+#include "domkrat3d/utils/memory.hpp"
+
+namespace {
+    void run_range(const utils::jobs::Job& job) {
+        (*static_cast<const utils::parallel::RangeBody*>(job.context))(job.begin, job.end);
+    }
+}    // namespace
+
+namespace utils::parallel {
+    auto worker_count() -> size_t {
+        return jobs::global().thread_count();
+    }
+
+    void parallel_for(jobs::JobSystem& system, size_t count, size_t grain, const RangeBody& body) {
+        if (count == 0) {
+            return;
+        }
+
+        grain = std::max<size_t>(grain, 1);
+        size_t const threads = system.thread_count();
+
+        if (count <= grain || threads == 1) {
+            body(0, count);
+            return;
+        }
+
+        // Several chunks per thread so uneven rows still balance out.
+        size_t const chunk = std::max(grain, count / (threads * 4));
+        size_t const chunks = (count + chunk - 1) / chunk;
+
+        memory::ScratchScope const scope;
+        std::pmr::vector<jobs::Job> ranges(chunks, &scope.resource());
+        for (size_t i = 0; i < chunks; ++i) {
+            ranges[i].function = run_range;
+            ranges[i].context = &body;
+            ranges[i].begin = i * chunk;
+            ranges[i].end = std::min(ranges[i].begin + chunk, count);
+        }
+
+        // The first chunk runs right here; the others wait for thieves or for wait() below.
+        jobs::Counter counter;
+        system.submit(ranges.data() + 1, chunks - 1, counter);
+        body(ranges[0].begin, ranges[0].end);
+        system.wait(counter);
+    }
+
+    void parallel_for(size_t count, size_t grain, const RangeBody& body) {
+        parallel_for(jobs::global(), count, grain, body);
+    }
+}    // namespace utils::parallel
@@ -1,12 +1,398 @@
-#include <cstdlib>
-#include <ctime>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
 
 #include "domkrat3d/utils/random.hpp"
 
+#include "domkrat3d/mathematics/simd.hpp"
 #include "domkrat3d/tracelogger.hpp"
 
+namespace {
+    constexpr float TWO_PI = 6.28318530717958647692F;
+
+    // Values produced per refill of the stack buffers used by the batch fills.
+    constexpr size_t CHUNK = 64;
+
+    constexpr uint64_t JUMP[4] = {
+        0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+
+    constexpr uint64_t LONG_JUMP[4] = {
+        0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL};
+
+    auto splitmix64(uint64_t& x) -> uint64_t {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31U);
+    }
+
+    auto stream_source() -> utils::random::Xoshiro256& {
+        static utils::random::Xoshiro256 source {
+            static_cast<uint64_t>(std::random_device {}())
+            ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())};
+        return source;
+    }
+
+    auto stream_source_mutex() -> std::mutex& {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    auto next_thread_stream() -> utils::random::Xoshiro256 {
+        std::lock_guard<std::mutex> const lock(stream_source_mutex());
+        return stream_source().split();
+    }
+
+    // Two 24-bit fractions out of every 64 random bits.
+    inline void bits_to_unit_floats(const uint64_t* bits, float* out, size_t pairs) {
+        for (size_t i = 0; i < pairs; ++i) {
+            auto const high = static_cast<int32_t>(bits[i] >> 40U);
+            auto const low = static_cast<int32_t>((bits[i] >> 8U) & 0xFFFFFFU);
+
+            out[2 * i] = static_cast<float>(high) * 0x1.0p-24F;
+            out[(2 * i) + 1] = static_cast<float>(low) * 0x1.0p-24F;
+        }
+    }
+
+    // Fills CHUNK unit floats in [0, 1).
+    inline void next_unit_chunk(utils::random::BatchEngine& engine, float* out) {
+        uint64_t bits[CHUNK / 2];
+
+        for (size_t i = 0; i < CHUNK / 2; i += utils::random::BatchEngine::LANES) {
+            engine.next_block(bits + i);
+        }
+
+        bits_to_unit_floats(bits, out, CHUNK / 2);
+    }
+
+    // Unit sphere directions for CHUNK samples, 4 lanes at a time.
+    void sphere_chunk(utils::random::BatchEngine& engine, float* x, float* y, float* z) {
+        using namespace mathematics::simd;
+
+        float u[CHUNK];
+        float v[CHUNK];
+        next_unit_chunk(engine, u);
+        next_unit_chunk(engine, v);
+
+        for (size_t i = 0; i < CHUNK; i += LANES) {
+            float4 const cos_theta = set1(1.0F) - (set1(2.0F) * load(u + i));
+            float4 const radius = sqrt(max(set1(1.0F) - (cos_theta * cos_theta), zero4()));
+
+            float4 sine;
+            float4 cosine;
+            sincos(load(v + i) * set1(TWO_PI), sine, cosine);
+
+            store(x + i, radius * cosine);
+            store(y + i, radius * sine);
+            store(z + i, cos_theta);
+        }
+    }
+}    // namespace
+
 auto generate_random_float() -> float {
     LOG_TRACE
-    std::srand(static_cast<unsigned int>(std::time(0)));
-    return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+
+    return utils::random::thread_engine().next_float();
 }
+
+namespace utils::random {
+    Xoshiro256::Xoshiro256(uint64_t seed)
+        : m_state {} {
+        for (auto& word : m_state) {
+            word = splitmix64(seed);
+        }
+    }
+
+    Xoshiro256::Xoshiro256(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3)
+        : m_state {s0, s1, s2, s3} {}
+
+    auto Xoshiro256::uniform_int(int32_t min, int32_t max) -> int32_t {
+        uint32_t const range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min) + 1U;
+
+        if (range == 0) {
+            return static_cast<int32_t>(static_cast<uint32_t>(next() >> 32U));
+        }
+
+        uint64_t product = (next() >> 32U) * range;
+        auto low = static_cast<uint32_t>(product);
+
+        if (low < range) {
+            uint32_t const threshold = (0U - range) % range;
+
+            while (low < threshold) {
+                product = (next() >> 32U) * range;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+
+        return static_cast<int32_t>(static_cast<uint32_t>(min) + static_cast<uint32_t>(product >> 32U));
+    }
+
+    auto Xoshiro256::normal(float mean, float stddev) -> float {
+        float const u1 = 1.0F - next_float();
+        float const u2 = next_float();
+
+        return mean + (stddev * std::sqrt(-2.0F * std::log(u1)) * std::cos(TWO_PI * u2));
+    }
+
+    void Xoshiro256::on_unit_sphere(float& x, float& y, float& z) {
+        float const cos_theta = 1.0F - (2.0F * next_float());
+        float const radius = std::sqrt(std::fmax(0.0F, 1.0F - (cos_theta * cos_theta)));
+        float const phi = TWO_PI * next_float();
+
+        x = radius * std::cos(phi);
+        y = radius * std::sin(phi);
+        z = cos_theta;
+    }
+
+    void Xoshiro256::apply_jump(const uint64_t (&polynomial)[4]) {
+        uint64_t s0 = 0;
+        uint64_t s1 = 0;
+        uint64_t s2 = 0;
+        uint64_t s3 = 0;
+
+        for (uint64_t const word : polynomial) {
+            for (unsigned int bit = 0; bit < 64; ++bit) {
+                if ((word & (1ULL << bit)) != 0) {
+                    s0 ^= m_state[0];
+                    s1 ^= m_state[1];
+                    s2 ^= m_state[2];
+                    s3 ^= m_state[3];
+                }
+                next();
+            }
+        }
+
+        m_state[0] = s0;
+        m_state[1] = s1;
+        m_state[2] = s2;
+        m_state[3] = s3;
+    }
+
+    void Xoshiro256::jump() {
+        apply_jump(JUMP);
+    }
+
+    void Xoshiro256::long_jump() {
+        apply_jump(LONG_JUMP);
+    }
+
+    auto Xoshiro256::split() -> Xoshiro256 {
+        Xoshiro256 const child = *this;
+        jump();
+        return child;
+    }
+
+    auto thread_engine() -> Xoshiro256& {
+        thread_local Xoshiro256 engine = next_thread_stream();
+        return engine;
+    }
+
+    void seed_thread_engines(uint64_t seed) {
+        LOG_TRACE
+
+        // Created before taking the lock: a first use splits its stream under that same lock.
+        Xoshiro256& engine = thread_engine();
+
+        std::lock_guard<std::mutex> const lock(stream_source_mutex());
+        stream_source() = Xoshiro256(seed);
+        engine = stream_source().split();
+    }
+
+    BatchEngine::BatchEngine(uint64_t seed)
+        : m_s0 {}
+        , m_s1 {}
+        , m_s2 {}
+        , m_s3 {} {
+        Xoshiro256 source(seed);
+        seed_lanes(source);
+    }
+
+    BatchEngine::BatchEngine(Xoshiro256& source)
+        : m_s0 {}
+        , m_s1 {}
+        , m_s2 {}
+        , m_s3 {} {
+        seed_lanes(source);
+    }
+
+    void BatchEngine::seed_lanes(Xoshiro256& source) {
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            Xoshiro256 const stream = source.split();
+
+            m_s0[lane] = stream.m_state[0];
+            m_s1[lane] = stream.m_state[1];
+            m_s2[lane] = stream.m_state[2];
+            m_s3[lane] = stream.m_state[3];
+        }
+    }
+
+    void BatchEngine::next_block(uint64_t* out) {
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            uint64_t const s1 = m_s1[lane];
+            uint64_t const times5 = (s1 << 2U) + s1;
+            uint64_t const rotated = (times5 << 7U) | (times5 >> 57U);
+            out[lane] = (rotated << 3U) + rotated;
+
+            uint64_t const shifted = s1 << 17U;
+            m_s2[lane] ^= m_s0[lane];
+            m_s3[lane] ^= s1;
+            m_s1[lane] = s1 ^ m_s2[lane];
+            m_s0[lane] ^= m_s3[lane];
+            m_s2[lane] ^= shifted;
+            m_s3[lane] = (m_s3[lane] << 45U) | (m_s3[lane] >> 19U);
+        }
+    }
+
+    void fill_bits(BatchEngine& engine, uint64_t* out, size_t count) {
+        uint64_t block[BatchEngine::LANES];
+        size_t i = 0;
+
+        for (; i + BatchEngine::LANES <= count; i += BatchEngine::LANES) {
+            engine.next_block(out + i);
+        }
+
+        if (i < count) {
+            engine.next_block(block);
+            for (size_t lane = 0; i < count; ++i, ++lane) {
+                out[i] = block[lane];
+            }
+        }
+    }
+
+    void fill_uniform(BatchEngine& engine, float* out, size_t count, float min, float max) {
+        float const scale = max - min;
+        float chunk[CHUNK];
+
+        for (size_t i = 0; i < count; i += CHUNK) {
+            next_unit_chunk(engine, chunk);
+
+            size_t const n = (count - i) < CHUNK ? (count - i) : CHUNK;
+            for (size_t j = 0; j < n; ++j) {
+                out[i + j] = min + (scale * chunk[j]);
+            }
+        }
+    }
+
+    void fill_uniform(BatchEngine& engine, double* out, size_t count, double min, double max) {
+        double const scale = max - min;
+        uint64_t bits[CHUNK];
+
+        for (size_t i = 0; i < count; i += CHUNK) {
+            size_t const n = (count - i) < CHUNK ? (count - i) : CHUNK;
+            fill_bits(engine, bits, n);
+
+            for (size_t j = 0; j < n; ++j) {
+                auto const mantissa = static_cast<int64_t>(bits[j] >> 11U);
+                out[i + j] = min + (scale * (static_cast<double>(mantissa) * 0x1.0p-53));
+            }
+        }
+    }
+
+    void fill_uniform_int(BatchEngine& engine, int32_t* out, size_t count, int32_t min, int32_t max) {
+        uint64_t const range =
+            static_cast<uint64_t>(static_cast<uint32_t>(max) - static_cast<uint32_t>(min)) + 1U;
+        uint64_t bits[CHUNK / 2];
+
+        for (size_t i = 0; i < count; i += CHUNK) {
+            size_t const n = (count - i) < CHUNK ? (count - i) : CHUNK;
+            fill_bits(engine, bits, (n + 1) / 2);
+
+            for (size_t j = 0; j < n; ++j) {
+                uint64_t const word = bits[j / 2];
+                uint64_t const half = (j % 2 == 0) ? (word >> 32U) : (word & 0xFFFFFFFFU);
+                out[i + j] = static_cast<int32_t>(static_cast<uint32_t>(min)
+                                                  + static_cast<uint32_t>((half * range) >> 32U));
+            }
+        }
+    }
+
+    void fill_normal(BatchEngine& engine, float* out, size_t count, float mean, float stddev) {
+        using namespace mathematics::simd;
+
+        float u[CHUNK];
+        float v[CHUNK];
+        float chunk[2 * CHUNK];
+
+        for (size_t i = 0; i < count; i += 2 * CHUNK) {
+            next_unit_chunk(engine, u);
+            next_unit_chunk(engine, v);
+
+            for (size_t j = 0; j < CHUNK; j += LANES) {
+                // 1 - u keeps the logarithm argument in (0, 1].
+                float4 const radius = sqrt(set1(-2.0F) * log(set1(1.0F) - load(u + j)));
+
+                float4 sine;
+                float4 cosine;
+                sincos(load(v + j) * set1(TWO_PI), sine, cosine);
+
+                store(chunk + j, madd(radius * cosine, set1(stddev), set1(mean)));
+                store(chunk + CHUNK + j, madd(radius * sine, set1(stddev), set1(mean)));
+            }
+
+            size_t const n = (count - i) < 2 * CHUNK ? (count - i) : 2 * CHUNK;
+            for (size_t j = 0; j < n; ++j) {
+                out[i + j] = chunk[j];
+            }
+        }
+    }
+
+    void fill_unit_sphere(BatchEngine& engine, float* x, float* y, float* z, size_t count) {
+        float cx[CHUNK];
+        float cy[CHUNK];
+        float cz[CHUNK];
+
+        for (size_t i = 0; i < count; i += CHUNK) {
+            sphere_chunk(engine, cx, cy, cz);
+
+            size_t const n = (count - i) < CHUNK ? (count - i) : CHUNK;
+            for (size_t j = 0; j < n; ++j) {
+                x[i + j] = cx[j];
+                y[i + j] = cy[j];
+                z[i + j] = cz[j];
+            }
+        }
+    }
+
+    void fill_hemisphere(BatchEngine& engine,
+                         float* x,
+                         float* y,
+                         float* z,
+                         size_t count,
+                         float nx,
+                         float ny,
+                         float nz) {
+        using namespace mathematics::simd;
+
+        float cx[CHUNK];
+        float cy[CHUNK];
+        float cz[CHUNK];
+
+        for (size_t i = 0; i < count; i += CHUNK) {
+            sphere_chunk(engine, cx, cy, cz);
+
+            // Mirror directions that point away from the normal.
+            for (size_t j = 0; j < CHUNK; j += LANES) {
+                float4 const dx = load(cx + j);
+                float4 const dy = load(cy + j);
+                float4 const dz = load(cz + j);
+                float4 const dot = madd(dx, set1(nx), madd(dy, set1(ny), dz * set1(nz)));
+                float4 const flip = dot < zero4();
+
+                store(cx + j, select(flip, -dx, dx));
+                store(cy + j, select(flip, -dy, dy));
+                store(cz + j, select(flip, -dz, dz));
+            }
+
+            size_t const n = (count - i) < CHUNK ? (count - i) : CHUNK;
+            for (size_t j = 0; j < n; ++j) {
+                x[i + j] = cx[j];
+                y[i + j] = cy[j];
+                z[i + j] = cz[j];
+            }
+        }
+    }
+}    // namespace utils::random
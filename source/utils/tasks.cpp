@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/utils/tasks.hpp"
+
+#include "domkrat3d/tracelogger.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    constexpr uint32_t NO_TASK = UINT32_MAX;
+
+    auto milliseconds(std::chrono::steady_clock::duration duration) -> double {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}    // namespace
+
+namespace utils::tasks {
+    TaskGraph::TaskGraph() {
+        LOG_TRACE
+    }
+
+    auto TaskGraph::add_resource(std::string name) -> ResourceId {
+        m_resources.push_back(std::move(name));
+        return static_cast<ResourceId>(m_resources.size() - 1);
+    }
+
+    auto TaskGraph::add_task(TaskDesc task) -> TaskId {
+        m_tasks.push_back({std::move(task)});
+        m_compiled = false;
+        return static_cast<TaskId>(m_tasks.size() - 1);
+    }
+
+    void TaskGraph::compile() {
+        LOG_TRACE
+
+        size_t const count = m_tasks.size();
+
+        // Walk the tasks in declaration order, tracking per resource the last writer and the
+        // readers since then.
+        std::vector<TaskId> last_writer(m_resources.size(), NO_TASK);
+        std::vector<std::vector<TaskId>> readers(m_resources.size());
+        std::vector<std::vector<TaskId>> predecessors(count);
+
+        for (TaskId task = 0; task < count; ++task) {
+            const TaskDesc& desc = m_tasks[task].desc;
+            std::vector<TaskId>& before = predecessors[task];
+
+            for (ResourceId const resource : desc.reads) {
+                if (last_writer[resource] != NO_TASK) {
+                    before.push_back(last_writer[resource]);
+                }
+            }
+            for (ResourceId const resource : desc.writes) {
+                if (last_writer[resource] != NO_TASK) {
+                    before.push_back(last_writer[resource]);
+                }
+                before.insert(before.end(), readers[resource].begin(), readers[resource].end());
+            }
+
+            std::sort(before.begin(), before.end());
+            before.erase(std::unique(before.begin(), before.end()), before.end());
+            before.erase(std::remove(before.begin(), before.end(), task), before.end());
+
+            for (ResourceId const resource : desc.reads) {
+                readers[resource].push_back(task);
+            }
+            for (ResourceId const resource : desc.writes) {
+                last_writer[resource] = task;
+                readers[resource].clear();
+            }
+        }
+
+        // Successor lists in one array; predecessors are visited in task order, so every list
+        // comes out sorted.
+        std::vector<uint32_t> successor_count(count, 0);
+        for (TaskId task = 0; task < count; ++task) {
+            for (TaskId const before : predecessors[task]) {
+                ++successor_count[before];
+            }
+        }
+
+        uint32_t offset = 0;
+        for (TaskId task = 0; task < count; ++task) {
+            m_tasks[task].predecessors = static_cast<uint32_t>(predecessors[task].size());
+            m_tasks[task].first_successor = offset;
+            m_tasks[task].successor_count = 0;
+            offset += successor_count[task];
+        }
+
+        m_successors.assign(offset, NO_TASK);
+        for (TaskId task = 0; task < count; ++task) {
+            for (TaskId const before : predecessors[task]) {
+                Task& source = m_tasks[before];
+                m_successors[source.first_successor + source.successor_count++] = task;
+            }
+        }
+
+        m_roots.clear();
+        for (TaskId task = 0; task < count; ++task) {
+            if (m_tasks[task].predecessors == 0) {
+                m_roots.push_back(task);
+            }
+        }
+
+        m_jobs.assign(count, jobs::Job {});
+        for (TaskId task = 0; task < count; ++task) {
+            m_jobs[task].function = run_job;
+            m_jobs[task].context = this;
+            m_jobs[task].begin = task;
+            m_jobs[task].end = task + 1;
+        }
+
+        m_remaining.reset(new std::atomic<uint32_t>[count]);
+        m_timings.assign(count, TaskTiming {});
+        m_main_ready.clear();
+        m_main_ready.reserve(count);
+        m_compiled = true;
+    }
+
+    auto TaskGraph::successors(TaskId task) const -> std::vector<TaskId> {
+        const Task& source = m_tasks[task];
+        auto const first = m_successors.begin() + source.first_successor;
+        return {first, first + source.successor_count};
+    }
+
+    void TaskGraph::run_job(const jobs::Job& job) {
+        // The graph hands itself out as the context of its own jobs.
+        auto* const graph = static_cast<TaskGraph*>(const_cast<void*>(job.context));
+        graph->execute(static_cast<TaskId>(job.begin));
+    }
+
+    void TaskGraph::schedule(TaskId task) {
+        if (m_tasks[task].desc.main_thread) {
+            std::lock_guard<std::mutex> const guard(m_main_mutex);
+            m_main_ready.push_back(task);
+        } else {
+            m_system->submit(&m_jobs[task], 1, m_counter);
+        }
+    }
+
+    auto TaskGraph::next_main_task(TaskId& task) -> bool {
+        std::lock_guard<std::mutex> const guard(m_main_mutex);
+        if (m_main_next == m_main_ready.size()) {
+            return false;
+        }
+
+        task = m_main_ready[m_main_next++];
+        return true;
+    }
+
+    void TaskGraph::execute(TaskId task) {
+        Clock::time_point const start = Clock::now();
+        m_tasks[task].desc.function();
+        Clock::time_point const end = Clock::now();
+        m_timings[task] = {milliseconds(start - m_frame_start), milliseconds(end - start)};
+
+        // Successors are scheduled before this task counts as finished, so run() cannot return
+        // while one of them is still to be queued.
+        const Task& source = m_tasks[task];
+        for (uint32_t i = 0; i < source.successor_count; ++i) {
+            TaskId const next = m_successors[source.first_successor + i];
+            if (m_remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                schedule(next);
+            }
+        }
+        m_finished.fetch_add(1, std::memory_order_release);
+    }
+
+    void TaskGraph::run(jobs::JobSystem& system) {
+        if (!m_compiled) {
+            compile();
+        }
+
+        m_system = &system;
+        m_frame_start = Clock::now();
+        m_finished.store(0, std::memory_order_relaxed);
+        m_main_ready.clear();
+        m_main_next = 0;
+        for (size_t task = 0; task < m_tasks.size(); ++task) {
+            m_remaining[task].store(m_tasks[task].predecessors, std::memory_order_relaxed);
+        }
+
+        for (TaskId const root : m_roots) {
+            schedule(root);
+        }
+
+        TaskId task = 0;
+        while (m_finished.load(std::memory_order_acquire) < m_tasks.size()) {
+            if (next_main_task(task)) {
+                execute(task);
+            } else if (!system.run_one()) {
+                std::this_thread::yield();
+            }
+        }
+
+        // The last jobs may still be returning; their slots are reused next frame.
+        system.wait(m_counter);
+        m_frame_time = milliseconds(Clock::now() - m_frame_start);
+    }
+
+    void TaskGraph::run() {
+        run(jobs::global());
+    }
+}    // namespace utils::tasks
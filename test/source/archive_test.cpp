@@ -0,0 +1,204 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/assets/archive.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    using assets::Archive;
+    using assets::ArchiveHeader;
+    using assets::AssetType;
+
+    using Bytes = std::vector<std::byte>;
+
+    constexpr size_t BLOB_COUNT = 40;
+
+    // Contents of blob `index`: a few pages at most, some of them empty.
+    auto contents(size_t index) -> std::vector<std::byte> {
+        std::vector<std::byte> data((index * 977) % 9000);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<std::byte>((i * 31) + index);
+        }
+        return data;
+    }
+
+    auto read_file(const fs::path& path) -> std::vector<std::byte> {
+        std::vector<std::byte> bytes(fs::file_size(path));
+        std::FILE* file = std::fopen(path.string().c_str(), "rb");
+        assert(file != nullptr);
+        [[maybe_unused]] size_t const read = std::fread(bytes.data(), 1, bytes.size(), file);
+        assert(read == bytes.size());
+        std::fclose(file);
+        return bytes;
+    }
+
+    void write_file(const fs::path& path, const std::vector<std::byte>& bytes) {
+        std::FILE* file = std::fopen(path.string().c_str(), "wb");
+        assert(file != nullptr);
+        [[maybe_unused]] size_t const written = std::fwrite(bytes.data(), 1, bytes.size(), file);
+        assert(written == bytes.size());
+        std::fclose(file);
+    }
+
+    auto opens(const fs::path& path) -> bool {
+        try {
+            Archive const archive(path.string());
+            return true;
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    // Opening a damaged copy of an archive fails.
+    template<typename Damage>
+    void check_rejected(const fs::path& path, const fs::path& copy, Damage&& damage) {
+        std::vector<std::byte> bytes = read_file(path);
+        damage(bytes);
+        write_file(copy, bytes);
+        assert(!opens(copy));
+    }
+
+    void set_header(std::vector<std::byte>& bytes, const ArchiveHeader& header) {
+        std::memcpy(bytes.data(), &header, sizeof(header));
+    }
+
+    auto header_of(const std::vector<std::byte>& bytes) -> ArchiveHeader {
+        ArchiveHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        return header;
+    }
+}    // namespace
+
+auto main() -> int {
+    fs::path const directory = fs::temp_directory_path() / "domkrat3d_archive_test";
+    fs::create_directories(directory);
+    fs::path const path = directory / "assets.pak";
+    fs::path const copy = directory / "damaged.pak";
+
+    // Blobs from memory, and one from a file larger than the copy buffer of the writer.
+    assets::ArchiveWriter writer;
+    for (size_t i = 0; i < BLOB_COUNT; ++i) {
+        writer.add("blob/" + std::to_string(i), static_cast<AssetType>(i % 4), contents(i));
+    }
+    std::vector<std::byte> large((3 << 20) + 5);
+    for (size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<std::byte>(i / 4096);
+    }
+    write_file(directory / "large.bin", large);
+    writer.add_file("large", AssetType::Texture, (directory / "large.bin").string());
+
+    bool thrown = false;
+    try {
+        writer.add("blob/3", AssetType::Raw, {});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    size_t const written = writer.write(path.string());
+    assert(written == fs::file_size(path));
+
+    {
+        Archive opened(path.string());
+        Archive const archive(std::move(opened));
+        assert(archive.size() == BLOB_COUNT + 1 && archive.file_size() == written);
+
+        for (size_t i = 0; i < BLOB_COUNT; ++i) {
+            std::string const name = "blob/" + std::to_string(i);
+            assets::Blob const blob = archive.find(name);
+            std::vector<std::byte> const expected = contents(i);
+            assert(blob && blob.name == name && blob.type == static_cast<AssetType>(i % 4));
+            assert(blob.size == expected.size());
+            assert(blob.size == 0 || std::memcmp(blob.data, expected.data(), blob.size) == 0);
+            assert(reinterpret_cast<uintptr_t>(blob.data) % assets::BLOB_ALIGNMENT == 0);
+            archive.prefetch(blob);
+        }
+        assets::Blob const blob = archive.find("large");
+        assert(blob && blob.type == AssetType::Texture && blob.size == large.size());
+        assert(std::memcmp(blob.data, large.data(), large.size()) == 0);
+        assert(!archive.find("blob/40") && !archive.find("") && !archive.find("blob"));
+
+        // File order is the order the blobs were added in.
+        std::vector<std::string> names;
+        archive.each([&names](const assets::Blob& each) { names.emplace_back(each.name); });
+        assert(names.size() == BLOB_COUNT + 1 && names.back() == "large");
+        for (size_t i = 0; i < BLOB_COUNT; ++i) {
+            assert(names[i] == "blob/" + std::to_string(i));
+        }
+
+        // Move assignment releases the old mapping and takes over the other one.
+        opened = Archive(path.string());
+        assert(opened.find("large").size == large.size());
+    }
+
+    // An empty archive is still valid.
+    assets::ArchiveWriter().write(copy.string());
+    assert(opens(copy) && Archive(copy.string()).size() == 0);
+
+    // Missing, truncated and corrupt files are rejected.
+    assert(!opens(directory / "missing.pak"));
+    check_rejected(path, copy, [](Bytes& bytes) { bytes.resize(sizeof(ArchiveHeader) / 2); });
+    check_rejected(path, copy, [](Bytes& bytes) { bytes.resize(bytes.size() / 2); });
+    check_rejected(path, copy, [](Bytes& bytes) { bytes[0] ^= std::byte {1}; });
+    check_rejected(path,
+                   copy,
+                   [](Bytes& bytes)
+                   {
+                       ArchiveHeader header = header_of(bytes);
+                       ++header.version;
+                       set_header(bytes, header);
+                   });
+    check_rejected(path,
+                   copy,
+                   [](Bytes& bytes)
+                   {
+                       ArchiveHeader header = header_of(bytes);
+                       header.slot_count += 1;
+                       set_header(bytes, header);
+                   });
+    check_rejected(path,
+                   copy,
+                   [](Bytes& bytes)
+                   {
+                       ArchiveHeader header = header_of(bytes);
+                       header.entry_count = header.slot_count;
+                       set_header(bytes, header);
+                   });
+    check_rejected(path,
+                   copy,
+                   [](Bytes& bytes)
+                   {
+                       ArchiveHeader header = header_of(bytes);
+                       header.table_offset = UINT64_MAX - 8;
+                       set_header(bytes, header);
+                   });
+    check_rejected(path,
+                   copy,
+                   [](Bytes& bytes)
+                   {
+                       ArchiveHeader header = header_of(bytes);
+                       header.names_size = bytes.size();
+                       set_header(bytes, header);
+                   });
+
+    // A changed name no longer matches the hash of its entry.
+    check_rejected(path,
+                   copy,
+                   [](Bytes& bytes)
+                   { bytes[static_cast<size_t>(header_of(bytes).names_offset)] ^= std::byte {1}; });
+
+    fs::remove_all(directory);
+
+    std::cout << "archive: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/broadphase.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using physics::broadphase::Pair;
+    using physics::broadphase::ProxyId;
+
+    constexpr size_t PROXY_COUNT = 600;
+    constexpr float WORLD_SIZE = 100.0F;
+
+    // Boxes indexed by proxy id; destroyed ids are marked dead.
+    struct Reference {
+        std::vector<Aabb> boxes;
+        std::vector<bool> alive;
+
+        void set(ProxyId proxy, const Aabb& box) {
+            if (proxy >= boxes.size()) {
+                boxes.resize(proxy + 1);
+                alive.resize(proxy + 1, false);
+            }
+            boxes[proxy] = box;
+            alive[proxy] = true;
+        }
+
+        auto pairs() const -> std::vector<uint64_t> {
+            std::vector<uint64_t> keys;
+            for (ProxyId a = 0; a < boxes.size(); ++a) {
+                for (ProxyId b = a + 1; b < boxes.size(); ++b) {
+                    if (alive[a] && alive[b] && mathematics::geometry::overlaps(boxes[a], boxes[b])) {
+                        keys.push_back((uint64_t {a} << 32) | b);
+                    }
+                }
+            }
+            return keys;
+        }
+    };
+
+    auto keys_of(const std::vector<Pair>& pairs) -> std::vector<uint64_t> {
+        std::vector<uint64_t> keys;
+        for (const Pair& pair : pairs) {
+            assert(pair.first < pair.second);
+            keys.push_back((uint64_t {pair.first} << 32) | pair.second);
+        }
+        std::sort(keys.begin(), keys.end());
+        assert(std::adjacent_find(keys.begin(), keys.end()) == keys.end());
+        return keys;
+    }
+
+    // Runs the same insert, move, remove and reinsert sequence on a broadphase and the reference.
+    template<typename Broadphase>
+    void check(Broadphase& broadphase) {
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> position(0.0F, WORLD_SIZE);
+        std::uniform_real_distribution<float> size(0.5F, 4.0F);
+        std::uniform_real_distribution<float> nudge(-0.5F, 0.5F);
+        auto const random_box = [&](Vec3 corner) -> Aabb
+        { return {corner, corner + Vec3 {size(random), size(random), size(random)}}; };
+
+        Reference reference;
+        std::vector<Pair> pairs;
+        auto const compare = [&]()
+        {
+            broadphase.find_pairs(pairs);
+            assert(keys_of(pairs) == reference.pairs());
+        };
+
+        std::vector<ProxyId> proxies;
+        for (size_t i = 0; i < PROXY_COUNT; ++i) {
+            Aabb const box = random_box({position(random), position(random), position(random)});
+            proxies.push_back(broadphase.create_proxy(box));
+            reference.set(proxies.back(), box);
+        }
+        compare();
+
+        // Small moves keep most proxies in their cells and order; every tenth one jumps across the world.
+        for (int frame = 0; frame < 4; ++frame) {
+            for (size_t i = 0; i < proxies.size(); ++i) {
+                Aabb box = reference.boxes[proxies[i]];
+                Vec3 const offset = i % 10 == 0
+                    ? Vec3 {position(random), position(random), position(random)} - box.min
+                    : Vec3 {nudge(random), nudge(random), nudge(random)};
+                box = {box.min + offset, box.max + offset};
+                broadphase.move_proxy(proxies[i], box);
+                reference.set(proxies[i], box);
+            }
+            compare();
+        }
+
+        // Every third proxy goes away, then new proxies take the freed ids.
+        std::vector<ProxyId> destroyed;
+        for (size_t i = 0; i < proxies.size(); i += 3) {
+            broadphase.destroy_proxy(proxies[i]);
+            reference.alive[proxies[i]] = false;
+            destroyed.push_back(proxies[i]);
+        }
+        compare();
+        assert(broadphase.proxy_count() == PROXY_COUNT - destroyed.size());
+
+        std::sort(destroyed.begin(), destroyed.end());
+        size_t reused = 0;
+        for (size_t i = 0; i < destroyed.size(); ++i) {
+            Aabb const box = random_box({position(random), position(random), position(random)});
+            ProxyId const proxy = broadphase.create_proxy(box);
+            if (std::binary_search(destroyed.begin(), destroyed.end(), proxy)) {
+                ++reused;
+            }
+            reference.set(proxy, box);
+        }
+        assert(reused == destroyed.size());
+        compare();
+        assert(broadphase.proxy_count() == PROXY_COUNT);
+    }
+}    // namespace
+
+auto main() -> int {
+    physics::broadphase::SpatialHash hash(4.0F);
+    check(hash);
+
+    for (auto const axis :
+         {physics::broadphase::Axis::X, physics::broadphase::Axis::Y, physics::broadphase::Axis::Z})
+    {
+        physics::broadphase::SweepAndPrune sweep(axis);
+        check(sweep);
+    }
+
+    std::cout << "broadphase: all checks passed\n";
+    return 0;
+}
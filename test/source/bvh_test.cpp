@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/bvh.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using mathematics::geometry::Plane;
+    using mathematics::geometry::Ray;
+    using physics::bvh::Bvh;
+    using physics::bvh::NO_PRIMITIVE;
+
+    constexpr size_t PRIMITIVE_COUNT = 20000;
+    constexpr size_t QUERY_COUNT = 200;
+    constexpr float WORLD_SIZE = 200.0F;
+    constexpr float TOLERANCE = 1e-3F;
+
+    auto sorted(std::vector<uint32_t> values) -> std::vector<uint32_t> {
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    auto in_front(const Aabb& box, const Plane* planes, size_t plane_count) -> bool {
+        for (size_t p = 0; p < plane_count; ++p) {
+            Vec3 const normal = planes[p].normal;
+            Vec3 const corner {normal.x >= 0.0F ? box.max.x : box.min.x,
+                               normal.y >= 0.0F ? box.max.y : box.min.y,
+                               normal.z >= 0.0F ? box.max.z : box.min.z};
+            if (mathematics::geometry::signed_distance(planes[p], corner) < 0.0F) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Every query of the tree against a scan over all boxes.
+    void check(const Bvh& bvh, const std::vector<Aabb>& boxes, std::mt19937& random) {
+        std::uniform_real_distribution<float> position(-WORLD_SIZE * 0.6F, WORLD_SIZE * 0.6F);
+        std::uniform_real_distribution<float> size(1.0F, 30.0F);
+        std::uniform_real_distribution<float> unit(-1.0F, 1.0F);
+        assert(bvh.primitive_count() == boxes.size());
+
+        std::vector<uint32_t> found;
+        std::vector<uint32_t> expected;
+        std::vector<Ray> rays;
+        for (size_t query = 0; query < QUERY_COUNT; ++query) {
+            Vec3 const corner {position(random), position(random), position(random)};
+            Aabb const box {corner, corner + Vec3 {size(random), size(random), size(random)}};
+            found.clear();
+            expected.clear();
+            bvh.overlap(box, found);
+            for (uint32_t i = 0; i < boxes.size(); ++i) {
+                if (mathematics::geometry::overlaps(box, boxes[i])) {
+                    expected.push_back(i);
+                }
+            }
+            assert(sorted(found) == expected);
+
+            // A slab of three planes, thick enough to hold a few hundred boxes.
+            Vec3 const normal = mathematics::normalize(Vec3 {unit(random), unit(random), unit(random)});
+            float const offset = position(random);
+            Plane const planes[3] = {{normal, -offset},
+                                     {-normal, offset + 20.0F},
+                                     {{0.0F, 1.0F, 0.0F}, WORLD_SIZE * 0.25F}};
+            found.clear();
+            expected.clear();
+            bvh.overlap(planes, 3, found);
+            for (uint32_t i = 0; i < boxes.size(); ++i) {
+                if (in_front(boxes[i], planes, 3)) {
+                    expected.push_back(i);
+                }
+            }
+            assert(sorted(found) == expected);
+
+            Ray ray {{position(random), position(random), position(random)},
+                     mathematics::normalize(Vec3 {unit(random), unit(random), unit(random)})};
+            ray.max_distance = query % 2 == 0 ? std::numeric_limits<float>::infinity() : 40.0F;
+            rays.push_back(ray);
+            float nearest = std::numeric_limits<float>::infinity();
+            for (const Aabb& candidate : boxes) {
+                float const distance = mathematics::geometry::intersect(ray, candidate);
+                if (distance <= ray.max_distance) {
+                    nearest = std::min(nearest, distance);
+                }
+            }
+            physics::bvh::RayHit const hit = bvh.raycast(ray);
+            if (std::isinf(nearest)) {
+                assert(hit.primitive == NO_PRIMITIVE && !bvh.occluded(ray));
+            } else {
+                assert(hit.primitive != NO_PRIMITIVE && std::fabs(hit.distance - nearest) <= TOLERANCE);
+                assert(std::fabs(mathematics::geometry::intersect(ray, boxes[hit.primitive]) - nearest)
+                       <= TOLERANCE);
+                assert(bvh.occluded(ray));
+            }
+
+            Vec3 const point {position(random), position(random), position(random)};
+            float closest = std::numeric_limits<float>::infinity();
+            for (const Aabb& candidate : boxes) {
+                Vec3 const on_box = mathematics::geometry::closest_point(candidate, point);
+                closest = std::min(closest, mathematics::length(on_box - point));
+            }
+            physics::bvh::ClosestHit const near = bvh.closest_point(point);
+            assert(near.primitive != NO_PRIMITIVE && std::fabs(near.distance - closest) <= TOLERANCE);
+        }
+
+        // The batched raycast agrees with one ray at a time.
+        std::vector<physics::bvh::RayHit> hits(rays.size());
+        bvh.raycast(rays.data(), hits.data(), rays.size());
+        for (size_t i = 0; i < rays.size(); ++i) {
+            physics::bvh::RayHit const single = bvh.raycast(rays[i]);
+            assert(hits[i].primitive == single.primitive);
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> position(-WORLD_SIZE * 0.5F, WORLD_SIZE * 0.5F);
+    std::uniform_real_distribution<float> size(0.1F, 3.0F);
+    std::uniform_real_distribution<float> drift(-5.0F, 5.0F);
+
+    std::vector<Aabb> boxes;
+    for (size_t i = 0; i < PRIMITIVE_COUNT; ++i) {
+        Vec3 const corner {position(random), position(random), position(random)};
+        boxes.push_back({corner, corner + Vec3 {size(random), size(random), size(random)}});
+    }
+
+    using physics::kinematics::Execution;
+    for (auto const execution : {Execution::Serial, Execution::Parallel}) {
+        Bvh bvh;
+        bvh.build(boxes.data(), boxes.size(), execution);
+        check(bvh, boxes, random);
+
+        // Primitives drift, and the refitted tree still answers exactly.
+        std::vector<Aabb> moved = boxes;
+        for (Aabb& box : moved) {
+            Vec3 const offset {drift(random), drift(random), drift(random)};
+            box = {box.min + offset, box.max + offset};
+        }
+        bvh.refit(moved.data());
+        check(bvh, moved, random);
+    }
+
+    // A tree of one primitive, and an empty one.
+    Bvh single;
+    single.build(boxes.data(), 1);
+    check(single, {boxes[0]}, random);
+
+    Bvh empty;
+    empty.build(boxes.data(), 0);
+    std::vector<uint32_t> found;
+    empty.overlap(boxes[0], found);
+    assert(found.empty() && empty.raycast({{}, {1.0F, 0.0F, 0.0F}}).primitive == NO_PRIMITIVE);
+
+    std::cout << "bvh: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/bvh.hpp"
+#include "domkrat3d/scene/culling.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using mathematics::Mat4;
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using scene::culling::CULL_CHUNK;
+    using scene::culling::Frustum;
+
+    // Distances this close to a plane may round either way between the SIMD and scalar sums.
+    constexpr float MARGIN = 1e-3F;
+
+    enum class Side
+    {
+        Inside,
+        Outside,
+        Edge,
+    };
+
+    // Scalar reference: the least distance of an object in front of the six planes, against zero.
+    template<typename Distance>
+    auto classify(const Frustum& frustum, Distance&& distance) -> Side {
+        float least = INFINITY;
+        for (const auto& plane : frustum.planes) {
+            least = std::min(least, distance(plane));
+        }
+        if (least > MARGIN) {
+            return Side::Inside;
+        }
+        return least < -MARGIN ? Side::Outside : Side::Edge;
+    }
+
+    auto sphere_side(const Frustum& frustum, Vec3 center, float radius) -> Side {
+        return classify(frustum,
+                        [center, radius](const mathematics::geometry::Plane& plane)
+                        { return mathematics::geometry::signed_distance(plane, center) + radius; });
+    }
+
+    // The corner farthest along the normal decides whether a box is behind a plane.
+    auto box_side(const Frustum& frustum, const Aabb& box) -> Side {
+        return classify(frustum,
+                        [&box](const mathematics::geometry::Plane& plane)
+                        {
+                            Vec3 const corner {plane.normal.x >= 0.0F ? box.max.x : box.min.x,
+                                               plane.normal.y >= 0.0F ? box.max.y : box.min.y,
+                                               plane.normal.z >= 0.0F ? box.max.z : box.min.z};
+                            return mathematics::geometry::signed_distance(plane, corner);
+                        });
+    }
+
+    // Visible lists are increasing, hold every object inside and none outside.
+    void check_visible(const std::vector<uint32_t>& visible, const std::vector<Side>& sides) {
+        assert(std::is_sorted(visible.begin(), visible.end()));
+        assert(std::adjacent_find(visible.begin(), visible.end()) == visible.end());
+        std::vector<bool> listed(sides.size(), false);
+        for (uint32_t const index : visible) {
+            assert(index < sides.size());
+            listed[index] = true;
+        }
+        for (size_t i = 0; i < sides.size(); ++i) {
+            assert(sides[i] == Side::Edge || listed[i] == (sides[i] == Side::Inside));
+        }
+    }
+
+    // Clip coordinates of a point, for checking the planes against the matrix they came from.
+    auto clip(const Mat4& m, Vec3 point) -> std::vector<float> {
+        std::vector<float> result(4);
+        for (int row = 0; row < 4; ++row) {
+            result[static_cast<size_t>(row)] = (m.columns[0][row] * point.x) + (m.columns[1][row] * point.y)
+                                               + (m.columns[2][row] * point.z) + m.columns[3][row];
+        }
+        return result;
+    }
+
+    void check_frustum(const Mat4& view_projection, const Frustum& frustum, std::mt19937& random) {
+        std::uniform_real_distribution<float> coordinate(-120.0F, 120.0F);
+        for (int i = 0; i < 20000; ++i) {
+            Vec3 const point {coordinate(random), coordinate(random), coordinate(random)};
+            std::vector<float> const c = clip(view_projection, point);
+            bool const in_clip = c[3] > 0.0F && std::fabs(c[0]) <= c[3] && std::fabs(c[1]) <= c[3]
+                                 && c[2] >= 0.0F && c[2] <= c[3];
+            Side const side = sphere_side(frustum, point, 0.0F);
+            assert(side == Side::Edge || in_clip == (side == Side::Inside));
+        }
+        for (const auto& plane : frustum.planes) {
+            assert(std::fabs(mathematics::length(plane.normal) - 1.0F) < 1e-5F);
+        }
+    }
+
+    // `count` random spheres and boxes through all three culls; `ahead` is a point well inside the view.
+    void check_count(const Frustum& frustum,
+                     Vec3 ahead,
+                     size_t count,
+                     utils::jobs::JobSystem& jobs,
+                     std::mt19937& random) {
+        std::uniform_real_distribution<float> coordinate(-80.0F, 80.0F);
+        std::uniform_real_distribution<float> size(0.05F, 6.0F);
+
+        scene::culling::SphereArray spheres;
+        scene::culling::BoxArray boxes;
+        std::vector<Aabb> box_list;
+        std::vector<Side> sphere_sides;
+        std::vector<Side> box_sides;
+        for (size_t i = 0; i < count; ++i) {
+            Vec3 const center {coordinate(random), coordinate(random), coordinate(random)};
+            float const radius = size(random);
+            Vec3 const extent {size(random), size(random), size(random)};
+            Aabb const box {center - extent, center + extent};
+            [[maybe_unused]] uint32_t const sphere = spheres.add(center, radius);
+            [[maybe_unused]] uint32_t const added = boxes.add(box);
+            assert(sphere == i && added == i);
+            box_list.push_back(box);
+            sphere_sides.push_back(sphere_side(frustum, center, radius));
+            box_sides.push_back(box_side(frustum, box));
+        }
+        assert(spheres.size() == count && boxes.size() == count);
+
+        // Stale contents of the output are replaced.
+        std::vector<uint32_t> visible(7, UINT32_MAX);
+        scene::culling::cull(frustum, spheres, visible, jobs);
+        check_visible(visible, sphere_sides);
+        scene::culling::cull(frustum, boxes, visible, jobs);
+        check_visible(visible, box_sides);
+
+        physics::bvh::Bvh bvh;
+        bvh.build(box_list.data(), box_list.size());
+        scene::culling::cull(frustum, bvh, visible);
+        check_visible(visible, box_sides);
+
+        // Moving the last object in or out of view through set() changes only its index.
+        if (count > 0) {
+            auto const last = static_cast<uint32_t>(count - 1);
+            Vec3 const behind {0.0F, 0.0F, 500.0F};
+            spheres.set(last, behind, 1.0F);
+            sphere_sides[last] = sphere_side(frustum, behind, 1.0F);
+            assert(sphere_sides[last] == Side::Outside);
+            scene::culling::cull(frustum, spheres, visible, jobs);
+            check_visible(visible, sphere_sides);
+
+            Aabb const box {ahead - Vec3 {1.0F, 1.0F, 1.0F}, ahead + Vec3 {1.0F, 1.0F, 1.0F}};
+            boxes.set(last, box);
+            box_sides[last] = box_side(frustum, box);
+            assert(box_sides[last] == Side::Inside);
+            scene::culling::cull(frustum, boxes, visible, jobs);
+            check_visible(visible, box_sides);
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    std::mt19937 random(17);
+    utils::jobs::JobSystem jobs(4);
+
+    // The origin is in view, so the zero padding of the arrays would show up if it were culled.
+    Vec3 const up {0.0F, 1.0F, 0.0F};
+    Mat4 const view_projection = mathematics::perspective(1.0F, 16.0F / 9.0F, 0.5F, 100.0F)
+                                 * mathematics::look_at({0.0F, 0.0F, 20.0F}, {0.0F, 0.0F, 0.0F}, up);
+    Frustum const frustum = scene::culling::extract_frustum(view_projection);
+    check_frustum(view_projection, frustum, random);
+
+    // Partial groups of four, single chunks, and chunks that end in the middle of a group.
+    size_t const counts[] = {0, 1, 3, 4, 5, CULL_CHUNK - 1, CULL_CHUNK, CULL_CHUNK + 1, (2 * CULL_CHUNK) + 3};
+    for (size_t const count : counts) {
+        check_count(frustum, {0.0F, 0.0F, 0.0F}, count, jobs, random);
+    }
+
+    // A tilted camera away from the origin, with every object in the same chunk.
+    Vec3 const eye {10.0F, 5.0F, -3.0F};
+    Vec3 const target {-20.0F, -4.0F, 30.0F};
+    Mat4 const tilted =
+        mathematics::perspective(0.8F, 1.0F, 1.0F, 60.0F) * mathematics::look_at(eye, target, up);
+    Frustum const other = scene::culling::extract_frustum(tilted);
+    check_frustum(tilted, other, random);
+    check_count(other, eye + (mathematics::normalize(target - eye) * 20.0F), 1001, jobs, random);
+
+    // With one thread the caller culls every chunk.
+    utils::jobs::JobSystem alone(1);
+    check_count(frustum, {0.0F, 0.0F, 0.0F}, (2 * CULL_CHUNK) + 1, alone, random);
+
+    std::cout << "culling: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/dynamics.hpp"
+#include "domkrat3d/physics/kinematics.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using physics::dynamics::BallJointDesc;
+    using physics::dynamics::BodyDesc;
+    using physics::dynamics::BodyId;
+    using physics::dynamics::BodyType;
+    using physics::dynamics::Settings;
+    using physics::dynamics::World;
+    using physics::kinematics::Execution;
+    using physics::narrowphase::Shape;
+
+    constexpr float STEP = 1.0F / 60.0F;
+
+    auto ground(World& world) -> BodyId {
+        BodyDesc desc;
+        desc.shape = Shape::box({20.0F, 0.5F, 20.0F});
+        desc.transform.position = {0.0F, -0.5F, 0.0F};
+        desc.type = BodyType::Static;
+        return world.create_body(desc);
+    }
+
+    // `height` unit cubes stacked at (x, z), each dropped from just above the one below.
+    auto stack(World& world, float x, float z, int height) -> std::vector<BodyId> {
+        std::vector<BodyId> bodies;
+        for (int level = 0; level < height; ++level) {
+            BodyDesc desc;
+            desc.shape = Shape::box({0.5F, 0.5F, 0.5F});
+            desc.transform.position = {x, 0.5F + (static_cast<float>(level) * 1.01F), z};
+            bodies.push_back(world.create_body(desc));
+        }
+        return bodies;
+    }
+
+    // A resting stack settles where it was built and the whole island falls asleep.
+    void check_stack() {
+        World world;
+        ground(world);
+        std::vector<BodyId> const boxes = stack(world, 0.0F, 0.0F, 5);
+
+        int steps = 0;
+        while (steps < 600 && !world.is_sleeping(boxes.back())) {
+            world.step(STEP);
+            ++steps;
+        }
+        assert(steps < 600);
+
+        for (size_t level = 0; level < boxes.size(); ++level) {
+            Vec3 const position = world.transform(boxes[level]).position;
+            assert(std::fabs(position.x) < 0.02F && std::fabs(position.z) < 0.02F);
+            assert(std::fabs(position.y - (0.5F + static_cast<float>(level))) < 0.05F);
+            assert(world.is_sleeping(boxes[level]));
+            assert(mathematics::length(world.linear_velocity(boxes[level])) < 0.1F);
+        }
+
+        // Asleep, nothing moves or is solved any more.
+        Vec3 const top = world.transform(boxes.back()).position;
+        for (int i = 0; i < 30; ++i) {
+            world.step(STEP);
+        }
+        assert(world.stats().awake_bodies == 0 && world.stats().islands == 0);
+        assert(mathematics::length(world.transform(boxes.back()).position - top) < 1e-6F);
+
+        // Woken, the stack stays where it was.
+        world.wake(boxes.front());
+        world.step(STEP);
+        assert(!world.is_sleeping(boxes.back()) && world.stats().awake_bodies == boxes.size());
+        assert(mathematics::length(world.transform(boxes.back()).position - top) < 0.01F);
+    }
+
+    // Stacks side by side, each an island of its own, with every other box set off to one side.
+    auto scene(const Settings& settings, Execution execution) -> std::vector<Vec3> {
+        World world(settings);
+        world.set_execution(execution);
+        ground(world);
+        std::vector<BodyId> bodies;
+        for (int i = 0; i < 6; ++i) {
+            for (int level = 0; level < 4; ++level) {
+                BodyDesc desc;
+                desc.shape = Shape::box({0.5F, 0.5F, 0.5F});
+                float const x = (static_cast<float>(i) * 3.0F) + (0.15F * static_cast<float>(level % 2));
+                desc.transform.position = {x, 0.5F + (static_cast<float>(level) * 1.01F), 0.0F};
+                bodies.push_back(world.create_body(desc));
+            }
+        }
+
+        size_t batched = 0;
+        for (int i = 0; i < 120; ++i) {
+            world.step(STEP);
+            batched += world.stats().batched_points;
+        }
+        assert((batched > 0) == (settings.batch_threshold == 0));
+
+        std::vector<Vec3> positions;
+        for (BodyId const body : bodies) {
+            positions.push_back(world.transform(body).position);
+        }
+        return positions;
+    }
+
+    // The scalar solver, the colored SIMD batches and worker threads agree: threads exactly, since
+    // islands are independent, batches within what a different solve order changes.
+    void check_solvers() {
+        Settings scalar;
+        scalar.batch_threshold = SIZE_MAX;
+        Settings batched;
+        batched.batch_threshold = 0;
+
+        std::vector<Vec3> const reference = scene(scalar, Execution::Serial);
+        std::vector<Vec3> const threaded = scene(scalar, Execution::Parallel);
+        std::vector<Vec3> const simd = scene(batched, Execution::Serial);
+        std::vector<Vec3> const both = scene(batched, Execution::Parallel);
+
+        for (size_t i = 0; i < reference.size(); ++i) {
+            assert(mathematics::length(threaded[i] - reference[i]) < 1e-5F);
+            assert(mathematics::length(both[i] - simd[i]) < 1e-5F);
+            assert(mathematics::length(simd[i] - reference[i]) < 0.02F);
+        }
+    }
+
+    // A chain of spheres hanging from a static body swings without coming apart.
+    void check_joints() {
+        World world;
+        BodyDesc anchor;
+        anchor.shape = Shape::sphere(0.1F);
+        anchor.transform.position = {0.0F, 10.0F, 0.0F};
+        anchor.type = BodyType::Static;
+        BodyId previous = world.create_body(anchor);
+
+        std::vector<BallJointDesc> joints;
+        for (int link = 1; link <= 5; ++link) {
+            BodyDesc desc;
+            desc.shape = Shape::sphere(0.2F);
+            desc.transform.position = {0.0F, 10.0F - static_cast<float>(link), 0.0F};
+            desc.linear_velocity = {0.0F, 0.0F, 0.8F * static_cast<float>(link)};
+            BodyId const body = world.create_body(desc);
+            BallJointDesc const joint {previous, body, {0.0F, -0.5F, 0.0F}, {0.0F, 0.5F, 0.0F}};
+            assert(world.create_joint(joint) == joints.size());
+            joints.push_back(joint);
+            previous = body;
+        }
+
+        float widest = 0.0F;
+        for (int step = 0; step < 300; ++step) {
+            world.step(STEP);
+            for (const BallJointDesc& joint : joints) {
+                Vec3 const a = mathematics::apply(world.transform(joint.first), joint.local_anchor_a);
+                Vec3 const b = mathematics::apply(world.transform(joint.second), joint.local_anchor_b);
+                assert(mathematics::length(a - b) < 0.03F);
+            }
+            widest = std::fmax(widest, std::fabs(world.transform(previous).position.z));
+        }
+
+        // It swung out, and the anchor stayed put.
+        assert(widest > 1.0F);
+        assert(mathematics::length(world.transform(0).position - anchor.transform.position) < 1e-6F);
+    }
+}    // namespace
+
+auto main() -> int {
+    check_stack();
+    check_solvers();
+    check_joints();
+
+    std::cout << "dynamics: all checks passed\n";
+    return 0;
+}
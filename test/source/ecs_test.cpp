@@ -0,0 +1,208 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "domkrat3d/scene/ecs.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using scene::ecs::Entity;
+    using scene::ecs::World;
+
+    constexpr uint32_t ENTITY_COUNT = 3000;
+
+    struct Position {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t z = 0;
+    };
+
+    struct Velocity {
+        uint64_t value = 0;
+    };
+
+    struct Tag {
+        uint16_t value = 0;
+    };
+
+    // Larger than a chunk, so no archetype can hold it.
+    struct Huge {
+        std::byte bytes[scene::ecs::CHUNK_SIZE + 16];
+    };
+
+    // What the world should hold for one entity.
+    struct Expected {
+        Entity entity;
+        bool alive = true;
+        bool velocity = false;
+        bool tag = false;
+        uint32_t key = 0;
+    };
+
+    auto position_of(uint32_t key) -> Position {
+        return {key, key * 2, key * 3};
+    }
+
+    // Every component of every entity, and what the queries visit.
+    void check(World& world, const std::vector<Expected>& expected) {
+        size_t alive = 0;
+        size_t with_velocity = 0;
+        size_t with_tag = 0;
+        for (const Expected& entry : expected) {
+            assert(world.alive(entry.entity) == entry.alive);
+            if (!entry.alive) {
+                assert(world.get<Position>(entry.entity) == nullptr);
+                continue;
+            }
+            ++alive;
+            const Position* const position = world.get<Position>(entry.entity);
+            Position const reference = position_of(entry.key);
+            assert(position != nullptr && position->x == reference.x && position->y == reference.y
+                   && position->z == reference.z);
+
+            assert(world.has<Velocity>(entry.entity) == entry.velocity);
+            if (entry.velocity) {
+                ++with_velocity;
+                assert(world.get<Velocity>(entry.entity)->value == uint64_t {entry.key} << 32);
+            }
+            assert(world.has<Tag>(entry.entity) == entry.tag);
+            if (entry.tag) {
+                ++with_tag;
+                assert(world.get<Tag>(entry.entity)->value == static_cast<uint16_t>(entry.key));
+            }
+        }
+        assert(world.entity_count() == alive);
+
+        scene::ecs::Query<Position> positions(world);
+        scene::ecs::Query<Position, Velocity> moving(world);
+        scene::ecs::Query<Position> untagged(world, scene::ecs::component_mask<Tag>());
+        assert(positions.count() == alive);
+        assert(moving.count() == with_velocity);
+        assert(untagged.count() == alive - with_tag);
+
+        // The handle stored in each row leads back to the same row.
+        positions.each([&world](Entity entity, Position& position)
+                       { assert(world.get<Position>(entity) == &position); });
+    }
+}    // namespace
+
+auto main() -> int {
+    World world;
+    std::vector<Expected> expected;
+    for (uint32_t key = 0; key < ENTITY_COUNT; ++key) {
+        expected.push_back({world.create(position_of(key)), true, false, false, key});
+    }
+    assert(world.archetype_count() >= 1 && world.chunk_count() > 1);
+    check(world, expected);
+
+    // Add transitions: half the entities move to {Position, Velocity}, some of those on to a third archetype.
+    for (Expected& entry : expected) {
+        if (entry.key % 2 == 0) {
+            assert(world.add(entry.entity, Velocity {uint64_t {entry.key} << 32}));
+            entry.velocity = true;
+        }
+        if (entry.key % 3 == 0) {
+            assert(world.add(entry.entity, Tag {static_cast<uint16_t>(entry.key)}));
+            entry.tag = true;
+        }
+    }
+    check(world, expected);
+
+    // Adding a component an entity has overwrites it in place.
+    Tag* const before = world.get<Tag>(expected[0].entity);
+    assert(world.add(expected[0].entity, Tag {7}));
+    assert(world.get<Tag>(expected[0].entity) == before && before->value == 7);
+    assert(world.add(expected[0].entity, Tag {0}));
+
+    // Remove transitions and swap-removes from the middle of full chunks.
+    for (Expected& entry : expected) {
+        if (entry.key % 4 == 0) {
+            assert(world.remove<Velocity>(entry.entity));
+            entry.velocity = false;
+        }
+        if (entry.key % 5 == 0) {
+            assert(world.destroy(entry.entity));
+            entry.alive = false;
+        }
+    }
+    check(world, expected);
+    assert(!world.destroy(expected[0].entity));
+    assert(!world.remove<Velocity>(expected[1].entity));
+    assert(!world.add(expected[0].entity, Tag {1}));
+
+    // Commands recorded by parallel jobs change nothing until they are applied.
+    utils::jobs::JobSystem system(4);
+    scene::ecs::CommandBuffer commands;
+    scene::ecs::Query<Position> positions(world);
+    positions.parallel_each(system,
+                            [&commands](Entity entity, Position& position)
+                            {
+                                if (position.x % 7 == 0) {
+                                    commands.destroy(entity);
+                                    commands.add(entity, Tag {1});
+                                } else if (position.x % 7 == 1) {
+                                    commands.add(entity, Velocity {uint64_t {position.x} << 32});
+                                } else if (position.x % 7 == 2) {
+                                    commands.remove<Tag>(entity);
+                                }
+                            });
+    for (uint32_t key = ENTITY_COUNT; key < ENTITY_COUNT + 100; ++key) {
+        commands.create(position_of(key), Tag {static_cast<uint16_t>(key)});
+    }
+    assert(!commands.empty());
+    check(world, expected);
+
+    commands.apply(world);
+    assert(commands.empty());
+    for (Expected& entry : expected) {
+        if (!entry.alive) {
+            continue;
+        }
+        // A component added after its entity was destroyed is skipped.
+        if (entry.key % 7 == 0) {
+            entry.alive = false;
+        } else if (entry.key % 7 == 1) {
+            entry.velocity = true;
+        } else if (entry.key % 7 == 2) {
+            entry.tag = false;
+        }
+    }
+
+    // Created entities are found through a query, as their handles were not known when recording.
+    scene::ecs::Query<Position, Tag> tagged(world);
+    tagged.each(
+        [&expected](Entity entity, Position& position, Tag&)
+        {
+            if (position.x >= ENTITY_COUNT) {
+                expected.push_back({entity, true, false, true, position.x});
+            }
+        });
+    assert(expected.size() == ENTITY_COUNT + 100);
+    check(world, expected);
+
+    // A component that does not fit in a chunk is rejected without changing the world.
+    size_t const count = world.entity_count();
+    bool thrown = false;
+    try {
+        world.create(Huge {});
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown && world.entity_count() == count);
+
+    Entity const live = expected[1].entity;
+    thrown = false;
+    try {
+        world.add(live, Huge {});
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown && !world.has<Huge>(live));
+    check(world, expected);
+
+    std::cout << "ecs: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/scene/graph.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using scene::graph::LocalTransform;
+    using scene::graph::Node;
+    using scene::graph::SceneGraph;
+
+    constexpr size_t NODE_COUNT = 3000;
+    constexpr size_t NO_PARENT = SIZE_MAX;
+
+    // The origin and the axes, each mapped through every world matrix.
+    const Vec3 POINTS[] = {{0.0F, 0.0F, 0.0F}, {1.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, {0.0F, 0.0F, 1.0F}};
+
+    // What the graph should hold, kept by index of creation.
+    struct Model {
+        std::vector<Node> nodes;
+        std::vector<size_t> parents;
+        std::vector<LocalTransform> locals;
+        std::vector<bool> alive;
+
+        // A point through the local transforms up to the root, without any matrix.
+        auto to_world(size_t index, Vec3 point) const -> Vec3 {
+            for (size_t current = index; current != NO_PARENT; current = parents[current]) {
+                const LocalTransform& local = locals[current];
+                Vec3 const scaled {point.x * local.scale.x, point.y * local.scale.y, point.z * local.scale.z};
+                point = mathematics::rotate(local.rotation, scaled) + local.position;
+            }
+            return point;
+        }
+
+        auto in_subtree(size_t index, size_t root) const -> bool {
+            for (size_t current = index; current != NO_PARENT; current = parents[current]) {
+                if (current == root) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        auto subtree_size(size_t root) const -> size_t {
+            size_t count = 0;
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (alive[i] && in_subtree(i, root)) {
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        auto depth(size_t index) const -> size_t {
+            size_t levels = 0;
+            for (size_t current = index; current != NO_PARENT; current = parents[current]) {
+                ++levels;
+            }
+            return levels;
+        }
+    };
+
+    auto random_local(std::mt19937& random) -> LocalTransform {
+        std::uniform_real_distribution<float> offset(-2.0F, 2.0F);
+        std::uniform_real_distribution<float> angle(-3.0F, 3.0F);
+        std::uniform_real_distribution<float> scale(0.8F, 1.25F);
+        Vec3 const direction {offset(random), offset(random), offset(random) + 4.5F};
+        Vec3 const axis = mathematics::normalize(direction);
+        return {{offset(random), offset(random), offset(random)},
+                mathematics::from_axis_angle(axis, angle(random)),
+                {scale(random), scale(random), scale(random)}};
+    }
+
+    auto close(Vec3 a, Vec3 b) -> bool {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (std::fabs(a[axis] - b[axis]) > 1e-3F * (1.0F + std::fabs(b[axis]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Every live node against the model.
+    void check(const SceneGraph& graph, const Model& model) {
+        size_t alive = 0;
+        size_t depth = 0;
+        for (size_t i = 0; i < model.nodes.size(); ++i) {
+            assert(graph.alive(model.nodes[i]) == model.alive[i]);
+            if (!model.alive[i]) {
+                continue;
+            }
+            ++alive;
+            depth = std::max(depth, model.depth(i));
+            Node const parent = model.parents[i] == NO_PARENT ? Node {} : model.nodes[model.parents[i]];
+            assert(graph.parent(model.nodes[i]) == parent);
+            for (Vec3 const point : POINTS) {
+                assert(close(mathematics::transform_point(graph.world(model.nodes[i]), point),
+                             model.to_world(i, point)));
+            }
+        }
+        assert(graph.size() == alive && graph.depth() == depth);
+    }
+
+    // The live node with the largest subtree below `limit` nodes, apart from `other` and its
+    // ancestors and descendants.
+    auto pick_subtree(const Model& model, size_t limit, size_t other) -> size_t {
+        size_t best = NO_PARENT;
+        size_t best_size = 0;
+        for (size_t i = 0; i < model.nodes.size(); ++i) {
+            if (!model.alive[i] || i == other || model.in_subtree(other, i) || model.in_subtree(i, other)) {
+                continue;
+            }
+            size_t const size = model.subtree_size(i);
+            if (size > best_size && size < limit) {
+                best = i;
+                best_size = size;
+            }
+        }
+        assert(best != NO_PARENT && best_size > 1);
+        return best;
+    }
+}    // namespace
+
+auto main() -> int {
+    std::mt19937 random(11);
+    utils::jobs::JobSystem system(4);
+    SceneGraph graph;
+    Model model;
+
+    // A forest with a few dozen roots; each other node hangs below an earlier one.
+    for (size_t i = 0; i < NODE_COUNT; ++i) {
+        size_t parent = NO_PARENT;
+        if (i % 100 != 0) {
+            parent = std::uniform_int_distribution<size_t>(i > 40 ? i - 40 : 0, i - 1)(random);
+        }
+        LocalTransform const local = random_local(random);
+        model.nodes.push_back(graph.create(local, parent == NO_PARENT ? Node {} : model.nodes[parent]));
+        model.parents.push_back(parent);
+        model.locals.push_back(local);
+        model.alive.push_back(true);
+    }
+    graph.update(system);
+    assert(graph.updated() == NODE_COUNT);
+    check(graph, model);
+
+    // Nothing changed, nothing is recomputed.
+    graph.update(system);
+    assert(graph.updated() == 0);
+
+    // A changed node recomputes its own subtree once, even when a descendant changed too, and
+    // nothing outside it.
+    size_t const moved = pick_subtree(model, 200, NO_PARENT);
+    model.locals[moved].position = model.locals[moved].position + Vec3 {0.5F, -1.0F, 2.0F};
+    graph.set_position(model.nodes[moved], model.locals[moved].position);
+    size_t child = NO_PARENT;
+    for (size_t i = moved + 1; i < model.nodes.size() && child == NO_PARENT; ++i) {
+        child = model.parents[i] == moved ? i : NO_PARENT;
+    }
+    model.locals[child].rotation = mathematics::from_axis_angle({0.0F, 1.0F, 0.0F}, 0.7F);
+    graph.set_rotation(model.nodes[child], model.locals[child].rotation);
+    size_t const other = pick_subtree(model, 100, moved);
+    model.locals[other].scale = {2.0F, 0.5F, 1.0F};
+    graph.set_scale(model.nodes[other], model.locals[other].scale);
+    graph.update(system);
+    assert(graph.updated() == model.subtree_size(moved) + model.subtree_size(other));
+    check(graph, model);
+
+    // A reparented subtree takes the world of its new parent; only the subtree is recomputed.
+    size_t const target = NODE_COUNT - 1;
+    size_t const branch = pick_subtree(model, 300, target);
+    graph.set_parent(model.nodes[branch], model.nodes[target]);
+    model.parents[branch] = target;
+    graph.update(system);
+    assert(graph.updated() == model.subtree_size(branch));
+    check(graph, model);
+
+    // Reparenting to the same parent changes nothing; a parent below the node is refused.
+    graph.set_parent(model.nodes[branch], model.nodes[target]);
+    graph.update(system);
+    assert(graph.updated() == 0);
+    bool thrown = false;
+    try {
+        graph.set_parent(model.nodes[target], model.nodes[branch]);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Moved to the roots, a subtree keeps its local transforms as world ones.
+    graph.set_parent(model.nodes[branch], Node {});
+    model.parents[branch] = NO_PARENT;
+    graph.update();
+    assert(graph.updated() == model.subtree_size(branch));
+    check(graph, model);
+
+    // Destroying a node destroys everything below it and leaves the rest as it was.
+    size_t const destroyed = pick_subtree(model, 400, branch);
+    size_t const before = graph.size();
+    size_t const removed = model.subtree_size(destroyed);
+    assert(graph.destroy(model.nodes[destroyed]));
+    for (size_t i = 0; i < model.nodes.size(); ++i) {
+        if (model.alive[i] && model.in_subtree(i, destroyed)) {
+            model.alive[i] = false;
+        }
+    }
+    assert(graph.size() == before - removed && !graph.destroy(model.nodes[destroyed]));
+    graph.update(system);
+    assert(graph.updated() == 0);
+    check(graph, model);
+
+    thrown = false;
+    try {
+        graph.create({}, model.nodes[destroyed]);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Changes queued before a relayout still reach their nodes.
+    size_t const last = pick_subtree(model, 400, destroyed);
+    model.locals[last].position = {9.0F, 9.0F, 9.0F};
+    graph.set_position(model.nodes[last], model.locals[last].position);
+    model.nodes.push_back(graph.create(model.locals[last], model.nodes[last]));
+    model.parents.push_back(last);
+    model.locals.push_back(model.locals[last]);
+    model.alive.push_back(true);
+    graph.update(system);
+    assert(graph.updated() == model.subtree_size(last));
+    check(graph, model);
+
+    std::cout << "graph: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "domkrat3d/graphics/simple.hpp"
+
+namespace {
+    // CTest reports the test as skipped on this exit code, see test/CMakeLists.txt.
+    constexpr int SKIPPED = 77;
+
+    // Machines that must run the test, such as CI with lavapipe installed, set this.
+    auto vulkan_required() -> bool {
+        const char* const value = std::getenv("DOMKRAT3D_REQUIRE_VULKAN");
+        return value != nullptr && *value != '\0';
+    }
+}    // namespace
+
+// The checks do not use assert, which release builds compile out.
+auto main() -> int {
+    SimpleBasicApplication application(HeadlessOptions {true, 1, true});
+    try {
+        application.run();
+    } catch (const std::runtime_error& error) {
+        if (vulkan_required()) {
+            std::cerr << "headless: " << error.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << "headless: skipped, no usable Vulkan implementation: " << error.what() << "\n";
+        return SKIPPED;
+    }
+
+    const std::vector<uint8_t>& frame = application.frame();
+    size_t const expected_size = size_t {static_cast<uint32_t>(application.WIDTH)}
+                                 * static_cast<uint32_t>(application.HEIGHT) * 4;
+    if (frame.size() != expected_size) {
+        std::cerr << "headless: frame has " << frame.size() << " bytes, expected " << expected_size << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // Every pixel is the clear color as UNORM bytes, give or take the rounding of the driver.
+    int expected[4];
+    for (int channel = 0; channel < 4; ++channel) {
+        expected[channel] =
+            static_cast<int>(std::lround(SimpleBasicApplication::CLEAR_COLOR.float32[channel] * 255.0F));
+    }
+    size_t mismatches = 0;
+    for (size_t i = 0; i < frame.size(); ++i) {
+        if (std::abs(int {frame[i]} - expected[i % 4]) > 1) {
+            ++mismatches;
+        }
+    }
+    if (mismatches != 0) {
+        std::cerr << "headless: " << mismatches << " bytes differ from the clear color\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "headless: all checks passed\n";
+    return 0;
+}
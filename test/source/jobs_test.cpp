@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+
+namespace {
+    using utils::jobs::Counter;
+    using utils::jobs::Job;
+    using utils::jobs::JobSystem;
+    using utils::jobs::Pinned;
+
+    // Context of the raw jobs: a hit count per index and the threads that ran them.
+    struct Record {
+        std::vector<std::atomic<uint32_t>>* hits = nullptr;
+        std::mutex* mutex = nullptr;
+        std::vector<std::thread::id>* threads = nullptr;
+        std::vector<size_t>* order = nullptr;
+    };
+
+    void record(const Job& job) {
+        const auto& context = *static_cast<const Record*>(job.context);
+        for (size_t i = job.begin; i < job.end; ++i) {
+            (*context.hits)[i].fetch_add(1, std::memory_order_relaxed);
+        }
+        if (context.mutex != nullptr) {
+            std::lock_guard<std::mutex> const lock(*context.mutex);
+            context.threads->push_back(std::this_thread::get_id());
+            context.order->push_back(job.begin);
+        }
+    }
+
+    auto all_once(const std::vector<std::atomic<uint32_t>>& hits) -> bool {
+        for (const auto& hit : hits) {
+            if (hit.load() != 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto make_jobs(const Record& context, size_t count, size_t per_job) -> std::vector<Job> {
+        std::vector<Job> jobs;
+        for (size_t begin = 0; begin < count; begin += per_job) {
+            jobs.push_back({record, &context, begin, std::min(begin + per_job, count), nullptr});
+        }
+        return jobs;
+    }
+
+    // Every index of a loop runs exactly once, for grains from one index to more than the whole range.
+    void check_parallel_for(JobSystem& system) {
+        for (size_t const count : {size_t {0}, size_t {1}, size_t {1000}, size_t {100003}}) {
+            for (size_t const grain : {size_t {1}, size_t {7}, size_t {1024}, count + 5}) {
+                std::vector<std::atomic<uint32_t>> hits(count);
+                utils::parallel::parallel_for(system,
+                                              count,
+                                              grain,
+                                              [&hits](size_t begin, size_t end)
+                                              {
+                                                  for (size_t i = begin; i < end; ++i) {
+                                                      hits[i].fetch_add(1, std::memory_order_relaxed);
+                                                  }
+                                              });
+                assert(all_once(hits));
+            }
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    JobSystem system(4);
+    assert(system.thread_count() == 4);
+    check_parallel_for(system);
+
+    // Loops inside loops: the outer bodies wait on the inner loops from worker threads.
+    constexpr size_t OUTER = 64;
+    constexpr size_t INNER = 500;
+    std::vector<std::atomic<uint32_t>> nested(OUTER * INNER);
+    utils::parallel::parallel_for(system,
+                                  OUTER,
+                                  1,
+                                  [&system, &nested](size_t begin, size_t end)
+                                  {
+                                      for (size_t outer = begin; outer < end; ++outer) {
+                                          utils::parallel::parallel_for(
+                                              system,
+                                              INNER,
+                                              16,
+                                              [&nested, outer](size_t first, size_t last)
+                                              {
+                                                  for (size_t i = first; i < last; ++i) {
+                                                      nested[(outer * INNER) + i].fetch_add(1);
+                                                  }
+                                              });
+                                      }
+                                  });
+    assert(all_once(nested));
+
+    // Raw jobs from the caller go through the shared queue; wait() returns with the counter done.
+    {
+        std::vector<std::atomic<uint32_t>> hits(10000);
+        Record const context {&hits};
+        std::vector<Job> jobs = make_jobs(context, hits.size(), 100);
+        Counter counter;
+        system.submit(jobs.data(), jobs.size(), counter);
+        system.wait(counter);
+        assert(counter.done() && all_once(hits));
+    }
+
+    // Pinned jobs run in submission order on their own thread, never on the caller.
+    {
+        std::vector<std::atomic<uint32_t>> hits(64);
+        std::mutex mutex;
+        std::vector<std::thread::id> threads[2];
+        std::vector<size_t> orders[2];
+        Record const gpu {&hits, &mutex, &threads[0], &orders[0]};
+        Record const io {&hits, &mutex, &threads[1], &orders[1]};
+        std::vector<Job> gpu_jobs;
+        std::vector<Job> io_jobs;
+        for (size_t i = 0; i < 32; ++i) {
+            gpu_jobs.push_back({record, &gpu, i, i + 1, nullptr});
+            io_jobs.push_back({record, &io, 32 + i, 33 + i, nullptr});
+        }
+        Counter counter;
+        system.submit(Pinned::Gpu, gpu_jobs.data(), gpu_jobs.size(), counter);
+        system.submit(Pinned::Io, io_jobs.data(), io_jobs.size(), counter);
+        system.wait(counter);
+        assert(all_once(hits));
+        for (size_t pinned = 0; pinned < 2; ++pinned) {
+            assert(orders[pinned].size() == 32);
+            for (size_t i = 0; i < 32; ++i) {
+                assert(orders[pinned][i] == (32 * pinned) + i);
+                assert(threads[pinned][i] == threads[pinned][0]);
+                assert(threads[pinned][i] != std::this_thread::get_id());
+            }
+        }
+        assert(threads[0][0] != threads[1][0]);
+    }
+
+    // A loop that waits on something else drains the queue with run_one().
+    {
+        std::vector<std::atomic<uint32_t>> hits(5000);
+        Record const context {&hits};
+        std::vector<Job> jobs = make_jobs(context, hits.size(), 10);
+        Counter counter;
+        system.submit(jobs.data(), jobs.size(), counter);
+        while (!counter.done()) {
+            if (!system.run_one()) {
+                std::this_thread::yield();
+            }
+        }
+        assert(all_once(hits));
+        assert(!system.run_one());
+    }
+
+    // Without workers the waiting caller runs everything itself.
+    JobSystem alone(1);
+    assert(alone.thread_count() == 1);
+    check_parallel_for(alone);
+    {
+        std::vector<std::atomic<uint32_t>> hits(1000);
+        Record const context {&hits};
+        std::vector<Job> jobs = make_jobs(context, hits.size(), 10);
+        Counter counter;
+        alone.submit(jobs.data(), jobs.size(), counter);
+        assert(!counter.done());
+        while (alone.run_one()) {
+        }
+        assert(counter.done() && all_once(hits));
+    }
+
+    std::cout << "jobs: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/physics/kinematics.hpp"
+
+namespace {
+    namespace kinematics = physics::kinematics;
+    using kinematics::ConstVec3Span;
+    using kinematics::Execution;
+    using kinematics::Vec3Span;
+
+    // Lengths around the SIMD widths, and one that splits into several parallel chunks with a tail.
+    const size_t COUNTS[] = {0, 1, 2, 3, 5, 7, 1001, (3 * 16384) + 3};
+
+    // Positions, velocities and accelerations of `count` bodies along one axis.
+    template<typename Real>
+    struct Axis {
+        std::vector<Real> position;
+        std::vector<Real> velocity;
+        std::vector<Real> acceleration;
+
+        Axis(size_t count, std::mt19937& random) {
+            std::uniform_real_distribution<Real> value(Real {-100}, Real {100});
+            for (size_t i = 0; i < count; ++i) {
+                position.push_back(value(random));
+                velocity.push_back(value(random));
+                acceleration.push_back(value(random));
+            }
+        }
+    };
+
+    // Batches against the scalar functions in double, within the rounding of Real.
+    template<typename Real>
+    auto close(Real batch, double scalar) -> bool {
+        double const tolerance = sizeof(Real) == sizeof(float) ? 1e-5 : 1e-12;
+        return std::fabs(static_cast<double>(batch) - scalar) <= tolerance * (1.0 + std::fabs(scalar));
+    }
+
+    template<typename Real>
+    void check_axis(const Axis<Real>& start,
+                    const Axis<Real>& result,
+                    Real time,
+                    bool moved,
+                    bool accelerated) {
+        auto const t = static_cast<double>(time);
+        for (size_t i = 0; i < start.position.size(); ++i) {
+            auto const s = static_cast<double>(start.position[i]);
+            auto const u = static_cast<double>(start.velocity[i]);
+            auto const a = static_cast<double>(start.acceleration[i]);
+            double const position = moved ? kinematics::calculate_final_position(s, u, a, t) : s;
+            double const velocity = accelerated ? kinematics::calculate_final_velocity(u, a, t) : u;
+            assert(close(result.position[i], position));
+            assert(close(result.velocity[i], velocity));
+        }
+    }
+
+    // The three updates on one axis, serial then parallel; both give the same bits.
+    template<typename Real>
+    void check_1d(size_t count, Real time, std::mt19937& random) {
+        Axis<Real> const start(count, random);
+        for (Execution const execution : {Execution::Serial, Execution::Parallel}) {
+            Axis<Real> velocity = start;
+            kinematics::calculate_final_velocity_batch(
+                velocity.velocity.data(), velocity.acceleration.data(), count, time, execution);
+            check_axis(start, velocity, time, false, true);
+
+            Axis<Real> position = start;
+            kinematics::calculate_final_position_batch(position.position.data(),
+                                                       position.velocity.data(),
+                                                       position.acceleration.data(),
+                                                       count,
+                                                       time,
+                                                       execution);
+            check_axis(start, position, time, true, false);
+
+            Axis<Real> advanced = start;
+            kinematics::advance_batch(advanced.position.data(),
+                                      advanced.velocity.data(),
+                                      advanced.acceleration.data(),
+                                      count,
+                                      time,
+                                      execution);
+            check_axis(start, advanced, time, true, true);
+
+            if (execution == Execution::Parallel) {
+                Axis<Real> serial = start;
+                kinematics::advance_batch(
+                    serial.position.data(), serial.velocity.data(), serial.acceleration.data(), count, time);
+                assert(serial.position == advanced.position && serial.velocity == advanced.velocity);
+            }
+        }
+    }
+
+    template<typename Real>
+    auto span(Axis<Real> (&axes)[3], std::vector<Real> Axis<Real>::*member) -> Vec3Span<Real> {
+        return {(axes[0].*member).data(), (axes[1].*member).data(), (axes[2].*member).data()};
+    }
+
+    template<typename Real>
+    auto const_span(Axis<Real> (&axes)[3], std::vector<Real> Axis<Real>::*member) -> ConstVec3Span<Real> {
+        return {(axes[0].*member).data(), (axes[1].*member).data(), (axes[2].*member).data()};
+    }
+
+    // The same updates on x/y/z spans, each axis against the scalar functions.
+    template<typename Real>
+    void check_3d(size_t count, Real time, std::mt19937& random) {
+        Axis<Real> const start[3] = {{count, random}, {count, random}, {count, random}};
+        auto const position = &Axis<Real>::position;
+        auto const velocity = &Axis<Real>::velocity;
+        auto const acceleration = &Axis<Real>::acceleration;
+
+        for (Execution const execution : {Execution::Serial, Execution::Parallel}) {
+            Axis<Real> updated[3] = {start[0], start[1], start[2]};
+            kinematics::calculate_final_velocity_batch(
+                span(updated, velocity), const_span(updated, acceleration), count, time, execution);
+            for (size_t axis = 0; axis < 3; ++axis) {
+                check_axis(start[axis], updated[axis], time, false, true);
+            }
+
+            Axis<Real> moved[3] = {start[0], start[1], start[2]};
+            kinematics::calculate_final_position_batch(span(moved, position),
+                                                       const_span(moved, velocity),
+                                                       const_span(moved, acceleration),
+                                                       count,
+                                                       time,
+                                                       execution);
+            for (size_t axis = 0; axis < 3; ++axis) {
+                check_axis(start[axis], moved[axis], time, true, false);
+            }
+
+            Axis<Real> advanced[3] = {start[0], start[1], start[2]};
+            kinematics::advance_batch(span(advanced, position),
+                                      span(advanced, velocity),
+                                      const_span(advanced, acceleration),
+                                      count,
+                                      time,
+                                      execution);
+            for (size_t axis = 0; axis < 3; ++axis) {
+                check_axis(start[axis], advanced[axis], time, true, true);
+            }
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    std::mt19937 random(3);
+    for (size_t const count : COUNTS) {
+        check_1d<float>(count, 0.016F, random);
+        check_1d<double>(count, 0.016, random);
+        check_3d<float>(count, 0.25F, random);
+        check_3d<double>(count, 0.25, random);
+    }
+
+    std::cout << "kinematics: all checks passed\n";
+    return 0;
+}
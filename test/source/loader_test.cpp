@@ -0,0 +1,217 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/assets/loader.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace {
+    namespace fs = std::filesystem;
+
+    using assets::AssetData;
+    using assets::AssetLoader;
+    using assets::LoadPriority;
+    using assets::LoadStatus;
+
+    constexpr size_t FILE_SIZE = 10000;
+
+    // Callbacks in the order they ran. The job system has no workers, so they all run on the
+    // test thread, in the order the loader scheduled them.
+    struct Log {
+        std::vector<std::string> names;
+        std::vector<LoadStatus> statuses;
+        std::vector<AssetData> data;
+
+        auto callback(std::string name) -> assets::LoadCallback {
+            return [this, name](LoadStatus status, const AssetData& loaded)
+            {
+                names.push_back(name);
+                statuses.push_back(status);
+                data.push_back(loaded);
+            };
+        }
+    };
+
+    auto contents(size_t size, uint8_t seed) -> std::vector<std::byte> {
+        std::vector<std::byte> bytes(size);
+        for (size_t i = 0; i < size; ++i) {
+            bytes[i] = static_cast<std::byte>((i * 7) + seed);
+        }
+        return bytes;
+    }
+
+    auto write_asset(const fs::path& path, size_t size, uint8_t seed) -> std::string {
+        std::vector<std::byte> const bytes = contents(size, seed);
+        std::FILE* file = std::fopen(path.string().c_str(), "wb");
+        assert(file != nullptr);
+        [[maybe_unused]] size_t const written = std::fwrite(bytes.data(), 1, bytes.size(), file);
+        assert(written == bytes.size());
+        std::fclose(file);
+        return path.string();
+    }
+
+    void drain(utils::jobs::JobSystem& system, const Log& log, size_t count) {
+        while (log.names.size() < count) {
+            if (!system.run_one()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Loads one file at a time and waits for it.
+    auto load_now(AssetLoader& loader, utils::jobs::JobSystem& system, Log& log, const std::string& path)
+        -> AssetData {
+        loader.load(path, LoadPriority::Normal, log.callback(path));
+        drain(system, log, log.names.size() + 1);
+        return log.data.back();
+    }
+
+    // Resident cache, eviction and failures, with io_uring or with the fallback threads.
+    void check_cache(const fs::path& directory, bool use_io_uring) {
+        utils::jobs::JobSystem system(1);
+        assets::LoaderSettings settings;
+        settings.memory_budget = 3 * FILE_SIZE;
+        settings.use_io_uring = use_io_uring;
+        Log log;
+        AssetLoader loader(system, settings);
+        assert(use_io_uring || !loader.uses_io_uring());
+
+        std::vector<std::string> paths;
+        for (uint8_t i = 0; i < 4; ++i) {
+            paths.push_back(write_asset(directory / ("cache" + std::to_string(i)), FILE_SIZE, i));
+        }
+        std::vector<AssetData> loaded;
+        for (uint8_t i = 0; i < 3; ++i) {
+            loaded.push_back(load_now(loader, system, log, paths[i]));
+            assert(log.statuses.back() == LoadStatus::Loaded && *loaded.back() == contents(FILE_SIZE, i));
+        }
+        assert(loader.resident_bytes() == 3 * FILE_SIZE);
+
+        // The first file was used last, so the second one is the least recently used.
+        assert(loader.find(paths[0]) == loaded[0]);
+        loaded.push_back(load_now(loader, system, log, paths[3]));
+        assert(loader.resident_bytes() == 3 * FILE_SIZE);
+        assert(loader.find(paths[1]) == nullptr);
+        assert(loader.find(paths[0]) && loader.find(paths[2]) && loader.find(paths[3]));
+
+        // Evicted data stays valid for whoever holds it.
+        assert(*loaded[1] == contents(FILE_SIZE, 1));
+
+        // A resident file is handed out without reading it again.
+        assert(load_now(loader, system, log, paths[3]) == loaded[3]);
+
+        // A file over the budget is loaded but never resident; an empty file is loaded too.
+        std::string const large = write_asset(directory / "large", 4 * FILE_SIZE, 9);
+        assert(load_now(loader, system, log, large)->size() == 4 * FILE_SIZE);
+        assert(loader.find(large) == nullptr && loader.resident_bytes() == 3 * FILE_SIZE);
+        std::string const empty = write_asset(directory / "empty", 0, 0);
+        assert(load_now(loader, system, log, empty)->empty() && log.statuses.back() == LoadStatus::Loaded);
+
+        std::string const missing = (directory / "missing").string();
+        assert(load_now(loader, system, log, missing) == nullptr);
+        assert(log.statuses.back() == LoadStatus::Failed);
+        assert(!loader.cancel(1) && loader.pending() == 0);
+    }
+
+#ifndef _WIN32
+    // Requests queued while the only I/O thread is stuck opening a FIFO, then released at once.
+    void check_queue(const fs::path& directory) {
+        utils::jobs::JobSystem system(1);
+        assets::LoaderSettings settings;
+        settings.use_io_uring = false;
+        settings.fallback_threads = 1;
+        Log log;
+        AssetLoader loader(system, settings);
+
+        fs::path const gate = directory / "gate";
+        [[maybe_unused]] int const made = ::mkfifo(gate.c_str(), 0600);
+        assert(made == 0);
+        std::vector<std::string> paths;
+        for (const char* name : {"low", "normal", "high", "later", "bumped", "shared", "cancelled", "kept"}) {
+            paths.push_back(write_asset(directory / name, FILE_SIZE, static_cast<uint8_t>(paths.size())));
+        }
+        auto const path = [&directory](const char* name) { return (directory / name).string(); };
+
+        loader.load(gate.string(), LoadPriority::Critical, log.callback("gate"));
+        loader.load(path("low"), LoadPriority::Low, log.callback("low"));
+        loader.load(path("normal"), LoadPriority::Normal, log.callback("normal"));
+        loader.load(path("high"), LoadPriority::High, log.callback("high"));
+        loader.load(path("later"), LoadPriority::Normal, log.callback("later"));
+
+        // A second request raises the priority of a queued load.
+        loader.load(path("bumped"), LoadPriority::Low, log.callback("bumped"));
+        loader.load(path("bumped"), LoadPriority::High, log.callback("bumped"));
+        for (int i = 0; i < 3; ++i) {
+            loader.load(path("shared"), LoadPriority::Normal, log.callback("shared"));
+        }
+
+        // A load nobody waits for any more is dropped; one with a request left is kept.
+        assets::LoadId const first = loader.load(path("cancelled"), LoadPriority::High, log.callback("x"));
+        assets::LoadId const second = loader.load(path("cancelled"), LoadPriority::High, log.callback("x"));
+        assets::LoadId const dropped = loader.load(path("kept"), LoadPriority::Normal, log.callback("x"));
+        loader.load(path("kept"), LoadPriority::Normal, log.callback("kept"));
+        [[maybe_unused]] bool const cancelled = loader.cancel(first) && loader.cancel(second)
+                                             && loader.cancel(dropped) && !loader.cancel(first);
+        assert(cancelled);
+        assert(loader.pending() == 11);
+
+        int const writer = ::open(gate.c_str(), O_WRONLY);
+        assert(writer >= 0);
+        ::close(writer);
+        drain(system, log, 11);
+
+        std::vector<std::string> const order = {"gate",
+                                                "high",
+                                                "bumped",
+                                                "bumped",
+                                                "normal",
+                                                "later",
+                                                "shared",
+                                                "shared",
+                                                "shared",
+                                                "kept",
+                                                "low"};
+        assert(log.names == order);
+        assert(log.statuses[0] == LoadStatus::Failed && log.data[0] == nullptr);
+        for (size_t i = 1; i < order.size(); ++i) {
+            assert(log.statuses[i] == LoadStatus::Loaded && log.data[i]->size() == FILE_SIZE);
+        }
+
+        // Joined requests share one read.
+        assert(log.data[2] == log.data[3] && log.data[6] == log.data[7] && log.data[7] == log.data[8]);
+        assert(*log.data[6] == contents(FILE_SIZE, 5));
+        assert(loader.find(path("cancelled")) == nullptr && loader.find(path("kept")) == log.data[9]);
+        assert(loader.pending() == 0);
+    }
+#endif
+}    // namespace
+
+auto main() -> int {
+    fs::path const directory = fs::temp_directory_path() / "domkrat3d_loader_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    check_cache(directory, true);
+    check_cache(directory, false);
+#ifndef _WIN32
+    check_queue(directory);
+#endif
+
+    fs::remove_all(directory);
+
+    std::cout << "loader: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/scene/culling.hpp"
+#include "domkrat3d/scene/lod.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using mathematics::Vec3;
+    using scene::lod::LodCamera;
+    using scene::lod::LodLevel;
+    using scene::lod::LodSelector;
+    using scene::lod::LodSettings;
+    using scene::lod::MAX_LODS;
+
+    // A 90 degree view 1000 pixels high: 500 pixels per unit at distance 1.
+    constexpr float FOV_Y = 1.5707964F;
+    constexpr float VIEWPORT_HEIGHT = 1000.0F;
+    constexpr float RADIUS = 1.0F;
+    constexpr float SLACK = 1e-4F;
+
+    // Level 1 shows one pixel of error 5 units in front of the sphere, three quarters of one at 6.67.
+    const LodLevel LEVELS[] = {{0.0F, 1000}, {0.01F, 400}, {0.04F, 100}, {0.16F, 20}};
+
+    // A camera on the +Z axis, `distance` in front of a sphere at the origin.
+    auto camera_at(float distance) -> LodCamera {
+        return scene::lod::make_camera({0.0F, 0.0F, distance + RADIUS}, FOV_Y, VIEWPORT_HEIGHT);
+    }
+
+    // One instance of the model, alone in view, moved through `distances` frame by frame.
+    struct Single {
+        LodSelector selector;
+        scene::culling::SphereArray bounds;
+        std::vector<uint32_t> visible {0};
+        utils::jobs::JobSystem& jobs;
+
+        Single(const LodSettings& settings, utils::jobs::JobSystem& system)
+            : selector(settings)
+            , jobs(system) {
+            selector.add_instance(selector.add_model(LEVELS, 4));
+            bounds.add({}, RADIUS);
+        }
+
+        // The level after each frame, and how many frames switched.
+        auto run(const std::vector<float>& distances, std::vector<uint32_t>& levels) -> size_t {
+            size_t switches = 0;
+            levels.clear();
+            for (float const distance : distances) {
+                selector.select(camera_at(distance), bounds, visible, jobs);
+                levels.push_back(selector.level(0));
+                switches += selector.switch_count();
+            }
+            return switches;
+        }
+    };
+
+    // Frames alternating a few percent either side of `distance`.
+    auto around(float distance, int frames) -> std::vector<float> {
+        std::vector<float> distances;
+        for (int frame = 0; frame < frames; ++frame) {
+            distances.push_back(distance * (frame % 2 == 0 ? 1.05F : 0.95F));
+        }
+        return distances;
+    }
+
+    void check_hysteresis(utils::jobs::JobSystem& jobs) {
+        std::vector<uint32_t> levels;
+
+        // Without a margin an instance at the boundary flips every frame.
+        Single plain({1.0F, 0.0F}, jobs);
+        assert(plain.run(around(5.0F, 20), levels) == 20);
+
+        // With one it stays on the finer level at the coarsening boundary...
+        Single damped({1.0F, 0.25F}, jobs);
+        assert(damped.run(around(5.0F, 20), levels) == 0);
+        assert(std::all_of(levels.begin(), levels.end(), [](uint32_t level) { return level == 0; }));
+
+        // ...and coarsens only once the margin is cleared.
+        assert(damped.run({6.5F, 6.8F}, levels) == 1 && (levels == std::vector<uint32_t> {0, 1}));
+
+        // Once coarse, it stays so at the refinement boundary until it is too coarse, then
+        // refines in the same frame and stays refined.
+        assert(damped.run({5.2F, 5.1F, 4.9F, 5.1F, 5.2F, 4.9F}, levels) == 1);
+        assert((levels == std::vector<uint32_t> {1, 1, 0, 0, 0, 0}));
+
+        // From far away, refining skips levels at once; coarsening also skips when the margin allows.
+        assert(damped.run({1000.0F, 10.0F, 3.0F, 1000.0F}, levels) == 4);
+        assert((levels == std::vector<uint32_t> {3, 1, 0, 3}));
+
+        // Inside the sphere the finest level is used.
+        assert(damped.run({-0.5F}, levels) == 1 && levels[0] == 0);
+    }
+
+    // Pixels of error a level shows from a camera, computed without SIMD.
+    auto pixels(const LodLevel& level, const LodCamera& camera, Vec3 center, float radius) -> float {
+        float const distance = std::max(mathematics::length(center - camera.position) - radius, 1e-3F);
+        return level.error * camera.pixels_per_unit / distance;
+    }
+
+    // Scalar pixel errors against a bound, allowing for the rounding of the SIMD ones: clearly
+    // over it, and over it or close enough to have been over it.
+    auto exceeds(float value, float bound) -> bool {
+        return value > bound * (1.0F + SLACK);
+    }
+
+    auto reaches(float value, float bound) -> bool {
+        return value > bound * (1.0F - SLACK);
+    }
+
+    void check_buckets(utils::jobs::JobSystem& jobs) {
+        LodSettings const settings {1.5F, 0.2F};
+        LodSelector selector(settings);
+        std::vector<std::vector<LodLevel>> models = {
+            {{0.0F, 5000}, {0.02F, 2000}, {0.05F, 800}, {0.2F, 200}, {0.8F, 50}},
+            {{0.0F, 300}},
+            {{0.0F, 900}, {0.01F, 900}, {0.3F, 10}},
+        };
+        for (const auto& levels : models) {
+            selector.add_model(levels.data(), levels.size());
+        }
+        assert(selector.model_count() == models.size());
+
+        std::mt19937 random(23);
+        std::uniform_real_distribution<float> coordinate(-200.0F, 200.0F);
+        std::uniform_real_distribution<float> radius(0.5F, 4.0F);
+        scene::culling::SphereArray bounds;
+        std::vector<uint32_t> instance_models;
+        for (uint32_t i = 0; i < 5003; ++i) {
+            auto const model = static_cast<uint32_t>(random() % models.size());
+            [[maybe_unused]] uint32_t const instance = selector.add_instance(model);
+            assert(instance == i);
+            bounds.add({coordinate(random), coordinate(random), coordinate(random)}, radius(random));
+            instance_models.push_back(model);
+        }
+
+        std::vector<uint32_t> all(bounds.size());
+        for (uint32_t i = 0; i < all.size(); ++i) {
+            all[i] = i;
+        }
+        for (int frame = 0; frame < 8; ++frame) {
+            // A shuffled subset of the instances, not a multiple of four long.
+            std::vector<uint32_t> visible = all;
+            std::shuffle(visible.begin(), visible.end(), random);
+            visible.resize(visible.size() - 1 - (random() % 1500));
+            std::vector<uint8_t> seen(all.size(), 0);
+            for (uint32_t const instance : visible) {
+                seen[instance] = 1;
+            }
+
+            std::vector<uint32_t> before;
+            for (uint32_t const instance : all) {
+                before.push_back(selector.level(instance));
+            }
+            LodCamera const camera = scene::lod::make_camera({coordinate(random), 0.0F, coordinate(random)},
+                                                             1.0F,
+                                                             720.0F);
+            selector.select(camera, bounds, visible, jobs);
+
+            // Hidden instances keep their level; visible ones take the coarsest level under the
+            // threshold, coarsening only past the margin.
+            uint64_t triangles = 0;
+            size_t switches = 0;
+            float const limit = settings.pixel_error;
+            float const margin = settings.pixel_error * (1.0F - settings.hysteresis);
+            for (uint32_t const instance : all) {
+                uint32_t const level = selector.level(instance);
+                if (seen[instance] == 0) {
+                    assert(level == before[instance]);
+                    continue;
+                }
+                const std::vector<LodLevel>& levels = models[instance_models[instance]];
+                Vec3 const center = bounds.center(instance);
+                float const shown = pixels(levels[level], camera, center, bounds.radius(instance));
+                assert(level < levels.size() && !exceeds(shown, limit));
+                assert(level <= before[instance] || !exceeds(shown, margin));
+                if (level + 1 < levels.size()) {
+                    float const next = pixels(levels[level + 1], camera, center, bounds.radius(instance));
+                    assert(reaches(next, limit) || (level + 1 > before[instance] && reaches(next, margin)));
+                }
+                triangles += levels[level].triangles;
+                if (level != before[instance]) {
+                    ++switches;
+                }
+            }
+            assert(selector.triangle_count() == triangles && selector.switch_count() == switches);
+
+            // The buckets hold every visible instance once, under its model and level, in visible order.
+            std::vector<size_t> positions(all.size(), 0);
+            for (size_t i = 0; i < visible.size(); ++i) {
+                positions[visible[i]] = i;
+            }
+            size_t listed = 0;
+            for (uint32_t model = 0; model < models.size(); ++model) {
+                for (uint32_t level = 0; level < MAX_LODS; ++level) {
+                    scene::lod::InstanceList const list = selector.instances(model, level);
+                    assert(level < models[model].size() || list.empty());
+                    for (const uint32_t* it = list.begin(); it != list.end(); ++it) {
+                        assert(seen[*it] == 1 && instance_models[*it] == model);
+                        assert(selector.level(*it) == level);
+                        assert(it == list.begin() || positions[*(it - 1)] < positions[*it]);
+                        seen[*it] = 2;
+                    }
+                    listed += list.size;
+                }
+            }
+            assert(listed == visible.size());
+        }
+
+        // Nothing visible leaves every bucket empty.
+        selector.select(scene::lod::make_camera({}, 1.0F, 720.0F), bounds, {}, jobs);
+        assert(selector.triangle_count() == 0 && selector.switch_count() == 0);
+        for (uint32_t model = 0; model < models.size(); ++model) {
+            assert(selector.instances(model, 0).empty());
+        }
+        assert(selector.instances(7, 0).empty());
+    }
+
+    void check_errors() {
+        LodSelector selector;
+        bool thrown = false;
+        try {
+            selector.add_model(LEVELS, 0);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        thrown = false;
+        LodLevel const reversed[] = {{0.1F, 10}, {0.05F, 5}};
+        try {
+            selector.add_model(reversed, 2);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        thrown = false;
+        try {
+            selector.add_instance(0);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown && selector.model_count() == 0 && selector.instance_count() == 0);
+    }
+}    // namespace
+
+auto main() -> int {
+    utils::jobs::JobSystem jobs(4);
+    check_hysteresis(jobs);
+    check_buckets(jobs);
+    check_errors();
+
+    // The same checks with the caller selecting alone.
+    utils::jobs::JobSystem alone(1);
+    check_buckets(alone);
+
+    std::cout << "lod: all checks passed\n";
+    return 0;
+}
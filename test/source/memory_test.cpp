@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#    include <malloc.h>
+#endif
+
+#include "domkrat3d/mathematics/statistics.hpp"
+#include "domkrat3d/scene/ecs.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+#include "domkrat3d/utils/memory.hpp"
+#include "domkrat3d/utils/parallel.hpp"
+#include "domkrat3d/utils/pool.hpp"
+#include "domkrat3d/utils/tasks.hpp"
+
+namespace {
+    std::atomic<size_t> heap_allocations {0};
+
+    // MSVC has no std::aligned_alloc; its aligned blocks must go back through _aligned_free.
+    auto aligned_allocate(size_t alignment, size_t size) -> void* {
+#ifdef _WIN32
+        return _aligned_malloc(size, alignment);
+#else
+        return std::aligned_alloc(alignment, size);
+#endif
+    }
+
+    void aligned_free(void* data) {
+#ifdef _WIN32
+        _aligned_free(data);
+#else
+        std::free(data);
+#endif
+    }
+
+    auto counted_allocation(size_t size, size_t alignment = alignof(std::max_align_t)) -> void* {
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t const rounded = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+        if (void* data = aligned_allocate(alignment, rounded)) {
+            return data;
+        }
+        throw std::bad_alloc();
+    }
+
+    // Heap allocations made by a function, after one call to warm up caches and scratch blocks.
+    template<typename Function>
+    auto allocations_of(Function&& function) -> size_t {
+        function();
+        size_t const before = heap_allocations.load();
+        for (int frame = 0; frame < 8; ++frame) {
+            function();
+        }
+        return heap_allocations.load() - before;
+    }
+
+    struct Position {
+        float x, y, z;
+    };
+}    // namespace
+
+auto operator new(size_t size) -> void* {
+    return counted_allocation(size);
+}
+
+auto operator new[](size_t size) -> void* {
+    return counted_allocation(size);
+}
+
+auto operator new(size_t size, std::align_val_t alignment) -> void* {
+    return counted_allocation(size, static_cast<size_t>(alignment));
+}
+
+auto operator new[](size_t size, std::align_val_t alignment) -> void* {
+    return counted_allocation(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* data) noexcept {
+    aligned_free(data);
+}
+
+void operator delete[](void* data) noexcept {
+    aligned_free(data);
+}
+
+void operator delete(void* data, size_t /*size*/) noexcept {
+    aligned_free(data);
+}
+
+void operator delete[](void* data, size_t /*size*/) noexcept {
+    aligned_free(data);
+}
+
+void operator delete(void* data, std::align_val_t /*alignment*/) noexcept {
+    aligned_free(data);
+}
+
+void operator delete[](void* data, std::align_val_t /*alignment*/) noexcept {
+    aligned_free(data);
+}
+
+void operator delete(void* data, size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+    aligned_free(data);
+}
+
+void operator delete[](void* data, size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+    aligned_free(data);
+}
+
+auto main() -> int {
+    using utils::memory::LinearArena;
+    using utils::memory::ScratchScope;
+
+    // The frame arena: containers on it cost nothing once the block is big enough.
+    LinearArena arena(1024);
+    size_t const frame_allocations = allocations_of(
+        [&arena]()
+        {
+            std::pmr::vector<int> values(&arena);
+            values.reserve(64);
+            for (int i = 0; i < 64; ++i) {
+                values.push_back(i);
+            }
+            std::pmr::string name("a name well past the small string buffer", &arena);
+            assert(values[63] == 63 && name.size() > 16);
+            arena.reset();
+        });
+    assert(frame_allocations == 0);
+
+    // A frame that overflows grows the block at the reset; the next frames fit again.
+    arena.allocate_array<std::byte>(4096);
+    assert(arena.used() == 4096 && arena.capacity() < 4096);
+    arena.reset();
+    assert(arena.capacity() >= 4096 && arena.used() == 0);
+    size_t const grown_allocations = allocations_of(
+        [&arena]()
+        {
+            arena.allocate_array<std::byte>(4096);
+            arena.reset();
+        });
+    assert(grown_allocations == 0);
+
+    // Threads allocate from one arena at the same time without overlapping.
+    LinearArena shared(1 << 16);
+    std::vector<uint32_t*> slots(4 * 256);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back(
+            [&shared, &slots, t]()
+            {
+                for (size_t i = 0; i < 256; ++i) {
+                    uint32_t* slot = shared.allocate_array<uint32_t>(4);
+                    slot[0] = static_cast<uint32_t>(t * 256 + i);
+                    slots[t * 256 + i] = slot;
+                }
+            });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < slots.size(); ++i) {
+        assert(slots[i][0] == i);
+    }
+    assert(shared.used() == slots.size() * 4 * sizeof(uint32_t));
+
+    // Scratch scopes nest and hand the same memory out again once closed.
+    void* first = nullptr;
+    {
+        ScratchScope const outer;
+        first = outer.resource().allocate(256, 16);
+        {
+            ScratchScope const inner;
+            void* const nested = inner.resource().allocate(256, 16);
+            assert(nested != first);
+        }
+        assert(outer.resource().allocate(256, 16) != first);
+    }
+    {
+        ScratchScope const again;
+        assert(again.resource().allocate(256, 16) == first);
+    }
+
+    // Hot paths: statistics, parallel loops, the task graph and queries stay off the heap.
+    std::vector<double> const samples {5.0, 1.0, 4.0, 2.0, 3.0, 6.0};
+    assert(std::fabs(mathematics::statistics::median(samples) - 3.5) < 1e-12);
+    assert(std::fabs(mathematics::statistics::median({3.0, 1.0, 2.0}) - 2.0) < 1e-12);
+    assert(allocations_of([&samples]() { mathematics::statistics::median(samples); }) == 0);
+
+    utils::jobs::JobSystem system(4);
+    std::vector<float> values(1 << 16);
+    auto const loop = [&system, &values]()
+    {
+        utils::parallel::parallel_for(system,
+                                      values.size(),
+                                      1024,
+                                      [&values](size_t begin, size_t end)
+                                      {
+                                          for (size_t i = begin; i < end; ++i) {
+                                              values[i] += 1.0F;
+                                          }
+                                      });
+    };
+    assert(allocations_of(loop) == 0);
+
+    auto const sum = []()
+    {
+        return utils::parallel::parallel_reduce(
+            size_t {1} << 16,
+            1024,
+            size_t {0},
+            [](size_t begin, size_t end) { return end - begin; },
+            [](size_t a, size_t b) { return a + b; });
+    };
+    assert(sum() == size_t {1} << 16);
+    assert(allocations_of(sum) == 0);
+
+    utils::tasks::TaskGraph graph;
+    utils::tasks::ResourceId const resource = graph.add_resource("values");
+    std::atomic<int> runs {0};
+    graph.add_task({"write", [&runs]() { ++runs; }, {}, {resource}});
+    graph.add_task({"read", [&runs]() { ++runs; }, {resource}, {}});
+    graph.add_task({"read too", [&runs]() { ++runs; }, {resource}, {}});
+    assert(allocations_of([&graph, &system]() { graph.run(system); }) == 0);
+    assert(runs.load() == 27);
+
+    scene::ecs::World world;
+    for (int i = 0; i < 10000; ++i) {
+        world.create(Position {static_cast<float>(i), 0.0F, 0.0F});
+    }
+    scene::ecs::Query<Position> query(world);
+    auto const move = [&query, &system]()
+    {
+        query.each([](scene::ecs::Entity, Position& position) { position.y += 1.0F; });
+        query.parallel_each(system, [](scene::ecs::Entity, Position& position) { position.z += 1.0F; });
+    };
+    assert(allocations_of(move) == 0);
+
+    // Pools reuse freed slots, and a stale handle finds nothing even once its slot is taken again.
+    utils::pool::Pool<Position> pool;
+    auto const churn = [&pool]()
+    {
+        auto const older = pool.create(Position {1.0F, 2.0F, 3.0F});
+        auto const newer = pool.create(Position {4.0F, 5.0F, 6.0F});
+        assert(std::fabs(pool[newer].x - 4.0F) < 1e-6F);
+        pool.destroy(older);
+        assert(pool.get(older) == nullptr && !pool.destroy(older));
+        auto const reused = pool.create(Position {7.0F, 8.0F, 9.0F});
+        assert(pool.get(older) == nullptr && pool.contains(reused)
+               && std::fabs(pool[reused].x - 7.0F) < 1e-6F);
+        pool.destroy(newer);
+        pool.destroy(reused);
+    };
+    assert(allocations_of(churn) == 0 && pool.empty());
+
+    std::cout << "memory: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/assets/mesh.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+
+namespace {
+    using assets::mesh::Mesh;
+    using assets::mesh::Vec3;
+    using assets::mesh::Vertex;
+
+    constexpr uint32_t GRID_SIZE = 40;
+
+    auto same(float a, float b) -> bool {
+        return !(std::fabs(a - b) > 0.0F);
+    }
+
+    auto same(const Vertex& a, const Vertex& b) -> bool {
+        return same(a.position.x, b.position.x) && same(a.position.y, b.position.y)
+               && same(a.position.z, b.position.z) && same(a.normal.x, b.normal.x)
+               && same(a.normal.y, b.normal.y) && same(a.normal.z, b.normal.z) && same(a.u, b.u)
+               && same(a.v, b.v);
+    }
+
+    // A bumpy grid as a triangle soup: every triangle has its own three vertices.
+    auto grid_soup() -> Mesh {
+        auto const vertex = [](uint32_t x, uint32_t y) -> Vertex
+        {
+            float const u = static_cast<float>(x) / GRID_SIZE;
+            float const v = static_cast<float>(y) / GRID_SIZE;
+            Vec3 const normal = mathematics::normalize(Vec3 {std::sin(u * 6.0F), 1.0F, std::cos(v * 5.0F)});
+            return {{u * 10.0F, std::sin(u * 6.0F) * std::cos(v * 5.0F), v * -7.0F}, normal, u, v};
+        };
+
+        Mesh mesh;
+        for (uint32_t y = 0; y < GRID_SIZE; ++y) {
+            for (uint32_t x = 0; x < GRID_SIZE; ++x) {
+                Vertex const corners[6] = {vertex(x, y),
+                                           vertex(x + 1, y),
+                                           vertex(x, y + 1),
+                                           vertex(x + 1, y),
+                                           vertex(x + 1, y + 1),
+                                           vertex(x, y + 1)};
+                for (const Vertex& corner : corners) {
+                    mesh.indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+                    mesh.vertices.push_back(corner);
+                }
+            }
+        }
+        return mesh;
+    }
+
+    // The corners of every triangle, which no reordering may change.
+    auto corners(const Mesh& mesh) -> std::vector<Vertex> {
+        std::vector<Vertex> result;
+        for (uint32_t const index : mesh.indices) {
+            result.push_back(mesh.vertices[index]);
+        }
+        return result;
+    }
+
+    auto triangles(const Mesh& mesh) -> std::vector<std::array<uint32_t, 3>> {
+        std::vector<std::array<uint32_t, 3>> result;
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            result.push_back({mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]});
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void check_same_corners(const std::vector<Vertex>& a, const std::vector<Vertex>& b) {
+        assert(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            assert(same(a[i], b[i]));
+        }
+    }
+
+    void check_half() {
+        using assets::mesh::float_to_half;
+        using assets::mesh::half_to_float;
+
+        assert(float_to_half(0.0F) == 0x0000 && float_to_half(-0.0F) == 0x8000);
+        assert(float_to_half(1.0F) == 0x3C00 && float_to_half(-2.0F) == 0xC000);
+        assert(float_to_half(65504.0F) == 0x7BFF && float_to_half(70000.0F) == 0x7C00);
+        assert(float_to_half(std::numeric_limits<float>::infinity()) == 0x7C00);
+        assert((float_to_half(std::numeric_limits<float>::quiet_NaN()) & 0x7FFFU) > 0x7C00);
+        assert(float_to_half(std::ldexp(1.0F, -24)) == 0x0001 && float_to_half(1e-9F) == 0x0000);
+
+        // Halfway cases round to the even neighbour, in normals and subnormals alike.
+        assert(float_to_half(1.0F + std::ldexp(1.0F, -11)) == 0x3C00);
+        assert(float_to_half(1.0F + std::ldexp(3.0F, -11)) == 0x3C02);
+        assert(float_to_half(std::ldexp(3.0F, -25)) == 0x0002);
+        assert(float_to_half(65519.0F) == 0x7BFF && float_to_half(65520.0F) == 0x7C00);
+
+        // Every half but NaN survives the trip through a float.
+        for (uint32_t bits = 0; bits <= 0xFFFF; ++bits) {
+            auto const half = static_cast<uint16_t>(bits);
+            if ((half & 0x7C00U) == 0x7C00U && (half & 0x3FFU) != 0) {
+                assert(std::isnan(half_to_float(half)));
+                continue;
+            }
+            assert(float_to_half(half_to_float(half)) == half);
+        }
+    }
+
+    void check_octahedral() {
+        std::mt19937 random(5);
+        std::uniform_real_distribution<float> unit(-1.0F, 1.0F);
+        std::vector<Vec3> normals = {
+            {1.0F, 0.0F, 0.0F}, {-1.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, {0.0F, -1.0F, 0.0F},
+            {0.0F, 0.0F, 1.0F}, {0.0F, 0.0F, -1.0F}, {0.6F, 0.0F, -0.8F}, {0.0F, -0.6F, -0.8F},
+        };
+        for (int i = 0; i < 10000; ++i) {
+            Vec3 const direction {unit(random), unit(random), unit(random)};
+            if (mathematics::length(direction) > 0.01F) {
+                normals.push_back(mathematics::normalize(direction));
+            }
+        }
+        for (Vec3 const normal : normals) {
+            int16_t encoded[2];
+            assets::mesh::encode_octahedral(normal, encoded);
+            Vec3 const decoded = assets::mesh::decode_octahedral(encoded);
+            assert(std::fabs(mathematics::length(decoded) - 1.0F) < 1e-5F);
+            assert(mathematics::dot(decoded, normal) > 0.99999F);
+        }
+    }
+
+    // Positions within half a quantization step, normals within the octahedral error, uvs as halves.
+    void check_cooked(const Mesh& mesh) {
+        std::vector<std::byte> const blob = assets::mesh::cook(mesh);
+        assets::mesh::CookedMesh const cooked = assets::mesh::read_cooked(blob.data(), blob.size());
+        assert(cooked && cooked.header->vertex_count == mesh.vertices.size());
+        assert(cooked.header->index_count == mesh.indices.size());
+        assert(cooked.header->index_size == (mesh.vertices.size() <= 65535 ? 2 : 4));
+
+        Vec3 low = mesh.vertices[0].position;
+        Vec3 high = low;
+        for (const Vertex& vertex : mesh.vertices) {
+            low = mathematics::min(low, vertex.position);
+            high = mathematics::max(high, vertex.position);
+        }
+        for (size_t i = 0; i < mesh.indices.size(); ++i) {
+            assert(cooked.index(i) == mesh.indices[i]);
+        }
+        for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+            const Vertex& vertex = mesh.vertices[i];
+            Vec3 const position = cooked.position(i);
+            for (int axis = 0; axis < 3; ++axis) {
+                float const step = (high[axis] - low[axis]) / 65535.0F;
+                assert(std::fabs(position[axis] - vertex.position[axis]) <= (step * 0.5F) + 1e-5F);
+            }
+            assert(mathematics::dot(cooked.normal(i), vertex.normal) > 0.99999F);
+            float u = 0.0F;
+            float v = 0.0F;
+            cooked.uv(i, u, v);
+            assert(std::fabs(u - vertex.u) <= std::fabs(vertex.u) * 0x1p-11F + 1e-7F);
+            assert(std::fabs(v - vertex.v) <= std::fabs(vertex.v) * 0x1p-11F + 1e-7F);
+        }
+
+        // A blob that is cut short or is something else is not a mesh.
+        assert(!assets::mesh::read_cooked(blob.data(), blob.size() - 1));
+        assert(!assets::mesh::read_cooked(blob.data(), sizeof(assets::mesh::MeshHeader) - 1));
+        assert(!assets::mesh::read_cooked(nullptr, 0));
+        std::vector<std::byte> corrupt = blob;
+        corrupt[0] ^= std::byte {1};
+        assert(!assets::mesh::read_cooked(corrupt.data(), corrupt.size()));
+    }
+}    // namespace
+
+auto main() -> int {
+    check_half();
+    check_octahedral();
+
+    // Welding keeps every triangle and merges the shared corners of the grid.
+    Mesh mesh = grid_soup();
+    std::vector<Vertex> const soup = corners(mesh);
+    assets::mesh::weld(mesh);
+    assert(mesh.vertices.size() == size_t {GRID_SIZE + 1} * (GRID_SIZE + 1));
+    check_same_corners(corners(mesh), soup);
+
+    // -0 and +0 weld together; a vertex that differs in anything else stays apart.
+    Mesh signs;
+    signs.vertices = {{{0.0F, 1.0F, 2.0F}, {0.0F, 1.0F, 0.0F}, 0.5F, 0.0F},
+                      {{-0.0F, 1.0F, 2.0F}, {-0.0F, 1.0F, 0.0F}, 0.5F, -0.0F},
+                      {{0.0F, 1.0F, 2.0F}, {0.0F, 1.0F, 0.0F}, 0.5F, 0.25F},
+                      {{0.0F, 1.0F, 2.0F}, {0.0F, 0.0F, 1.0F}, 0.5F, 0.0F}};
+    signs.indices = {0, 1, 2, 1, 3, 0};
+    assets::mesh::weld(signs);
+    assert(signs.vertices.size() == 3 && (signs.indices == std::vector<uint32_t> {0, 0, 1, 0, 2, 0}));
+
+    // Shuffled triangles make a poor order; the optimizer permutes them back into a good one.
+    std::mt19937 random(3);
+    std::vector<std::array<uint32_t, 3>> shuffled = triangles(mesh);
+    std::shuffle(shuffled.begin(), shuffled.end(), random);
+    mesh.indices.clear();
+    for (const auto& triangle : shuffled) {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+    std::vector<std::array<uint32_t, 3>> const before = triangles(mesh);
+    float const shuffled_ratio = assets::mesh::cache_miss_ratio(mesh);
+    assets::mesh::optimize_vertex_cache(mesh);
+    assert(triangles(mesh) == before);
+    float const optimized_ratio = assets::mesh::cache_miss_ratio(mesh);
+    assert(optimized_ratio < 0.8F && optimized_ratio < shuffled_ratio * 0.5F);
+
+    // Vertices in order of first use, with an unused one dropped; the triangles are unchanged.
+    mesh.vertices.push_back({{99.0F, 99.0F, 99.0F}, {0.0F, 1.0F, 0.0F}, 0.0F, 0.0F});
+    std::vector<Vertex> const optimized = corners(mesh);
+    assets::mesh::optimize_vertex_fetch(mesh);
+    assert(mesh.vertices.size() == size_t {GRID_SIZE + 1} * (GRID_SIZE + 1));
+    check_same_corners(corners(mesh), optimized);
+    uint32_t next = 0;
+    for (uint32_t const index : mesh.indices) {
+        assert(index <= next);
+        if (index == next) {
+            ++next;
+        }
+    }
+    assert(assets::mesh::cache_miss_ratio(mesh) <= optimized_ratio);
+
+    // Cooked with 16-bit indices, and the soup with more vertices than those can address.
+    check_cooked(mesh);
+    Mesh large;
+    for (int copy = 0; copy < 14; ++copy) {
+        Mesh part = grid_soup();
+        for (uint32_t& index : part.indices) {
+            index += static_cast<uint32_t>(large.vertices.size());
+        }
+        large.vertices.insert(large.vertices.end(), part.vertices.begin(), part.vertices.end());
+        large.indices.insert(large.indices.end(), part.indices.begin(), part.indices.end());
+    }
+    assert(large.vertices.size() > 65535);
+    check_cooked(large);
+
+    std::cout << "mesh: all checks passed\n";
+    return 0;
+}
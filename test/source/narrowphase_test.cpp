@@ -0,0 +1,239 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/physics/broadphase.hpp"
+#include "domkrat3d/physics/narrowphase.hpp"
+
+namespace {
+    using mathematics::Quat;
+    using mathematics::Vec3;
+    using physics::narrowphase::Collider;
+    using physics::narrowphase::ConvexHull;
+    using physics::narrowphase::Manifold;
+    using physics::narrowphase::Narrowphase;
+    using physics::narrowphase::Shape;
+
+    constexpr float QUARTER_TURN = 1.5707964F;
+    constexpr float EIGHTH_TURN = 0.7853982F;
+    constexpr float SQRT2 = 1.4142135F;
+
+    // EPA stops within 1e-4 of the surface; everything else is exact up to rounding.
+    constexpr float TOLERANCE = 1e-3F;
+
+    const Vec3 X_AXIS {1.0F, 0.0F, 0.0F};
+    const Vec3 Y_AXIS {0.0F, 1.0F, 0.0F};
+    const Vec3 Z_AXIS {0.0F, 0.0F, 1.0F};
+
+    const Vec3 CUBE[] = {{-1.0F, -1.0F, -1.0F},
+                         {1.0F, -1.0F, -1.0F},
+                         {-1.0F, 1.0F, -1.0F},
+                         {1.0F, 1.0F, -1.0F},
+                         {-1.0F, -1.0F, 1.0F},
+                         {1.0F, -1.0F, 1.0F},
+                         {-1.0F, 1.0F, 1.0F},
+                         {1.0F, 1.0F, 1.0F},
+                         {0.0F, 0.0F, 0.0F}};
+
+    auto place(const Shape& shape, Vec3 position, Quat rotation = {}) -> Collider {
+        return {shape, {position, rotation}};
+    }
+
+    auto near(float value, float expected) -> bool {
+        return std::fabs(value - expected) <= TOLERANCE;
+    }
+
+    auto near(Vec3 value, Vec3 expected) -> bool {
+        return mathematics::length(value - expected) <= TOLERANCE;
+    }
+
+    // Contacts of the expected depth along the expected normal, from the first shape to the second.
+    void check_contact(const Collider& a, const Collider& b, Vec3 normal, float depth) {
+        Manifold manifold;
+        assert(physics::narrowphase::collide(a, b, manifold));
+        assert(manifold.count >= 1 && near(manifold.normal, normal));
+        for (int i = 0; i < manifold.count; ++i) {
+            assert(near(manifold.points[i].depth, depth));
+        }
+
+        // Swapped, the normal flips and the depth stays.
+        Manifold swapped;
+        assert(physics::narrowphase::collide(b, a, swapped));
+        assert(near(swapped.normal, -normal) && near(swapped.points[0].depth, depth));
+    }
+
+    // A contact whose normal is only known to be a unit vector, e.g. for coincident shapes.
+    void check_depth(const Collider& a, const Collider& b, float depth) {
+        Manifold manifold;
+        assert(physics::narrowphase::collide(a, b, manifold));
+        assert(manifold.count == 1 && near(mathematics::length(manifold.normal), 1.0F));
+        assert(near(manifold.points[0].depth, depth));
+    }
+
+    void check_spheres() {
+        Shape const unit = Shape::sphere(1.0F);
+        check_contact(place(unit, {}), place(unit, {1.5F, 0.0F, 0.0F}), X_AXIS, 0.5F);
+        check_contact(
+            place(unit, {0.0F, -1.0F, 0.0F}), place(Shape::sphere(0.5F), {0.0F, 0.3F, 0.0F}), Y_AXIS, 0.2F);
+
+        // Within the contact margin the depth is a negative gap; beyond it nothing touches.
+        check_contact(place(unit, {}), place(unit, {0.0F, 0.0F, 2.01F}), Z_AXIS, -0.01F);
+        Manifold manifold;
+        assert(!physics::narrowphase::collide(place(unit, {}), place(unit, {2.05F, 0.0F, 0.0F}), manifold));
+
+        // Same centers: pushed apart by both radii in some direction.
+        check_depth(place(unit, {}), place(unit, {}), 2.0F);
+        check_depth(place(unit, {3.0F, 1.0F, 2.0F}), place(Shape::sphere(0.25F), {3.0F, 1.0F, 2.0F}), 1.25F);
+    }
+
+    void check_boxes_and_spheres() {
+        Shape const cube = Shape::box({1.0F, 1.0F, 1.0F});
+        Shape const ball = Shape::sphere(0.5F);
+
+        // Against a face, shallow and with the center inside the box.
+        check_contact(place(cube, {}), place(ball, {0.0F, 1.3F, 0.0F}), Y_AXIS, 0.2F);
+        check_contact(place(cube, {}), place(ball, {0.2F, 0.8F, -0.1F}), Y_AXIS, 0.7F);
+        check_contact(place(cube, {}), place(ball, {-1.4F, 0.5F, 0.3F}), -X_AXIS, 0.1F);
+
+        // Against an edge of a box turned an eighth about z.
+        Quat const turned = mathematics::from_axis_angle(Z_AXIS, EIGHTH_TURN);
+        check_contact(place(cube, {}, turned), place(ball, {0.0F, SQRT2 + 0.3F, 0.0F}), Y_AXIS, 0.2F);
+
+        // A corner, along the diagonal.
+        Vec3 const diagonal = mathematics::normalize(Vec3 {1.0F, 1.0F, 1.0F});
+        Vec3 const corner {1.0F, 1.0F, 1.0F};
+        check_contact(place(cube, {}), place(ball, corner + (diagonal * 0.4F)), diagonal, 0.1F);
+    }
+
+    void check_capsules() {
+        Shape const capsule = Shape::capsule(0.25F, 1.0F);
+        Quat const along_x = mathematics::from_axis_angle(Z_AXIS, QUARTER_TURN);
+
+        // Crossing segments separate along their common perpendicular, even when they meet.
+        check_contact(place(capsule, {}), place(capsule, {0.0F, 0.2F, 0.4F}, along_x), Z_AXIS, 0.1F);
+        check_depth(place(capsule, {}), place(capsule, {0.0F, 0.3F, 0.0F}, along_x), 0.5F);
+
+        // Side by side, end on, coincident.
+        check_contact(place(capsule, {}), place(capsule, {0.45F, 0.5F, 0.0F}), X_AXIS, 0.05F);
+        check_contact(place(capsule, {}), place(capsule, {0.0F, 2.4F, 0.0F}), Y_AXIS, 0.1F);
+        check_depth(place(capsule, {}), place(capsule, {}), 0.5F);
+
+        // Against a sphere beside the segment and one centered on it, then a box face.
+        check_contact(place(capsule, {}), place(Shape::sphere(0.5F), {0.6F, 0.7F, 0.0F}), X_AXIS, 0.15F);
+        check_depth(place(capsule, {}), place(Shape::sphere(0.5F), {0.0F, 0.7F, 0.0F}), 0.75F);
+        Collider const slab = place(Shape::box({2.0F, 0.5F, 2.0F}), {});
+        check_contact(slab, place(capsule, {0.3F, 0.4F, 0.0F}, along_x), Y_AXIS, 0.35F);
+    }
+
+    void check_hulls() {
+        ConvexHull const hull(CUBE, sizeof(CUBE) / sizeof(CUBE[0]));
+        assert(hull.vertex_count() == 9);
+        Shape const shape = Shape::convex_hull(hull);
+
+        check_contact(place(shape, {}), place(Shape::sphere(0.5F), {1.3F, 0.0F, 0.0F}), X_AXIS, 0.2F);
+        check_contact(place(shape, {}), place(shape, {0.3F, -1.85F, 0.2F}), -Y_AXIS, 0.15F);
+        Collider const small = place(Shape::box({0.5F, 0.5F, 0.5F}), {0.0F, 0.0F, -1.4F});
+        check_contact(place(shape, {}), small, -Z_AXIS, 0.1F);
+
+        // The hull matches the box of the same size.
+        Quat const tilted = mathematics::from_axis_angle(X_AXIS, 0.3F);
+        Manifold from_hull;
+        Manifold from_box;
+        Collider const ball = place(Shape::sphere(0.7F), {0.4F, 1.5F, 0.1F});
+        assert(physics::narrowphase::collide(place(shape, {}, tilted), ball, from_hull));
+        Collider const box = place(Shape::box({1.0F, 1.0F, 1.0F}), {}, tilted);
+        assert(physics::narrowphase::collide(box, ball, from_box));
+        assert(near(from_hull.normal, from_box.normal));
+        assert(near(from_hull.points[0].depth, from_box.points[0].depth));
+    }
+
+    // Box on box gives the whole face in one query: four points of the same depth.
+    void check_face_contact() {
+        Shape const cube = Shape::box({1.0F, 1.0F, 1.0F});
+        Manifold manifold;
+        assert(physics::narrowphase::collide(place(cube, {}), place(cube, {0.3F, 1.9F, -0.2F}), manifold));
+        assert(manifold.count == 4 && near(manifold.normal, Y_AXIS));
+        for (int i = 0; i < manifold.count; ++i) {
+            const auto& point = manifold.points[i];
+            assert(near(point.depth, 0.1F) && near(point.position.y, 0.95F));
+            assert(std::fabs(point.position.x) <= 1.0F + TOLERANCE);
+            assert(std::fabs(point.position.z) <= 1.0F + TOLERANCE);
+        }
+    }
+
+    // An edge of one box across an edge of the other: one point, the normal across both edges.
+    void check_edge_contact() {
+        Shape const cube = Shape::box({1.0F, 1.0F, 1.0F});
+        Collider const lower = place(cube, {}, mathematics::from_axis_angle(Z_AXIS, EIGHTH_TURN));
+        Collider const upper = place(
+            cube, {0.0F, (2.0F * SQRT2) - 0.1F, 0.0F}, mathematics::from_axis_angle(X_AXIS, EIGHTH_TURN));
+
+        Manifold manifold;
+        assert(physics::narrowphase::collide(lower, upper, manifold));
+        assert(manifold.count == 1 && near(manifold.normal, Y_AXIS) && near(manifold.points[0].depth, 0.1F));
+        assert(near(manifold.points[0].position, {0.0F, SQRT2 - 0.05F, 0.0F}));
+    }
+
+    // Manifolds persist across frames: an unmoved pair is served from the cache with its impulses, a
+    // slightly moved one keeps the impulses of the points it still has.
+    void check_cache() {
+        Shape const cube = Shape::box({1.0F, 1.0F, 1.0F});
+        Collider colliders[] = {
+            place(cube, {}), place(cube, {0.0F, 1.95F, 0.0F}), place(cube, {5.0F, 0.0F, 0.0F})};
+        physics::broadphase::Pair const pairs[] = {{1, 0}, {0, 2}, {0, 1}};
+
+        Narrowphase narrowphase;
+        narrowphase.update(pairs, 3, colliders);
+        assert(narrowphase.manifolds().size() == 2 && narrowphase.reused_count() == 0);
+        assert(narrowphase.contact_count() == 4);
+        Manifold& resting = narrowphase.manifolds()[0];
+        assert(resting.first == 0 && resting.second == 1 && resting.count == 4);
+        assert(narrowphase.manifolds()[1].count == 0);
+        for (int i = 0; i < resting.count; ++i) {
+            resting.points[i].normal_impulse = 5.0F;
+        }
+
+        narrowphase.update(pairs, 3, colliders);
+        assert(narrowphase.reused_count() >= 1 && narrowphase.manifolds()[0].count == 4);
+        for (int i = 0; i < 4; ++i) {
+            assert(near(narrowphase.manifolds()[0].points[i].normal_impulse, 5.0F));
+        }
+
+        colliders[1].transform.position.x += 0.005F;
+        narrowphase.update(pairs, 3, colliders, physics::kinematics::Execution::Serial);
+        const Manifold& moved = narrowphase.manifolds()[0];
+        assert(moved.count == 4 && near(moved.normal, Y_AXIS));
+        for (int i = 0; i < moved.count; ++i) {
+            assert(near(moved.points[i].normal_impulse, 5.0F) && near(moved.points[i].depth, 0.05F));
+        }
+
+        // Sleeping pairs keep their manifold untouched; a pair that leaves the input is forgotten.
+        uint8_t const asleep[] = {0, 0, 0};
+        colliders[1].transform.position.y += 0.5F;
+        narrowphase.update(pairs, 3, colliders, physics::kinematics::Execution::Parallel, asleep);
+        const Manifold& kept = narrowphase.manifolds()[0];
+        assert(kept.count == 4 && near(kept.points[0].depth, 0.05F));
+
+        narrowphase.update(pairs, 1, colliders);
+        assert(narrowphase.manifolds().size() == 1 && narrowphase.manifolds()[0].count == 0);
+        narrowphase.clear();
+        assert(narrowphase.manifolds().empty() && narrowphase.contact_count() == 0);
+    }
+}    // namespace
+
+auto main() -> int {
+    check_spheres();
+    check_boxes_and_spheres();
+    check_capsules();
+    check_hulls();
+    check_face_contact();
+    check_edge_contact();
+    check_cache();
+
+    std::cout << "narrowphase: all checks passed\n";
+    return 0;
+}
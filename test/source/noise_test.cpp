@@ -0,0 +1,181 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/utils/noise.hpp"
+
+namespace {
+    using utils::noise::Fractal;
+    using utils::noise::NoiseSettings;
+    using utils::noise::NoiseType;
+
+    // Not a multiple of the SIMD width, so every batch ends in a padded tail.
+    constexpr size_t COUNT = 1003;
+
+    const NoiseType TYPES[] = {NoiseType::Value, NoiseType::Perlin, NoiseType::Simplex};
+    const Fractal FRACTALS[] = {Fractal::None, Fractal::Fbm, Fractal::Ridged};
+
+    // Batch and scalar paths share their kernels, so they agree to the last bit or close to it.
+    auto same(float a, float b) -> bool {
+        return std::fabs(a - b) <= 1e-6F;
+    }
+
+    // Every noise is about [-1, 1]; value noise exactly so.
+    auto in_range(NoiseType type, float value) -> bool {
+        float const bound = type == NoiseType::Value ? 1.0F : 1.05F;
+        return std::isfinite(value) && std::fabs(value) <= bound;
+    }
+
+    auto base(NoiseType type, float x, float y, uint32_t seed) -> float {
+        switch (type) {
+            case NoiseType::Value:
+                return utils::noise::value(x, y, seed);
+            case NoiseType::Perlin:
+                return utils::noise::perlin(x, y, seed);
+            case NoiseType::Simplex:
+                return utils::noise::simplex(x, y, seed);
+        }
+        return 0.0F;
+    }
+
+    void check_batches(const NoiseSettings& settings, const std::vector<float> (&axes)[4]) {
+        std::vector<float> out(COUNT);
+
+        utils::noise::evaluate(settings, axes[0].data(), axes[1].data(), out.data(), COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            assert(same(out[i], utils::noise::sample(settings, axes[0][i], axes[1][i])));
+            assert(in_range(settings.type, out[i]));
+        }
+
+        utils::noise::evaluate(settings, axes[0].data(), axes[1].data(), axes[2].data(), out.data(), COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            assert(same(out[i], utils::noise::sample(settings, axes[0][i], axes[1][i], axes[2][i])));
+            assert(in_range(settings.type, out[i]));
+        }
+
+        utils::noise::evaluate(
+            settings, axes[0].data(), axes[1].data(), axes[2].data(), axes[3].data(), out.data(), COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            float const expected =
+                utils::noise::sample(settings, axes[0][i], axes[1][i], axes[2][i], axes[3][i]);
+            assert(same(out[i], expected));
+            assert(in_range(settings.type, out[i]));
+        }
+
+        // Short batches are all tail.
+        for (size_t count = 1; count < 8; ++count) {
+            utils::noise::evaluate(settings, axes[0].data(), axes[1].data(), out.data(), count);
+            for (size_t i = 0; i < count; ++i) {
+                assert(same(out[i], utils::noise::sample(settings, axes[0][i], axes[1][i])));
+            }
+        }
+    }
+
+    // Grids and volumes with rows that end in a tail, against single samples.
+    void check_grids(const NoiseSettings& settings) {
+        size_t const width = 13;
+        size_t const height = 6;
+        size_t const depth = 3;
+        float const step = 0.37F;
+
+        std::vector<float> grid(width * height);
+        utils::noise::evaluate_grid(settings, grid.data(), width, height, -2.0F, 5.0F, step);
+        for (size_t row = 0; row < height; ++row) {
+            for (size_t column = 0; column < width; ++column) {
+                float const x = -2.0F + (static_cast<float>(column) * step);
+                float const y = 5.0F + (static_cast<float>(row) * step);
+                assert(same(grid[(row * width) + column], utils::noise::sample(settings, x, y)));
+            }
+        }
+
+        std::vector<float> volume(width * height * depth);
+        utils::noise::evaluate_volume(settings, volume.data(), width, height, depth, 1.0F, -3.0F, 0.5F, step);
+        for (size_t slice = 0; slice < depth; ++slice) {
+            for (size_t row = 0; row < height; ++row) {
+                for (size_t column = 0; column < width; ++column) {
+                    float const x = 1.0F + (static_cast<float>(column) * step);
+                    float const y = -3.0F + (static_cast<float>(row) * step);
+                    float const z = 0.5F + (static_cast<float>(slice) * step);
+                    size_t const index = (((slice * height) + row) * width) + column;
+                    assert(same(volume[index], utils::noise::sample(settings, x, y, z)));
+                }
+            }
+        }
+    }
+
+    void check_seeds(const std::vector<float> (&axes)[4]) {
+        for (NoiseType const type : TYPES) {
+            NoiseSettings settings;
+            settings.type = type;
+            std::vector<float> first(COUNT);
+            std::vector<float> second(COUNT);
+            utils::noise::evaluate(settings, axes[0].data(), axes[1].data(), first.data(), COUNT);
+            utils::noise::evaluate(settings, axes[0].data(), axes[1].data(), second.data(), COUNT);
+            assert(first == second);
+
+            settings.seed += 1;
+            utils::noise::evaluate(settings, axes[0].data(), axes[1].data(), second.data(), COUNT);
+            size_t differ = 0;
+            for (size_t i = 0; i < COUNT; ++i) {
+                if (!same(first[i], second[i])) {
+                    ++differ;
+                }
+            }
+            assert(differ > COUNT / 2);
+        }
+    }
+
+    // Without a fractal the base noise comes out as is; one octave still applies the fractal.
+    void check_octaves(const std::vector<float> (&axes)[4]) {
+        for (NoiseType const type : TYPES) {
+            for (size_t i = 0; i < 100; ++i) {
+                float const x = axes[0][i];
+                float const y = axes[1][i];
+                float const plain = base(type, x, y, 7);
+
+                NoiseSettings settings {type, Fractal::None, 7, 5, 1.0F, 2.0F, 0.5F};
+                assert(same(utils::noise::sample(settings, x, y), plain));
+
+                settings.fractal = Fractal::Fbm;
+                settings.octaves = 1;
+                assert(same(utils::noise::sample(settings, x, y), plain));
+
+                settings.fractal = Fractal::Ridged;
+                assert(same(utils::noise::sample(settings, x, y), 1.0F - (2.0F * std::fabs(plain))));
+                settings.octaves = 0;
+                assert(same(utils::noise::sample(settings, x, y), 1.0F - (2.0F * std::fabs(plain))));
+            }
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> coordinate(-50.0F, 50.0F);
+    std::vector<float> axes[4];
+    for (auto& axis : axes) {
+        for (size_t i = 0; i < COUNT; ++i) {
+            axis.push_back(coordinate(random));
+        }
+    }
+
+    for (NoiseType const type : TYPES) {
+        for (Fractal const fractal : FRACTALS) {
+            NoiseSettings settings;
+            settings.type = type;
+            settings.fractal = fractal;
+            settings.frequency = 0.3F;
+            check_batches(settings, axes);
+            check_grids(settings);
+        }
+    }
+    check_seeds(axes);
+    check_octaves(axes);
+
+    std::cout << "noise: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "domkrat3d/mathematics/geometry.hpp"
+#include "domkrat3d/mathematics/matrix.hpp"
+#include "domkrat3d/mathematics/vector.hpp"
+#include "domkrat3d/scene/culling.hpp"
+#include "domkrat3d/scene/occlusion.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using mathematics::Mat4;
+    using mathematics::Vec3;
+    using mathematics::geometry::Aabb;
+    using scene::occlusion::OcclusionBuffer;
+
+    // The camera looks down -Z from z = 10 at the occluder, a quad in the plane z = 0.
+    constexpr float EYE_Z = 10.0F;
+    constexpr float HALF_WIDTH = 4.0F;
+    constexpr float HALF_HEIGHT = 3.0F;
+
+    const Vec3 QUAD[] = {{-HALF_WIDTH, -HALF_HEIGHT, 0.0F},
+                         {HALF_WIDTH, -HALF_HEIGHT, 0.0F},
+                         {HALF_WIDTH, HALF_HEIGHT, 0.0F},
+                         {-HALF_WIDTH, HALF_HEIGHT, 0.0F}};
+    const uint32_t QUAD_INDICES[] = {0, 1, 2, 0, 2, 3};
+
+    struct Case {
+        Aabb box;
+        bool occluded;
+    };
+
+    // Boxes behind the quad are hidden; any part in front of it, beside it, through the near plane
+    // or off screen is enough to be seen.
+    const Case CASES[] = {
+        {{{-1.0F, -1.0F, -5.0F}, {1.0F, 1.0F, -3.0F}}, true},
+        {{{2.5F, 1.5F, -3.0F}, {3.5F, 2.5F, -0.5F}}, true},
+        {{{-3.9F, -2.9F, -40.0F}, {3.9F, 2.9F, -1.0F}}, true},
+        {{{-0.1F, -0.1F, -0.3F}, {0.1F, 0.1F, -0.1F}}, true},
+        {{{-1.0F, -1.0F, 1.0F}, {1.0F, 1.0F, 2.0F}}, false},
+        {{{-1.0F, -1.0F, -1.0F}, {1.0F, 1.0F, 1.0F}}, false},
+        {{{3.0F, -1.0F, -5.0F}, {6.0F, 1.0F, -3.0F}}, false},
+        {{{-1.0F, 2.5F, -5.0F}, {1.0F, 5.0F, -3.0F}}, false},
+        {{{-5.0F, -4.0F, -2.0F}, {5.0F, 4.0F, -1.0F}}, false},
+        {{{-1.0F, -1.0F, 9.0F}, {1.0F, 1.0F, 12.0F}}, false},
+        {{{-1.0F, -1.0F, 11.0F}, {1.0F, 1.0F, 12.0F}}, false},
+        {{{60.0F, -1.0F, -5.0F}, {62.0F, 1.0F, -3.0F}}, false},
+        {{{-1.0F, -40.0F, -5.0F}, {1.0F, -38.0F, -3.0F}}, false},
+        {{{-1.0F, -1.0F, -500.0F}, {1.0F, 1.0F, -300.0F}}, false},
+    };
+
+    // Depth of a point as the buffer stores it, z/w of clip space.
+    auto depth_of(const Mat4& m, Vec3 point) -> float {
+        float clip[4];
+        for (int row = 0; row < 4; ++row) {
+            clip[row] = (m.columns[0][row] * point.x) + (m.columns[1][row] * point.y)
+                        + (m.columns[2][row] * point.z) + m.columns[3][row];
+        }
+        return clip[2] / clip[3];
+    }
+
+    void check_cases(const OcclusionBuffer& buffer) {
+        for (const Case& test : CASES) {
+            assert(buffer.occluded(test.box) == test.occluded);
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    // Sizes round up to whole tiles; zero is refused.
+    OcclusionBuffer buffer(250, 120);
+    assert(buffer.width() == 256 && buffer.height() == 128);
+    bool thrown = false;
+    try {
+        OcclusionBuffer const empty(0, 64);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    float const aspect = static_cast<float>(buffer.width()) / static_cast<float>(buffer.height());
+    Mat4 const view_projection = mathematics::perspective(1.0F, aspect, 0.5F, 100.0F)
+                                 * mathematics::look_at({0.0F, 0.0F, EYE_Z}, {}, {0.0F, 1.0F, 0.0F});
+    Mat4 const identity = mathematics::affine(mathematics::diagonal({1.0F, 1.0F, 1.0F}), {});
+
+    // Without occluders nothing is hidden.
+    utils::jobs::JobSystem jobs(4);
+    buffer.begin(view_projection);
+    buffer.rasterize(jobs);
+    for (const Case& test : CASES) {
+        assert(!buffer.occluded(test.box));
+    }
+
+    buffer.add_occluder(QUAD, 4, QUAD_INDICES, 6, identity);
+    assert(buffer.triangle_count() == 2);
+    buffer.rasterize(jobs);
+    check_cases(buffer);
+
+    // The quad is at its own depth in the middle of the buffer, and the corners stay clear.
+    std::vector<float> const depth = buffer.depth();
+    float const centre = depth[(size_t {buffer.height()} / 2 * buffer.width()) + (buffer.width() / 2)];
+    assert(std::fabs(centre - depth_of(view_projection, {})) < 1e-5F);
+    assert(!(depth.front() < 1.0F) && !(depth.back() < 1.0F));
+
+    // The batch test agrees with the single one, keeping the order of the candidates.
+    scene::culling::BoxArray boxes;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> expected;
+    for (const Case& test : CASES) {
+        candidates.insert(candidates.begin(), boxes.add(test.box));
+        if (!test.occluded) {
+            expected.insert(expected.begin(), candidates.front());
+        }
+    }
+    std::vector<uint32_t> visible;
+    buffer.cull(boxes, candidates, visible, jobs);
+    assert(visible == expected);
+
+    // The same quad moved by its world matrix, rasterized by the caller alone, gives the same result.
+    utils::jobs::JobSystem alone(1);
+    Vec3 const local[] = {{0.0F, 0.0F, 0.0F}, {2.0F, 0.0F, 0.0F}, {2.0F, 2.0F, 0.0F}, {0.0F, 2.0F, 0.0F}};
+    Mat4 const world = mathematics::affine(mathematics::diagonal({HALF_WIDTH, HALF_HEIGHT, 1.0F}),
+                                           {-HALF_WIDTH, -HALF_HEIGHT, 0.0F});
+    buffer.begin(view_projection);
+    buffer.add_occluder(local, 4, QUAD_INDICES, 6, world);
+    buffer.rasterize(alone);
+    check_cases(buffer);
+    for (size_t i = 0; i < depth.size(); ++i) {
+        assert(std::fabs(buffer.depth()[i] - depth[i]) < 1e-5F);
+    }
+
+    // A quad seen edge on covers nothing; a bad index is refused.
+    Vec3 const edge_on[] = {{-4.0F, 0.0F, -1.0F},
+                            {4.0F, 0.0F, -1.0F},
+                            {4.0F, 0.0F, -9.0F},
+                            {-4.0F, 0.0F, -9.0F}};
+    buffer.begin(view_projection);
+    buffer.add_occluder(edge_on, 4, QUAD_INDICES, 6, identity);
+    buffer.rasterize(jobs);
+    assert(!buffer.occluded(CASES[0].box));
+
+    thrown = false;
+    uint32_t const bad[] = {0, 1, 4};
+    try {
+        buffer.add_occluder(QUAD, 4, bad, 3, identity);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "occlusion: all checks passed\n";
+    return 0;
+}
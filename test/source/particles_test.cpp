@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "domkrat3d/physics/kinematics.hpp"
+#include "domkrat3d/physics/particles.hpp"
+
+namespace {
+    using physics::kinematics::Execution;
+    using physics::particles::Emitter;
+    using physics::particles::EmitterShape;
+    using physics::particles::ForceType;
+    using physics::particles::Integrator;
+    using physics::particles::ParticlePool;
+    using physics::particles::ParticleSystem;
+
+    constexpr float GRAVITY = -9.81F;
+
+    auto close(float value, float expected) -> bool {
+        return std::fabs(value - expected) <= 1e-4F * (1.0F + std::fabs(expected));
+    }
+
+    auto burst() -> Emitter {
+        Emitter emitter;
+        emitter.x = 1.0F;
+        emitter.y = 2.0F;
+        emitter.z = -3.0F;
+        emitter.radius = 2.0F;
+        emitter.min_speed = 3.0F;
+        emitter.max_speed = 5.0F;
+        emitter.min_lifetime = 0.5F;
+        emitter.max_lifetime = 1.0F;
+        return emitter;
+    }
+
+    // Spawned particles lie in the ball of the emitter, spread through its volume, and start with
+    // speeds and lifetimes in range.
+    void check_spawn() {
+        size_t const count = 20003;
+        ParticleSystem system(count - 3);
+        Emitter emitter = burst();
+        assert(system.emit(emitter, count) == count - 3 && system.emit(emitter, 1) == 0);
+
+        const ParticlePool& pool = system.pool();
+        size_t inner = 0;
+        for (size_t i = 0; i < pool.size; ++i) {
+            float const dx = pool.px[i] - emitter.x;
+            float const dy = pool.py[i] - emitter.y;
+            float const dz = pool.pz[i] - emitter.z;
+            float const distance = std::sqrt((dx * dx) + (dy * dy) + (dz * dz));
+            assert(distance <= emitter.radius * 1.0001F);
+            if (distance < emitter.radius * 0.5F) {
+                ++inner;
+            }
+            float const speed =
+                std::sqrt((pool.vx[i] * pool.vx[i]) + (pool.vy[i] * pool.vy[i]) + (pool.vz[i] * pool.vz[i]));
+            assert(speed >= emitter.min_speed * 0.9999F && speed < emitter.max_speed * 1.0001F);
+            assert(pool.lifetime[i] >= emitter.min_lifetime && pool.lifetime[i] < emitter.max_lifetime);
+            assert(!(pool.age[i] > 0.0F));
+        }
+
+        // An eighth of a uniform ball lies within half its radius.
+        double const fraction = static_cast<double>(inner) / static_cast<double>(pool.size);
+        assert(std::fabs(fraction - 0.125) < 0.01);
+
+        // Hemisphere emitters shoot along their direction; a point emitter spawns at its position.
+        ParticleSystem hemisphere(1001);
+        emitter.shape = EmitterShape::Hemisphere;
+        emitter.radius = 0.0F;
+        emitter.direction_x = 0.0F;
+        emitter.direction_y = 0.0F;
+        emitter.direction_z = -1.0F;
+        hemisphere.emit(emitter, 1001);
+        const ParticlePool& shot = hemisphere.pool();
+        for (size_t i = 0; i < shot.size; ++i) {
+            assert(!(shot.vz[i] > 0.0F));
+            assert(close(shot.px[i], emitter.x) && close(shot.py[i], emitter.y));
+            assert(close(shot.pz[i], emitter.z));
+        }
+    }
+
+    // One step under uniform gravity against the closed form of each scheme.
+    void check_step(Integrator integrator) {
+        ParticleSystem system(1003);
+        Emitter emitter = burst();
+        emitter.min_lifetime = 10.0F;
+        emitter.max_lifetime = 11.0F;
+        system.add_force({ForceType::Uniform, 0.0F, GRAVITY, 0.0F});
+        system.emit(emitter, 1003);
+        system.set_integrator(integrator);
+
+        ParticlePool const before = system.pool();
+        float const time = 0.05F;
+        system.step(time);
+        const ParticlePool& after = system.pool();
+        assert(after.size == before.size);
+
+        for (size_t i = 0; i < after.size; ++i) {
+            float const vy = before.vy[i] + (GRAVITY * time);
+            // Semi-implicit Euler moves with the new velocity; the others follow the parabola.
+            float const py = integrator == Integrator::SemiImplicitEuler
+                                 ? before.py[i] + (vy * time)
+                                 : before.py[i] + (before.vy[i] * time) + (0.5F * GRAVITY * time * time);
+            assert(close(after.px[i], before.px[i] + (before.vx[i] * time)));
+            assert(close(after.pz[i], before.pz[i] + (before.vz[i] * time)));
+            assert(close(after.py[i], py));
+            assert(close(after.vx[i], before.vx[i]) && close(after.vz[i], before.vz[i]));
+            assert(close(after.vy[i], vy));
+            assert(close(after.age[i], time));
+        }
+    }
+
+    // Expired particles leave the pool at the end of the step they expire in; the rest stay.
+    void check_expiry() {
+        ParticleSystem system(5001);
+        Emitter emitter = burst();
+        emitter.min_lifetime = 0.1F;
+        emitter.max_lifetime = 0.4F;
+        system.emit(emitter, 5001);
+        const std::vector<float>& spawned = system.pool().lifetime;
+        std::vector<float> lifetimes(spawned.begin(),
+                                     spawned.begin() + static_cast<std::ptrdiff_t>(system.size()));
+
+        float const time = 0.03F;
+        float age = 0.0F;
+        while (system.size() > 0) {
+            system.step(time);
+            age += time;
+
+            std::vector<float> expected;
+            std::copy_if(lifetimes.begin(),
+                         lifetimes.end(),
+                         std::back_inserter(expected),
+                         [age](float lifetime) { return lifetime > age; });
+            const ParticlePool& pool = system.pool();
+            std::vector<float> alive(pool.lifetime.begin(),
+                                     pool.lifetime.begin() + static_cast<std::ptrdiff_t>(pool.size));
+            std::sort(expected.begin(), expected.end());
+            std::sort(alive.begin(), alive.end());
+            assert(alive == expected);
+            for (size_t i = 0; i < pool.size; ++i) {
+                assert(pool.age[i] < pool.lifetime[i]);
+            }
+        }
+        assert(!(age > 0.45F));
+    }
+
+    // Worker threads give the same pool as the calling thread; update() keeps to its step cap.
+    void check_parallel() {
+        ParticleSystem serial(30000, 9);
+        ParticleSystem parallel(30000, 9);
+        parallel.set_execution(Execution::Parallel);
+        for (ParticleSystem* system : {&serial, &parallel}) {
+            Emitter emitter = burst();
+            emitter.rate = 200000.0F;
+            system->add_emitter(emitter);
+            system->add_force({ForceType::Uniform, 0.0F, GRAVITY, 0.0F});
+            system->add_force({ForceType::Drag, 0.0F, 0.0F, 0.0F, 0.3F});
+            system->set_integrator(Integrator::Rk4);
+            system->set_fixed_step(0.01F, 4);
+            assert(system->update(0.1F) == 4);
+        }
+        assert(serial.size() == parallel.size() && serial.size() > 4096);
+        const ParticlePool& a = serial.pool();
+        const ParticlePool& b = parallel.pool();
+        assert(a.px == b.px && a.py == b.py && a.pz == b.pz && a.vy == b.vy && a.age == b.age);
+    }
+}    // namespace
+
+auto main() -> int {
+    check_spawn();
+    check_step(Integrator::SemiImplicitEuler);
+    check_step(Integrator::VelocityVerlet);
+    check_step(Integrator::Rk4);
+    check_expiry();
+    check_parallel();
+
+    std::cout << "particles: all checks passed\n";
+    return 0;
+}
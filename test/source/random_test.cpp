@@ -0,0 +1,114 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/utils/random.hpp"
+
+auto main() -> int {
+    // Reference output of xoshiro256** for the state {1, 2, 3, 4}.
+    utils::random::Xoshiro256 reference(1, 2, 3, 4);
+    assert(reference.next() == 11520);
+    assert(reference.next() == 0);
+    assert(reference.next() == 1509978240);
+    assert(reference.next() == 1215971899390074240ULL);
+
+    // Same seed, same sequence; split streams differ from their parent.
+    utils::random::Xoshiro256 first(42);
+    utils::random::Xoshiro256 second(42);
+    assert(first.next() == second.next());
+
+    utils::random::Xoshiro256 child = first.split();
+    assert(child.next() != first.next());
+
+    // The color helper must not repeat itself within a second any more.
+    float const red = generate_random_float();
+    float const green = generate_random_float();
+    float const blue = generate_random_float();
+    assert(std::fabs(red - green) > 0.0F || std::fabs(green - blue) > 0.0F);
+    assert(red >= 0.0F && red < 1.0F);
+
+    // Seeding is allowed as the first random call of a thread, and the same seed gives the same stream.
+    uint64_t seeded[2] = {};
+    for (uint64_t& value : seeded) {
+        std::thread thread(
+            [&value]
+            {
+                utils::random::seed_thread_engines(99);
+                value = utils::random::thread_engine().next();
+            });
+        thread.join();
+    }
+    assert(seeded[0] == seeded[1]);
+
+    for (int i = 0; i < 10000; ++i) {
+        int32_t const value = first.uniform_int(-3, 3);
+        assert(value >= -3 && value <= 3);
+    }
+
+    const size_t count = 100003;
+    utils::random::BatchEngine engine(7);
+
+    std::vector<float> uniform(count);
+    utils::random::fill_uniform(engine, uniform.data(), count, 2.0F, 4.0F);
+    double sum = 0.0;
+    for (float const value : uniform) {
+        assert(value >= 2.0F && value < 4.0F);
+        sum += static_cast<double>(value);
+    }
+    assert(std::fabs((sum / count) - 3.0) < 0.01);
+
+    std::vector<double> uniform_double(count);
+    utils::random::fill_uniform(engine, uniform_double.data(), count);
+    for (double const value : uniform_double) {
+        assert(value >= 0.0 && value < 1.0);
+    }
+
+    std::vector<int32_t> dice(count);
+    utils::random::fill_uniform_int(engine, dice.data(), count, 1, 6);
+    std::vector<size_t> faces(7, 0);
+    for (int32_t const value : dice) {
+        assert(value >= 1 && value <= 6);
+        faces[static_cast<size_t>(value)]++;
+    }
+    for (size_t face = 1; face <= 6; ++face) {
+        assert(faces[face] > count / 7);
+    }
+
+    std::vector<float> normal(count);
+    utils::random::fill_normal(engine, normal.data(), count, 1.0F, 2.0F);
+    double mean = 0.0;
+    for (float const value : normal) {
+        mean += static_cast<double>(value);
+    }
+    mean /= count;
+    double deviation = 0.0;
+    for (float const value : normal) {
+        double const delta = static_cast<double>(value) - mean;
+        deviation += delta * delta;
+    }
+    deviation = std::sqrt(deviation / count);
+    assert(std::fabs(mean - 1.0) < 0.03);
+    assert(std::fabs(deviation - 2.0) < 0.03);
+
+    std::vector<float> x(count);
+    std::vector<float> y(count);
+    std::vector<float> z(count);
+    utils::random::fill_unit_sphere(engine, x.data(), y.data(), z.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        float const length = std::sqrt((x[i] * x[i]) + (y[i] * y[i]) + (z[i] * z[i]));
+        assert(std::fabs(length - 1.0F) < 1e-4F);
+    }
+
+    utils::random::fill_hemisphere(engine, x.data(), y.data(), z.data(), count, 0.0F, 1.0F, 0.0F);
+    for (size_t i = 0; i < count; ++i) {
+        assert(y[i] >= 0.0F);
+    }
+
+    std::cout << "random: all checks passed" << '\n';
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+#include "domkrat3d/utils/ring.hpp"
+
+namespace {
+    using utils::ring::SpscRing;
+
+    // Filled, emptied and refilled far past its capacity, so the indices wrap around the slots many times.
+    void check_wraparound() {
+        SpscRing<uint32_t, 8> ring;
+        uint32_t value = 0;
+        assert(ring.empty() && !ring.pop(value));
+
+        uint32_t next = 0;
+        uint32_t expected = 0;
+        for (size_t round = 0; round < 100; ++round) {
+            // Uneven amounts in and out, so the head and the tail meet at every slot.
+            size_t const in = 1 + (round % 8);
+            for (size_t i = 0; i < in && ring.size() < ring.CAPACITY; ++i) {
+                assert(ring.push(next++));
+            }
+            size_t const out = 1 + ((round * 3) % 5);
+            for (size_t i = 0; i < out && ring.pop(value); ++i) {
+                assert(value == expected++);
+            }
+        }
+        while (ring.pop(value)) {
+            assert(value == expected++);
+        }
+        assert(expected == next && ring.empty());
+
+        // A batch pop that wraps takes the oldest elements in order, and no more than there are.
+        for (uint32_t i = 0; i < 6; ++i) {
+            assert(ring.push(next + i));
+        }
+        uint32_t batch[16] = {};
+        assert(ring.pop(batch, 16) == 6);
+        for (uint32_t i = 0; i < 6; ++i) {
+            assert(batch[i] == next + i);
+        }
+        assert(ring.pop(batch, 16) == 0);
+    }
+
+    // A full ring turns elements away without disturbing what it holds; the count of refusals is
+    // what the input queue reports as dropped.
+    void check_full() {
+        SpscRing<uint32_t, 16> ring;
+        size_t dropped = 0;
+        for (uint32_t value = 0; value < 40; ++value) {
+            if (!ring.push(value)) {
+                ++dropped;
+            }
+        }
+        assert(dropped == 40 - ring.CAPACITY && ring.size() == ring.CAPACITY);
+
+        // One slot freed takes one more element, then it is full again.
+        uint32_t value = 0;
+        assert(ring.pop(value) && value == 0);
+        assert(ring.push(100) && !ring.push(101));
+
+        for (uint32_t expected = 1; expected < ring.CAPACITY; ++expected) {
+            assert(ring.pop(value) && value == expected);
+        }
+        assert(ring.pop(value) && value == 100 && ring.empty());
+    }
+
+    // One producer and one consumer thread: every element arrives once, in order, even through a
+    // ring small enough to be full and empty all the time.
+    void check_threads() {
+        constexpr uint64_t COUNT = 1000000;
+        SpscRing<uint64_t, 64> ring;
+
+        std::thread producer([&ring]() {
+            for (uint64_t value = 0; value < COUNT;) {
+                if (ring.push(value)) {
+                    ++value;
+                }
+            }
+        });
+
+        uint64_t expected = 0;
+        uint64_t batch[7] = {};
+        while (expected < COUNT) {
+            // Single and batch pops in turn.
+            if ((expected & 1) == 0) {
+                uint64_t value = 0;
+                if (ring.pop(value)) {
+                    assert(value == expected++);
+                }
+            } else {
+                size_t const taken = ring.pop(batch, 7);
+                for (size_t i = 0; i < taken; ++i) {
+                    assert(batch[i] == expected++);
+                }
+            }
+        }
+        producer.join();
+        assert(ring.empty());
+    }
+}    // namespace
+
+auto main() -> int {
+    check_wraparound();
+    check_full();
+    check_threads();
+
+    std::cout << "ring: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/mathematics/quaternion.hpp"
+#include "domkrat3d/physics/dynamics.hpp"
+#include "domkrat3d/physics/simulation.hpp"
+
+namespace {
+    using mathematics::Transform;
+    using physics::dynamics::BodyDesc;
+    using physics::dynamics::World;
+    using physics::narrowphase::Shape;
+    using physics::simulation::Clock;
+    using physics::simulation::Settings;
+    using physics::simulation::Simulation;
+    using physics::simulation::TripleBuffer;
+
+    constexpr float SPEED = 2.0F;
+
+    // A value that is only whole if both halves were written together.
+    struct Pair {
+        uint64_t value = 0;
+        uint64_t check = 0;
+    };
+
+    void check_buffer() {
+        TripleBuffer<Pair> buffer;
+        assert(!buffer.update());
+
+        buffer.back() = {1, ~1ULL};
+        buffer.publish();
+        assert(buffer.update() && buffer.front().value == 1);
+        assert(!buffer.update() && buffer.front().value == 1);
+
+        // The reader skips what it was too slow to see and gets the latest value.
+        for (uint64_t value = 2; value <= 5; ++value) {
+            buffer.back() = {value, ~value};
+            buffer.publish();
+        }
+        assert(buffer.update() && buffer.front().value == 5);
+        assert(!buffer.update());
+    }
+
+    // A writer publishing as fast as it can: the reader only ever sees whole values, in order.
+    void check_buffer_threads() {
+        constexpr uint64_t LAST = 200000;
+        TripleBuffer<Pair> buffer;
+
+        std::thread writer([&buffer]() {
+            for (uint64_t value = 1; value <= LAST; ++value) {
+                buffer.back() = {value, ~value};
+                buffer.publish();
+            }
+        });
+
+        uint64_t seen = 0;
+        while (seen < LAST) {
+            if (buffer.update()) {
+                const Pair& pair = buffer.front();
+                assert(pair.check == ~pair.value);
+                assert(pair.value > seen);
+                seen = pair.value;
+            }
+        }
+        writer.join();
+        assert(!buffer.update());
+    }
+
+    // One sphere moving along x at SPEED, with nothing to pull or stop it.
+    auto drifting_world() -> World {
+        physics::dynamics::Settings settings;
+        settings.gravity = {0.0F, 0.0F, 0.0F};
+        World world(settings);
+        BodyDesc desc;
+        desc.shape = Shape::sphere(0.5F);
+        desc.linear_velocity = {SPEED, 0.0F, 0.0F};
+        world.create_body(desc);
+        return world;
+    }
+
+    auto x_at(Simulation& simulation, Clock::time_point now) -> float {
+        std::vector<Transform> transforms;
+        assert(simulation.interpolate(now, transforms) && transforms.size() == 1);
+        return transforms[0].position.x;
+    }
+
+    auto close(float value, float expected) -> bool {
+        return std::fabs(value - expected) <= 1e-4F;
+    }
+
+    // update() driven by a made-up clock: steps fall due every step and the backlog is capped.
+    void check_schedule() {
+        World world = drifting_world();
+        Settings settings;
+        settings.rate = 100.0;
+        settings.max_steps_per_update = 4;
+        Simulation simulation(world, settings);
+        Clock::duration const step = std::chrono::milliseconds(10);
+        Clock::time_point const start = Clock::time_point {} + std::chrono::seconds(5);
+
+        std::vector<Transform> transforms;
+        assert(!simulation.interpolate(start, transforms) && transforms.empty());
+
+        // The first call only sets the schedule.
+        assert(simulation.update(start) == 0 && simulation.step_count() == 0);
+        assert(simulation.update(start + (step / 2)) == 0);
+        assert(simulation.update(start + step) == 1);
+        assert(simulation.update(start + (step * 3) + (step / 2)) == 2);
+        assert(simulation.update(start + (step * 4) - std::chrono::microseconds(1)) == 0);
+        assert(simulation.update(start + (step * 4)) == 1 && simulation.step_count() == 4);
+
+        // Far behind, it runs max_steps_per_update steps and drops the rest of the backlog.
+        Clock::time_point const late = start + std::chrono::seconds(1);
+        assert(simulation.update(late) == 4 && simulation.step_count() == 8);
+        assert(simulation.update(late + (step / 2) - std::chrono::microseconds(1)) == 0);
+        assert(simulation.update(late + (step / 2)) == 1 && simulation.step_count() == 9);
+    }
+
+    // The latest pair of states is blended by how far `now` is past the last step, clamped to one step.
+    void check_interpolation() {
+        World world = drifting_world();
+        Settings settings;
+        settings.rate = 100.0;
+        Simulation simulation(world, settings);
+        Clock::duration const step = std::chrono::milliseconds(10);
+        Clock::time_point const start = Clock::time_point {} + std::chrono::seconds(5);
+
+        simulation.update(start);
+        assert(simulation.update(start + (step * 3)) == 3);
+        Clock::time_point const last = start + (step * 3);
+        float const previous = 2.0F * SPEED * simulation.step_time();
+        float const current = 3.0F * SPEED * simulation.step_time();
+        assert(close(world.transform(0).position.x, current));
+
+        float const alphas[] = {0.0F, 0.25F, 0.5F, 0.75F, 1.0F};
+        for (float const alpha : alphas) {
+            auto const offset =
+                std::chrono::duration_cast<Clock::duration>(step * static_cast<double>(alpha));
+            assert(close(x_at(simulation, last + offset), previous + (alpha * (current - previous))));
+        }
+        assert(close(x_at(simulation, last - step), previous));
+        assert(close(x_at(simulation, last + (step * 3)), current));
+    }
+
+    // advance() steps by step_time() whatever the clock says; the thread keeps stepping until stopped.
+    void check_running() {
+        World world = drifting_world();
+        Simulation simulation(world);
+        simulation.advance(12);
+        assert(simulation.step_count() == 12);
+        assert(close(world.transform(0).position.x, 12.0F * SPEED * simulation.step_time()));
+
+        simulation.start();
+        assert(simulation.is_running());
+        std::vector<Transform> transforms;
+        for (int i = 0; i < 200 && !(simulation.interpolate(Clock::now(), transforms)
+                                     && transforms[0].position.x > 20.0F * SPEED * simulation.step_time());
+             ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        simulation.stop();
+        assert(!simulation.is_running());
+
+        uint64_t const steps = simulation.step_count();
+        assert(steps > 20);
+        float const travelled = static_cast<float>(steps) * SPEED * simulation.step_time();
+        assert(close(world.transform(0).position.x, travelled));
+    }
+}    // namespace
+
+auto main() -> int {
+    check_buffer();
+    check_buffer_threads();
+    check_schedule();
+    check_interpolation();
+    check_running();
+
+    std::cout << "simulation: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/physics/snapshot.hpp"
+
+namespace {
+    using physics::snapshot::Pool;
+    using physics::snapshot::SnapshotRing;
+
+    // Two pools, one of them not a whole number of words.
+    struct State {
+        std::vector<uint32_t> words = std::vector<uint32_t>(300);
+        std::vector<uint8_t> bytes = std::vector<uint8_t>(37);
+
+        auto pools() -> std::vector<Pool> {
+            return {{words.data(), words.size() * sizeof(uint32_t)}, {bytes.data(), bytes.size()}};
+        }
+
+        auto operator==(const State& other) const -> bool {
+            return words == other.words && bytes == other.bytes;
+        }
+    };
+
+    // A frame changes a few words and bytes, as a simulation step with mostly sleeping bodies does.
+    void step(State& state, std::mt19937& random) {
+        for (int change = 0; change < 8; ++change) {
+            state.words[random() % state.words.size()] = static_cast<uint32_t>(random());
+            state.bytes[random() % state.bytes.size()] = static_cast<uint8_t>(random());
+        }
+    }
+
+    // Capture frames 0..9, rewind to 7: the slots of 4 and 5 now hold 8 and 9, so they must be gone.
+    void check_rewind_window(size_t keyframe_interval) {
+        std::mt19937 random(1);
+        SnapshotRing ring(4, keyframe_interval);
+        State state;
+        std::vector<State> history;
+        for (uint64_t frame = 0; frame < 10; ++frame) {
+            step(state, random);
+            assert(ring.capture(state.pools()) == frame);
+            history.push_back(state);
+        }
+        assert(!ring.contains(5) && ring.contains(9));
+
+        assert(ring.restore(7, state.pools()) && state == history[7]);
+        assert(ring.last_frame() == 7 && !ring.contains(8));
+        assert(!ring.contains(4) && !ring.contains(5) && ring.first_frame() >= 6);
+        assert(!ring.restore(4, state.pools()) && !ring.restore(5, state.pools()));
+        if (ring.contains(6)) {
+            assert(ring.restore(6, state.pools()) && state == history[6]);
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    // With a keyframe interval of 4, frame 7 depends on keyframe 4 and is gone as well.
+    for (size_t interval = 1; interval <= 3; ++interval) {
+        check_rewind_window(interval);
+    }
+
+    // Random captures and rewinds against a record of every frame's state.
+    for (size_t const interval : {size_t {1}, size_t {3}, size_t {32}}) {
+        std::mt19937 random(static_cast<uint32_t>(interval));
+        SnapshotRing ring(6, interval);
+        State state;
+        std::map<uint64_t, State> expected;
+        for (int action = 0; action < 2000; ++action) {
+            if (ring.empty() || random() % 4 != 0) {
+                step(state, random);
+                uint64_t const frame = ring.capture(state.pools());
+                expected[frame] = state;
+                assert(ring.contains(frame) && ring.last_frame() == frame);
+                assert(ring.packed_bytes(frame) > 0);
+                continue;
+            }
+
+            uint64_t const frame = ring.last_frame() - random() % 8U;
+            bool const contained = ring.contains(frame);
+            bool const restored = ring.restore(frame, state.pools());
+            assert(restored == contained);
+            if (restored) {
+                assert(state == expected.at(frame) && ring.last_frame() == frame);
+            }
+        }
+    }
+
+    // A new layout starts over.
+    SnapshotRing ring(4, 2);
+    State state;
+    ring.capture(state.pools());
+    std::vector<uint32_t> other(5);
+    std::vector<Pool> const resized {{other.data(), other.size() * sizeof(uint32_t)}};
+    assert(ring.capture(resized) == 1 && ring.first_frame() == 1 && !ring.contains(0));
+    assert(!ring.restore(1, state.pools()));
+
+    std::cout << "snapshot: all checks passed\n";
+    return 0;
+}
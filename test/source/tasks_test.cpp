@@ -0,0 +1,109 @@
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "domkrat3d/utils/jobs.hpp"
+#include "domkrat3d/utils/tasks.hpp"
+
+namespace {
+    using utils::tasks::TaskGraph;
+    using utils::tasks::TaskId;
+
+    constexpr int FRAME_COUNT = 50;
+
+    // Position of each task in the order the tasks ran, and the thread that ran it.
+    struct Trace {
+        std::atomic<uint32_t> next {0};
+        std::vector<std::atomic<uint32_t>> positions;
+        std::vector<std::thread::id> threads;
+
+        explicit Trace(size_t count)
+            : positions(count)
+            , threads(count) {}
+    };
+
+    void check_run(TaskGraph& graph, utils::jobs::JobSystem& system, Trace& trace, TaskId main_task) {
+        for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+            trace.next.store(0);
+            graph.run(system);
+            assert(trace.next.load() == graph.task_count());
+
+            // Every edge of the graph held at run time.
+            for (TaskId task = 0; task < graph.task_count(); ++task) {
+                for (TaskId const next : graph.successors(task)) {
+                    assert(trace.positions[task].load() < trace.positions[next].load());
+                }
+            }
+            assert(trace.threads[main_task] == std::this_thread::get_id());
+
+            assert(graph.timings().size() == graph.task_count());
+            for (const auto& timing : graph.timings()) {
+                assert(timing.start >= 0.0 && timing.duration >= 0.0);
+            }
+            assert(graph.frame_time() > 0.0);
+        }
+    }
+}    // namespace
+
+auto main() -> int {
+    TaskGraph graph;
+    auto const a = graph.add_resource("a");
+    auto const b = graph.add_resource("b");
+    assert(graph.resource_name(b) == "b");
+
+    // Room for the task added after the first runs.
+    Trace trace(8);
+    auto const task = [&trace](TaskId id)
+    {
+        return [&trace, id]()
+        {
+            trace.positions[id].store(trace.next.fetch_add(1));
+            trace.threads[id] = std::this_thread::get_id();
+        };
+    };
+
+    TaskId const write_a = graph.add_task({"write a", task(0), {}, {a}});
+    TaskId const read_a = graph.add_task({"read a", task(1), {a}, {}});
+    TaskId const read_a_again = graph.add_task({"read a again", task(2), {a}, {}});
+    TaskId const rewrite_a = graph.add_task({"rewrite a", task(3), {}, {a}});
+    TaskId const write_b = graph.add_task({"write b", task(4), {}, {b}});
+    TaskId const rewrite_b = graph.add_task({"rewrite b", task(5), {}, {b}});
+    TaskId const present = graph.add_task({"present", task(6), {a, b}, {}, true});
+    assert(graph.task_count() == 7 && graph.name(present) == "present");
+
+    graph.compile();
+    using Ids = std::vector<TaskId>;
+
+    // Read after write: both readers follow the writer, and do not wait on each other.
+    // Write after read: the second writer follows both readers. Write after write: it also
+    // follows the first writer, as does the second writer of b.
+    assert(graph.successors(write_a) == (Ids {read_a, read_a_again, rewrite_a}));
+    assert(graph.successors(read_a) == Ids {rewrite_a});
+    assert(graph.successors(read_a_again) == Ids {rewrite_a});
+    assert(graph.successors(rewrite_a) == Ids {present});
+    assert(graph.successors(write_b) == Ids {rewrite_b});
+    assert(graph.successors(rewrite_b) == Ids {present});
+    assert(graph.successors(present).empty());
+
+    utils::jobs::JobSystem system(4);
+    check_run(graph, system, trace, present);
+
+    // A task added later is picked up by the next run, which compiles again.
+    TaskId const read_b = graph.add_task({"read b", task(7), {b}, {}});
+    check_run(graph, system, trace, present);
+    assert(graph.successors(rewrite_b) == (Ids {present, read_b}));
+
+    // With one thread the caller runs every task itself.
+    utils::jobs::JobSystem alone(1);
+    check_run(graph, alone, trace, present);
+    for (const auto& thread : trace.threads) {
+        assert(thread == std::this_thread::get_id());
+    }
+
+    std::cout << "tasks: all checks passed\n";
+    return 0;
+}
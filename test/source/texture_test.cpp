@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "domkrat3d/assets/texture.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    using assets::texture::Image;
+    using assets::texture::MipFilter;
+    using assets::texture::TextureFormat;
+    using assets::texture::TextureSettings;
+
+    const TextureFormat BLOCK_FORMATS[] = {
+        TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC5, TextureFormat::BC7};
+
+    auto block_bytes(TextureFormat format) -> size_t {
+        return format == TextureFormat::BC1 ? 8 : 16;
+    }
+
+    // Interpolated values between the two ends of a channel: a line through a block is off by at
+    // most half a step, plus what storing the ends loses.
+    auto steps(TextureFormat format, int channel) -> int {
+        if (format == TextureFormat::BC7) {
+            return 15;
+        }
+        if (format == TextureFormat::BC5 || (format == TextureFormat::BC3 && channel == 3)) {
+            return 7;
+        }
+        return 3;
+    }
+
+    auto stored(TextureFormat format, int channel) -> bool {
+        return format != TextureFormat::BC5 || channel < 2;
+    }
+
+    void round_trip(TextureFormat format, const uint8_t texels[64], uint8_t decoded[64]) {
+        std::byte block[16];
+        assets::texture::encode_block(format, texels, block);
+        assets::texture::decode_block(format, block, decoded);
+    }
+
+    // A flat block and blocks running along a line in colour space come back within the precision of
+    // the format; channels BC5 does not store decode to 0 and 255.
+    void check_blocks(TextureFormat format) {
+        std::mt19937 random(11);
+        std::uniform_int_distribution<int> value(0, 255);
+        uint8_t texels[64];
+        uint8_t decoded[64];
+
+        for (int round = 0; round < 2000; ++round) {
+            int low[4];
+            int high[4];
+            for (int c = 0; c < 4; ++c) {
+                low[c] = value(random);
+                high[c] = round % 4 == 0 ? low[c] : value(random);
+            }
+            if (format == TextureFormat::BC1) {
+                low[3] = 255;
+                high[3] = 255;
+            }
+            for (int texel = 0; texel < 16; ++texel) {
+                for (int c = 0; c < 4; ++c) {
+                    int const level = low[c] + ((high[c] - low[c]) * texel / 15);
+                    texels[(texel * 4) + c] = static_cast<uint8_t>(level);
+                }
+            }
+
+            round_trip(format, texels, decoded);
+            for (int c = 0; c < 4; ++c) {
+                // 5:6:5 colour ends lose up to 4; BC7 keeps 7 bits and a shared bit.
+                int const precision = format == TextureFormat::BC7 ? 2 : (c < 3 ? 4 : 1);
+                int const bound = (std::abs(high[c] - low[c]) / (2 * steps(format, c))) + precision + 1;
+                for (int texel = 0; texel < 16; ++texel) {
+                    int const result = decoded[(texel * 4) + c];
+                    if (!stored(format, c)) {
+                        assert(result == (c == 2 ? 0 : 255));
+                        continue;
+                    }
+                    assert(std::abs(result - texels[(texel * 4) + c]) <= bound);
+                }
+            }
+        }
+    }
+
+    // BC1 keeps texels with alpha below one half as transparent black and the rest opaque.
+    void check_cutout() {
+        uint8_t texels[64];
+        uint8_t decoded[64];
+        for (int texel = 0; texel < 16; ++texel) {
+            texels[texel * 4] = 200;
+            texels[(texel * 4) + 1] = static_cast<uint8_t>(texel * 16);
+            texels[(texel * 4) + 2] = 40;
+            texels[(texel * 4) + 3] = texel % 3 == 0 ? 20 : 240;
+        }
+        round_trip(TextureFormat::BC1, texels, decoded);
+        for (int texel = 0; texel < 16; ++texel) {
+            if (texel % 3 == 0) {
+                assert(decoded[(texel * 4) + 3] == 0);
+                assert(decoded[texel * 4] == 0 && decoded[(texel * 4) + 1] == 0);
+            } else {
+                assert(decoded[(texel * 4) + 3] == 255);
+                assert(std::abs(decoded[texel * 4] - 200) <= 4);
+            }
+        }
+    }
+
+    // A smooth image whose sizes are not multiples of the block size.
+    auto gradient(uint32_t width, uint32_t height) -> Image {
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(size_t {width} * height * 4);
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                uint8_t* const texel = &image.pixels[((size_t {y} * width) + x) * 4];
+                texel[0] = static_cast<uint8_t>(x * 255 / (width - 1));
+                texel[1] = static_cast<uint8_t>(y * 255 / (height - 1));
+                texel[2] = static_cast<uint8_t>((x + y) * 255 / (width + height - 2));
+                texel[3] = static_cast<uint8_t>(255 - (x * 100 / (width - 1)));
+            }
+        }
+        return image;
+    }
+
+    auto at(const Image& image, uint32_t x, uint32_t y, int channel) -> int {
+        return image.pixels[(((size_t {y} * image.width) + x) * 4) + static_cast<size_t>(channel)];
+    }
+
+    // Every level halves the last down to 1x1; a flat image stays flat whatever the filter, and a box
+    // filtered level without sRGB is the plain average of four texels.
+    void check_mips(utils::jobs::JobSystem& jobs) {
+        Image flat;
+        flat.width = 37;
+        flat.height = 20;
+        for (size_t i = 0; i < size_t {flat.width} * flat.height; ++i) {
+            flat.pixels.insert(flat.pixels.end(), {180, 64, 12, 99});
+        }
+
+        uint32_t const widths[] = {37, 18, 9, 4, 2, 1};
+        uint32_t const heights[] = {20, 10, 5, 2, 1, 1};
+        for (MipFilter const filter : {MipFilter::Box, MipFilter::Kaiser}) {
+            for (bool const srgb : {false, true}) {
+                std::vector<Image> const levels = assets::texture::generate_mips(flat, srgb, filter, jobs);
+                assert(levels.size() == 6);
+                for (size_t mip = 0; mip < levels.size(); ++mip) {
+                    assert(levels[mip].width == widths[mip] && levels[mip].height == heights[mip]);
+                    assert(levels[mip].pixels.size() == size_t {widths[mip]} * heights[mip] * 4);
+                    for (size_t i = 0; i < levels[mip].pixels.size(); ++i) {
+                        assert(std::abs(levels[mip].pixels[i] - flat.pixels[i % 4]) <= 1);
+                    }
+                }
+            }
+        }
+
+        Image const image = gradient(32, 16);
+        std::vector<Image> const levels = assets::texture::generate_mips(image, false, MipFilter::Box, jobs);
+        assert(levels.size() == 6);
+        const Image& half = levels[1];
+        for (uint32_t y = 0; y < half.height; ++y) {
+            for (uint32_t x = 0; x < half.width; ++x) {
+                for (int c = 0; c < 4; ++c) {
+                    uint32_t const left = x * 2;
+                    uint32_t const top = y * 2;
+                    int const sum = at(image, left, top, c) + at(image, left + 1, top, c)
+                                    + at(image, left, top + 1, c) + at(image, left + 1, top + 1, c);
+                    assert(std::abs((at(half, x, y, c) * 4) - sum) <= 2);
+                }
+            }
+        }
+    }
+
+    // Compressed levels are encode_block() of each block, edge blocks repeating the last row and
+    // column, whatever the tiling; decoded, a smooth image stays close to the original. Its blocks
+    // span a plane of colours rather than a line, so single texels may be off by more than in
+    // check_blocks().
+    void check_compress(utils::jobs::JobSystem& jobs) {
+        Image const image = gradient(37, 22);
+        uint32_t const blocks_x = 10;
+        uint32_t const blocks_y = 6;
+
+        for (TextureFormat const format : BLOCK_FORMATS) {
+            double squared = 0.0;
+            size_t count = 0;
+            std::vector<std::byte> const data = assets::texture::compress(image, format, 8, jobs);
+            assert(data.size() == assets::texture::level_size(format, 37, 22));
+            assert(data.size() == size_t {blocks_x} * blocks_y * block_bytes(format));
+            assert(assets::texture::compress(image, format, 128, jobs) == data);
+            assert(assets::texture::compress(image, format, 4, jobs) == data);
+
+            uint8_t texels[64];
+            uint8_t decoded[64];
+            std::byte block[16];
+            for (uint32_t by = 0; by < blocks_y; ++by) {
+                for (uint32_t bx = 0; bx < blocks_x; ++bx) {
+                    for (uint32_t texel = 0; texel < 16; ++texel) {
+                        uint32_t const x = std::min((bx * 4) + (texel % 4), image.width - 1);
+                        uint32_t const y = std::min((by * 4) + (texel / 4), image.height - 1);
+                        for (int c = 0; c < 4; ++c) {
+                            auto const value = static_cast<uint8_t>(at(image, x, y, c));
+                            texels[(texel * 4) + static_cast<uint32_t>(c)] = value;
+                        }
+                    }
+                    assets::texture::encode_block(format, texels, block);
+                    const std::byte* const stored_block =
+                        &data[((size_t {by} * blocks_x) + bx) * block_bytes(format)];
+                    assert(std::equal(block, block + block_bytes(format), stored_block));
+
+                    assets::texture::decode_block(format, stored_block, decoded);
+                    for (int i = 0; i < 64; ++i) {
+                        int const channel = i % 4;
+                        // BC1 alpha is one bit; the image is opaque to it.
+                        if (stored(format, channel) && (format != TextureFormat::BC1 || channel < 3)) {
+                            int const error = std::abs(decoded[i] - texels[i]);
+                            assert(error <= 20);
+                            squared += error * error;
+                            ++count;
+                        }
+                    }
+                }
+            }
+            assert(std::sqrt(squared / static_cast<double>(count)) < 6.0);
+        }
+    }
+
+    // A cooked blob reads back with every level where the header says, each the compressed mip.
+    void check_cook(utils::jobs::JobSystem& jobs) {
+        Image const image = gradient(37, 22);
+        TextureSettings settings;
+        settings.format = TextureFormat::BC3;
+        settings.tile_size = 16;
+        std::vector<std::byte> const blob = assets::texture::cook(image, settings, jobs);
+
+        assets::texture::CookedTexture const texture =
+            assets::texture::read_texture(blob.data(), blob.size());
+        assert(texture && texture.header->mip_count == 6 && texture.header->srgb == 1);
+        std::vector<Image> const levels =
+            assets::texture::generate_mips(image, settings.srgb, settings.filter, jobs);
+        for (uint32_t mip = 0; mip < texture.header->mip_count; ++mip) {
+            assets::texture::Level const level = texture.level(mip);
+            assert(level.width == levels[mip].width && level.height == levels[mip].height);
+            assert(texture.header->offsets[mip] % 16 == 0);
+            std::vector<std::byte> const expected =
+                assets::texture::compress(levels[mip], settings.format, settings.tile_size, jobs);
+            assert(level.size == expected.size());
+            assert(std::equal(expected.begin(), expected.end(), level.data));
+        }
+
+        // Cut short or with a wrong magic, the blob is refused.
+        assert(!assets::texture::read_texture(blob.data(), blob.size() - 1));
+        std::vector<std::byte> broken = blob;
+        broken[0] = std::byte {0};
+        assert(!assets::texture::read_texture(broken.data(), broken.size()));
+    }
+}    // namespace
+
+auto main() -> int {
+    for (TextureFormat const format : BLOCK_FORMATS) {
+        check_blocks(format);
+    }
+    check_cutout();
+
+    utils::jobs::JobSystem jobs(4);
+    check_mips(jobs);
+    check_compress(jobs);
+    check_cook(jobs);
+
+    std::cout << "texture: all checks passed\n";
+    return 0;
+}
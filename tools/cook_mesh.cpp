@@ -0,0 +1,82 @@
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/assets/archive.hpp"
+#include "domkrat3d/assets/mesh.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    auto cook_model(const std::string& path) -> std::vector<std::byte> {
+        assets::mesh::Mesh mesh = assets::mesh::import_mesh(path);
+        size_t const imported = mesh.vertices.size();
+
+        assets::mesh::weld(mesh);
+        float const before = assets::mesh::cache_miss_ratio(mesh);
+        assets::mesh::optimize_vertex_cache(mesh);
+        assets::mesh::optimize_vertex_fetch(mesh);
+        std::vector<std::byte> cooked = assets::mesh::cook(mesh);
+
+        size_t const float_bytes =
+            mesh.vertices.size() * sizeof(assets::mesh::Vertex) + mesh.indices.size() * sizeof(uint32_t);
+        std::cout << path << ": " << mesh.indices.size() / 3 << " triangles, " << imported << " -> "
+                  << mesh.vertices.size() << " vertices, ACMR " << before << " -> "
+                  << assets::mesh::cache_miss_ratio(mesh) << ", " << float_bytes << " -> " << cooked.size()
+                  << " bytes\n";
+        return cooked;
+    }
+
+    void write_file(const fs::path& path, const std::vector<std::byte>& data) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            throw std::runtime_error("cannot write " + path.string());
+        }
+    }
+}    // namespace
+
+auto main(int argc, char** argv) -> int {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <archive.pak or directory> <model>...\n";
+        return 2;
+    }
+
+    try {
+        fs::path const output = argv[1];
+        bool const archive = output.extension() == ".pak";
+        if (!archive) {
+            fs::create_directories(output);
+        }
+
+        // Cooked meshes are named after their model: a directory of them can also go to domkrat3d_pack.
+        assets::ArchiveWriter writer;
+        for (int i = 2; i < argc; ++i) {
+            std::string const name = fs::path(argv[i]).stem().string() + ".mesh";
+            std::vector<std::byte> cooked = cook_model(argv[i]);
+            if (archive) {
+                writer.add(name, assets::AssetType::Mesh, std::move(cooked));
+            } else {
+                write_file(output / name, cooked);
+            }
+        }
+
+        if (archive) {
+            size_t const bytes = writer.write(output.string());
+            std::cout << "packed " << writer.size() << " meshes into " << output.string() << " (" << bytes
+                      << " bytes)\n";
+        }
+    } catch (const std::exception& error) {
+        std::cerr << argv[0] << ": " << error.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
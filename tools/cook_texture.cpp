@@ -0,0 +1,165 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/assets/archive.hpp"
+#include "domkrat3d/assets/texture.hpp"
+#include "domkrat3d/utils/jobs.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    using assets::texture::TextureFormat;
+
+    auto parse_format(const std::string& name) -> TextureFormat {
+        if (name == "rgba8") {
+            return TextureFormat::RGBA8;
+        }
+        if (name == "bc1") {
+            return TextureFormat::BC1;
+        }
+        if (name == "bc3") {
+            return TextureFormat::BC3;
+        }
+        if (name == "bc5") {
+            return TextureFormat::BC5;
+        }
+        if (name == "bc7") {
+            return TextureFormat::BC7;
+        }
+        throw std::invalid_argument("unknown format " + name);
+    }
+
+    // Peak signal to noise ratio of the largest level against the image, over the stored channels.
+    auto psnr(const assets::texture::Image& image, const assets::texture::CookedTexture& texture) -> double {
+        TextureFormat const format = texture.header->format;
+        if (format == TextureFormat::RGBA8) {
+            return std::numeric_limits<double>::infinity();
+        }
+        assets::texture::Level const level = texture.level(0);
+        size_t const block_bytes = format == TextureFormat::BC1 ? 8 : 16;
+        uint32_t const channels = format == TextureFormat::BC5 ? 2 : 4;
+        uint32_t const blocks_x = (image.width + 3) / 4;
+
+        double error = 0.0;
+        uint8_t texels[64];
+        for (uint32_t y = 0; y < image.height; y += 4) {
+            for (uint32_t x = 0; x < image.width; x += 4) {
+                size_t const block = size_t {y / 4} * blocks_x + x / 4;
+                assets::texture::decode_block(format, level.data + block * block_bytes, texels);
+                for (uint32_t texel = 0; texel < 16; ++texel) {
+                    uint32_t const texel_x = x + texel % 4;
+                    uint32_t const texel_y = y + texel / 4;
+                    if (texel_x >= image.width || texel_y >= image.height) {
+                        continue;
+                    }
+                    size_t const index = size_t {texel_y} * image.width + texel_x;
+                    const uint8_t* const original = &image.pixels[index * 4];
+                    for (uint32_t c = 0; c < channels; ++c) {
+                        double const difference = texels[texel * 4 + c] - original[c];
+                        error += difference * difference;
+                    }
+                }
+            }
+        }
+        double const mean = error / (static_cast<double>(image.pixels.size()) / 4.0 * channels);
+        if (!(mean > 0.0)) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return 10.0 * std::log10(255.0 * 255.0 / mean);
+    }
+
+    void write_file(const fs::path& path, const std::vector<std::byte>& data) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            throw std::runtime_error("cannot write " + path.string());
+        }
+    }
+}    // namespace
+
+auto main(int argc, char** argv) -> int {
+    assets::texture::TextureSettings settings;
+    int first = 1;
+    try {
+        for (; first < argc && std::string(argv[first]).compare(0, 2, "--") == 0; ++first) {
+            std::string const option = argv[first];
+            if (option == "--format" && first + 1 < argc) {
+                settings.format = parse_format(argv[++first]);
+            } else if (option == "--linear") {
+                settings.srgb = false;
+            } else if (option == "--box") {
+                settings.filter = assets::texture::MipFilter::Box;
+            } else if (option == "--no-mips") {
+                settings.mipmaps = false;
+            } else {
+                throw std::invalid_argument("unknown option " + option);
+            }
+        }
+    } catch (const std::exception& error) {
+        std::cerr << argv[0] << ": " << error.what() << "\n";
+        first = argc;
+    }
+    if (argc - first < 2) {
+        std::cerr << "usage: " << argv[0]
+                  << " [--format rgba8|bc1|bc3|bc5|bc7] [--linear] [--box] [--no-mips]"
+                     " <archive.pak or directory> <image>...\n";
+        return 2;
+    }
+    // Two-channel data is never colour.
+    if (settings.format == TextureFormat::BC5) {
+        settings.srgb = false;
+    }
+
+    try {
+        fs::path const output = argv[first];
+        bool const archive = output.extension() == ".pak";
+        if (!archive) {
+            fs::create_directories(output);
+        }
+
+        // Cooked textures are named after their image: a directory of them can also go to domkrat3d_pack.
+        assets::ArchiveWriter writer;
+        for (int i = first + 1; i < argc; ++i) {
+            auto const start = std::chrono::steady_clock::now();
+            assets::texture::Image const image = assets::texture::load_image(argv[i]);
+            std::vector<std::byte> cooked = assets::texture::cook(image, settings, utils::jobs::global());
+            std::chrono::duration<double> const seconds = std::chrono::steady_clock::now() - start;
+
+            assets::texture::CookedTexture const texture =
+                assets::texture::read_texture(cooked.data(), cooked.size());
+            std::cout << argv[i] << ": " << image.width << "x" << image.height << ", "
+                      << texture.header->mip_count << " levels, " << image.pixels.size() << " -> "
+                      << cooked.size() << " bytes, PSNR " << psnr(image, texture) << " dB, "
+                      << seconds.count() << " s\n";
+
+            std::string const name = fs::path(argv[i]).stem().string() + ".tex";
+            if (archive) {
+                writer.add(name, assets::AssetType::Texture, std::move(cooked));
+            } else {
+                write_file(output / name, cooked);
+            }
+        }
+
+        if (archive) {
+            size_t const bytes = writer.write(output.string());
+            std::cout << "packed " << writer.size() << " textures into " << output.string() << " (" << bytes
+                      << " bytes)\n";
+        }
+    } catch (const std::exception& error) {
+        std::cerr << argv[0] << ": " << error.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
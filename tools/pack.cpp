@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "domkrat3d/assets/archive.hpp"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    using assets::AssetType;
+
+    struct Input {
+        std::string name;
+        std::string path;
+    };
+
+    // Cooked formats by extension; anything else is stored as raw bytes.
+    auto type_of(const fs::path& path) -> AssetType {
+        std::string const extension = path.extension().string();
+        if (extension == ".mesh") {
+            return AssetType::Mesh;
+        }
+        if (extension == ".tex") {
+            return AssetType::Texture;
+        }
+        if (extension == ".spv") {
+            return AssetType::Shader;
+        }
+        return AssetType::Raw;
+    }
+
+    void collect(const fs::path& argument, std::vector<Input>& inputs) {
+        if (!fs::is_directory(argument)) {
+            inputs.push_back({argument.generic_string(), argument.string()});
+            return;
+        }
+
+        for (const fs::directory_entry& entry : fs::recursive_directory_iterator(argument)) {
+            if (entry.is_regular_file()) {
+                std::string name = entry.path().lexically_relative(argument).generic_string();
+                inputs.push_back({std::move(name), entry.path().string()});
+            }
+        }
+    }
+}    // namespace
+
+auto main(int argc, char** argv) -> int {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <archive> <file or directory>...\n";
+        return 2;
+    }
+
+    try {
+        std::vector<Input> inputs;
+        for (int i = 2; i < argc; ++i) {
+            collect(argv[i], inputs);
+        }
+
+        // Sorted by name, so an archive of the same files is the same byte for byte.
+        std::sort(
+            inputs.begin(), inputs.end(), [](const Input& a, const Input& b) { return a.name < b.name; });
+
+        assets::ArchiveWriter writer;
+        for (Input& input : inputs) {
+            AssetType const type = type_of(input.path);
+            writer.add_file(std::move(input.name), type, input.path);
+        }
+        size_t const bytes = writer.write(argv[1]);
+
+        std::cout << "packed " << writer.size() << " assets into " << argv[1] << " (" << bytes << " bytes)\n";
+    } catch (const std::exception& error) {
+        std::cerr << argv[0] << ": " << error.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}